@@ -10,6 +10,9 @@ DAnalysisUtilities::DAnalysisUtilities(JEventLoop* locEventLoop)
   DEBUG_LEVEL=0;
   gPARMS->SetDefaultParameter("DAnalysisUtilities:DEBUG_LEVEL",DEBUG_LEVEL);
 
+	dUseP4CacheFlag = true;
+	gPARMS->SetDefaultParameter("ANALYSIS:P4_CACHE", dUseP4CacheFlag, "Reuse missing/final-state p4's already computed for a combo (0 to recompute every time)");
+
 	locEventLoop->GetSingle(dPIDAlgorithm);
 
 	dTargetZCenter = 65.0;
@@ -30,6 +33,12 @@ DAnalysisUtilities::DAnalysisUtilities(JEventLoop* locEventLoop)
 	gPARMS->SetDefaultParameter("COMBO:SHOWER_SELECT_TAG", dShowerSelectionTag);
 }
 
+DAnalysisUtilities::~DAnalysisUtilities(void)
+{
+	if((DEBUG_LEVEL > 0) && (dNumP4CacheHits + dNumP4CacheMisses > 0))
+		jout << "DAnalysisUtilities: missing/final-state p4's computed: " << dNumP4CacheMisses << ", reused: " << dNumP4CacheHits << endl;
+}
+
 bool DAnalysisUtilities::Check_IsBDTSignalEvent(JEventLoop* locEventLoop, const DReaction* locReaction, bool locExclusiveMatchFlag, bool locIncludeDecayingToReactionFlag) const
 {
 #ifdef VTRACE
@@ -780,11 +789,32 @@ DLorentzVector DAnalysisUtilities::Calc_MissingP4(const DReaction* locReaction,
 
 DLorentzVector DAnalysisUtilities::Calc_MissingP4(const DReaction* locReaction, const DParticleCombo* locParticleCombo, size_t locStepIndex, int locUpToStepIndex, set<size_t> locUpThroughIndices, set<pair<const JObject*, unsigned int> >& locSourceObjects, bool locUseKinFitDataFlag) const
 {
-	//NOTE: this routine assumes that the p4 of a charged decaying particle with a detached vertex is the same at both vertices!
-	//assumes missing particle is not the beam particle
 	if(locUseKinFitDataFlag && (locParticleCombo->Get_KinFitResults() == NULL))
-		return Calc_MissingP4(locReaction, locParticleCombo, locStepIndex, locUpToStepIndex, locUpThroughIndices, locSourceObjects, false); //kinematic fit failed
+		locUseKinFitDataFlag = false; //kinematic fit failed
+	if(!dUseP4CacheFlag)
+		return Calc_MissingP4_DecayChain(locReaction, locParticleCombo, locStepIndex, locUpToStepIndex, locUpThroughIndices, locSourceObjects, locUseKinFitDataFlag);
+
+	//same p4 may have been computed for this combo by a previous action
+	auto& locP4Cache = locParticleCombo->Get_P4Cache();
+	auto locCachedP4 = locP4Cache.Find(d_ComboMissingP4, locReaction, locStepIndex, locUpToStepIndex, locUpThroughIndices, locUseKinFitDataFlag, locSourceObjects);
+	if(locCachedP4 != nullptr)
+	{
+		++dNumP4CacheHits;
+		return *locCachedP4;
+	}
+	++dNumP4CacheMisses;
+
+	set<pair<const JObject*, unsigned int> > locNewSourceObjects;
+	auto locMissingP4 = Calc_MissingP4_DecayChain(locReaction, locParticleCombo, locStepIndex, locUpToStepIndex, locUpThroughIndices, locNewSourceObjects, locUseKinFitDataFlag);
+	locP4Cache.Add(d_ComboMissingP4, locReaction, locStepIndex, locUpToStepIndex, locUpThroughIndices, locUseKinFitDataFlag, locMissingP4, locNewSourceObjects);
+	locSourceObjects.insert(locNewSourceObjects.begin(), locNewSourceObjects.end());
+	return locMissingP4;
+}
 
+DLorentzVector DAnalysisUtilities::Calc_MissingP4_DecayChain(const DReaction* locReaction, const DParticleCombo* locParticleCombo, size_t locStepIndex, int locUpToStepIndex, const set<size_t>& locUpThroughIndices, set<pair<const JObject*, unsigned int> >& locSourceObjects, bool locUseKinFitDataFlag) const
+{
+	//NOTE: this routine assumes that the p4 of a charged decaying particle with a detached vertex is the same at both vertices!
+	//assumes missing particle is not the beam particle
 	DLorentzVector locMissingP4;
 	const DParticleComboStep* locParticleComboStep = locParticleCombo->Get_ParticleComboStep(locStepIndex);
 	auto locReactionStep = locReaction->Get_ReactionStep(locStepIndex);
@@ -820,7 +850,7 @@ DLorentzVector DAnalysisUtilities::Calc_MissingP4(const DReaction* locReaction,
 		if(locDecayStepIndex > 0) //decaying-particle
 		{
 			//why plus? because the minus-signs are already applied during the call below
-			locMissingP4 += Calc_MissingP4(locReaction, locParticleCombo, locDecayStepIndex, locUpToStepIndex, locUpThroughIndices, locSourceObjects, locUseKinFitDataFlag); //p4 returned is already < 0
+			locMissingP4 += Calc_MissingP4_DecayChain(locReaction, locParticleCombo, locDecayStepIndex, locUpToStepIndex, locUpThroughIndices, locSourceObjects, locUseKinFitDataFlag); //p4 returned is already < 0
 		}
 		else //detected
 		{
@@ -859,9 +889,12 @@ TMatrixFSym DAnalysisUtilities::Calc_MissingP3Covariance(const DReaction* locRea
 	{
 		//initial particle
 		locKinematicData = locParticleComboStep->Get_InitialParticle_Measured();
-		TMatrixFSym locParticleCovarianceMatrix = *(locKinematicData->errorMatrix().get());
-		locParticleCovarianceMatrix.ResizeTo(3, 3);
-		locMissingCovarianceMatrix += locParticleCovarianceMatrix;
+		const DMatrixFSym7& locParticleCovarianceMatrix = *(locKinematicData->errorMatrix());
+		for(int loc_k = 0; loc_k < 3; ++loc_k)
+		{
+			for(int loc_l = 0; loc_l < 3; ++loc_l)
+				locMissingCovarianceMatrix(loc_k, loc_l) += locParticleCovarianceMatrix(loc_k, loc_l);
+		}
 	}
 
 	auto locParticles = locParticleComboStep->Get_FinalParticles_Measured();
@@ -877,9 +910,12 @@ TMatrixFSym DAnalysisUtilities::Calc_MissingP3Covariance(const DReaction* locRea
 			locMissingCovarianceMatrix += Calc_MissingP3Covariance(locReaction, locParticleCombo, locDecayStepIndex, locUpToStepIndex, locUpThroughIndices);
 		else //detected
 		{
-			TMatrixFSym locParticleCovarianceMatrix = *(locParticles[loc_j]->errorMatrix().get());
-			locParticleCovarianceMatrix.ResizeTo(3, 3);
-			locMissingCovarianceMatrix += locParticleCovarianceMatrix;
+			const DMatrixFSym7& locParticleCovarianceMatrix = *(locParticles[loc_j]->errorMatrix());
+			for(int loc_k = 0; loc_k < 3; ++loc_k)
+			{
+				for(int loc_l = 0; loc_l < 3; ++loc_l)
+					locMissingCovarianceMatrix(loc_k, loc_l) += locParticleCovarianceMatrix(loc_k, loc_l);
+			}
 		}
 	}
 
@@ -906,8 +942,29 @@ DLorentzVector DAnalysisUtilities::Calc_FinalStateP4(const DReaction* locReactio
 DLorentzVector DAnalysisUtilities::Calc_FinalStateP4(const DReaction* locReaction, const DParticleCombo* locParticleCombo, size_t locStepIndex, set<size_t> locToIncludeIndices, set<pair<const JObject*, unsigned int> >& locSourceObjects, bool locUseKinFitDataFlag) const
 {
 	if(locUseKinFitDataFlag && (locParticleCombo->Get_KinFitResults() == NULL))
-		return Calc_FinalStateP4(locReaction, locParticleCombo, locStepIndex, locToIncludeIndices, locSourceObjects, false); //kinematic fit failed
+		locUseKinFitDataFlag = false; //kinematic fit failed
+	if(!dUseP4CacheFlag)
+		return Calc_FinalStateP4_DecayChain(locReaction, locParticleCombo, locStepIndex, locToIncludeIndices, locSourceObjects, locUseKinFitDataFlag);
+
+	//same p4 may have been computed for this combo by a previous action
+	auto& locP4Cache = locParticleCombo->Get_P4Cache();
+	auto locCachedP4 = locP4Cache.Find(d_ComboFinalStateP4, locReaction, locStepIndex, -1, locToIncludeIndices, locUseKinFitDataFlag, locSourceObjects);
+	if(locCachedP4 != nullptr)
+	{
+		++dNumP4CacheHits;
+		return *locCachedP4;
+	}
+	++dNumP4CacheMisses;
+
+	set<pair<const JObject*, unsigned int> > locNewSourceObjects;
+	auto locFinalStateP4 = Calc_FinalStateP4_DecayChain(locReaction, locParticleCombo, locStepIndex, locToIncludeIndices, locNewSourceObjects, locUseKinFitDataFlag);
+	locP4Cache.Add(d_ComboFinalStateP4, locReaction, locStepIndex, -1, locToIncludeIndices, locUseKinFitDataFlag, locFinalStateP4, locNewSourceObjects);
+	locSourceObjects.insert(locNewSourceObjects.begin(), locNewSourceObjects.end());
+	return locFinalStateP4;
+}
 
+DLorentzVector DAnalysisUtilities::Calc_FinalStateP4_DecayChain(const DReaction* locReaction, const DParticleCombo* locParticleCombo, size_t locStepIndex, const set<size_t>& locToIncludeIndices, set<pair<const JObject*, unsigned int> >& locSourceObjects, bool locUseKinFitDataFlag) const
+{
 	DLorentzVector locFinalStateP4;
 	const DParticleComboStep* locParticleComboStep = locParticleCombo->Get_ParticleComboStep(locStepIndex);
 	if(locParticleComboStep == NULL)
@@ -938,12 +995,12 @@ DLorentzVector DAnalysisUtilities::Calc_FinalStateP4(const DReaction* locReactio
 		{
 			//measured results, or not constrained by kinfit (either non-fixed mass or excluded from kinfit)
 			if((!locUseKinFitDataFlag) || (!IsFixedMass(locReactionStep->Get_FinalPID(loc_i))))
-				locFinalStateP4 += Calc_FinalStateP4(locReaction, locParticleCombo, locDecayStepIndex, set<size_t>(), locSourceObjects, locUseKinFitDataFlag);
+				locFinalStateP4 += Calc_FinalStateP4_DecayChain(locReaction, locParticleCombo, locDecayStepIndex, set<size_t>(), locSourceObjects, locUseKinFitDataFlag);
 			else //want kinfit results, and decaying particle p4 is constrained by kinfit
 			{
 				locFinalStateP4 += locParticles[loc_i]->lorentzMomentum();
 				//still need source objects of decay products! dive down anyway, but ignore p4 result
-				Calc_FinalStateP4(locReaction, locParticleCombo, locDecayStepIndex, set<size_t>(), locSourceObjects, locUseKinFitDataFlag);
+				Calc_FinalStateP4_DecayChain(locReaction, locParticleCombo, locDecayStepIndex, set<size_t>(), locSourceObjects, locUseKinFitDataFlag);
 			}
 		}
 		else //detected particle
@@ -59,6 +59,7 @@ class DAnalysisUtilities : public JObject
  
 		// Constructor and destructor
 		DAnalysisUtilities(JEventLoop *loop);
+		~DAnalysisUtilities(void);
 
 		bool Check_IsBDTSignalEvent(JEventLoop* locEventLoop, const DReaction* locReaction, bool locExclusiveMatchFlag, bool locIncludeDecayingToReactionFlag) const;
 		void Replace_DecayingParticleWithProducts(deque<pair<const DMCThrown*, deque<const DMCThrown*> > >& locThrownSteps, size_t locStepIndex) const;
@@ -134,6 +135,10 @@ class DAnalysisUtilities : public JObject
 		DVector3 Calc_CrudeVertex(const vector<const DChargedTrackHypothesis*>& locParticles) const;
 		DVector3 Calc_CrudeVertex(const vector<const DTrackTimeBased*>& locParticles) const;
 
+		//p4 calculations avoided by the per-combo cache (see DParticleComboP4Cache)
+		size_t Get_NumP4CacheHits(void) const{return dNumP4CacheHits;}
+		size_t Get_NumP4CacheMisses(void) const{return dNumP4CacheMisses;}
+
 		set<set<size_t> > Build_IndexCombos(const DReactionStep* locReactionStep, deque<Particle_t> locToIncludePIDs) const;
 
 		//For handling helical tracks
@@ -146,6 +151,9 @@ class DAnalysisUtilities : public JObject
 
 	private:
 
+		DLorentzVector Calc_MissingP4_DecayChain(const DReaction* locReaction, const DParticleCombo* locParticleCombo, size_t locStepIndex, int locUpToStepIndex, const set<size_t>& locUpThroughIndices, set<pair<const JObject*, unsigned int> >& locSourceObjects, bool locUseKinFitDataFlag) const;
+		DLorentzVector Calc_FinalStateP4_DecayChain(const DReaction* locReaction, const DParticleCombo* locParticleCombo, size_t locStepIndex, const set<size_t>& locToIncludeIndices, set<pair<const JObject*, unsigned int> >& locSourceObjects, bool locUseKinFitDataFlag) const;
+
 		bool Handle_Decursion(int& locParticleIndex, deque<size_t>& locComboDeque, deque<int>& locResumeAtIndices, deque<deque<size_t> >& locPossibilities) const;
 
 		string dTrackSelectionTag;
@@ -159,6 +167,10 @@ class DAnalysisUtilities : public JObject
 
 		bool dIsNoFieldFlag;
 
+		bool dUseP4CacheFlag;
+		mutable size_t dNumP4CacheHits = 0;
+		mutable size_t dNumP4CacheMisses = 0;
+
 		int DEBUG_LEVEL;
 };
 
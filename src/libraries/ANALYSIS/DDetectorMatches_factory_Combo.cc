@@ -30,8 +30,13 @@ jerror_t DDetectorMatches_factory_Combo::brun(jana::JEventLoop *locEventLoop, in
 
 double DDetectorMatches_factory_Combo::Calc_PVariance(const DTrackTimeBased* locTrack) const
 {
-	TMatrixFSym locTrackingMatrix = *(locTrack->errorMatrix().get());
-	locTrackingMatrix.ResizeTo(3, 3);
+	TMatrixFSym locTrackingMatrix(3);
+	const DMatrixFSym7& locErrorMatrix = *(locTrack->errorMatrix());
+	for(int loc_i = 0; loc_i < 3; ++loc_i)
+	{
+		for(int loc_j = 0; loc_j < 3; ++loc_j)
+			locTrackingMatrix(loc_i, loc_j) = locErrorMatrix(loc_i, loc_j);
+	}
 
 	TMatrixD locJacobian(1, 3);
 	DVector3 locUnitP = locTrack->momentum().Unit();
@@ -104,6 +104,12 @@ void DEventWriterROOT::Create_ThrownTree(JEventLoop* locEventLoop, string locOut
 	if(dThrownTreeInterface != nullptr)
 		return; //Already setup for this thread!
 	dThrownTreeInterface = DTreeInterface::Create_DTreeInterface("Thrown_Tree", locOutputFileName); //set up this thread
+
+	//branch handles for this thread's fill data
+	dThrownTreeBranchHandles.dRunNumber = dThrownTreeFillData.Get_BranchHandle<UInt_t>("RunNumber");
+	dThrownTreeBranchHandles.dEventNumber = dThrownTreeFillData.Get_BranchHandle<ULong64_t>("EventNumber");
+	Create_BranchHandles_Thrown(&dThrownTreeFillData, dThrownTreeBranchHandles.dThrown, true);
+
 	if(dThrownTreeInterface->Get_BranchesCreatedFlag())
 		return; //branches already created: return
 
@@ -146,7 +152,10 @@ void DEventWriterROOT::Create_DataTree(const DReaction* locReaction, JEventLoop*
 	DTreeInterface* locTreeInterface = DTreeInterface::Create_DTreeInterface(locTreeName, locOutputFileName);
 	dTreeInterfaceMap[locReaction] = locTreeInterface;
 	if(locTreeInterface->Get_BranchesCreatedFlag())
+	{
+		Create_BranchHandles_DataTree(locReaction, locIsMCDataFlag);
 		return; //branches already created, then return
+	}
 
 	//Branch register
 	DTreeBranchRegister locBranchRegister;
@@ -189,6 +198,226 @@ void DEventWriterROOT::Create_DataTree(const DReaction* locReaction, JEventLoop*
 	//Create branches
 	locTreeInterface->Create_Branches(locBranchRegister);
 	locTreeInterface->Set_TreeIndexBranchNames("RunNumber", "EventNumber");
+
+	Create_BranchHandles_DataTree(locReaction, locIsMCDataFlag);
+}
+
+void DEventWriterROOT::Create_BranchHandles_DataTree(const DReaction* locReaction, bool locIsMCDataFlag)
+{
+	//Resolve the handles for all of the default branches once, so that filling is done by index rather than by branch name
+	DTreeFillData* locTreeFillData = dTreeFillDataMap[locReaction];
+	DDataTreeBranchHandles_t& locBranchHandles = dTreeBranchHandlesMap[locReaction];
+
+	//event-wide
+	locBranchHandles.dRunNumber = locTreeFillData->Get_BranchHandle<UInt_t>("RunNumber");
+	locBranchHandles.dEventNumber = locTreeFillData->Get_BranchHandle<ULong64_t>("EventNumber");
+	locBranchHandles.dL1TriggerBits = locTreeFillData->Get_BranchHandle<UInt_t>("L1TriggerBits");
+	locBranchHandles.dX4_Production = locTreeFillData->Get_BranchHandle<TLorentzVector>("X4_Production");
+	if(locIsMCDataFlag)
+	{
+		Create_BranchHandles_Thrown(locTreeFillData, locBranchHandles.dThrown, false);
+		locBranchHandles.dIsThrownTopology = locTreeFillData->Get_BranchHandle<Bool_t>("IsThrownTopology");
+	}
+
+	//beam
+	auto& locBeamHandles = locBranchHandles.dBeam;
+	locBranchHandles.dNumBeam = locTreeFillData->Get_BranchHandle<UInt_t>("NumBeam");
+	locBeamHandles.dPID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName("Beam", "PID"));
+	locBeamHandles.dIsGenerator = locTreeFillData->Get_BranchHandle<Bool_t>(Build_BranchName("Beam", "IsGenerator"));
+	locBeamHandles.dX4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName("Beam", "X4_Measured"));
+	locBeamHandles.dP4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName("Beam", "P4_Measured"));
+
+	//charged hypotheses
+	string locParticleBranchName = "ChargedHypo";
+	auto& locChargedHandles = locBranchHandles.dChargedHypo;
+	locBranchHandles.dNumChargedHypos = locTreeFillData->Get_BranchHandle<UInt_t>("NumChargedHypos");
+	locChargedHandles.dTrackID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "TrackID"));
+	locChargedHandles.dPID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "PID"));
+	locChargedHandles.dThrownIndex = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "ThrownIndex"));
+	locChargedHandles.dX4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Measured"));
+	locChargedHandles.dP4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_Measured"));
+	locChargedHandles.dNDF_Tracking = locTreeFillData->Get_BranchHandle<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_Tracking"));
+	locChargedHandles.dChiSq_Tracking = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Tracking"));
+	locChargedHandles.dNDF_DCdEdx = locTreeFillData->Get_BranchHandle<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_DCdEdx"));
+	locChargedHandles.dChiSq_DCdEdx = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_DCdEdx"));
+	locChargedHandles.ddEdx_CDC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_CDC"));
+	locChargedHandles.ddEdx_CDC_integral = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_CDC_integral"));
+	locChargedHandles.ddEdx_FDC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_FDC"));
+	locChargedHandles.ddEdx_TOF = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_TOF"));
+	locChargedHandles.ddEdx_ST = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_ST"));
+	locChargedHandles.dEnergy_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCAL"));
+	locChargedHandles.dEnergy_BCALPreshower = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALPreshower"));
+	locChargedHandles.dEnergy_BCALLayer2 = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer2"));
+	locChargedHandles.dEnergy_BCALLayer3 = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer3"));
+	locChargedHandles.dEnergy_BCALLayer4 = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer4"));
+	locChargedHandles.dEnergy_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_FCAL"));
+	locChargedHandles.dSigLong_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SigLong_BCAL"));
+	locChargedHandles.dSigTheta_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SigTheta_BCAL"));
+	locChargedHandles.dSigTrans_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SigTrans_BCAL"));
+	locChargedHandles.dRMSTime_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "RMSTime_BCAL"));
+	locChargedHandles.dE1E9_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "E1E9_FCAL"));
+	locChargedHandles.dE9E25_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "E9E25_FCAL"));
+	locChargedHandles.dSumU_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SumU_FCAL"));
+	locChargedHandles.dSumV_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SumV_FCAL"));
+	locChargedHandles.dHitTime = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "HitTime"));
+	locChargedHandles.dRFDeltaTVar = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "RFDeltaTVar"));
+	locChargedHandles.dBeta_Timing = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing"));
+	locChargedHandles.dChiSq_Timing = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing"));
+	locChargedHandles.dNDF_Timing = locTreeFillData->Get_BranchHandle<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_Timing"));
+	locChargedHandles.dTrackBCAL_DeltaPhi = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaPhi"));
+	locChargedHandles.dTrackBCAL_DeltaZ = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaZ"));
+	locChargedHandles.dTrackFCAL_DOCA = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "TrackFCAL_DOCA"));
+	locChargedHandles.dNumPhotons_DIRC = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "NumPhotons_DIRC"));
+	locChargedHandles.dExtrapolatedX_DIRC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ExtrapolatedX_DIRC"));
+	locChargedHandles.dExtrapolatedY_DIRC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ExtrapolatedY_DIRC"));
+	locChargedHandles.dThetaC_DIRC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ThetaC_DIRC"));
+	locChargedHandles.dLele_DIRC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Lele_DIRC"));
+	locChargedHandles.dLpi_DIRC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Lpi_DIRC"));
+	locChargedHandles.dLk_DIRC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Lk_DIRC"));
+	locChargedHandles.dLp_DIRC = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Lp_DIRC"));
+
+	//neutral hypotheses
+	locParticleBranchName = "NeutralHypo";
+	auto& locNeutralHandles = locBranchHandles.dNeutralHypo;
+	locBranchHandles.dNumNeutralHypos = locTreeFillData->Get_BranchHandle<UInt_t>("NumNeutralHypos");
+	locNeutralHandles.dNeutralID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "NeutralID"));
+	locNeutralHandles.dPID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "PID"));
+	locNeutralHandles.dThrownIndex = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "ThrownIndex"));
+	locNeutralHandles.dX4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Measured"));
+	locNeutralHandles.dP4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_Measured"));
+	locNeutralHandles.dX4_Shower = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Shower"));
+	locNeutralHandles.dBeta_Timing = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing"));
+	locNeutralHandles.dChiSq_Timing = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing"));
+	locNeutralHandles.dNDF_Timing = locTreeFillData->Get_BranchHandle<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_Timing"));
+	locNeutralHandles.dShowerQuality = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ShowerQuality"));
+	locNeutralHandles.dEnergy_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCAL"));
+	locNeutralHandles.dEnergy_BCALPreshower = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALPreshower"));
+	locNeutralHandles.dEnergy_BCALLayer2 = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer2"));
+	locNeutralHandles.dEnergy_BCALLayer3 = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer3"));
+	locNeutralHandles.dEnergy_BCALLayer4 = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer4"));
+	locNeutralHandles.dEnergy_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_FCAL"));
+	locNeutralHandles.dEnergy_CCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Energy_CCAL"));
+	locNeutralHandles.dSigLong_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SigLong_BCAL"));
+	locNeutralHandles.dSigTheta_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SigTheta_BCAL"));
+	locNeutralHandles.dSigTrans_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SigTrans_BCAL"));
+	locNeutralHandles.dRMSTime_BCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "RMSTime_BCAL"));
+	locNeutralHandles.dE1E9_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "E1E9_FCAL"));
+	locNeutralHandles.dE9E25_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "E9E25_FCAL"));
+	locNeutralHandles.dSumU_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SumU_FCAL"));
+	locNeutralHandles.dSumV_FCAL = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "SumV_FCAL"));
+	locNeutralHandles.dTrackBCAL_DeltaPhi = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaPhi"));
+	locNeutralHandles.dTrackBCAL_DeltaZ = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaZ"));
+	locNeutralHandles.dTrackFCAL_DOCA = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "TrackFCAL_DOCA"));
+	locNeutralHandles.dPhotonRFDeltaTVar = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "PhotonRFDeltaTVar"));
+
+	//combos
+	locBranchHandles.dNumUnusedTracks = locTreeFillData->Get_BranchHandle<UChar_t>("NumUnusedTracks");
+	locBranchHandles.dNumCombos = locTreeFillData->Get_BranchHandle<UInt_t>("NumCombos");
+	locBranchHandles.dIsComboCut = locTreeFillData->Get_BranchHandle<Bool_t>("IsComboCut");
+	if(locIsMCDataFlag)
+	{
+		locBranchHandles.dIsTrueCombo = locTreeFillData->Get_BranchHandle<Bool_t>("IsTrueCombo");
+		locBranchHandles.dIsBDTSignalCombo = locTreeFillData->Get_BranchHandle<Bool_t>("IsBDTSignalCombo");
+	}
+	locBranchHandles.dRFTime_Measured = locTreeFillData->Get_BranchHandle<Float_t>("RFTime_Measured");
+	locBranchHandles.dChiSq_KinFit = locTreeFillData->Get_BranchHandle<Float_t>("ChiSq_KinFit");
+	locBranchHandles.dNDF_KinFit = locTreeFillData->Get_BranchHandle<UInt_t>("NDF_KinFit");
+	locBranchHandles.dRFTime_KinFit = locTreeFillData->Get_BranchHandle<Float_t>("RFTime_KinFit");
+	locBranchHandles.dNumUnusedShowers = locTreeFillData->Get_BranchHandle<UChar_t>("NumUnusedShowers");
+	locBranchHandles.dEnergy_UnusedShowers = locTreeFillData->Get_BranchHandle<Float_t>("Energy_UnusedShowers");
+	locBranchHandles.dNumUnusedShowers_Quality = locTreeFillData->Get_BranchHandle<UChar_t>("NumUnusedShowers_Quality");
+	locBranchHandles.dEnergy_UnusedShowers_Quality = locTreeFillData->Get_BranchHandle<Float_t>("Energy_UnusedShowers_Quality");
+	locBranchHandles.dSumPMag_UnusedTracks = locTreeFillData->Get_BranchHandle<Float_t>("SumPMag_UnusedTracks");
+	locBranchHandles.dSumP3_UnusedTracks = locTreeFillData->Get_BranchHandle<TVector3>("SumP3_UnusedTracks");
+
+	//combo beam
+	auto& locComboBeamHandles = locBranchHandles.dComboBeam;
+	locComboBeamHandles.dBeamIndex = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName("ComboBeam", "BeamIndex"));
+	locComboBeamHandles.dX4_KinFit = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName("ComboBeam", "X4_KinFit"));
+	locComboBeamHandles.dP4_KinFit = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName("ComboBeam", "P4_KinFit"));
+
+	//combo particles: names are from the PositionToNameMap (created with the tree, maybe by another thread)
+	const TList* locUserInfo = dTreeInterfaceMap[locReaction]->Get_UserInfo();
+	const TMap* locPositionToNameMap = (TMap*)locUserInfo->FindObject("PositionToNameMap");
+
+	size_t locNumSteps = locReaction->Get_NumReactionSteps();
+	locBranchHandles.dComboDecayingHandles.resize(locNumSteps);
+	locBranchHandles.dComboFinalHandles.resize(locNumSteps);
+	for(size_t loc_i = 0; loc_i < locNumSteps; ++loc_i)
+	{
+		const DReactionStep* locReactionStep = locReaction->Get_ReactionStep(loc_i);
+
+		//initial particle: if decaying
+		if((loc_i != 0) || (locReactionStep->Get_InitialPID() == Unknown))
+		{
+			ostringstream locPositionStream;
+			locPositionStream << loc_i << "_-1";
+			TObjString* locObjString = (TObjString*)locPositionToNameMap->GetValue(locPositionStream.str().c_str());
+			if(locObjString != NULL)
+				Create_BranchHandles_ComboParticle(locTreeFillData, (const char*)(locObjString->GetString()), locBranchHandles.dComboDecayingHandles[loc_i]);
+		}
+
+		//final particles: if not decaying
+		auto locFinalParticleIDs = locReactionStep->Get_FinalPIDs();
+		locBranchHandles.dComboFinalHandles[loc_i].resize(locFinalParticleIDs.size());
+		for(size_t loc_j = 0; loc_j < locFinalParticleIDs.size(); ++loc_j)
+		{
+			if(DAnalysis::Get_DecayStepIndex(locReaction, loc_i, loc_j) >= 0)
+				continue; //decaying particle
+
+			ostringstream locPositionStream;
+			locPositionStream << loc_i << "_" << loc_j;
+			TObjString* locObjString = (TObjString*)locPositionToNameMap->GetValue(locPositionStream.str().c_str());
+			if(locObjString != NULL)
+				Create_BranchHandles_ComboParticle(locTreeFillData, (const char*)(locObjString->GetString()), locBranchHandles.dComboFinalHandles[loc_i][loc_j]);
+		}
+	}
+}
+
+void DEventWriterROOT::Create_BranchHandles_Thrown(DTreeFillData* locTreeFillData, DThrownBranchHandles_t& locBranchHandles, bool locIsOnlyThrownFlag) const
+{
+	locBranchHandles.dMCWeight = locTreeFillData->Get_BranchHandle<Float_t>("MCWeight");
+
+	//BEAM
+	locBranchHandles.dThrownBeam_PID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName("ThrownBeam", "PID"));
+	locBranchHandles.dThrownBeam_GeneratedEnergy = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName("ThrownBeam", "GeneratedEnergy"));
+	locBranchHandles.dThrownBeam_X4 = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName("ThrownBeam", "X4"));
+	locBranchHandles.dThrownBeam_P4 = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName("ThrownBeam", "P4"));
+
+	//EVENT-WIDE INFO
+	locBranchHandles.dNumThrown = locTreeFillData->Get_BranchHandle<UInt_t>("NumThrown");
+	locBranchHandles.dNumPIDThrown_FinalState = locTreeFillData->Get_BranchHandle<ULong64_t>("NumPIDThrown_FinalState");
+	locBranchHandles.dPIDThrown_Decaying = locTreeFillData->Get_BranchHandle<ULong64_t>("PIDThrown_Decaying");
+
+	//PRODUCTS
+	string locParticleBranchName = "Thrown";
+	locBranchHandles.dParentIndex = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "ParentIndex"));
+	locBranchHandles.dPID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "PID"));
+	if(!locIsOnlyThrownFlag)
+	{
+		locBranchHandles.dMatchID = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "MatchID"));
+		locBranchHandles.dMatchFOM = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "MatchFOM"));
+	}
+	locBranchHandles.dX4 = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4"));
+	locBranchHandles.dP4 = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4"));
+}
+
+void DEventWriterROOT::Create_BranchHandles_ComboParticle(DTreeFillData* locTreeFillData, string locParticleBranchName, DComboParticleBranchHandles_t& locBranchHandles) const
+{
+	//superset for all particle types: only the ones that exist for this particle get filled
+	locBranchHandles.dChargedIndex = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "ChargedIndex"));
+	locBranchHandles.dNeutralIndex = locTreeFillData->Get_BranchHandle<Int_t>(Build_BranchName(locParticleBranchName, "NeutralIndex"));
+	locBranchHandles.dX4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Measured"));
+	locBranchHandles.dP4_Measured = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_Measured"));
+	locBranchHandles.dBeta_Timing_Measured = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing_Measured"));
+	locBranchHandles.dChiSq_Timing_Measured = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing_Measured"));
+	locBranchHandles.dBeta_Timing_KinFit = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing_KinFit"));
+	locBranchHandles.dChiSq_Timing_KinFit = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing_KinFit"));
+	locBranchHandles.dX4_KinFit = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_KinFit"));
+	locBranchHandles.dP4_KinFit = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_KinFit"));
+	locBranchHandles.dX4 = locTreeFillData->Get_BranchHandle<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4"));
+	locBranchHandles.dPathLengthSigma = locTreeFillData->Get_BranchHandle<Float_t>(Build_BranchName(locParticleBranchName, "PathLengthSigma"));
+	locBranchHandles.dIsPhotonFlag = (locParticleBranchName.substr(0, 6) == "Photon");
 }
 
 TMap* DEventWriterROOT::Create_UserInfoMaps(DTreeBranchRegister& locBranchRegister, JEventLoop* locEventLoop, const DReaction* locReaction) const
@@ -967,11 +1196,11 @@ void DEventWriterROOT::Fill_ThrownTree(JEventLoop* locEventLoop) const
 	japp->RootWriteLock();
 
 	//primary event info
-	dThrownTreeFillData.Fill_Single<UInt_t>("RunNumber", locEventLoop->GetJEvent().GetRunNumber());
-	dThrownTreeFillData.Fill_Single<ULong64_t>("EventNumber", locEventLoop->GetJEvent().GetEventNumber());
+	dThrownTreeFillData.Fill_Single<UInt_t>(dThrownTreeBranchHandles.dRunNumber, locEventLoop->GetJEvent().GetRunNumber());
+	dThrownTreeFillData.Fill_Single<ULong64_t>(dThrownTreeBranchHandles.dEventNumber, locEventLoop->GetJEvent().GetEventNumber());
 
 	//throwns
-	Fill_ThrownInfo(&dThrownTreeFillData, locMCReaction, locTaggedMCGenBeam, locMCThrownsToSave, locThrownIndexMap, locNumPIDThrown_FinalState, locPIDThrown_Decaying);
+	Fill_ThrownInfo(&dThrownTreeFillData, dThrownTreeBranchHandles.dThrown, locMCReaction, locTaggedMCGenBeam, locMCThrownsToSave, locThrownIndexMap, locNumPIDThrown_FinalState, locPIDThrown_Decaying);
 
 	//Custom Branches
 	Fill_CustomBranches_ThrownTree(&dThrownTreeFillData, locEventLoop, locMCReaction, locMCThrownsToSave);
@@ -1171,76 +1400,77 @@ void DEventWriterROOT::Fill_DataTree(JEventLoop* locEventLoop, const DReaction*
 
 	//Get tree fill data
 	DTreeFillData* locTreeFillData = dTreeFillDataMap.find(locReaction)->second;
+	const DDataTreeBranchHandles_t& locBranchHandles = dTreeBranchHandlesMap.find(locReaction)->second;
 
 	//PRIMARY EVENT INFO
-	locTreeFillData->Fill_Single<UInt_t>("RunNumber", locEventLoop->GetJEvent().GetRunNumber());
-	locTreeFillData->Fill_Single<ULong64_t>("EventNumber", locEventLoop->GetJEvent().GetEventNumber());
-	locTreeFillData->Fill_Single<UInt_t>("L1TriggerBits", locTrigger->Get_L1TriggerBits());
+	locTreeFillData->Fill_Single<UInt_t>(locBranchHandles.dRunNumber, locEventLoop->GetJEvent().GetRunNumber());
+	locTreeFillData->Fill_Single<ULong64_t>(locBranchHandles.dEventNumber, locEventLoop->GetJEvent().GetEventNumber());
+	locTreeFillData->Fill_Single<UInt_t>(locBranchHandles.dL1TriggerBits, locTrigger->Get_L1TriggerBits());
 
 	//PRODUCTION X4
 	DLorentzVector locProductionX4 = locVertex->dSpacetimeVertex;
 	TLorentzVector locProductionTX4(locProductionX4.X(), locProductionX4.Y(), locProductionX4.Z(), locProductionX4.T());
-	locTreeFillData->Fill_Single<TLorentzVector>("X4_Production", locProductionTX4);
+	locTreeFillData->Fill_Single<TLorentzVector>(locBranchHandles.dX4_Production, locProductionTX4);
 
 	//THROWN INFORMATION
 	if(locMCReaction != NULL)
 	{
-		Fill_ThrownInfo(locTreeFillData, locMCReaction, locTaggedMCGenBeam, locMCThrownsToSave, locThrownIndexMap, locNumPIDThrown_FinalState, locPIDThrown_Decaying, locMCThrownMatching);
-		locTreeFillData->Fill_Single<Bool_t>("IsThrownTopology", locIsThrownTopologyFlag);
+		Fill_ThrownInfo(locTreeFillData, locBranchHandles.dThrown, locMCReaction, locTaggedMCGenBeam, locMCThrownsToSave, locThrownIndexMap, locNumPIDThrown_FinalState, locPIDThrown_Decaying, locMCThrownMatching);
+		locTreeFillData->Fill_Single<Bool_t>(locBranchHandles.dIsThrownTopology, locIsThrownTopologyFlag);
 	}
 
 	//INDEPENDENT BEAM PARTICLES
 	if(locBeamUsedFlag)
 	{
 		//however, only fill with beam particles that are in the combos
-		locTreeFillData->Fill_Single<UInt_t>("NumBeam", UInt_t(locBeamPhotons.size()));
+		locTreeFillData->Fill_Single<UInt_t>(locBranchHandles.dNumBeam, UInt_t(locBeamPhotons.size()));
 		for(size_t loc_i = 0; loc_i < locBeamPhotons.size(); ++loc_i)
-			Fill_BeamData(locTreeFillData, loc_i, locBeamPhotons[loc_i], locVertex, locMCThrownMatching);
+			Fill_BeamData(locTreeFillData, locBranchHandles.dBeam, loc_i, locBeamPhotons[loc_i], locVertex, locMCThrownMatching);
 	}
 
 	//INDEPENDENT CHARGED TRACKS
-	locTreeFillData->Fill_Single<UInt_t>("NumChargedHypos", UInt_t(locChargedTrackHypotheses.size()));
+	locTreeFillData->Fill_Single<UInt_t>(locBranchHandles.dNumChargedHypos, UInt_t(locChargedTrackHypotheses.size()));
 	for(size_t loc_i = 0; loc_i < locChargedTrackHypotheses.size(); ++loc_i)
-		Fill_ChargedHypo(locTreeFillData, loc_i, locChargedTrackHypotheses[loc_i], locMCThrownMatching, locThrownIndexMap, locDetectorMatches);
+		Fill_ChargedHypo(locTreeFillData, locBranchHandles.dChargedHypo, loc_i, locChargedTrackHypotheses[loc_i], locMCThrownMatching, locThrownIndexMap, locDetectorMatches);
 
 	//INDEPENDENT NEUTRAL PARTICLES
-	locTreeFillData->Fill_Single<UInt_t>("NumNeutralHypos", UInt_t(locNeutralParticleHypotheses.size()));
+	locTreeFillData->Fill_Single<UInt_t>(locBranchHandles.dNumNeutralHypos, UInt_t(locNeutralParticleHypotheses.size()));
 	for(size_t loc_i = 0; loc_i < locNeutralParticleHypotheses.size(); ++loc_i)
-		Fill_NeutralHypo(locTreeFillData, loc_i, locNeutralParticleHypotheses[loc_i], locMCThrownMatching, locThrownIndexMap, locDetectorMatches);
+		Fill_NeutralHypo(locTreeFillData, locBranchHandles.dNeutralHypo, loc_i, locNeutralParticleHypotheses[loc_i], locMCThrownMatching, locThrownIndexMap, locDetectorMatches);
 
 	//UNUSED TRACKS
 	double locSumPMag_UnusedTracks = 0.0;
 	TVector3 locSumP3_UnusedTracks;
 	int locNumUnusedTracks = dAnalysisUtilities->Calc_Momentum_UnusedTracks(locEventLoop, locParticleCombos[0], locSumPMag_UnusedTracks, locSumP3_UnusedTracks);
-	locTreeFillData->Fill_Single<UChar_t>("NumUnusedTracks", locNumUnusedTracks);
+	locTreeFillData->Fill_Single<UChar_t>(locBranchHandles.dNumUnusedTracks, locNumUnusedTracks);
 
 	//COMBOS
-	locTreeFillData->Fill_Single<UInt_t>("NumCombos", UInt_t(locParticleCombos.size()));
+	locTreeFillData->Fill_Single<UInt_t>(locBranchHandles.dNumCombos, UInt_t(locParticleCombos.size()));
 	for(size_t loc_i = 0; loc_i < locParticleCombos.size(); ++loc_i)
 	{
-		Fill_ComboData(locTreeFillData, locReaction, locParticleCombos[loc_i], loc_i, locObjectToArrayIndexMap);
+		Fill_ComboData(locTreeFillData, locBranchHandles, locReaction, locParticleCombos[loc_i], loc_i, locObjectToArrayIndexMap);
 		
 		//ENERGY OF UNUSED SHOWERS (access to event loop required)
 		double locEnergy_UnusedShowers = 0.;
 		double locEnergy_UnusedShowers_Quality = 0.;
 		int locNumber_UnusedShowers_Quality = 0;
 		int locNumber_UnusedShowers = dAnalysisUtilities->Calc_Energy_UnusedShowers(locEventLoop, locParticleCombos[loc_i], locEnergy_UnusedShowers, locNumber_UnusedShowers_Quality, locEnergy_UnusedShowers_Quality);
-		locTreeFillData->Fill_Array<UChar_t>("NumUnusedShowers", locNumber_UnusedShowers, loc_i);
-		locTreeFillData->Fill_Array<Float_t>("Energy_UnusedShowers", locEnergy_UnusedShowers, loc_i);
-		locTreeFillData->Fill_Array<UChar_t>("NumUnusedShowers_Quality", locNumber_UnusedShowers_Quality, loc_i);
-		locTreeFillData->Fill_Array<Float_t>("Energy_UnusedShowers_Quality", locEnergy_UnusedShowers_Quality, loc_i);
+		locTreeFillData->Fill_Array<UChar_t>(locBranchHandles.dNumUnusedShowers, locNumber_UnusedShowers, loc_i);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_UnusedShowers, locEnergy_UnusedShowers, loc_i);
+		locTreeFillData->Fill_Array<UChar_t>(locBranchHandles.dNumUnusedShowers_Quality, locNumber_UnusedShowers_Quality, loc_i);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_UnusedShowers_Quality, locEnergy_UnusedShowers_Quality, loc_i);
 
 		//MOMENTUM OF UNUSED TRACKS (access to event loop required)
 		double locSumPMag_UnusedTracks = 0;
 		TVector3 locSumP3_UnusedTracks;
 		dAnalysisUtilities->Calc_Momentum_UnusedTracks(locEventLoop, locParticleCombos[loc_i], locSumPMag_UnusedTracks, locSumP3_UnusedTracks);
-		locTreeFillData->Fill_Array<Float_t>("SumPMag_UnusedTracks", locSumPMag_UnusedTracks, loc_i);
-		locTreeFillData->Fill_Array<TVector3>("SumP3_UnusedTracks", locSumP3_UnusedTracks, loc_i);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSumPMag_UnusedTracks, locSumPMag_UnusedTracks, loc_i);
+		locTreeFillData->Fill_Array<TVector3>(locBranchHandles.dSumP3_UnusedTracks, locSumP3_UnusedTracks, loc_i);
 
 		if(locMCReaction != NULL)
 		{
-			locTreeFillData->Fill_Array<Bool_t>("IsTrueCombo", locIsTrueComboFlags[loc_i], loc_i);
-			locTreeFillData->Fill_Array<Bool_t>("IsBDTSignalCombo", locIsTrueComboFlags[loc_i], loc_i);
+			locTreeFillData->Fill_Array<Bool_t>(locBranchHandles.dIsTrueCombo, locIsTrueComboFlags[loc_i], loc_i);
+			locTreeFillData->Fill_Array<Bool_t>(locBranchHandles.dIsBDTSignalCombo, locIsTrueComboFlags[loc_i], loc_i);
 		}
 	}
 
@@ -1435,39 +1665,37 @@ void DEventWriterROOT::Group_ThrownParticles(const vector<const DMCThrown*>& loc
 		locThrownIndexMap[locMCThrownsToSave[loc_i]] = loc_i;
 }
 
-void DEventWriterROOT::Fill_ThrownInfo(DTreeFillData* locTreeFillData, const DMCReaction* locMCReaction, const DBeamPhoton* locTaggedMCGenBeam, const vector<const DMCThrown*>& locMCThrowns, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, ULong64_t locNumPIDThrown_FinalState, ULong64_t locPIDThrown_Decaying, const DMCThrownMatching* locMCThrownMatching) const
+void DEventWriterROOT::Fill_ThrownInfo(DTreeFillData* locTreeFillData, const DThrownBranchHandles_t& locBranchHandles, const DMCReaction* locMCReaction, const DBeamPhoton* locTaggedMCGenBeam, const vector<const DMCThrown*>& locMCThrowns, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, ULong64_t locNumPIDThrown_FinalState, ULong64_t locPIDThrown_Decaying, const DMCThrownMatching* locMCThrownMatching) const
 {
 	//THIS MUST BE CALLED FROM WITHIN A LOCK, SO DO NOT PASS IN JEVENTLOOP! //TOO TEMPTING TO DO SOMETHING BAD
 
 	//WEIGHT
-	locTreeFillData->Fill_Single<Float_t>("MCWeight", locMCReaction->weight);
+	locTreeFillData->Fill_Single<Float_t>(locBranchHandles.dMCWeight, locMCReaction->weight);
 
 	//THROWN BEAM
-	locTreeFillData->Fill_Single<Int_t>(Build_BranchName("ThrownBeam", "PID"), PDGtype(locMCReaction->beam.PID()));
-	locTreeFillData->Fill_Single<Float_t>(Build_BranchName("ThrownBeam", "GeneratedEnergy"), locMCReaction->beam.energy());
+	locTreeFillData->Fill_Single<Int_t>(locBranchHandles.dThrownBeam_PID, PDGtype(locMCReaction->beam.PID()));
+	locTreeFillData->Fill_Single<Float_t>(locBranchHandles.dThrownBeam_GeneratedEnergy, locMCReaction->beam.energy());
 
 	DVector3 locThrownBeamX3 = locMCReaction->beam.position();
 	TLorentzVector locThrownBeamTX4(locThrownBeamX3.X(), locThrownBeamX3.Y(), locThrownBeamX3.Z(), locMCReaction->beam.time());
-	locTreeFillData->Fill_Single<TLorentzVector>(Build_BranchName("ThrownBeam", "X4"), locThrownBeamTX4);
+	locTreeFillData->Fill_Single<TLorentzVector>(locBranchHandles.dThrownBeam_X4, locThrownBeamTX4);
 
 	DLorentzVector locThrownBeamP4 = locTaggedMCGenBeam->lorentzMomentum();
 	TLorentzVector locThrownBeamTP4(locThrownBeamP4.Px(), locThrownBeamP4.Py(), locThrownBeamP4.Pz(), locThrownBeamP4.E());
-	locTreeFillData->Fill_Single<TLorentzVector>(Build_BranchName("ThrownBeam", "P4"), locThrownBeamTP4);
+	locTreeFillData->Fill_Single<TLorentzVector>(locBranchHandles.dThrownBeam_P4, locThrownBeamTP4);
 
 	//THROWN PRODUCTS
-	locTreeFillData->Fill_Single<UInt_t>("NumThrown", locMCThrowns.size());
+	locTreeFillData->Fill_Single<UInt_t>(locBranchHandles.dNumThrown, locMCThrowns.size());
 	for(size_t loc_i = 0; loc_i < locMCThrowns.size(); ++loc_i)
-		Fill_ThrownParticleData(locTreeFillData, loc_i, locMCThrowns[loc_i], locThrownIndexMap, locMCThrownMatching);
+		Fill_ThrownParticleData(locTreeFillData, locBranchHandles, loc_i, locMCThrowns[loc_i], locThrownIndexMap, locMCThrownMatching);
 
 	//PID INFO
-	locTreeFillData->Fill_Single<ULong64_t>("NumPIDThrown_FinalState", locNumPIDThrown_FinalState);
-	locTreeFillData->Fill_Single<ULong64_t>("PIDThrown_Decaying", locPIDThrown_Decaying);
+	locTreeFillData->Fill_Single<ULong64_t>(locBranchHandles.dNumPIDThrown_FinalState, locNumPIDThrown_FinalState);
+	locTreeFillData->Fill_Single<ULong64_t>(locBranchHandles.dPIDThrown_Decaying, locPIDThrown_Decaying);
 }
 
-void DEventWriterROOT::Fill_ThrownParticleData(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DMCThrown* locMCThrown, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DMCThrownMatching* locMCThrownMatching) const
+void DEventWriterROOT::Fill_ThrownParticleData(DTreeFillData* locTreeFillData, const DThrownBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DMCThrown* locMCThrown, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DMCThrownMatching* locMCThrownMatching) const
 {
-	string locParticleBranchName = "Thrown";
-
 	//IDENTIFIERS
 	int locParentIndex = -1; //e.g. photoproduced
 	map<const DMCThrown*, unsigned int>::const_iterator locIterator;
@@ -1478,8 +1706,8 @@ void DEventWriterROOT::Fill_ThrownParticleData(DTreeFillData* locTreeFillData, u
 		locParentIndex = locIterator->second;
 		break;
 	}
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "ParentIndex"), locParentIndex, locArrayIndex);
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "PID"), locMCThrown->pdgtype, locArrayIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dParentIndex, locParentIndex, locArrayIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dPID, locMCThrown->pdgtype, locArrayIndex);
 
 	//MATCHING
 	if(locMCThrownMatching != NULL)
@@ -1500,29 +1728,27 @@ void DEventWriterROOT::Fill_ThrownParticleData(DTreeFillData* locTreeFillData, u
 			if(locNeutralShower != NULL)
 				locMatchID = locNeutralShower->dShowerID;
 		}
-		locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "MatchID"), locMatchID, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "MatchFOM"), locMatchFOM, locArrayIndex);
+		locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dMatchID, locMatchID, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dMatchFOM, locMatchFOM, locArrayIndex);
 	}
 
 	//KINEMATICS: THROWN //at the production vertex
 	TLorentzVector locX4_Thrown(locMCThrown->position().X(), locMCThrown->position().Y(), locMCThrown->position().Z(), locMCThrown->time());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4"), locX4_Thrown, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4, locX4_Thrown, locArrayIndex);
 	TLorentzVector locP4_Thrown(locMCThrown->momentum().X(), locMCThrown->momentum().Y(), locMCThrown->momentum().Z(), locMCThrown->energy());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4"), locP4_Thrown, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4, locP4_Thrown, locArrayIndex);
 }
 
-void DEventWriterROOT::Fill_BeamData(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DBeamPhoton* locBeamPhoton, const DVertex* locVertex, const DMCThrownMatching* locMCThrownMatching) const
+void DEventWriterROOT::Fill_BeamData(DTreeFillData* locTreeFillData, const DBeamBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DBeamPhoton* locBeamPhoton, const DVertex* locVertex, const DMCThrownMatching* locMCThrownMatching) const
 {
-	string locParticleBranchName = "Beam";
-
 	//IDENTIFIER
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "PID"), PDGtype(locBeamPhoton->PID()), locArrayIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dPID, PDGtype(locBeamPhoton->PID()), locArrayIndex);
 
 	//MATCHING
 	if(locMCThrownMatching != NULL)
 	{
 		Bool_t locIsGeneratorFlag = (locMCThrownMatching->Get_TaggedMCGENBeamPhoton() == locBeamPhoton) ? kTRUE : kFALSE;
-		locTreeFillData->Fill_Array<Bool_t>(Build_BranchName(locParticleBranchName, "IsGenerator"), locIsGeneratorFlag, locArrayIndex);
+		locTreeFillData->Fill_Array<Bool_t>(locBranchHandles.dIsGenerator, locIsGeneratorFlag, locArrayIndex);
 	}
 
 	//KINEMATICS: MEASURED
@@ -1536,17 +1762,15 @@ void DEventWriterROOT::Fill_BeamData(DTreeFillData* locTreeFillData, unsigned in
 	double locTime = locBeamPhoton->time() + locDeltaT;
 
 	TLorentzVector locX4_Measured(locProductionVertex.X(), locProductionVertex.Y(), locProductionVertex.Z(), locTime);
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Measured"), locX4_Measured, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_Measured, locX4_Measured, locArrayIndex);
 
 	DLorentzVector locDP4 = locBeamPhoton->lorentzMomentum();
 	TLorentzVector locP4_Measured(locDP4.Px(), locDP4.Py(), locDP4.Pz(), locDP4.E());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_Measured"), locP4_Measured, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4_Measured, locP4_Measured, locArrayIndex);
 }
 
-void DEventWriterROOT::Fill_ChargedHypo(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DChargedTrackHypothesis* locChargedTrackHypothesis, const DMCThrownMatching* locMCThrownMatching, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DDetectorMatches* locDetectorMatches) const
+void DEventWriterROOT::Fill_ChargedHypo(DTreeFillData* locTreeFillData, const DChargedHypoBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DChargedTrackHypothesis* locChargedTrackHypothesis, const DMCThrownMatching* locMCThrownMatching, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DDetectorMatches* locDetectorMatches) const
 {
-	string locParticleBranchName = "ChargedHypo";
-
 	//ASSOCIATED OBJECTS
 	auto locTrackTimeBased = locChargedTrackHypothesis->Get_TrackTimeBased();
 
@@ -1559,8 +1783,8 @@ void DEventWriterROOT::Fill_ChargedHypo(DTreeFillData* locTreeFillData, unsigned
 		locFCALShower = locChargedTrackHypothesis->Get_FCALShowerMatchParams()->dFCALShower;
 
 	//IDENTIFIERS
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "TrackID"), locTrackTimeBased->candidateid, locArrayIndex);
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "PID"), PDGtype(locChargedTrackHypothesis->PID()), locArrayIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dTrackID, locTrackTimeBased->candidateid, locArrayIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dPID, PDGtype(locChargedTrackHypothesis->PID()), locArrayIndex);
 
 	//MATCHING
 	if(locMCThrownMatching != NULL)
@@ -1570,80 +1794,80 @@ void DEventWriterROOT::Fill_ChargedHypo(DTreeFillData* locTreeFillData, unsigned
 		const DMCThrown* locMCThrown = locMCThrownMatching->Get_MatchingMCThrown(locChargedTrackHypothesis, locMatchFOM);
 		if(locMCThrown != NULL)
 			locThrownIndex = locThrownIndexMap.find(locMCThrown)->second;
-		locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "ThrownIndex"), locThrownIndex, locArrayIndex);
+		locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dThrownIndex, locThrownIndex, locArrayIndex);
 	}
 
 	//KINEMATICS: MEASURED
 	DVector3 locPosition = locChargedTrackHypothesis->position();
 	TLorentzVector locTX4_Measured(locPosition.X(), locPosition.Y(), locPosition.Z(), locChargedTrackHypothesis->time());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Measured"), locTX4_Measured, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_Measured, locTX4_Measured, locArrayIndex);
 
 	DLorentzVector locDP4 = locChargedTrackHypothesis->lorentzMomentum();
 	TLorentzVector locP4_Measured(locDP4.Px(), locDP4.Py(), locDP4.Pz(), locDP4.E());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_Measured"), locP4_Measured, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4_Measured, locP4_Measured, locArrayIndex);
 
 	//TRACKING INFO
-	locTreeFillData->Fill_Array<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_Tracking"), locTrackTimeBased->Ndof, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Tracking"), locTrackTimeBased->chisq, locArrayIndex);
-	locTreeFillData->Fill_Array<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_DCdEdx"), locChargedTrackHypothesis->Get_NDF_DCdEdx(), locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_DCdEdx"), locChargedTrackHypothesis->Get_ChiSq_DCdEdx(), locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_CDC"), locTrackTimeBased->ddEdx_CDC_amp, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_CDC_integral"), locTrackTimeBased->ddEdx_CDC, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_FDC"), locTrackTimeBased->ddEdx_FDC, locArrayIndex);
+	locTreeFillData->Fill_Array<UInt_t>(locBranchHandles.dNDF_Tracking, locTrackTimeBased->Ndof, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_Tracking, locTrackTimeBased->chisq, locArrayIndex);
+	locTreeFillData->Fill_Array<UInt_t>(locBranchHandles.dNDF_DCdEdx, locChargedTrackHypothesis->Get_NDF_DCdEdx(), locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_DCdEdx, locChargedTrackHypothesis->Get_ChiSq_DCdEdx(), locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.ddEdx_CDC, locTrackTimeBased->ddEdx_CDC_amp, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.ddEdx_CDC_integral, locTrackTimeBased->ddEdx_CDC, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.ddEdx_FDC, locTrackTimeBased->ddEdx_FDC, locArrayIndex);
 
 	//HIT ENERGY
 	double locTOFdEdx = (locChargedTrackHypothesis->Get_TOFHitMatchParams() != NULL) ? locChargedTrackHypothesis->Get_TOFHitMatchParams()->dEdx : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_TOF"), locTOFdEdx, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.ddEdx_TOF, locTOFdEdx, locArrayIndex);
 	double locSCdEdx = (locChargedTrackHypothesis->Get_SCHitMatchParams() != NULL) ? locChargedTrackHypothesis->Get_SCHitMatchParams()->dEdx : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "dEdx_ST"), locSCdEdx, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.ddEdx_ST, locSCdEdx, locArrayIndex);
 	double locBCALEnergy = (locBCALShower != NULL) ? locBCALShower->E : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCAL"), locBCALEnergy, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCAL, locBCALEnergy, locArrayIndex);
 	double locBCALPreshowerEnergy = (locBCALShower != NULL) ? locBCALShower->E_preshower : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALPreshower"), locBCALPreshowerEnergy, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALPreshower, locBCALPreshowerEnergy, locArrayIndex);
 	if(BCAL_VERBOSE_OUTPUT) {
 		double locBCALLayer2Energy = (locBCALShower != NULL) ? locBCALShower->E_L2 : 0.0;
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer2"), locBCALLayer2Energy, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALLayer2, locBCALLayer2Energy, locArrayIndex);
 		double locBCALLayer3Energy = (locBCALShower != NULL) ? locBCALShower->E_L3 : 0.0;
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer3"), locBCALLayer3Energy, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALLayer3, locBCALLayer3Energy, locArrayIndex);
 		double locBCALLayer4Energy = (locBCALShower != NULL) ? locBCALShower->E_L4 : 0.0;
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer4"), locBCALLayer4Energy, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALLayer4, locBCALLayer4Energy, locArrayIndex);
 	}
 	
 	double locFCALEnergy = (locFCALShower != NULL) ? locFCALShower->getEnergy() : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_FCAL"), locFCALEnergy, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_FCAL, locFCALEnergy, locArrayIndex);
 	
 	//double locCCALEnergy = (locCCALShower != NULL) ? locCCALShower->getEnergy() : 0.0;
-	//locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_CCAL"), locCCALEnergy, locArrayIndex);
+	//locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_CCAL, locCCALEnergy, locArrayIndex);
 
 	//SHOWER PROPERTIES
 	double locSigLongBCAL = (locBCALShower != NULL) ? locBCALShower->sigLong : 0.0;
 	double locSigThetaBCAL = (locBCALShower != NULL) ? locBCALShower->sigTheta : 0.0;
 	double locSigTransBCAL = (locBCALShower != NULL) ? locBCALShower->sigTrans : 0.0;
 	double locRMSTimeBCAL = (locBCALShower != NULL) ? locBCALShower->rmsTime : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SigLong_BCAL"), locSigLongBCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SigTheta_BCAL"), locSigThetaBCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SigTrans_BCAL"), locSigTransBCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "RMSTime_BCAL"), locRMSTimeBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSigLong_BCAL, locSigLongBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSigTheta_BCAL, locSigThetaBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSigTrans_BCAL, locSigTransBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dRMSTime_BCAL, locRMSTimeBCAL, locArrayIndex);
 	
 	double locE1E9FCAL = (locFCALShower != NULL) ? locFCALShower->getE1E9() : 0.0;
 	double locE9E25FCAL = (locFCALShower != NULL) ? locFCALShower->getE9E25() : 0.0;
 	double locSumUFCAL = (locFCALShower != NULL) ? locFCALShower->getSumU() : 0.0;
 	double locSumVFCAL = (locFCALShower != NULL) ? locFCALShower->getSumV() : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "E1E9_FCAL"), locE1E9FCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "E9E25_FCAL"), locE9E25FCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SumU_FCAL"), locSumUFCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SumV_FCAL"), locSumVFCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dE1E9_FCAL, locE1E9FCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dE9E25_FCAL, locE9E25FCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSumU_FCAL, locSumUFCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSumV_FCAL, locSumVFCAL, locArrayIndex);
 
 	//TIMING INFO
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "HitTime"), locChargedTrackHypothesis->t1(), locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dHitTime, locChargedTrackHypothesis->t1(), locArrayIndex);
 	double locStartTimeError = locChargedTrackHypothesis->t0_err();
 	double locRFDeltaTVariance = (*locChargedTrackHypothesis->errorMatrix())(6, 6) + locStartTimeError*locStartTimeError;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "RFDeltaTVar"), locRFDeltaTVariance, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dRFDeltaTVar, locRFDeltaTVariance, locArrayIndex);
 
 	//MEASURED PID INFO
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing"), locChargedTrackHypothesis->measuredBeta(), locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing"), locChargedTrackHypothesis->Get_ChiSq_Timing(), locArrayIndex);
-	locTreeFillData->Fill_Array<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_Timing"), locChargedTrackHypothesis->Get_NDF_Timing(), locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dBeta_Timing, locChargedTrackHypothesis->measuredBeta(), locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_Timing, locChargedTrackHypothesis->Get_ChiSq_Timing(), locArrayIndex);
+	locTreeFillData->Fill_Array<UInt_t>(locBranchHandles.dNDF_Timing, locChargedTrackHypothesis->Get_NDF_Timing(), locArrayIndex);
 
 	//SHOWER MATCHING: BCAL
 	double locTrackBCAL_DeltaPhi = 999.0, locTrackBCAL_DeltaZ = 999.0;
@@ -1652,14 +1876,14 @@ void DEventWriterROOT::Fill_ChargedHypo(DTreeFillData* locTreeFillData, unsigned
 		locTrackBCAL_DeltaPhi = locChargedTrackHypothesis->Get_BCALShowerMatchParams()->dDeltaPhiToShower;
 		locTrackBCAL_DeltaZ = locChargedTrackHypothesis->Get_BCALShowerMatchParams()->dDeltaZToShower;
 	}
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaPhi"), locTrackBCAL_DeltaPhi, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaZ"), locTrackBCAL_DeltaZ, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dTrackBCAL_DeltaPhi, locTrackBCAL_DeltaPhi, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dTrackBCAL_DeltaZ, locTrackBCAL_DeltaZ, locArrayIndex);
 
 	//SHOWER MATCHING: FCAL
 	double locDOCAToShower_FCAL = 999.0;
 	if(locChargedTrackHypothesis->Get_FCALShowerMatchParams() != NULL)
 		locDOCAToShower_FCAL = locChargedTrackHypothesis->Get_FCALShowerMatchParams()->dDOCAToShower;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "TrackFCAL_DOCA"), locDOCAToShower_FCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dTrackFCAL_DOCA, locDOCAToShower_FCAL, locArrayIndex);
 
 	// DIRC
 	if(DIRC_OUTPUT) {
@@ -1682,20 +1906,19 @@ void DEventWriterROOT::Fill_ChargedHypo(DTreeFillData* locTreeFillData, unsigned
 			locDIRCLk =  locDIRCMatchParams->dLikelihoodKaon;
 			locDIRCLp =  locDIRCMatchParams->dLikelihoodProton;
 		}
-		locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "NumPhotons_DIRC"), locDIRCNumPhotons, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ExtrapolatedX_DIRC"), locDIRCExtrapolatedX, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ExtrapolatedY_DIRC"), locDIRCExtrapolatedY, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ThetaC_DIRC"), locDIRCThetaC, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Lele_DIRC"), locDIRCLele, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Lpi_DIRC"), locDIRCLpi, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Lk_DIRC"), locDIRCLk, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Lp_DIRC"), locDIRCLp, locArrayIndex);
+		locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dNumPhotons_DIRC, locDIRCNumPhotons, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dExtrapolatedX_DIRC, locDIRCExtrapolatedX, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dExtrapolatedY_DIRC, locDIRCExtrapolatedY, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dThetaC_DIRC, locDIRCThetaC, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dLele_DIRC, locDIRCLele, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dLpi_DIRC, locDIRCLpi, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dLk_DIRC, locDIRCLk, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dLp_DIRC, locDIRCLp, locArrayIndex);
 	}
 }
 
-void DEventWriterROOT::Fill_NeutralHypo(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DNeutralParticleHypothesis* locNeutralParticleHypothesis, const DMCThrownMatching* locMCThrownMatching, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DDetectorMatches* locDetectorMatches) const
+void DEventWriterROOT::Fill_NeutralHypo(DTreeFillData* locTreeFillData, const DNeutralHypoBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DNeutralParticleHypothesis* locNeutralParticleHypothesis, const DMCThrownMatching* locMCThrownMatching, const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DDetectorMatches* locDetectorMatches) const
 {
-	string locParticleBranchName = "NeutralHypo";
 	const DNeutralShower* locNeutralShower = locNeutralParticleHypothesis->Get_NeutralShower();
 
 	//ASSOCIATED OBJECTS
@@ -1708,8 +1931,8 @@ void DEventWriterROOT::Fill_NeutralHypo(DTreeFillData* locTreeFillData, unsigned
 
 	//IDENTIFIERS
 	Particle_t locPID = locNeutralParticleHypothesis->PID();
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "NeutralID"), locNeutralShower->dShowerID, locArrayIndex);
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "PID"), PDGtype(locPID), locArrayIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dNeutralID, locNeutralShower->dShowerID, locArrayIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dPID, PDGtype(locPID), locArrayIndex);
 
 	//MATCHING
 	if(locMCThrownMatching != NULL)
@@ -1719,69 +1942,69 @@ void DEventWriterROOT::Fill_NeutralHypo(DTreeFillData* locTreeFillData, unsigned
 		const DMCThrown* locMCThrown = locMCThrownMatching->Get_MatchingMCThrown(locNeutralParticleHypothesis, locMatchFOM);
 		if(locMCThrown != NULL)
 			locThrownIndex = locThrownIndexMap.find(locMCThrown)->second;
-		locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "ThrownIndex"), locThrownIndex, locArrayIndex);
+		locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dThrownIndex, locThrownIndex, locArrayIndex);
 	}
 
 	//KINEMATICS: MEASURED
 	DVector3 locPosition = locNeutralParticleHypothesis->position();
 	TLorentzVector locX4_Measured(locPosition.X(), locPosition.Y(), locPosition.Z(), locNeutralParticleHypothesis->time());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Measured"), locX4_Measured, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_Measured, locX4_Measured, locArrayIndex);
 
 	DLorentzVector locDP4 = locNeutralParticleHypothesis->lorentzMomentum();
 	TLorentzVector locP4_Measured(locDP4.Px(), locDP4.Py(), locDP4.Pz(), locDP4.E());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_Measured"), locP4_Measured, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4_Measured, locP4_Measured, locArrayIndex);
 
 	//MEASURED PID INFO
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing"), locNeutralParticleHypothesis->measuredBeta(), locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing"), locNeutralParticleHypothesis->Get_ChiSq(), locArrayIndex);
-	locTreeFillData->Fill_Array<UInt_t>(Build_BranchName(locParticleBranchName, "NDF_Timing"), locNeutralParticleHypothesis->Get_NDF(), locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ShowerQuality"), locNeutralShower->dQuality, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dBeta_Timing, locNeutralParticleHypothesis->measuredBeta(), locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_Timing, locNeutralParticleHypothesis->Get_ChiSq(), locArrayIndex);
+	locTreeFillData->Fill_Array<UInt_t>(locBranchHandles.dNDF_Timing, locNeutralParticleHypothesis->Get_NDF(), locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dShowerQuality, locNeutralShower->dQuality, locArrayIndex);
 
 	//SHOWER ENERGY
 	DetectorSystem_t locDetector = locNeutralShower->dDetectorSystem;
 	double locBCALEnergy = (locDetector == SYS_BCAL) ? locNeutralShower->dEnergy : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCAL"), locBCALEnergy, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCAL, locBCALEnergy, locArrayIndex);
 	double locBCALPreshowerEnergy = (locDetector == SYS_BCAL) ? static_cast<const DBCALShower*>(locNeutralShower->dBCALFCALShower)->E_preshower : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALPreshower"), locBCALPreshowerEnergy, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALPreshower, locBCALPreshowerEnergy, locArrayIndex);
 	if(BCAL_VERBOSE_OUTPUT) {
 		double locBCALLayer2Energy = (locBCALShower != NULL) ? locBCALShower->E_L2 : 0.0;
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer2"), locBCALLayer2Energy, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALLayer2, locBCALLayer2Energy, locArrayIndex);
 		double locBCALLayer3Energy = (locBCALShower != NULL) ? locBCALShower->E_L3 : 0.0;
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer3"), locBCALLayer3Energy, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALLayer3, locBCALLayer3Energy, locArrayIndex);
 		double locBCALLayer4Energy = (locBCALShower != NULL) ? locBCALShower->E_L4 : 0.0;
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_BCALLayer4"), locBCALLayer4Energy, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_BCALLayer4, locBCALLayer4Energy, locArrayIndex);
 	}
 	
 	double locFCALEnergy = (locDetector == SYS_FCAL) ? locNeutralShower->dEnergy : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_FCAL"), locFCALEnergy, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_FCAL, locFCALEnergy, locArrayIndex);
 
 	double locCCALEnergy = (locDetector == SYS_CCAL) ? locNeutralShower->dEnergy : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Energy_CCAL"), locCCALEnergy, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dEnergy_CCAL, locCCALEnergy, locArrayIndex);
 
 	//SHOWER POSITION
 	DLorentzVector locHitDX4 = locNeutralShower->dSpacetimeVertex;
 	TLorentzVector locTX4_Shower(locHitDX4.X(), locHitDX4.Y(), locHitDX4.Z(), locHitDX4.T());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Shower"), locTX4_Shower, locArrayIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_Shower, locTX4_Shower, locArrayIndex);
 
 	//SHOWER PROPERTIES
 	double locSigLongBCAL = (locBCALShower != NULL) ? locBCALShower->sigLong : 0.0;
 	double locSigThetaBCAL = (locBCALShower != NULL) ? locBCALShower->sigTheta : 0.0;
 	double locSigTransBCAL = (locBCALShower != NULL) ? locBCALShower->sigTrans : 0.0;
 	double locRMSTimeBCAL = (locBCALShower != NULL) ? locBCALShower->rmsTime : 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SigLong_BCAL"), locSigLongBCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SigTheta_BCAL"), locSigThetaBCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SigTrans_BCAL"), locSigTransBCAL, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "RMSTime_BCAL"), locRMSTimeBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSigLong_BCAL, locSigLongBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSigTheta_BCAL, locSigThetaBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSigTrans_BCAL, locSigTransBCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dRMSTime_BCAL, locRMSTimeBCAL, locArrayIndex);
 	
 	if(FCAL_VERBOSE_OUTPUT) {
 		double locE1E9FCAL = (locFCALShower != NULL) ? locFCALShower->getE1E9() : 0.0;
 		double locE9E25FCAL = (locFCALShower != NULL) ? locFCALShower->getE9E25() : 0.0;
 		double locSumUFCAL = (locFCALShower != NULL) ? locFCALShower->getSumU() : 0.0;
 		double locSumVFCAL = (locFCALShower != NULL) ? locFCALShower->getSumV() : 0.0;
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "E1E9_FCAL"), locE1E9FCAL, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "E9E25_FCAL"), locE9E25FCAL, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SumU_FCAL"), locSumUFCAL, locArrayIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "SumV_FCAL"), locSumVFCAL, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dE1E9_FCAL, locE1E9FCAL, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dE9E25_FCAL, locE9E25FCAL, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSumU_FCAL, locSumUFCAL, locArrayIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dSumV_FCAL, locSumVFCAL, locArrayIndex);
 	}
 	
 	//Track DOCA to Shower - BCAL
@@ -1799,8 +2022,8 @@ void DEventWriterROOT::Fill_NeutralHypo(DTreeFillData* locTreeFillData, unsigned
 			locNearestTrackBCALDeltaZ = 999.0;
 		}
 	}
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaPhi"), locNearestTrackBCALDeltaPhi, locArrayIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "TrackBCAL_DeltaZ"), locNearestTrackBCALDeltaZ, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dTrackBCAL_DeltaPhi, locNearestTrackBCALDeltaPhi, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dTrackBCAL_DeltaZ, locNearestTrackBCALDeltaZ, locArrayIndex);
 
 	//Track DOCA to Shower - FCAL
 	double locDistanceToNearestTrack_FCAL = 999.0;
@@ -1811,28 +2034,28 @@ void DEventWriterROOT::Fill_NeutralHypo(DTreeFillData* locTreeFillData, unsigned
 		if(locDistanceToNearestTrack_FCAL > 999.0)
 			locDistanceToNearestTrack_FCAL = 999.0;
 	}
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "TrackFCAL_DOCA"), locDistanceToNearestTrack_FCAL, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dTrackFCAL_DOCA, locDistanceToNearestTrack_FCAL, locArrayIndex);
 
 	//PHOTON PID INFO
 	double locStartTimeError = locNeutralParticleHypothesis->t0_err();
 	double locPhotonRFDeltaTVar = (*locNeutralParticleHypothesis->errorMatrix())(6, 6) + locStartTimeError*locStartTimeError;
 	if(locPID != Gamma)
 		locPhotonRFDeltaTVar = 0.0;
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "PhotonRFDeltaTVar"), locPhotonRFDeltaTVar, locArrayIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dPhotonRFDeltaTVar, locPhotonRFDeltaTVar, locArrayIndex);
 }
 
-void DEventWriterROOT::Fill_ComboData(DTreeFillData* locTreeFillData, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locComboIndex, const map<pair<oid_t, Particle_t>, size_t>& locObjectToArrayIndexMap) const
+void DEventWriterROOT::Fill_ComboData(DTreeFillData* locTreeFillData, const DDataTreeBranchHandles_t& locBranchHandles, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locComboIndex, const map<pair<oid_t, Particle_t>, size_t>& locObjectToArrayIndexMap) const
 {
 	//MAIN CLASSES
 	const DKinFitResults* locKinFitResults = locParticleCombo->Get_KinFitResults();
 	const DEventRFBunch* locEventRFBunch = locParticleCombo->Get_EventRFBunch();
 
 	//IS COMBO CUT
-	locTreeFillData->Fill_Array<Bool_t>("IsComboCut", kFALSE, locComboIndex);
+	locTreeFillData->Fill_Array<Bool_t>(locBranchHandles.dIsComboCut, kFALSE, locComboIndex);
 
 	//RF INFO
 	double locRFTime = (locEventRFBunch != NULL) ? locEventRFBunch->dTime : numeric_limits<double>::quiet_NaN();
-	locTreeFillData->Fill_Array<Float_t>("RFTime_Measured", locRFTime, locComboIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dRFTime_Measured, locRFTime, locComboIndex);
 
 	//KINFIT INFO
 	DKinFitType locKinFitType = locReaction->Get_KinFitType();
@@ -1841,34 +2064,32 @@ void DEventWriterROOT::Fill_ComboData(DTreeFillData* locTreeFillData, const DRea
 	{
 		if(locKinFitResults != NULL)
 		{
-			locTreeFillData->Fill_Array<Float_t>("ChiSq_KinFit", locKinFitResults->Get_ChiSq(), locComboIndex);
-			locTreeFillData->Fill_Array<UInt_t>("NDF_KinFit", locKinFitResults->Get_NDF(), locComboIndex);
+			locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_KinFit, locKinFitResults->Get_ChiSq(), locComboIndex);
+			locTreeFillData->Fill_Array<UInt_t>(locBranchHandles.dNDF_KinFit, locKinFitResults->Get_NDF(), locComboIndex);
 			if((locKinFitType == d_SpacetimeFit) || (locKinFitType == d_P4AndSpacetimeFit))
 			{
 				double locRFTime_KinFit = -9.9E9; //NOT IMPLEMENTED YET
-				locTreeFillData->Fill_Array<Float_t>("RFTime_KinFit", locRFTime_KinFit, locComboIndex);
+				locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dRFTime_KinFit, locRFTime_KinFit, locComboIndex);
 			}
 		}
 		else
 		{
-			locTreeFillData->Fill_Array<Float_t>("ChiSq_KinFit", 0.0, locComboIndex);
-			locTreeFillData->Fill_Array<UInt_t>("NDF_KinFit", 0, locComboIndex);
+			locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_KinFit, 0.0, locComboIndex);
+			locTreeFillData->Fill_Array<UInt_t>(locBranchHandles.dNDF_KinFit, 0, locComboIndex);
 			if((locKinFitType == d_SpacetimeFit) || (locKinFitType == d_P4AndSpacetimeFit))
-				locTreeFillData->Fill_Array<Float_t>("RFTime_KinFit", -9.9E9, locComboIndex);
+				locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dRFTime_KinFit, -9.9E9, locComboIndex);
 		}
 	}
 
 	//STEP DATA
 	for(size_t loc_i = 0; loc_i < locParticleCombo->Get_NumParticleComboSteps(); ++loc_i)
-		Fill_ComboStepData(locTreeFillData, locReaction, locParticleCombo, loc_i, locComboIndex, locKinFitType, locObjectToArrayIndexMap);
+		Fill_ComboStepData(locTreeFillData, locBranchHandles, locReaction, locParticleCombo, loc_i, locComboIndex, locKinFitType, locObjectToArrayIndexMap);
 }
 
-void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locStepIndex, unsigned int locComboIndex, DKinFitType locKinFitType, const map<pair<oid_t, Particle_t>, size_t>& locObjectToArrayIndexMap) const
+void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const DDataTreeBranchHandles_t& locBranchHandles, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locStepIndex, unsigned int locComboIndex, DKinFitType locKinFitType, const map<pair<oid_t, Particle_t>, size_t>& locObjectToArrayIndexMap) const
 {
 	auto locReactionVertexInfo = dVertexInfoMap.find(locReaction)->second;
 	auto locReactionStep = locReaction->Get_ReactionStep(locStepIndex);
-	const TList* locUserInfo = dTreeInterfaceMap.find(locReaction)->second->Get_UserInfo(); //No Lock!  But this should be unchanging at this point anyway
-	const TMap* locPositionToNameMap = (TMap*)locUserInfo->FindObject("PositionToNameMap");
 
 	auto locParticleComboStep = locParticleCombo->Get_ParticleComboStep(locStepIndex);
 	DLorentzVector locStepX4 = locParticleComboStep->Get_SpacetimeVertex();
@@ -1887,15 +2108,12 @@ void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const
 		pair<oid_t, Particle_t> locBeamPair(locMeasuredBeamPhoton->id, locMeasuredBeamPhoton->PID());
 		size_t locBeamIndex = locObjectToArrayIndexMap.find(locBeamPair)->second;
 
-		Fill_ComboBeamData(locTreeFillData, locComboIndex, locBeamPhoton, locBeamIndex, locKinFitType);
+		Fill_ComboBeamData(locTreeFillData, locBranchHandles.dComboBeam, locComboIndex, locBeamPhoton, locBeamIndex, locKinFitType);
 	}
 	else //decaying
 	{
-		//get the branch name
-		ostringstream locPositionStream;
-		locPositionStream << locStepIndex << "_-1";
-		TObjString* locObjString = (TObjString*)locPositionToNameMap->GetValue(locPositionStream.str().c_str());
-		string locParticleBranchName = (const char*)(locObjString->GetString());
+		//get the branch handles
+		const DComboParticleBranchHandles_t& locParticleHandles = locBranchHandles.dComboDecayingHandles[locStepIndex];
 
 		auto locP4FitFlag = ((locKinFitType == d_P4Fit) || (locKinFitType == d_P4AndVertexFit) || (locKinFitType == d_P4AndSpacetimeFit));
 		if(IsFixedMass(locInitialPID) && locReactionStep->Get_KinFitConstrainInitMassFlag() && locP4FitFlag)
@@ -1910,11 +2128,11 @@ void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const
 			}
 			else
 				locDecayP4.SetPxPyPzE(locInitialParticle->momentum().X(), locInitialParticle->momentum().Y(), locInitialParticle->momentum().Z(), locInitialParticle->energy());
-			locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_KinFit"), locDecayP4, locComboIndex);
+			locTreeFillData->Fill_Array<TLorentzVector>(locParticleHandles.dP4_KinFit, locDecayP4, locComboIndex);
 		}
 
 		if((locStepIndex == 0) || IsDetachedVertex(locInitialPID))
-			locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4"), locStepTX4, locComboIndex);
+			locTreeFillData->Fill_Array<TLorentzVector>(locParticleHandles.dX4, locStepTX4, locComboIndex);
 
 		auto locStepVertexInfo = locReactionVertexInfo->Get_StepVertexInfo(locStepIndex);
 		auto locParentVertexInfo = locStepVertexInfo->Get_ParentVertexInfo();
@@ -1923,7 +2141,7 @@ void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const
 		{
 			auto locKinFitParticle = locParticleComboStep->Get_InitialKinFitParticle();
 			auto locPathLengthSigma = locKinFitParticle->Get_PathLengthUncertainty();
-			locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "PathLengthSigma"), locPathLengthSigma, locComboIndex);
+			locTreeFillData->Fill_Array<Float_t>(locParticleHandles.dPathLengthSigma, locPathLengthSigma, locComboIndex);
 		}
 	}
 
@@ -1938,11 +2156,8 @@ void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const
 		if(DAnalysis::Get_DecayStepIndex(locReaction, locStepIndex, loc_i) >= 0)
 			continue;
 
-		//get the branch name
-		ostringstream locPositionStream;
-		locPositionStream << locStepIndex << "_" << loc_i;
-		TObjString* locObjString = (TObjString*)locPositionToNameMap->GetValue(locPositionStream.str().c_str());
-		string locParticleBranchName = (const char*)(locObjString->GetString());
+		//get the branch handles
+		const DComboParticleBranchHandles_t& locParticleHandles = locBranchHandles.dComboFinalHandles[locStepIndex][loc_i];
 
 		//missing particle
 		if(locReactionStep->Get_MissingParticleIndex() == int(loc_i))
@@ -1960,7 +2175,7 @@ void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const
 				else
 					locMissingP4.SetPxPyPzE(locKinematicData->momentum().X(), locKinematicData->momentum().Y(), locKinematicData->momentum().Z(), locKinematicData->energy());
 
-				locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_KinFit"), locMissingP4, locComboIndex);
+				locTreeFillData->Fill_Array<TLorentzVector>(locParticleHandles.dP4_KinFit, locMissingP4, locComboIndex);
 			}
 			continue;
 		}
@@ -1976,7 +2191,7 @@ void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const
 			pair<oid_t, Particle_t> locNeutralPair(locNeutralShower->id, locNeutralHypo->PID());
 			size_t locNeutralIndex = locObjectToArrayIndexMap.find(locNeutralPair)->second;
 
-			Fill_ComboNeutralData(locTreeFillData, locComboIndex, locParticleBranchName, locMeasuredNeutralHypo, locNeutralHypo, locNeutralIndex, locKinFitType);
+			Fill_ComboNeutralData(locTreeFillData, locParticleHandles, locComboIndex, locMeasuredNeutralHypo, locNeutralHypo, locNeutralIndex, locKinFitType);
 		}
 		else
 		{
@@ -1988,17 +2203,15 @@ void DEventWriterROOT::Fill_ComboStepData(DTreeFillData* locTreeFillData, const
 			pair<oid_t, Particle_t> locTrackPair(locTrackTimeBased->id, locChargedHypo->PID());
 			size_t locChargedIndex = locObjectToArrayIndexMap.find(locTrackPair)->second;
 
-			Fill_ComboChargedData(locTreeFillData, locComboIndex, locParticleBranchName, locMeasuredChargedHypo, locChargedHypo, locChargedIndex, locKinFitType);
+			Fill_ComboChargedData(locTreeFillData, locParticleHandles, locComboIndex, locMeasuredChargedHypo, locChargedHypo, locChargedIndex, locKinFitType);
 		}
 	}
 }
 
-void DEventWriterROOT::Fill_ComboBeamData(DTreeFillData* locTreeFillData, unsigned int locComboIndex, const DBeamPhoton* locBeamPhoton, size_t locBeamIndex, DKinFitType locKinFitType) const
+void DEventWriterROOT::Fill_ComboBeamData(DTreeFillData* locTreeFillData, const DComboBeamBranchHandles_t& locBranchHandles, unsigned int locComboIndex, const DBeamPhoton* locBeamPhoton, size_t locBeamIndex, DKinFitType locKinFitType) const
 {
-	string locParticleBranchName = "ComboBeam";
-
 	//IDENTIFIER
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "BeamIndex"), locBeamIndex, locComboIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dBeamIndex, locBeamIndex, locComboIndex);
 
 	//KINEMATICS: KINFIT
 	if(locKinFitType != d_NoFit)
@@ -2007,7 +2220,7 @@ void DEventWriterROOT::Fill_ComboBeamData(DTreeFillData* locTreeFillData, unsign
 		{
 			DVector3 locPosition = locBeamPhoton->position();
 			TLorentzVector locX4_KinFit(locPosition.X(), locPosition.Y(), locPosition.Z(), locBeamPhoton->time());
-			locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_KinFit"), locX4_KinFit, locComboIndex);
+			locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_KinFit, locX4_KinFit, locComboIndex);
 		}
 
 		//if charged, bends in b-field, update p4 when vertex changes
@@ -2015,25 +2228,25 @@ void DEventWriterROOT::Fill_ComboBeamData(DTreeFillData* locTreeFillData, unsign
 		{
 			DLorentzVector locDP4 = locBeamPhoton->lorentzMomentum();
 			TLorentzVector locP4_KinFit(locDP4.Px(), locDP4.Py(), locDP4.Pz(), locDP4.E());
-			locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_KinFit"), locP4_KinFit, locComboIndex);
+			locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4_KinFit, locP4_KinFit, locComboIndex);
 		}
 	}
 }
 
-void DEventWriterROOT::Fill_ComboChargedData(DTreeFillData* locTreeFillData, unsigned int locComboIndex, string locParticleBranchName, const DChargedTrackHypothesis* locMeasuredChargedHypo, const DChargedTrackHypothesis* locChargedHypo, size_t locChargedIndex, DKinFitType locKinFitType) const
+void DEventWriterROOT::Fill_ComboChargedData(DTreeFillData* locTreeFillData, const DComboParticleBranchHandles_t& locBranchHandles, unsigned int locComboIndex, const DChargedTrackHypothesis* locMeasuredChargedHypo, const DChargedTrackHypothesis* locChargedHypo, size_t locChargedIndex, DKinFitType locKinFitType) const
 {
 	//IDENTIFIER
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "ChargedIndex"), locChargedIndex, locComboIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dChargedIndex, locChargedIndex, locComboIndex);
 
 	//MEASURED PID
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing_Measured"), locMeasuredChargedHypo->measuredBeta(), locComboIndex);
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing_Measured"), locMeasuredChargedHypo->Get_ChiSq_Timing(), locComboIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dBeta_Timing_Measured, locMeasuredChargedHypo->measuredBeta(), locComboIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_Timing_Measured, locMeasuredChargedHypo->Get_ChiSq_Timing(), locComboIndex);
 
 	//KINFIT PID
 	if((locKinFitType != d_NoFit) && (locKinFitType != d_SpacetimeFit) && (locKinFitType != d_P4AndSpacetimeFit))
 	{
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing_KinFit"), locChargedHypo->measuredBeta(), locComboIndex);
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing_KinFit"), locChargedHypo->Get_ChiSq_Timing(), locComboIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dBeta_Timing_KinFit, locChargedHypo->measuredBeta(), locComboIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_Timing_KinFit, locChargedHypo->Get_ChiSq_Timing(), locComboIndex);
 	}
 
 	//KINFIT
@@ -2044,41 +2257,41 @@ void DEventWriterROOT::Fill_ComboChargedData(DTreeFillData* locTreeFillData, uns
 		{
 			DVector3 locPosition = locChargedHypo->position();
 			TLorentzVector locX4_KinFit(locPosition.X(), locPosition.Y(), locPosition.Z(), locChargedHypo->time());
-			locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_KinFit"), locX4_KinFit, locComboIndex);
+			locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_KinFit, locX4_KinFit, locComboIndex);
 		}
 
 		//update even if vertex-only fit, because charged momentum propagated through b-field
 		DLorentzVector locDP4 = locChargedHypo->lorentzMomentum();
 		TLorentzVector locP4_KinFit(locDP4.Px(), locDP4.Py(), locDP4.Pz(), locDP4.E());
-		locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_KinFit"), locP4_KinFit, locComboIndex);
+		locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4_KinFit, locP4_KinFit, locComboIndex);
 	}
 }
 
-void DEventWriterROOT::Fill_ComboNeutralData(DTreeFillData* locTreeFillData, unsigned int locComboIndex, string locParticleBranchName, const DNeutralParticleHypothesis* locMeasuredNeutralHypo, const DNeutralParticleHypothesis* locNeutralHypo, size_t locNeutralIndex, DKinFitType locKinFitType) const
+void DEventWriterROOT::Fill_ComboNeutralData(DTreeFillData* locTreeFillData, const DComboParticleBranchHandles_t& locBranchHandles, unsigned int locComboIndex, const DNeutralParticleHypothesis* locMeasuredNeutralHypo, const DNeutralParticleHypothesis* locNeutralHypo, size_t locNeutralIndex, DKinFitType locKinFitType) const
 {
 	//IDENTIFIER
-	locTreeFillData->Fill_Array<Int_t>(Build_BranchName(locParticleBranchName, "NeutralIndex"), locNeutralIndex, locComboIndex);
+	locTreeFillData->Fill_Array<Int_t>(locBranchHandles.dNeutralIndex, locNeutralIndex, locComboIndex);
 
 	//KINEMATICS: MEASURED
 	DVector3 locPosition = locMeasuredNeutralHypo->position();
 	TLorentzVector locX4_Measured(locPosition.X(), locPosition.Y(), locPosition.Z(), locMeasuredNeutralHypo->time());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_Measured"), locX4_Measured, locComboIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_Measured, locX4_Measured, locComboIndex);
 
 	DLorentzVector locDP4 = locMeasuredNeutralHypo->lorentzMomentum();
 	TLorentzVector locP4_Measured(locDP4.Px(), locDP4.Py(), locDP4.Pz(), locDP4.E());
-	locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_Measured"), locP4_Measured, locComboIndex);
+	locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4_Measured, locP4_Measured, locComboIndex);
 
 	//MEASURED PID INFO
-	locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing_Measured"), locMeasuredNeutralHypo->measuredBeta(), locComboIndex);
-	if(locParticleBranchName.substr(0, 6) == "Photon")
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing_Measured"), locMeasuredNeutralHypo->Get_ChiSq(), locComboIndex);
+	locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dBeta_Timing_Measured, locMeasuredNeutralHypo->measuredBeta(), locComboIndex);
+	if(locBranchHandles.dIsPhotonFlag)
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_Timing_Measured, locMeasuredNeutralHypo->Get_ChiSq(), locComboIndex);
 
 	//KINFIT PID INFO
 	if((locKinFitType != d_NoFit) && (locKinFitType != d_SpacetimeFit) && (locKinFitType != d_P4AndSpacetimeFit))
 	{
-		locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "Beta_Timing_KinFit"), locNeutralHypo->measuredBeta(), locComboIndex);
-		if(locParticleBranchName.substr(0, 6) == "Photon")
-			locTreeFillData->Fill_Array<Float_t>(Build_BranchName(locParticleBranchName, "ChiSq_Timing_KinFit"), locNeutralHypo->Get_ChiSq(), locComboIndex);
+		locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dBeta_Timing_KinFit, locNeutralHypo->measuredBeta(), locComboIndex);
+		if(locBranchHandles.dIsPhotonFlag)
+			locTreeFillData->Fill_Array<Float_t>(locBranchHandles.dChiSq_Timing_KinFit, locNeutralHypo->Get_ChiSq(), locComboIndex);
 	}
 
 	//KINFIT
@@ -2089,13 +2302,13 @@ void DEventWriterROOT::Fill_ComboNeutralData(DTreeFillData* locTreeFillData, uns
 		{
 			DVector3 locPosition = locNeutralHypo->position();
 			TLorentzVector locX4_KinFit(locPosition.X(), locPosition.Y(), locPosition.Z(), locNeutralHypo->time());
-			locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "X4_KinFit"), locX4_KinFit, locComboIndex);
+			locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dX4_KinFit, locX4_KinFit, locComboIndex);
 		}
 
 		//update even if vertex-only fit, because neutral momentum defined by vertex
 		DLorentzVector locDP4 = locNeutralHypo->lorentzMomentum();
 		TLorentzVector locP4_KinFit(locDP4.Px(), locDP4.Py(), locDP4.Pz(), locDP4.E());
-		locTreeFillData->Fill_Array<TLorentzVector>(Build_BranchName(locParticleBranchName, "P4_KinFit"), locP4_KinFit, locComboIndex);
+		locTreeFillData->Fill_Array<TLorentzVector>(locBranchHandles.dP4_KinFit, locP4_KinFit, locComboIndex);
 	}
 }
 
@@ -98,6 +98,175 @@ class DEventWriterROOT : public JObject
 
 		/****************************************************************************************************************************************/
 
+		//TREE FILLING: BRANCH HANDLES
+			//Resolved once per tree (when it is created for this thread), so that the fill path does no branch-name building or lookups
+			//Handles for branches that don't exist in the tree (e.g. non-MC, verbose output off) are never filled, and are ignored
+		struct DThrownBranchHandles_t //MC info & "Thrown__" particles
+		{
+			DTreeBranchHandle<Float_t> dMCWeight;
+			DTreeBranchHandle<Int_t> dThrownBeam_PID;
+			DTreeBranchHandle<Float_t> dThrownBeam_GeneratedEnergy;
+			DTreeBranchHandle<TLorentzVector> dThrownBeam_X4;
+			DTreeBranchHandle<TLorentzVector> dThrownBeam_P4;
+			DTreeBranchHandle<UInt_t> dNumThrown;
+			DTreeBranchHandle<ULong64_t> dNumPIDThrown_FinalState;
+			DTreeBranchHandle<ULong64_t> dPIDThrown_Decaying;
+			DTreeBranchHandle<Int_t> dParentIndex;
+			DTreeBranchHandle<Int_t> dPID;
+			DTreeBranchHandle<Int_t> dMatchID;
+			DTreeBranchHandle<Float_t> dMatchFOM;
+			DTreeBranchHandle<TLorentzVector> dX4;
+			DTreeBranchHandle<TLorentzVector> dP4;
+		};
+		struct DBeamBranchHandles_t //"Beam__"
+		{
+			DTreeBranchHandle<Int_t> dPID;
+			DTreeBranchHandle<Bool_t> dIsGenerator;
+			DTreeBranchHandle<TLorentzVector> dX4_Measured;
+			DTreeBranchHandle<TLorentzVector> dP4_Measured;
+		};
+		struct DChargedHypoBranchHandles_t //"ChargedHypo__"
+		{
+			DTreeBranchHandle<Int_t> dTrackID;
+			DTreeBranchHandle<Int_t> dPID;
+			DTreeBranchHandle<Int_t> dThrownIndex;
+			DTreeBranchHandle<TLorentzVector> dX4_Measured;
+			DTreeBranchHandle<TLorentzVector> dP4_Measured;
+			DTreeBranchHandle<UInt_t> dNDF_Tracking;
+			DTreeBranchHandle<Float_t> dChiSq_Tracking;
+			DTreeBranchHandle<UInt_t> dNDF_DCdEdx;
+			DTreeBranchHandle<Float_t> dChiSq_DCdEdx;
+			DTreeBranchHandle<Float_t> ddEdx_CDC;
+			DTreeBranchHandle<Float_t> ddEdx_CDC_integral;
+			DTreeBranchHandle<Float_t> ddEdx_FDC;
+			DTreeBranchHandle<Float_t> ddEdx_TOF;
+			DTreeBranchHandle<Float_t> ddEdx_ST;
+			DTreeBranchHandle<Float_t> dEnergy_BCAL;
+			DTreeBranchHandle<Float_t> dEnergy_BCALPreshower;
+			DTreeBranchHandle<Float_t> dEnergy_BCALLayer2;
+			DTreeBranchHandle<Float_t> dEnergy_BCALLayer3;
+			DTreeBranchHandle<Float_t> dEnergy_BCALLayer4;
+			DTreeBranchHandle<Float_t> dEnergy_FCAL;
+			DTreeBranchHandle<Float_t> dSigLong_BCAL;
+			DTreeBranchHandle<Float_t> dSigTheta_BCAL;
+			DTreeBranchHandle<Float_t> dSigTrans_BCAL;
+			DTreeBranchHandle<Float_t> dRMSTime_BCAL;
+			DTreeBranchHandle<Float_t> dE1E9_FCAL;
+			DTreeBranchHandle<Float_t> dE9E25_FCAL;
+			DTreeBranchHandle<Float_t> dSumU_FCAL;
+			DTreeBranchHandle<Float_t> dSumV_FCAL;
+			DTreeBranchHandle<Float_t> dHitTime;
+			DTreeBranchHandle<Float_t> dRFDeltaTVar;
+			DTreeBranchHandle<Float_t> dBeta_Timing;
+			DTreeBranchHandle<Float_t> dChiSq_Timing;
+			DTreeBranchHandle<UInt_t> dNDF_Timing;
+			DTreeBranchHandle<Float_t> dTrackBCAL_DeltaPhi;
+			DTreeBranchHandle<Float_t> dTrackBCAL_DeltaZ;
+			DTreeBranchHandle<Float_t> dTrackFCAL_DOCA;
+			DTreeBranchHandle<Int_t> dNumPhotons_DIRC;
+			DTreeBranchHandle<Float_t> dExtrapolatedX_DIRC;
+			DTreeBranchHandle<Float_t> dExtrapolatedY_DIRC;
+			DTreeBranchHandle<Float_t> dThetaC_DIRC;
+			DTreeBranchHandle<Float_t> dLele_DIRC;
+			DTreeBranchHandle<Float_t> dLpi_DIRC;
+			DTreeBranchHandle<Float_t> dLk_DIRC;
+			DTreeBranchHandle<Float_t> dLp_DIRC;
+		};
+		struct DNeutralHypoBranchHandles_t //"NeutralHypo__"
+		{
+			DTreeBranchHandle<Int_t> dNeutralID;
+			DTreeBranchHandle<Int_t> dPID;
+			DTreeBranchHandle<Int_t> dThrownIndex;
+			DTreeBranchHandle<TLorentzVector> dX4_Measured;
+			DTreeBranchHandle<TLorentzVector> dP4_Measured;
+			DTreeBranchHandle<TLorentzVector> dX4_Shower;
+			DTreeBranchHandle<Float_t> dBeta_Timing;
+			DTreeBranchHandle<Float_t> dChiSq_Timing;
+			DTreeBranchHandle<UInt_t> dNDF_Timing;
+			DTreeBranchHandle<Float_t> dShowerQuality;
+			DTreeBranchHandle<Float_t> dEnergy_BCAL;
+			DTreeBranchHandle<Float_t> dEnergy_BCALPreshower;
+			DTreeBranchHandle<Float_t> dEnergy_BCALLayer2;
+			DTreeBranchHandle<Float_t> dEnergy_BCALLayer3;
+			DTreeBranchHandle<Float_t> dEnergy_BCALLayer4;
+			DTreeBranchHandle<Float_t> dEnergy_FCAL;
+			DTreeBranchHandle<Float_t> dEnergy_CCAL;
+			DTreeBranchHandle<Float_t> dSigLong_BCAL;
+			DTreeBranchHandle<Float_t> dSigTheta_BCAL;
+			DTreeBranchHandle<Float_t> dSigTrans_BCAL;
+			DTreeBranchHandle<Float_t> dRMSTime_BCAL;
+			DTreeBranchHandle<Float_t> dE1E9_FCAL;
+			DTreeBranchHandle<Float_t> dE9E25_FCAL;
+			DTreeBranchHandle<Float_t> dSumU_FCAL;
+			DTreeBranchHandle<Float_t> dSumV_FCAL;
+			DTreeBranchHandle<Float_t> dTrackBCAL_DeltaPhi;
+			DTreeBranchHandle<Float_t> dTrackBCAL_DeltaZ;
+			DTreeBranchHandle<Float_t> dTrackFCAL_DOCA;
+			DTreeBranchHandle<Float_t> dPhotonRFDeltaTVar;
+		};
+		struct DComboBeamBranchHandles_t //"ComboBeam__"
+		{
+			DTreeBranchHandle<Int_t> dBeamIndex;
+			DTreeBranchHandle<TLorentzVector> dX4_KinFit;
+			DTreeBranchHandle<TLorentzVector> dP4_KinFit;
+		};
+		struct DComboParticleBranchHandles_t //one combo particle (by its name in the PositionToNameMap): decaying, missing, charged, or neutral
+		{
+			DTreeBranchHandle<Int_t> dChargedIndex;
+			DTreeBranchHandle<Int_t> dNeutralIndex;
+			DTreeBranchHandle<TLorentzVector> dX4_Measured;
+			DTreeBranchHandle<TLorentzVector> dP4_Measured;
+			DTreeBranchHandle<Float_t> dBeta_Timing_Measured;
+			DTreeBranchHandle<Float_t> dChiSq_Timing_Measured;
+			DTreeBranchHandle<Float_t> dBeta_Timing_KinFit;
+			DTreeBranchHandle<Float_t> dChiSq_Timing_KinFit;
+			DTreeBranchHandle<TLorentzVector> dX4_KinFit;
+			DTreeBranchHandle<TLorentzVector> dP4_KinFit;
+			DTreeBranchHandle<TLorentzVector> dX4;
+			DTreeBranchHandle<Float_t> dPathLengthSigma;
+			bool dIsPhotonFlag = false; //timing chisq only saved for photons
+		};
+		struct DDataTreeBranchHandles_t //one reaction
+		{
+			DTreeBranchHandle<UInt_t> dRunNumber;
+			DTreeBranchHandle<ULong64_t> dEventNumber;
+			DTreeBranchHandle<UInt_t> dL1TriggerBits;
+			DTreeBranchHandle<TLorentzVector> dX4_Production;
+			DTreeBranchHandle<Bool_t> dIsThrownTopology;
+			DTreeBranchHandle<UInt_t> dNumBeam;
+			DTreeBranchHandle<UInt_t> dNumChargedHypos;
+			DTreeBranchHandle<UInt_t> dNumNeutralHypos;
+			DTreeBranchHandle<UChar_t> dNumUnusedTracks;
+			DTreeBranchHandle<UInt_t> dNumCombos;
+			DTreeBranchHandle<UChar_t> dNumUnusedShowers;
+			DTreeBranchHandle<Float_t> dEnergy_UnusedShowers;
+			DTreeBranchHandle<UChar_t> dNumUnusedShowers_Quality;
+			DTreeBranchHandle<Float_t> dEnergy_UnusedShowers_Quality;
+			DTreeBranchHandle<Float_t> dSumPMag_UnusedTracks;
+			DTreeBranchHandle<TVector3> dSumP3_UnusedTracks;
+			DTreeBranchHandle<Bool_t> dIsTrueCombo;
+			DTreeBranchHandle<Bool_t> dIsBDTSignalCombo;
+			DTreeBranchHandle<Bool_t> dIsComboCut;
+			DTreeBranchHandle<Float_t> dRFTime_Measured;
+			DTreeBranchHandle<Float_t> dChiSq_KinFit;
+			DTreeBranchHandle<UInt_t> dNDF_KinFit;
+			DTreeBranchHandle<Float_t> dRFTime_KinFit;
+
+			DThrownBranchHandles_t dThrown;
+			DBeamBranchHandles_t dBeam;
+			DChargedHypoBranchHandles_t dChargedHypo;
+			DNeutralHypoBranchHandles_t dNeutralHypo;
+			DComboBeamBranchHandles_t dComboBeam;
+			vector<DComboParticleBranchHandles_t> dComboDecayingHandles; //index is step index: initial particle
+			vector<vector<DComboParticleBranchHandles_t> > dComboFinalHandles; //indices are step index, final-particle index
+		};
+		struct DThrownTreeBranchHandles_t
+		{
+			DTreeBranchHandle<UInt_t> dRunNumber;
+			DTreeBranchHandle<ULong64_t> dEventNumber;
+			DThrownBranchHandles_t dThrown;
+		};
+
 		//TREE INTERFACES, FILL OBJECTS
 		//The non-thrown objects are created during the constructor, and thus the maps can remain const
 		//The thrown objects are created later by the user (so they can specify file name), when the object is const, so they are declared mutable
@@ -105,6 +274,8 @@ class DEventWriterROOT : public JObject
 		mutable DTreeFillData dThrownTreeFillData;
 		map<const DReaction*, DTreeInterface*> dTreeInterfaceMap;
 		map<const DReaction*, DTreeFillData*> dTreeFillDataMap;
+		mutable DThrownTreeBranchHandles_t dThrownTreeBranchHandles;
+		map<const DReaction*, DDataTreeBranchHandles_t> dTreeBranchHandlesMap;
 
 		map<const DReaction*, const DReactionVertexInfo*> dVertexInfoMap;
 
@@ -127,15 +298,20 @@ class DEventWriterROOT : public JObject
 		void Create_Branches_ComboTrack(DTreeBranchRegister& locTreeBranchRegister, string locParticleBranchName, DKinFitType locKinFitType) const;
 		void Create_Branches_ComboNeutral(DTreeBranchRegister& locTreeBranchRegister, string locParticleBranchName, DKinFitType locKinFitType) const;
 
+		//TREE CREATION: BRANCH HANDLES (for this thread's fill data)
+		void Create_BranchHandles_DataTree(const DReaction* locReaction, bool locIsMCDataFlag);
+		void Create_BranchHandles_Thrown(DTreeFillData* locTreeFillData, DThrownBranchHandles_t& locBranchHandles, bool locIsOnlyThrownFlag) const;
+		void Create_BranchHandles_ComboParticle(DTreeFillData* locTreeFillData, string locParticleBranchName, DComboParticleBranchHandles_t& locBranchHandles) const;
+
 		//TREE FILLING: THROWN INFO
 		void Compute_ThrownPIDInfo(const vector<const DMCThrown*>& locMCThrowns_FinalState, const vector<const DMCThrown*>& locMCThrowns_Decaying,
 				ULong64_t& locNumPIDThrown_FinalState, ULong64_t& locPIDThrown_Decaying) const;
 		void Group_ThrownParticles(const vector<const DMCThrown*>& locMCThrowns_FinalState, const vector<const DMCThrown*>& locMCThrowns_Decaying,
 				vector<const DMCThrown*>& locMCThrownsToSave, map<const DMCThrown*, unsigned int>& locThrownIndexMap) const;
-		void Fill_ThrownInfo(DTreeFillData* locTreeFillData, const DMCReaction* locMCReaction, const DBeamPhoton* locTaggedMCGenBeam, const vector<const DMCThrown*>& locMCThrowns,
+		void Fill_ThrownInfo(DTreeFillData* locTreeFillData, const DThrownBranchHandles_t& locBranchHandles, const DMCReaction* locMCReaction, const DBeamPhoton* locTaggedMCGenBeam, const vector<const DMCThrown*>& locMCThrowns,
 				const map<const DMCThrown*, unsigned int>& locThrownIndexMap, ULong64_t locNumPIDThrown_FinalState, ULong64_t locPIDThrown_Decaying,
 				const DMCThrownMatching* locMCThrownMatching = NULL) const;
-		void Fill_ThrownParticleData(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DMCThrown* locMCThrown, 
+		void Fill_ThrownParticleData(DTreeFillData* locTreeFillData, const DThrownBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DMCThrown* locMCThrown, 
 				const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DMCThrownMatching* locMCThrownMatching) const;
 
 		//TREE FILLING: GET HYPOTHESES/BEAM
@@ -146,22 +322,22 @@ class DEventWriterROOT : public JObject
 		vector<const DNeutralParticleHypothesis*> Get_NeutralHypotheses_Used(JEventLoop* locEventLoop, const DReaction* locReaction, const set<Particle_t>& locReactionPIDs, const deque<const DParticleCombo*>& locParticleCombos) const;
 
 		//TREE FILLING: INDEPENDENT PARTICLES
-		void Fill_BeamData(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DBeamPhoton* locBeamPhoton, const DVertex* locVertex, const DMCThrownMatching* locMCThrownMatching) const;
-		void Fill_ChargedHypo(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DChargedTrackHypothesis* locChargedTrackHypothesis, const DMCThrownMatching* locMCThrownMatching,
+		void Fill_BeamData(DTreeFillData* locTreeFillData, const DBeamBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DBeamPhoton* locBeamPhoton, const DVertex* locVertex, const DMCThrownMatching* locMCThrownMatching) const;
+		void Fill_ChargedHypo(DTreeFillData* locTreeFillData, const DChargedHypoBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DChargedTrackHypothesis* locChargedTrackHypothesis, const DMCThrownMatching* locMCThrownMatching,
 				const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DDetectorMatches* locDetectorMatches) const;
-		void Fill_NeutralHypo(DTreeFillData* locTreeFillData, unsigned int locArrayIndex, const DNeutralParticleHypothesis* locPhotonHypothesis, const DMCThrownMatching* locMCThrownMatching,
+		void Fill_NeutralHypo(DTreeFillData* locTreeFillData, const DNeutralHypoBranchHandles_t& locBranchHandles, unsigned int locArrayIndex, const DNeutralParticleHypothesis* locPhotonHypothesis, const DMCThrownMatching* locMCThrownMatching,
 				const map<const DMCThrown*, unsigned int>& locThrownIndexMap, const DDetectorMatches* locDetectorMatches) const;
 
 		//TREE FILLING: COMBO
-		void Fill_ComboData(DTreeFillData* locTreeFillData, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locComboIndex, const map<pair<oid_t, Particle_t>, size_t>& locObjectToArrayIndexMap) const;
-		void Fill_ComboStepData(DTreeFillData* locTreeFillData, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locStepIndex, unsigned int locComboIndex,
+		void Fill_ComboData(DTreeFillData* locTreeFillData, const DDataTreeBranchHandles_t& locBranchHandles, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locComboIndex, const map<pair<oid_t, Particle_t>, size_t>& locObjectToArrayIndexMap) const;
+		void Fill_ComboStepData(DTreeFillData* locTreeFillData, const DDataTreeBranchHandles_t& locBranchHandles, const DReaction* locReaction, const DParticleCombo* locParticleCombo, unsigned int locStepIndex, unsigned int locComboIndex,
 				DKinFitType locKinFitType, const map<pair<oid_t, Particle_t>, size_t>& locObjectToArrayIndexMap) const;
 
 		//TREE FILLING: COMBO PARTICLES
-		void Fill_ComboBeamData(DTreeFillData* locTreeFillData, unsigned int locComboIndex, const DBeamPhoton* locBeamPhoton, size_t locBeamIndex, DKinFitType locKinFitType) const;
-		void Fill_ComboChargedData(DTreeFillData* locTreeFillData, unsigned int locComboIndex, string locParticleBranchName, const DChargedTrackHypothesis* locMeasuredChargedHypo,
+		void Fill_ComboBeamData(DTreeFillData* locTreeFillData, const DComboBeamBranchHandles_t& locBranchHandles, unsigned int locComboIndex, const DBeamPhoton* locBeamPhoton, size_t locBeamIndex, DKinFitType locKinFitType) const;
+		void Fill_ComboChargedData(DTreeFillData* locTreeFillData, const DComboParticleBranchHandles_t& locBranchHandles, unsigned int locComboIndex, const DChargedTrackHypothesis* locMeasuredChargedHypo,
 				const DChargedTrackHypothesis* locChargedHypo, size_t locChargedIndex, DKinFitType locKinFitType) const;
-		void Fill_ComboNeutralData(DTreeFillData* locTreeFillData, unsigned int locComboIndex, string locParticleBranchName, const DNeutralParticleHypothesis* locMeasuredNeutralHypo,
+		void Fill_ComboNeutralData(DTreeFillData* locTreeFillData, const DComboParticleBranchHandles_t& locBranchHandles, unsigned int locComboIndex, const DNeutralParticleHypothesis* locMeasuredNeutralHypo,
 				const DNeutralParticleHypothesis* locNeutralHypo, size_t locNeutralIndex, DKinFitType locKinFitType) const;
 };
 
@@ -3320,7 +3320,7 @@ bool DHistogramAction_TrackShowerErrors::Perform_Action(JEventLoop* locEventLoop
 		double locTheta = locMomentum.Theta()*180.0/TMath::Pi();
 		double locP = locMomentum.Mag();
 
-		const TMatrixFSym& locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix().get());
+		const DMatrixFSym7& locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix());
 		double locPxError = sqrt(locCovarianceMatrix(0, 0));
 		double locPyError = sqrt(locCovarianceMatrix(1, 1));
 		double locPzError = sqrt(locCovarianceMatrix(2, 2));
@@ -477,7 +477,7 @@ void DHistogramAction_ParticleComboGenReconComparison::Fill_ChargedHists(const D
 	double locDeltaPhi = locChargedTrackHypothesis->momentum().Phi()*180.0/TMath::Pi() - locMCThrown->momentum().Phi()*180.0/TMath::Pi();
 	double locDeltaT = locChargedTrackHypothesis->time() - locMCThrown->time(); //time comparison isn't fair if track comes from a detached vertex!!!
 	double locDeltaVertexZ = locChargedTrackHypothesis->position().Z() - locMCThrown->position().Z();
-	const TMatrixDSym& locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix().get());
+	const DMatrixFSym7& locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix());
 
 	double locStartTime = locThrownEventRFBunch->dTime + (locMCThrown->z() - dTargetZCenter)/29.9792458;
 	double locTimePull = (locStartTime - locChargedTrackHypothesis->time())/sqrt(locCovarianceMatrix(6, 6));
@@ -595,7 +595,7 @@ void DHistogramAction_ParticleComboGenReconComparison::Fill_NeutralHists(const D
 
 		if(locCovarianceMatrix != nullptr)
 		{
-			TMatrixDSym locCovCopy = *locCovarianceMatrix;
+			TMatrixDSym locCovCopy = TMatrixFSym(*locCovarianceMatrix);
 			locCovCopy.Similarity(locJacobian);
 			double locEUncertainty = sqrt(locCovCopy(0, 0));
 			locEPull = (locNeutralParticleHypothesis->energy() - locMCThrown->energy())/locEUncertainty;
@@ -1322,7 +1322,7 @@ bool DHistogramAction_GenReconTrackComparison::Perform_Action(JEventLoop* locEve
 		locDeltaPhi = locChargedTrackHypothesis->momentum().Phi()*180.0/TMath::Pi() - locMCThrown->momentum().Phi()*180.0/TMath::Pi();
 		locDeltaT = locChargedTrackHypothesis->time() - locMCThrown->time(); //time comparison isn't fair if track comes from a detached vertex!!!
 		locDeltaVertexZ = locChargedTrackHypothesis->position().Z() - locMCThrown->position().Z();
-		const TMatrixDSym& locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix().get());
+		const DMatrixFSym7& locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix());
 
 		const DTrackTimeBased* locTrackTimeBased = locChargedTrackHypothesis->Get_TrackTimeBased();
 
@@ -1439,7 +1439,7 @@ bool DHistogramAction_GenReconTrackComparison::Perform_Action(JEventLoop* locEve
 		locDeltaPhi = locNeutralParticleHypothesis->momentum().Phi()*180.0/TMath::Pi() - locMCThrown->momentum().Phi()*180.0/TMath::Pi();
 		locDeltaT = locNeutralParticleHypothesis->time() - locMCThrown->time(); //time comparison isn't fair if track comes from a detached vertex!!!
 		locDeltaVertexZ = locNeutralParticleHypothesis->position().Z() - locMCThrown->position().Z();
-		const TMatrixDSym& locCovarianceMatrix = *(locNeutralParticleHypothesis->errorMatrix().get());
+		const DMatrixFSym7& locCovarianceMatrix = *(locNeutralParticleHypothesis->errorMatrix());
 
 		double locStartTime = locThrownEventRFBunch->dTime + (locMCThrown->z() - dTargetZCenter)/29.9792458;
 		double locTimePull = (locStartTime - locNeutralParticleHypothesis->time())/sqrt(locCovarianceMatrix(6, 6));
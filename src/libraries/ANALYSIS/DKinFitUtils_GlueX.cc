@@ -82,7 +82,7 @@ shared_ptr<DKinFitParticle> DKinFitUtils_GlueX::Make_BeamParticle(const DBeamPho
 	TVector3 locMomentum = Make_TVector3(locBeamPhoton->momentum());
 	Particle_t locPID = locBeamPhoton->PID();
 
-	auto locKinFitParticle = DKinFitUtils::Make_BeamParticle(PDGtype(locPID), ParticleCharge(locPID), ParticleMass(locPID), locSpacetimeVertex, locMomentum, locBeamPhoton->errorMatrix());
+	auto locKinFitParticle = DKinFitUtils::Make_BeamParticle(PDGtype(locPID), ParticleCharge(locPID), ParticleMass(locPID), locSpacetimeVertex, locMomentum, Make_KinFitCovarianceMatrix(locBeamPhoton->errorMatrix()));
 	dParticleMap_SourceToInput_Beam[locSourcePair] = locKinFitParticle;
 	dParticleMap_InputToSource_JObject[locKinFitParticle] = locBeamPhoton;
 	return locKinFitParticle;
@@ -101,7 +101,7 @@ shared_ptr<DKinFitParticle> DKinFitUtils_GlueX::Make_BeamParticle(const DBeamPho
 
 	//set rf time variance in covariance matrix
 	auto locCovarianceMatrix = Get_SymMatrixResource(7);
-	*locCovarianceMatrix = *(locBeamPhoton->errorMatrix());
+	locBeamPhoton->errorMatrix()->Get(*locCovarianceMatrix);
 	(*locCovarianceMatrix)(6, 6) = locEventRFBunch->dTimeVariance;
 	//zero the correlation terms
 	for(int loc_i = 0; loc_i < 6; ++loc_i)
@@ -136,12 +136,21 @@ shared_ptr<DKinFitParticle> DKinFitUtils_GlueX::Make_DetectedParticle(const DKin
 			locPathLength = locNeutralHypo->Get_PathLength();
 	}
 
-	auto locKinFitParticle = DKinFitUtils::Make_DetectedParticle(PDGtype(locPID), ParticleCharge(locPID), ParticleMass(locPID), locSpacetimeVertex, locMomentum, locPathLength, locKinematicData->errorMatrix());
+	auto locKinFitParticle = DKinFitUtils::Make_DetectedParticle(PDGtype(locPID), ParticleCharge(locPID), ParticleMass(locPID), locSpacetimeVertex, locMomentum, locPathLength, Make_KinFitCovarianceMatrix(locKinematicData->errorMatrix()));
 	dParticleMap_SourceToInput_DetectedParticle[locKinematicData] = locKinFitParticle;
 	dParticleMap_InputToSource_JObject[locKinFitParticle] = locKinematicData;
 	return locKinFitParticle;
 }
 
+shared_ptr<TMatrixFSym> DKinFitUtils_GlueX::Make_KinFitCovarianceMatrix(const DMatrixFSym7* locErrorMatrix)
+{
+	if(locErrorMatrix == nullptr)
+		return nullptr;
+	auto locCovarianceMatrix = Get_SymMatrixResource(7);
+	locErrorMatrix->Get(*locCovarianceMatrix);
+	return locCovarianceMatrix;
+}
+
 shared_ptr<DKinFitParticle> DKinFitUtils_GlueX::Make_DetectedShower(const DNeutralShower* locNeutralShower, Particle_t locPID)
 {
 	pair<const DNeutralShower*, Particle_t> locSourcePair(locNeutralShower, locPID);
@@ -906,8 +915,7 @@ bool DKinFitUtils_GlueX::Propagate_TrackInfoToCommonVertex(DKinematicData* locKi
 		return false;
 
 	//Convert 10x10 to 7x7
-	auto locCovarianceMatrix = Get_SymMatrixResource(7);
-	*locCovarianceMatrix = locTempCovarianceMatrix.GetSub(0, 6, *locCovarianceMatrix);
+	DMatrixFSym7 locCovarianceMatrix(locTempCovarianceMatrix);
 
 	locKinematicData->setMomentum(DVector3(locMomentum.X(),locMomentum.Y(),locMomentum.Z()));
 	locKinematicData->setPosition(DVector3(locSpacetimeVertex.Vect().X(),locSpacetimeVertex.Vect().Y(),locSpacetimeVertex.Vect().Z()));
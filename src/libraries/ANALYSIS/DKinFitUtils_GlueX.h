@@ -103,6 +103,9 @@ class DKinFitUtils_GlueX : public DKinFitUtils
 		//PRIVATE DEFAULT CONSTRUCTOR
 		DKinFitUtils_GlueX(void){} //Cannot use default constructor. Must construct with DMagneticFieldMap as argument
 
+		//Kinfit particles take their covariance as a (pooled) TMatrixFSym: nullptr if none
+		shared_ptr<TMatrixFSym> Make_KinFitCovarianceMatrix(const DMatrixFSym7* locErrorMatrix);
+
 		/************************************************************ CREATE DKINFITCHAIN ***********************************************************/
 
 		shared_ptr<DKinFitChainStep> Make_KinFitChainStep(const DReactionVertexInfo* locReactionVertexInfo, const DReaction* locReaction, const DParticleCombo* locParticleCombo, DKinFitType locKinFitType, size_t locStepIndex, const shared_ptr<DKinFitChain>& locKinFitChain);
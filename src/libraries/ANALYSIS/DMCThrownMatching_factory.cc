@@ -723,7 +723,7 @@ void DMCThrownMatching_factory::Find_GenReconMatches_NeutralHypo(const vector<co
 	locMCThrownMatching->Set_ThrownToNeutralHypoMap(locThrownToNeutralMap);
 }
 
-bool DMCThrownMatching_factory::Calc_InverseMatrix(const TMatrixFSym& locInputCovarianceMatrix, TMatrixDSym& locInverse3x3Matrix) const
+bool DMCThrownMatching_factory::Calc_InverseMatrix(const DMatrixFSym7& locInputCovarianceMatrix, TMatrixDSym& locInverse3x3Matrix) const
 {
 	double locTotalError = sqrt(locInputCovarianceMatrix(0, 0) + locInputCovarianceMatrix(1, 1) + locInputCovarianceMatrix(2, 2));
 	if(locTotalError >= dMaxTotalParticleErrorForMatch)
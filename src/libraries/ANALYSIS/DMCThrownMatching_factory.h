@@ -39,7 +39,7 @@ using namespace std;
 class DMCThrownMatching_factory : public jana::JFactory<DMCThrownMatching>
 {
 	public:
-		bool Calc_InverseMatrix(const TMatrixFSym& locInputCovarianceMatrix, TMatrixDSym& locInverse3x3Matrix) const;
+		bool Calc_InverseMatrix(const DMatrixFSym7& locInputCovarianceMatrix, TMatrixDSym& locInverse3x3Matrix) const;
 		double Calc_MatchFOM(const DVector3& locMomentum_Thrown, const DVector3& locMomentum_Detected, TMatrixDSym locInverse3x3Matrix) const;
 
 	private:
@@ -11,6 +11,7 @@
 #include "ANALYSIS/DParticleComboStep.h"
 #include "ANALYSIS/DKinFitResults.h"
 #include "ANALYSIS/DReaction.h"
+#include "ANALYSIS/DParticleComboP4Cache.h"
 
 using namespace std;
 using namespace DAnalysis;
@@ -25,11 +26,11 @@ class DParticleCombo : public DResettable
 		void Release(void){Reset();};
 
 		// SET STEPS
-		void Add_ParticleComboStep(const DParticleComboStep* locParticleComboStep){dParticleComboSteps.push_back(locParticleComboStep);}
+		void Add_ParticleComboStep(const DParticleComboStep* locParticleComboStep){dParticleComboSteps.push_back(locParticleComboStep); dP4Cache.Clear();}
 		void Set_ParticleComboStep(const DParticleComboStep* locParticleComboStep, size_t locStepIndex);
 
 		// SET OBJECT DATA:
-		void Set_KinFitResults(const DKinFitResults* locKinFitResults){dKinFitResults = locKinFitResults;}
+		void Set_KinFitResults(const DKinFitResults* locKinFitResults){dKinFitResults = locKinFitResults; dP4Cache.Clear();}
 		void Set_EventRFBunch(const DEventRFBunch* locEventRFBunch){dEventRFBunch = locEventRFBunch;}
 
 		// GET OBJECT DATA:
@@ -54,11 +55,15 @@ class DParticleCombo : public DResettable
 		// OTHER:
 		DLorentzVector Get_EventVertex(void) const;
 
+		//missing & final-state p4's already computed for this combo (see DAnalysisUtilities)
+		DParticleComboP4Cache& Get_P4Cache(void) const{return dP4Cache;}
+
 	private:
 
 		const DKinFitResults* dKinFitResults;
 		const DEventRFBunch* dEventRFBunch;
 		vector<const DParticleComboStep*> dParticleComboSteps;
+		mutable DParticleComboP4Cache dP4Cache;
 };
 
 inline void DParticleCombo::Reset(void)
@@ -66,6 +71,7 @@ inline void DParticleCombo::Reset(void)
 	dKinFitResults = NULL;
 	dEventRFBunch = NULL;
 	dParticleComboSteps.clear();
+	dP4Cache.Clear();
 }
 
 inline const DParticleComboStep* DParticleCombo::Get_ParticleComboStep(size_t locStepIndex) const
@@ -80,6 +86,7 @@ inline void DParticleCombo::Set_ParticleComboStep(const DParticleComboStep* locP
 	if(locStepIndex >= Get_NumParticleComboSteps())
 		return;
 	dParticleComboSteps[locStepIndex] = locParticleComboStep;
+	dP4Cache.Clear();
 }
 
 inline DLorentzVector DParticleCombo::Get_EventVertex(void) const
@@ -0,0 +1,91 @@
+#ifndef _DParticleComboP4Cache_
+#define _DParticleComboP4Cache_
+
+#include <set>
+#include <vector>
+#include <utility>
+
+#include "JANA/JObject.h"
+#include "DLorentzVector.h"
+#include "ANALYSIS/DReaction.h"
+
+using namespace std;
+using namespace jana;
+
+namespace DAnalysis
+{
+
+/*
+Results of DAnalysisUtilities::Calc_MissingP4() and Calc_FinalStateP4() for one combo.
+Many actions ask for the same missing/final-state p4 of the same combo; the first call walks the decay chain, the others are served from here.
+Entries are keyed by reaction, step, up-to step (missing p4 only), particle indices and kinfit flag, and hold the p4 and the source objects it was built from.
+The cache is owned by the DParticleCombo and is cleared when it is reset or its contents are changed.
+*/
+
+enum DComboP4Type_t
+{
+	d_ComboMissingP4 = 0,
+	d_ComboFinalStateP4
+};
+
+class DParticleComboP4Cache
+{
+	public:
+		const DLorentzVector* Find(DComboP4Type_t locType, const DReaction* locReaction, size_t locStepIndex, int locUpToStepIndex, const set<size_t>& locIndices,
+				bool locUseKinFitDataFlag, set<pair<const JObject*, unsigned int> >& locSourceObjects) const;
+		void Add(DComboP4Type_t locType, const DReaction* locReaction, size_t locStepIndex, int locUpToStepIndex, const set<size_t>& locIndices,
+				bool locUseKinFitDataFlag, const DLorentzVector& locP4, const set<pair<const JObject*, unsigned int> >& locSourceObjects);
+		void Clear(void){dEntries.clear();}
+
+	private:
+
+		struct DEntry_t
+		{
+			DComboP4Type_t dType;
+			const DReaction* dReaction;
+			size_t dStepIndex;
+			int dUpToStepIndex;
+			set<size_t> dIndices;
+			bool dUseKinFitDataFlag;
+
+			DLorentzVector dP4;
+			vector<pair<const JObject*, unsigned int> > dSourceObjects;
+		};
+
+		//few entries per combo: linear search
+		vector<DEntry_t> dEntries;
+};
+
+inline const DLorentzVector* DParticleComboP4Cache::Find(DComboP4Type_t locType, const DReaction* locReaction, size_t locStepIndex, int locUpToStepIndex,
+		const set<size_t>& locIndices, bool locUseKinFitDataFlag, set<pair<const JObject*, unsigned int> >& locSourceObjects) const
+{
+	for(auto& locEntry : dEntries)
+	{
+		if((locEntry.dType != locType) || (locEntry.dStepIndex != locStepIndex) || (locEntry.dUpToStepIndex != locUpToStepIndex))
+			continue;
+		if((locEntry.dUseKinFitDataFlag != locUseKinFitDataFlag) || (locEntry.dReaction != locReaction) || (locEntry.dIndices != locIndices))
+			continue;
+		locSourceObjects.insert(locEntry.dSourceObjects.begin(), locEntry.dSourceObjects.end());
+		return &locEntry.dP4;
+	}
+	return nullptr;
+}
+
+inline void DParticleComboP4Cache::Add(DComboP4Type_t locType, const DReaction* locReaction, size_t locStepIndex, int locUpToStepIndex, const set<size_t>& locIndices,
+		bool locUseKinFitDataFlag, const DLorentzVector& locP4, const set<pair<const JObject*, unsigned int> >& locSourceObjects)
+{
+	dEntries.emplace_back();
+	auto& locEntry = dEntries.back();
+	locEntry.dType = locType;
+	locEntry.dReaction = locReaction;
+	locEntry.dStepIndex = locStepIndex;
+	locEntry.dUpToStepIndex = locUpToStepIndex;
+	locEntry.dIndices = locIndices;
+	locEntry.dUseKinFitDataFlag = locUseKinFitDataFlag;
+	locEntry.dP4 = locP4;
+	locEntry.dSourceObjects.assign(locSourceObjects.begin(), locSourceObjects.end());
+}
+
+} //end DAnalysis namespace
+
+#endif // _DParticleComboP4Cache_
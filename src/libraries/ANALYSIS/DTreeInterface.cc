@@ -1,4 +1,5 @@
 #include "DTreeInterface.h"
+#include <JANA/JParameterManager.h>
 
 /************************************************* STATIC-VARIABLE-ACCESSING PRIVATE MEMBER FUNCTIONS *************************************************/
 
@@ -53,11 +54,29 @@ dTreeIndex_MajorBranchName("0"), dTreeIndex_MinorBranchName("0")
 	japp->RootUnLock();
 
 	GetOrCreate_FileAndTree(locTreeName);
+
+	//buffered output
+	bool locUseWriterThreadFlag = false;
+	size_t locMaxQueueSize = 200;
+	gPARMS->SetDefaultParameter("ANALYSIS:TREE_WRITER_THREAD", locUseWriterThreadFlag, "Fill the output trees in a separate thread per output file (1) instead of in the processing threads (0)");
+	gPARMS->SetDefaultParameter("ANALYSIS:TREE_WRITER_QUEUE_SIZE", locMaxQueueSize, "Max # of tree entries waiting to be written by each tree writer thread");
+	if(locUseWriterThreadFlag)
+		dWriterThread = DTreeWriterThread::Acquire(dFileName, locMaxQueueSize);
 }
 
 //Destructor
 DTreeInterface::~DTreeInterface(void)
 {
+	//write what is still queued for this tree
+	if(dWriterThread != nullptr)
+	{
+		dWriterThread->Flush(this);
+		dWriterThread = nullptr;
+		DTreeWriterThread::Release(dFileName);
+	}
+	for(auto& locFillBuffer : dFillBuffers)
+		delete locFillBuffer;
+
 	japp->RootWriteLock();
 	{
 		map<string, int>& locNumWritersByFileMap = Get_NumWritersByFileMap();
@@ -239,64 +258,97 @@ void DTreeInterface::Create_Branch(string locBranchName, type_index locTypeIndex
 /**************************************************************** FILL BRANCHES & TREE ****************************************************************/
 
 void DTreeInterface::Fill(DTreeFillData& locTreeFillData)
+{
+	if(dWriterThread == nullptr)
+	{
+		Fill_Tree(locTreeFillData);
+		return;
+	}
+
+	//buffered: copy the data (resets the input for the next entry), queue it for the writer thread
+	auto locFillBuffer = Get_FillBuffer();
+	locFillBuffer->Take_Data(locTreeFillData);
+	dWriterThread->Enqueue(this, locFillBuffer);
+}
+
+DTreeFillData* DTreeInterface::Get_FillBuffer(void)
+{
+	{
+		lock_guard<mutex> locLock(dFillBufferMutex);
+		if(!dFillBuffers.empty())
+		{
+			auto locFillBuffer = dFillBuffers.back();
+			dFillBuffers.pop_back();
+			return locFillBuffer;
+		}
+	}
+	return new DTreeFillData();
+}
+
+void DTreeInterface::Write_Buffer(DTreeFillData* locFillBuffer)
+{
+	Fill_Tree(*locFillBuffer);
+
+	lock_guard<mutex> locLock(dFillBufferMutex);
+	dFillBuffers.push_back(locFillBuffer);
+}
+
+void DTreeInterface::Fill_Tree(DTreeFillData& locTreeFillData)
 {
 	//MUST CARRY AROUND A REFERENCE TO THIS.  ONLY READ/MODIFY THE MAP WITHIN A FILE LOCK. 
 	map<string, size_t>& locFundamentalArraySizeMap = Get_FundamentalArraySizeMap(dTree);
 	japp->WriteLock(dFileName); //LOCK FILE
 	{
+		//branch lookups are only done when the plan is (re)compiled: first fill, or new branches in the fill data
+		auto& locFillPlan = locTreeFillData.dFillPlan;
+		if((locTreeFillData.dFillPlanInterface != this) || (locFillPlan.size() != locTreeFillData.dFillSlots.size()))
+			Compile_FillPlan(locTreeFillData, locFundamentalArraySizeMap);
+
 		//loop over branches
-		for(auto locBranchPair : locTreeFillData.dFillData)
+		for(size_t loc_i = 0; loc_i < locFillPlan.size(); ++loc_i)
 		{
-			//type
-			auto locBranchName = locBranchPair.first;
-			auto locTypeIndex = locBranchPair.second.first;
-			auto locFillBaseClass = locBranchPair.second.second;
+			auto& locFillSlot = locTreeFillData.dFillSlots[loc_i];
+			if(!locFillSlot.dHasDataFlag)
+				continue; //handle registered, but never filled
 
-			if(dTree->GetBranch(locBranchName.c_str()) == NULL)
+			auto& locFillStep = locFillPlan[loc_i];
+			if(locFillStep.dBranch == NULL)
 			{
-				cout << "WARNING, CANNOT FILL DATA, BRANCH " << locBranchName << " DOES NOT EXIST." << endl;
-				continue;
+				Compile_FillStep(locFillSlot.dBranchName, locFillStep, locFundamentalArraySizeMap); //may have been created since
+				if(locFillStep.dBranch == NULL)
+				{
+					cout << "WARNING, CANNOT FILL DATA, BRANCH " << locFillSlot.dBranchName << " DOES NOT EXIST." << endl;
+					continue;
+				}
 			}
 
 			//check if is array. if not, fill
-			auto locLargestIndexFilledIterator = locTreeFillData.dArrayLargestIndexFilledMap.find(locBranchName);
-			bool locIsArrayFlag = (locLargestIndexFilledIterator != locTreeFillData.dArrayLargestIndexFilledMap.end());
-			if(!locIsArrayFlag)
+			auto locFillBaseClass = locFillSlot.dFillClass;
+			if(!locFillSlot.dIsArrayFlag)
 			{
-				Fill(locBranchName, locTypeIndex, locFillBaseClass->Get(0), false);
+				Fill(locFillStep, locFillBaseClass->Get(0), false);
 				continue;
 			}
 
 			//is array, get how many to fill
-			auto& locLargestIndexFilled = locLargestIndexFilledIterator->second;
+			auto& locLargestIndexFilled = locFillSlot.dLargestIndexFilled;
 
-			//increase array size if necessary, or decrease if too large from last event
-			auto locFundamentalArraySizeIterator = locFundamentalArraySizeMap.find(locBranchName);
-			if(locFundamentalArraySizeIterator != locFundamentalArraySizeMap.end())
+			//increase array size if necessary
+			if(locFillStep.dFundamentalArraySize != nullptr)
 			{
-				size_t locCurrentArraySize = locFundamentalArraySizeMap[locBranchName]; //may not be in map! (tobj)
+				size_t& locCurrentArraySize = *locFillStep.dFundamentalArraySize;
 				if((locLargestIndexFilled + 1) > int(locCurrentArraySize))
 				{
-					Change_ArraySize(locBranchName, locTypeIndex, locLargestIndexFilled + 1);
-					locFundamentalArraySizeMap[locBranchName] = locLargestIndexFilled + 1;
+					Change_ArraySize(locFillStep.dBranch, locFillStep.dFillType, locLargestIndexFilled + 1);
+					locCurrentArraySize = locLargestIndexFilled + 1;
 				}
-/*				else if(locCurrentArraySize > dMaxArraySize)
-				{
-					Change_ArraySize(locBranchName, locTypeIndex, dMaxArraySize);
-					locFundamentalArraySizeMap[locBranchName] = dMaxArraySize;
-				} */
 			}
 			else //is clones array: clear it
-			{
-				auto locClonesArray = Get_Pointer_TClonesArray(locBranchName);
-				locClonesArray->Clear(); //empties array
-//				if(size_t(locClonesArray->GetEntriesFast()) > dMaxArraySize)
-//					locClonesArray->Expand(dMaxArraySize);
-			}
+				Get_Pointer_TClonesArray(locFillStep.dBranch)->Clear(); //empties array
 
 			//fill array
 			for(int locArrayIndex = 0; locArrayIndex <= locLargestIndexFilled; ++locArrayIndex)
-				Fill(locBranchName, locTypeIndex, locFillBaseClass->Get(locArrayIndex), true, locArrayIndex);
+				Fill(locFillStep, locFillBaseClass->Get(locArrayIndex), true, locArrayIndex);
 
 			//reset DTreeFillData for next event!
 			locLargestIndexFilled = -1;
@@ -308,77 +360,143 @@ void DTreeInterface::Fill(DTreeFillData& locTreeFillData)
 	japp->Unlock(dFileName); //UNLOCK FILE
 
 	//Reset fill vectors if too large!!
-	for(auto locBranchPair : locTreeFillData.dFillData)
-		locBranchPair.second.second->Check_Capacity();
+	for(auto& locFillSlot : locTreeFillData.dFillSlots)
+		locFillSlot.dFillClass->Check_Capacity();
 }
 
-void DTreeInterface::Change_ArraySize(string locBranchName, type_index locTypeIndex, size_t locNewArraySize)
+void DTreeInterface::Compile_FillPlan(DTreeFillData& locTreeFillData, map<string, size_t>& locFundamentalArraySizeMap) const
 {
-	//Fundamental types
-	if(locTypeIndex == type_index(typeid(Char_t)))
-		Change_ArraySize<Char_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(UChar_t)))
-		Change_ArraySize<UChar_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Short_t)))
-		Change_ArraySize<Short_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(UShort_t)))
-		Change_ArraySize<UShort_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Int_t)))
-		Change_ArraySize<Int_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(UInt_t)))
-		Change_ArraySize<UInt_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Float_t)))
-		Change_ArraySize<Float_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Double_t)))
-		Change_ArraySize<Double_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Long64_t)))
-		Change_ArraySize<Long64_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(ULong64_t)))
-		Change_ArraySize<ULong64_t>(locBranchName, locNewArraySize);
-	else if(locTypeIndex == type_index(typeid(Bool_t)))
-		Change_ArraySize<Bool_t>(locBranchName, locNewArraySize);
+	//MUST BE CALLED WITHIN THE FILE LOCK
+	auto& locFillPlan = locTreeFillData.dFillPlan;
+	locFillPlan.resize(locTreeFillData.dFillSlots.size());
+	for(size_t loc_i = 0; loc_i < locFillPlan.size(); ++loc_i)
+	{
+		auto& locFillSlot = locTreeFillData.dFillSlots[loc_i];
+		locFillPlan[loc_i].dFillType = Get_FillType(locFillSlot.dTypeIndex);
+		Compile_FillStep(locFillSlot.dBranchName, locFillPlan[loc_i], locFundamentalArraySizeMap);
+	}
+	locTreeFillData.dFillPlanInterface = this;
 }
 
-void DTreeInterface::Fill(string locBranchName, type_index locTypeIndex, void* locVoidPointer, bool locIsArrayFlag, size_t locArrayIndex)
+void DTreeInterface::Compile_FillStep(const string& locBranchName, DTreeFillStep_t& locFillStep, map<string, size_t>& locFundamentalArraySizeMap) const
+{
+	//MUST BE CALLED WITHIN THE FILE LOCK
+	locFillStep.dBranch = dTree->GetBranch(locBranchName.c_str());
+
+	//map entries aren't moved by later insertions: can keep a pointer
+	auto locFundamentalArraySizeIterator = locFundamentalArraySizeMap.find(locBranchName);
+	locFillStep.dFundamentalArraySize = (locFundamentalArraySizeIterator != locFundamentalArraySizeMap.end()) ? &(locFundamentalArraySizeIterator->second) : nullptr;
+}
+
+DTreeFillType_t DTreeInterface::Get_FillType(type_index locTypeIndex)
 {
 	//Fundamental types
 	if(locTypeIndex == type_index(typeid(Char_t)))
-		Get_Pointer_Fundamental<Char_t>(locBranchName)[locArrayIndex] = *(static_cast<Char_t*>(locVoidPointer));
+		return d_TreeFill_Char;
 	else if(locTypeIndex == type_index(typeid(UChar_t)))
-		Get_Pointer_Fundamental<UChar_t>(locBranchName)[locArrayIndex] = *(static_cast<UChar_t*>(locVoidPointer));
+		return d_TreeFill_UChar;
 	else if(locTypeIndex == type_index(typeid(Short_t)))
-		Get_Pointer_Fundamental<Short_t>(locBranchName)[locArrayIndex] = *(static_cast<Short_t*>(locVoidPointer));
+		return d_TreeFill_Short;
 	else if(locTypeIndex == type_index(typeid(UShort_t)))
-		Get_Pointer_Fundamental<UShort_t>(locBranchName)[locArrayIndex] = *(static_cast<UShort_t*>(locVoidPointer));
+		return d_TreeFill_UShort;
 	else if(locTypeIndex == type_index(typeid(Int_t)))
-		Get_Pointer_Fundamental<Int_t>(locBranchName)[locArrayIndex] = *(static_cast<Int_t*>(locVoidPointer));
+		return d_TreeFill_Int;
 	else if(locTypeIndex == type_index(typeid(UInt_t)))
-		Get_Pointer_Fundamental<UInt_t>(locBranchName)[locArrayIndex] = *(static_cast<UInt_t*>(locVoidPointer));
+		return d_TreeFill_UInt;
 	else if(locTypeIndex == type_index(typeid(Float_t)))
-		Get_Pointer_Fundamental<Float_t>(locBranchName)[locArrayIndex] = *(static_cast<Float_t*>(locVoidPointer));
+		return d_TreeFill_Float;
 	else if(locTypeIndex == type_index(typeid(Double_t)))
-		Get_Pointer_Fundamental<Double_t>(locBranchName)[locArrayIndex] = *(static_cast<Double_t*>(locVoidPointer));
+		return d_TreeFill_Double;
 	else if(locTypeIndex == type_index(typeid(Long64_t)))
-		Get_Pointer_Fundamental<Long64_t>(locBranchName)[locArrayIndex] = *(static_cast<Long64_t*>(locVoidPointer));
+		return d_TreeFill_Long64;
 	else if(locTypeIndex == type_index(typeid(ULong64_t)))
-		Get_Pointer_Fundamental<ULong64_t>(locBranchName)[locArrayIndex] = *(static_cast<ULong64_t*>(locVoidPointer));
+		return d_TreeFill_ULong64;
 	else if(locTypeIndex == type_index(typeid(Bool_t)))
-		Get_Pointer_Fundamental<Bool_t>(locBranchName)[locArrayIndex] = *(static_cast<Bool_t*>(locVoidPointer));
+		return d_TreeFill_Bool;
 
 	//TObject
-	else if(locTypeIndex == type_index(typeid(TVector3)))
-	{
-		TVector3& locObject = *(static_cast<TVector3*>(locVoidPointer));
-		Fill_TObject<TVector3>(locBranchName, locObject, locIsArrayFlag, locArrayIndex);
-	}
 	else if(locTypeIndex == type_index(typeid(TVector2)))
+		return d_TreeFill_TVector2;
+	else if(locTypeIndex == type_index(typeid(TVector3)))
+		return d_TreeFill_TVector3;
+	else if(locTypeIndex == type_index(typeid(TLorentzVector)))
+		return d_TreeFill_TLorentzVector;
+
+	return d_TreeFill_Unknown;
+}
+
+void DTreeInterface::Change_ArraySize(TBranch* locBranch, DTreeFillType_t locFillType, size_t locNewArraySize)
+{
+	//Fundamental types
+	switch(locFillType)
 	{
-		TVector2& locObject = *(static_cast<TVector2*>(locVoidPointer));
-		Fill_TObject<TVector2>(locBranchName, locObject, locIsArrayFlag, locArrayIndex);
+		case d_TreeFill_Char: Change_ArraySize<Char_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_UChar: Change_ArraySize<UChar_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_Short: Change_ArraySize<Short_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_UShort: Change_ArraySize<UShort_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_Int: Change_ArraySize<Int_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_UInt: Change_ArraySize<UInt_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_Float: Change_ArraySize<Float_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_Double: Change_ArraySize<Double_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_Long64: Change_ArraySize<Long64_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_ULong64: Change_ArraySize<ULong64_t>(locBranch, locNewArraySize); break;
+		case d_TreeFill_Bool: Change_ArraySize<Bool_t>(locBranch, locNewArraySize); break;
+		default: break;
 	}
-	else if(locTypeIndex == type_index(typeid(TLorentzVector)))
+}
+
+void DTreeInterface::Fill(const DTreeFillStep_t& locFillStep, void* locVoidPointer, bool locIsArrayFlag, size_t locArrayIndex)
+{
+	TBranch* locBranch = locFillStep.dBranch;
+	switch(locFillStep.dFillType)
 	{
-		TLorentzVector& locObject = *(static_cast<TLorentzVector*>(locVoidPointer));
-		Fill_TObject<TLorentzVector>(locBranchName, locObject, locIsArrayFlag, locArrayIndex);
+		//Fundamental types
+		case d_TreeFill_Char:
+			Get_Pointer_Fundamental<Char_t>(locBranch)[locArrayIndex] = *(static_cast<Char_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_UChar:
+			Get_Pointer_Fundamental<UChar_t>(locBranch)[locArrayIndex] = *(static_cast<UChar_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_Short:
+			Get_Pointer_Fundamental<Short_t>(locBranch)[locArrayIndex] = *(static_cast<Short_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_UShort:
+			Get_Pointer_Fundamental<UShort_t>(locBranch)[locArrayIndex] = *(static_cast<UShort_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_Int:
+			Get_Pointer_Fundamental<Int_t>(locBranch)[locArrayIndex] = *(static_cast<Int_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_UInt:
+			Get_Pointer_Fundamental<UInt_t>(locBranch)[locArrayIndex] = *(static_cast<UInt_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_Float:
+			Get_Pointer_Fundamental<Float_t>(locBranch)[locArrayIndex] = *(static_cast<Float_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_Double:
+			Get_Pointer_Fundamental<Double_t>(locBranch)[locArrayIndex] = *(static_cast<Double_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_Long64:
+			Get_Pointer_Fundamental<Long64_t>(locBranch)[locArrayIndex] = *(static_cast<Long64_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_ULong64:
+			Get_Pointer_Fundamental<ULong64_t>(locBranch)[locArrayIndex] = *(static_cast<ULong64_t*>(locVoidPointer));
+			break;
+		case d_TreeFill_Bool:
+			Get_Pointer_Fundamental<Bool_t>(locBranch)[locArrayIndex] = *(static_cast<Bool_t*>(locVoidPointer));
+			break;
+
+		//TObject
+		case d_TreeFill_TVector3:
+			Fill_TObject<TVector3>(locBranch, *(static_cast<TVector3*>(locVoidPointer)), locIsArrayFlag, locArrayIndex);
+			break;
+		case d_TreeFill_TVector2:
+			Fill_TObject<TVector2>(locBranch, *(static_cast<TVector2*>(locVoidPointer)), locIsArrayFlag, locArrayIndex);
+			break;
+		case d_TreeFill_TLorentzVector:
+			Fill_TObject<TLorentzVector>(locBranch, *(static_cast<TLorentzVector*>(locVoidPointer)), locIsArrayFlag, locArrayIndex);
+			break;
+
+		default:
+			break;
 	}
 }
@@ -8,6 +8,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <mutex>
 
 #include <TROOT.h>
 #include <TTree.h>
@@ -23,11 +24,14 @@
 #include <particleType.h>
 
 #include "DTreeInterfaceObjects.h"
+#include "DTreeWriterThread.h"
 
 using namespace std;
 
 class DTreeInterface
 {
+	friend class DTreeWriterThread;
+
 	//WARNING: This class ASSUMES that the only things you are saving to the given output files are trees managed by DTreeInterface objects.  
 		//Saving anything else to these files will probably not work!  And would be unwise anyway ...
 
@@ -67,6 +71,9 @@ class DTreeInterface
 
 		void Fill(DTreeFillData& locTreeFillData); //not const: needs to reset arrays
 
+		//Buffered output: if ANALYSIS:TREE_WRITER_THREAD is set, Fill() only copies the data: the tree is filled by the DTreeWriterThread
+		bool Get_BufferedOutputFlag(void) const{return (dWriterThread != nullptr);}
+
 	private:
 
 		/**************************************************************** INITIALIZE ****************************************************************/
@@ -104,16 +111,25 @@ class DTreeInterface
 
 		/******************************************************************* FILL *******************************************************************/
 
-		void Change_ArraySize(string locBranchName, type_index locTypeIndex, size_t locNewArraySize);
-		template <typename DType> void Change_ArraySize(string locBranchName, int locNewArraySize);
-		void Fill(string locBranchName, type_index locTypeIndex, void* locVoidPointer, bool locIsArrayFlag, size_t locArrayIndex = 0);
-		template <typename DType> void Fill_TObject(string locBranchName, DType& locObject, bool locIsArrayFlag, size_t locArrayIndex);
+		void Fill_Tree(DTreeFillData& locTreeFillData);
+		void Write_Buffer(DTreeFillData* locFillBuffer); //called by the writer thread
+		DTreeFillData* Get_FillBuffer(void);
+
+		void Compile_FillPlan(DTreeFillData& locTreeFillData, map<string, size_t>& locFundamentalArraySizeMap) const;
+		void Compile_FillStep(const string& locBranchName, DTreeFillStep_t& locFillStep, map<string, size_t>& locFundamentalArraySizeMap) const;
+		static DTreeFillType_t Get_FillType(type_index locTypeIndex);
+
+		void Change_ArraySize(TBranch* locBranch, DTreeFillType_t locFillType, size_t locNewArraySize);
+		template <typename DType> void Change_ArraySize(TBranch* locBranch, int locNewArraySize);
+		void Fill(const DTreeFillStep_t& locFillStep, void* locVoidPointer, bool locIsArrayFlag, size_t locArrayIndex = 0);
+		template <typename DType> void Fill_TObject(TBranch* locBranch, DType& locObject, bool locIsArrayFlag, size_t locArrayIndex);
 
 		/*************************************************************** GET POINTERS ***************************************************************/
 
-		template <typename DType> DType* Get_Pointer_Fundamental(string locBranchName) const;
-		template <typename DType> DType* Get_Pointer_TObject(string locBranchName) const;
-		TClonesArray* Get_Pointer_TClonesArray(string locBranchName);
+		//From the branch: addresses of fundamental arrays change when they are resized
+		template <typename DType> DType* Get_Pointer_Fundamental(TBranch* locBranch) const;
+		template <typename DType> DType* Get_Pointer_TObject(TBranch* locBranch) const;
+		TClonesArray* Get_Pointer_TClonesArray(TBranch* locBranch) const;
 
 		/******************************************** STATIC-VARIABLE-ACCESSING PRIVATE MEMBER FUNCTIONS ********************************************/
 
@@ -154,27 +170,30 @@ class DTreeInterface
 		Long64_t dAutoFlush = -5000000; //if 200 trees at once, and want them to take at most 1GB of RAM before flush, then flush every 5MB: -5000000 //default every 30MB
 		map<string, TClonesArray*> dMemoryMap_ClonesArray;
 		map<string, TObject*> dMemoryMap_TObject;
+
+		/****************************************************************** BUFFERED OUTPUT *****************************************************************/
+
+		DTreeWriterThread* dWriterThread = nullptr; //nullptr if not buffered
+		mutex dFillBufferMutex;
+		vector<DTreeFillData*> dFillBuffers; //written, can be reused
 };
 
 /******************************************************************** GET POINTERS ********************************************************************/
 
 //GET POINTERS
-template <typename DType> inline DType* DTreeInterface::Get_Pointer_Fundamental(string locBranchName) const
+template <typename DType> inline DType* DTreeInterface::Get_Pointer_Fundamental(TBranch* locBranch) const
 {
-	TBranch* locBranch = dTree->GetBranch(locBranchName.c_str());
-	return ((locBranch != NULL) ? (DType*)locBranch->GetAddress() : NULL);
+	return (DType*)locBranch->GetAddress();
 }
 
-template <typename DType> inline DType* DTreeInterface::Get_Pointer_TObject(string locBranchName) const
+template <typename DType> inline DType* DTreeInterface::Get_Pointer_TObject(TBranch* locBranch) const
 {
-	TBranch* locBranch = dTree->GetBranch(locBranchName.c_str());
-	return ((locBranch != NULL) ? *(DType**)locBranch->GetAddress() : NULL);
+	return *(DType**)locBranch->GetAddress();
 }
 
-inline TClonesArray* DTreeInterface::Get_Pointer_TClonesArray(string locBranchName)
+inline TClonesArray* DTreeInterface::Get_Pointer_TClonesArray(TBranch* locBranch) const
 {
-	TBranch* locBranch = dTree->GetBranch(locBranchName.c_str());
-	return ((locBranch != NULL) ? *(TClonesArray**)locBranch->GetAddress() : NULL);
+	return *(TClonesArray**)locBranch->GetAddress();
 }
 
 /******************************************************************* CREATE BRANCHES ******************************************************************/
@@ -259,24 +278,24 @@ inline void DTreeInterface::Set_TreeIndexBranchNames(string locTreeIndex_MajorBr
 }
 
 //INCREASE ARRAY SIZE
-template <typename DType> inline void DTreeInterface::Change_ArraySize(string locBranchName, int locNewArraySize)
+template <typename DType> inline void DTreeInterface::Change_ArraySize(TBranch* locBranch, int locNewArraySize)
 {
 	//create a new, larger array if the current one is too small
 		//DOES NOT copy the old results!  In other words, only call BETWEEN entries, not DURING an entry
-	DType* locOldBranchAddress = Get_Pointer_Fundamental<DType>(locBranchName);
-	dTree->SetBranchAddress(locBranchName.c_str(), new DType[locNewArraySize]);
+	DType* locOldBranchAddress = Get_Pointer_Fundamental<DType>(locBranch);
+	dTree->SetBranchAddress(locBranch->GetName(), new DType[locNewArraySize]);
 	delete[] locOldBranchAddress;
 }
 
-template <typename DType> inline void DTreeInterface::Fill_TObject(string locBranchName, DType& locObject, bool locIsArrayFlag, size_t locArrayIndex)
+template <typename DType> inline void DTreeInterface::Fill_TObject(TBranch* locBranch, DType& locObject, bool locIsArrayFlag, size_t locArrayIndex)
 {
 	if(locIsArrayFlag)
 	{
-		TClonesArray* locClonesArray = Get_Pointer_TClonesArray(locBranchName);
+		TClonesArray* locClonesArray = Get_Pointer_TClonesArray(locBranch);
 		*(DType*)locClonesArray->ConstructedAt(locArrayIndex) = locObject;
 	}
 	else
-		*Get_Pointer_TObject<DType>(locBranchName) = locObject;
+		*Get_Pointer_TObject<DType>(locBranch) = locObject;
 }
 
 #endif //DTreeInterface_h
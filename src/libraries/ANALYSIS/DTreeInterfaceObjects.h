@@ -7,6 +7,9 @@
 #include <string>
 #include <deque>
 #include <vector>
+#include <limits>
+#include <algorithm>
+#include <iostream>
 
 #include "TVector2.h"
 #include "TVector3.h"
@@ -15,6 +18,7 @@
 using namespace std;
 
 class DTreeInterface;
+class TBranch;
 
 /***************************************************************** DTreeTypeChecker *******************************************************************/
 
@@ -114,6 +118,10 @@ class DFillBaseClass
 		virtual ~DFillBaseClass(){};
 		virtual void* Get(size_t locArrayIndex) = 0;
 		virtual void Check_Capacity(void) = 0;
+
+		//for buffered output: empty object of the same type, and copy of the first entries of another one of the same type
+		virtual DFillBaseClass* Clone_Empty(void) const = 0;
+		virtual void Copy_Data(const DFillBaseClass* locSource, size_t locNumEntries) = 0;
 };
 
 template <typename DType>
@@ -127,6 +135,9 @@ class DFillClass : public DFillBaseClass
 		void* Get(size_t locArrayIndex){return static_cast<void*>(&(dFillData[locArrayIndex]));}
 		void Check_Capacity(void);
 
+		DFillBaseClass* Clone_Empty(void) const{return new DFillClass<DType>();}
+		void Copy_Data(const DFillBaseClass* locSource, size_t locNumEntries);
+
 	private:
 		size_t dMaxFillVectorSize = 1000; //if exceeds this, will drop down on next event
 };
@@ -138,6 +149,54 @@ template <typename DType> inline void DFillClass<DType>::Check_Capacity(void)
 	dFillData.resize(dMaxFillVectorSize);
 }
 
+/**************************************************************** DTreeBranchHandle *****************************************************************/
+
+//Token for one branch of a DTreeFillData, from DTreeFillData::Get_BranchHandle<DType>()
+	//Filling through a handle skips the branch-name lookup and the type check: get them once (e.g. at init), fill with them every event
+	//Only valid for the DTreeFillData that created it
+template <typename DType>
+class DTreeBranchHandle
+{
+	friend class DTreeFillData;
+
+	public:
+		DTreeBranchHandle(void) : dSlotIndex(std::numeric_limits<size_t>::max()){}
+		bool Is_Valid(void) const{return (dSlotIndex != std::numeric_limits<size_t>::max());}
+
+	private:
+		explicit DTreeBranchHandle(size_t locSlotIndex) : dSlotIndex(locSlotIndex){}
+		size_t dSlotIndex;
+};
+
+/****************************************************************** DTreeFillStep *******************************************************************/
+
+//Supported branch types, resolved once from the type_index when the fill plan is compiled
+enum DTreeFillType_t
+{
+	d_TreeFill_Char = 0, d_TreeFill_UChar, d_TreeFill_Short, d_TreeFill_UShort, d_TreeFill_Int, d_TreeFill_UInt,
+	d_TreeFill_Float, d_TreeFill_Double, d_TreeFill_Long64, d_TreeFill_ULong64, d_TreeFill_Bool,
+	d_TreeFill_TVector2, d_TreeFill_TVector3, d_TreeFill_TLorentzVector, d_TreeFill_Unknown
+};
+
+//One entry of a fill plan: where the data of a DTreeFillData slot goes in the tree
+	//Built by DTreeInterface under the file lock, so that filling needs no branch or array-size lookups by name
+struct DTreeFillStep_t
+{
+	DTreeFillType_t dFillType;
+	TBranch* dBranch; //nullptr if the branch doesn't exist (yet)
+	size_t* dFundamentalArraySize; //current size of the fundamental array branch (shared by all threads), else nullptr
+};
+
+/******************************************************************* DTreeFillData ********************************************************************/
+
+template <typename DType> inline void DFillClass<DType>::Copy_Data(const DFillBaseClass* locSource, size_t locNumEntries)
+{
+	auto& locSourceData = static_cast<const DFillClass<DType>*>(locSource)->dFillData;
+	if(dFillData.size() < locNumEntries)
+		dFillData.resize(locNumEntries);
+	std::copy(locSourceData.begin(), locSourceData.begin() + locNumEntries, dFillData.begin());
+}
+
 //Need one per thread:
 	//If this is created within the scope of a single object that is shared amongst all threads (e.g. plugin processor): static thread-local variable
 		//Data stored as void*: Requires new on creation and delete on destruction: Try to re-use object
@@ -148,71 +207,111 @@ class DTreeFillData
 
 	public:
 		~DTreeFillData(void);
-		template <typename DType> void Fill_Single(string locBranchName, const DType& locData);
-		template <typename DType> void Fill_Array(string locBranchName, const DType& locData, size_t locArrayIndex);
+
+		//Registers the branch here (if not already) and returns the handle to fill it with: invalid if registered with a different type
+		template <typename DType> DTreeBranchHandle<DType> Get_BranchHandle(const string& locBranchName);
+
+		template <typename DType> void Fill_Single(const DTreeBranchHandle<DType>& locBranchHandle, const DType& locData);
+		template <typename DType> void Fill_Array(const DTreeBranchHandle<DType>& locBranchHandle, const DType& locData, size_t locArrayIndex);
+
+		//By branch name: same as above, but looks up the handle every call
+		template <typename DType> void Fill_Single(const string& locBranchName, const DType& locData);
+		template <typename DType> void Fill_Array(const string& locBranchName, const DType& locData, size_t locArrayIndex);
 
 	private:
-		map<string, pair<type_index, DFillBaseClass*> > dFillData;
-		map<string, int> dArrayLargestIndexFilledMap; //can be less than the size //reset by DTreeInterface after fill
+
+		//For buffered output (DTreeWriterThread): make this a copy of the data filled in locSource, then reset locSource for the next entry
+		void Take_Data(DTreeFillData& locSource);
+
+		struct DFillSlot_t
+		{
+			DFillSlot_t(const string& locBranchName, type_index locTypeIndex, DFillBaseClass* locFillClass) :
+				dBranchName(locBranchName), dTypeIndex(locTypeIndex), dFillClass(locFillClass){}
+
+			string dBranchName;
+			type_index dTypeIndex;
+			DFillBaseClass* dFillClass;
+			bool dHasDataFlag = false; //not filled until first set
+			bool dIsArrayFlag = false;
+			int dLargestIndexFilled = -1; //can be less than the size //reset by DTreeInterface after fill
+		};
+
+		vector<DFillSlot_t> dFillSlots; //handle token is the index
+		map<string, size_t> dSlotIndexMap;
+
+		//Fill plan: one step per slot, compiled by DTreeInterface::Fill() (again if slots are added)
+		const DTreeInterface* dFillPlanInterface = nullptr;
+		vector<DTreeFillStep_t> dFillPlan;
 };
 
-/*********************************************************** DTreeFillData: FILL BRANCHES *************************************************************/
+/********************************************************* DTreeFillData: REGISTER BRANCHES ***********************************************************/
 
-template <typename DType> inline void DTreeFillData::Fill_Single(string locBranchName, const DType& locData)
+template <typename DType> inline DTreeBranchHandle<DType> DTreeFillData::Get_BranchHandle(const string& locBranchName)
 {
 	DTreeTypeChecker::Is_Supported<DType>();
 	type_index locTypeIndex(typeid(DType));
 
-	auto locIterator = dFillData.find(locBranchName);
-	if(locIterator == dFillData.end())
+	auto locIterator = dSlotIndexMap.find(locBranchName);
+	if(locIterator == dSlotIndexMap.end())
 	{
 		//create new object, register in map
-		auto locFillClass = new DFillClass<DType>();
-		locFillClass->dFillData.push_back(locData);
-		dFillData.emplace(locBranchName, std::make_pair(locTypeIndex, static_cast<DFillBaseClass*>(locFillClass)));
+		size_t locSlotIndex = dFillSlots.size();
+		dFillSlots.emplace_back(locBranchName, locTypeIndex, static_cast<DFillBaseClass*>(new DFillClass<DType>()));
+		dSlotIndexMap.emplace(locBranchName, locSlotIndex);
+		return DTreeBranchHandle<DType>(locSlotIndex);
 	}
-	else if(locTypeIndex != locIterator->second.first)
-		cout << "WARNING: CANNOT FILL: IS WRONG TYPE FOR BRANCH " << locBranchName << endl;
-	else
+	if(locTypeIndex != dFillSlots[locIterator->second].dTypeIndex)
 	{
-		auto locFillClass = static_cast<DFillClass<DType>*>(locIterator->second.second);
-		locFillClass->dFillData[0] = locData;
+		cout << "WARNING: CANNOT FILL: IS WRONG TYPE FOR BRANCH " << locBranchName << endl;
+		return DTreeBranchHandle<DType>();
 	}
+	return DTreeBranchHandle<DType>(locIterator->second);
 }
 
-template <typename DType> inline void DTreeFillData::Fill_Array(string locBranchName, const DType& locData, size_t locArrayIndex)
-{
-	DTreeTypeChecker::Is_Supported<DType>();
-	type_index locTypeIndex(typeid(DType));
+/*********************************************************** DTreeFillData: FILL BRANCHES *************************************************************/
 
-	auto locIterator = dFillData.find(locBranchName);
-	if(locIterator == dFillData.end())
-	{
-		//create new object, register in map
-		auto locFillClass = new DFillClass<DType>();
-		dFillData.emplace(locBranchName, std::make_pair(locTypeIndex, static_cast<DFillBaseClass*>(locFillClass)));
+template <typename DType> inline void DTreeFillData::Fill_Single(const DTreeBranchHandle<DType>& locBranchHandle, const DType& locData)
+{
+	if(!locBranchHandle.Is_Valid())
+		return;
 
-		//fill
-		locFillClass->dFillData.resize(locArrayIndex + 1);
-		locFillClass->dFillData[locArrayIndex] = locData;
-		dArrayLargestIndexFilledMap[locBranchName] = locArrayIndex;
-	}
-	else if(locTypeIndex != locIterator->second.first)
-		cout << "WARNING: CANNOT FILL: IS WRONG TYPE FOR BRANCH " << locBranchName << endl;
+	auto& locFillSlot = dFillSlots[locBranchHandle.dSlotIndex];
+	auto& locFillData = static_cast<DFillClass<DType>*>(locFillSlot.dFillClass)->dFillData;
+	if(locFillData.empty())
+		locFillData.push_back(locData);
 	else
-	{
-		auto locFillClass = static_cast<DFillClass<DType>*>(locIterator->second.second);
+		locFillData[0] = locData;
+	locFillSlot.dHasDataFlag = true;
+}
 
-		//resize if needed & fill
-		if(locArrayIndex >= locFillClass->dFillData.size())
-			locFillClass->dFillData.resize(locArrayIndex + 1);
-		locFillClass->dFillData[locArrayIndex] = locData;
+template <typename DType> inline void DTreeFillData::Fill_Array(const DTreeBranchHandle<DType>& locBranchHandle, const DType& locData, size_t locArrayIndex)
+{
+	if(!locBranchHandle.Is_Valid())
+		return;
 
-		//register largest index filled
-		auto& locLargestIndexFilled = dArrayLargestIndexFilledMap[locBranchName];
-		if(int(locArrayIndex) > locLargestIndexFilled)
-			locLargestIndexFilled = locArrayIndex;
-	}
+	auto& locFillSlot = dFillSlots[locBranchHandle.dSlotIndex];
+	auto& locFillData = static_cast<DFillClass<DType>*>(locFillSlot.dFillClass)->dFillData;
+
+	//resize if needed & fill
+	if(locArrayIndex >= locFillData.size())
+		locFillData.resize(locArrayIndex + 1);
+	locFillData[locArrayIndex] = locData;
+
+	//register largest index filled
+	if(int(locArrayIndex) > locFillSlot.dLargestIndexFilled)
+		locFillSlot.dLargestIndexFilled = locArrayIndex;
+	locFillSlot.dIsArrayFlag = true;
+	locFillSlot.dHasDataFlag = true;
+}
+
+template <typename DType> inline void DTreeFillData::Fill_Single(const string& locBranchName, const DType& locData)
+{
+	Fill_Single<DType>(Get_BranchHandle<DType>(locBranchName), locData);
+}
+
+template <typename DType> inline void DTreeFillData::Fill_Array(const string& locBranchName, const DType& locData, size_t locArrayIndex)
+{
+	Fill_Array<DType>(Get_BranchHandle<DType>(locBranchName), locData, locArrayIndex);
 }
 /*
 //Enable this version if type inherits from TObject //void: is return type
@@ -223,14 +322,61 @@ template <typename DType> typename enable_if<std::is_base_of<TObject, DType>::va
 template <typename DType> typename enable_if<!std::is_base_of<TObject, DType>::value, void>::type
 		Create_Branch(string locBranchName, size_t locArraySize, string locArraySizeName);
 */
+/*********************************************************** DTreeFillData: BUFFERED OUTPUT ***********************************************************/
+
+inline void DTreeFillData::Take_Data(DTreeFillData& locSource)
+{
+	//same branches in the same order as the source: branches can only be added to it
+	bool locSameLayoutFlag = (dFillSlots.size() <= locSource.dFillSlots.size());
+	for(size_t loc_i = 0; locSameLayoutFlag && (loc_i < dFillSlots.size()); ++loc_i)
+		locSameLayoutFlag = (dFillSlots[loc_i].dBranchName == locSource.dFillSlots[loc_i].dBranchName);
+	if(!locSameLayoutFlag)
+	{
+		for(auto& locFillSlot : dFillSlots)
+			delete locFillSlot.dFillClass;
+		dFillSlots.clear();
+		dSlotIndexMap.clear();
+		dFillPlanInterface = nullptr;
+	}
+
+	for(size_t loc_i = dFillSlots.size(); loc_i < locSource.dFillSlots.size(); ++loc_i)
+	{
+		auto& locSourceSlot = locSource.dFillSlots[loc_i];
+		dFillSlots.emplace_back(locSourceSlot.dBranchName, locSourceSlot.dTypeIndex, locSourceSlot.dFillClass->Clone_Empty());
+		dSlotIndexMap.emplace(locSourceSlot.dBranchName, loc_i);
+	}
+
+	for(size_t loc_i = 0; loc_i < dFillSlots.size(); ++loc_i)
+	{
+		auto& locFillSlot = dFillSlots[loc_i];
+		auto& locSourceSlot = locSource.dFillSlots[loc_i];
+		locFillSlot.dHasDataFlag = locSourceSlot.dHasDataFlag;
+		locFillSlot.dIsArrayFlag = locSourceSlot.dIsArrayFlag;
+		locFillSlot.dLargestIndexFilled = locSourceSlot.dLargestIndexFilled;
+		if(!locSourceSlot.dHasDataFlag)
+			continue;
+
+		size_t locNumEntries = locSourceSlot.dIsArrayFlag ? (locSourceSlot.dLargestIndexFilled + 1) : 1;
+		if(locNumEntries > 0)
+			locFillSlot.dFillClass->Copy_Data(locSourceSlot.dFillClass, locNumEntries);
+
+		//reset source for next event!
+		locSourceSlot.dLargestIndexFilled = -1;
+	}
+
+	//Reset fill vectors if too large!!
+	for(auto& locSourceSlot : locSource.dFillSlots)
+		locSourceSlot.dFillClass->Check_Capacity();
+}
+
 /************************************************************* DTreeFillData: DESTRUCTOR **************************************************************/
 
 inline DTreeFillData::~DTreeFillData(void)
 {
 	//delete all memory (void*'s)
 	//loop over branches
-	for(auto& locBranchPair : dFillData)
-		delete locBranchPair.second.second;
+	for(auto& locFillSlot : dFillSlots)
+		delete locFillSlot.dFillClass;
 }
 
 #endif //DTreeInterfaceObjects
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <chrono>
+
+#include "DTreeWriterThread.h"
+#include "DTreeInterface.h"
+
+/************************************************* STATIC-VARIABLE-ACCESSING PRIVATE MEMBER FUNCTIONS *************************************************/
+
+mutex& DTreeWriterThread::Get_InstanceMutex(void)
+{
+	static mutex locInstanceMutex;
+	return locInstanceMutex;
+}
+
+map<string, DTreeWriterThread*>& DTreeWriterThread::Get_InstanceMap(void)
+{
+	//must be accessed within the instance mutex
+	static map<string, DTreeWriterThread*> locInstanceMap;
+	return locInstanceMap;
+}
+
+map<string, size_t>& DTreeWriterThread::Get_NumUsersMap(void)
+{
+	//must be accessed within the instance mutex
+	static map<string, size_t> locNumUsersMap;
+	return locNumUsersMap;
+}
+
+/********************************************************************* START/STOP *********************************************************************/
+
+DTreeWriterThread* DTreeWriterThread::Acquire(string locFileName, size_t locMaxQueueSize)
+{
+	lock_guard<mutex> locLock(Get_InstanceMutex());
+	auto& locInstance = Get_InstanceMap()[locFileName];
+	if(locInstance == nullptr)
+		locInstance = new DTreeWriterThread(locFileName, locMaxQueueSize);
+	++Get_NumUsersMap()[locFileName];
+	return locInstance;
+}
+
+void DTreeWriterThread::Release(string locFileName)
+{
+	lock_guard<mutex> locLock(Get_InstanceMutex());
+	auto locUsersIterator = Get_NumUsersMap().find(locFileName);
+	if(locUsersIterator == Get_NumUsersMap().end())
+		return;
+	if(--locUsersIterator->second != 0)
+		return;
+	Get_NumUsersMap().erase(locUsersIterator);
+
+	auto locInstanceIterator = Get_InstanceMap().find(locFileName);
+	delete locInstanceIterator->second;
+	Get_InstanceMap().erase(locInstanceIterator);
+}
+
+DTreeWriterThread::DTreeWriterThread(string locFileName, size_t locMaxQueueSize) : dFileName(locFileName), dMaxQueueSize(locMaxQueueSize > 0 ? locMaxQueueSize : 1)
+{
+	dThread = thread(&DTreeWriterThread::Run, this);
+}
+
+DTreeWriterThread::~DTreeWriterThread(void)
+{
+	{
+		lock_guard<mutex> locLock(dQueueMutex);
+		dQuitFlag = true;
+	}
+	dQueueNotEmpty.notify_all();
+	dThread.join();
+
+	cout << "DTreeWriterThread (" << dFileName << "): " << dNumEntriesWritten << " tree entries written, " << dFillTime << " s in TTree::Fill() (incl. compression)." << endl;
+	cout << "DTreeWriterThread (" << dFileName << "): max queue depth " << dMaxQueueDepth << " (of " << dMaxQueueSize << "), processing threads waited on a full queue ";
+	cout << dNumFullQueueWaits << " times, " << dFullQueueWaitTime << " s total." << endl;
+}
+
+/******************************************************************** QUEUE ENTRIES *******************************************************************/
+
+void DTreeWriterThread::Enqueue(DTreeInterface* locTreeInterface, DTreeFillData* locFillBuffer)
+{
+	unique_lock<mutex> locLock(dQueueMutex);
+	if(dQueue.size() >= dMaxQueueSize)
+	{
+		auto locWaitStartTime = chrono::steady_clock::now();
+		dQueueNotFull.wait(locLock, [this]{return (dQueue.size() < dMaxQueueSize);});
+		++dNumFullQueueWaits;
+		dFullQueueWaitTime += chrono::duration<double>(chrono::steady_clock::now() - locWaitStartTime).count();
+	}
+
+	dQueue.emplace_back(locTreeInterface, locFillBuffer);
+	if(dQueue.size() > dMaxQueueDepth)
+		dMaxQueueDepth = dQueue.size();
+	locLock.unlock();
+	dQueueNotEmpty.notify_one();
+}
+
+bool DTreeWriterThread::Is_Queued(const DTreeInterface* locTreeInterface) const
+{
+	if(dWritingInterface == locTreeInterface)
+		return true;
+	for(auto& locQueuePair : dQueue)
+	{
+		if(locQueuePair.first == locTreeInterface)
+			return true;
+	}
+	return false;
+}
+
+void DTreeWriterThread::Flush(const DTreeInterface* locTreeInterface)
+{
+	unique_lock<mutex> locLock(dQueueMutex);
+	dEntryWritten.wait(locLock, [this, locTreeInterface]{return !Is_Queued(locTreeInterface);});
+}
+
+/******************************************************************** WRITE ENTRIES *******************************************************************/
+
+void DTreeWriterThread::Run(void)
+{
+	unique_lock<mutex> locLock(dQueueMutex);
+	while(true)
+	{
+		dQueueNotEmpty.wait(locLock, [this]{return (dQuitFlag || !dQueue.empty());});
+		if(dQueue.empty())
+			return; //quit, and nothing left to write
+
+		auto locQueuePair = dQueue.front();
+		dQueue.pop_front();
+		dWritingInterface = locQueuePair.first;
+		locLock.unlock();
+		dQueueNotFull.notify_one();
+
+		//fill the tree: takes the file lock
+		auto locFillStartTime = chrono::steady_clock::now();
+		locQueuePair.first->Write_Buffer(locQueuePair.second);
+		double locFillTime = chrono::duration<double>(chrono::steady_clock::now() - locFillStartTime).count();
+
+		locLock.lock();
+		dWritingInterface = nullptr;
+		++dNumEntriesWritten;
+		dFillTime += locFillTime;
+		dEntryWritten.notify_all();
+	}
+}
@@ -0,0 +1,71 @@
+#ifndef DTreeWriterThread_h
+#define DTreeWriterThread_h
+
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+class DTreeInterface;
+class DTreeFillData;
+
+class DTreeWriterThread
+{
+	//Buffered tree output (ANALYSIS:TREE_WRITER_THREAD=1):
+		//DTreeInterface::Fill() copies the fill data into a buffer and queues it here, instead of filling the tree itself
+		//This thread fills the trees from the queue, so TTree::Fill() (and the basket compression in it) runs off the processing threads
+		//Entries are written in the order they are queued: same as the order of the lock in the unbuffered mode
+		//If the queue is full, DTreeInterface::Fill() waits
+
+	//One thread per output file, shared by the buffered DTreeInterface's of that file: started by the first one, stopped by the last one (and stats printed)
+		//Trees in different files are filled in parallel; trees in the same file need the file lock to fill anyway
+
+	public:
+
+		static DTreeWriterThread* Acquire(string locFileName, size_t locMaxQueueSize);
+		static void Release(string locFileName);
+
+		void Enqueue(DTreeInterface* locTreeInterface, DTreeFillData* locFillBuffer);
+		void Flush(const DTreeInterface* locTreeInterface); //returns once all queued entries for this interface are in the tree
+
+	private:
+
+		DTreeWriterThread(string locFileName, size_t locMaxQueueSize);
+		~DTreeWriterThread(void); //writes what is left, stops the thread
+		DTreeWriterThread(void) = delete;
+
+		void Run(void);
+		bool Is_Queued(const DTreeInterface* locTreeInterface) const; //call with the mutex locked
+
+		//See the note in DTreeInterface.h: shared variables are function-scope statics in the source file
+		static mutex& Get_InstanceMutex(void);
+		static map<string, DTreeWriterThread*>& Get_InstanceMap(void); //string is file name
+		static map<string, size_t>& Get_NumUsersMap(void); //string is file name
+
+		string dFileName;
+		size_t dMaxQueueSize;
+		bool dQuitFlag = false;
+
+		mutex dQueueMutex;
+		condition_variable dQueueNotEmpty;
+		condition_variable dQueueNotFull;
+		condition_variable dEntryWritten;
+		deque<pair<DTreeInterface*, DTreeFillData*> > dQueue;
+		const DTreeInterface* dWritingInterface = nullptr;
+
+		//Stats
+		size_t dNumEntriesWritten = 0;
+		size_t dMaxQueueDepth = 0;
+		size_t dNumFullQueueWaits = 0;
+		double dFillTime = 0.0; //seconds in TTree::Fill() (incl. compression)
+		double dFullQueueWaitTime = 0.0; //seconds the processing threads waited on a full queue
+
+		thread dThread;
+};
+
+#endif //DTreeWriterThread_h
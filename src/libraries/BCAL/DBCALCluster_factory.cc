@@ -165,7 +165,7 @@ DBCALCluster_factory::evnt( JEventLoop *loop, uint64_t eventnumber ){
 }
 
 vector<DBCALCluster*>
-DBCALCluster_factory::clusterize( vector< const DBCALPoint* > points , vector< const DBCALPoint* > usedPoints ,  vector< const DBCALUnifiedHit* > hits, vector< const DTrackWireBased* > tracks ) const {
+DBCALCluster_factory::clusterize( vector< const DBCALPoint* > points , vector< const DBCALPoint* > usedPoints , const vector< const DBCALUnifiedHit* > &hits, const vector< const DTrackWireBased* > &tracks ) const {
 
   // first sort the points by energy
   sort( points.begin(), points.end(), PointSort );
@@ -207,13 +207,13 @@ DBCALCluster_factory::clusterize( vector< const DBCALPoint* > points , vector< c
       int q = 0;
 
       // Check if a point is matched to a track      
-      for( vector< const DTrackWireBased* >::iterator trk = tracks.begin();
+      for( vector< const DTrackWireBased* >::const_iterator trk = tracks.begin();
 	   trk != tracks.end();
 	   ++trk ){
 	DVector3 track_pos(0.0, 0.0, 0.0);
 	double point_r = (**pt).r();
 	double point_z = (**pt).z();
-	vector<DTrackFitter::Extrapolation_t>extrapolations=(*trk)->extrapolations.at(SYS_BCAL);
+	const vector<DTrackFitter::Extrapolation_t> &extrapolations=(*trk)->extrapolations.at(SYS_BCAL);
 	if (fitter->ExtrapolateToRadius(point_r,extrapolations,track_pos)){
 	  double dPhi=track_pos.Phi()-(**pt).phi();
 	  if (dPhi<-M_PI) dPhi+=2.*M_PI;
@@ -285,7 +285,7 @@ DBCALCluster_factory::clusterize( vector< const DBCALPoint* > points , vector< c
   }
 
   // add the single-ended hits that overlap with a cluster that was made from points
-  for( vector< const DBCALUnifiedHit* >::iterator ht = hits.begin();
+  for( vector< const DBCALUnifiedHit* >::const_iterator ht = hits.begin();
        ht != hits.end();
        ++ht){
     bool usedHit = false;	 
@@ -317,7 +317,7 @@ DBCALCluster_factory::clusterize( vector< const DBCALPoint* > points , vector< c
 }
 
 void
-DBCALCluster_factory::recycle_points( vector<const DBCALPoint*> usedPoints, vector<DBCALCluster*>& clusters) const{
+DBCALCluster_factory::recycle_points( const vector<const DBCALPoint*> &usedPoints, vector<DBCALCluster*>& clusters) const{
 
   if ( clusters.size() <= 1 ) return;
 
@@ -14,6 +14,7 @@ using namespace std;
 #include <BCAL/DBCALDigiHit.h>
 #include "DBCALGeometry.h"
 #include "DBCALHit_factory.h"
+#include "DANA/DApplication.h"
 #include <DAQ/Df250PulseIntegral.h>
 #include <DAQ/Df250Config.h>
 #include <TTAB/DTTabUtilities.h>
@@ -36,6 +37,19 @@ jerror_t DBCALHit_factory::init(void)
 
   // cout << " CORRECT_SIPM_SATURATION=" << CORRECT_SIPM_SATURATION << endl;
 
+   // tables loaded once for all threads by the shared calibration cache
+   DApplication* dapp = dynamic_cast<DApplication*>(japp);
+   calib_cache = dapp->GetCalibCache();
+   calib_cache->Declare< map<string,double> >("/BCAL/digi_scales");
+   calib_cache->Declare< map<string,double> >("/BCAL/base_time_offset");
+   calib_cache->Declare< vector<double> >("/BCAL/ADC_gains");
+   calib_cache->Declare< vector<double> >("/BCAL/ADC_pedestals");
+   calib_cache->Declare< vector<double> >("/BCAL/ADC_timing_offsets");
+   calib_cache->Declare< vector<double> >("/BCAL/channel_global_offset");
+   calib_cache->Declare< vector<double> >("/BCAL/tdiff_u_d");
+   calib_cache->Declare< vector< map<string,double> > >("/BCAL/ADC_saturation");
+   calib_cache->Declare< vector< map<string,double> > >("/BCAL/SiPM_saturation");
+
    return NOERROR;
 }
 
@@ -66,7 +80,7 @@ jerror_t DBCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
    
    // load scale factors
    map<string,double> scale_factors;
-   if (eventLoop->GetCalib("/BCAL/digi_scales", scale_factors))
+   if (calib_cache->GetCalib(eventLoop, "/BCAL/digi_scales", scale_factors))
        jout << "Error loading /BCAL/digi_scales !" << endl;
    if (scale_factors.find("BCAL_ADC_ASCALE") != scale_factors.end())
        a_scale = scale_factors["BCAL_ADC_ASCALE"];
@@ -83,7 +97,7 @@ jerror_t DBCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 
   // load base time offset
    map<string,double> base_time_offset;
-   if (eventLoop->GetCalib("/BCAL/base_time_offset",base_time_offset))
+   if (calib_cache->GetCalib(eventLoop, "/BCAL/base_time_offset",base_time_offset))
        jout << "Error loading /BCAL/base_time_offset !" << endl;
    if (base_time_offset.find("BCAL_BASE_TIME_OFFSET") != base_time_offset.end()) {
      t_base = base_time_offset["BCAL_BASE_TIME_OFFSET"];
@@ -95,15 +109,15 @@ jerror_t DBCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
        jerr << "Unable to get BCAL_BASE_TIME_OFFSET from /BCAL/base_time_offset !" << endl;  
 
    // load constant tables
-   if (eventLoop->GetCalib("/BCAL/ADC_gains", raw_gains))
+   if (calib_cache->GetCalib(eventLoop, "/BCAL/ADC_gains", raw_gains))
        jout << "Error loading /BCAL/ADC_gains !" << endl;
-   if (eventLoop->GetCalib("/BCAL/ADC_pedestals", raw_pedestals))
+   if (calib_cache->GetCalib(eventLoop, "/BCAL/ADC_pedestals", raw_pedestals))
        jout << "Error loading /BCAL/ADC_pedestals !" << endl;
-   if (eventLoop->GetCalib("/BCAL/ADC_timing_offsets", raw_ADC_timing_offsets))
+   if (calib_cache->GetCalib(eventLoop, "/BCAL/ADC_timing_offsets", raw_ADC_timing_offsets))
        jout << "Error loading /BCAL/ADC_timing_offsets !" << endl;
-   if(eventLoop->GetCalib("/BCAL/channel_global_offset", raw_channel_global_offset))
+   if(calib_cache->GetCalib(eventLoop, "/BCAL/channel_global_offset", raw_channel_global_offset))
        jout << "Error loading /BCAL/channel_global_offset !" << endl;
-   if(eventLoop->GetCalib("/BCAL/tdiff_u_d", raw_tdiff_u_d))
+   if(calib_cache->GetCalib(eventLoop, "/BCAL/tdiff_u_d", raw_tdiff_u_d))
        jout << "Error loading /BCAL/tdiff_u_d !" << endl;
 
    if (PRINTCALIBRATION) jout << "DBCALHit_factory >> raw_gains" << endl;
@@ -118,7 +132,7 @@ jerror_t DBCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
    FillCalibTableShort(tdiff_u_d, raw_tdiff_u_d);
    
    std::vector<std::map<string,double> > saturation_ADC_pars;
-   if(eventLoop->GetCalib("/BCAL/ADC_saturation", saturation_ADC_pars))
+   if(calib_cache->GetCalib(eventLoop, "/BCAL/ADC_saturation", saturation_ADC_pars))
       jout << "Error loading /BCAL/ADC_saturation !" << endl;
    for (unsigned int i=0; i < saturation_ADC_pars.size(); i++) {
 	   int end = (saturation_ADC_pars[i])["end"];
@@ -130,7 +144,7 @@ jerror_t DBCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 
    // load parameters for SiPM saturation
    std::vector<std::map<string,double> > saturation_SiPM_pars;
-   if(eventLoop->GetCalib("/BCAL/SiPM_saturation", saturation_SiPM_pars))
+   if(calib_cache->GetCalib(eventLoop, "/BCAL/SiPM_saturation", saturation_SiPM_pars))
       jout << "Error loading /SiPM/SiPM_saturation !" << endl;
    for (unsigned int i=0; i < saturation_SiPM_pars.size(); i++) {
 	   int end = (saturation_SiPM_pars[i])["END"];
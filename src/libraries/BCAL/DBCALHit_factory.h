@@ -14,6 +14,7 @@
 using namespace std;
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include "TTAB/DTranslationTable.h"
 #include "DBCALHit.h"
 
@@ -93,6 +94,7 @@ class DBCALHit_factory:public jana::JFactory<DBCALHit>{
         double integral_to_peak[BCAL_NUM_ENDS][BCAL_NUM_LAYERS];     // ration of pulse integral to peak value (integral counts)
 	double sipm_npixels[BCAL_NUM_ENDS][BCAL_NUM_LAYERS];         // number of pixels per sensor(s) 
         double pixel_per_count[BCAL_NUM_ENDS][BCAL_NUM_LAYERS];   // conversion between counts and pixels
+        DCalibCache *calib_cache;
 };
 
 #endif // _DBCALHit_factory_
@@ -13,6 +13,7 @@ using namespace std;
 #include <JANA/JEventLoop.h>
 #include <BCAL/DBCALTDCDigiHit.h>
 #include <BCAL/DBCALTDCHit_factory.h>
+#include "DANA/DApplication.h"
 #include <DAQ/DF1TDCHit.h>
 
 using namespace jana;
@@ -29,6 +30,15 @@ jerror_t DBCALTDCHit_factory::init(void)
     t_rollover = 65250;
     //t_offset   = 0;
 
+    // tables loaded once for all threads by the shared calibration cache
+    DApplication* dapp = dynamic_cast<DApplication*>(japp);
+    calib_cache = dapp->GetCalibCache();
+    calib_cache->Declare< map<string,double> >("/BCAL/digi_scales");
+    calib_cache->Declare< map<string,double> >("/BCAL/base_time_offset");
+    calib_cache->Declare< vector<double> >("/BCAL/TDC_offsets");
+    calib_cache->Declare< vector<double> >("/BCAL/channel_global_offset");
+    calib_cache->Declare< vector<double> >("/BCAL/tdiff_u_d");
+
     return NOERROR;
 }
 
@@ -64,7 +74,7 @@ jerror_t DBCALTDCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumbe
 
     // load scale factors
     map<string,double> scale_factors;
-    if(eventLoop->GetCalib("/BCAL/digi_scales", scale_factors))
+    if(calib_cache->GetCalib(eventLoop, "/BCAL/digi_scales", scale_factors))
         jout << "Error loading /BCAL/digi_scales !" << endl; 
     if( scale_factors.find("BCAL_TDC_SCALE") != scale_factors.end() ) {
         t_scale = scale_factors["BCAL_TDC_SCALE"];
@@ -74,7 +84,7 @@ jerror_t DBCALTDCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumbe
 
     // load base time offset
     map<string,double> base_time_offset;
-    if (eventLoop->GetCalib("/BCAL/base_time_offset",base_time_offset))
+    if (calib_cache->GetCalib(eventLoop, "/BCAL/base_time_offset",base_time_offset))
         jout << "Error loading /BCAL/base_time_offset !" << endl;
     if (base_time_offset.find("BCAL_TDC_BASE_TIME_OFFSET") != base_time_offset.end())
         t_base = base_time_offset["BCAL_TDC_BASE_TIME_OFFSET"];
@@ -85,11 +95,11 @@ jerror_t DBCALTDCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumbe
     vector<double> raw_channel_global_offset;
     vector<double> raw_tdiff_u_d;
 
-    if(eventLoop->GetCalib("/BCAL/TDC_offsets", raw_time_offsets))
+    if(calib_cache->GetCalib(eventLoop, "/BCAL/TDC_offsets", raw_time_offsets))
         jout << "Error loading /BCAL/TDC_offsets !" << endl;
-    if(eventLoop->GetCalib("/BCAL/channel_global_offset", raw_channel_global_offset))
+    if(calib_cache->GetCalib(eventLoop, "/BCAL/channel_global_offset", raw_channel_global_offset))
         jout << "Error loading /BCAL/channel_global_offset !" << endl;
-    if(eventLoop->GetCalib("/BCAL/tdiff_u_d", raw_tdiff_u_d))
+    if(calib_cache->GetCalib(eventLoop, "/BCAL/tdiff_u_d", raw_tdiff_u_d))
         jout << "Error loading /BCAL/tdiff_u_d !" << endl;
 
     FillCalibTable(time_offsets, raw_time_offsets);
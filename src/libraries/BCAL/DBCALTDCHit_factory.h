@@ -9,6 +9,7 @@
 #define _DBCALTDCHit_factory_
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include "TTAB/DTTabUtilities.h"
 #include "DBCALTDCHit.h"
 
@@ -67,6 +68,7 @@ class DBCALTDCHit_factory:public jana::JFactory<DBCALTDCHit>{
 				     const vector<double> &raw_table);
         void FillCalibTableShort( bcal_digi_constants_t &table,
                      const vector<double> &raw_table);
+                     DCalibCache *calib_cache;
 };
 
 #endif // _DBCALTDCHit_factory_
@@ -57,6 +57,10 @@ DCCALShower_factory::DCCALShower_factory()
 	gPARMS->SetDefaultParameter( "CCAL:CCAL_RADIATION_LENGTH", CCAL_RADIATION_LENGTH );
 	gPARMS->SetDefaultParameter( "CCAL:CCAL_CRITICAL_ENERGY", CCAL_CRITICAL_ENERGY );
 	gPARMS->SetDefaultParameter( "CCAL:LOG_POS_CONST", LOG_POS_CONST );
+	
+	CHECK_NEIGHBOR_TABLE      =  0;
+	gPARMS->SetDefaultParameter( "CCAL:CHECK_NEIGHBOR_TABLE", CHECK_NEIGHBOR_TABLE, 
+			"compare the table driven neighbour search with the original scan" );
 
 	VERBOSE = 0;              ///< >0 once off info ; >2 event by event ; >3 everything
 	gPARMS->SetDefaultParameter("DFCALShower:VERBOSE", VERBOSE, "Verbosity level for DFCALShower objects and factories");
@@ -169,6 +173,47 @@ jerror_t DCCALShower_factory::brun(JEventLoop *locEventLoop, int32_t runnumber)
 	
 	
 	
+	//------------------------------------------------------//
+	//----------  Build the block neighbour table ----------//
+	
+	/*
+	For every cell (address 100*ix+iy, ix,iy = 1..12) store the addresses 
+	of the live cells around it. The order is the one the island code 
+	has always used to look for zero-energy neighbours, which keeps the 
+	chi2 sums bit for bit identical.
+	*/
+	
+	for( int ix = 1; ix <= MCOL; ix++ ) {
+	  for( int iy = 1; iy <= MROW; iy++ ) {
+	    
+	    int cand[8];
+	    int ncand = 0;
+	    if( ix > 1 ) {
+	      cand[ncand++] = iy + (ix-1)*100;
+	      if( iy > 1 )    cand[ncand++] = iy-1 + (ix-1)*100;
+	      if( iy < MROW ) cand[ncand++] = iy+1 + (ix-1)*100;
+	    }
+	    if( ix < MCOL ) {
+	      cand[ncand++] = iy + (ix+1)*100;
+	      if( iy > 1 )    cand[ncand++] = iy-1 + (ix+1)*100;
+	      if( iy < MROW ) cand[ncand++] = iy+1 + (ix+1)*100;
+	    }
+	    if( iy > 1 )    cand[ncand++] = iy-1 + ix*100;
+	    if( iy < MROW ) cand[ncand++] = iy+1 + ix*100;
+	    
+	    m_nNeighbors[ix-1][iy-1] = 0;
+	    for( int in = 0; in < ncand; in++ ) {
+	      int jx = cand[in]/100;
+	      int jy = cand[in] - jx*100;
+	      if( stat_ch[jy-1][jx-1] != 0 ) continue;
+	      m_neighbors[ix-1][iy-1][ m_nNeighbors[ix-1][iy-1]++ ] = cand[in];
+	    }
+	  }
+	}
+	
+	
+	
+	
 	//------------------------------------------------------//
 	//----------  Read shower timewalk parameters ----------//
 	
@@ -304,7 +349,7 @@ jerror_t DCCALShower_factory::evnt(JEventLoop *locEventLoop, uint64_t eventnumbe
 	  
 	  /*-----  prepare data in dimensionless format  -----*/
 	  
-	  vector< const DCCALHit* > rawHitPattern = hitPatterns[ipat];
+	  const vector< const DCCALHit* > &rawHitPattern = hitPatterns[ipat];
 	  vector< const DCCALHit* > locHitPattern;
 	  cleanHitPattern( rawHitPattern, locHitPattern );
 	  
@@ -435,7 +480,7 @@ jerror_t DCCALShower_factory::evnt(JEventLoop *locEventLoop, uint64_t eventnumbe
 //
 //==========================================================
 
-void DCCALShower_factory::getHitPatterns( vector< const DCCALHit* > hitarray, 
+void DCCALShower_factory::getHitPatterns( const vector< const DCCALHit* > &hitarray, 
 		vector< vector< const DCCALHit* > > &hitPatterns ) 
 {
 
@@ -573,7 +618,7 @@ void DCCALShower_factory::sortByTime( vector< const DCCALHit* > &hitarray, float
 //
 //==========================================================
 
-void DCCALShower_factory::cleanHitPattern( vector< const DCCALHit* > hitarray, 
+void DCCALShower_factory::cleanHitPattern( const vector< const DCCALHit* > &hitarray, 
 	vector< const DCCALHit* > &hitarrayClean ) 
 {
 
@@ -610,8 +655,8 @@ void DCCALShower_factory::cleanHitPattern( vector< const DCCALHit* > hitarray,
 //
 //==========================================================
 
-void DCCALShower_factory::processShowers( vector< gamma_t > gammas, DCCALGeometry ccalGeom, 
-		vector< const DCCALHit* > locHitPattern, int eventnumber, 
+void DCCALShower_factory::processShowers( const vector< gamma_t > &gammas, const DCCALGeometry &ccalGeom, 
+		const vector< const DCCALHit* > &locHitPattern, int eventnumber, 
 		vector< ccalcluster_t > &ccalClusters, vector< cluster_t > &clusterStorage )
 {
 
@@ -622,6 +667,21 @@ void DCCALShower_factory::processShowers( vector< gamma_t > gammas, DCCALGeometr
 	int n_clusters = 0;
 	int n_hits = static_cast<int>( locHitPattern.size() );
 	
+	// time of the (first) hit in each channel of this pattern
+	
+	double hitTimes[DCCALGeometry::kCCALMaxChannels];
+	bool   hasTime[DCCALGeometry::kCCALMaxChannels];
+	for( int ich = 0; ich < DCCALGeometry::kCCALMaxChannels; ich++ ) {
+	  hitTimes[ich] = 0.;
+	  hasTime[ich]  = false;
+	}
+	for( int ihit = 0; ihit < n_hits; ihit++ ) {
+	  int hitid = 12*( locHitPattern[ihit]->row) + locHitPattern[ihit]->column;
+	  if( hitid < 0 || hitid >= DCCALGeometry::kCCALMaxChannels || hasTime[hitid] ) continue;
+	  hitTimes[hitid] = locHitPattern[ihit]->t;
+	  hasTime[hitid]  = true;
+	}
+	
 	int init_clusters = static_cast<int>( gammas.size() );
 	for( int k = 0; k < init_clusters; k++ )  {
 	  
@@ -696,13 +756,8 @@ void DCCALShower_factory::processShowers( vector< gamma_t > gammas, DCCALGeometr
 	    }
 	    
 	    double hittime = 0.;
-	    for( int ihit = 0; ihit < n_hits; ihit++ ) {
-	      int trialid = 12*( locHitPattern[ihit]->row) + locHitPattern[ihit]->column;
-	      if( trialid == ccal_id ) {
-	        hittime = locHitPattern[ihit]->t;
-		break;
-	      }
-	    }
+	    if( ccal_id >= 0 && ccal_id < DCCALGeometry::kCCALMaxChannels )
+	      hittime = hitTimes[ccal_id];
 	    
 	    locClusterStorage.id[j] = ccal_id;
 	    locClusterStorage.E[j]  = ecell;
@@ -821,7 +876,7 @@ void DCCALShower_factory::processShowers( vector< gamma_t > gammas, DCCALGeometr
 //
 //==========================================================
 
-double DCCALShower_factory::getEnergyWeightedTime( cluster_t clusterStorage, int nHits )
+double DCCALShower_factory::getEnergyWeightedTime( const cluster_t &clusterStorage, int nHits )
 {
 
 	double weightedtime = 0.;
@@ -1019,11 +1074,11 @@ void DCCALShower_factory::main_island( vector<int> &ia, vector<int> &id, vector<
 	    ecl += id[ipncl+ii];
 	  if( ecl > MIN_ENERGY ) {
 	    
-	    vector< int > icl_a; // addresses of current cluster
-	    vector< int > icl_d; // energies of current cluster
+	    vector< int > &icl_a = m_icl_a; // addresses of current cluster
+	    vector< int > &icl_d = m_icl_d; // energies of current cluster
 	    
-	    icl_a.insert( icl_a.begin(), ia.begin()+ipncl, ia.begin()+ipncl+lencl[icl] );
-	    icl_d.insert( icl_d.begin(), id.begin()+ipncl, id.begin()+ipncl+lencl[icl] );
+	    icl_a.assign( ia.begin()+ipncl, ia.begin()+ipncl+lencl[icl] );
+	    icl_d.assign( id.begin()+ipncl, id.begin()+ipncl+lencl[icl] );
 	    
 	    
 	    if( SHOWER_DEBUG ) {
@@ -1312,21 +1367,17 @@ void DCCALShower_factory::gams_hyc( int nadc, vector<int> &ia, vector<int> &id,
 	
 	
 	
-	vector<int> iwrk[13];     // working array for resolved peaks
-	vector<int> idp[13];      // energy of each cell of the island belonging to each peak
-	vector<double> fwrk[13];  // working array for resolved peaks
+	vector<int> *iwrk = m_iwrk;     // working array for resolved peaks
+	vector<int> *idp = m_idp;       // energy of each cell of the island belonging to each peak
+	vector<double> *fwrk = m_fwrk;  // working array for resolved peaks
 	
-	// allocate memory for each vector:
+	// the working arrays are kept by the factory and only
+	// reallocated when an island larger than any before shows up
 	
 	for( int ii=0; ii<13; ii++ ) {
-	  iwrk[ii].reserve(nadc);
-	  fwrk[ii].reserve(nadc);
-	  idp[ii].reserve(nadc);
-	  for( int ih=0; ih<nadc; ih++ ) {
-	    iwrk[ii].push_back(0);
-	    fwrk[ii].push_back(0.);
-	    idp[ii].push_back(0);
-	  }
+	  iwrk[ii].assign(nadc, 0);
+	  fwrk[ii].assign(nadc, 0.);
+	  idp[ii].assign(nadc, 0);
 	}
 	
 	
@@ -1484,10 +1535,6 @@ void DCCALShower_factory::gams_hyc( int nadc, vector<int> &ia, vector<int> &id,
 	  
 	  ratio = 1.;
 	  for( int iter = 0; iter < niter; iter++ ) {
-	    for( int ii = 0; ii < nadc; ii++ ) {
-	      iwrk[0].push_back(0);
-	      fwrk[0].push_back(0.);
-	    }
 	    
 	    for( int ipk = 0; ipk < npk; ipk++ ) {
 	    
@@ -1589,8 +1636,10 @@ void DCCALShower_factory::gams_hyc( int nadc, vector<int> &ia, vector<int> &id,
 	  
 	  for( int ipk = 0; ipk < npk; ipk++ ) {
 	    
-	    vector<int> iwrk_a;
-	    vector<int> iwrk_d;
+	    vector<int> &iwrk_a = m_iwrk_a;
+	    vector<int> &iwrk_d = m_iwrk_d;
+	    iwrk_a.clear();
+	    iwrk_d.clear();
 	    
 	    leng = 0;
 	    for( int ii = 0; ii < nadc; ii++ ) {
@@ -1763,8 +1812,10 @@ void DCCALShower_factory::gams_hyc( int nadc, vector<int> &ia, vector<int> &id,
 	  for( int ipk = 0; ipk < npk; ipk++ ) {
 	    leng = 0;
 	    
-	    vector<int> iwrk_a;
-	    vector<int> iwrk_d;
+	    vector<int> &iwrk_a = m_iwrk_a;
+	    vector<int> &iwrk_d = m_iwrk_d;
+	    iwrk_a.clear();
+	    iwrk_d.clear();
 	    
 	    for( int ii = 0; ii < nadc; ii++ ){
 	      if( iwrk[0][ii] > 0 ) {
@@ -1905,7 +1956,7 @@ int DCCALShower_factory::peak_type( int ix, int iy )
 //
 //==========================================================
 
-void DCCALShower_factory::gamma_hyc( int nadc, vector<int> ia, vector<int> id, double &chisq, 
+void DCCALShower_factory::gamma_hyc( int nadc, const vector<int> &ia, const vector<int> &id, double &chisq, 
 		double &e1, double &x1, double &y1, 
 		double &e2, double &x2, double &y2 )
 {
@@ -1930,7 +1981,7 @@ void DCCALShower_factory::gamma_hyc( int nadc, vector<int> ia, vector<int> id, d
 	xm2cut  = 1.7;
 	
 	int nzero;
-	vector<int> iaz;
+	vector<int> &iaz = m_iaz;
 	
 	//-------------Event Analysis Code------------//
 	
@@ -2049,7 +2100,67 @@ void DCCALShower_factory::gamma_hyc( int nadc, vector<int> ia, vector<int> id, d
 //
 //==========================================================
 
-void DCCALShower_factory::fill_zeros( int nadc, vector<int> ia, int &nneib, vector<int> &iaz )
+void DCCALShower_factory::fill_zeros( int nadc, const vector<int> &ia, int &nneib, vector<int> &iaz )
+{
+	/*
+	Collect the live cells around the island that have no hit. The 
+	neighbours of each cell come from the table filled in brun, in the 
+	same order the cells used to be scanned (left, right, bottom, top), 
+	and the cell mask drops hit cells and repeated neighbours without 
+	searching the lists.
+	*/
+
+	iaz.clear();
+	memset( m_cellMask, 0, sizeof(m_cellMask) );
+	
+	for( int ii = 0; ii < nadc; ii++ ) {
+	  int ix = ia[ii]/100;
+	  int iy = ia[ii] - ix*100;
+	  m_cellMask[ix-1][iy-1] = 1;
+	}
+	
+	for( int ii = 0; ii < nadc; ii++ ) {
+	  int ix = ia[ii]/100;
+	  int iy = ia[ii] - ix*100;
+	  
+	  const int *neib = m_neighbors[ix-1][iy-1];
+	  for( int in = 0; in < m_nNeighbors[ix-1][iy-1]; in++ ) {
+	    int jx = neib[in]/100;
+	    int jy = neib[in] - jx*100;
+	    if( m_cellMask[jx-1][jy-1] ) continue;
+	    m_cellMask[jx-1][jy-1] = 1;
+	    iaz.push_back( neib[in] );
+	  }
+	}
+	nneib = static_cast<int>( iaz.size() );
+	
+	if( CHECK_NEIGHBOR_TABLE ) {
+	  int nneib_scan;
+	  vector<int> iaz_scan;
+	  fill_zeros_scan( nadc, ia, nneib_scan, iaz_scan );
+	  if( iaz_scan != iaz ) {
+	    cout << "DCCALShower_factory: neighbor table mismatch for island of " 
+	    	<< nadc << " cells (" << nneib << " vs " << nneib_scan << " zeros)" << endl;
+	  }
+	}
+
+	return;
+}
+
+
+
+
+
+//==========================================================
+//
+//   fill_zeros_scan
+//
+//   Original neighbour search, kept to validate the table
+//   driven version (CCAL:CHECK_NEIGHBOR_TABLE).
+//
+//==========================================================
+
+void DCCALShower_factory::fill_zeros_scan( int nadc, const vector<int> &ia, int &nneib, vector<int> &iaz )
 {
 
 	int ix, iy, nneibnew;
@@ -2138,8 +2249,8 @@ void DCCALShower_factory::fill_zeros( int nadc, vector<int> ia, int &nneib, vect
 //
 //==========================================================
 
-void DCCALShower_factory::mom1_pht( int nadc, vector<int> ia, vector<int> id, 
-		int nzero, vector<int> iaz, double &e1, double &x1, double &y1 )
+void DCCALShower_factory::mom1_pht( int nadc, const vector<int> &ia, const vector<int> &id, 
+		int nzero, const vector<int> &iaz, double &e1, double &x1, double &y1 )
 {
 	//-------------Local Declarations------------//
 
@@ -2215,8 +2326,8 @@ void DCCALShower_factory::mom1_pht( int nadc, vector<int> ia, vector<int> id,
 //
 //==========================================================
 
-void DCCALShower_factory::chisq1_hyc( int nadc, vector<int> ia, vector<int> id, 
-	int nneib, vector<int> iaz, double e1, double x1, double y1, double &chisq )
+void DCCALShower_factory::chisq1_hyc( int nadc, const vector<int> &ia, const vector<int> &id, 
+	int nneib, const vector<int> &iaz, double e1, double x1, double y1, double &chisq )
 {
 	//-------------Local Declarations------------//
 
@@ -2363,8 +2474,8 @@ double DCCALShower_factory::cell_hyc( double dx, double dy )
 //
 //==========================================================
 
-void DCCALShower_factory::tgamma_hyc( int nadc, vector<int> ia, vector<int> id, 
-	int nzero, vector<int> iaz, double &chisq, double &e1, double &x1, double &y1, 
+void DCCALShower_factory::tgamma_hyc( int nadc, const vector<int> &ia, const vector<int> &id, 
+	int nzero, const vector<int> &iaz, double &chisq, double &e1, double &x1, double &y1, 
 	double &e2, double &x2, double &y2 )
 {
 	//-------------- Local Declarations -------------//
@@ -2607,8 +2718,8 @@ void DCCALShower_factory::tgamma_hyc( int nadc, vector<int> ia, vector<int> id,
 //
 //==========================================================
 
-void DCCALShower_factory::mom2_pht( int nadc, vector<int> ia, vector<int> id, 
-	int nzero, vector<int> iaz, double &a0, double &x0, double &y0, 
+void DCCALShower_factory::mom2_pht( int nadc, const vector<int> &ia, const vector<int> &id, 
+	int nzero, const vector<int> &iaz, double &a0, double &x0, double &y0, 
 	double &xx, double &yy, double &yx)
 {
 	//-------------- Local Declarations --------------//
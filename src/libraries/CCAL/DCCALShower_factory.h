@@ -26,6 +26,7 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
+#include <string.h>
 #include <mutex>
 
 using namespace std;
@@ -53,20 +54,20 @@ class DCCALShower_factory:public JFactory<DCCALShower>{
 		
 		
 		
-		void getHitPatterns( vector< const DCCALHit* > hitarray, 
+		void getHitPatterns( const vector< const DCCALHit* > &hitarray, 
 				vector< vector< const DCCALHit* > > &hitPatterns );
 		
 		void sortByTime( vector< const DCCALHit* > &hitarray, float hitTime );
 		
-		void cleanHitPattern( vector< const DCCALHit* > hitarray, 
+		void cleanHitPattern( const vector< const DCCALHit* > &hitarray, 
 				vector< const DCCALHit* > &hitarrayClean );
 		
-		void processShowers( vector< gamma_t > gammas, DCCALGeometry ccalGeom, 
-				vector< const DCCALHit* > locHitPattern, int eventnumber, 
+		void processShowers( const vector< gamma_t > &gammas, const DCCALGeometry &ccalGeom, 
+				const vector< const DCCALHit* > &locHitPattern, int eventnumber, 
 				vector< ccalcluster_t > &ccalClusters, 
 				vector< cluster_t > &clusterStorage );
 		
-		double getEnergyWeightedTime( cluster_t clusterStorage, int nHits );
+		double getEnergyWeightedTime( const cluster_t &clusterStorage, int nHits );
 		double getCorrectedTime( double time, double energy );
 		double getShowerDepth( double energy );
 		double getCorrectedEnergy( double energy, int id );
@@ -98,6 +99,21 @@ class DCCALShower_factory:public JFactory<DCCALShower>{
 		
 		int stat_ch[MROW][MCOL];	
 		
+		// live neighbours of each cell, indexed [ix-1][iy-1] (see brun)
+		int m_neighbors[MCOL][MROW][8];
+		int m_nNeighbors[MCOL][MROW];
+		
+		
+		//--------------  Island working space (per thread) --------------//
+		
+		unsigned char m_cellMask[MCOL][MROW];
+		vector<int> m_icl_a, m_icl_d;
+		vector<int> m_iwrk_a, m_iwrk_d;
+		vector<int> m_iaz;
+		vector<int> m_iwrk[13];
+		vector<int> m_idp[13];
+		vector<double> m_fwrk[13];
+		
 		
 		
 		//----------------------- Island Functions -----------------------//
@@ -114,28 +130,29 @@ class DCCALShower_factory:public JFactory<DCCALShower>{
 				
 		int  peak_type( int ix, int iy );
 		
-		void gamma_hyc( int nadc, vector<int> ia, vector<int> id, double &chisq, 
+		void gamma_hyc( int nadc, const vector<int> &ia, const vector<int> &id, double &chisq, 
 				double &e1, double &x1, double &y1, 
 				double &e2, double &x2, double &y2 );
 				
-		void fill_zeros( int nadc, vector<int> ia, int &nneib, vector<int> &iaz );
+		void fill_zeros( int nadc, const vector<int> &ia, int &nneib, vector<int> &iaz );
+		void fill_zeros_scan( int nadc, const vector<int> &ia, int &nneib, vector<int> &iaz );
 		
-		void mom1_pht( int nadc, vector<int> ia, vector<int> id, int nzero, 
-				vector<int> iaz, double &e1, double &x1, double &y1 );
+		void mom1_pht( int nadc, const vector<int> &ia, const vector<int> &id, int nzero, 
+				const vector<int> &iaz, double &e1, double &x1, double &y1 );
 				
-		void chisq1_hyc( int nadc, vector<int> ia, vector<int> id, int nneib, 
-				vector<int> iaz, double e1, double x1, double y1, double &chisq );
+		void chisq1_hyc( int nadc, const vector<int> &ia, const vector<int> &id, int nneib, 
+				const vector<int> &iaz, double e1, double x1, double y1, double &chisq );
 				
 		double sigma2( double dx, double dy, double fc, double e );
 		double d2c( double x, double y );
 		double cell_hyc( double dx, double dy );
 		
-		void tgamma_hyc( int nadc, vector<int> ia, vector<int> id, int nneib, 
-				vector<int> iaz, double &chisq, double &e1, double &x1, 
+		void tgamma_hyc( int nadc, const vector<int> &ia, const vector<int> &id, int nneib, 
+				const vector<int> &iaz, double &chisq, double &e1, double &x1, 
 				double &y1, double &e2, double &x2, double &y2 );
 				
-		void mom2_pht( int nadc, vector<int> ia, vector<int> id, int nzero, 
-				vector<int> iaz, double &a0, double &x0, double &y0, 
+		void mom2_pht( int nadc, const vector<int> &ia, const vector<int> &id, int nzero, 
+				const vector<int> &iaz, double &a0, double &x0, double &y0, 
 				double &xx, double &yy, double &yx );
 				
 		void c3to5_pht( double e0, double x0, double y0, double eps, double dx, 
@@ -165,6 +182,7 @@ class DCCALShower_factory:public JFactory<DCCALShower>{
 		double        TIME_CUT;
 		int           MAX_HITS_FOR_CLUSTERING;
 		int           DO_NONLINEAR_CORRECTION;
+		int           CHECK_NEIGHBOR_TABLE;
 		
 		double        CCAL_RADIATION_LENGTH;
 		double        CCAL_CRITICAL_ENERGY;
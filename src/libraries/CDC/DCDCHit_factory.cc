@@ -12,6 +12,7 @@
 #include <CDC/DCDCHit.h>
 
 #include "DCDCHit_factory.h"
+#include "DANA/DApplication.h"
 
 static double DIGI_THRESHOLD = -1.0e8;
 
@@ -55,6 +56,11 @@ jerror_t DCDCHit_factory::init(void)
   // This factory will manage this memory.
   SetFactoryFlag(NOT_OBJECT_OWNER);
   
+  // tables loaded once for all threads by the shared calibration cache
+  DApplication* dapp = dynamic_cast<DApplication*>(japp);
+  calib_cache = dapp->GetCalibCache();
+  calib_cache->Declare< vector<double> >("/CDC/timing_cut");
+
   return NOERROR;
 }
 
@@ -69,7 +75,7 @@ jerror_t DCDCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
   
   vector<double> cdc_timing_cuts;
   
-  if (eventLoop->GetCalib("/CDC/timing_cut", cdc_timing_cuts)){
+  if (calib_cache->GetCalib(eventLoop, "/CDC/timing_cut", cdc_timing_cuts)){
     LowTCut = -60.;
     HighTCut = 900.;
     jout << "Error loading /CDC/timing_cut ! set defaul values -60. and 900." << endl;
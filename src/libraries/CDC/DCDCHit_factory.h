@@ -9,6 +9,7 @@
 #define _DCDCHit_factory_
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include <DAQ/Df125CDCPulse.h>
 #include <TTAB/DTranslationTable.h>
 
@@ -55,6 +56,7 @@ class DCDCHit_factory: public jana::JFactory<DCDCHit>{
 
 	bool USE_CDC;  
   vector<const DTranslationTable *> ttab;
+  DCalibCache *calib_cache;
 };
 
 #endif // _DCDCHit_factory_
@@ -15,6 +15,7 @@ using std::string;
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <chrono>
  
 
 #include "DApplication.h"
@@ -83,6 +84,34 @@ DApplication::DApplication(int narg, char* argv[]):JApplication(narg, argv)
 	if (parmap.empty()) {
 		pm->SetParameter("THREAD_TIMEOUT", "30 seconds");
 	}
+
+	// Calibration constants shared by all threads
+	calib_cache = new DCalibCache(pm);
+
+	// The per-run resources can be built on background threads as soon
+	// as an event source sees a new run number coming, instead of by the
+	// factories' brun() once its first event is processed (see PrepareRun)
+	// The field map, material map and DIRC LUT are not listed: they are
+	// built once per job under the DApplication mutex, so building them
+	// ahead of time would only block the threads that need the mutex.
+	ASYNC_BRUN = false;
+	ASYNC_BRUN_STEPS = "calib,geometry";
+	pm->SetDefaultParameter("DANA:ASYNC_BRUN", ASYNC_BRUN, "Set to 1 to build the per-run resources in the background as soon as an event source sees a new run number. Otherwise they are built when the factories ask for them.");
+	pm->SetDefaultParameter("DANA:ASYNC_BRUN_STEPS", ASYNC_BRUN_STEPS, "Comma separated list of per-run resources built in the background for DANA:ASYNC_BRUN. Any of: calib (declared calibration tables), geometry");
+	run_prep_thread = NULL;
+	run_prep_done = false;
+	last_run_to_prepare = 0;
+
+	stringstream ss(ASYNC_BRUN_STEPS);
+	string step;
+	while(getline(ss, step, ',')){
+		if(step == "calib")
+			AddRunPreparation(step, [this](int32_t run_number){calib_cache->Prefetch(run_number, GetJCalibration(run_number));});
+		else if(step == "geometry")
+			AddRunPreparation(step, [this](int32_t run_number){GetDGeometry(run_number);});
+		else if(step != "")
+			jerr << "Unknown DANA:ASYNC_BRUN_STEPS entry \"" << step << "\" (ignored)" << endl;
+	}
 	
 	// Optionally copy SQLite CCDB file to local disk
 	CopySQLiteToLocalDisk();
@@ -195,8 +224,20 @@ jerror_t DApplication::Init(void)
 //---------------------------------
 DApplication::~DApplication()
 {
+	// Stop preparing runs before deleting what it may be building
+	if(run_prep_thread){
+		{
+			lock_guard<std::mutex> lck(run_prep_mutex);
+			run_prep_done = true;
+		}
+		run_prep_cv.notify_all();
+		run_prep_thread->join();
+		delete run_prep_thread;
+	}
+
 	if(bfield) delete bfield;
 	if(lorentz_def) delete lorentz_def;
+	if(calib_cache) delete calib_cache;
 	
 	// As of JANA 0.6.3 and later, the following are 
 	// automatically deleted when ~JApplication is called.
@@ -531,3 +572,83 @@ DDIRCLutReader* DApplication::GetDIRCLut(unsigned int run_number)
 	
 	return dircLut;
 }
+
+//---------------------------------
+// AddRunPreparation
+//---------------------------------
+void DApplication::AddRunPreparation(string name, function<void(int32_t)> preparation)
+{
+	/// Add a step to the preparation of new runs (see PrepareRun). The
+	/// steps of a run are run on parallel threads. They should only build
+	/// resources that are cached for the factories to pick up in brun(),
+	/// e.g. by calling one of the Get methods of this class.
+	lock_guard<std::mutex> lck(run_prep_mutex);
+	run_preparations.push_back(make_pair(name, preparation));
+}
+
+//---------------------------------
+// PrepareRun
+//---------------------------------
+void DApplication::PrepareRun(int32_t run_number)
+{
+	/// Start building the per-run resources of the given run in the
+	/// background, if that wasn't done already. This is called by the
+	/// event sources as soon as they see a run number, e.g. when opening
+	/// a file or when parsing events ahead of their processing. When the
+	/// first events of the run reach the factories, their brun() then
+	/// finds the resources ready (or waits for them to be finished)
+	/// instead of building them one after the other, while the events
+	/// of the previous run are still being processed.
+	///
+	/// This is cheap when called again for the same run, so the sources
+	/// may call it for every event.
+
+	if(!ASYNC_BRUN || run_number <= 0) return;
+	if(last_run_to_prepare.exchange(run_number) == run_number) return;
+
+	lock_guard<std::mutex> lck(run_prep_mutex);
+	if(run_prep_done || run_preparations.empty()) return;
+	if(!runs_prepared.insert(run_number).second) return;
+	runs_to_prepare.push_back(run_number);
+	if(!run_prep_thread) run_prep_thread = new thread(&DApplication::RunPreparationThread, this);
+	run_prep_cv.notify_all();
+}
+
+//---------------------------------
+// RunPreparationThread
+//---------------------------------
+void DApplication::RunPreparationThread(void)
+{
+	while(true){
+		unique_lock<std::mutex> lck(run_prep_mutex);
+		run_prep_cv.wait(lck, [this]{return run_prep_done || !runs_to_prepare.empty();});
+		if(run_prep_done) break;
+		int32_t run_number = runs_to_prepare.front();
+		runs_to_prepare.pop_front();
+		auto preparations = run_preparations;
+		lck.unlock();
+
+		jout << "Preparing run " << run_number << " in the background ..." << endl;
+		auto start_time = chrono::steady_clock::now();
+		vector<double> prep_ms(preparations.size(), 0.0);
+		vector<thread> threads;
+		for(unsigned int i=0; i<preparations.size(); i++){
+			threads.push_back(thread([&, i](){
+				auto prep_start = chrono::steady_clock::now();
+				try{
+					preparations[i].second(run_number);
+				}catch(...){
+					// brun() will find this out (again) and report it
+					jerr << "Exception while preparing " << preparations[i].first << " for run " << run_number << endl;
+				}
+				prep_ms[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - prep_start).count();
+			}));
+		}
+		for(auto &t : threads) t.join();
+
+		stringstream times;
+		for(unsigned int i=0; i<preparations.size(); i++) times << " " << preparations[i].first << ":" << prep_ms[i];
+		double total_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start_time).count();
+		jout << "Prepared run " << run_number << " in " << total_ms << " ms (ms per step:" << times.str() << ")" << endl;
+	}
+}
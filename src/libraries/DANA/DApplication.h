@@ -12,6 +12,11 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
 
 #include "TF1.h"
 
@@ -22,6 +27,7 @@ using namespace std;
 
 #include "HDGEOMETRY/DGeometry.h"
 #include "DIRC/DDIRCLutReader.h"
+#include "DCalibCache.h"
 
 class DMagneticFieldMap;
 class DLorentzDeflections;
@@ -50,6 +56,10 @@ class DApplication:public JApplication{
 		DRootGeom *GetRootGeom(unsigned int run_number);
 		void CopySQLiteToLocalDisk(void);
 		DDIRCLutReader *GetDIRCLut(unsigned int run_number);
+		DCalibCache* GetCalibCache(void){return calib_cache;}
+
+		void PrepareRun(int32_t run_number);
+		void AddRunPreparation(string name, function<void(int32_t)> preparation);
 		
 		pthread_rwlock_t* GetReadWriteLock(string &name) {
 			return rw_locks.count( name ) == 0 ? nullptr : rw_locks[name];
@@ -70,8 +80,23 @@ class DApplication:public JApplication{
 	 	DRootGeom *RootGeom;	
 		vector<DGeometry*> geometries;
 		DDIRCLutReader *dircLut;
+		DCalibCache *calib_cache;
 
 		pthread_mutex_t mutex;
+
+		// Asynchronous preparation of the per-run resources (see PrepareRun)
+		void RunPreparationThread(void);
+
+		bool ASYNC_BRUN;
+		string ASYNC_BRUN_STEPS;
+		thread *run_prep_thread;
+		std::mutex run_prep_mutex;
+		condition_variable run_prep_cv;
+		bool run_prep_done;
+		atomic<int32_t> last_run_to_prepare;
+		deque<int32_t> runs_to_prepare;
+		set<int32_t> runs_prepared;
+		vector<pair<string, function<void(int32_t)> > > run_preparations;
 };
 
 #endif // _DApplication_
@@ -0,0 +1,320 @@
+// $Id$
+//
+//    File: DCalibCache.cc
+//
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "DCalibCache.h"
+
+// First line of the snapshot files
+static const char *kSnapshotHeader = "# DCalibCache snapshot v2";
+
+//---------------------------------
+// DCalibCache    (Constructor)
+//---------------------------------
+DCalibCache::DCalibCache(JParameterManager *pm)
+{
+	PRINT_LOAD_TIMES = false;
+	SNAPSHOT_READ = "";
+	SNAPSHOT_WRITE = "";
+	MAX_RUNS = 4;
+	pm->SetDefaultParameter("CALIB:PRINT_LOAD_TIMES", PRINT_LOAD_TIMES, "Print the time it took to load each calibration table of DCalibCache at the end of the job (slowest first)");
+	pm->SetDefaultParameter("CALIB:SNAPSHOT_READ", SNAPSHOT_READ, "Directory to read the calibration tables of DCalibCache from, if found there (files calib_snapshot_<run>.txt written with CALIB:SNAPSHOT_WRITE)");
+	pm->SetDefaultParameter("CALIB:SNAPSHOT_WRITE", SNAPSHOT_WRITE, "Directory to write all calibration tables loaded by DCalibCache to, one file per run");
+	pm->SetDefaultParameter("CALIB:MAX_RUNS", MAX_RUNS, "Number of most recently used runs of which DCalibCache keeps the calibration tables");
+	if(MAX_RUNS < 1) MAX_RUNS = 1;
+
+	Nrun_lookups = 0;
+	Nruns = 0;
+}
+
+//---------------------------------
+// ~DCalibCache    (Destructor)
+//---------------------------------
+DCalibCache::~DCalibCache()
+{
+	if(SNAPSHOT_WRITE != "") WriteSnapshots();
+	if(PRINT_LOAD_TIMES) PrintLoadTimes();
+}
+
+//---------------------------------
+// GetTable
+//---------------------------------
+shared_ptr<DCalibCache::DTableBase> DCalibCache::GetTable(int32_t run, JCalibration *jcalib, const table_key_t &key, table_maker_t maker)
+{
+	shared_ptr<DRunTables> run_tables = GetRunTables(run, jcalib);
+	shared_ptr<DTableSlot> slot = GetSlot(*run_tables, key);
+	return LoadSlot(*slot, jcalib, key, maker);
+}
+
+//---------------------------------
+// GetRunTables
+//---------------------------------
+shared_ptr<DCalibCache::DRunTables> DCalibCache::GetRunTables(int32_t run, JCalibration *jcalib)
+{
+	/// Get the tables of the given run. When the run is first seen, its
+	/// snapshot is read, all declared tables are prefetched and the least
+	/// recently used runs beyond CALIB:MAX_RUNS are dropped.
+
+	shared_ptr<DRunTables> run_tables;
+	map<table_key_t, table_maker_t> to_prefetch;
+	vector<pair<int32_t, shared_ptr<DRunTables> > > evicted;
+	{
+		lock_guard<mutex> lock(dMutex);
+		shared_ptr<DRunTables> &locRunTables = runs[run];
+		if(locRunTables == NULL){
+			locRunTables = make_shared<DRunTables>();
+			Nruns++;
+		}
+		run_tables = locRunTables;
+		run_tables->last_used = ++Nrun_lookups;
+		if(!run_tables->prefetched){
+			run_tables->prefetched = true;
+			to_prefetch = declared;
+		}
+
+		while(runs.size() > MAX_RUNS){
+			auto oldest = runs.end();
+			for(auto iter = runs.begin(); iter != runs.end(); ++iter){
+				if(oldest == runs.end() || iter->second->last_used < oldest->second->last_used)
+					oldest = iter;
+			}
+			evicted.push_back(*oldest);
+			runs.erase(oldest);
+		}
+	}
+
+	// Tables of runs no longer needed (threads still using them keep their copies)
+	if(SNAPSHOT_WRITE != ""){
+		for(auto &run_iter : evicted) WriteSnapshot(run_iter.first, *run_iter.second);
+	}
+
+	// Every user of the run waits for its snapshot before loading any table
+	if(SNAPSHOT_READ != "")
+		call_once(run_tables->snapshot_read, [&](){ReadSnapshot(run, *run_tables);});
+
+	if(!to_prefetch.empty()){
+		auto start_time = chrono::steady_clock::now();
+		for(auto &decl : to_prefetch) LoadSlot(*GetSlot(*run_tables, decl.first), jcalib, decl.first, decl.second);
+		double prefetch_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start_time).count();
+		jout << "Prefetched " << to_prefetch.size() << " calibration tables for run " << run << " in " << prefetch_ms << " ms" << endl;
+	}
+
+	return run_tables;
+}
+
+//---------------------------------
+// GetSlot
+//---------------------------------
+shared_ptr<DCalibCache::DTableSlot> DCalibCache::GetSlot(DRunTables &run_tables, const table_key_t &key)
+{
+	lock_guard<mutex> lock(dMutex);
+	shared_ptr<DTableSlot> &slot = run_tables.tables[key];
+	if(slot == NULL) slot = make_shared<DTableSlot>();
+	return slot;
+}
+
+//---------------------------------
+// Prefetch
+//---------------------------------
+void DCalibCache::Prefetch(int32_t run, JCalibration *jcalib)
+{
+	GetRunTables(run, jcalib);
+}
+
+//---------------------------------
+// LoadSlot
+//---------------------------------
+shared_ptr<DCalibCache::DTableBase> DCalibCache::LoadSlot(DTableSlot &slot, JCalibration *jcalib, const table_key_t &key, table_maker_t maker)
+{
+	/// Load one table from the snapshot or the calibration DB, unless
+	/// it already is. Threads asking for the same table wait here for
+	/// the one loading it; dMutex is not held meanwhile.
+
+	lock_guard<mutex> load_lock(slot.load_mutex);
+	if(slot.table != NULL) return slot.table;
+
+	auto start_time = chrono::steady_clock::now();
+	shared_ptr<DTableBase> table(maker());
+
+	bool from_snapshot = false;
+	if(slot.has_snapshot){
+		istringstream ss(slot.snapshot);
+		from_snapshot = !table->Read(ss);
+		slot.has_snapshot = false;
+		slot.snapshot.clear();
+	}
+	if(!from_snapshot){
+		if(jcalib)
+			table->Load(jcalib, key.first);
+		else
+			table->failed = true;
+	}
+	slot.table = table;
+
+	double load_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start_time).count();
+	lock_guard<mutex> lock(dMutex);
+	DLoadStats &stats = load_stats[key];
+	stats.Nloads++;
+	if(from_snapshot) stats.Nsnapshot++;
+	if(table->failed) stats.Nfailed++;
+	stats.total_ms += load_ms;
+	stats.max_ms = max(stats.max_ms, load_ms);
+
+	return table;
+}
+
+//---------------------------------
+// SnapshotFilename
+//---------------------------------
+string DCalibCache::SnapshotFilename(string dir, int32_t run) const
+{
+	stringstream ss;
+	ss << dir << "/calib_snapshot_" << run << ".txt";
+	return ss.str();
+}
+
+//---------------------------------
+// ReadSnapshot
+//---------------------------------
+void DCalibCache::ReadSnapshot(int32_t run, DRunTables &run_tables)
+{
+	/// Read the text of all tables of a run from its snapshot file.
+	/// After a header line, each table is its namepath and type (as
+	/// length-prefixed strings), the length of the values text, a
+	/// newline, the values text and a newline. The values are only
+	/// parsed when the table is requested, as then the type is known.
+
+	string fname = SnapshotFilename(SNAPSHOT_READ, run);
+	ifstream ifs(fname.c_str(), ios::binary);
+	if(!ifs.is_open()){
+		jout << "No calibration snapshot " << fname << " (tables will be read from the calibration DB)" << endl;
+		return;
+	}
+
+	string header;
+	if(!getline(ifs, header) || header != kSnapshotHeader){
+		jerr << "Calibration snapshot " << fname << " is not in the " << kSnapshotHeader << " format (ignored)" << endl;
+		return;
+	}
+
+	map<table_key_t, string> snapshot;
+	while(true){
+		table_key_t key;
+		size_t len = 0;
+		if(!ReadValue(ifs, key.first) || !ReadValue(ifs, key.second) || !(ifs >> len)) break;
+		if(ifs.get() != '\n') break;
+		string values(len, ' ');
+		if(len > 0 && !ifs.read(&values[0], len)) break;
+		if(ifs.get() != '\n') break;
+		snapshot[key] = values;
+	}
+	if(!ifs.eof())
+		jerr << "Calibration snapshot " << fname << " is truncated or corrupt after " << snapshot.size() << " tables" << endl;
+
+	lock_guard<mutex> lock(dMutex);
+	for(auto &iter : snapshot){
+		shared_ptr<DTableSlot> &slot = run_tables.tables[iter.first];
+		if(slot == NULL) slot = make_shared<DTableSlot>();
+		slot->has_snapshot = true;
+		slot->snapshot = iter.second;
+	}
+	jout << "Read " << snapshot.size() << " calibration tables from snapshot " << fname << endl;
+}
+
+//---------------------------------
+// WriteSnapshot
+//---------------------------------
+void DCalibCache::WriteSnapshot(int32_t run, DRunTables &run_tables)
+{
+	map<table_key_t, shared_ptr<DTableSlot> > tables;
+	{
+		lock_guard<mutex> lock(dMutex);
+		tables = run_tables.tables;
+	}
+
+	string fname = SnapshotFilename(SNAPSHOT_WRITE, run);
+	ofstream ofs(fname.c_str(), ios::binary);
+	if(!ofs.is_open()){
+		jerr << "Unable to write calibration snapshot " << fname << endl;
+		return;
+	}
+	ofs << kSnapshotHeader << "\n";
+
+	unsigned int Ntables = 0;
+	for(auto &table_iter : tables){
+		DTableSlot &slot = *table_iter.second;
+		lock_guard<mutex> load_lock(slot.load_mutex);
+
+		// Tables read from the snapshot that were never requested are copied as they are
+		string values;
+		if(slot.table != NULL){
+			if(slot.table->failed) continue;
+			ostringstream ss;
+			ss << setprecision(17);
+			slot.table->Write(ss);
+			values = ss.str();
+		}
+		else if(slot.has_snapshot)
+			values = slot.snapshot;
+		else
+			continue;
+
+		WriteValue(ofs, table_iter.first.first);
+		ofs << ' ';
+		WriteValue(ofs, table_iter.first.second);
+		ofs << ' ' << values.size() << "\n" << values << "\n";
+		Ntables++;
+	}
+	jout << "Wrote " << Ntables << " calibration tables to snapshot " << fname << endl;
+}
+
+//---------------------------------
+// WriteSnapshots
+//---------------------------------
+void DCalibCache::WriteSnapshots(void)
+{
+	map<int32_t, shared_ptr<DRunTables> > locRuns;
+	{
+		lock_guard<mutex> lock(dMutex);
+		locRuns = runs;
+	}
+	for(auto &run_iter : locRuns) WriteSnapshot(run_iter.first, *run_iter.second);
+}
+
+//---------------------------------
+// PrintLoadTimes
+//---------------------------------
+void DCalibCache::PrintLoadTimes(void)
+{
+	lock_guard<mutex> lock(dMutex);
+	vector<pair<double, table_key_t> > order;
+	for(auto &iter : load_stats) order.push_back(make_pair(iter.second.total_ms, iter.first));
+	sort(order.rbegin(), order.rend());
+
+	jout << "Calibration table load times (" << load_stats.size() << " tables, " << Nruns << " runs):" << endl;
+	jout << setw(12) << "total ms" << setw(10) << "max ms" << setw(7) << "loads" << setw(10) << "snapshot" << setw(8) << "failed" << "  namepath" << endl;
+	for(auto &entry : order){
+		const DLoadStats &stats = load_stats[entry.second];
+		jout << fixed << setprecision(2);
+		jout << setw(12) << stats.total_ms << setw(10) << stats.max_ms << setw(7) << stats.Nloads;
+		jout << setw(10) << stats.Nsnapshot << setw(8) << stats.Nfailed << "  " << entry.second.first << endl;
+	}
+}
+
+//---------------------------------
+// ReadValue
+//---------------------------------
+bool DCalibCache::ReadValue(istream &is, string &val)
+{
+	// Strings are written as <length>:<characters>
+	size_t len = 0;
+	char colon = 0;
+	if(!(is >> len >> colon) || colon != ':') return false;
+	val.resize(len);
+	if(len > 0 && !is.read(&val[0], len)) return false;
+	return true;
+}
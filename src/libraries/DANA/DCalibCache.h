@@ -0,0 +1,254 @@
+// $Id$
+//
+//    File: DCalibCache.h
+//
+
+#ifndef _DCalibCache_
+#define _DCalibCache_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <sstream>
+#include <typeinfo>
+#include <cstdint>
+
+#include <JANA/JEventLoop.h>
+#include <JANA/JCalibration.h>
+#include <JANA/JParameterManager.h>
+using namespace jana;
+using namespace std;
+
+/// Calibration constants shared by all threads (see DApplication::GetCalibCache()).
+///
+/// Each namepath is fetched from the calibration DB and parsed once per run and
+/// requested type, into an immutable table of which all threads get read-only
+/// (shared_ptr<const T>) views. The namepaths that were declared with Declare(),
+/// e.g. in the factories' init(), are all loaded together with the first table
+/// requested for a run. A table is loaded under its own lock, so threads only
+/// wait for the tables they need and different tables load in parallel. Only
+/// the CALIB:MAX_RUNS most recently used runs are kept. The load time of every
+/// table is recorded; set CALIB:PRINT_LOAD_TIMES=1 to get them, slowest first,
+/// at the end of the job. Prefetch() loads them ahead of time (see
+/// DApplication::PrepareRun()).
+///
+/// With CALIB:SNAPSHOT_WRITE=dir all loaded tables are written to one text file
+/// per run (dir/calib_snapshot_<run>.txt), when the run is dropped from the cache
+/// or at the end of the job. With CALIB:SNAPSHOT_READ=dir the tables are taken
+/// from these files, so a job can run without access to the database for the
+/// tables it finds there.
+///
+/// The types are those of JEventLoop::GetCalib(): map<string,T>, vector<T>,
+/// vector< map<string,T> > and vector< vector<T> >, with T double, int or string.
+/// As JEventLoop::GetCalib(), Get() and GetCalib() return true on error.
+class DCalibCache{
+	public:
+		DCalibCache(JParameterManager *pm);
+		~DCalibCache();
+
+		// Namepath to prefetch for every run, as type T
+		template<class T> void Declare(string namepath);
+
+		// Read-only table shared by all threads
+		template<class T> bool Get(JEventLoop *loop, string namepath, shared_ptr<const T> &vals);
+		// Copy of the table (replacement for JEventLoop::GetCalib)
+		template<class T> bool GetCalib(JEventLoop *loop, string namepath, T &vals);
+
+		// Load the declared tables of a run now
+		void Prefetch(int32_t run, JCalibration *jcalib);
+
+		void PrintLoadTimes(void);
+		void WriteSnapshots(void);
+
+	private:
+
+		class DTableBase{
+			public:
+				DTableBase(void) : failed(false) {}
+				virtual ~DTableBase() {}
+				virtual void Load(JCalibration *jcalib, string namepath) = 0;
+				virtual bool Read(istream &is) = 0; // true on error
+				virtual void Write(ostream &os) const = 0;
+
+				bool failed;
+		};
+
+		template<class T> class DTable : public DTableBase{
+			public:
+				DTable(void) : vals(make_shared<T>()) {}
+				void Load(JCalibration *jcalib, string namepath){
+					shared_ptr<T> locVals = make_shared<T>();
+					failed = jcalib->Get(namepath, *locVals);
+					vals = locVals;
+				}
+				bool Read(istream &is){
+					shared_ptr<T> locVals = make_shared<T>();
+					if(!ReadValue(is, *locVals)) return true;
+					vals = locVals;
+					return false;
+				}
+				void Write(ostream &os) const {WriteValue(os, *vals);}
+
+				shared_ptr<const T> vals;
+		};
+
+		typedef pair<string, string> table_key_t; // namepath, type
+		typedef DTableBase* (*table_maker_t)(void);
+		template<class T> static DTableBase* MakeTable(void) {return new DTable<T>();}
+
+		// One table of a run: loaded at most once, under load_mutex
+		class DTableSlot{
+			public:
+				DTableSlot(void) : has_snapshot(false) {}
+				mutex load_mutex;
+				shared_ptr<DTableBase> table; // NULL until loaded
+				bool has_snapshot;
+				string snapshot; // not yet parsed table from CALIB:SNAPSHOT_READ
+		};
+
+		class DRunTables{
+			public:
+				DRunTables(void) : prefetched(false), last_used(0) {}
+				map<table_key_t, shared_ptr<DTableSlot> > tables; // dMutex
+				bool prefetched; // dMutex
+				uint64_t last_used; // dMutex
+				once_flag snapshot_read;
+		};
+
+		class DLoadStats{
+			public:
+				DLoadStats(void) : Nloads(0), Nsnapshot(0), Nfailed(0), total_ms(0.0), max_ms(0.0) {}
+				unsigned int Nloads;
+				unsigned int Nsnapshot;
+				unsigned int Nfailed;
+				double total_ms;
+				double max_ms;
+		};
+
+		shared_ptr<DTableBase> GetTable(int32_t run, JCalibration *jcalib, const table_key_t &key, table_maker_t maker);
+		shared_ptr<DRunTables> GetRunTables(int32_t run, JCalibration *jcalib);
+		shared_ptr<DTableSlot> GetSlot(DRunTables &run_tables, const table_key_t &key);
+		shared_ptr<DTableBase> LoadSlot(DTableSlot &slot, JCalibration *jcalib, const table_key_t &key, table_maker_t maker);
+		void ReadSnapshot(int32_t run, DRunTables &run_tables);
+		void WriteSnapshot(int32_t run, DRunTables &run_tables);
+		string SnapshotFilename(string dir, int32_t run) const;
+
+		// Snapshot text format of the values
+		static void WriteValue(ostream &os, double val){os << val;}
+		static void WriteValue(ostream &os, int val){os << val;}
+		static void WriteValue(ostream &os, const string &val){os << val.size() << ':' << val;}
+		template<class T> static void WriteValue(ostream &os, const vector<T> &vals);
+		template<class T> static void WriteValue(ostream &os, const map<string, T> &vals);
+		static bool ReadValue(istream &is, double &val){return bool(is >> val);}
+		static bool ReadValue(istream &is, int &val){return bool(is >> val);}
+		static bool ReadValue(istream &is, string &val);
+		template<class T> static bool ReadValue(istream &is, vector<T> &vals);
+		template<class T> static bool ReadValue(istream &is, map<string, T> &vals);
+
+		bool PRINT_LOAD_TIMES;
+		string SNAPSHOT_READ;
+		string SNAPSHOT_WRITE;
+		unsigned int MAX_RUNS;
+
+		// Guards the maps below and the run/slot bookkeeping, never held
+		// while a table is loaded or a snapshot file read or written
+		mutex dMutex;
+		map<table_key_t, table_maker_t> declared;
+		map<int32_t, shared_ptr<DRunTables> > runs;
+		map<table_key_t, DLoadStats> load_stats;
+		uint64_t Nrun_lookups;
+		unsigned int Nruns;
+};
+
+//---------------------------------
+// Declare
+//---------------------------------
+template<class T>
+void DCalibCache::Declare(string namepath)
+{
+	lock_guard<mutex> lock(dMutex);
+	declared[table_key_t(namepath, typeid(T).name())] = &MakeTable<T>;
+}
+
+//---------------------------------
+// Get
+//---------------------------------
+template<class T>
+bool DCalibCache::Get(JEventLoop *loop, string namepath, shared_ptr<const T> &vals)
+{
+	table_key_t key(namepath, typeid(T).name());
+	shared_ptr<DTableBase> table = GetTable(loop->GetJEvent().GetRunNumber(), loop->GetJCalibration(), key, &MakeTable<T>);
+
+	vals = static_pointer_cast<DTable<T> >(table)->vals;
+	return table->failed;
+}
+
+//---------------------------------
+// GetCalib
+//---------------------------------
+template<class T>
+bool DCalibCache::GetCalib(JEventLoop *loop, string namepath, T &vals)
+{
+	shared_ptr<const T> table;
+	bool failed = Get(loop, namepath, table);
+	vals = *table;
+	return failed;
+}
+
+//---------------------------------
+// WriteValue
+//---------------------------------
+template<class T>
+void DCalibCache::WriteValue(ostream &os, const vector<T> &vals)
+{
+	os << vals.size();
+	for(auto &val : vals){
+		os << ' ';
+		WriteValue(os, val);
+	}
+}
+
+template<class T>
+void DCalibCache::WriteValue(ostream &os, const map<string, T> &vals)
+{
+	os << vals.size();
+	for(auto &val : vals){
+		os << ' ';
+		WriteValue(os, val.first);
+		os << ' ';
+		WriteValue(os, val.second);
+	}
+}
+
+//---------------------------------
+// ReadValue
+//---------------------------------
+template<class T>
+bool DCalibCache::ReadValue(istream &is, vector<T> &vals)
+{
+	size_t N = 0;
+	if(!(is >> N)) return false;
+	vals.resize(N);
+	for(auto &val : vals){
+		if(!ReadValue(is, val)) return false;
+	}
+	return true;
+}
+
+template<class T>
+bool DCalibCache::ReadValue(istream &is, map<string, T> &vals)
+{
+	size_t N = 0;
+	if(!(is >> N)) return false;
+	for(size_t i=0; i<N; i++){
+		string key;
+		if(!ReadValue(is, key)) return false;
+		if(!ReadValue(is, vals[key])) return false;
+	}
+	return true;
+}
+
+#endif // _DCalibCache_
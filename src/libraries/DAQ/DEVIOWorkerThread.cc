@@ -72,6 +72,8 @@ DEVIOWorkerThread::DEVIOWorkerThread(
 	PARSE_SSP           = true;
 	PARSE_GEMSRS        = true;
         NSAMPLES_GEMSRS     = 9;
+	KEEP_RAW_EVENT      = false;
+	raw_buffer_pool     = make_shared<DRawBufferPool>();
 	
 	LINK_TRIGGERTIME    = true;
 }
@@ -265,10 +267,37 @@ void DEVIOWorkerThread::MakeEvents(void)
 		pe->copied_to_factories = false;
 		pe->event_status_bits   = 0;
 		pe->borptrs      = NULL; // may be set by either ParseBORbank or JEventSource_EVIOpp::GetEvent
+		pe->raw_event.reset();
 	}
 
 	// Parse data in buffer to create data objects
 	ParseBank();
+
+	// Optionally hand the buffer over to the event so it can be written out
+	// unchanged (see DEventWriterEVIO). It is not copied: we take another one
+	// for the next EVIO event instead. It is returned to raw_buffer_pool when
+	// the event is freed (JEventSource_EVIOpp::FreeEvent). Blocks of entangled
+	// events are not kept since single events can't be taken out of them
+	// without re-encoding.
+	if( KEEP_RAW_EVENT && (current_parsed_events.size()==1) ){
+		shared_ptr<DRawBufferPool> pool = raw_buffer_pool;
+		uint32_t len = buff_len;
+		current_parsed_events.front()->raw_event = shared_ptr<const uint32_t>(buff, [pool, len](const uint32_t *b){
+			lock_guard<mutex> lck(pool->mtx);
+			pool->buffers.push_back(make_pair(const_cast<uint32_t*>(b), len));
+		});
+
+		buff = NULL;
+		{
+			lock_guard<mutex> lck(raw_buffer_pool->mtx);
+			if(!raw_buffer_pool->buffers.empty()){
+				buff     = raw_buffer_pool->buffers.back().first;
+				buff_len = raw_buffer_pool->buffers.back().second; // grows as needed when reading
+				raw_buffer_pool->buffers.pop_back();
+			}
+		}
+		if(buff == NULL) buff = new uint32_t[buff_len];
+	}
 	
 	// Occasionally prune extra DParsedEvent objects as well as objects
 	// from the existing pools to reduce average memory usage. We do
@@ -288,6 +317,9 @@ void DEVIOWorkerThread::PublishEvents(void)
 	/// Copy our "current_parsed_events" pointers into the global "parsed_events"
 	/// list making them available for consumption. 
 	
+	// The events may be processed much later: have their runs prepared now
+	for(auto pe : current_parsed_events) event_source->PrepareRun(pe->run_number);
+
 	// Lock mutex so other threads can't modify parsed_events
 	unique_lock<mutex> lck(PARSED_EVENTS_MUTEX);
 	
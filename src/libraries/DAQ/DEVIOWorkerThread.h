@@ -80,6 +80,16 @@ class DEVIOWorkerThread{
 		uint32_t *buff;
 		streampos pos;
 
+		// Event buffers handed over to DParsedEvent::raw_event (KEEP_RAW_EVENT)
+		// come back here once the event is freed so they can be reused
+		class DRawBufferPool{
+			public:
+				~DRawBufferPool(){ for(auto &b : buffers) delete[] b.first; }
+				mutex mtx;
+				vector<pair<uint32_t*, uint32_t> > buffers; // buffer, length in words
+		};
+		shared_ptr<DRawBufferPool> raw_buffer_pool;
+
 		bool  PARSE_F250;
 		bool  PARSE_F125;
 		bool  PARSE_F1TDC;
@@ -92,6 +102,7 @@ class DEVIOWorkerThread{
 		bool  PARSE_SSP;
 		bool  PARSE_GEMSRS;
                 int   NSAMPLES_GEMSRS;
+		bool  KEEP_RAW_EVENT;
 
 		bool  LINK_TRIGGERTIME;
 		bool  LINK_CONFIG;
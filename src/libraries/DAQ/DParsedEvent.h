@@ -10,8 +10,10 @@
 
 #include <string>
 #include <map>
+#include <memory>
 using std::string;
 using std::map;
+using std::shared_ptr;
 
 #include <JANA/jerror.h>
 #include <JANA/JObject.h>
@@ -148,6 +150,11 @@ class DParsedEvent{
 		
 		DBORptrs *borptrs;
 		
+		// Original EVIO event (host byte order, raw_event.get()[0]+1 words). Only
+		// kept with EVIO:KEEP_RAW_EVENT and if the event is not part of a block
+		// of entangled events. Set in DEVIOWorkerThread::MakeEvents
+		shared_ptr<const uint32_t> raw_event;
+		
 		// For each type defined in "MyTypes" above, define a vector of
 		// pointers to it with a name made by prepending a "v" to the classname
 		// The following expands to things like e.g.
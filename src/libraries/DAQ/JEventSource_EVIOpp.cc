@@ -27,6 +27,7 @@ using namespace std::chrono;
 
 
 #include <TTAB/DTranslationTable_factory.h>
+#include <DANA/DApplication.h>
 #include <DAQ/Df250EmulatorAlgorithm_v1.h>
 #include <DAQ/Df250EmulatorAlgorithm_v2.h>
 #include <DAQ/Df250EmulatorAlgorithm_v3.h>
@@ -94,6 +95,7 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 	PARSE_SSP = true;
 	PARSE_GEMSRS = false;
         NSAMPLES_GEMSRS = 9;
+	KEEP_RAW_EVENT = false;
 	APPLY_TRANSLATION_TABLE = true;
 	IGNORE_EMPTY_BOR = false;
 	F250_EMULATION_MODE = kEmulationAuto;
@@ -136,6 +138,7 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 	gPARMS->SetDefaultParameter("EVIO:PARSE_SSP", PARSE_SSP, "Set this to 0 to disable parsing of the SSP (DIRC data) bank from CODA (for benchmarking/debugging)");
 	gPARMS->SetDefaultParameter("EVIO:PARSE_GEMSRS", PARSE_GEMSRS, "Set this to 0 to disable parsing of the SRS (GEM data) bank from CODA (for benchmarking/debugging)");
         gPARMS->SetDefaultParameter("EVIO:NSAMPLES_GEMSRS", NSAMPLES_GEMSRS, "Set this to number of readout samples for SRS (GEM data) bank from CODA (for benchmarking/debugging)");
+	gPARMS->SetDefaultParameter("EVIO:KEEP_RAW_EVENT", KEEP_RAW_EVENT, "Keep the original EVIO buffer of each event (not of blocks of entangled events) so it can be written out without re-encoding it (see EVIOOUT:PASSTHROUGH). This is turned on by the evio_writer plugin.");
 	gPARMS->SetDefaultParameter("EVIO:APPLY_TRANSLATION_TABLE", APPLY_TRANSLATION_TABLE, "Apply the translation table to create DigiHits (you almost always want this on)");
 	gPARMS->SetDefaultParameter("EVIO:IGNORE_EMPTY_BOR", IGNORE_EMPTY_BOR, "Set to non-zero to continue processing data even if an empty BOR event is encountered.");
 	gPARMS->SetDefaultParameter("EVIO:TREAT_TRUNCATED_AS_ERROR", TREAT_TRUNCATED_AS_ERROR, "Set to non-zero to have a truncated EVIO file the JANA return code to non-zero indicating the program errored.");
@@ -201,6 +204,11 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 	}
 
 	if(VERBOSE>0) evioout << "Success opening event source \"" << this->source_name << "\"!" <<endl;
+
+	// Start building the resources of the first run while the event
+	// threads are still busy with any previous source
+	dapp = dynamic_cast<DApplication*>(japp);
+	PrepareRun(run_number_seed);
 	
 	// Create dispatcher thread
 	dispatcher_thread = new thread(&JEventSource_EVIOpp::Dispatcher, this);
@@ -223,6 +231,7 @@ JEventSource_EVIOpp::JEventSource_EVIOpp(const char* source_name):JEventSource(s
 		w->PARSE_SSP           = PARSE_SSP;
 		w->PARSE_GEMSRS        = PARSE_GEMSRS;
                 w->NSAMPLES_GEMSRS     = NSAMPLES_GEMSRS;
+		w->KEEP_RAW_EVENT      = KEEP_RAW_EVENT;
 		w->LINK_TRIGGERTIME    = LINK_TRIGGERTIME;
 		w->LINK_CONFIG         = LINK_CONFIG;
 		w->run_number_seed     = run_number_seed;
@@ -602,11 +611,30 @@ void JEventSource_EVIOpp::FreeEvent(JEvent &event)
 	// effectively serializes everything done here. (Don't delete all
 	// objects in pe which can be slow.)
 	DParsedEvent *pe = (DParsedEvent*)event.GetRef();
+	pe->raw_event.reset(); // return the event buffer to its worker thread's pool
 	pe->in_use = false; // return pe to pool
 	
 	NEVENTS_PROCESSED++;
 }
 
+//----------------
+// GetRawEvent
+//----------------
+shared_ptr<const uint32_t> JEventSource_EVIOpp::GetRawEvent(JEvent &event) const
+{
+	/// Return the original EVIO event (host byte order) the given event was
+	/// parsed from. Its length is the first word + 1. This is only available if
+	/// EVIO:KEEP_RAW_EVENT is set and the event was not in a block of entangled
+	/// events. Otherwise, an empty pointer is returned.
+
+	if(event.GetJEventSource() != this) return shared_ptr<const uint32_t>();
+
+	DParsedEvent *pe = (DParsedEvent*)event.GetRef();
+	if(pe == NULL) return shared_ptr<const uint32_t>();
+
+	return pe->raw_event;
+}
+
 //----------------
 // GetObjects
 //----------------
@@ -756,6 +784,18 @@ void JEventSource_EVIOpp::LinkBORassociations(DParsedEvent *pe)
 //
 //}
 
+//----------------
+// PrepareRun
+//----------------
+void JEventSource_EVIOpp::PrepareRun(uint64_t run_number)
+{
+	/// Have the per-run resources built in the background before the
+	/// first event of the run gets processed (see DApplication::PrepareRun).
+	/// This is called by the worker threads for every parsed event.
+	if(USER_RUN_NUMBER>0) run_number = USER_RUN_NUMBER;
+	if(dapp) dapp->PrepareRun(run_number);
+}
+
 //----------------
 // SearchFileForRunNumber
 //----------------
@@ -29,6 +29,8 @@
 
 #include <DANA/DStatusBits.h>
 
+class DApplication;
+
 /// How this Event Source Works
 /// ===================================================================
 ///
@@ -131,10 +133,12 @@ class JEventSource_EVIOpp: public jana::JEventSource{
 
 		               void LinkBORassociations(DParsedEvent *pe);
 		           uint64_t SearchFileForRunNumber(void);
+		               void PrepareRun(uint64_t run_number);
 		               void EmulateDf250Firmware(DParsedEvent *pe);
 		               void EmulateDf125Firmware(DParsedEvent *pe);
 		               void AddToCallStack(DParsedEvent *pe, JEventLoop *loop);
 		               void AddSourceObjectsToCallStack(JEventLoop *loop, string className);
+		shared_ptr<const uint32_t> GetRawEvent(jana::JEvent &event) const;
 		               void AddEmulatedObjectsToCallStack(JEventLoop *loop, string caller, string callee);
 		               void AddROCIDtoParseList(uint32_t rocid){ ROCIDS_TO_PARSE.insert(rocid); }
 		      set<uint32_t> GetROCIDParseList(uint32_t rocid){ return ROCIDS_TO_PARSE; }
@@ -166,6 +170,7 @@ class JEventSource_EVIOpp: public jana::JEventSource{
 
 		vector<DEVIOWorkerThread*> worker_threads;
 		thread *dispatcher_thread;
+		DApplication *dapp;
 
 		JStreamLog evioout;
 		
@@ -193,6 +198,7 @@ class JEventSource_EVIOpp: public jana::JEventSource{
 		bool     PARSE_SSP;
 		bool     PARSE_GEMSRS;
                 int      NSAMPLES_GEMSRS;
+		bool     KEEP_RAW_EVENT;
 		bool     APPLY_TRANSLATION_TABLE;
 		int      ET_STATION_NEVENTS;
 		bool     ET_STATION_CREATE_BLOCKING;
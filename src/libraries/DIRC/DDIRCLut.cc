@@ -11,6 +11,25 @@ using namespace std;
 #include "DANA/DApplication.h"
 #include <JANA/JCalibration.h>
 
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+//---------------------------------
+// VectorAngle
+//---------------------------------
+// Same as TVector3::Angle, given the dot product and the two squared
+// magnitudes, so the LUT loop can work on plain doubles.
+static inline double VectorAngle(double dot, double mag2a, double mag2b)
+{
+	double ptot2 = mag2a*mag2b;
+	if(ptot2 <= 0) return 0.0;
+	double arg = dot/sqrt(ptot2);
+	if(arg >  1.0) arg =  1.0;
+	if(arg < -1.0) arg = -1.0;
+	return acos(arg);
+}
+
 //---------------------------------
 // DDIRCLut    (Constructor)
 //---------------------------------
@@ -47,6 +66,11 @@ DDIRCLut::DDIRCLut()
 	DIRC_THETAC_OFFSET = true;
 	gPARMS->SetDefaultParameter("DIRC:THETAC_OFFSET",DIRC_THETAC_OFFSET);
 
+	// Use the batched (prefiltered) photon loop in CalcLUT. The debug
+	// histograms are only filled by the per-photon CalcPhoton path.
+	DIRC_BATCH_LIKELIHOOD = true;
+	gPARMS->SetDefaultParameter("DIRC:BATCH_LIKELIHOOD",DIRC_BATCH_LIKELIHOOD, "Use batched photon likelihood loop in DDIRCLut::CalcLUT");
+
 	// set PID for different passes in debuging histograms
 	dFinalStatePIDs.push_back(Positron);
 	dFinalStatePIDs.push_back(PiPlus);
@@ -150,7 +174,7 @@ bool DDIRCLut::CreateDebugHistograms() {
 	return true;
 }
 
-bool DDIRCLut::CalcLUT(TVector3 locProjPos, TVector3 locProjMom, const vector<const DDIRCPmtHit*> locDIRCHits, double locFlightTime, double locMass, shared_ptr<DDIRCMatchParams>& locDIRCMatchParams, const vector<const DDIRCTruthBarHit*> locDIRCBarHits, map<shared_ptr<const DDIRCMatchParams>, vector<const DDIRCPmtHit*> >& locDIRCTrackMatchParams) const
+bool DDIRCLut::CalcLUT(TVector3 locProjPos, TVector3 locProjMom, const vector<const DDIRCPmtHit*>& locDIRCHits, double locFlightTime, double locMass, shared_ptr<DDIRCMatchParams>& locDIRCMatchParams, const vector<const DDIRCTruthBarHit*>& locDIRCBarHits, map<shared_ptr<const DDIRCMatchParams>, vector<const DDIRCPmtHit*> >& locDIRCTrackMatchParams) const
 {
 	// get bar and track position/momentum from extrapolation
 	TVector3 momInBar = locProjMom;
@@ -199,7 +223,27 @@ bool DDIRCLut::CalcLUT(TVector3 locProjPos, TVector3 locProjMom, const vector<co
 	int nPhotonsThetaC = 0;
 	double meanThetaC = 0.;
 	double meanDeltaT = 0.;
-	for (unsigned int loc_i = 0; loc_i < locDIRCHits.size(); loc_i++){
+	if(DIRC_BATCH_LIKELIHOOD && !DIRC_DEBUG_HISTS) {
+
+		double locExpected[kHypotheses], locLogLikelihood[kHypotheses];
+		for(uint loc_i = 0; loc_i<dFinalStatePIDs.size(); loc_i++) {
+			locExpected[loc_i] = locExpectedAngle[dFinalStatePIDs[loc_i]];
+			locLogLikelihood[loc_i] = 0;
+		}
+		double locCenterAngle = 0.5*(locExpectedAngle[PiPlus]+locExpectedAngle[KPlus]);
+
+		vector<const DDIRCPmtHit*> locGoodHits;
+		CalcPhotonsBatch(locDIRCHits, locFlightTime, posInBar, momInBar, locExpected, locCenterAngle, locLogLikelihood, nPhotonsThetaC, meanThetaC, meanDeltaT, locGoodHits);
+		nPhotons = locGoodHits.size();
+		if(nPhotons > 0) {
+			vector<const DDIRCPmtHit*> &locMatchedHits = locDIRCTrackMatchParams[locDIRCMatchParams];
+			locMatchedHits.insert(locMatchedHits.end(), locGoodHits.begin(), locGoodHits.end());
+		}
+
+		for(uint loc_i = 0; loc_i<dFinalStatePIDs.size(); loc_i++)
+			logLikelihoodSum[dFinalStatePIDs[loc_i]] = locLogLikelihood[loc_i];
+	}
+	else for (unsigned int loc_i = 0; loc_i < locDIRCHits.size(); loc_i++){
 
 		const DDIRCPmtHit* locDIRCHit = locDIRCHits[loc_i];
 		bool locIsGood = false;
@@ -238,19 +282,15 @@ bool DDIRCLut::CalcLUT(TVector3 locProjPos, TVector3 locProjMom, const vector<co
 	return true;
 }
 
-vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, TVector3 posInBar, TVector3 momInBar, map<Particle_t, double> locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum, int &nPhotonsThetaC, double &meanThetaC, double &meanDeltaT, bool &isGood) const
+vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, const TVector3 &posInBar, const TVector3 &momInBar, const map<Particle_t, double> &locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum, int &nPhotonsThetaC, double &meanThetaC, double &meanDeltaT, bool &isGood) const
 {	
 	// initialize photon pairs for time and thetaC
 	pair<double, double> locDIRCPhoton(-999., -999.);
 	vector<pair<double, double>> locDIRCPhotons;
 
-	TVector3 fnX1 = TVector3 (1,0,0);
-	TVector3 fnY1 = TVector3 (0,1,0);
-	TVector3 fnZ1 = TVector3 (0,0,1);
-
 	double tangle,luttheta,evtime;
 	int64_t pathid; 
-	TVector3 dir,dird;
+	double locCenterAngle = 0.5*(locExpectedAngle.at(PiPlus)+locExpectedAngle.at(KPlus));
 	
 	// get bar number from geometry
 	int bar = dDIRCGeometry->GetBar(posInBar.Y()); 
@@ -299,15 +339,32 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 	// check for pixel before going through loop
 	int box_channel = channel%dMaxChannels;
 	int box_pmt = box_channel/DDIRCGeometry::kPixels;
-	if(dDIRCLutReader->GetLutPixelAngleSize(bar, box_channel) == 0) 
+	const DDIRCLutFlat *locLut = dDIRCLutReader->GetFlatLut();
+	uint locNodes = locLut->GetSize(bar, box_channel);
+	if(locNodes == 0) 
 		return locDIRCPhotons;
+	const float *locLutX = locLut->GetAngleX(bar, box_channel);
+	const float *locLutY = locLut->GetAngleY(bar, box_channel);
+	const float *locLutZ = locLut->GetAngleZ(bar, box_channel);
+	const float *locLutTime = locLut->GetTime(bar, box_channel);
+	const int64_t *locLutPath = locLut->GetPath(bar, box_channel);
+
+	// track direction in the bar frame is the same for every node
+	TVector3 trackMom = momInBar;
+	if(DIRC_ROTATE_TRACK) { // rotate tracks to bar plane from survey data
+	  trackMom.RotateX(rotX);
+	  trackMom.RotateY(rotY);
+	  trackMom.RotateZ(rotZ);
+	}
+	double trackMomX = trackMom.X(), trackMomY = trackMom.Y(), trackMomZ = trackMom.Z();
+	double trackMom2 = trackMomX*trackMomX + trackMomY*trackMomY + trackMomZ*trackMomZ;
 	
 	// loop over LUT table for this bar/pixel to calculate thetaC	     
-	for(uint i = 0; i < dDIRCLutReader->GetLutPixelAngleSize(bar, box_channel); i++){
+	for(uint i = 0; i < locNodes; i++){
 		
-		dird   = dDIRCLutReader->GetLutPixelAngle(bar, box_channel, i); 
-		evtime = dDIRCLutReader->GetLutPixelTime(bar, box_channel, i); 
-		pathid = dDIRCLutReader->GetLutPixelPath(bar, box_channel, i); 
+		double dirdX = locLutX[i], dirdY = locLutY[i], dirdZ = locLutZ[i];
+		evtime = locLutTime[i]; 
+		pathid = locLutPath[i]; 
 		
 		// in MC we can check if the path of the LUT and measured photon are the same
 		bool samepath(false);
@@ -321,26 +378,20 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 			else lenz = dlenz;
 			
 			for(int u = 0; u < 4; u++){
-				if(u == 0) dir = dird;
-				if(u == 1) dir.SetXYZ( dird.X(),-dird.Y(),  dird.Z());
-				if(u == 2) dir.SetXYZ( dird.X(), dird.Y(), -dird.Z());
-				if(u == 3) dir.SetXYZ( dird.X(),-dird.Y(), -dird.Z());
-				if(r) dir.SetXYZ( -dir.X(), dir.Y(), dir.Z());
-				if(dir.Angle(fnY1) < dCriticalAngle || dir.Angle(fnZ1) < dCriticalAngle) continue;
+				double dirX = dirdX;
+				double dirY = (u == 1 || u == 3) ? -dirdY : dirdY;
+				double dirZ = (u == 2 || u == 3) ? -dirdZ : dirdZ;
+				if(r) dirX = -dirX;
+				double dir2 = dirX*dirX + dirY*dirY + dirZ*dirZ;
+				if(VectorAngle(dirY, dir2, 1.0) < dCriticalAngle || VectorAngle(dirZ, dir2, 1.0) < dCriticalAngle) continue;
 				
-				TVector3 trackMom = momInBar;
-				if(DIRC_ROTATE_TRACK) { // rotate tracks to bar plane from survey data
-				  trackMom.RotateX(rotX);
-				  trackMom.RotateY(rotY);
-				  trackMom.RotateZ(rotZ);
-				}
-				tangle = trackMom.Angle(dir);
+				tangle = VectorAngle(trackMomX*dirX + trackMomY*dirY + trackMomZ*dirZ, trackMom2, dir2);
  
 				if(DIRC_THETAC_OFFSET) { // ad-hoc correction per-PMT
 				  tangle -= dThetaCOffset[bar][box_pmt];
 				}
 
-				luttheta = dir.Angle(TVector3(-1,0,0));
+				luttheta = VectorAngle(-dirX, dir2, 1.0);
 				if(luttheta > TMath::PiOver2()) luttheta = TMath::Pi()-luttheta;
 				double bartime = lenz/cos(luttheta)/DIRC_LIGHT_V;
 				double totalTime = bartime+evtime;
@@ -353,7 +404,7 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 					hTime->Fill(hitTime);
 					hCalc->Fill(totalTime);
 					
-					if(fabs(tangle-0.5*(locExpectedAngle[PiPlus]+locExpectedAngle[KPlus]))<0.2){
+					if(fabs(tangle-locCenterAngle)<0.2){
 						hDiff->Fill(locDeltaT);
 						hDiff_Pixel[box]->Fill(channel%dMaxChannels, locDeltaT);
 						if(samepath){
@@ -366,7 +417,7 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 				}
 				
 				// save hits array which pass some lose time and angle criteria
-				if(fabs(locDeltaT) < 100.0 && fabs(tangle-0.5*(locExpectedAngle[PiPlus]+locExpectedAngle[KPlus]))<0.2) {
+				if(fabs(locDeltaT) < 100.0 && fabs(tangle-locCenterAngle)<0.2) {
 					locDIRCPhoton.first = totalTime;
 					locDIRCPhoton.second = tangle;
 					locDIRCPhotons.push_back(locDIRCPhoton);
@@ -384,7 +435,7 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 				}
 				
 				// remove photon candidates not used in likelihood
-				if(fabs(tangle-0.5*(locExpectedAngle[PiPlus]+locExpectedAngle[KPlus]))>0.03) continue;
+				if(fabs(tangle-locCenterAngle)>0.03) continue;
 				
 				isReflected = r;
 
@@ -401,7 +452,7 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 				
 				// calculate likelihood for each mass hypothesis
 				for(uint loc_j = 0; loc_j<dFinalStatePIDs.size(); loc_j++) {
-					logLikelihoodSum[dFinalStatePIDs[loc_j]] += TMath::Log( CalcLikelihood(locExpectedAngle[dFinalStatePIDs[loc_j]], tangle));
+					logLikelihoodSum[dFinalStatePIDs[loc_j]] += TMath::Log( CalcLikelihood(locExpectedAngle.at(dFinalStatePIDs[loc_j]), tangle));
 				}
 				
 			}
@@ -412,7 +463,7 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 }
 
 // overloaded function when calculating outside LUT factory
-vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, TVector3 posInBar, TVector3 momInBar, map<Particle_t, double> locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum) const
+vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, const TVector3 &posInBar, const TVector3 &momInBar, const map<Particle_t, double> &locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum) const
 {
 	int nPhotonsThetaC=0;
 	double meanThetaC=0.0, meanDeltaT=0.0;
@@ -420,6 +471,231 @@ vector<pair<double,double>> DDIRCLut::CalcPhoton(const DDIRCPmtHit *locDIRCHit,
 	return CalcPhoton(locDIRCHit, locFlightTime, posInBar, momInBar, locExpectedAngle, locAngle, locPID, isReflected, logLikelihoodSum, nPhotonsThetaC, meanThetaC, meanDeltaT, isGood);
 }
 
+//---------------------------------
+// CalcPhotonsBatch
+//---------------------------------
+// Batched equivalent of calling CalcPhoton for every hit of a track, used
+// by CalcLUT. For each hit the packed LUT nodes of its pixel are first run
+// through a vectorized prefilter (SelectLutNodes) that keeps only the
+// (node, reflection, orientation) combinations that can pass the critical
+// angle and thetaC window cuts. The survivors are then evaluated exactly as
+// in CalcPhoton and in the same order, so the sums are unchanged.
+void DDIRCLut::CalcPhotonsBatch(const vector<const DDIRCPmtHit*>& locDIRCHits, double locFlightTime, const TVector3 &posInBar, const TVector3 &momInBar, const double *locExpectedAngle, double locCenterAngle, double *logLikelihoodSum, int &nPhotonsThetaC, double &meanThetaC, double &meanDeltaT, vector<const DDIRCPmtHit*>& locGoodHits) const
+{
+	// get bar number from geometry
+	int bar = dDIRCGeometry->GetBar(posInBar.Y()); 
+	if(bar < 0 || bar > 47) return;
+	
+	// get box from bar number (North/Upper = 0 and South/Lower = 1)
+	int box = (bar < 24) ? 1 : 0;
+
+	double rotX = 0, rotY = 0, rotZ=0;
+	int xbin = (int)(posInBar.X()/5.0) + 19;
+	if(xbin>=0 && xbin<=39) {
+	  rotX = dRotationX[bar];
+	  rotY = dRotationY[bar];
+	  rotZ = dRotationZ[bar];
+	}
+
+	TVector3 trackMom = momInBar;
+	if(DIRC_ROTATE_TRACK) { // rotate tracks to bar plane from survey data
+	  trackMom.RotateX(rotX);
+	  trackMom.RotateY(rotY);
+	  trackMom.RotateZ(rotZ);
+	}
+	double locTrackMom[3] = {trackMom.X(), trackMom.Y(), trackMom.Z()};
+	double trackMom2 = locTrackMom[0]*locTrackMom[0] + locTrackMom[1]*locTrackMom[1] + locTrackMom[2]*locTrackMom[2];
+
+	// get length for reflected and direct photons
+	double radiatorL = dDIRCGeometry->GetBarLength(bar);
+	double barend = dDIRCGeometry->GetBarEnd(bar);
+	double dlenz = fabs(barend - posInBar.X()); // direct
+	double rlenz = 2*radiatorL - dlenz; // reflected
+
+	// Prefilter limits. The cuts are on acos() of the cosines computed in
+	// SelectLutNodes, so the limits are widened by a small margin to be
+	// safely conservative.
+	const double kMargin = 1.0e-9;
+	const double locCosCritical = cos(dCriticalAngle) + kMargin;
+
+	const DDIRCLutFlat *locLut = dDIRCLutReader->GetFlatLut();
+	int locMaskPixel = -1;
+
+	for(uint loc_h = 0; loc_h < locDIRCHits.size(); loc_h++) {
+		const DDIRCPmtHit *locDIRCHit = locDIRCHits[loc_h];
+
+		int channel = locDIRCHit->ch;
+		if((box == 0 && channel < dMaxChannels) || (box == 1 && channel >= dMaxChannels)) 
+			continue;
+
+		int box_channel = channel%dMaxChannels;
+		int box_pmt = box_channel/DDIRCGeometry::kPixels;
+		uint locNodes = locLut->GetSize(bar, box_channel);
+		if(locNodes == 0) continue;
+
+		// use hit time to determine if reflected or not
+		double hitTime = locDIRCHit->t - locFlightTime;
+		if(DIRC_TRUTH_PIXELTIME) {
+			vector<const DDIRCTruthPmtHit*> locTruthDIRCHits;
+			locDIRCHit->Get(locTruthDIRCHits);
+			if(locTruthDIRCHits.size() > 0) hitTime = locTruthDIRCHits[0]->t - locFlightTime;
+		}
+		bool reflected = hitTime>35;
+
+		const float *locLutX = locLut->GetAngleX(bar, box_channel);
+		const float *locLutY = locLut->GetAngleY(bar, box_channel);
+		const float *locLutZ = locLut->GetAngleZ(bar, box_channel);
+		const float *locLutTime = locLut->GetTime(bar, box_channel);
+		double locOffset = DIRC_THETAC_OFFSET ? dThetaCOffset[bar][box_pmt] : 0.0;
+
+		// masks only depend on the pixel, so reuse them for repeated hits
+		if(box_channel != locMaskPixel) {
+			if(trackMom2 > 0) {
+				double locAngleMin = locCenterAngle + locOffset - 0.03;
+				double locAngleMax = locCenterAngle + locOffset + 0.03;
+				double locArgMin = (locAngleMax >= TMath::Pi()) ? -2.0 : cos(locAngleMax) - kMargin;
+				double locArgMax = (locAngleMin <= 0.0) ? 2.0 : cos(locAngleMin) + kMargin;
+				SelectLutNodes(locLutX, locLutY, locLutZ, locNodes, locTrackMom, locCosCritical, locArgMin, locArgMax);
+			}
+			else
+				dNodeMask.assign(locNodes, 0xFF); // degenerate track, let the exact loop decide
+			locMaskPixel = box_channel;
+		}
+
+		bool isGood = false;
+		uint8_t locVariants = reflected ? 0xFF : 0x0F;
+		for(uint i = 0; i < locNodes; i++){
+			uint8_t locMask = dNodeMask[i] & locVariants;
+			if(!locMask) continue;
+
+			double dirdX = locLutX[i], dirdY = locLutY[i], dirdZ = locLutZ[i];
+			double evtime = locLutTime[i];
+
+			for(int r=0; r<2; r++){
+				double lenz = r ? rlenz : dlenz;
+				
+				for(int u = 0; u < 4; u++){
+					if(!(locMask & (1 << (4*r + u)))) continue;
+
+					double dirX = r ? -dirdX : dirdX;
+					double dirY = (u == 1 || u == 3) ? -dirdY : dirdY;
+					double dirZ = (u == 2 || u == 3) ? -dirdZ : dirdZ;
+					double dir2 = dirX*dirX + dirY*dirY + dirZ*dirZ;
+					if(VectorAngle(dirY, dir2, 1.0) < dCriticalAngle || VectorAngle(dirZ, dir2, 1.0) < dCriticalAngle) continue;
+
+					double tangle = VectorAngle(locTrackMom[0]*dirX + locTrackMom[1]*dirY + locTrackMom[2]*dirZ, trackMom2, dir2);
+					tangle -= locOffset;
+
+					double luttheta = VectorAngle(-dirX, dir2, 1.0);
+					if(luttheta > TMath::PiOver2()) luttheta = TMath::Pi()-luttheta;
+					double bartime = lenz/cos(luttheta)/DIRC_LIGHT_V;
+					double totalTime = bartime+evtime;
+					double locDeltaT = totalTime-hitTime;
+
+					// reject photons that are too far out of time
+					if(!r && fabs(locDeltaT)>DIRC_CUT_TDIFFD) continue;
+					if( r && fabs(locDeltaT)>DIRC_CUT_TDIFFR) continue;
+					
+					// remove photon candidates not used in likelihood
+					if(fabs(tangle-locCenterAngle)>0.03) continue;
+
+					isGood = true;
+					nPhotonsThetaC++;
+					meanThetaC += tangle;
+					meanDeltaT += locDeltaT;
+
+					for(uint loc_j = 0; loc_j<dFinalStatePIDs.size(); loc_j++)
+						logLikelihoodSum[loc_j] += TMath::Log( CalcLikelihood(locExpectedAngle[loc_j], tangle));
+				}
+			}
+		} // end loop over nodes
+
+		if(isGood) locGoodHits.push_back(locDIRCHit);
+	} // end loop over hits
+}
+
+//---------------------------------
+// SelectLutNodes
+//---------------------------------
+// Fill dNodeMask with one bit per (reflection r, orientation u) combination
+// of each LUT node whose direction can pass the critical angle cut (cosine
+// with the bar Y and Z axes below locCosCritical) and whose cosine with the
+// track lies in [locArgMin, locArgMax]. Flipping the sign of a component
+// only flips the sign of its term, so all 8 combinations share the same
+// normalization.
+void DDIRCLut::SelectLutNodes(const float *locLutX, const float *locLutY, const float *locLutZ, uint locNodes, const double *locTrackMom, double locCosCritical, double locArgMin, double locArgMax) const
+{
+	if(dNodeMask.size() < locNodes) dNodeMask.resize(locNodes);
+	uint8_t *locMask = dNodeMask.data();
+
+	double tx = locTrackMom[0], ty = locTrackMom[1], tz = locTrackMom[2];
+	double trackMom2 = tx*tx + ty*ty + tz*tz;
+
+	uint i = 0;
+#ifdef USE_SSE2
+	__m128d vTx = _mm_set1_pd(tx), vTy = _mm_set1_pd(ty), vTz = _mm_set1_pd(tz);
+	__m128d vTm2 = _mm_set1_pd(trackMom2);
+	__m128d vCrit = _mm_set1_pd(locCosCritical);
+	__m128d vMin = _mm_set1_pd(locArgMin), vMax = _mm_set1_pd(locArgMax);
+	__m128d vZero = _mm_setzero_pd();
+	for(; i+2 <= locNodes; i += 2){
+		__m128d dx = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(locLutX + i))));
+		__m128d dy = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(locLutY + i))));
+		__m128d dz = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(locLutZ + i))));
+		__m128d dir2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+		__m128d norm = _mm_sqrt_pd(dir2);
+		__m128d cy = _mm_div_pd(dy, norm);
+		__m128d cz = _mm_div_pd(dz, norm);
+		__m128d tnorm = _mm_sqrt_pd(_mm_mul_pd(vTm2, dir2));
+		__m128d px = _mm_div_pd(_mm_mul_pd(vTx, dx), tnorm);
+		__m128d py = _mm_div_pd(_mm_mul_pd(vTy, dy), tnorm);
+		__m128d pz = _mm_div_pd(_mm_mul_pd(vTz, dz), tnorm);
+
+		// critical angle for +/-Y and +/-Z
+		int okYp = _mm_movemask_pd(_mm_cmple_pd(cy, vCrit));
+		int okYm = _mm_movemask_pd(_mm_cmple_pd(_mm_sub_pd(vZero, cy), vCrit));
+		int okZp = _mm_movemask_pd(_mm_cmple_pd(cz, vCrit));
+		int okZm = _mm_movemask_pd(_mm_cmple_pd(_mm_sub_pd(vZero, cz), vCrit));
+
+		int bits0 = 0, bits1 = 0;
+		for(int r=0; r<2; r++){
+			__m128d sx = r ? _mm_sub_pd(vZero, px) : px;
+			for(int u=0; u<4; u++){
+				bool flipY = (u == 1 || u == 3), flipZ = (u == 2 || u == 3);
+				__m128d a = _mm_add_pd(sx, flipY ? _mm_sub_pd(vZero, py) : py);
+				a = flipZ ? _mm_sub_pd(a, pz) : _mm_add_pd(a, pz);
+				int ok = _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(a, vMin), _mm_cmple_pd(a, vMax)));
+				ok &= (flipY ? okYm : okYp) & (flipZ ? okZm : okZp);
+				bits0 |= (ok & 1) << (4*r + u);
+				bits1 |= ((ok >> 1) & 1) << (4*r + u);
+			}
+		}
+		locMask[i] = bits0;
+		locMask[i+1] = bits1;
+	}
+#endif
+	for(; i < locNodes; i++){
+		double dx = locLutX[i], dy = locLutY[i], dz = locLutZ[i];
+		double dir2 = dx*dx + dy*dy + dz*dz;
+		double norm = sqrt(dir2);
+		double cy = dy/norm, cz = dz/norm;
+		double tnorm = sqrt(trackMom2*dir2);
+		double px = tx*dx/tnorm, py = ty*dy/tnorm, pz = tz*dz/tnorm;
+
+		int bits = 0;
+		for(int r=0; r<2; r++){
+			for(int u=0; u<4; u++){
+				bool flipY = (u == 1 || u == 3), flipZ = (u == 2 || u == 3);
+				if(!((flipY ? -cy : cy) <= locCosCritical)) continue;
+				if(!((flipZ ? -cz : cz) <= locCosCritical)) continue;
+				double a = (r ? -px : px) + (flipY ? -py : py) + (flipZ ? -pz : pz);
+				if(a >= locArgMin && a <= locArgMax) bits |= 1 << (4*r + u);
+			}
+		}
+		locMask[i] = bits;
+	}
+}
+
 double DDIRCLut::CalcLikelihood(double locExpectedThetaC, double locThetaC) const {
 	
 	double locLikelihood = TMath::Exp(-0.5*( (locExpectedThetaC-locThetaC)/DIRC_SIGMA_THETAC * (locExpectedThetaC-locThetaC)/DIRC_SIGMA_THETAC ) ) + 0.00001;
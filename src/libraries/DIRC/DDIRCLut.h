@@ -36,14 +36,19 @@ public:
 
 	bool brun(JEventLoop *loop);
 	bool CreateDebugHistograms();
-	bool CalcLUT(TVector3 locProjPos, TVector3 locProjMom, const vector<const DDIRCPmtHit*> locDIRCHits, double locFlightTime, double locMass, shared_ptr<DDIRCMatchParams>& locDIRCMatchParams, const vector<const DDIRCTruthBarHit*> locDIRCBarHits, map<shared_ptr<const DDIRCMatchParams>, vector<const DDIRCPmtHit*> >& locDIRCTrackMatchParams) const;
-	vector<pair<double,double>> CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, TVector3 posInBar, TVector3 momInBar, map<Particle_t, double> locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum, int &nPhotonsThetaC, double &meanThetaC, double &meanDeltaT, bool &isGood) const;
-	vector<pair<double,double>> CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, TVector3 posInBar, TVector3 momInBar, map<Particle_t, double> locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum) const;
+	bool CalcLUT(TVector3 locProjPos, TVector3 locProjMom, const vector<const DDIRCPmtHit*>& locDIRCHits, double locFlightTime, double locMass, shared_ptr<DDIRCMatchParams>& locDIRCMatchParams, const vector<const DDIRCTruthBarHit*>& locDIRCBarHits, map<shared_ptr<const DDIRCMatchParams>, vector<const DDIRCPmtHit*> >& locDIRCTrackMatchParams) const;
+	vector<pair<double,double>> CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, const TVector3 &posInBar, const TVector3 &momInBar, const map<Particle_t, double> &locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum, int &nPhotonsThetaC, double &meanThetaC, double &meanDeltaT, bool &isGood) const;
+	vector<pair<double,double>> CalcPhoton(const DDIRCPmtHit *locDIRCHit, double locFlightTime, const TVector3 &posInBar, const TVector3 &momInBar, const map<Particle_t, double> &locExpectedAngle, double locAngle, Particle_t locPID, bool &isReflected, map<Particle_t, double> &logLikelihoodSum) const;
 	double CalcLikelihood(double locExpectedThetaC, double locThetaC) const;
 	double CalcAngle(double locP, double locMass) const;
 	map<Particle_t, double> CalcExpectedAngles(double locP) const;
 	
 private:
+	enum { kHypotheses = 4 }; // size of dFinalStatePIDs
+
+	void CalcPhotonsBatch(const vector<const DDIRCPmtHit*>& locDIRCHits, double locFlightTime, const TVector3 &posInBar, const TVector3 &momInBar, const double *locExpectedAngle, double locCenterAngle, double *logLikelihoodSum, int &nPhotonsThetaC, double &meanThetaC, double &meanDeltaT, vector<const DDIRCPmtHit*>& locGoodHits) const;
+	void SelectLutNodes(const float *locLutX, const float *locLutY, const float *locLutZ, uint locNodes, const double *locTrackMom, double locCosCritical, double locArgMin, double locArgMax) const;
+
 	DApplication *dapp;
 	DDIRCLutReader *dDIRCLutReader;
 	const DDIRCGeometry *dDIRCGeometry;
@@ -53,6 +58,7 @@ private:
 	bool DIRC_TRUTH_PIXELTIME;
 	bool DIRC_ROTATE_TRACK;
 	bool DIRC_THETAC_OFFSET;
+	bool DIRC_BATCH_LIKELIHOOD;
 
 	double DIRC_CUT_TDIFFD;
 	double DIRC_CUT_TDIFFR;
@@ -71,6 +77,10 @@ private:
 	map<Particle_t, TH1I*> hDeltaThetaC;
 	map<Particle_t, TH2I*> hDeltaThetaC_Pixel;
 
+	// per-node bitmask of (reflection,orientation) combinations passing
+	// the angle prefilter in CalcPhotonsBatch (bit = 4*r + u)
+	mutable vector<uint8_t> dNodeMask;
+
 };
 
 #endif // _DDIRCLut_
@@ -0,0 +1,331 @@
+// $Id$
+//
+//    File: DDIRCLutFlat.cc
+//
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdio.h>
+
+#include "DDIRCLutFlat.h"
+#include <JANA/JApplication.h>
+using namespace jana;
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+
+static const char kLutFlatMagic[8] = {'G','X','D','I','R','C','L','T'};
+
+//---------------------------------
+// DDIRCLutFlat    (Constructor)
+//---------------------------------
+DDIRCLutFlat::DDIRCLutFlat()
+{
+	dMapAddr = NULL;
+	dMapSize = 0;
+	Clear();
+}
+
+//---------------------------------
+// ~DDIRCLutFlat    (Destructor)
+//---------------------------------
+DDIRCLutFlat::~DDIRCLutFlat()
+{
+	Clear();
+}
+
+//---------------------------------
+// Clear
+//---------------------------------
+void DDIRCLutFlat::Clear(void)
+{
+	if(dMapAddr) munmap(dMapAddr, dMapSize);
+	dMapAddr = NULL;
+	dMapSize = 0;
+	dBuffer.clear();
+
+	dOffsets = NULL;
+	dAngleX = dAngleY = dAngleZ = dTime = NULL;
+	dPath = NULL;
+	dNentries = 0;
+}
+
+//---------------------------------
+// SetPointers
+//---------------------------------
+void DDIRCLutFlat::SetPointers(const char *base, uint64_t nentries)
+{
+	/// Point the section pointers into an image laid out as described
+	/// in DDIRCLutFlat.h, starting with the header at "base".
+	size_t pos = Align(sizeof(header_t));
+	dOffsets = (const uint64_t*)(base + pos);
+	pos += Align((kNodes+1)*sizeof(uint64_t));
+	dAngleX = (const float*)(base + pos);
+	pos += Align(nentries*sizeof(float));
+	dAngleY = (const float*)(base + pos);
+	pos += Align(nentries*sizeof(float));
+	dAngleZ = (const float*)(base + pos);
+	pos += Align(nentries*sizeof(float));
+	dTime = (const float*)(base + pos);
+	pos += Align(nentries*sizeof(float));
+	dPath = (const int64_t*)(base + pos);
+	dNentries = nentries;
+}
+
+//---------------------------------
+// Checksum
+//---------------------------------
+bool DDIRCLutFlat::Checksum(string filename, uint64_t &checksum)
+{
+	/// 64 bit FNV-1a hash of the contents of the given file. This
+	/// identifies the ROOT LUT a binary file was made from.
+	FILE *f = fopen(filename.c_str(), "rb");
+	if(!f){
+		jerr << "Unable to open " << filename << " to checksum it!" << endl;
+		return false;
+	}
+	uint64_t hash = 14695981039346656037ULL;
+	vector<unsigned char> buff(1<<20);
+	size_t n;
+	while( (n = fread(buff.data(), 1, buff.size(), f)) > 0 ){
+		for(size_t i=0; i<n; i++){
+			hash ^= buff[i];
+			hash *= 1099511628211ULL;
+		}
+	}
+	bool ok = !ferror(f);
+	fclose(f);
+	if(!ok){
+		jerr << "Error reading " << filename << " to checksum it!" << endl;
+		return false;
+	}
+	checksum = hash;
+	return true;
+}
+
+//---------------------------------
+// ReadROOT
+//---------------------------------
+bool DDIRCLutFlat::ReadROOT(string filename, string source_name, uint64_t source_checksum)
+{
+	/// Fill the table from the "lut_dirc_flat" TTree. Entry i of the tree
+	/// holds pixel i for every bar; the nodes are repacked bar-major so
+	/// that each bar/pixel is one contiguous slice. The source name and
+	/// checksum are stored in the header for Write().
+	Clear();
+
+	const int luts = DDIRCGeometry::kBars;
+
+	auto saveDir = gDirectory;
+	TFile *fLut = new TFile(filename.c_str());
+	if( !fLut->IsOpen() ){
+		jerr << "Unable to open " << filename << "!!" << endl;
+		delete fLut;
+		saveDir->cd();
+		return false;
+	}
+	TTree *tLut=(TTree*) fLut->Get("lut_dirc_flat");
+	if( tLut == NULL ){
+		jerr << "Unable find TTree lut_dirc_flat in " << filename << "!!" << endl;
+		fLut->Close();
+		delete fLut;
+		saveDir->cd();
+		return false;
+	}
+
+	vector<Float_t> *LutPixelAngleX[luts];
+	vector<Float_t> *LutPixelAngleY[luts];
+	vector<Float_t> *LutPixelAngleZ[luts];
+	vector<Float_t> *LutPixelTime[luts];
+	vector<Long64_t> *LutPixelPath[luts];
+
+	for(int l=0; l<luts; l++){
+		LutPixelAngleX[l] = 0;
+		LutPixelAngleY[l] = 0;
+		LutPixelAngleZ[l] = 0;
+		LutPixelTime[l] = 0;
+		LutPixelPath[l] = 0;
+		tLut->SetBranchAddress(Form("LUT_AngleX_%d",l),&LutPixelAngleX[l]);
+		tLut->SetBranchAddress(Form("LUT_AngleY_%d",l),&LutPixelAngleY[l]);
+		tLut->SetBranchAddress(Form("LUT_AngleZ_%d",l),&LutPixelAngleZ[l]);
+		tLut->SetBranchAddress(Form("LUT_Time_%d",l),&LutPixelTime[l]);
+		tLut->SetBranchAddress(Form("LUT_Path_%d",l),&LutPixelPath[l]);
+	}
+
+	// The tree is pixel-major, so stage each bar separately and
+	// concatenate the bars afterwards
+	vector<uint64_t> counts(kNodes, 0);
+	vector<float> ax[luts], ay[luts], az[luts], t[luts];
+	vector<int64_t> p[luts];
+	Long64_t nPixels = tLut->GetEntries();
+	if(nPixels > kNodesPerBar) nPixels = kNodesPerBar;
+	for(Long64_t i=0; i<nPixels; i++) {
+		tLut->GetEntry(i);
+		for(int l=0; l<luts; l++){
+			uint32_t n = LutPixelAngleX[l]->size();
+			counts[l*kNodesPerBar + i] = n;
+			for(uint32_t j=0; j<n; j++){
+				ax[l].push_back(LutPixelAngleX[l]->at(j));
+				ay[l].push_back(LutPixelAngleY[l]->at(j));
+				az[l].push_back(LutPixelAngleZ[l]->at(j));
+				t[l].push_back(LutPixelTime[l]->at(j));
+				p[l].push_back(LutPixelPath[l]->at(j));
+			}
+		}
+	}
+
+	fLut->Close();
+	delete fLut;
+	saveDir->cd();
+
+	uint64_t nentries = 0;
+	for(int l=0; l<luts; l++) nentries += ax[l].size();
+
+	// Build the full image (header included) so Write() is a single dump
+	size_t nbytes = Align(sizeof(header_t)) + Align((kNodes+1)*sizeof(uint64_t))
+	              + 4*Align(nentries*sizeof(float)) + Align(nentries*sizeof(int64_t));
+	dBuffer.assign(nbytes/sizeof(uint64_t), 0);
+	char *base = (char*)dBuffer.data();
+
+	header_t *hdr = (header_t*)base;
+	memcpy(hdr->magic, kLutFlatMagic, sizeof(hdr->magic));
+	hdr->version  = kVersion;
+	hdr->nBars    = DDIRCGeometry::kBars;
+	hdr->nPixels  = kNodesPerBar;
+	hdr->nEntries = nentries;
+	hdr->sourceChecksum = source_checksum;
+	strncpy(hdr->sourceName, source_name.c_str(), sizeof(hdr->sourceName)-1);
+
+	SetPointers(base, nentries);
+	uint64_t *offsets = (uint64_t*)dOffsets;
+	offsets[0] = 0;
+	for(int node=0; node<kNodes; node++) offsets[node+1] = offsets[node] + counts[node];
+
+	for(int l=0; l<luts; l++){
+		if(ax[l].empty()) continue;
+		uint64_t start = offsets[l*kNodesPerBar];
+		size_t n = ax[l].size();
+		memcpy((float*)dAngleX + start, ax[l].data(), n*sizeof(float));
+		memcpy((float*)dAngleY + start, ay[l].data(), n*sizeof(float));
+		memcpy((float*)dAngleZ + start, az[l].data(), n*sizeof(float));
+		memcpy((float*)dTime   + start, t[l].data(),  n*sizeof(float));
+		memcpy((int64_t*)dPath + start, p[l].data(),  n*sizeof(int64_t));
+	}
+
+	return true;
+}
+
+//---------------------------------
+// Write
+//---------------------------------
+bool DDIRCLutFlat::Write(string filename) const
+{
+	/// Write the table in the binary format read by Map(). Only a table
+	/// filled by ReadROOT() can be written.
+	if(dBuffer.empty()){
+		jerr << "No DIRC LUT loaded from ROOT; nothing to write to " << filename << endl;
+		return false;
+	}
+
+	// Write to a unique temporary file in the same directory and rename
+	// it, so concurrent readers never see a partially written file and
+	// concurrent writers don't write into the same temporary file
+	string tmpname = filename + ".XXXXXX";
+	int fd = mkstemp(&tmpname[0]);
+	if(fd < 0){
+		jerr << "Unable to create a temporary file for " << filename << "!" << endl;
+		return false;
+	}
+	fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	FILE *f = fdopen(fd, "wb");
+	if(!f){
+		jerr << "Unable to open " << tmpname << " for writing!" << endl;
+		close(fd);
+		unlink(tmpname.c_str());
+		return false;
+	}
+	size_t nbytes = dBuffer.size()*sizeof(uint64_t);
+	size_t nwritten = fwrite(dBuffer.data(), 1, nbytes, f);
+	if(fclose(f)!=0 || nwritten!=nbytes){
+		jerr << "Error writing DIRC LUT to " << tmpname << endl;
+		unlink(tmpname.c_str());
+		return false;
+	}
+	if(rename(tmpname.c_str(), filename.c_str()) != 0){
+		jerr << "Unable to rename " << tmpname << " to " << filename << endl;
+		unlink(tmpname.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// Map
+//---------------------------------
+bool DDIRCLutFlat::Map(string filename, string source_name, uint64_t source_checksum)
+{
+	/// Map a binary LUT file read-only. Returns false (leaving the table
+	/// empty) if the file is missing, does not match this geometry, or
+	/// was not made from the given ROOT LUT.
+	Clear();
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd < 0) return false;
+
+	struct stat st;
+	if(fstat(fd, &st)!=0 || (size_t)st.st_size < sizeof(header_t)){
+		close(fd);
+		jerr << "DIRC LUT file " << filename << " is truncated" << endl;
+		return false;
+	}
+
+	void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // mapping stays valid after close
+	if(addr == MAP_FAILED){
+		jerr << "Unable to mmap DIRC LUT file " << filename << endl;
+		return false;
+	}
+
+	const header_t *hdr = (const header_t*)addr;
+	bool ok = memcmp(hdr->magic, kLutFlatMagic, sizeof(hdr->magic))==0
+	       && hdr->version == kVersion
+	       && hdr->nBars   == (uint32_t)DDIRCGeometry::kBars
+	       && hdr->nPixels == (uint32_t)kNodesPerBar;
+	if(ok){
+		uint64_t n = hdr->nEntries;
+		size_t nbytes = Align(sizeof(header_t)) + Align((kNodes+1)*sizeof(uint64_t))
+		              + 4*Align(n*sizeof(float)) + Align(n*sizeof(int64_t));
+		ok = (size_t)st.st_size >= nbytes;
+	}
+	if(!ok){
+		munmap(addr, st.st_size);
+		jerr << "DIRC LUT file " << filename << " has a bad header or size" << endl;
+		return false;
+	}
+
+	if(hdr->sourceChecksum != source_checksum
+	   || strncmp(hdr->sourceName, source_name.c_str(), sizeof(hdr->sourceName)) != 0){
+		munmap(addr, st.st_size);
+		jout << "DIRC LUT file " << filename << " was made from " << string(hdr->sourceName, strnlen(hdr->sourceName, sizeof(hdr->sourceName)))
+		     << ", not from " << source_name << ". Not using it." << endl;
+		return false;
+	}
+
+	dMapAddr = addr;
+	dMapSize = st.st_size;
+	SetPointers((const char*)addr, hdr->nEntries);
+
+	// Cheap sanity check on the offset table
+	if(dOffsets[kNodes] != dNentries){
+		jerr << "DIRC LUT file " << filename << " has an inconsistent offset table" << endl;
+		Clear();
+		return false;
+	}
+
+	return true;
+}
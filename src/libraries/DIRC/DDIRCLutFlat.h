@@ -0,0 +1,99 @@
+// $Id$
+//
+//    File: DDIRCLutFlat.h
+//
+
+#ifndef _DDIRCLutFlat_
+#define _DDIRCLutFlat_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <DIRC/DDIRCGeometry.h>
+
+/// Flat, float-packed storage for the DIRC lookup table.
+///
+/// All LUT nodes are kept in a handful of contiguous arrays (one per
+/// component) indexed through an offset table, so the entries for one
+/// bar/pixel are a single contiguous slice of each array. The table can be
+/// filled from the "lut_dirc_flat" ROOT tree or mapped read-only from a
+/// binary file written by Write(). A mapped file is shared through the page
+/// cache by every process on the node that maps it. The header records the
+/// name and checksum of the ROOT LUT the file was made from, so a binary
+/// file made from a different LUT is never mapped.
+///
+/// Binary layout (native byte order), each section aligned to 64 bytes:
+///   header_t
+///   uint64_t offsets[nBars*nPixels+1]
+///   float    angleX[nEntries], angleY[nEntries], angleZ[nEntries]
+///   float    time[nEntries]
+///   int64_t  path[nEntries]
+
+class DDIRCLutFlat{
+
+public:
+
+	enum { kNodesPerBar = DDIRCGeometry::kPMTs*DDIRCGeometry::kPixels };
+	enum { kNodes = DDIRCGeometry::kBars*kNodesPerBar };
+	enum { kAlign = 64 };
+
+	DDIRCLutFlat();
+	virtual ~DDIRCLutFlat();
+
+	bool ReadROOT(string filename, string source_name, uint64_t source_checksum);
+	bool Map(string filename, string source_name, uint64_t source_checksum);
+	bool Write(string filename) const;
+
+	static bool Checksum(string filename, uint64_t &checksum);
+
+	bool IsMapped(void) const {return dMapAddr != NULL;}
+	uint64_t GetNentries(void) const {return dNentries;}
+
+	// Entries for one bar/pixel: [0, GetSize(bar,pixel))
+	uint32_t GetSize(int bar, int pixel) const {
+		int node = bar*kNodesPerBar + pixel;
+		return dOffsets==NULL ? 0:(uint32_t)(dOffsets[node+1] - dOffsets[node]);
+	}
+	const float*   GetAngleX(int bar, int pixel) const {return dAngleX + dOffsets[bar*kNodesPerBar + pixel];}
+	const float*   GetAngleY(int bar, int pixel) const {return dAngleY + dOffsets[bar*kNodesPerBar + pixel];}
+	const float*   GetAngleZ(int bar, int pixel) const {return dAngleZ + dOffsets[bar*kNodesPerBar + pixel];}
+	const float*   GetTime(int bar, int pixel) const {return dTime + dOffsets[bar*kNodesPerBar + pixel];}
+	const int64_t* GetPath(int bar, int pixel) const {return dPath + dOffsets[bar*kNodesPerBar + pixel];}
+
+private:
+
+	typedef struct{
+		char magic[8];
+		uint32_t version;
+		uint32_t nBars;
+		uint32_t nPixels;
+		uint32_t reserved;
+		uint64_t nEntries;
+		uint64_t sourceChecksum; // of the ROOT LUT file
+		char sourceName[256];    // CCDB map_name (or file name) of the ROOT LUT
+	}header_t;
+
+	static const uint32_t kVersion = 2;
+
+	static size_t Align(size_t n){return (n + kAlign - 1)/kAlign*kAlign;}
+	void Clear(void);
+	void SetPointers(const char *base, uint64_t nentries);
+
+	// Section pointers into either dBuffer or the mapped file
+	const uint64_t *dOffsets;
+	const float *dAngleX;
+	const float *dAngleY;
+	const float *dAngleZ;
+	const float *dTime;
+	const int64_t *dPath;
+	uint64_t dNentries;
+
+	vector<uint64_t> dBuffer; // owned storage when filled from ROOT (uint64_t keeps it 8-byte aligned)
+	void *dMapAddr;
+	size_t dMapSize;
+};
+
+#endif // _DDIRCLutFlat_
+
@@ -19,77 +19,48 @@ DDIRCLutReader::DDIRCLutReader(JApplication *japp, unsigned int run_number)
 	/////////////////////////////////////////
 	// retrieve from LUT from file or CCDB //
 	/////////////////////////////////////////
-        const int luts = DDIRCGeometry::kBars;
+	jcalib = NULL;
+	jresman = NULL;
 
         string lut_file;
         gPARMS->SetDefaultParameter("DIRC_LUT", lut_file, "DIRC LUT root file (will eventually be moved to resource)");
+
+	// Binary (flat) copy of the LUT. If it was made from the same ROOT LUT
+	// it is memory-mapped and shared between processes; otherwise it is
+	// (re)written after the ROOT file is read so later jobs can map it.
+	string lut_flat_file;
+	gPARMS->SetDefaultParameter("DIRC:LUT_FLAT", lut_flat_file, "DIRC LUT binary file to memory-map (created from the ROOT LUT if it does not exist or was made from a different LUT)");
 	
 	// follow similar procedure as other resources (DMagneticFieldMapFineMesh)
 	map<string,string> lut_map_name;
+	string lut_source = lut_file;
 	jcalib = japp->GetJCalibration(run_number);
 	if(jcalib->GetCalib("/DIRC/LUT/lut_map", lut_map_name)) 
 		jout << "Can't find requested /DIRC/LUT/lut_map in CCDB for this run!" << endl;
 	else if(lut_map_name.find("map_name") != lut_map_name.end() && lut_map_name["map_name"] != "None" && lut_file.empty()) {
 		jresman = japp->GetJResourceManager(run_number);
-		lut_file = jresman->GetResource(lut_map_name["map_name"]);
+		lut_source = lut_map_name["map_name"];
+		lut_file = jresman->GetResource(lut_source);
 	}
 	
 	// only create reader if have tree from CCDB or command-line parameter is set
 	if(!lut_file.empty()) {
-		jout<<"Reading DIRC LUT TTree from "<<lut_file<<" ..."<<endl;
-		
-		auto saveDir = gDirectory;
-		TFile *fLut = new TFile(lut_file.c_str());
-		if( !fLut->IsOpen() ){
-			jerr << "Unable to open " << lut_file << "!!" << endl;
-			_exit(-1);
-		}
-		TTree *tLut=(TTree*) fLut->Get("lut_dirc_flat");
-		if( tLut == NULL ){
-			jerr << "Unable find TTree lut_dirc_flat in " << lut_file << "!!" << endl;
-			_exit(-1);
-		}
-		
-		vector<Float_t> *LutPixelAngleX[luts];
-		vector<Float_t> *LutPixelAngleY[luts];
-		vector<Float_t> *LutPixelAngleZ[luts];
-		vector<Float_t> *LutPixelTime[luts];
-		vector<Long64_t> *LutPixelPath[luts];
-		
-		// clear arrays to fill from TTree
-		for(int l=0; l<luts; l++){
-			LutPixelAngleX[l] = 0;
-			LutPixelAngleY[l] = 0;
-			LutPixelAngleZ[l] = 0;
-			LutPixelTime[l] = 0;
-			LutPixelPath[l] = 0;
-		}
-		
-		for(int l=0; l<luts; l++){
-			tLut->SetBranchAddress(Form("LUT_AngleX_%d",l),&LutPixelAngleX[l]); 
-			tLut->SetBranchAddress(Form("LUT_AngleY_%d",l),&LutPixelAngleY[l]); 
-			tLut->SetBranchAddress(Form("LUT_AngleZ_%d",l),&LutPixelAngleZ[l]); 
-			tLut->SetBranchAddress(Form("LUT_Time_%d",l),&LutPixelTime[l]); 
-			tLut->SetBranchAddress(Form("LUT_Path_%d",l),&LutPixelPath[l]); 
-		}
-		
-		// fill nodes with LUT info for each bar/pixel combination
-		for(int i=0; i<tLut->GetEntries(); i++) { // get pixels from TTree
-			tLut->GetEntry(i);
-			
-			for(int l=0; l<luts; l++){ // loop over bars
-				for(uint j=0; j<LutPixelAngleX[l]->size(); j++) { // loop over possible paths
-					TVector3 angle(LutPixelAngleX[l]->at(j), LutPixelAngleY[l]->at(j), LutPixelAngleZ[l]->at(j));
-					lutNodeAngle[l][i].push_back(angle);
-					lutNodeTime[l][i].push_back(LutPixelTime[l]->at(j));
-					lutNodePath[l][i].push_back(LutPixelPath[l]->at(j));
-				}
+		uint64_t lut_checksum = 0;
+		if(!lut_flat_file.empty()) {
+			if(!DDIRCLutFlat::Checksum(lut_file, lut_checksum)) _exit(-1);
+			if(dLut.Map(lut_flat_file, lut_source, lut_checksum)) {
+				jout<<"Mapped DIRC LUT from "<<lut_flat_file<<" ("<<dLut.GetNentries()<<" entries)"<<endl;
+				return;
 			}
 		}
-		
-		// close LUT file
-		fLut->Close();
-		saveDir->cd();
+
+		jout<<"Reading DIRC LUT TTree from "<<lut_file<<" ..."<<endl;
+		if(!dLut.ReadROOT(lut_file, lut_source, lut_checksum)) _exit(-1);
+
+		if(!lut_flat_file.empty()) {
+			if(dLut.Write(lut_flat_file))
+				jout<<"Wrote DIRC LUT binary file "<<lut_flat_file<<endl;
+		}
 	}
 }
 
@@ -99,31 +70,30 @@ DDIRCLutReader::~DDIRCLutReader() {
 
 uint DDIRCLutReader::GetLutPixelAngleSize(int bar, int pixel) const
 {
-	
-	return lutNodeAngle[bar][pixel].size();
+	return dLut.GetSize(bar, pixel);
 }
 	
 uint DDIRCLutReader::GetLutPixelTimeSize(int bar, int pixel) const
 {
-	return lutNodeTime[bar][pixel].size();
+	return dLut.GetSize(bar, pixel);
 }
 	
 uint DDIRCLutReader::GetLutPixelPathSize(int bar, int pixel) const
 {
-	return lutNodePath[bar][pixel].size();
+	return dLut.GetSize(bar, pixel);
 }
 
 TVector3 DDIRCLutReader::GetLutPixelAngle(int bar, int pixel, int entry) const
 {
-	return lutNodeAngle[bar][pixel].at(entry);
+	return TVector3(dLut.GetAngleX(bar, pixel)[entry], dLut.GetAngleY(bar, pixel)[entry], dLut.GetAngleZ(bar, pixel)[entry]);
 }
 
 Float_t DDIRCLutReader::GetLutPixelTime(int bar, int pixel, int entry) const
 {
-	return lutNodeTime[bar][pixel].at(entry);
+	return dLut.GetTime(bar, pixel)[entry];
 }
 
 Long64_t DDIRCLutReader::GetLutPixelPath(int bar, int pixel, int entry) const
 {
-	return lutNodePath[bar][pixel].at(entry);
+	return dLut.GetPath(bar, pixel)[entry];
 }
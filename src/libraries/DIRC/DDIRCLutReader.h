@@ -13,6 +13,7 @@
 #include <DANA/DApplication.h>
 
 #include <DIRC/DDIRCGeometry.h>
+#include <DIRC/DDIRCLutFlat.h>
 
 #include "TROOT.h"
 #include "TVector3.h"
@@ -33,13 +34,14 @@ public:
 	Float_t GetLutPixelTime(int bar, int pixel, int entry) const;
 	Long64_t GetLutPixelPath(int bar, int pixel, int entry) const;		
 
+	// Direct access to the packed table for tight loops
+	const DDIRCLutFlat* GetFlatLut(void) const {return &dLut;}
+
 private:
 
 	pthread_mutex_t mutex;
 
-	vector<TVector3> lutNodeAngle[DDIRCGeometry::kBars][DDIRCGeometry::kPMTs*DDIRCGeometry::kPixels];
-	vector<Float_t> lutNodeTime[DDIRCGeometry::kBars][DDIRCGeometry::kPMTs*DDIRCGeometry::kPixels];
-	vector<Long64_t> lutNodePath[DDIRCGeometry::kBars][DDIRCGeometry::kPMTs*DDIRCGeometry::kPixels];
+	DDIRCLutFlat dLut;
 
 protected:
 	JCalibration *jcalib;
@@ -5,6 +5,10 @@
 #include "DFCALCluster.h"
 #include "DFCALGeometry.h"
 
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifndef SQR
 # define SQR(x) (x)*(x)
 #endif
@@ -54,7 +58,7 @@ DFCALCluster::~DFCALCluster()
 }
 
 
-void DFCALCluster::saveHits( const userhits_t* const hits )
+void DFCALCluster::saveHits( const DFCALHitSoA &hits )
 {
    
    for ( int i=0; i < fNhits; i++) {
@@ -104,7 +108,7 @@ void DFCALCluster::resetClusterHits()
    }
 }
 
-bool DFCALCluster::update( const userhits_t* const hitList,
+bool DFCALCluster::update( const DFCALHitSoA &hits,
 			   double fcalFaceZ )
 {
 
@@ -113,12 +117,12 @@ bool DFCALCluster::update( const userhits_t* const hitList,
    for ( int h = 0; h < fNhits; h++ ) {
       int ih = fHit[h];
       double frac = fHitf[h];
-      double hitEnergy = hitList->hit[ih].E*frac;
+      double hitEnergy = hits.E(ih)*frac;
 
       energy += hitEnergy;
       
-      t2EWeight += hitEnergy * hitList->hit[ih].t * hitList->hit[ih].t;
-      tEWeight += hitEnergy * hitList->hit[ih].t;
+      t2EWeight += hitEnergy * hits.t(ih) * hits.t(ih);
+      tEWeight += hitEnergy * hits.t(ih);
    }
 
    tEWeight /= energy;
@@ -128,9 +132,9 @@ bool DFCALCluster::update( const userhits_t* const hitList,
     int chMax=0;
 
    if (fNhits > 0) { 
-       eMax = hitList->hit[fHit[0]].E;
-       timeMax = hitList->hit[fHit[0]].t;
-       chMax = hitList->hit[fHit[0]].ch;
+       eMax = hits.E(fHit[0]);
+       timeMax = hits.t(fHit[0]);
+       chMax = hits.ch(fHit[0]);
    }
 
    DVector3 centroid;
@@ -156,7 +160,7 @@ bool DFCALCluster::update( const userhits_t* const hitList,
     * to be used in weighting, since negative weights are thrown out
     */
 
-      weight = currentOffset + log(hitList->hit[ih].E*frac/energy);
+      weight = currentOffset + log(hits.E(ih)*frac/energy);
       if (h == 0) {
          centerWeight = weight;
       }
@@ -165,8 +169,8 @@ bool DFCALCluster::update( const userhits_t* const hitList,
                (neighborMaxWeight < weight)? weight:neighborMaxWeight;
       }
       if (weight > 0) {
-         xc  += hitList->hit[ih].x*weight;
-         yc  += hitList->hit[ih].y*weight;
+         xc  += hits.x(ih)*weight;
+         yc  += hits.y(ih)*weight;
          weightSum += weight;
       }
    }
@@ -176,9 +180,9 @@ bool DFCALCluster::update( const userhits_t* const hitList,
     */
    if (neighborMaxWeight > 0) {
       xc += (logFraction-1)*(centerWeight-neighborMaxWeight)
-                             *hitList->hit[0].x;
+                             *hits.x(0);
       yc += (logFraction-1)*(centerWeight-neighborMaxWeight)
-                             *hitList->hit[0].y;
+                             *hits.y(0);
       weightSum += (logFraction-1)*(centerWeight-neighborMaxWeight);
    }
    centroid.SetX(xc/weightSum);
@@ -187,8 +191,8 @@ bool DFCALCluster::update( const userhits_t* const hitList,
    for (int h = 0; h < fNhits; h++) {
       int ih = fHit[h];
       double frac = fHitf[h];
-      xc += hitList->hit[ih].x*(hitList->hit[ih].E*frac);
-      yc += hitList->hit[ih].y*(hitList->hit[ih].E*frac);
+      xc += hits.x(ih)*(hits.E(ih)*frac);
+      yc += hits.y(ih)*(hits.E(ih)*frac);
 
    }
    centroid.SetX(xc/energy);
@@ -206,21 +210,21 @@ bool DFCALCluster::update( const userhits_t* const hitList,
    for ( int h = 0; h < fNhits; h++ ) {
       int ih = fHit[h];
       double frac = fHitf[h];
-      double x = hitList->hit[ih].x;
-      double y = hitList->hit[ih].y;
+      double x = hits.x(ih);
+      double y = hits.y(ih);
 
-      MOM1x += hitList->hit[ih].E*frac*x;
-      MOM1y += hitList->hit[ih].E*frac*y;
-      MOM2x += hitList->hit[ih].E*frac*SQR(x);
-      MOM2y += hitList->hit[ih].E*frac*SQR(y);
+      MOM1x += hits.E(ih)*frac*x;
+      MOM1y += hits.E(ih)*frac*y;
+      MOM2x += hits.E(ih)*frac*SQR(x);
+      MOM2y += hits.E(ih)*frac*SQR(y);
 
       double phi = atan2( centroid.y() , centroid.x() );
       double u = x*cos(phi) + y*sin(phi);
       double v =-x*sin(phi) + y*cos(phi);
-      MOM1u += hitList->hit[ih].E*frac*u;
-      MOM1v += hitList->hit[ih].E*frac*v;
-      MOM2u += hitList->hit[ih].E*frac*SQR(u);
-      MOM2v += hitList->hit[ih].E*frac*SQR(v);
+      MOM1u += hits.E(ih)*frac*u;
+      MOM1v += hits.E(ih)*frac*v;
+      MOM2u += hits.E(ih)*frac*SQR(u);
+      MOM2v += hits.E(ih)*frac*SQR(v);
    }
 
    bool something_changed = false;
@@ -252,47 +256,86 @@ bool DFCALCluster::update( const userhits_t* const hitList,
       fRMS_u = sqrt(energy*MOM2u - SQR(MOM1u))/(energy);
       fRMS_v = sqrt(energy*MOM2v - SQR(MOM1v))/(energy);
 
-      for (int ih = 0; ih < hitList->nhits; ih++) {
-	shower_profile( hitList, ih,fEallowed[ih],fEexpected[ih],
-			fcalFaceZ+0.5*DFCALGeometry::blockLength());
-      }
+      shower_profile( hits, fcalFaceZ+0.5*DFCALGeometry::blockLength() );
    }
 
    return something_changed;
 }
 
-void DFCALCluster::shower_profile( const userhits_t* const hitList, 
-                                   const int ihit,
-                                   double& Eallowed, double& Eexpected,
-				   double fcalMidplaneZ) const
+void DFCALCluster::shower_profile( const DFCALHitSoA &hits,
+				   double fcalMidplaneZ)
 {
-
-   //std::cout << " Run profile for hit " << ihit; 
-   Eallowed = Eexpected = 0;
+   const int nhits = hits.size();
+   for ( int ih = 0; ih < nhits; ih++ ) {
+      fEallowed[ih] = 0;
+      fEexpected[ih] = 0;
+   }
    if (fEnergy == 0)
       return;
-   double x = hitList->hit[ihit].x;
-   double y = hitList->hit[ihit].y;
-   double dist = sqrt(SQR(x - fCentroid.x()) + SQR(y - fCentroid.y()));
-   if (dist > MAX_SHOWER_RADIUS)
-      return;
-   double theta = atan2((double)sqrt(SQR(fCentroid.x()) + SQR(fCentroid.y())), fcalMidplaneZ);
-   double phi = atan2( fCentroid.y(), fCentroid.x() );
-   double u0 = sqrt(SQR(fCentroid.x())+SQR(fCentroid.y()));
-   double v0 = 0;
-   double u = x*cos(phi) + y*sin(phi);
-   double v =-x*sin(phi) + y*cos(phi);
-   double vVar = SQR(MOLIERE_RADIUS);
-   double uVar = vVar+SQR(SQR(8*theta));
-   double vTail = 4.5+0.9*log(fEnergy+0.05);
-   double uTail = vTail+SQR(10*theta);
-   double core = exp(-0.5*SQR(SQR(u-u0)/uVar + SQR(v-v0)/vVar));
-   double tail = exp(-sqrt(SQR((u-u0)/uTail)+SQR((v-v0)/vTail)));
-   Eexpected = fEnergy*core;
-   Eallowed = 2*fEmax*core + (0.2+0.5*log(fEmax+1.))*tail;
-
-   if ((dist <= 4.) && (Eallowed < fEmax) ) {
-      std::cerr << "Warning: FCAL cluster Eallowed value out of range!\n";
-      Eallowed = fEmax;
+
+   // everything that depends only on the cluster is evaluated once
+   // here rather than once per hit
+   const double xc = fCentroid.x();
+   const double yc = fCentroid.y();
+   const double theta = atan2((double)sqrt(SQR(xc) + SQR(yc)), fcalMidplaneZ);
+   const double phi = atan2( yc, xc );
+   const double cosPhi = cos(phi);
+   const double sinPhi = sin(phi);
+   const double u0 = sqrt(SQR(xc)+SQR(yc));
+   const double v0 = 0;
+   const double vVar = SQR(MOLIERE_RADIUS);
+   const double uVar = vVar+SQR(SQR(8*theta));
+   const double vTail = 4.5+0.9*log(fEnergy+0.05);
+   const double uTail = vTail+SQR(10*theta);
+   const double tailNorm = 0.2+0.5*log(fEmax+1.);
+
+   const float* hx = hits.x();
+   const float* hy = hits.y();
+
+   // exact (double precision) profile of a single block
+   auto profile = [&]( int ih ) {
+      double x = hx[ih];
+      double y = hy[ih];
+      double dist = sqrt(SQR(x - xc) + SQR(y - yc));
+      if (dist > MAX_SHOWER_RADIUS)
+         return;
+      double u = x*cosPhi + y*sinPhi;
+      double v =-x*sinPhi + y*cosPhi;
+      double core = exp(-0.5*SQR(SQR(u-u0)/uVar + SQR(v-v0)/vVar));
+      double tail = exp(-sqrt(SQR((u-u0)/uTail)+SQR((v-v0)/vTail)));
+      fEexpected[ih] = fEnergy*core;
+      fEallowed[ih] = 2*fEmax*core + tailNorm*tail;
+
+      if ((dist <= 4.) && (fEallowed[ih] < fEmax) ) {
+         std::cerr << "Warning: FCAL cluster Eallowed value out of range!\n";
+         fEallowed[ih] = fEmax;
+      }
+   };
+
+#ifdef USE_SSE2
+   // Most blocks are far from any given cluster.  Reject them four at a
+   // time with a single precision distance test that is looser than the
+   // exact cut, so only the surviving blocks get the full evaluation.
+   // The hit arrays are padded to a multiple of four by DFCALHitSoA.
+   const float rCut = MAX_SHOWER_RADIUS + 1.0;
+   const __m128 xc4 = _mm_set1_ps( (float)xc );
+   const __m128 yc4 = _mm_set1_ps( (float)yc );
+   const __m128 rCut2 = _mm_set1_ps( rCut*rCut );
+   for ( int ih0 = 0; ih0 < nhits; ih0 += DFCALHitSoA::kSIMDWidth ) {
+      __m128 dx = _mm_sub_ps( _mm_loadu_ps( hx + ih0 ), xc4 );
+      __m128 dy = _mm_sub_ps( _mm_loadu_ps( hy + ih0 ), yc4 );
+      __m128 d2 = _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) );
+      int mask = _mm_movemask_ps( _mm_cmple_ps( d2, rCut2 ) );
+      while (mask) {
+         int ih = ih0 + __builtin_ctz( mask );
+         mask &= mask - 1;
+         if (ih < nhits)
+            profile( ih );
+      }
    }
+#else
+   for ( int ih = 0; ih < nhits; ih++ ) {
+      profile( ih );
+   }
+#endif
 }
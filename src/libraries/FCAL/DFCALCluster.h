@@ -10,6 +10,7 @@
 
 #include <DVector3.h>
 #include "DFCALHit.h"
+#include "DFCALHitSoA.h"
 using namespace std;
 
 #include <JANA/JObject.h>
@@ -27,23 +28,6 @@ class DFCALCluster : public JObject {
       DFCALCluster( const int nhits );
       ~DFCALCluster();
 
-   typedef struct {
-      oid_t id;
-      int ch;
-      float x;
-      float y;
-      float E;
-      float t;
-     // this may be pruned at a later stage to reduce size
-     // but it is useful for development now
-      float intOverPeak;
-   } userhit_t;
-
-   typedef struct {
-      int nhits;
-      userhit_t hit[1];
-   } userhits_t;
-
    typedef struct {
       oid_t id;
       int ch;
@@ -54,10 +38,12 @@ class DFCALCluster : public JObject {
       float intOverPeak;
    } DFCALClusterHit_t;
 
-   void saveHits( const userhits_t* const hit );
+   void saveHits( const DFCALHitSoA &hits );
 
    double getEexpected(const int ihit) const;
    double getEallowed(const int ihit) const;
+   // per-hit expected energies indexed like the DFCALHitSoA
+   const double* getEexpectedList() const { return fEexpected; }
    double getEnergy() const;
    double getEmax() const;
     int getChannelEmax() const;
@@ -78,7 +64,7 @@ class DFCALCluster : public JObject {
    int getHits() const; // get number of hits owned by a cluster
    int addHit(const int ihit, const double frac);
    void resetClusterHits();
-   bool update( const userhits_t* const hitList, double fcalFaceZ );
+   bool update( const DFCALHitSoA &hits, double fcalFaceZ );
 
 // get hits that form a cluster after clustering is finished
    inline const vector<DFCALClusterHit_t> GetHits() const { return my_hits; }
@@ -94,20 +80,19 @@ class DFCALCluster : public JObject {
 
    private:
 
-   void shower_profile( const userhits_t* const hitList, 
-                        const int ihit,
-                        double& Eallowed, double& Eexpected, 
-			double fcalMidplaneZ ) const ;
+   // evaluates fEallowed and fEexpected for every hit in the list
+   void shower_profile( const DFCALHitSoA &hits,
+			double fcalMidplaneZ ) ;
 
    // internal parsers of properties for a hit belonging to a cluster 
-   oid_t  getHitID( const userhits_t* const hitList, const int ihit) const;
-   int    getHitCh( const userhits_t* const hitList, const int ihit) const;
-   double getHitX( const userhits_t* const hitList, const int ihit) const;
-   double getHitY( const userhits_t* const hitList, const int ihit) const;
-   double getHitT( const userhits_t* const hitList, const int ihit) const;
-   double getHitIntOverPeak( const userhits_t* const hitList, const int ihit) const;
-   double getHitE( const userhits_t* const hitList, const int ihit) const;  // hit energy owned by cluster
-   double getHitEhit( const userhits_t* const hitList, const int ihit) const; // energy in a FCAL block
+   oid_t  getHitID( const DFCALHitSoA &hits, const int ihit) const;
+   int    getHitCh( const DFCALHitSoA &hits, const int ihit) const;
+   double getHitX( const DFCALHitSoA &hits, const int ihit) const;
+   double getHitY( const DFCALHitSoA &hits, const int ihit) const;
+   double getHitT( const DFCALHitSoA &hits, const int ihit) const;
+   double getHitIntOverPeak( const DFCALHitSoA &hits, const int ihit) const;
+   double getHitE( const DFCALHitSoA &hits, const int ihit) const;  // hit energy owned by cluster
+   double getHitEhit( const DFCALHitSoA &hits, const int ihit) const; // energy in a FCAL block
 
    double fEnergy;        // total cluster energy (GeV) or 0 if stale
    double fTime;          // cluster time(ns) set equivalent to fTimeMaxE below
@@ -220,80 +205,80 @@ inline int DFCALCluster::getHits() const
    return fNhits;
 }
 
-inline JObject::oid_t DFCALCluster::getHitID(const userhits_t* const hitList, const int ihit ) const
+inline JObject::oid_t DFCALCluster::getHitID(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) {
-     return hitList->hit[ fHit[ ihit ] ].id;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) {
+     return hits.id( fHit[ ihit ] );
    }
    else {
      return 0;
    }
 }
 
-inline int DFCALCluster::getHitCh(const userhits_t* const hitList, const int ihit ) const
+inline int DFCALCluster::getHitCh(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) {
-     return hitList->hit[ fHit[ ihit ] ].ch;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) {
+     return hits.ch( fHit[ ihit ] );
    }
    else {
      return 0;
    }
 }
 
-inline double DFCALCluster::getHitX(const userhits_t* const hitList, const int ihit ) const
+inline double DFCALCluster::getHitX(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) {
-     return  hitList->hit[ fHit[ ihit ] ].x;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) {
+     return  hits.x( fHit[ ihit ] );
    }
    else {
      return 0.;
    }
 }
 
-inline double DFCALCluster::getHitY(const userhits_t* const hitList, const int ihit ) const
+inline double DFCALCluster::getHitY(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) {
-     return  hitList->hit[ fHit[ ihit ] ].y;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) {
+     return  hits.y( fHit[ ihit ] );
    }
    else {
      return 0.;
    }
 }
 
-inline double DFCALCluster::getHitT(const userhits_t* const hitList, const int ihit ) const
+inline double DFCALCluster::getHitT(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) { 
-     return  hitList->hit[ fHit[ ihit ] ].t;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) { 
+     return  hits.t( fHit[ ihit ] );
    }
    else {
      return 0.;
    }
 }
 
-inline double DFCALCluster::getHitIntOverPeak(const userhits_t* const hitList, const int ihit ) const
+inline double DFCALCluster::getHitIntOverPeak(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) { 
-     return  hitList->hit[ fHit[ ihit ] ].intOverPeak;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) { 
+     return  hits.intOverPeak( fHit[ ihit ] );
    }
    else {
      return 0.;
    }
 }
 
-inline double DFCALCluster::getHitE(const userhits_t* const hitList, const int ihit ) const
+inline double DFCALCluster::getHitE(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) {
-     return fHitf[ ihit ] * hitList->hit[ fHit[ ihit ] ].E ;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) {
+     return fHitf[ ihit ] * hits.E( fHit[ ihit ] ) ;
    }
    else {
      return -1.;
    }
 }
 
-inline double DFCALCluster::getHitEhit(const userhits_t* const hitList, const int ihit ) const
+inline double DFCALCluster::getHitEhit(const DFCALHitSoA &hits, const int ihit ) const
 {
-   if ( ihit >= 0  && ihit < fNhits && hitList && ihit < hitList->nhits ) {
-     return hitList->hit[ fHit[ ihit ] ].E ;
+   if ( ihit >= 0  && ihit < fNhits && ihit < hits.size() ) {
+     return hits.E( fHit[ ihit ] ) ;
    }
    else {
      return -1.;
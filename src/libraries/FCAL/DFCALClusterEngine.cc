@@ -0,0 +1,157 @@
+//
+//    File: DFCALClusterEngine.cc
+//
+
+#include <math.h>
+
+#include "FCAL/DFCALClusterEngine.h"
+#include "FCAL/DFCALCluster.h"
+
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+//------------------
+// DFCALClusterEngine
+//------------------
+DFCALClusterEngine::DFCALClusterEngine()
+{
+   fMinSeedEnergy = 0.035; // GeV
+   fTimeCut = 15.0; // ns
+   fMaxIterations = 99;
+}
+
+//------------------
+// Clusterize
+//------------------
+void DFCALClusterEngine::Clusterize( const DFCALHitSoA &hits, double fcalFaceZ,
+                                     vector<DFCALCluster*> &clusters )
+{
+   const int nhits = hits.size();
+   fHitUsed.assign( nhits, 0 );
+   fTotalExpected.resize( nhits );
+
+   vector<DFCALCluster*> &myClusters = fClusters;
+   myClusters.clear();
+
+   for ( int iter = 0; iter < fMaxIterations; iter++ ) {
+
+      // 1. At beginning of iteration, recompute info for all clusters.
+      //    If something changed, return all hits to the pool and repeat.
+
+      bool something_changed = false;
+      for ( size_t c = 0; c < myClusters.size(); c++ ) {
+         something_changed |= myClusters[c]->update( hits, fcalFaceZ );
+      }
+      if (something_changed) {
+         for ( size_t c = 0; c < myClusters.size(); c++ ) {
+            myClusters[c]->resetClusterHits();
+         }
+         fHitUsed.assign( nhits, 0 );
+      }
+      else if (iter > 0) {
+         break;
+      }
+
+      // 2. Look for blocks with energy large enough to require formation
+      //    of a new cluster, and assign them as cluster seeds.
+
+      SeedClusters( hits, fcalFaceZ, iter, myClusters );
+
+      // 3. Share all non-seed blocks among seeded clusters, where
+      //    any cluster shares a block if it expects at least 1 KeV in it.
+
+      ShareHits( hits, myClusters );
+   }
+
+   clusters.insert( clusters.end(), myClusters.begin(), myClusters.end() );
+   myClusters.clear();
+}
+
+//------------------
+// SeedClusters
+//------------------
+void DFCALClusterEngine::SeedClusters( const DFCALHitSoA &hits, double fcalFaceZ,
+                                       int iter, vector<DFCALCluster*> &clusters )
+{
+   // Seeding is sequential: a new seed changes the allowed energy of
+   // every block that comes after it in the energy ordered list.
+   for ( int ih = 0; ih < hits.size(); ih++ ) {
+      double energy = hits.E(ih);
+      if (energy < fMinSeedEnergy)
+         break;
+      double totalAllowed = 0;
+      for ( size_t c = 0; c < clusters.size(); c++ ) {
+         totalAllowed += clusters[c]->getEallowed(ih);
+      }
+      if (energy > totalAllowed) {
+         DFCALCluster *cluster = new DFCALCluster( hits.size() );
+         fHitUsed[ih] = -1;
+         cluster->addHit(ih,1.);
+         cluster->update( hits, fcalFaceZ );
+         clusters.push_back( cluster );
+      }
+      else if (iter > 0) {
+         for ( size_t c = 0; c < clusters.size(); c++ ) {
+            if ( clusters[c]->getHits() )
+               continue;
+            totalAllowed -= clusters[c]->getEallowed(ih);
+            if (energy > totalAllowed) {
+               fHitUsed[ih] = -1;
+               clusters[c]->addHit(ih,1.);
+               break;
+            }
+         }
+      }
+   }
+}
+
+//------------------
+// ShareHits
+//------------------
+void DFCALClusterEngine::ShareHits( const DFCALHitSoA &hits,
+                                    vector<DFCALCluster*> &clusters )
+{
+   // The set of clusters owning hits does not change while blocks are
+   // being shared, so the expected energy summed over clusters can be
+   // accumulated for all blocks at once, one cluster row at a time.
+   // Clusters are added in the same order for every block so the sums
+   // are identical to the block-by-block evaluation.
+   const int nhits = hits.size();
+   double *total = fTotalExpected.data();
+   for ( int ih = 0; ih < nhits; ih++ ) total[ih] = 0;
+
+   for ( size_t c = 0; c < clusters.size(); c++ ) {
+      if (clusters[c]->getHits() == 0) continue;
+      const double *expected = clusters[c]->getEexpectedList();
+      int ih = 0;
+#ifdef USE_SSE2
+      for ( ; ih + 2 <= nhits; ih += 2 ) {
+         __m128d sum = _mm_add_pd( _mm_loadu_pd( total + ih ),
+                                   _mm_loadu_pd( expected + ih ) );
+         _mm_storeu_pd( total + ih, sum );
+      }
+#endif
+      for ( ; ih < nhits; ih++ ) total[ih] += expected[ih];
+   }
+
+   // Each cluster collects its share of every non-seed block that is in
+   // time with it.  Hits are offered to a cluster in increasing order so
+   // the per-cluster hit lists come out as in a hit-major loop.
+   const float *t = hits.t();
+   for ( size_t c = 0; c < clusters.size(); c++ ) {
+      DFCALCluster *cluster = clusters[c];
+      if (cluster->getHits() == 0) continue;
+      const double *expected = cluster->getEexpectedList();
+      double tCluster = cluster->getTimeMaxE();
+      for ( int ih = 0; ih < nhits; ih++ ) {
+         if ( fHitUsed[ih] < 0 ) // cannot share seed
+            continue;
+         if (expected[ih] > 1e-6 && fabs(tCluster - t[ih]) < fTimeCut) {
+            cluster->addHit(ih, expected[ih]/total[ih]);
+            ++fHitUsed[ih];
+         }
+      }
+   }
+}
+
@@ -0,0 +1,55 @@
+//
+//    File: DFCALClusterEngine.h
+//
+// Iterative island clusterizer for the FCAL (UConn LGD algorithm,
+// M. Kornicer) working on the structure-of-arrays hit view.  One engine
+// is owned by each DFCALCluster_factory, so its scratch buffers are
+// private to the thread and are reused from event to event.
+//
+
+#ifndef _DFCALClusterEngine_
+#define _DFCALClusterEngine_
+
+#include <vector>
+using namespace std;
+
+#include "DFCALHitSoA.h"
+
+class DFCALCluster;
+
+class DFCALClusterEngine {
+   public:
+
+      DFCALClusterEngine();
+      ~DFCALClusterEngine(){}
+
+      void SetMinSeedEnergy( float E ){ fMinSeedEnergy = E; }
+      void SetTimeCut( float t ){ fTimeCut = t; }
+      void SetMaxIterations( int n ){ fMaxIterations = n; }
+
+      // Run the clusterizer on hits sorted by decreasing energy.  The
+      // clusters found are appended to the list and are owned by the
+      // caller.  fcalFaceZ is the FCAL face in the frame where z=0 is
+      // the center of the target.
+      void Clusterize( const DFCALHitSoA &hits, double fcalFaceZ,
+                       vector<DFCALCluster*> &clusters );
+
+   private:
+
+      void SeedClusters( const DFCALHitSoA &hits, double fcalFaceZ,
+                         int iter, vector<DFCALCluster*> &clusters );
+      void ShareHits( const DFCALHitSoA &hits,
+                      vector<DFCALCluster*> &clusters );
+
+      float fMinSeedEnergy;
+      float fTimeCut;
+      int fMaxIterations;
+
+      // per-event scratch space, indexed like the hit view
+      vector<int> fHitUsed;          // <0 for seeds, else number of sharers
+      vector<double> fTotalExpected; // summed expected energy of all clusters
+      vector<DFCALCluster*> fClusters;
+};
+
+#endif // _DFCALClusterEngine_
+
@@ -12,6 +12,8 @@
 #include <JANA/JEventLoop.h>
 
 #include "DFCALCluster.h"
+#include "DFCALClusterEngine.h"
+#include "DFCALHitSoA.h"
 
 using namespace jana;
 
@@ -37,6 +39,10 @@ class DFCALCluster_factory:public JFactory<DFCALCluster>{
 		// where z = 0 is the center of the target
 
 		double fcalFaceZ_TargetIsZeq0;
+
+		// reused from event to event
+		DFCALHitSoA hitView;
+		DFCALClusterEngine engine;
 };
 
 #endif // _DFCALCluster_factory_
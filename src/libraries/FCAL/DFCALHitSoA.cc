@@ -0,0 +1,66 @@
+//
+//    File: DFCALHitSoA.cc
+//
+
+#include <iostream>
+using namespace std;
+
+#include "FCAL/DFCALHitSoA.h"
+#include "FCAL/DFCALHit.h"
+#include "FCAL/DFCALGeometry.h"
+
+// Coordinate given to padding entries: far enough from any block that
+// the shower profile of every cluster vanishes there.
+static const float kFarAway = 1.0e6;
+
+//------------------
+// Fill
+//------------------
+int DFCALHitSoA::Fill( const vector<const DFCALHit*> &fcalhits,
+                       const DFCALGeometry &fcalGeom,
+                       float minE, int maxHits )
+{
+   // clear() keeps the capacity so after the first few events
+   // no further allocation takes place
+   fX.clear();
+   fY.clear();
+   fE.clear();
+   fT.clear();
+   fCh.clear();
+   fIntOverPeak.clear();
+   fId.clear();
+   fHit.clear();
+
+   fN = 0;
+   for( vector<const DFCALHit*>::const_iterator hit = fcalhits.begin();
+        hit != fcalhits.end(); hit++ ){
+      if( (**hit).E < minE ) continue;
+      fX.push_back( (**hit).x );
+      fY.push_back( (**hit).y );
+      fE.push_back( (**hit).E );
+      fT.push_back( (**hit).t );
+      fCh.push_back( fcalGeom.channel( (**hit).row, (**hit).column ) );
+      fIntOverPeak.push_back( (**hit).intOverPeak );
+      fId.push_back( (**hit).id );
+      fHit.push_back( *hit );
+      fN++;
+
+      if( fN >= maxHits ){
+         cout << "ERROR: DFCALHitSoA: number of hits "
+              << fN << " larger than " << maxHits << endl;
+         break;
+      }
+   }
+
+   // pad to a multiple of the SIMD width
+   while( fX.size() % kSIMDWidth ){
+      fX.push_back( kFarAway );
+      fY.push_back( kFarAway );
+      fE.push_back( 0. );
+      fT.push_back( 0. );
+      fCh.push_back( -1 );
+   }
+
+   return fN;
+}
+
@@ -0,0 +1,75 @@
+//
+//    File: DFCALHitSoA.h
+//
+// Structure-of-arrays view of the FCAL hits used by the island
+// clusterizer.  The view is filled once per event from the
+// (energy sorted) DFCALHit list and keeps x, y, E, t and channel in
+// separate contiguous arrays so that the per-cluster shower profile
+// can be evaluated over all hits with packed SIMD loads.  The arrays
+// are padded to a multiple of kSIMDWidth with entries placed far
+// outside the calorimeter so vector loops need no tail handling.
+//
+
+#ifndef _DFCALHitSoA_
+#define _DFCALHitSoA_
+
+#include <vector>
+using namespace std;
+
+#include <JANA/JObject.h>
+using namespace jana;
+
+class DFCALHit;
+class DFCALGeometry;
+
+class DFCALHitSoA {
+   public:
+
+      enum { kSIMDWidth = 4 };
+
+      DFCALHitSoA(){ fN = 0; }
+      ~DFCALHitSoA(){}
+
+      // Fill from a hit list already sorted by decreasing energy.  Hits
+      // below minE are skipped and at most maxHits are kept.  Returns the
+      // number of hits stored.
+      int Fill( const vector<const DFCALHit*> &fcalhits,
+                const DFCALGeometry &fcalGeom,
+                float minE, int maxHits );
+      void Reset(){ fN = 0; }
+
+      int size() const { return fN; }
+      int paddedSize() const { return (int)fX.size(); }
+
+      // packed arrays (length paddedSize())
+      const float* x() const { return fX.data(); }
+      const float* y() const { return fY.data(); }
+      const float* E() const { return fE.data(); }
+      const float* t() const { return fT.data(); }
+      const int*  ch() const { return fCh.data(); }
+
+      // single hit accessors
+      float x( int ih ) const { return fX[ih]; }
+      float y( int ih ) const { return fY[ih]; }
+      float E( int ih ) const { return fE[ih]; }
+      float t( int ih ) const { return fT[ih]; }
+      int   ch( int ih ) const { return fCh[ih]; }
+      float intOverPeak( int ih ) const { return fIntOverPeak[ih]; }
+      JObject::oid_t id( int ih ) const { return fId[ih]; }
+      const DFCALHit* hit( int ih ) const { return fHit[ih]; }
+
+   private:
+
+      int fN;                     // number of real hits
+      vector<float> fX;           // block center x (cm)
+      vector<float> fY;           // block center y (cm)
+      vector<float> fE;           // hit energy (GeV)
+      vector<float> fT;           // hit time (ns)
+      vector<int>   fCh;          // FCAL channel number
+      vector<float> fIntOverPeak;
+      vector<JObject::oid_t> fId;
+      vector<const DFCALHit*> fHit;
+};
+
+#endif // _DFCALHitSoA_
+
@@ -17,6 +17,7 @@ using namespace std;
 #include "DAQ/Df250PulsePedestal.h"
 #include "DAQ/Df250Config.h"
 #include "TTAB/DTTabUtilities.h"
+#include "DANA/DApplication.h"
 using namespace jana;
 
 //------------------
@@ -54,6 +55,18 @@ jerror_t DFCALHit_factory::init(void)
     CHECK_FADC_ERRORS = true;
     gPARMS->SetDefaultParameter("FCAL:CHECK_FADC_ERRORS", CHECK_FADC_ERRORS, "Set to 1 to reject hits with fADC250 errors, ser to 0 to keep these hits");
 
+    // constants are loaded (once for all threads) by the shared calibration
+    // cache, which fetches them together with the other declared tables
+    DApplication* dapp = dynamic_cast<DApplication*>(japp);
+    calib_cache = dapp->GetCalibCache();
+    calib_cache->Declare< map<string,double> >("/FCAL/digi_scales");
+    calib_cache->Declare< map<string,double> >("/FCAL/base_time_offset");
+    calib_cache->Declare< vector<double> >("/FCAL/gains");
+    calib_cache->Declare< vector<double> >("/FCAL/pedestals");
+    calib_cache->Declare< vector<double> >("/FCAL/timing_offsets");
+    calib_cache->Declare< vector<double> >("/FCAL/block_quality");
+    calib_cache->Declare< vector<double> >("/FCAL/ADC_Offsets");
+
     return NOERROR;
 }
 
@@ -80,18 +93,18 @@ jerror_t DFCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
         return OBJECT_NOT_AVAILABLE;
     const DFCALGeometry& fcalGeom = *(fcalGeomVect[0]);
 
-    /// Read in calibration constants
-    vector< double > raw_gains;
-    vector< double > raw_pedestals;
-    vector< double > raw_time_offsets;
-    vector< double > raw_block_qualities;    // we should change this to an int?
-    vector< double > raw_ADCoffsets;
+    /// Read in calibration constants (read-only tables shared by all threads)
+    shared_ptr<const vector<double> > raw_gains;
+    shared_ptr<const vector<double> > raw_pedestals;
+    shared_ptr<const vector<double> > raw_time_offsets;
+    shared_ptr<const vector<double> > raw_block_qualities;    // we should change this to an int?
+    shared_ptr<const vector<double> > raw_ADCoffsets;
 
     if(print_messages) jout << "In DFCALHit_factory, loading constants..." << endl;
 
     // load scale factors
     map<string,double> scale_factors;
-    if (eventLoop->GetCalib("/FCAL/digi_scales", scale_factors))
+    if (calib_cache->GetCalib(eventLoop, "/FCAL/digi_scales", scale_factors))
         jout << "Error loading /FCAL/digi_scales !" << endl;
     if (scale_factors.find("FCAL_ADC_ASCALE") != scale_factors.end())
         a_scale = scale_factors["FCAL_ADC_ASCALE"];
@@ -104,7 +117,7 @@ jerror_t DFCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 
     // load base time offset
     map<string,double> base_time_offset;
-    if (eventLoop->GetCalib("/FCAL/base_time_offset",base_time_offset))
+    if (calib_cache->GetCalib(eventLoop, "/FCAL/base_time_offset", base_time_offset))
         jout << "Error loading /FCAL/base_time_offset !" << endl;
     if (base_time_offset.find("FCAL_BASE_TIME_OFFSET") != base_time_offset.end())
         t_base = base_time_offset["FCAL_BASE_TIME_OFFSET"];
@@ -112,22 +125,22 @@ jerror_t DFCALHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
         jerr << "Unable to get FCAL_BASE_TIME_OFFSET from /FCAL/base_time_offset !" << endl;
 
     // load constant tables
-    if (eventLoop->GetCalib("/FCAL/gains", raw_gains))
+    if (calib_cache->Get(eventLoop, "/FCAL/gains", raw_gains))
         jout << "Error loading /FCAL/gains !" << endl;
-    if (eventLoop->GetCalib("/FCAL/pedestals", raw_pedestals))
+    if (calib_cache->Get(eventLoop, "/FCAL/pedestals", raw_pedestals))
         jout << "Error loading /FCAL/pedestals !" << endl;
-    if (eventLoop->GetCalib("/FCAL/timing_offsets", raw_time_offsets))
+    if (calib_cache->Get(eventLoop, "/FCAL/timing_offsets", raw_time_offsets))
         jout << "Error loading /FCAL/timing_offsets !" << endl;
-    if (eventLoop->GetCalib("/FCAL/block_quality", raw_block_qualities))
+    if (calib_cache->Get(eventLoop, "/FCAL/block_quality", raw_block_qualities))
         jout << "Error loading /FCAL/block_quality !" << endl;
-    if (eventLoop->GetCalib("/FCAL/ADC_Offsets", raw_ADCoffsets))
+    if (calib_cache->Get(eventLoop, "/FCAL/ADC_Offsets", raw_ADCoffsets))
         jout << "Error loading /FCAL/ADC_Offsets !" << endl;
 
-    FillCalibTable(gains, raw_gains, fcalGeom);
-    FillCalibTable(pedestals, raw_pedestals, fcalGeom);
-    FillCalibTable(time_offsets, raw_time_offsets, fcalGeom);
-    FillCalibTable(block_qualities, raw_block_qualities, fcalGeom);
-    FillCalibTable(ADC_Offsets, raw_ADCoffsets, fcalGeom);
+    FillCalibTable(gains, *raw_gains, fcalGeom);
+    FillCalibTable(pedestals, *raw_pedestals, fcalGeom);
+    FillCalibTable(time_offsets, *raw_time_offsets, fcalGeom);
+    FillCalibTable(block_qualities, *raw_block_qualities, fcalGeom);
+    FillCalibTable(ADC_Offsets, *raw_ADCoffsets, fcalGeom);
 
     return NOERROR;
 }
@@ -12,6 +12,7 @@
 using namespace std;
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include "TTAB/DTranslationTable.h"
 #include "DFCALDigiHit.h"
 #include "DFCALHit.h"
@@ -65,6 +66,7 @@ class DFCALHit_factory:public jana::JFactory<DFCALHit>{
 				     const DFCALGeometry &fcalGeom);
 
         bool CHECK_FADC_ERRORS;
+        DCalibCache *calib_cache;
 };
 
 #endif // _DFCALHit_factory_
@@ -14,6 +14,7 @@ using namespace std;
 #include <FDC/DFDCCathodeDigiHit.h>
 #include <FDC/DFDCWireDigiHit.h>
 #include "DFDCHit_factory.h"
+#include "DANA/DApplication.h"
 #include <DAQ/Df125PulseIntegral.h>
 #include <DAQ/Df125PulsePedestal.h>
 #include <DAQ/Df125Config.h>
@@ -35,6 +36,20 @@ jerror_t DFDCHit_factory::init(void)
    t_base       = 0.;           // ns
    fadc_t_base  = 0.;           // ns
 
+   // tables loaded once for all threads by the shared calibration cache
+   DApplication* dapp = dynamic_cast<DApplication*>(japp);
+   calib_cache = dapp->GetCalibCache();
+   calib_cache->Declare< map<string,double> >("/FDC/digi_scales");
+   calib_cache->Declare< map<string,double> >("/FDC/base_time_offset");
+   for(int package=1; package<=4; package++){
+      stringstream ccdb_prefix;
+      ccdb_prefix << "/FDC/package" << package;
+      calib_cache->Declare< vector< vector<double> > >(ccdb_prefix.str()+"/strip_gains_v2");
+      calib_cache->Declare< vector< vector<double> > >(ccdb_prefix.str()+"/strip_pedestals");
+      calib_cache->Declare< vector< vector<double> > >(ccdb_prefix.str()+"/strip_timing_offsets");
+      calib_cache->Declare< vector< vector<double> > >(ccdb_prefix.str()+"/wire_timing_offsets");
+   }
+
    return NOERROR;
 }
 
@@ -66,7 +81,7 @@ jerror_t DFDCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 
    // load scale factors
    map<string,double> scale_factors;
-   if(eventLoop->GetCalib("/FDC/digi_scales", scale_factors))
+   if(calib_cache->GetCalib(eventLoop, "/FDC/digi_scales", scale_factors))
       jout << "Error loading /FDC/digi_scales !" << endl;
    if( scale_factors.find("FDC_ADC_ASCALE") != scale_factors.end() ) {
       a_scale = scale_factors["FDC_ADC_ASCALE"];
@@ -81,7 +96,7 @@ jerror_t DFDCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 
    // load base time offset
    map<string,double> base_time_offset;
-   if (eventLoop->GetCalib("/FDC/base_time_offset",base_time_offset))
+   if (calib_cache->GetCalib(eventLoop, "/FDC/base_time_offset",base_time_offset))
       jout << "Error loading /FDC/base_time_offset !" << endl;
    if (base_time_offset.find("FDC_BASE_TIME_OFFSET") != base_time_offset.end())
       fadc_t_base = base_time_offset["FDC_BASE_TIME_OFFSET"];
@@ -381,13 +396,13 @@ void DFDCHit_factory::LoadPackageCalibTables(jana::JEventLoop *eventLoop, string
    vector< vector<double> >  new_gains, new_pedestals, new_strip_t0s, new_wire_t0s;
    char str[256];
 
-   if(eventLoop->GetCalib(ccdb_prefix+"/strip_gains_v2", new_gains))
+   if(calib_cache->GetCalib(eventLoop, ccdb_prefix+"/strip_gains_v2", new_gains))
       cout << "Error loading "+ccdb_prefix+"/strip_gains_v2 !" << endl;
-   if(eventLoop->GetCalib(ccdb_prefix+"/strip_pedestals", new_pedestals))
+   if(calib_cache->GetCalib(eventLoop, ccdb_prefix+"/strip_pedestals", new_pedestals))
       cout << "Error loading "+ccdb_prefix+"/strip_pedestals !" << endl;
-   if(eventLoop->GetCalib(ccdb_prefix+"/strip_timing_offsets", new_strip_t0s))
+   if(calib_cache->GetCalib(eventLoop, ccdb_prefix+"/strip_timing_offsets", new_strip_t0s))
       cout << "Error loading "+ccdb_prefix+"/strip_timing_offsets!" << endl;
-   if(eventLoop->GetCalib(ccdb_prefix+"/wire_timing_offsets", new_wire_t0s))
+   if(calib_cache->GetCalib(eventLoop, ccdb_prefix+"/wire_timing_offsets", new_wire_t0s))
       cout << "Error loading "+ccdb_prefix+"/wire_timing_offsets!" << endl;
 
    for(int nchamber=0; nchamber<6; nchamber++) {
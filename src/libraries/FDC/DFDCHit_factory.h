@@ -12,6 +12,7 @@
 using namespace std;
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include "TTAB/DTTabUtilities.h"
 
 #include "DFDCHit.h"
@@ -58,6 +59,7 @@ class DFDCHit_factory:public jana::JFactory<DFDCHit>{
 	
 	bool USE_FDC;
 		void LoadPackageCalibTables(jana::JEventLoop *eventLoop, string ccdb_prefix);
+		DCalibCache *calib_cache;
 };
 
 #endif // _DFDCHit_factory_
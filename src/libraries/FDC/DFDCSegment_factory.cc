@@ -126,9 +126,10 @@ jerror_t DFDCSegment_factory::evnt(JEventLoop* eventLoop, uint64_t eventNo) {
 // Also returns predicted positions along the helical path.
 //
 jerror_t DFDCSegment_factory::RiemannLineFit(vector<const DFDCPseudo *>&points,
-					     DMatrix &CR,vector<xyz_t>&XYZ){
+					     vector<double> &CR,vector<xyz_t>&XYZ){
   unsigned int n=points.size()+1;
-  vector<int>bad(n);  // Keep track of "bad" intersection points
+  vector<int>&bad=fit_bad;  // Keep track of "bad" intersection points
+  bad.assign(n,0);
   bool got_bad_intersection=false;
   // Fill matrix of intersection points
   for (unsigned int m=0;m<n-1;m++){
@@ -178,7 +179,7 @@ jerror_t DFDCSegment_factory::RiemannLineFit(vector<const DFDCPseudo *>&points,
     num_z++;
 
     DVector2 diffxy=XYZ[k].xy-oldxy;
-    double var=CR(k,k);
+    double var=CR[k];
     if (bad[k]) var=XYZ[k].covr;
   
     sperp_old=sperp;
@@ -238,25 +239,18 @@ jerror_t DFDCSegment_factory::RiemannLineFit(vector<const DFDCPseudo *>&points,
 // update the R and RPhi covariance matrices.
 //
 jerror_t DFDCSegment_factory::UpdatePositionsAndCovariance(unsigned int n,
-     double r1sq,vector<xyz_t>&XYZ,DMatrix &CRPhi,DMatrix &CR){
+     double r1sq,vector<xyz_t>&XYZ,vector<double> &CRPhi,vector<double> &CR){
   double delta_x=XYZ[ref_plane].xy.X()-xc; 
   double delta_y=XYZ[ref_plane].xy.Y()-yc;
   double r1=sqrt(r1sq);
   double denom=delta_x*delta_x+delta_y*delta_y;
 
-  // Auxiliary matrices for correcting for non-normal track incidence to FDC
-  // The correction is 
-  //    CRPhi'= C*CRPhi*C+S*CR*S, where S(i,i)=R_i*kappa/2
-  //                                and C(i,i)=sqrt(1-S(i,i)^2)  
-  DMatrix C(n,n);
-  DMatrix S(n,n);
-
   // Predicted positions
   Phi1=atan2(delta_y,delta_x);
   double z1=XYZ[ref_plane].z;
   double y1=XYZ[ref_plane].xy.X();
   double x1=XYZ[ref_plane].xy.Y();
-  double var_R1=CR(ref_plane,ref_plane);
+  double var_R1=CR[ref_plane];
   for (unsigned int k=0;k<n;k++){       
     double sperp=rotation_sense*(XYZ[k].z-z1)/tanl;
     double phi_s=Phi1+sperp/rc;
@@ -307,26 +301,16 @@ jerror_t DFDCSegment_factory::UpdatePositionsAndCovariance(unsigned int n,
     double dx1_dr1=-r1*(2.*N[0]*N[2]*x1+2.*N[2]*cdist-N[1]*N[1])/xdenom;
     double var_x1=dx1_dr1*dx1_dr1*var_R1;
 
-    CRPhi(k,k)=dRPhi_dx1*dRPhi_dx1*var_x1+dRPhi_dy1*dRPhi_dy1*var_y1
+    double var_rphi=dRPhi_dx1*dRPhi_dx1*var_x1+dRPhi_dy1*dRPhi_dy1*var_y1
       +dRPhi_dtanl*dRPhi_dtanl*var_tanl;
-    CR(k,k)=dR_dx1*dR_dx1*var_x1+dR_dy1*dR_dy1*var_y1
+    CR[k]=dR_dx1*dR_dx1*var_x1+dR_dy1*dR_dy1*var_y1
       +dR_dtanl*dR_dtanl*var_tanl;
 
+    // Correction for non-normal incidence of track on FDC 
     // double stemp=sqrt(XYZ(k,0)*XYZ(k,0)+XYZ(k,1)*XYZ(k,1))/(4.*rc);
     double stemp=XYZ[k].xy.Mod()/(4.*rc);
-    double ctemp=1.-stemp*stemp;
-    if (ctemp>0){
-      S(k,k)=stemp;
-      C(k,k)=sqrt(ctemp);
-    }
-    else{
-      S(k,k)=0.;
-      C(k,k)=1.;
-    }
+    CRPhi[k]=DRiemannFitEngine::CorrectVarRPhi(var_rphi,CR[k],stemp);
   }
-  
-  // Correction for non-normal incidence of track on FDC 
-  CRPhi=C*CRPhi*C+S*CR*S;
  
   return NOERROR;
 }
@@ -337,15 +321,11 @@ jerror_t DFDCSegment_factory::UpdatePositionsAndCovariance(unsigned int n,
 // fitting planes in (x,y, w=x^2+y^2) space
 //
 jerror_t DFDCSegment_factory::RiemannCircleFit(vector<const DFDCPseudo *>&points,
-					       DMatrix &CRPhi){
+					       vector<double> &CRPhi){
   unsigned int n=points.size()+1;
-  DMatrix X(n,3);
-  DMatrix Xavg(1,3);
   DMatrix A(3,3);
-  // vector of ones
-  DMatrix OnesT(1,n);
+  double Xavg[3];
   double W_sum=0.;
-  DMatrix W(n,n);
 
   // The goal is to find the eigenvector corresponding to the smallest 
   // eigenvalue of the equation
@@ -357,26 +337,20 @@ jerror_t DFDCSegment_factory::RiemannCircleFit(vector<const DFDCPseudo *>&points
   // diagonal elements in W.
   // At this stage we ignore the multiple scattering.
   unsigned int last_index=n-1;
+  riemann_engine.Reset(n);
   for (unsigned int i=0;i<last_index;i++){
-    X(i,0)=points[i]->xy.X();
-    X(i,1)=points[i]->xy.Y();
-    X(i,2)=points[i]->xy.Mod2();
-    OnesT(0,i)=1.;
-    W(i,i)=1./CRPhi(i,i);
-    W_sum+=W(i,i);
+    riemann_engine.SetPoint(i,points[i]->xy.X(),points[i]->xy.Y(),
+			    1./CRPhi[i]);
   }
-  OnesT(0,last_index)=1.;
-  W(last_index,last_index)=1./CRPhi(last_index,last_index);
-  W_sum+=W(last_index,last_index);
+  // Fake target point at the origin
+  riemann_engine.SetPoint(last_index,0.,0.,1./CRPhi[last_index]);
+  riemann_engine.CalcMoments(A,Xavg,W_sum);
   var_avg=1./W_sum;
-  Xavg=var_avg*(OnesT*(W*X));
   // Store in private array for use in other routines
-  xavg[0]=Xavg(0,0);
-  xavg[1]=Xavg(0,1);
-  xavg[2]=Xavg(0,2);
+  xavg[0]=Xavg[0];
+  xavg[1]=Xavg[1];
+  xavg[2]=Xavg[2];
   
-  A=DMatrix(DMatrix::kTransposed,X)*(W*X)
-    -W_sum*(DMatrix(DMatrix::kTransposed,Xavg)*Xavg);
   if(!A.IsValid())return UNRECOVERABLE_ERROR;
 
   // The characteristic equation is 
@@ -437,7 +411,7 @@ jerror_t DFDCSegment_factory::RiemannCircleFit(vector<const DFDCPseudo *>&points
   }
       
   // Distance to origin
-  dist_to_origin=-(N[0]*Xavg(0,0)+N[1]*Xavg(0,1)+N[2]*Xavg(0,2));
+  dist_to_origin=-(N[0]*Xavg[0]+N[1]*Xavg[1]+N[2]*Xavg[2]);
 
   // Center and radius of the circle
   double two_N2=2.*N[2];
@@ -460,9 +434,12 @@ DFDCSegment_factory::RiemannHelicalFit(vector<const DFDCPseudo*>&points){
   unsigned int num_points=num_measured+1; 
   Ndof=num_points-3;
   // list of points on track and corresponding covariance matrices
-  vector<xyz_t>XYZ(num_points);
-  DMatrix CR(num_points,num_points);
-  DMatrix CRPhi(num_points,num_points); 
+  vector<xyz_t>&XYZ=fit_XYZ;
+  vector<double>&CR=fit_CR;
+  vector<double>&CRPhi=fit_CRPhi;
+  XYZ.assign(num_points,xyz_t());
+  CR.assign(num_points,0.);
+  CRPhi.assign(num_points,0.);
   
  
   // Fill initial matrices for R and RPhi measurements
@@ -479,15 +456,15 @@ DFDCSegment_factory::RiemannHelicalFit(vector<const DFDCPseudo*>&points){
     double var_u=0.08333;
     double var_v=0.0075;
     double one_over_R2=1./points[m]->xy.Mod2();
-    CRPhi(m,m)=one_over_R2*(var_v*temp1*temp1+var_u*temp2*temp2);
-    CR(m,m)=one_over_R2*(var_u*u*u+var_v*v*v);
+    CRPhi[m]=one_over_R2*(var_v*temp1*temp1+var_u*temp2*temp2);
+    CR[m]=one_over_R2*(var_u*u*u+var_v*v*v);
 
-    XYZ[m].covr=CR(m,m);
-    XYZ[m].covrphi=CRPhi(m,m);
+    XYZ[m].covr=CR[m];
+    XYZ[m].covrphi=CRPhi[m];
   }
   XYZ[last_index].z=TARGET_Z;
-  CR(last_index,last_index)=BEAM_VARIANCE;
-  CRPhi(last_index,last_index)=BEAM_VARIANCE;
+  CR[last_index]=BEAM_VARIANCE;
+  CRPhi[last_index]=BEAM_VARIANCE;
 
   // Reference track:
   jerror_t error=NOERROR;  
@@ -506,11 +483,11 @@ DFDCSegment_factory::RiemannHelicalFit(vector<const DFDCPseudo*>&points){
     // (i.e., the calcuation of the intersection point failed).  Relax the 
     // emphasis on the "target" point and refit.
     for (unsigned int i=0;i<last_index;i++){
-      CR(i,i)=XYZ[i].covr;
-      CRPhi(i,i)=XYZ[i].covrphi;
+      CR[i]=XYZ[i].covr;
+      CRPhi[i]=XYZ[i].covrphi;
     }
-    CRPhi(last_index,last_index)=1e6;
-    CR(last_index,last_index)=1e6;
+    CRPhi[last_index]=1e6;
+    CR[last_index]=1e6;
 
     // First find the center and radius of the projected circle
     error=RiemannCircleFit(points,CRPhi); 
@@ -542,7 +519,7 @@ DFDCSegment_factory::RiemannHelicalFit(vector<const DFDCPseudo*>&points){
     double sperp=rotation_sense*(XYZ[m].z-XYZ[ref_plane].z)/tanl;
     double phi_s=Phi1+sperp/rc;
     DVector2 XY(xc+rc*cos(phi_s),yc+rc*sin(phi_s));
-    chisq0+=(XY-points[m]->xy).Mod2()/CR(m,m);
+    chisq0+=(XY-points[m]->xy).Mod2()/CR[m];
   }
 
   // Preliminary circle fit 
@@ -573,7 +550,7 @@ DFDCSegment_factory::RiemannHelicalFit(vector<const DFDCPseudo*>&points){
     double sperp=rotation_sense*(XYZ[m].z-XYZ[ref_plane].z)/tanl;
     double phi_s=Phi1+sperp/rc;
     DVector2 XY(xc+rc*cos(phi_s),yc+rc*sin(phi_s));
-    chisq_+=(XY-points[m]->xy).Mod2()/CR(m,m);
+    chisq_+=(XY-points[m]->xy).Mod2()/CR[m];
   }
   // If we did not improve the fit, bail from this routine...
   if (chisq_>chisq0){
@@ -613,10 +590,10 @@ DFDCSegment_factory::RiemannHelicalFit(vector<const DFDCPseudo*>&points){
     DVector2 XY(xc+rc*cos(phi_s),yc+rc*sin(phi_s));
 
     if (m<num_measured){
-      chisq+=(XY-points[m]->xy).Mod2()/CR(m,m);
+      chisq+=(XY-points[m]->xy).Mod2()/CR[m];
     }
     else{
-      chisq+=XY.Mod2()/CR(m,m);
+      chisq+=XY.Mod2()/CR[m];
     }
   }
 
@@ -842,8 +819,8 @@ jerror_t DFDCSegment_factory::FindSegments(vector<const DFDCPseudo*>&points){
 
 // Linear regression to find charge
 double DFDCSegment_factory::GetRotationSense(unsigned int n,vector<xyz_t>&XYZ, 
-					     DMatrix &CR, 
-					     DMatrix &CRPhi, 
+					     vector<double> &CR, 
+					     vector<double> &CRPhi, 
 					     vector<const DFDCPseudo *>&points){
   double Phi1=atan2(points[0]->xy.Y()-yc,points[0]->xy.X()-xc);
   double z0=points[0]->wire->origin.z();
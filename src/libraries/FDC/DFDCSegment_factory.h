@@ -15,6 +15,7 @@
 
 #include "HDGEOMETRY/DMagneticFieldMap.h"
 #include "HDGEOMETRY/DLorentzDeflections.h"
+#include "TRACKING/DRiemannFitEngine.h"
 #include <TDecompLU.h>
 #include <DVector2.h>
 
@@ -58,15 +59,17 @@ class DFDCSegment_factory : public JFactory<DFDCSegment> {
   jerror_t GetHelicalTrackPosition(double z,const DFDCSegment *segment,
 				   double &xpos,double &ypos);
   jerror_t RiemannHelicalFit(vector<const DFDCPseudo*>&points);
+  // The R and RPhi covariance matrices are diagonal: only the diagonal
+  // elements are passed around
   jerror_t RiemannCircleFit(vector<const DFDCPseudo*>&points,
-			    DMatrix &CRPhi);
+			    vector<double> &CRPhi);
   jerror_t RiemannLineFit(vector<const DFDCPseudo *>&points,
-			  DMatrix &CR,vector<xyz_t>&XYZ);
+			  vector<double> &CR,vector<xyz_t>&XYZ);
   jerror_t UpdatePositionsAndCovariance(unsigned int n,double r1sq,
-					vector<xyz_t> &XYZ,DMatrix &CRPhi,
-					DMatrix &CR);
-  double GetRotationSense(unsigned int n,vector<xyz_t>&XYZ,DMatrix &CR, 
-			  DMatrix &CRPhi, vector<const DFDCPseudo *>&points);
+					vector<xyz_t> &XYZ,vector<double> &CRPhi,
+					vector<double> &CR);
+  double GetRotationSense(unsigned int n,vector<xyz_t>&XYZ,vector<double> &CR, 
+			  vector<double> &CRPhi, vector<const DFDCPseudo *>&points);
   jerror_t CircleFit(vector<const DFDCPseudo *>&points);
   jerror_t LineFit(vector<const DFDCPseudo *>&points);
   double ComputeCircleChiSq(vector<const DFDCPseudo *>&neighbors);
@@ -112,6 +115,12 @@ class DFDCSegment_factory : public JFactory<DFDCSegment> {
 		int DEBUG_LEVEL;
 
 		int myeventno;
+
+		// Scratch space for the Riemann fits, reused from fit to fit
+		DRiemannFitEngine riemann_engine;
+		vector<xyz_t> fit_XYZ;
+		vector<double> fit_CR,fit_CRPhi;
+		vector<int> fit_bad;
 };
 
 #endif // DFACTORY_DFDCSEGMENT_H
@@ -93,6 +93,7 @@ DEventSourceHDDM::DEventSourceHDDM(const char* source_name)
    geom = NULL;
    
    dRunNumber = -1;
+   dPreparedRunNumber = -1;
 	
    if( (!gPARMS->Exists("JANA_CALIB_CONTEXT")) && (getenv("JANA_CALIB_CONTEXT")==NULL) ){
    		cout << "============================================================" << endl;
@@ -159,6 +160,15 @@ jerror_t DEventSourceHDDM::GetEvent(JEvent &event)
        run_number = pe.getRunNo();
    }
 
+   // Have the resources of a new run built in the background while
+   // the events of the previous one are still being processed
+   if (run_number != dPreparedRunNumber) {
+      dPreparedRunNumber = run_number;
+      DApplication *locApp = dynamic_cast<DApplication*>(japp);
+      if (locApp)
+         locApp->PrepareRun(run_number);
+   }
+
    // Copy the reference info into the JEvent object
    event.SetJEventSource(this);
    event.SetEventNumber(event_number);
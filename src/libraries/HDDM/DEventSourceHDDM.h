@@ -161,6 +161,7 @@ class DEventSourceHDDM:public JEventSource
    private:
       bool initialized;
       int dRunNumber;
+      int dPreparedRunNumber; // last run passed to DApplication::PrepareRun
       static thread_local shared_ptr<DResourcePool<TMatrixFSym>> dResourcePool_TMatrixFSym;
 
       map<unsigned int, double> dTargetCenterZMap; //unsigned int is run number
@@ -44,6 +44,7 @@ DEventSourceREST::DEventSourceREST(const char* source_name)
    }
 
    fin = new hddm_r::istream(*ifs);
+   dPreparedRunNumber = -1;
    
    PRUNE_DUPLICATE_TRACKS = true;
    gPARMS->SetDefaultParameter("REST:PRUNE_DUPLICATE_TRACKS", PRUNE_DUPLICATE_TRACKS, 
@@ -187,6 +188,14 @@ jerror_t DEventSourceREST::GetEvent(JEvent &event)
 
          continue;
       }
+      // Have the resources of a new run built in the background while
+      // the events of the previous one are still being processed
+      if ((int)re.getRunNo() != dPreparedRunNumber) {
+         dPreparedRunNumber = re.getRunNo();
+         DApplication *locApp = dynamic_cast<DApplication*>(japp);
+         if (locApp)
+            locApp->PrepareRun(dPreparedRunNumber);
+      }
       event.SetEventNumber(re.getEventNo());
       event.SetRunNumber(re.getRunNo());
       event.SetJEventSource(this);
@@ -598,10 +607,7 @@ jerror_t DEventSourceREST::Extract_DBeamPhoton(hddm_r::HDDM *record,
 		gamma->setTime(locTAGMiter->getT());
 		gamma->dSystem = SYS_TAGM;
 
-	      auto locCovarianceMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
-	      locCovarianceMatrix->ResizeTo(7, 7);
-	      locCovarianceMatrix->Zero();
-		gamma->setErrorMatrix(locCovarianceMatrix);
+		gamma->setErrorMatrix(DMatrixFSym7()); //zero
 
         tagmGeom->E_to_column(locTAGMiter->getE(), gamma->dCounter);
 		dbeam_photons.push_back(gamma);
@@ -623,10 +629,7 @@ jerror_t DEventSourceREST::Extract_DBeamPhoton(hddm_r::HDDM *record,
 		gamma->setTime(locTAGHiter->getT());
 		gamma->dSystem = SYS_TAGH;
 
-	      auto locCovarianceMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
-	      locCovarianceMatrix->ResizeTo(7, 7);
-	      locCovarianceMatrix->Zero();
-		gamma->setErrorMatrix(locCovarianceMatrix);
+		gamma->setErrorMatrix(DMatrixFSym7()); //zero
 
 		taghGeom->E_to_counter(locTAGHiter->getE(), gamma->dCounter);
 		dbeam_photons.push_back(gamma);
@@ -1196,11 +1199,10 @@ jerror_t DEventSourceREST::Extract_DTrackTimeBased(hddm_r::HDDM *record,
       tra->setTrackingStateVector(vect[0], vect[1], vect[2], vect[3], vect[4]);
 
       // Set the 7x7 covariance matrix.
-      auto loc7x7ErrorMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
-      loc7x7ErrorMatrix->ResizeTo(7, 7);
-	   Get7x7ErrorMatrix(tra->mass(), vect, loc5x5ErrorMatrix.get(), loc7x7ErrorMatrix.get());
+      DMatrixFSym7 loc7x7ErrorMatrix;
+	   Get7x7ErrorMatrix(tra->mass(), vect, loc5x5ErrorMatrix.get(), &loc7x7ErrorMatrix);
+      loc7x7ErrorMatrix(6, 6) = fit.getT0err()*fit.getT0err();
       tra->setErrorMatrix(loc7x7ErrorMatrix);
-      (*loc7x7ErrorMatrix)(6, 6) = fit.getT0err()*fit.getT0err();
 
       // Track parameters at exit of tracking volume
       const hddm_r::ExitParamsList& locExitParamsList = iter->getExitParamses();
@@ -1577,7 +1579,7 @@ jerror_t DEventSourceREST::Extract_DDetectorMatches(JEventLoop* locEventLoop, hd
 // Transform the 5x5 tracking error matrix into a 7x7 error matrix in cartesian
 // coordinates.
 // This was copied and transformed from DKinFit.cc
-void DEventSourceREST::Get7x7ErrorMatrix(double mass, const double vec[5], const TMatrixFSym* C5x5, TMatrixFSym* loc7x7ErrorMatrix)
+void DEventSourceREST::Get7x7ErrorMatrix(double mass, const double vec[5], const TMatrixFSym* C5x5, DMatrixFSym7* loc7x7ErrorMatrix)
 {
   TMatrixF J(7,5);
 
@@ -1612,7 +1614,7 @@ void DEventSourceREST::Get7x7ErrorMatrix(double mass, const double vec[5], const
 
   // C'= JCJ^T
   TMatrixFSym locTempMatrix(*C5x5);
-  *loc7x7ErrorMatrix=locTempMatrix.Similarity(J);
+  loc7x7ErrorMatrix->Set(locTempMatrix.Similarity(J));
 }
 
 uint32_t DEventSourceREST::Convert_SignedIntToUnsigned(int32_t locSignedInt) const
@@ -43,6 +43,7 @@
 
 #include <TMatrixF.h>
 #include <DMatrix.h>
+#include <DMatrixFSym7.h>
 #include <TMath.h>
 
 class DEventSourceREST:public JEventSource
@@ -93,7 +94,7 @@ class DEventSourceREST:public JEventSource
    jerror_t Extract_DDIRCPmtHit(hddm_r::HDDM *record,
                     JFactory<DDIRCPmtHit>* factory, JEventLoop* locEventLoop);
 
-   void Get7x7ErrorMatrix(double mass, const double vec[5], const TMatrixFSym* C5x5, TMatrixFSym* loc7x7ErrorMatrix);
+   void Get7x7ErrorMatrix(double mass, const double vec[5], const TMatrixFSym* C5x5, DMatrixFSym7* loc7x7ErrorMatrix);
  private:
    // Warning: Class JEventSource methods must be re-entrant, so do not
    // store any data here that might change from event to event.
@@ -121,6 +122,7 @@ class DEventSourceREST:public JEventSource
 
    std::ifstream *ifs;		// input hddm file ifstream
    hddm_r::istream *fin;	// provides hddm layer on top of ifstream
+   int dPreparedRunNumber;	// last run passed to DApplication::PrepareRun
 };
 
 #endif //_JEVENT_SOURCEREST_H_
@@ -129,10 +129,7 @@ void DBeamPhoton_factory::Set_BeamPhoton(DBeamPhoton* gamma, const DTAGMHit* hit
     gamma->dSystem = SYS_TAGM;
     gamma->AddAssociatedObject(hit);
 
-	auto locCovarianceMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
-	locCovarianceMatrix->ResizeTo(7, 7);
-	locCovarianceMatrix->Zero();
-	gamma->setErrorMatrix(locCovarianceMatrix);
+	gamma->setErrorMatrix(DMatrixFSym7()); //zero
 }
 
 void DBeamPhoton_factory::Set_BeamPhoton(DBeamPhoton* gamma, const DTAGHHit* hit, uint64_t locEventNumber)
@@ -147,8 +144,5 @@ void DBeamPhoton_factory::Set_BeamPhoton(DBeamPhoton* gamma, const DTAGHHit* hit
     gamma->dSystem = SYS_TAGH;
     gamma->AddAssociatedObject(hit);
 
-	auto locCovarianceMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
-	locCovarianceMatrix->ResizeTo(7, 7);
-	locCovarianceMatrix->Zero();
-	gamma->setErrorMatrix(locCovarianceMatrix);
+	gamma->setErrorMatrix(DMatrixFSym7()); //zero
 }
@@ -22,9 +22,6 @@ class DBeamPhoton_factory:public jana::JFactory<DBeamPhoton>
 		{
 			dResourcePool_BeamPhotons = new DResourcePool<DBeamPhoton>();
 			dResourcePool_BeamPhotons->Set_ControlParams(100, 20, 200, 500, 0);
-
-			dResourcePool_TMatrixFSym = std::make_shared<DResourcePool<TMatrixFSym>>();
-			dResourcePool_TMatrixFSym->Set_ControlParams(20, 20, 50);
 		}
 
 		void Recycle_Resources(vector<const DBeamPhoton*>& locBeams){dResourcePool_BeamPhotons->Recycle(locBeams);}
@@ -58,7 +55,6 @@ class DBeamPhoton_factory:public jana::JFactory<DBeamPhoton>
 		//RESOURCE POOL
 		vector<DBeamPhoton*> dCreated;
 		DResourcePool<DBeamPhoton>* dResourcePool_BeamPhotons = nullptr;
-		shared_ptr<DResourcePool<TMatrixFSym>> dResourcePool_TMatrixFSym;
 
 		// config. parameters
 		double DELTA_T_DOUBLES_MAX;
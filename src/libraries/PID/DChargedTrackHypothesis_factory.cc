@@ -33,8 +33,6 @@ jerror_t DChargedTrackHypothesis_factory::init(void)
 	SetFactoryFlag(NOT_OBJECT_OWNER);
 	dResourcePool_ChargedTrackHypothesis = new DResourcePool<DChargedTrackHypothesis>();
 	dResourcePool_ChargedTrackHypothesis->Set_ControlParams(30, 20, 200, 2000, 0);
-	dResourcePool_TMatrixFSym = std::make_shared<DResourcePool<TMatrixFSym>>();
-	dResourcePool_TMatrixFSym->Set_ControlParams(20, 20, 50);
 	return NOERROR;
 }
 
@@ -99,10 +97,9 @@ DChargedTrackHypothesis* DChargedTrackHypothesis_factory::Create_ChargedTrackHyp
 	locChargedTrackHypothesis->Share_FromInput_Kinematics(static_cast<const DKinematicData*>(locTrackTimeBased));
 	locChargedTrackHypothesis->Set_TrackTimeBased(locTrackTimeBased);
 
-	auto locCovarianceMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
-	locCovarianceMatrix->ResizeTo(7, 7);
+	DMatrixFSym7 locCovarianceMatrix;
 	if(locChargedTrackHypothesis->errorMatrix() != nullptr)
-		*locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix());
+		locCovarianceMatrix = *(locChargedTrackHypothesis->errorMatrix());
 
 	// RF Time
 	if(locEventRFBunch->dTimeSource != SYS_NULL)
@@ -123,8 +120,8 @@ DChargedTrackHypothesis* DChargedTrackHypothesis_factory::Create_ChargedTrackHyp
 //		double locPropagatedTimeUncertainty = sqrt(locSCHitMatchParams->dHitTimeVariance + locSCHitMatchParams->dFlightTimeVariance);
 		double locPropagatedTimeUncertainty = 0.3;
 //		double locFlightTimePCorrelation = locDetectorMatches->Get_FlightTimePCorrelation(locTrackTimeBased, SYS_START); //uncomment when ready!!
-//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, locCovarianceMatrix, locSCHitMatchParams->dFlightTimeVariance, locSCHitMatchParams->dHitTimeVariance, locFlightTimePCorrelation); //uncomment when ready!!
-		(*locCovarianceMatrix)(6, 6) = 0.3*0.3+locSCHitMatchParams->dFlightTimeVariance;
+//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, &locCovarianceMatrix, locSCHitMatchParams->dFlightTimeVariance, locSCHitMatchParams->dHitTimeVariance, locFlightTimePCorrelation); //uncomment when ready!!
+		locCovarianceMatrix(6, 6) = 0.3*0.3+locSCHitMatchParams->dFlightTimeVariance;
 
 		if(locEventRFBunch->dTimeSource == SYS_NULL)
 			locChargedTrackHypothesis->Set_T0(locPropagatedTime, locPropagatedTimeUncertainty, SYS_START); //update when ready
@@ -151,8 +148,8 @@ DChargedTrackHypothesis* DChargedTrackHypothesis_factory::Create_ChargedTrackHyp
 		const DBCALShower* locBCALShower = locBCALShowerMatchParams->dBCALShower;
 		locChargedTrackHypothesis->setTime(locBCALShower->t - locBCALShowerMatchParams->dFlightTime);
 //		double locFlightTimePCorrelation = locDetectorMatches->Get_FlightTimePCorrelation(locTrackTimeBased, SYS_BCAL); //uncomment when ready!!
-//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, locCovarianceMatrix.get(), locBCALShowerMatchParams->dFlightTimeVariance, locBCALShower->tErr()*locBCALShower->tErr(), locFlightTimePCorrelation); //uncomment when ready!!
-		(*locCovarianceMatrix)(6 , 6) = 0.25*0.25+locBCALShowerMatchParams->dFlightTimeVariance;
+//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, &locCovarianceMatrix, locBCALShowerMatchParams->dFlightTimeVariance, locBCALShower->tErr()*locBCALShower->tErr(), locFlightTimePCorrelation); //uncomment when ready!!
+		locCovarianceMatrix(6, 6) = 0.25*0.25+locBCALShowerMatchParams->dFlightTimeVariance;
 	}
 
 	// TOF
@@ -161,8 +158,8 @@ DChargedTrackHypothesis* DChargedTrackHypothesis_factory::Create_ChargedTrackHyp
 		auto locTOFHitMatchParams = locChargedTrackHypothesis->Get_TOFHitMatchParams();
 		locChargedTrackHypothesis->setTime(locTOFHitMatchParams->dHitTime - locTOFHitMatchParams->dFlightTime);
 //		double locFlightTimePCorrelation = locDetectorMatches->Get_FlightTimePCorrelation(locTrackTimeBased, SYS_TOF); //uncomment when ready!!
-//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, locCovarianceMatrix.get(), locTOFHitMatchParams->dFlightTimeVariance, locTOFHitMatchParams->dHitTimeVariance, locFlightTimePCorrelation); //uncomment when ready!!
-		(*locCovarianceMatrix)(6, 6) = 0.1*0.1+locTOFHitMatchParams->dFlightTimeVariance;
+//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, &locCovarianceMatrix, locTOFHitMatchParams->dFlightTimeVariance, locTOFHitMatchParams->dHitTimeVariance, locFlightTimePCorrelation); //uncomment when ready!!
+		locCovarianceMatrix(6, 6) = 0.1*0.1+locTOFHitMatchParams->dFlightTimeVariance;
 	}
 
 	//FCAL
@@ -172,8 +169,8 @@ DChargedTrackHypothesis* DChargedTrackHypothesis_factory::Create_ChargedTrackHyp
 		const DFCALShower* locFCALShower = locFCALShowerMatchParams->dFCALShower;
 		locChargedTrackHypothesis->setTime(locFCALShower->getTime() - locFCALShowerMatchParams->dFlightTime);
 //		double locFlightTimePCorrelation = locDetectorMatches->Get_FlightTimePCorrelation(locTrackTimeBased, SYS_FCAL); //uncomment when ready!!
-//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, locCovarianceMatrix.get(), locFCALShowerMatchParams->dFlightTimeVariance, locFCALShower->dCovarianceMatrix(4, 4), locFlightTimePCorrelation); //uncomment when ready!!
-		(*locCovarianceMatrix)(6, 6) = 0.7*0.7+locFCALShowerMatchParams->dFlightTimeVariance;
+//		Add_TimeToTrackingMatrix(locChargedTrackHypothesis, &locCovarianceMatrix, locFCALShowerMatchParams->dFlightTimeVariance, locFCALShower->dCovarianceMatrix(4, 4), locFlightTimePCorrelation); //uncomment when ready!!
+		locCovarianceMatrix(6, 6) = 0.7*0.7+locFCALShowerMatchParams->dFlightTimeVariance;
 	}
 
 	locChargedTrackHypothesis->setErrorMatrix(locCovarianceMatrix);
@@ -185,7 +182,7 @@ DChargedTrackHypothesis* DChargedTrackHypothesis_factory::Create_ChargedTrackHyp
 	return locChargedTrackHypothesis;
 }
 
-void DChargedTrackHypothesis_factory::Add_TimeToTrackingMatrix(DChargedTrackHypothesis* locChargedTrackHypothesis, TMatrixFSym* locCovarianceMatrix, double locFlightTimeVariance, double locHitTimeVariance, double locFlightTimePCorrelation) const
+void DChargedTrackHypothesis_factory::Add_TimeToTrackingMatrix(DChargedTrackHypothesis* locChargedTrackHypothesis, DMatrixFSym7* locCovarianceMatrix, double locFlightTimeVariance, double locHitTimeVariance, double locFlightTimePCorrelation) const
 {
 	DVector3 locMomentum = locChargedTrackHypothesis->momentum();
 
@@ -0,0 +1,322 @@
+// $Id$
+//
+//    File: DDetectorMatchIndex.cc
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "DDetectorMatchIndex.h"
+#include "DParticleID.h"
+
+#ifndef M_TWO_PI
+#define M_TWO_PI 6.28318530717958647692
+#endif
+
+// Binning. The bins only decide which objects are looked at; the windows
+// themselves are applied exactly in Select().
+static const unsigned int kNumBCALPhiBins = 72; //5 degrees
+static const unsigned int kNumGridCells = 26; //10 cm over +/-130 cm (FCAL & TOF)
+static const double kGridHalfWidth = 130.0;
+
+//------------------
+// DDetectorMatchIndex
+//------------------
+DDetectorMatchIndex::DDetectorMatchIndex(void) :
+dParticleID(NULL), dBCALPhiBins(kNumBCALPhiBins), dFCALGrid(-kGridHalfWidth, kGridHalfWidth, kNumGridCells),
+dFCALShowerZMin(0.0), dFCALShowerZMax(0.0), dTOFGrid(-kGridHalfWidth, kGridHalfWidth, kNumGridCells)
+{
+}
+
+//------------------
+// Reset
+//------------------
+void DDetectorMatchIndex::Reset(const DParticleID* locParticleID, const vector<const DBCALShower*>& locBCALShowers, const vector<const DFCALShower*>& locFCALShowers, const vector<const DTOFPoint*>& locTOFPoints, const vector<const DSCHit*>& locSCHits)
+{
+	dParticleID = locParticleID;
+	const double locInfinity = numeric_limits<double>::infinity();
+
+	//BCAL: phi extent of the shower centroid and all of its points (the match uses the closest of them), z of the centroid
+	dBCALPhiBins.Clear();
+	dBCALExtents.resize(locBCALShowers.size());
+	vector<const DBCALPoint*> locPoints;
+	for(size_t loc_i = 0; loc_i < locBCALShowers.size(); ++loc_i)
+	{
+		const DBCALShower* locBCALShower = locBCALShowers[loc_i];
+		double locPhi0 = DVector3(locBCALShower->x, locBCALShower->y, locBCALShower->z).Phi();
+		double locDeltaPhiMin = 0.0, locDeltaPhiMax = 0.0;
+
+		locParticleID->Get_BCALShowerPoints(locBCALShower, locPoints);
+		for(size_t loc_j = 0; loc_j < locPoints.size(); ++loc_j)
+		{
+			double locDeltaPhi = locPoints[loc_j]->phi() - locPhi0;
+			while(locDeltaPhi > M_PI)
+				locDeltaPhi -= M_TWO_PI;
+			while(locDeltaPhi < -M_PI)
+				locDeltaPhi += M_TWO_PI;
+			locDeltaPhiMin = min(locDeltaPhiMin, locDeltaPhi);
+			locDeltaPhiMax = max(locDeltaPhiMax, locDeltaPhi);
+		}
+
+		DExtent_t& locExtent = dBCALExtents[loc_i];
+		locExtent.dMin1 = locPhi0 + locDeltaPhiMin;
+		locExtent.dMax1 = locPhi0 + locDeltaPhiMax;
+		locExtent.dMin2 = locExtent.dMax2 = locBCALShower->z;
+		dBCALPhiBins.Add(loc_i, locExtent.dMin1, locExtent.dMax1);
+	}
+
+	//FCAL: x-y box of the shower centroid and the hits of its clusters
+	dFCALGrid.Clear();
+	dFCALExtents.resize(locFCALShowers.size());
+	dFCALShowerZMin = locInfinity;
+	dFCALShowerZMax = -locInfinity;
+	for(size_t loc_i = 0; loc_i < locFCALShowers.size(); ++loc_i)
+	{
+		DVector3 locPosition = locFCALShowers[loc_i]->getPosition();
+		dFCALShowerZMin = min(dFCALShowerZMin, locPosition.Z());
+		dFCALShowerZMax = max(dFCALShowerZMax, locPosition.Z());
+
+		DExtent_t& locExtent = dFCALExtents[loc_i];
+		locExtent.dMin1 = locExtent.dMax1 = locPosition.X();
+		locExtent.dMin2 = locExtent.dMax2 = locPosition.Y();
+
+		vector<const DFCALCluster*> locClusters;
+		locFCALShowers[loc_i]->Get(locClusters);
+		for(size_t loc_j = 0; loc_j < locClusters.size(); ++loc_j)
+		{
+			const vector<DFCALCluster::DFCALClusterHit_t> locHits = locClusters[loc_j]->GetHits();
+			for(size_t loc_k = 0; loc_k < locHits.size(); ++loc_k)
+			{
+				locExtent.dMin1 = min(locExtent.dMin1, double(locHits[loc_k].x));
+				locExtent.dMax1 = max(locExtent.dMax1, double(locHits[loc_k].x));
+				locExtent.dMin2 = min(locExtent.dMin2, double(locHits[loc_k].y));
+				locExtent.dMax2 = max(locExtent.dMax2, double(locHits[loc_k].y));
+			}
+		}
+		dFCALGrid.Add(loc_i, locExtent.dMin1, locExtent.dMax1, locExtent.dMin2, locExtent.dMax2);
+	}
+
+	//TOF: a coordinate that is not well-defined is not cut on, so it spans everything
+	dTOFGrid.Clear();
+	dTOFExtents.resize(locTOFPoints.size());
+	for(size_t loc_i = 0; loc_i < locTOFPoints.size(); ++loc_i)
+	{
+		const DTOFPoint* locTOFPoint = locTOFPoints[loc_i];
+		DExtent_t& locExtent = dTOFExtents[loc_i];
+		bool locXDefined = locTOFPoint->Is_XPositionWellDefined();
+		bool locYDefined = locTOFPoint->Is_YPositionWellDefined();
+		locExtent.dMin1 = locXDefined ? locTOFPoint->pos.X() : -locInfinity;
+		locExtent.dMax1 = locXDefined ? locTOFPoint->pos.X() : locInfinity;
+		locExtent.dMin2 = locYDefined ? locTOFPoint->pos.Y() : -locInfinity;
+		locExtent.dMax2 = locYDefined ? locTOFPoint->pos.Y() : locInfinity;
+		dTOFGrid.Add(loc_i, locExtent.dMin1, locExtent.dMax1, locExtent.dMin2, locExtent.dMax2);
+	}
+
+	//SC: by sector
+	for(size_t loc_i = 0; loc_i < dSCHitsBySector.size(); ++loc_i)
+		dSCHitsBySector[loc_i].clear();
+	for(size_t loc_i = 0; loc_i < locSCHits.size(); ++loc_i)
+	{
+		size_t locSector = (locSCHits[loc_i]->sector > 0) ? locSCHits[loc_i]->sector : 0;
+		if(locSector >= dSCHitsBySector.size())
+			dSCHitsBySector.resize(locSector + 1);
+		dSCHitsBySector[locSector].push_back(loc_i);
+	}
+}
+
+//------------------
+// Get_BCALCandidates
+//------------------
+void DDetectorMatchIndex::Get_BCALCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, vector<size_t>& locCandidates) const
+{
+	locCandidates.clear();
+	double locPhiMin, locPhiMax, locZMin, locZMax;
+	if(!dParticleID->Get_BCALMatchWindow(extrapolations, locPhiMin, locPhiMax, locZMin, locZMax))
+		return;
+
+	dBCALPhiBins.Get(locPhiMin, locPhiMax, dScratch);
+
+	//the bins select in phi (to within the bin size), the z window is applied here
+	for(size_t loc_i = 0; loc_i < dScratch.size(); ++loc_i)
+	{
+		const DExtent_t& locExtent = dBCALExtents[dScratch[loc_i]];
+		if((locExtent.dMax2 < locZMin) || (locExtent.dMin2 > locZMax))
+			continue;
+		locCandidates.push_back(dScratch[loc_i]);
+	}
+}
+
+//------------------
+// Get_FCALCandidates
+//------------------
+void DDetectorMatchIndex::Get_FCALCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, vector<size_t>& locCandidates) const
+{
+	locCandidates.clear();
+	if(dFCALExtents.empty())
+		return;
+	double locXMin, locXMax, locYMin, locYMax;
+	if(!dParticleID->Get_FCALMatchWindow(extrapolations, dFCALShowerZMin, dFCALShowerZMax, locXMin, locXMax, locYMin, locYMax))
+		return;
+
+	dFCALGrid.Get(locXMin, locXMax, locYMin, locYMax, dScratch);
+	Select(dFCALExtents, dScratch, locXMin, locXMax, locYMin, locYMax);
+	locCandidates.swap(dScratch);
+}
+
+//------------------
+// Get_TOFCandidates
+//------------------
+void DDetectorMatchIndex::Get_TOFCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, vector<size_t>& locCandidates) const
+{
+	locCandidates.clear();
+	if(dTOFExtents.empty())
+		return;
+	double locXMin, locXMax, locYMin, locYMax;
+	if(!dParticleID->Get_TOFMatchWindow(extrapolations, locXMin, locXMax, locYMin, locYMax))
+		return;
+
+	dTOFGrid.Get(locXMin, locXMax, locYMin, locYMax, dScratch);
+	Select(dTOFExtents, dScratch, locXMin, locXMax, locYMin, locYMax);
+	locCandidates.swap(dScratch);
+}
+
+//------------------
+// Get_SCCandidates
+//------------------
+void DDetectorMatchIndex::Get_SCCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, bool locIsTimeBased, vector<size_t>& locCandidates) const
+{
+	locCandidates.clear();
+	for(size_t locSector = 0; locSector < dSCHitsBySector.size(); ++locSector)
+	{
+		const vector<size_t>& locHits = dSCHitsBySector[locSector];
+		if(locHits.empty())
+			continue;
+		if(!dParticleID->Cut_MatchSCSector(extrapolations, locSector, locIsTimeBased))
+			continue;
+		locCandidates.insert(locCandidates.end(), locHits.begin(), locHits.end());
+	}
+	sort(locCandidates.begin(), locCandidates.end());
+}
+
+//------------------
+// Select
+//------------------
+void DDetectorMatchIndex::Select(const vector<DExtent_t>& locExtents, vector<size_t>& locIndices, double locMin1, double locMax1, double locMin2, double locMax2) const
+{
+	//keep only the objects whose extent overlaps the window (in place, order preserved)
+	size_t locNumKept = 0;
+	for(size_t loc_i = 0; loc_i < locIndices.size(); ++loc_i)
+	{
+		const DExtent_t& locExtent = locExtents[locIndices[loc_i]];
+		if((locExtent.dMax1 < locMin1) || (locExtent.dMin1 > locMax1))
+			continue;
+		if((locExtent.dMax2 < locMin2) || (locExtent.dMin2 > locMax2))
+			continue;
+		locIndices[locNumKept++] = locIndices[loc_i];
+	}
+	locIndices.resize(locNumKept);
+}
+
+/******************************************************************** PHI BINS ********************************************************************/
+
+DDetectorMatchIndex::DPhiBins::DPhiBins(unsigned int locNumBins) : dBins(locNumBins) {}
+
+void DDetectorMatchIndex::DPhiBins::Clear(void)
+{
+	for(size_t loc_i = 0; loc_i < dBins.size(); ++loc_i)
+		dBins[loc_i].clear();
+}
+
+void DDetectorMatchIndex::DPhiBins::Get_BinRange(double locPhiMin, double locPhiMax, int& locFirstBin, int& locNumBins) const
+{
+	int locTotalBins = dBins.size();
+	double locBinWidth = M_TWO_PI/locTotalBins;
+	if(!(locPhiMax - locPhiMin < M_TWO_PI - locBinWidth)) //includes NaN
+	{
+		locFirstBin = 0;
+		locNumBins = locTotalBins;
+		return;
+	}
+	int locLow = int(floor(locPhiMin/locBinWidth));
+	int locHigh = int(floor(locPhiMax/locBinWidth));
+	locNumBins = min(locHigh - locLow + 1, locTotalBins);
+	locFirstBin = ((locLow % locTotalBins) + locTotalBins) % locTotalBins;
+}
+
+void DDetectorMatchIndex::DPhiBins::Add(size_t locIndex, double locPhiMin, double locPhiMax)
+{
+	int locFirstBin, locNumBins;
+	Get_BinRange(locPhiMin, locPhiMax, locFirstBin, locNumBins);
+	for(int loc_i = 0; loc_i < locNumBins; ++loc_i)
+		dBins[(locFirstBin + loc_i) % dBins.size()].push_back(locIndex);
+}
+
+void DDetectorMatchIndex::DPhiBins::Get(double locPhiMin, double locPhiMax, vector<size_t>& locIndices) const
+{
+	locIndices.clear();
+	int locFirstBin, locNumBins;
+	Get_BinRange(locPhiMin, locPhiMax, locFirstBin, locNumBins);
+	for(int loc_i = 0; loc_i < locNumBins; ++loc_i)
+	{
+		const vector<size_t>& locBin = dBins[(locFirstBin + loc_i) % dBins.size()];
+		locIndices.insert(locIndices.end(), locBin.begin(), locBin.end());
+	}
+	sort(locIndices.begin(), locIndices.end());
+	locIndices.erase(unique(locIndices.begin(), locIndices.end()), locIndices.end());
+}
+
+/******************************************************************** X-Y GRID ********************************************************************/
+
+DDetectorMatchIndex::DGrid2D::DGrid2D(double locMin, double locMax, unsigned int locNumCells) :
+dMin(locMin), dCellSize((locMax - locMin)/locNumCells), dNumCells(locNumCells), dCells(locNumCells*locNumCells) {}
+
+void DDetectorMatchIndex::DGrid2D::Clear(void)
+{
+	for(size_t loc_i = 0; loc_i < dCells.size(); ++loc_i)
+		dCells[loc_i].clear();
+}
+
+unsigned int DDetectorMatchIndex::DGrid2D::Get_Cell(double locValue) const
+{
+	//clamp before converting: out-of-range, infinite and NaN values land in the edge cells
+	double locCell = floor((locValue - dMin)/dCellSize);
+	if(!(locCell > 0.0))
+		return 0;
+	if(!(locCell < double(dNumCells - 1)))
+		return dNumCells - 1;
+	return (unsigned int)locCell;
+}
+
+void DDetectorMatchIndex::DGrid2D::Add(size_t locIndex, double locXMin, double locXMax, double locYMin, double locYMax)
+{
+	unsigned int locXLow = Get_Cell(locXMin), locXHigh = Get_Cell(locXMax);
+	unsigned int locYLow = Get_Cell(locYMin), locYHigh = Get_Cell(locYMax);
+	for(unsigned int locX = locXLow; locX <= locXHigh; ++locX)
+	{
+		for(unsigned int locY = locYLow; locY <= locYHigh; ++locY)
+			dCells[locX*dNumCells + locY].push_back(locIndex);
+	}
+}
+
+void DDetectorMatchIndex::DGrid2D::Get(double locXMin, double locXMax, double locYMin, double locYMax, vector<size_t>& locIndices) const
+{
+	locIndices.clear();
+	if(!(locXMin <= locXMax) || !(locYMin <= locYMax))
+	{
+		//NaN window: return everything
+		locXMin = locYMin = -numeric_limits<double>::infinity();
+		locXMax = locYMax = numeric_limits<double>::infinity();
+	}
+	unsigned int locXLow = Get_Cell(locXMin), locXHigh = Get_Cell(locXMax);
+	unsigned int locYLow = Get_Cell(locYMin), locYHigh = Get_Cell(locYMax);
+	for(unsigned int locX = locXLow; locX <= locXHigh; ++locX)
+	{
+		for(unsigned int locY = locYLow; locY <= locYHigh; ++locY)
+		{
+			const vector<size_t>& locCell = dCells[locX*dNumCells + locY];
+			locIndices.insert(locIndices.end(), locCell.begin(), locCell.end());
+		}
+	}
+	sort(locIndices.begin(), locIndices.end());
+	locIndices.erase(unique(locIndices.begin(), locIndices.end()), locIndices.end());
+}
@@ -0,0 +1,121 @@
+// $Id$
+//
+//    File: DDetectorMatchIndex.h
+//
+
+#ifndef _DDetectorMatchIndex_
+#define _DDetectorMatchIndex_
+
+#include <vector>
+#include <limits>
+
+#include <JANA/JApplication.h>
+#include <TRACKING/DTrackFitter.h>
+#include <BCAL/DBCALShower.h>
+#include <FCAL/DFCALShower.h>
+#include <TOF/DTOFPoint.h>
+#include <START_COUNTER/DSCHit.h>
+
+using namespace std;
+using namespace jana;
+
+class DParticleID;
+
+/// Per-event spatial index of the showers/hits that tracks are matched to
+/// in DDetectorMatches_factory. BCAL showers are binned in phi (and cut in
+/// z), FCAL showers and TOF points in an x-y grid, and SC hits are grouped
+/// by sector. For a track, the Get_*Candidates() methods return the indices
+/// (ascending, i.e. in the original order) of the objects that can pass the
+/// corresponding DParticleID::Cut_MatchDistance(); the windows come from
+/// DParticleID so they follow the same cut parameters. Everything else is
+/// guaranteed to fail the cut and is skipped.
+
+class DDetectorMatchIndex
+{
+	public:
+
+		DDetectorMatchIndex(void);
+
+		void Reset(const DParticleID* locParticleID, const vector<const DBCALShower*>& locBCALShowers, const vector<const DFCALShower*>& locFCALShowers, const vector<const DTOFPoint*>& locTOFPoints, const vector<const DSCHit*>& locSCHits);
+
+		void Get_BCALCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, vector<size_t>& locCandidates) const;
+		void Get_FCALCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, vector<size_t>& locCandidates) const;
+		void Get_TOFCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, vector<size_t>& locCandidates) const;
+		void Get_SCCandidates(const vector<DTrackFitter::Extrapolation_t>& extrapolations, bool locIsTimeBased, vector<size_t>& locCandidates) const;
+
+		// Debugging aid: report objects outside the candidate list that do pass the cut
+		template <typename DType, typename DCutFunctor>
+		void Check_Candidates(const char* locSystem, const vector<const DType*>& locObjects, const vector<size_t>& locCandidates, DCutFunctor locCut) const;
+
+	private:
+
+		// Extent of an object in the binned coordinates
+		struct DExtent_t
+		{
+			double dMin1, dMax1, dMin2, dMax2;
+		};
+
+		// Items are entered in every phi bin their extent touches
+		class DPhiBins
+		{
+			public:
+				DPhiBins(unsigned int locNumBins);
+				void Clear(void);
+				void Add(size_t locIndex, double locPhiMin, double locPhiMax);
+				void Get(double locPhiMin, double locPhiMax, vector<size_t>& locIndices) const;
+			private:
+				void Get_BinRange(double locPhiMin, double locPhiMax, int& locFirstBin, int& locNumBins) const;
+				vector<vector<size_t> > dBins;
+		};
+
+		// Items are entered in every cell their x-y box touches; out-of-range
+		// coordinates fall into the edge cells
+		class DGrid2D
+		{
+			public:
+				DGrid2D(double locMin, double locMax, unsigned int locNumCells);
+				void Clear(void);
+				void Add(size_t locIndex, double locXMin, double locXMax, double locYMin, double locYMax);
+				void Get(double locXMin, double locXMax, double locYMin, double locYMax, vector<size_t>& locIndices) const;
+			private:
+				unsigned int Get_Cell(double locValue) const;
+				double dMin, dCellSize;
+				unsigned int dNumCells;
+				vector<vector<size_t> > dCells;
+		};
+
+		void Select(const vector<DExtent_t>& locExtents, vector<size_t>& locIndices, double locMin1, double locMax1, double locMin2, double locMax2) const;
+
+		const DParticleID* dParticleID;
+
+		DPhiBins dBCALPhiBins;
+		vector<DExtent_t> dBCALExtents; //phi, z
+
+		DGrid2D dFCALGrid;
+		vector<DExtent_t> dFCALExtents; //x, y
+		double dFCALShowerZMin, dFCALShowerZMax;
+
+		DGrid2D dTOFGrid;
+		vector<DExtent_t> dTOFExtents; //x, y
+
+		vector<vector<size_t> > dSCHitsBySector;
+
+		mutable vector<size_t> dScratch;
+};
+
+template <typename DType, typename DCutFunctor>
+void DDetectorMatchIndex::Check_Candidates(const char* locSystem, const vector<const DType*>& locObjects, const vector<size_t>& locCandidates, DCutFunctor locCut) const
+{
+	size_t locCandidate = 0;
+	for(size_t loc_i = 0; loc_i < locObjects.size(); ++loc_i)
+	{
+		while((locCandidate < locCandidates.size()) && (locCandidates[locCandidate] < loc_i))
+			++locCandidate;
+		if((locCandidate < locCandidates.size()) && (locCandidates[locCandidate] == loc_i))
+			continue;
+		if(locCut(locObjects[loc_i]))
+			jerr << "DDetectorMatchIndex: " << locSystem << " match " << loc_i << " is outside of the search window!" << endl;
+	}
+}
+
+#endif // _DDetectorMatchIndex_
@@ -7,6 +7,18 @@
 
 #include "DDetectorMatches_factory.h"
 
+//------------------
+// DDetectorMatches_factory
+//------------------
+DDetectorMatches_factory::DDetectorMatches_factory(void)
+{
+	//read here rather than in brun(): the "Combo" factory calls Create_DDetectorMatches directly
+	dUseMatchIndexFlag = true;
+	gPARMS->SetDefaultParameter("PID:USE_MATCH_INDEX", dUseMatchIndexFlag, "Only try to match tracks to the showers/hits in a spatial window around the track projection (default true)");
+	dCheckMatchIndexFlag = false;
+	gPARMS->SetDefaultParameter("PID:CHECK_MATCH_INDEX", dCheckMatchIndexFlag, "Debug: also try all showers/hits outside of the window and report any that match (default false)");
+}
+
 //------------------
 // init
 //------------------
@@ -63,6 +75,8 @@ DDetectorMatches* DDetectorMatches_factory::Create_DDetectorMatches(jana::JEvent
 	locEventLoop->Get(locDIRCBarHits);
 
 	DDetectorMatches* locDetectorMatches = new DDetectorMatches();
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Reset(locParticleID, locBCALShowers, locFCALShowers, locTOFPoints, locSCHits);
 
 	//Match tracks to showers/hits
 	for(size_t loc_i = 0; loc_i < locTrackTimeBasedVector.size(); ++loc_i)
@@ -105,57 +119,113 @@ DDetectorMatches* DDetectorMatches_factory::Create_DDetectorMatches(jana::JEvent
 
 void DDetectorMatches_factory::MatchToBCAL(const DParticleID* locParticleID, const DTrackTimeBased* locTrackTimeBased, const vector<const DBCALShower*>& locBCALShowers, DDetectorMatches* locDetectorMatches) const
 {
-  vector<DTrackFitter::Extrapolation_t>extrapolations=locTrackTimeBased->extrapolations.at(SYS_BCAL);
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackTimeBased->extrapolations.at(SYS_BCAL);
 	if (extrapolations.size()==0) return;
 
 	double locInputStartTime = locTrackTimeBased->t0();
-	for(size_t loc_i = 0; loc_i < locBCALShowers.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_BCALCandidates(extrapolations, dCandidates);
+	else
+		Get_Candidates(locBCALShowers.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
 	{
+	  const DBCALShower* locBCALShower = locBCALShowers[dCandidates[loc_i]];
 	  shared_ptr<DBCALShowerMatchParams> locShowerMatchParams;
-	  if(locParticleID->Cut_MatchDistance(extrapolations, locBCALShowers[loc_i], locInputStartTime, locShowerMatchParams))
-	    locDetectorMatches->Add_Match(locTrackTimeBased, locBCALShowers[loc_i], locShowerMatchParams);
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locBCALShower, locInputStartTime, locShowerMatchParams))
+	    locDetectorMatches->Add_Match(locTrackTimeBased, locBCALShower, locShowerMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
+	{
+		dMatchIndex.Check_Candidates("BCAL", locBCALShowers, dCandidates, [&](const DBCALShower* locBCALShower) -> bool
+		{
+			shared_ptr<DBCALShowerMatchParams> locShowerMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locBCALShower, locInputStartTime, locShowerMatchParams);
+		});
 	}
 }
 
 void DDetectorMatches_factory::MatchToTOF(const DParticleID* locParticleID, const DTrackTimeBased* locTrackTimeBased, const vector<const DTOFPoint*>& locTOFPoints, DDetectorMatches* locDetectorMatches) const
 {
-  vector<DTrackFitter::Extrapolation_t> extrapolations=locTrackTimeBased->extrapolations.at(SYS_TOF);
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackTimeBased->extrapolations.at(SYS_TOF);
 	if (extrapolations.size()==0) return;
 
 	double locInputStartTime = locTrackTimeBased->t0();
-	for(size_t loc_i = 0; loc_i < locTOFPoints.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_TOFCandidates(extrapolations, dCandidates);
+	else
+		Get_Candidates(locTOFPoints.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
 	{
+	  const DTOFPoint* locTOFPoint = locTOFPoints[dCandidates[loc_i]];
 	  shared_ptr<DTOFHitMatchParams> locTOFHitMatchParams;
-	  if(locParticleID->Cut_MatchDistance(extrapolations, locTOFPoints[loc_i], locInputStartTime, locTOFHitMatchParams))
-	    locDetectorMatches->Add_Match(locTrackTimeBased, locTOFPoints[loc_i], locTOFHitMatchParams);
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locTOFPoint, locInputStartTime, locTOFHitMatchParams))
+	    locDetectorMatches->Add_Match(locTrackTimeBased, locTOFPoint, locTOFHitMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
+	{
+		dMatchIndex.Check_Candidates("TOF", locTOFPoints, dCandidates, [&](const DTOFPoint* locTOFPoint) -> bool
+		{
+			shared_ptr<DTOFHitMatchParams> locTOFHitMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locTOFPoint, locInputStartTime, locTOFHitMatchParams);
+		});
 	}
 }
 
 void DDetectorMatches_factory::MatchToFCAL(const DParticleID* locParticleID, const DTrackTimeBased* locTrackTimeBased, const vector<const DFCALShower*>& locFCALShowers, DDetectorMatches* locDetectorMatches) const
 {
-  vector<DTrackFitter::Extrapolation_t> extrapolations=locTrackTimeBased->extrapolations.at(SYS_FCAL);
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackTimeBased->extrapolations.at(SYS_FCAL);
 	if (extrapolations.size()==0) return;
 
 	double locInputStartTime = locTrackTimeBased->t0();
-	for(size_t loc_i = 0; loc_i < locFCALShowers.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_FCALCandidates(extrapolations, dCandidates);
+	else
+		Get_Candidates(locFCALShowers.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
+	{
+	  const DFCALShower* locFCALShower = locFCALShowers[dCandidates[loc_i]];
+	  shared_ptr<DFCALShowerMatchParams> locShowerMatchParams;
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locFCALShower, locInputStartTime, locShowerMatchParams))
+	    locDetectorMatches->Add_Match(locTrackTimeBased, locFCALShower, locShowerMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
 	{
-	  shared_ptr<DFCALShowerMatchParams>locShowerMatchParams;
-	  if(locParticleID->Cut_MatchDistance(extrapolations, locFCALShowers[loc_i], locInputStartTime, locShowerMatchParams))
-	    locDetectorMatches->Add_Match(locTrackTimeBased, locFCALShowers[loc_i], locShowerMatchParams);
+		dMatchIndex.Check_Candidates("FCAL", locFCALShowers, dCandidates, [&](const DFCALShower* locFCALShower) -> bool
+		{
+			shared_ptr<DFCALShowerMatchParams> locShowerMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locFCALShower, locInputStartTime, locShowerMatchParams);
+		});
 	}
 }
 
 void DDetectorMatches_factory::MatchToSC(const DParticleID* locParticleID, const DTrackTimeBased* locTrackTimeBased, const vector<const DSCHit*>& locSCHits, DDetectorMatches* locDetectorMatches) const
 {
-  vector<DTrackFitter::Extrapolation_t> extrapolations=locTrackTimeBased->extrapolations.at(SYS_START);
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackTimeBased->extrapolations.at(SYS_START);
 	if (extrapolations.size()==0) return;
 
 	double locInputStartTime = locTrackTimeBased->t0();
-	for(size_t loc_i = 0; loc_i < locSCHits.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_SCCandidates(extrapolations, true, dCandidates);
+	else
+		Get_Candidates(locSCHits.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
 	{
-	    shared_ptr<DSCHitMatchParams>locSCHitMatchParams;
-	    if(locParticleID->Cut_MatchDistance(extrapolations, locSCHits[loc_i], locInputStartTime, locSCHitMatchParams, true))
-	      locDetectorMatches->Add_Match(locTrackTimeBased, locSCHits[loc_i], locSCHitMatchParams);
+	  const DSCHit* locSCHit = locSCHits[dCandidates[loc_i]];
+	  shared_ptr<DSCHitMatchParams> locSCHitMatchParams;
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locSCHit, locInputStartTime, locSCHitMatchParams, true))
+	    locDetectorMatches->Add_Match(locTrackTimeBased, locSCHit, locSCHitMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
+	{
+		dMatchIndex.Check_Candidates("SC", locSCHits, dCandidates, [&](const DSCHit* locSCHit) -> bool
+		{
+			shared_ptr<DSCHitMatchParams> locSCHitMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locSCHit, locInputStartTime, locSCHitMatchParams, true);
+		});
 	}
 }
 
@@ -185,7 +255,7 @@ void DDetectorMatches_factory::MatchToTrack(const DParticleID* locParticleID, co
 		shared_ptr<DBCALShowerMatchParams> locShowerMatchParams;
 		double locInputStartTime = locTrackTimeBasedVector[loc_i]->t0();
 		
-		map<DetectorSystem_t,vector<DTrackFitter::Extrapolation_t> >extrapolations=locTrackTimeBasedVector[loc_i]->extrapolations;
+		const map<DetectorSystem_t,vector<DTrackFitter::Extrapolation_t> >& extrapolations=locTrackTimeBasedVector[loc_i]->extrapolations;
 		if (extrapolations.size()==0) continue;
 
 		if(!locParticleID->Distance_ToTrack(extrapolations.at(SYS_BCAL), locBCALShower, locInputStartTime, locShowerMatchParams))
@@ -210,7 +280,7 @@ void DDetectorMatches_factory::MatchToTrack(const DParticleID* locParticleID, co
 	double locMinDistance = 999.0;
 	for(size_t loc_i = 0; loc_i < locTrackTimeBasedVector.size(); ++loc_i)
 	{
-	  map<DetectorSystem_t,vector<DTrackFitter::Extrapolation_t> >extrapolations=locTrackTimeBasedVector[loc_i]->extrapolations;
+	  const map<DetectorSystem_t,vector<DTrackFitter::Extrapolation_t> >& extrapolations=locTrackTimeBasedVector[loc_i]->extrapolations;
 	  if (extrapolations.size()==0) return;
 
 	  shared_ptr<DFCALShowerMatchParams> locShowerMatchParams;
@@ -222,3 +292,11 @@ void DDetectorMatches_factory::MatchToTrack(const DParticleID* locParticleID, co
 	}
 	locDetectorMatches->Set_DistanceToNearestTrack(locFCALShower, locMinDistance);
 }
+
+void DDetectorMatches_factory::Get_Candidates(size_t locNumObjects, vector<size_t>& locCandidates) const
+{
+	//no index: try everything
+	locCandidates.resize(locNumObjects);
+	for(size_t loc_i = 0; loc_i < locNumObjects; ++loc_i)
+		locCandidates[loc_i] = loc_i;
+}
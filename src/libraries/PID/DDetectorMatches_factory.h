@@ -16,6 +16,7 @@
 #include <PID/DDetectorMatches.h>
 #include <TRACKING/DTrackTimeBased.h>
 #include <PID/DParticleID.h>
+#include <PID/DDetectorMatchIndex.h>
 #include <TOF/DTOFPoint.h>
 #include <BCAL/DBCALShower.h>
 #include <FCAL/DFCALShower.h>
@@ -29,7 +30,7 @@ using namespace jana;
 class DDetectorMatches_factory : public jana::JFactory<DDetectorMatches>
 {
 	public:
-		DDetectorMatches_factory(){};
+		DDetectorMatches_factory(void);
 		~DDetectorMatches_factory(){};
 
 		//called by DDetectorMatches tag=Combo factory
@@ -50,6 +51,14 @@ class DDetectorMatches_factory : public jana::JFactory<DDetectorMatches>
 		//matching showers to tracks routines
 		void MatchToTrack(const DParticleID* locParticleID, const DBCALShower* locBCALShower, const vector<const DTrackTimeBased*>& locTrackTimeBasedVector, DDetectorMatches* locDetectorMatches) const;
 		void MatchToTrack(const DParticleID* locParticleID, const DFCALShower* locFCALShower, const vector<const DTrackTimeBased*>& locTrackTimeBasedVector, DDetectorMatches* locDetectorMatches) const;
+
+		void Get_Candidates(size_t locNumObjects, vector<size_t>& locCandidates) const;
+
+		//spatial index of the event's showers/hits: only objects that can pass the match cuts are tried
+		DDetectorMatchIndex dMatchIndex;
+		bool dUseMatchIndexFlag;
+		bool dCheckMatchIndexFlag;
+		mutable vector<size_t> dCandidates;
 };
 
 #endif // _DDetectorMatches_factory_
@@ -7,6 +7,18 @@
 
 #include "DDetectorMatches_factory_WireBased.h"
 
+//------------------
+// DDetectorMatches_factory_WireBased
+//------------------
+DDetectorMatches_factory_WireBased::DDetectorMatches_factory_WireBased(void)
+{
+	//read here rather than in brun(): the "Combo" factory calls Create_DDetectorMatches directly
+	dUseMatchIndexFlag = true;
+	gPARMS->SetDefaultParameter("PID:USE_MATCH_INDEX", dUseMatchIndexFlag, "Only try to match tracks to the showers/hits in a spatial window around the track projection (default true)");
+	dCheckMatchIndexFlag = false;
+	gPARMS->SetDefaultParameter("PID:CHECK_MATCH_INDEX", dCheckMatchIndexFlag, "Debug: also try all showers/hits outside of the window and report any that match (default false)");
+}
+
 //------------------
 // init
 //------------------
@@ -56,6 +68,8 @@ DDetectorMatches* DDetectorMatches_factory_WireBased::Create_DDetectorMatches(ja
 	locEventLoop->Get(locBCALShowers);
 
 	DDetectorMatches* locDetectorMatches = new DDetectorMatches();
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Reset(locParticleID, locBCALShowers, locFCALShowers, locTOFPoints, locSCHits);
 
 	//Match tracks to showers/hits
 	for(size_t loc_i = 0; loc_i < locTrackWireBasedVector.size(); ++loc_i)
@@ -97,50 +111,107 @@ DDetectorMatches* DDetectorMatches_factory_WireBased::Create_DDetectorMatches(ja
 
 void DDetectorMatches_factory_WireBased::MatchToBCAL(const DParticleID* locParticleID, const DTrackWireBased* locTrackWireBased, const vector<const DBCALShower*>& locBCALShowers, DDetectorMatches* locDetectorMatches) const
 {
-  if (locTrackWireBased->extrapolations.at(SYS_BCAL).size()==0) return;
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackWireBased->extrapolations.at(SYS_BCAL);
+	if (extrapolations.size()==0) return;
 
 	double locInputStartTime = locTrackWireBased->t0();
-	for(size_t loc_i = 0; loc_i < locBCALShowers.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_BCALCandidates(extrapolations, dCandidates);
+	else
+		Get_Candidates(locBCALShowers.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
 	{
-	  shared_ptr<DBCALShowerMatchParams>locShowerMatchParams;
-	  if(locParticleID->Cut_MatchDistance(locTrackWireBased->extrapolations.at(SYS_BCAL), locBCALShowers[loc_i], locInputStartTime, locShowerMatchParams))
-	    locDetectorMatches->Add_Match(locTrackWireBased, locBCALShowers[loc_i], locShowerMatchParams);
+	  const DBCALShower* locBCALShower = locBCALShowers[dCandidates[loc_i]];
+	  shared_ptr<DBCALShowerMatchParams> locShowerMatchParams;
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locBCALShower, locInputStartTime, locShowerMatchParams))
+	    locDetectorMatches->Add_Match(locTrackWireBased, locBCALShower, locShowerMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
+	{
+		dMatchIndex.Check_Candidates("BCAL", locBCALShowers, dCandidates, [&](const DBCALShower* locBCALShower) -> bool
+		{
+			shared_ptr<DBCALShowerMatchParams> locShowerMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locBCALShower, locInputStartTime, locShowerMatchParams);
+		});
 	}
 }
 
 void DDetectorMatches_factory_WireBased::MatchToTOF(const DParticleID* locParticleID, const DTrackWireBased* locTrackWireBased, const vector<const DTOFPoint*>& locTOFPoints, DDetectorMatches* locDetectorMatches) const
 {
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackWireBased->extrapolations.at(SYS_TOF);
 	double locInputStartTime = locTrackWireBased->t0();
-	const vector<DTrackFitter::Extrapolation_t>extrapolations=locTrackWireBased->extrapolations.at(SYS_TOF);
-	for(size_t loc_i = 0; loc_i < locTOFPoints.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_TOFCandidates(extrapolations, dCandidates);
+	else
+		Get_Candidates(locTOFPoints.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
+	{
+	  const DTOFPoint* locTOFPoint = locTOFPoints[dCandidates[loc_i]];
+	  shared_ptr<DTOFHitMatchParams> locTOFHitMatchParams;
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locTOFPoint, locInputStartTime, locTOFHitMatchParams))
+	    locDetectorMatches->Add_Match(locTrackWireBased, locTOFPoint, locTOFHitMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
 	{
-	  shared_ptr<DTOFHitMatchParams>locTOFHitMatchParams;
-	  if(locParticleID->Cut_MatchDistance(extrapolations, locTOFPoints[loc_i], locInputStartTime, locTOFHitMatchParams))
-	    locDetectorMatches->Add_Match(locTrackWireBased, locTOFPoints[loc_i], locTOFHitMatchParams);
+		dMatchIndex.Check_Candidates("TOF", locTOFPoints, dCandidates, [&](const DTOFPoint* locTOFPoint) -> bool
+		{
+			shared_ptr<DTOFHitMatchParams> locTOFHitMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locTOFPoint, locInputStartTime, locTOFHitMatchParams);
+		});
 	}
 }
 
 void DDetectorMatches_factory_WireBased::MatchToFCAL(const DParticleID* locParticleID, const DTrackWireBased* locTrackWireBased, const vector<const DFCALShower*>& locFCALShowers, DDetectorMatches* locDetectorMatches) const
 {
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackWireBased->extrapolations.at(SYS_FCAL);
 	double locInputStartTime = locTrackWireBased->t0();
-	const vector<DTrackFitter::Extrapolation_t>extrapolations=locTrackWireBased->extrapolations.at(SYS_FCAL);
-	for(size_t loc_i = 0; loc_i < locFCALShowers.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_FCALCandidates(extrapolations, dCandidates);
+	else
+		Get_Candidates(locFCALShowers.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
 	{
+	  const DFCALShower* locFCALShower = locFCALShowers[dCandidates[loc_i]];
 	  shared_ptr<DFCALShowerMatchParams> locShowerMatchParams;
-	  if(locParticleID->Cut_MatchDistance(extrapolations, locFCALShowers[loc_i], locInputStartTime, locShowerMatchParams))
-	    locDetectorMatches->Add_Match(locTrackWireBased, locFCALShowers[loc_i], locShowerMatchParams);
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locFCALShower, locInputStartTime, locShowerMatchParams))
+	    locDetectorMatches->Add_Match(locTrackWireBased, locFCALShower, locShowerMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
+	{
+		dMatchIndex.Check_Candidates("FCAL", locFCALShowers, dCandidates, [&](const DFCALShower* locFCALShower) -> bool
+		{
+			shared_ptr<DFCALShowerMatchParams> locShowerMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locFCALShower, locInputStartTime, locShowerMatchParams);
+		});
 	}
 }
 
 void DDetectorMatches_factory_WireBased::MatchToSC(const DParticleID* locParticleID, const DTrackWireBased* locTrackWireBased, const vector<const DSCHit*>& locSCHits, DDetectorMatches* locDetectorMatches) const
 {
+	const vector<DTrackFitter::Extrapolation_t>& extrapolations = locTrackWireBased->extrapolations.at(SYS_START);
 	double locInputStartTime = locTrackWireBased->t0();
-	const vector<DTrackFitter::Extrapolation_t>extrapolations=locTrackWireBased->extrapolations.at(SYS_START);
-	for(size_t loc_i = 0; loc_i < locSCHits.size(); ++loc_i)
+	if(dUseMatchIndexFlag)
+		dMatchIndex.Get_SCCandidates(extrapolations, true, dCandidates);
+	else
+		Get_Candidates(locSCHits.size(), dCandidates);
+	for(size_t loc_i = 0; loc_i < dCandidates.size(); ++loc_i)
 	{
+	  const DSCHit* locSCHit = locSCHits[dCandidates[loc_i]];
 	  shared_ptr<DSCHitMatchParams> locSCHitMatchParams;
-	  if(locParticleID->Cut_MatchDistance(extrapolations, locSCHits[loc_i], locInputStartTime, locSCHitMatchParams, true))
-	    locDetectorMatches->Add_Match(locTrackWireBased, locSCHits[loc_i], locSCHitMatchParams);
+	  if(locParticleID->Cut_MatchDistance(extrapolations, locSCHit, locInputStartTime, locSCHitMatchParams, true))
+	    locDetectorMatches->Add_Match(locTrackWireBased, locSCHit, locSCHitMatchParams);
+	}
+
+	if(dUseMatchIndexFlag && dCheckMatchIndexFlag)
+	{
+		dMatchIndex.Check_Candidates("SC", locSCHits, dCandidates, [&](const DSCHit* locSCHit) -> bool
+		{
+			shared_ptr<DSCHitMatchParams> locSCHitMatchParams;
+			return locParticleID->Cut_MatchDistance(extrapolations, locSCHit, locInputStartTime, locSCHitMatchParams, true);
+		});
 	}
 }
 
@@ -152,7 +223,7 @@ void DDetectorMatches_factory_WireBased::MatchToTrack(const DParticleID* locPart
 	{
 		shared_ptr<DBCALShowerMatchParams> locShowerMatchParams;
 		double locInputStartTime = locTrackWireBasedVector[loc_i]->t0();
-		const vector<DTrackFitter::Extrapolation_t>extrapolations=locTrackWireBasedVector[loc_i]->extrapolations.at(SYS_BCAL);
+		const vector<DTrackFitter::Extrapolation_t>& extrapolations=locTrackWireBasedVector[loc_i]->extrapolations.at(SYS_BCAL);
 		if(!locParticleID->Distance_ToTrack(extrapolations, locBCALShower, locInputStartTime, locShowerMatchParams))
 			continue;
 
@@ -177,7 +248,7 @@ void DDetectorMatches_factory_WireBased::MatchToTrack(const DParticleID* locPart
 	{
 		shared_ptr<DFCALShowerMatchParams> locShowerMatchParams;
 		double locInputStartTime = locTrackWireBasedVector[loc_i]->t0();
-		const vector<DTrackFitter::Extrapolation_t>extrapolations=locTrackWireBasedVector[loc_i]->extrapolations.at(SYS_FCAL);
+		const vector<DTrackFitter::Extrapolation_t>& extrapolations=locTrackWireBasedVector[loc_i]->extrapolations.at(SYS_FCAL);
 		if(!locParticleID->Distance_ToTrack(extrapolations, locFCALShower, locInputStartTime, locShowerMatchParams))
 			continue;
 		if(locShowerMatchParams->dDOCAToShower < locMinDistance)
@@ -185,3 +256,11 @@ void DDetectorMatches_factory_WireBased::MatchToTrack(const DParticleID* locPart
 	}
 	locDetectorMatches->Set_DistanceToNearestTrack(locFCALShower, locMinDistance);
 }
+
+void DDetectorMatches_factory_WireBased::Get_Candidates(size_t locNumObjects, vector<size_t>& locCandidates) const
+{
+	//no index: try everything
+	locCandidates.resize(locNumObjects);
+	for(size_t loc_i = 0; loc_i < locNumObjects; ++loc_i)
+		locCandidates[loc_i] = loc_i;
+}
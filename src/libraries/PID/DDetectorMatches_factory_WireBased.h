@@ -16,6 +16,7 @@
 #include <PID/DDetectorMatches.h>
 #include <TRACKING/DTrackWireBased.h>
 #include <PID/DParticleID.h>
+#include <PID/DDetectorMatchIndex.h>
 #include <TOF/DTOFPoint.h>
 #include <BCAL/DBCALShower.h>
 #include <FCAL/DFCALShower.h>
@@ -27,7 +28,7 @@ using namespace jana;
 class DDetectorMatches_factory_WireBased : public jana::JFactory<DDetectorMatches>
 {
 	public:
-		DDetectorMatches_factory_WireBased(){};
+		DDetectorMatches_factory_WireBased(void);
 		virtual ~DDetectorMatches_factory_WireBased(){};
 		const char* Tag(void){return "WireBased";}
 
@@ -48,6 +49,14 @@ class DDetectorMatches_factory_WireBased : public jana::JFactory<DDetectorMatche
 		//matching showers to tracks routines
 		void MatchToTrack(const DParticleID* locParticleID, const DBCALShower* locBCALShower, const vector<const DTrackWireBased*>& locTrackWireBasedVector, DDetectorMatches* locDetectorMatches) const;
 		void MatchToTrack(const DParticleID* locParticleID, const DFCALShower* locFCALShower, const vector<const DTrackWireBased*>& locTrackWireBasedVector, DDetectorMatches* locDetectorMatches) const;
+
+		void Get_Candidates(size_t locNumObjects, vector<size_t>& locCandidates) const;
+
+		//spatial index of the event's showers/hits: only objects that can pass the match cuts are tried
+		DDetectorMatchIndex dMatchIndex;
+		bool dUseMatchIndexFlag;
+		bool dCheckMatchIndexFlag;
+		mutable vector<size_t> dCandidates;
 };
 
 #endif // _DDetectorMatches_factory_WireBased_
@@ -11,6 +11,7 @@
 #include "DLorentzVector.h" 
 #include "particleType.h" 
 #include "TMatrixFSym.h"
+#include "DMatrixFSym7.h"
 #include "DResettable.h"
 #include "DResourcePool.h"
 
@@ -27,7 +28,7 @@ class DKinematicData : public JObject, public DResettable
 
 		// constructors and destructor
 		DKinematicData(void);
-		DKinematicData(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition = DVector3(), double locTime = 0.0, const shared_ptr<const TMatrixFSym>& locErrorMatrix = nullptr);
+		DKinematicData(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition = DVector3(), double locTime = 0.0, const DMatrixFSym7* locErrorMatrix = nullptr);
 		DKinematicData(const DKinematicData& locSourceData, bool locShareKinematicsFlag = false);
 		virtual ~DKinematicData(void) {};
 
@@ -46,7 +47,7 @@ class DKinematicData : public JObject, public DResettable
 		const DVector3& momentum(void) const{return dKinematicInfo->dMomentum;}
 		const DVector3& position(void) const{return dKinematicInfo->dPosition;}
 		double time(void) const{return dKinematicInfo->dTime;}
-		shared_ptr<const TMatrixFSym> errorMatrix(void) const{return dErrorMatrix;}
+		const DMatrixFSym7* errorMatrix(void) const{return dHasErrorMatrix ? &dErrorMatrix : nullptr;} //nullptr if not set
 
 		//components
 		double px(void) const{return dKinematicInfo->dMomentum.Px();}
@@ -66,13 +67,18 @@ class DKinematicData : public JObject, public DResettable
 		DLorentzVector x4(void) const{return DLorentzVector(position(), time());}
 
 		//SETTERS
-		void Set_Members(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition = DVector3(), double locTime = 0.0, const shared_ptr<const TMatrixFSym>& locErrorMatrix = nullptr);
+		void Set_Members(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition = DVector3(), double locTime = 0.0, const DMatrixFSym7* locErrorMatrix = nullptr);
 		void setPID(Particle_t locPID){dKinematicInfo->dPID = locPID;}
 		void setMomentum(const DVector3& aMomentum){dKinematicInfo->dMomentum = aMomentum;}
 		void setPosition(const DVector3& aPosition){dKinematicInfo->dPosition = aPosition;}
 		void setTime(double locTime){dKinematicInfo->dTime = locTime;}
-		void setErrorMatrix(const shared_ptr<const TMatrixFSym>& aMatrix){dErrorMatrix = aMatrix;}
-		void setErrorMatrix(const shared_ptr<TMatrixFSym>& aMatrix){dErrorMatrix = std::const_pointer_cast<const TMatrixFSym>(aMatrix);}
+		void setErrorMatrix(const DMatrixFSym7& aMatrix){dErrorMatrix = aMatrix; dHasErrorMatrix = true;}
+		void setErrorMatrix(const DMatrixFSym7* aMatrix){if(aMatrix != nullptr) setErrorMatrix(*aMatrix); else clearErrorMatrix();}
+		void clearErrorMatrix(void){dHasErrorMatrix = false;}
+		//TMatrixFSym shims (e.g. kinfit results): the leading 7x7 block is kept; nullptr or < 7 rows clears the matrix
+		void setErrorMatrix(const TMatrixFSym& aMatrix){dHasErrorMatrix = dErrorMatrix.Set(aMatrix);}
+		void setErrorMatrix(const shared_ptr<const TMatrixFSym>& aMatrix){if(aMatrix != nullptr) setErrorMatrix(*aMatrix); else clearErrorMatrix();}
+		void setErrorMatrix(const shared_ptr<TMatrixFSym>& aMatrix){setErrorMatrix(std::const_pointer_cast<const TMatrixFSym>(aMatrix));}
 
 		void toStrings(vector<pair<string,string> > &items) const
 		{
@@ -115,26 +121,29 @@ class DKinematicData : public JObject, public DResettable
 		//By inheriting this class, you also get to share the same interface
 		shared_ptr<DKinematicInfo> dKinematicInfo = nullptr;
 
-		//This member must be separate from DKinematicInfo or else it may be recycled on a different thread from which it was created, causing a race condition!
-		shared_ptr<const TMatrixFSym> dErrorMatrix = nullptr; // Order is (px, py, pz, x, y, z, t)
+		//Stored by value (packed, no allocation): copying it is cheaper than sharing a pooled TMatrixFSym
+		DMatrixFSym7 dErrorMatrix; // Order is (px, py, pz, x, y, z, t)
+		bool dHasErrorMatrix = false;
 
 		static thread_local shared_ptr<DResourcePool<DKinematicInfo>> dResourcePool_KinematicInfo;
 };
 
 /************************************************************** CONSTRUCTORS & OPERATORS ***************************************************************/
 
-inline DKinematicData::DKinematicData(void) : dKinematicInfo(dResourcePool_KinematicInfo->Get_SharedResource()), dErrorMatrix(nullptr){}
+inline DKinematicData::DKinematicData(void) : dKinematicInfo(dResourcePool_KinematicInfo->Get_SharedResource()){}
 
-inline DKinematicData::DKinematicData(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition, double locTime, const shared_ptr<const TMatrixFSym>& locErrorMatrix) :
-		dKinematicInfo(dResourcePool_KinematicInfo->Get_SharedResource()), dErrorMatrix(locErrorMatrix)
+inline DKinematicData::DKinematicData(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition, double locTime, const DMatrixFSym7* locErrorMatrix) :
+		dKinematicInfo(dResourcePool_KinematicInfo->Get_SharedResource())
 {
 	dKinematicInfo->Set_Members(locPID, locMomentum, locPosition, locTime);
+	setErrorMatrix(locErrorMatrix);
 }
 
 inline void DKinematicData::Share_FromInput_Kinematics(const DKinematicData* locSourceData)
 {
 	dKinematicInfo = const_cast<DKinematicData*>(locSourceData)->dKinematicInfo;
 	dErrorMatrix = locSourceData->dErrorMatrix;
+	dHasErrorMatrix = locSourceData->dHasErrorMatrix;
 }
 
 inline DKinematicData::DKinematicData(const DKinematicData& locSourceData, bool locShareKinematicsFlag)
@@ -147,7 +156,8 @@ inline DKinematicData::DKinematicData(const DKinematicData& locSourceData, bool
 		dKinematicInfo = dResourcePool_KinematicInfo->Get_SharedResource();
 		*dKinematicInfo = *(locSourceData.dKinematicInfo);
 	}
-	dErrorMatrix = locSourceData.dErrorMatrix; //it's const so it can't be modified: share and then replace if desired
+	dErrorMatrix = locSourceData.dErrorMatrix;
+	dHasErrorMatrix = locSourceData.dHasErrorMatrix;
 }
 
 inline DKinematicData& DKinematicData::operator=(const DKinematicData& locSourceData)
@@ -160,7 +170,8 @@ inline DKinematicData& DKinematicData::operator=(const DKinematicData& locSource
 	dKinematicInfo = dResourcePool_KinematicInfo->Get_SharedResource();
 	*dKinematicInfo = *(locSourceData.dKinematicInfo);
 
-	dErrorMatrix = locSourceData.dErrorMatrix; //it's const so it can't be modified: share and then replace if desired
+	dErrorMatrix = locSourceData.dErrorMatrix;
+	dHasErrorMatrix = locSourceData.dHasErrorMatrix;
 	return *this;
 }
 
@@ -169,10 +180,10 @@ dPID(locPID), dMomentum(locMomentum), dPosition(locPosition), dTime(locTime) {}
 
 /*********************************************************************** RESET & RELEASE *************************************************************************/
 
-inline void DKinematicData::Set_Members(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition, double locTime, const shared_ptr<const TMatrixFSym>& locErrorMatrix)
+inline void DKinematicData::Set_Members(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition, double locTime, const DMatrixFSym7* locErrorMatrix)
 {
 	dKinematicInfo->Set_Members(locPID, locMomentum, locPosition, locTime);
-	dErrorMatrix = locErrorMatrix;
+	setErrorMatrix(locErrorMatrix);
 }
 
 inline void DKinematicData::DKinematicInfo::Set_Members(Particle_t locPID, const DVector3& locMomentum, DVector3 locPosition, double locTime)
@@ -186,14 +197,14 @@ inline void DKinematicData::DKinematicInfo::Set_Members(Particle_t locPID, const
 inline void DKinematicData::Reset(void)
 {
 	dKinematicInfo = dResourcePool_KinematicInfo->Get_SharedResource(); //not safe to reset individually, since you don't know what it's shared with
-	dErrorMatrix = nullptr;
+	dHasErrorMatrix = false;
 	ClearAssociatedObjects();
 }
 
 inline void DKinematicData::Release(void)
 {
 	dKinematicInfo = nullptr;
-	dErrorMatrix = nullptr;
+	dHasErrorMatrix = false;
 	ClearAssociatedObjects();
 }
 
@@ -24,8 +24,6 @@ jerror_t DNeutralParticleHypothesis_factory::init(void)
 	SetFactoryFlag(NOT_OBJECT_OWNER);
 	dResourcePool_NeutralParticleHypothesis = new DResourcePool<DNeutralParticleHypothesis>();
 	dResourcePool_NeutralParticleHypothesis->Set_ControlParams(50, 20, 400, 4000, 0);
-	dResourcePool_TMatrixFSym = std::make_shared<DResourcePool<TMatrixFSym>>();
-	dResourcePool_TMatrixFSym->Set_ControlParams(50, 20, 1000, 15000, 0);
 
 	gPARMS->SetDefaultParameter("COMBO:MAX_MASSIVE_NEUTRAL_BETA", dMaxMassiveNeutralBeta);
 
@@ -101,9 +99,7 @@ DNeutralParticleHypothesis* DNeutralParticleHypothesis_factory::Create_DNeutralP
 		return NULL; //invalid, will divide by zero when creating error matrix, so skip!
 
 	DVector3 locMomentum(locPath);
-	shared_ptr<TMatrixFSym> locParticleCovariance = (locVertexCovMatrix != nullptr) ? dResourcePool_TMatrixFSym->Get_SharedResource() : nullptr;
-	if(locParticleCovariance != nullptr)
-		locParticleCovariance->ResizeTo(7, 7);
+	DMatrixFSym7 locParticleCovariance;
 
 	double locProjectedTime = 0.0, locPMag = 0.0;
 	if(locPID != Gamma)
@@ -122,7 +118,7 @@ DNeutralParticleHypothesis* DNeutralParticleHypothesis_factory::Create_DNeutralP
 
 		locProjectedTime = locStartTime + (locVertexGuess.Z() - dTargetCenterZ)/29.9792458;
 		if(locVertexCovMatrix != nullptr)
-			Calc_ParticleCovariance_Massive(locNeutralShower, locVertexCovMatrix, locMass, locDeltaT, locMomentum, locPath, locParticleCovariance.get());
+			Calc_ParticleCovariance_Massive(locNeutralShower, locVertexCovMatrix, locMass, locDeltaT, locMomentum, locPath, &locParticleCovariance);
 	}
 	else
 	{
@@ -131,7 +127,7 @@ DNeutralParticleHypothesis* DNeutralParticleHypothesis_factory::Create_DNeutralP
 		locProjectedTime = locHitTime - locFlightTime;
 		locMomentum.SetMag(locPMag);
 		if(locVertexCovMatrix != nullptr)
-			Calc_ParticleCovariance_Photon(locNeutralShower, locVertexCovMatrix, locMomentum, locPath, locParticleCovariance.get());
+			Calc_ParticleCovariance_Photon(locNeutralShower, locVertexCovMatrix, locMomentum, locPath, &locParticleCovariance);
 	}
 
 	// Build DNeutralParticleHypothesis // dEdx not set
@@ -142,7 +138,10 @@ DNeutralParticleHypothesis* DNeutralParticleHypothesis_factory::Create_DNeutralP
 	locNeutralParticleHypothesis->setPosition(locVertexGuess);
 	locNeutralParticleHypothesis->setTime(locProjectedTime);
 	locNeutralParticleHypothesis->Set_T0(locStartTime, sqrt(locEventRFBunch->dTimeVariance), locEventRFBunch->dTimeSource);
-	locNeutralParticleHypothesis->setErrorMatrix(locParticleCovariance);
+	if(locVertexCovMatrix != nullptr)
+		locNeutralParticleHypothesis->setErrorMatrix(locParticleCovariance);
+	else
+		locNeutralParticleHypothesis->clearErrorMatrix();
 
 	// Calculate DNeutralParticleHypothesis FOM
 	unsigned int locNDF = 0;
@@ -158,7 +157,7 @@ DNeutralParticleHypothesis* DNeutralParticleHypothesis_factory::Create_DNeutralP
 	return locNeutralParticleHypothesis;
 }
 
-void DNeutralParticleHypothesis_factory::Calc_ParticleCovariance_Photon(const DNeutralShower* locNeutralShower, const TMatrixFSym* locVertexCovMatrix, const DVector3& locMomentum, const DVector3& locPathVector, TMatrixFSym* locParticleCovariance) const
+void DNeutralParticleHypothesis_factory::Calc_ParticleCovariance_Photon(const DNeutralShower* locNeutralShower, const TMatrixFSym* locVertexCovMatrix, const DVector3& locMomentum, const DVector3& locPathVector, DMatrixFSym7* locParticleCovariance) const
 {
 	//build 8x8 matrix: 5x5 shower, 3x3 vertex position
 	TMatrixFSym locShowerPlusVertCovariance(8);
@@ -223,10 +222,10 @@ void DNeutralParticleHypothesis_factory::Calc_ParticleCovariance_Photon(const DN
 	locTransformMatrix(6, 7) = -1.0*locTransformMatrix(6, 3); //partial deriv of t wrst vert-z
 
 	//convert
-	*locParticleCovariance = locShowerPlusVertCovariance.Similarity(locTransformMatrix);
+	locParticleCovariance->Set(locShowerPlusVertCovariance.Similarity(locTransformMatrix));
 }
 
-void DNeutralParticleHypothesis_factory::Calc_ParticleCovariance_Massive(const DNeutralShower* locNeutralShower, const TMatrixFSym* locVertexCovMatrix, double locMass, double locDeltaT, const DVector3& locMomentum, const DVector3& locPathVector, TMatrixFSym* locParticleCovariance) const
+void DNeutralParticleHypothesis_factory::Calc_ParticleCovariance_Massive(const DNeutralShower* locNeutralShower, const TMatrixFSym* locVertexCovMatrix, double locMass, double locDeltaT, const DVector3& locMomentum, const DVector3& locPathVector, DMatrixFSym7* locParticleCovariance) const
 {
 	//build 9x9 matrix: 5x5 shower, 4x4 vertex position & time
 	TMatrixFSym locShowerPlusVertCovariance(9);
@@ -293,5 +292,5 @@ void DNeutralParticleHypothesis_factory::Calc_ParticleCovariance_Massive(const D
 	locTransformMatrix(6, 8) = 1.0; //partial deriv of t wrst vertex-t
 
 	//convert
-	*locParticleCovariance = locShowerPlusVertCovariance.Similarity(locTransformMatrix);
+	locParticleCovariance->Set(locShowerPlusVertCovariance.Similarity(locTransformMatrix));
 }
@@ -77,6 +77,8 @@ NSpec 0
 #include <string>
 #include <iostream>
 
+#include "DFlatMLP.h"
+
 #ifndef IClassifierReader__def
 #define IClassifierReader__def
 
@@ -181,6 +183,9 @@ class DNeutralShower_FCALQualityMLP : public IClassifierReader {
    // variables given to the constructor
    double GetMvaValue( const std::vector<double>& inputValues ) const;
 
+   // the same network (and input transformation) as flat arrays, for batch evaluation
+   void Fill_FlatMLP( DFlatMLP& flatMLP ) const;
+
  private:
 
    // method-specific destructor
@@ -560,3 +565,12 @@ inline void DNeutralShower_FCALQualityMLP::Transform( std::vector<double>& iv, i
 {
    Transform_1( iv, sigOrBgd );
 }
+
+//_______________________________________________________________________
+inline void DNeutralShower_FCALQualityMLP::Fill_FlatMLP( DFlatMLP& flatMLP ) const
+{
+   // Transform() is always called for class 2 (all classes)
+   flatMLP.Set_InputNormalization( std::vector<double>( fMin_1[2], fMin_1[2] + 8 ), std::vector<double>( fMax_1[2], fMax_1[2] + 8 ) );
+   flatMLP.Add_Layer( 11, std::vector<double>( &fWeightMatrix0to1[0][0], &fWeightMatrix0to1[0][0] + 11*9 ), DFlatMLP::kRadial );
+   flatMLP.Add_Layer( 1, std::vector<double>( &fWeightMatrix1to2[0][0], &fWeightMatrix1to2[0][0] + 1*12 ), DFlatMLP::kSigmoid );
+}
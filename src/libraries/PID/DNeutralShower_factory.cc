@@ -32,7 +32,8 @@ DNeutralShower_factory::DNeutralShower_factory()
 {
 
   vector< string > vars( inputVars, inputVars + sizeof( inputVars )/sizeof( char* ) );
-  dFCALClassifier = new DNeutralShower_FCALQualityMLP( vars );
+  DNeutralShower_FCALQualityMLP locFCALClassifier( vars );
+  locFCALClassifier.Fill_FlatMLP( dFCALClassifier );
   
   dResourcePool_TMatrixFSym = std::make_shared<DResourcePool<TMatrixFSym>>(); 
 }
@@ -123,6 +124,8 @@ jerror_t DNeutralShower_factory::evnt(jana::JEventLoop *locEventLoop, uint64_t e
 
   // Loop over all DFCALShowers, create DNeutralShower if didn't match to any tracks
   // The chance of an actual neutral shower matching to a bogus track is very small
+  dFCALNeutralShowers.clear();
+  dFCALQualityInputs.resize( 8*locFCALShowers.size() );
   for(size_t loc_i = 0; loc_i < locFCALShowers.size(); ++loc_i)
     {
       if(locDetectorMatches->Get_IsMatchedToTrack(locFCALShowers[loc_i]))
@@ -139,7 +142,8 @@ jerror_t DNeutralShower_factory::evnt(jana::JEventLoop *locEventLoop, uint64_t e
       locNeutralShower->dSpacetimeVertex.SetVect(locFCALShowers[loc_i]->getPosition());
       locNeutralShower->dSpacetimeVertex.SetT(locFCALShowers[loc_i]->getTime());
       
-      locNeutralShower->dQuality = getFCALQuality( locFCALShowers[loc_i], rfTime );
+      getFCALQualityInputs( locFCALShowers[loc_i], rfTime, &dFCALQualityInputs[8*dFCALNeutralShowers.size()] );
+      dFCALNeutralShowers.push_back( locNeutralShower );
       
       auto locCovMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
       locCovMatrix->ResizeTo(5, 5);
@@ -150,6 +154,12 @@ jerror_t DNeutralShower_factory::evnt(jana::JEventLoop *locEventLoop, uint64_t e
 
       _data.push_back(locNeutralShower);
     }
+
+  // FCAL shower quality: all showers in one batch
+  dFCALQualities.resize( dFCALNeutralShowers.size() );
+  dFCALClassifier.Evaluate( dFCALQualityInputs.data(), dFCALNeutralShowers.size(), dFCALQualities.data() );
+  for(size_t loc_i = 0; loc_i < dFCALNeutralShowers.size(); ++loc_i)
+    dFCALNeutralShowers[loc_i]->dQuality = dFCALQualities[loc_i];
   
   // Loop over all DCCALShowers, create DNeutralShower if didn't match to any tracks
   // The chance of an actual neutral shower matching to a bogus track is very small
@@ -201,12 +211,11 @@ jerror_t DNeutralShower_factory::fini(void)
   return NOERROR;
 }
 
-double DNeutralShower_factory::getFCALQuality( const DFCALShower* fcalShower, double rfTime ) const {
+void DNeutralShower_factory::getFCALQualityInputs( const DFCALShower* fcalShower, double rfTime, double* mvaInputs ) const {
 
   double flightDistance = ( fcalShower->getPosition() - dTargetCenter ).Mag();
   double flightTime = fcalShower->getTime() - rfTime;
   
-  vector< double > mvaInputs( 8 );
   mvaInputs[0] = fcalShower->getNumBlocks();
   mvaInputs[1] = fcalShower->getE9E25();
   mvaInputs[2] = fcalShower->getE1E9();
@@ -215,7 +224,5 @@ double DNeutralShower_factory::getFCALQuality( const DFCALShower* fcalShower, do
   mvaInputs[5] = ( mvaInputs[3] - mvaInputs[4] ) / ( mvaInputs[3] + mvaInputs[4] );
   mvaInputs[6] = flightDistance / flightTime;
   mvaInputs[7] = fcalShower->getTime() - ( rfTime + fcalShower->getTimeTrack() );
-  
-  return dFCALClassifier->GetMvaValue( mvaInputs );
 }
 
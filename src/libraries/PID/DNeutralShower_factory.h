@@ -30,7 +30,7 @@ class DNeutralShower_factory:public jana::JFactory<DNeutralShower>
 {
  public:
   DNeutralShower_factory();
-  ~DNeutralShower_factory(){ delete dFCALClassifier;}
+  ~DNeutralShower_factory(){}
 
  private:
   jerror_t init(void);						///< Called once at program start.
@@ -43,9 +43,14 @@ class DNeutralShower_factory:public jana::JFactory<DNeutralShower>
   DVector3 dTargetCenter;
 
   const char* inputVars[8] = { "nHits", "e9e25Sh", "e1e9Sh", "sumUSh", "sumVSh", "asymUVSh", "speedSh", "dtTrSh" };
-  DNeutralShower_FCALQualityMLP* dFCALClassifier;
+  DFlatMLP dFCALClassifier; // DNeutralShower_FCALQualityMLP network, evaluated for all FCAL showers of the event at once
 
-  double getFCALQuality( const DFCALShower* fcalShower, double rfTime ) const;
+  // reused every event
+  vector< DNeutralShower* > dFCALNeutralShowers;
+  vector< double > dFCALQualityInputs;
+  vector< double > dFCALQualities;
+
+  void getFCALQualityInputs( const DFCALShower* fcalShower, double rfTime, double* mvaInputs ) const;
 };
 
 #endif // _DNeutralShower_factory_
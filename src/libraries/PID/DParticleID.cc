@@ -1340,23 +1340,8 @@ bool DParticleID::Distance_ToTrack(const vector<DTrackFitter::Extrapolation_t> &
 
 	// Correct the locDeltaPhi in case the projected and input SC hit paddles are different	
 	unsigned int sc_index=locSCHit->sector-1;
-	double z=locProjPos.z();
 	unsigned int locSCPlane=0;
-	if (z>sc_pos[sc_index][0].z()){
-		for (unsigned int j=0;j<sc_pos[sc_index].size();j++){
-		  if (z>sc_pos[sc_index][j].z()) continue;
-
-		  locSCPlane=j-1;
-		  break;
-		}
-	}
-	
-	DVector3 sc_pos_at_projz = sc_pos[sc_index][locSCPlane] + (locProjPos.Z() - sc_pos[sc_index][locSCPlane].z())*sc_dir[sc_index][locSCPlane];
-	double locDeltaPhi = sc_pos_at_projz.Phi() - locProjPos.Phi();
-	while(locDeltaPhi > TMath::Pi())
-	locDeltaPhi -= M_TWO_PI;
-	while(locDeltaPhi < -1.0*TMath::Pi())
-	locDeltaPhi += M_TWO_PI;
+	double locDeltaPhi = Calc_SCDeltaPhi(sc_index, locProjPos, locSCPlane);
 
 	// Compute the track distance through the scintillator
 	DVector3 locPaddleNorm=sc_norm[sc_index][locSCPlane];
@@ -1469,28 +1454,9 @@ bool DParticleID::Distance_ToTrack(const vector<DTrackFitter::Extrapolation_t> &
   // The next part of the code tries to take into account curvature
   // of shower cluster distribution
   
-  // Get clusters associated with this shower
-  vector<const DBCALCluster*>clusters;
-  locBCALShower->Get(clusters);
-  
   // make list of points associated with the shower
   vector<const DBCALPoint*> points;
-  if(!clusters.empty())
-    {
-      // classic BCAL shower objects are built from the output of the clusterizer
-      // so the points need to be accessed as shower -> cluster -> points
-      for (unsigned int k=0;k<clusters.size();k++)
-	{
-	  vector<const DBCALPoint*> cluster_points=clusters[k]->points();
-	  points.insert(points.end(), cluster_points.begin(), cluster_points.end());
-	}
-    }
-  else
-    {
-      // other BCAL shower objects directly keep a list of the points associated with the shower
-      // (e.g. "CURVATURE" showers)
-      locBCALShower->Get(points);
-    }
+  Get_BCALShowerPoints(locBCALShower, points);
   
   // loop over points associated with this shower, finding
   // the closest match between a point and the track
@@ -1786,6 +1752,155 @@ bool DParticleID::Cut_MatchDIRC(const vector<DTrackFitter::Extrapolation_t> &ext
 }
 
 
+/********************************************************** MATCH SEARCH WINDOWS **********************************************************/
+
+// These give, for a set of extrapolations, a region outside of which no shower/hit can pass the corresponding
+// Cut_MatchDistance() above. They must stay in sync with those cuts; DDetectorMatchIndex uses them to skip
+// the (expensive) distance calculation for far-away objects.
+
+bool DParticleID::Get_BCALMatchWindow(const vector<DTrackFitter::Extrapolation_t> &extrapolations, double& locPhiMin, double& locPhiMax, double& locZMin, double& locZMax) const
+{
+	if(extrapolations.size()<2)
+		return false;
+
+	// The projection used for the cuts is one of the extrapolation points, and the closest shower point is compared
+	// to positions interpolated between them: span all of them. The phi cut is evaluated at each point's momentum.
+	double locPhi0 = extrapolations[0].position.Phi();
+	double locDeltaPhiMin = 0.0, locDeltaPhiMax = 0.0, locMaxPhiCut = 0.0;
+	locZMin = locZMax = extrapolations[0].position.z();
+	for(size_t loc_i = 0; loc_i < extrapolations.size(); ++loc_i)
+	{
+		const DVector3& locPosition = extrapolations[loc_i].position;
+		double locDeltaPhi = locPosition.Phi() - locPhi0;
+		while(locDeltaPhi > M_PI)
+			locDeltaPhi -= M_TWO_PI;
+		while(locDeltaPhi < -M_PI)
+			locDeltaPhi += M_TWO_PI;
+		locDeltaPhiMin = min(locDeltaPhiMin, locDeltaPhi);
+		locDeltaPhiMax = max(locDeltaPhiMax, locDeltaPhi);
+		locZMin = min(locZMin, locPosition.z());
+		locZMax = max(locZMax, locPosition.z());
+
+		double locP = extrapolations[loc_i].momentum.Mag();
+		double locPhiCut = BCAL_PHI_CUT_PAR1 + BCAL_PHI_CUT_PAR2*exp(-1.0*BCAL_PHI_CUT_PAR3*locP);
+		locMaxPhiCut = max(locMaxPhiCut, locPhiCut);
+	}
+
+	// extra 5 degrees: points slightly inside the BCAL inner radius are extrapolated beyond the first step
+	double locPhiWindow = (locMaxPhiCut + 5.0)*TMath::Pi()/180.0;
+	locPhiMin = locPhi0 + locDeltaPhiMin - locPhiWindow;
+	locPhiMax = locPhi0 + locDeltaPhiMax + locPhiWindow;
+	locZMin -= BCAL_Z_CUT;
+	locZMax += BCAL_Z_CUT;
+	return true;
+}
+
+bool DParticleID::Get_FCALMatchWindow(const vector<DTrackFitter::Extrapolation_t> &extrapolations, double locShowerZMin, double locShowerZMax, double& locXMin, double& locXMax, double& locYMin, double& locYMax) const
+{
+	if(extrapolations.size()==0)
+		return false;
+
+	// The track is projected along a straight line to the z of each shower: span the projections to all shower z's
+	const DVector3& locPos = extrapolations[0].position;
+	const DVector3& locMom = extrapolations[0].momentum;
+	double locX1 = locPos.x() + (locShowerZMin - locPos.z())*locMom.x()/locMom.z();
+	double locX2 = locPos.x() + (locShowerZMax - locPos.z())*locMom.x()/locMom.z();
+	double locY1 = locPos.y() + (locShowerZMin - locPos.z())*locMom.y()/locMom.z();
+	double locY2 = locPos.y() + (locShowerZMax - locPos.z())*locMom.y()/locMom.z();
+
+	// Distance_ToTrack() compares the squared distance to the shower hits with the (unsquared) distance to the
+	// shower centroid, so either can satisfy the cut: use the larger radius
+	double p=locMom.Mag();
+	double theta=locMom.Theta()*180./M_PI;
+	double cut=(FCAL_CUT_PAR1+FCAL_CUT_PAR2/p)*(1.+FCAL_CUT_PAR3*theta*theta);
+	double locRadius = max(cut, cut*cut) + 0.1;
+
+	locXMin = min(locX1, locX2) - locRadius;
+	locXMax = max(locX1, locX2) + locRadius;
+	locYMin = min(locY1, locY2) - locRadius;
+	locYMax = max(locY1, locY2) + locRadius;
+	return true;
+}
+
+bool DParticleID::Get_TOFMatchWindow(const vector<DTrackFitter::Extrapolation_t> &extrapolations, double& locXMin, double& locXMax, double& locYMin, double& locYMax) const
+{
+	if(extrapolations.size()==0)
+		return false;
+
+	const DVector3& locProjPos = extrapolations[0].position;
+	double locMatchCut = exp(-1.0*TOF_CUT_PAR1*extrapolations[0].momentum.Mag() + TOF_CUT_PAR2) + TOF_CUT_PAR3 + 0.1;
+	locXMin = locProjPos.X() - locMatchCut;
+	locXMax = locProjPos.X() + locMatchCut;
+	locYMin = locProjPos.Y() - locMatchCut;
+	locYMax = locProjPos.Y() + locMatchCut;
+	return true;
+}
+
+bool DParticleID::Cut_MatchSCSector(const vector<DTrackFitter::Extrapolation_t> &extrapolations, unsigned int locSCSector, bool locIsTimeBased) const
+{
+	if(extrapolations.size()==0)
+		return false;
+	if((locSCSector == 0) || (locSCSector > sc_pos.size()))
+		return true; //let the full cut decide
+
+	// Same delta-phi and cut as Cut_MatchDistance(), which only differs by the timing cut
+	const DVector3& locProjPos = extrapolations[0].position;
+	unsigned int locSCPlane = 0;
+	double locDeltaPhi = 180.0*Calc_SCDeltaPhi(locSCSector - 1, locProjPos, locSCPlane)/TMath::Pi();
+	auto& locSCCutPars = locIsTimeBased ? dSCCutPars_TimeBased : dSCCutPars_WireBased;
+	double sc_dphi_cut = locSCCutPars[0] + locSCCutPars[1]*exp(locSCCutPars[2]*(locProjPos.Z() - locSCCutPars[3]));
+	return (fabs(locDeltaPhi) <= sc_dphi_cut);
+}
+
+void DParticleID::Get_BCALShowerPoints(const DBCALShower* locBCALShower, vector<const DBCALPoint*>& locPoints) const
+{
+  locPoints.clear();
+
+  // Get clusters associated with this shower
+  vector<const DBCALCluster*>clusters;
+  locBCALShower->Get(clusters);
+  
+  if(!clusters.empty())
+    {
+      // classic BCAL shower objects are built from the output of the clusterizer
+      // so the points need to be accessed as shower -> cluster -> points
+      for (unsigned int k=0;k<clusters.size();k++)
+	{
+	  vector<const DBCALPoint*> cluster_points=clusters[k]->points();
+	  locPoints.insert(locPoints.end(), cluster_points.begin(), cluster_points.end());
+	}
+    }
+  else
+    {
+      // other BCAL shower objects directly keep a list of the points associated with the shower
+      // (e.g. "CURVATURE" showers)
+      locBCALShower->Get(locPoints);
+    }
+}
+
+double DParticleID::Calc_SCDeltaPhi(unsigned int sc_index, const DVector3& locProjPos, unsigned int& locSCPlane) const
+{
+	// Phi of the paddle at the z of the projection, minus phi of the projection
+	double z=locProjPos.z();
+	locSCPlane=0;
+	if (z>sc_pos[sc_index][0].z()){
+		for (unsigned int j=0;j<sc_pos[sc_index].size();j++){
+		  if (z>sc_pos[sc_index][j].z()) continue;
+
+		  locSCPlane=j-1;
+		  break;
+		}
+	}
+	
+	DVector3 sc_pos_at_projz = sc_pos[sc_index][locSCPlane] + (locProjPos.Z() - sc_pos[sc_index][locSCPlane].z())*sc_dir[sc_index][locSCPlane];
+	double locDeltaPhi = sc_pos_at_projz.Phi() - locProjPos.Phi();
+	while(locDeltaPhi > TMath::Pi())
+	locDeltaPhi -= M_TWO_PI;
+	while(locDeltaPhi < -1.0*TMath::Pi())
+	locDeltaPhi += M_TWO_PI;
+	return locDeltaPhi;
+}
+
 /********************************************************** GET BEST MATCH **********************************************************/
 
 bool DParticleID::Get_BestBCALMatchParams(const DTrackingData* locTrack, const DDetectorMatches* locDetectorMatches, shared_ptr<const DBCALShowerMatchParams>& locBestMatchParams) const
@@ -134,6 +134,18 @@ class DParticleID:public jana::JObject
 		bool Cut_MatchDistance(const vector<DTrackFitter::Extrapolation_t> &extrapolations, const DSCHit* locSCHit, double locInputStartTime,shared_ptr<DSCHitMatchParams>& locSCHitMatchParams, bool locIsTimeBased, DVector3 *locOutputProjPos=nullptr, DVector3 *locOutputProjMom=nullptr) const;
 		bool Cut_MatchDIRC(const vector<DTrackFitter::Extrapolation_t> &extrapolations, const vector<const DDIRCPmtHit*> locDIRCHits, double locInputStartTime, Particle_t locPID, shared_ptr<DDIRCMatchParams>& locDIRCMatchParams, const vector<const DDIRCTruthBarHit*> locDIRCBarHits, map<shared_ptr<const DDIRCMatchParams>, vector<const DDIRCPmtHit*> >& locDIRCTrackMatchParams, DVector3 *locOutputProjPos=nullptr, DVector3 *locOutputProjMom=nullptr) const;
 
+		/********************************************************** MATCH SEARCH WINDOWS **********************************************************/
+
+		// Conservative windows used by DDetectorMatchIndex: objects outside of them cannot pass Cut_MatchDistance() for these extrapolations
+		// Return false if nothing can match (e.g. no extrapolations)
+		bool Get_BCALMatchWindow(const vector<DTrackFitter::Extrapolation_t> &extrapolations, double& locPhiMin, double& locPhiMax, double& locZMin, double& locZMax) const;
+		bool Get_FCALMatchWindow(const vector<DTrackFitter::Extrapolation_t> &extrapolations, double locShowerZMin, double locShowerZMax, double& locXMin, double& locXMax, double& locYMin, double& locYMax) const;
+		bool Get_TOFMatchWindow(const vector<DTrackFitter::Extrapolation_t> &extrapolations, double& locXMin, double& locXMax, double& locYMin, double& locYMax) const;
+		bool Cut_MatchSCSector(const vector<DTrackFitter::Extrapolation_t> &extrapolations, unsigned int locSCSector, bool locIsTimeBased) const;
+
+		void Get_BCALShowerPoints(const DBCALShower* locBCALShower, vector<const DBCALPoint*>& locPoints) const;
+		double Calc_SCDeltaPhi(unsigned int locSCIndex, const DVector3& locProjPos, unsigned int& locSCPlane) const;
+
 		/********************************************************** GET BEST MATCH **********************************************************/
 
 		// Wrappers
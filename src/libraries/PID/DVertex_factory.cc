@@ -170,7 +170,7 @@ jerror_t DVertex_factory::Create_Vertex_OneTrack(const DTrackTimeBased* locTrack
 	//error matrix
 	if(locTrackTimeBased->errorMatrix() != nullptr)
 	{
-		const TMatrixFSym& locTrackErrorMatrix = *(locTrackTimeBased->errorMatrix());
+		const DMatrixFSym7& locTrackErrorMatrix = *(locTrackTimeBased->errorMatrix());
 		locVertex->dCovarianceMatrix.ResizeTo(4, 4);
 		locVertex->dCovarianceMatrix.Zero();
 		for(size_t loc_i = 0; loc_i < 3; ++loc_i)
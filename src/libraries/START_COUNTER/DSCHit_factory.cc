@@ -18,6 +18,7 @@ using namespace std;
 #include <DAQ/Df250PulseIntegral.h>
 #include <DAQ/Df250Config.h>
 #include "DSCHit_factory.h"
+#include "DANA/DApplication.h"
 
 using namespace jana;
 
@@ -73,6 +74,17 @@ jerror_t DSCHit_factory::init(void)
     CHECK_FADC_ERRORS = true;
     gPARMS->SetDefaultParameter("SC:CHECK_FADC_ERRORS", CHECK_FADC_ERRORS, "Set to 1 to reject hits with fADC250 errors, ser to 0 to keep these hits");
 
+    // tables loaded once for all threads by the shared calibration cache
+    DApplication* dapp = dynamic_cast<DApplication*>(japp);
+    calib_cache = dapp->GetCalibCache();
+    calib_cache->Declare< map<string,double> >("/START_COUNTER/digi_scales");
+    calib_cache->Declare< map<string,double> >("/START_COUNTER/base_time_offset");
+    calib_cache->Declare< vector<double> >("/START_COUNTER/gains");
+    calib_cache->Declare< vector<double> >("/START_COUNTER/pedestals");
+    calib_cache->Declare< vector<double> >("/START_COUNTER/adc_timing_offsets");
+    calib_cache->Declare< vector<double> >("/START_COUNTER/tdc_timing_offsets");
+    calib_cache->Declare< vector< vector<double> > >("START_COUNTER/timewalk_parms_v2");
+
     return NOERROR;
 }
 
@@ -113,7 +125,7 @@ jerror_t DSCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
     // load scale factors
     map<string,double> scale_factors;
     // a_scale (SC_ADC_SCALE)
-    if (eventLoop->GetCalib("/START_COUNTER/digi_scales", scale_factors))
+    if (calib_cache->GetCalib(eventLoop, "/START_COUNTER/digi_scales", scale_factors))
         jout << "Error loading /START_COUNTER/digi_scales !" << endl;
     if (scale_factors.find("SC_ADC_ASCALE") != scale_factors.end())
         a_scale = scale_factors["SC_ADC_ASCALE"];
@@ -130,7 +142,7 @@ jerror_t DSCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
     // load base time offset
     map<string,double> base_time_offset;
     // t_base (SC_BASE_TIME_OFFSET)
-    if (eventLoop->GetCalib("/START_COUNTER/base_time_offset",base_time_offset))
+    if (calib_cache->GetCalib(eventLoop, "/START_COUNTER/base_time_offset",base_time_offset))
         jout << "Error loading /START_COUNTER/base_time_offset !" << endl;
     if (base_time_offset.find("SC_BASE_TIME_OFFSET") != base_time_offset.end())
         t_base = base_time_offset["SC_BASE_TIME_OFFSET"];
@@ -144,19 +156,19 @@ jerror_t DSCHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 
     // load constant tables
     // a_gains (gains)
-    if (eventLoop->GetCalib("/START_COUNTER/gains", a_gains))
+    if (calib_cache->GetCalib(eventLoop, "/START_COUNTER/gains", a_gains))
         jout << "Error loading /START_COUNTER/gains !" << endl;
     // a_pedestals (pedestals)
-    if (eventLoop->GetCalib("/START_COUNTER/pedestals", a_pedestals))
+    if (calib_cache->GetCalib(eventLoop, "/START_COUNTER/pedestals", a_pedestals))
         jout << "Error loading /START_COUNTER/pedestals !" << endl;
     // adc_time_offsets (adc_timing_offsets)
-    if (eventLoop->GetCalib("/START_COUNTER/adc_timing_offsets", adc_time_offsets))
+    if (calib_cache->GetCalib(eventLoop, "/START_COUNTER/adc_timing_offsets", adc_time_offsets))
         jout << "Error loading /START_COUNTER/adc_timing_offsets !" << endl;
     // tdc_time_offsets (tdc_timing_offsets)
-    if (eventLoop->GetCalib("/START_COUNTER/tdc_timing_offsets", tdc_time_offsets))
+    if (calib_cache->GetCalib(eventLoop, "/START_COUNTER/tdc_timing_offsets", tdc_time_offsets))
         jout << "Error loading /START_COUNTER/tdc_timing_offsets !" << endl;
     // timewalk_parameters (timewalk_parms)
-    if(eventLoop->GetCalib("START_COUNTER/timewalk_parms_v2", timewalk_parameters))
+    if(calib_cache->GetCalib(eventLoop, "START_COUNTER/timewalk_parms_v2", timewalk_parameters))
         jout << "Error loading /START_COUNTER/timewalk_parms_v2 !" << endl;
 
 
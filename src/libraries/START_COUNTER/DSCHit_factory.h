@@ -9,6 +9,7 @@
 #define _DSCHit_factory_
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include <DANA/DApplication.h>
 #include <HDGEOMETRY/DGeometry.h>
 #include <TTAB/DTTabUtilities.h>
@@ -64,6 +65,7 @@ class DSCHit_factory:public jana::JFactory<DSCHit>{
 
         bool CHECK_FADC_ERRORS;
 	bool REQUIRE_ADC_TDC_MATCH;
+	DCalibCache *calib_cache;
 };
 
 #endif // _DSCHit_factory_
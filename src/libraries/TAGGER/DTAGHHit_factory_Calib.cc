@@ -12,6 +12,7 @@
 using namespace std;
 
 #include "DTAGHHit_factory_Calib.h"
+#include "DANA/DApplication.h"
 #include "DTAGHDigiHit.h"
 #include "DTAGHTDCDigiHit.h"
 #include "TTAB/DTTabUtilities.h"
@@ -57,6 +58,17 @@ jerror_t DTAGHHit_factory_Calib::init(void)
         counter_quality[counter] = 0;
     }
 
+    // tables loaded once for all threads by the shared calibration cache
+    DApplication* dapp = dynamic_cast<DApplication*>(japp);
+    calib_cache = dapp->GetCalibCache();
+    calib_cache->Declare< map<string,double> >("/PHOTON_BEAM/hodoscope/base_time_offset");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/hodoscope/fadc_gains");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/hodoscope/fadc_pedestals");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/hodoscope/fadc_time_offsets");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/hodoscope/tdc_time_offsets");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/hodoscope/counter_quality");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/hodoscope/tdc_timewalk");
+
     return NOERROR;
 }
 
@@ -85,7 +97,7 @@ jerror_t DTAGHHit_factory_Calib::brun(jana::JEventLoop *eventLoop, int32_t runnu
 
     // load base time offset
     map<string,double> base_time_offset;
-    if (eventLoop->GetCalib("/PHOTON_BEAM/hodoscope/base_time_offset",base_time_offset))
+    if (calib_cache->GetCalib(eventLoop, "/PHOTON_BEAM/hodoscope/base_time_offset",base_time_offset))
         jout << "Error loading /PHOTON_BEAM/hodoscope/base_time_offset !" << endl;
     if (base_time_offset.find("TAGH_BASE_TIME_OFFSET") != base_time_offset.end())
         t_base = base_time_offset["TAGH_BASE_TIME_OFFSET"];
@@ -280,7 +292,7 @@ bool DTAGHHit_factory_Calib::load_ccdb_constants(
 {
     std::vector< std::map<std::string, double> > table;
     std::string ccdb_key = "/PHOTON_BEAM/hodoscope/" + table_name;
-    if (eventLoop->GetCalib(ccdb_key, table))
+    if (calib_cache->GetCalib(eventLoop, ccdb_key, table))
     {
         jout << "Error loading " << ccdb_key << " from ccdb!" << std::endl;
         return false;
@@ -9,6 +9,7 @@
 #define _DTAGHHit_factory_Calib_
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include "DTAGHHit.h"
 #include "DTAGHGeometry.h"
 
@@ -56,6 +57,7 @@ class DTAGHHit_factory_Calib:public jana::JFactory<DTAGHHit>{
         jerror_t fini(void);						///< Called after last event of last event source has been processed.
 
         bool CHECK_FADC_ERRORS;
+        DCalibCache *calib_cache;
 };
 
 #endif // _DTAGHHit_factory_Calib_
@@ -14,6 +14,7 @@ using namespace std;
 #include "DTAGMTDCDigiHit.h"
 #include "DTAGMGeometry.h"
 #include "DTAGMHit_factory_Calib.h"
+#include "DANA/DApplication.h"
 #include <DAQ/Df250PulseIntegral.h>
 #include <DAQ/Df250PulsePedestal.h>
 #include <DAQ/Df250Config.h>
@@ -58,6 +59,18 @@ jerror_t DTAGMHit_factory_Calib::init(void)
         }
     }
 
+    // tables loaded once for all threads by the shared calibration cache
+    DApplication* dapp = dynamic_cast<DApplication*>(japp);
+    calib_cache = dapp->GetCalibCache();
+    calib_cache->Declare< map<string,double> >("/PHOTON_BEAM/microscope/base_time_offset");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/microscope/fadc_gains");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/microscope/fadc_pedestals");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/microscope/fadc_time_offsets");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/microscope/tdc_time_offsets");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/microscope/fiber_quality");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/microscope/tdc_timewalk_corrections");
+    calib_cache->Declare< vector< map<string,double> > >("/PHOTON_BEAM/microscope/integral_cuts");
+
     return NOERROR;
 }
 
@@ -87,7 +100,7 @@ jerror_t DTAGMHit_factory_Calib::brun(jana::JEventLoop *eventLoop, int32_t runnu
 
     // load base time offset
     map<string,double> base_time_offset;
-    if (eventLoop->GetCalib("/PHOTON_BEAM/microscope/base_time_offset",base_time_offset))
+    if (calib_cache->GetCalib(eventLoop, "/PHOTON_BEAM/microscope/base_time_offset",base_time_offset))
         jout << "Error loading /PHOTON_BEAM/microscope/base_time_offset !" << endl;
     if (base_time_offset.find("TAGM_BASE_TIME_OFFSET") != base_time_offset.end())
         t_base = base_time_offset["TAGM_BASE_TIME_OFFSET"];
@@ -330,7 +343,7 @@ bool DTAGMHit_factory_Calib::load_ccdb_constants(
 {
     std::vector< std::map<std::string, double> > table;
     std::string ccdb_key = "/PHOTON_BEAM/microscope/" + table_name;
-    if (eventLoop->GetCalib(ccdb_key, table))
+    if (calib_cache->GetCalib(eventLoop, ccdb_key, table))
     {
         jout << "Error loading " << ccdb_key << " from ccdb!" << std::endl;
         return false;
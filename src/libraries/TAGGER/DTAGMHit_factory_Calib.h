@@ -12,6 +12,7 @@
 using namespace std;
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include "TTAB/DTTabUtilities.h"
 
 #include "DTAGMHit.h"
@@ -63,6 +64,7 @@ class DTAGMHit_factory_Calib: public jana::JFactory<DTAGMHit> {
       jerror_t fini(void);                                          ///< Called after last event of last event source has been processed
 
       bool CHECK_FADC_ERRORS;
+      DCalibCache *calib_cache;
 };
 
 #endif // _DTAGMHit_factory_Calib_
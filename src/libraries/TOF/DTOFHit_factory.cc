@@ -19,6 +19,7 @@ using namespace std;
 #include <TOF/DTOFDigiHit.h>
 #include <TOF/DTOFTDCDigiHit.h>
 #include "DTOFHit_factory.h"
+#include "DANA/DApplication.h"
 #include <DAQ/Df250PulseIntegral.h>
 #include <DAQ/Df250Config.h>
 #include <DAQ/DCODAROCInfo.h>
@@ -82,6 +83,11 @@ jerror_t DTOFHit_factory::init(void)
   TOF_NUM_BARS = 44;
   TOF_MAX_CHANNELS = 176;
   
+  // tables loaded once for all threads by the shared calibration cache
+  DApplication* dapp = dynamic_cast<DApplication*>(japp);
+  calib_cache = dapp->GetCalibCache();
+  // (not declared for prefetch: the CCDB directory comes from DTOFGeometry)
+
   return NOERROR;
 }
 
@@ -132,7 +138,7 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 
       vector<double> time_cut_values;
       string locTOFHitTimeCutTable = tofGeom.Get_CCDB_DirectoryName() + "/HitTimeCut";
-      if(eventLoop->GetCalib(locTOFHitTimeCutTable.c_str(), time_cut_values)){
+      if(calib_cache->GetCalib(eventLoop, locTOFHitTimeCutTable.c_str(), time_cut_values)){
 	jout << "Error loading " << locTOFHitTimeCutTable << " SET DEFUALT to 0 and 100!" << endl;
 	TimeCenterCut = 0.;
 	TimeWidthCut = 100.;
@@ -157,7 +163,7 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
     // load scale factors
     map<string,double> scale_factors;
 	string locTOFDigiScalesTable = tofGeom.Get_CCDB_DirectoryName() + "/digi_scales";
-    if(eventLoop->GetCalib(locTOFDigiScalesTable.c_str(), scale_factors))
+    if(calib_cache->GetCalib(eventLoop, locTOFDigiScalesTable.c_str(), scale_factors))
       jout << "Error loading " << locTOFDigiScalesTable << " !" << endl;
     if( scale_factors.find("TOF_ADC_ASCALE") != scale_factors.end() ) {
       ;	//a_scale = scale_factors["TOF_ADC_ASCALE"];
@@ -173,7 +179,7 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
     // load base time offset
     map<string,double> base_time_offset;
 	string locTOFBaseTimeOffsetTable = tofGeom.Get_CCDB_DirectoryName() + "/base_time_offset";
-    if (eventLoop->GetCalib(locTOFBaseTimeOffsetTable.c_str(),base_time_offset))
+    if (calib_cache->GetCalib(eventLoop, locTOFBaseTimeOffsetTable.c_str(),base_time_offset))
       jout << "Error loading " << locTOFBaseTimeOffsetTable << " !" << endl;
     if (base_time_offset.find("TOF_BASE_TIME_OFFSET") != base_time_offset.end())
       t_base = base_time_offset["TOF_BASE_TIME_OFFSET"];
@@ -187,19 +193,19 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
     
     // load constant tables
     string locTOFPedestalsTable = tofGeom.Get_CCDB_DirectoryName() + "/pedestals";
-    if(eventLoop->GetCalib(locTOFPedestalsTable.c_str(), raw_adc_pedestals))
+    if(calib_cache->GetCalib(eventLoop, locTOFPedestalsTable.c_str(), raw_adc_pedestals))
       jout << "Error loading " << locTOFPedestalsTable << " !" << endl;
     string locTOFGainsTable = tofGeom.Get_CCDB_DirectoryName() + "/gains";
-    if(eventLoop->GetCalib(locTOFGainsTable.c_str(), raw_adc_gains))
+    if(calib_cache->GetCalib(eventLoop, locTOFGainsTable.c_str(), raw_adc_gains))
       jout << "Error loading " << locTOFGainsTable << " !" << endl;
     string locTOFADCTimeOffetsTable = tofGeom.Get_CCDB_DirectoryName() + "/adc_timing_offsets";
-    if(eventLoop->GetCalib(locTOFADCTimeOffetsTable.c_str(), raw_adc_offsets))
+    if(calib_cache->GetCalib(eventLoop, locTOFADCTimeOffetsTable.c_str(), raw_adc_offsets))
       jout << "Error loading " << locTOFADCTimeOffetsTable << " !" << endl;
     
     // check which walk correction to use:
     string locTOFWalkCorrectionType = tofGeom.Get_CCDB_DirectoryName() + "/walkcorr_type";
     vector<int> walkcorrtype;
-    if(eventLoop->GetCalib(locTOFWalkCorrectionType.c_str(), walkcorrtype)) {
+    if(calib_cache->GetCalib(eventLoop, locTOFWalkCorrectionType.c_str(), walkcorrtype)) {
       jout<<"\033[1;31m";  // red text";
       jout<< "Error loading "<<locTOFWalkCorrectionType<<" !\033[0m" << endl;
       return (jerror_t)101;
@@ -211,11 +217,11 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
       {
 	if(print_messages) jout<<"TOF: USE WALK CORRECTION TYPE 1"<<endl;
 	string locTOFTimewalkTable = tofGeom.Get_CCDB_DirectoryName() + "/timewalk_parms";
-	if(eventLoop->GetCalib(locTOFTimewalkTable.c_str(), timewalk_parameters)){
+	if(calib_cache->GetCalib(eventLoop, locTOFTimewalkTable.c_str(), timewalk_parameters)){
 	  jout << "Error loading "<<locTOFTimewalkTable<<" !" << endl;
 	}
 	string locTOFChanOffsetTable1 = tofGeom.Get_CCDB_DirectoryName() + "/timing_offsets";
-	if(eventLoop->GetCalib(locTOFChanOffsetTable1.c_str(), raw_tdc_offsets)){
+	if(calib_cache->GetCalib(eventLoop, locTOFChanOffsetTable1.c_str(), raw_tdc_offsets)){
 	  jout << "Error loading "<<locTOFChanOffsetTable1<<" !" << endl;
 	}
       }
@@ -226,11 +232,11 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 	if(print_messages) jout<<"TOF: USE WALK CORRECTION TYPE 2"<<endl;
 	USE_AMP_4WALKCORR = 1;
 	string locTOFTimewalkAMPTable = tofGeom.Get_CCDB_DirectoryName() + "/timewalk_parms_AMP";
-	if(eventLoop->GetCalib(locTOFTimewalkAMPTable.c_str(), timewalk_parameters_AMP)){
+	if(calib_cache->GetCalib(eventLoop, locTOFTimewalkAMPTable.c_str(), timewalk_parameters_AMP)){
 	  jout << "Error loading "<<locTOFTimewalkAMPTable<<" !" << endl;
 	}
 	string locTOFChanOffsetTable2 = tofGeom.Get_CCDB_DirectoryName() + "/timing_offsets";
-	if(eventLoop->GetCalib(locTOFChanOffsetTable2.c_str(), raw_tdc_offsets)){
+	if(calib_cache->GetCalib(eventLoop, locTOFChanOffsetTable2.c_str(), raw_tdc_offsets)){
 	  jout << "Error loading "<<locTOFChanOffsetTable2<<" !" << endl;
 	}
       }
@@ -241,11 +247,11 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 	if(print_messages) jout<<"TOF: USE WALK CORRECTION TYPE 3"<<endl;
 	USE_NEWAMP_4WALKCORR = 1;
 	string locTOFChanOffsetNEWAMPTable = tofGeom.Get_CCDB_DirectoryName() + "/timing_offsets_NEWAMP";
-	if(eventLoop->GetCalib(locTOFChanOffsetNEWAMPTable.c_str(), raw_tdc_offsets)) {
+	if(calib_cache->GetCalib(eventLoop, locTOFChanOffsetNEWAMPTable.c_str(), raw_tdc_offsets)) {
 	  jout<< "Error loading "<<locTOFChanOffsetNEWAMPTable<<" !" << endl;
 	}
 	string locTOFTimewalkNEWAMPTable = tofGeom.Get_CCDB_DirectoryName() + "/timewalk_parms_NEWAMP";
-	if(eventLoop->GetCalib(locTOFTimewalkNEWAMPTable.c_str(), timewalk_parameters_NEWAMP)){
+	if(calib_cache->GetCalib(eventLoop, locTOFTimewalkNEWAMPTable.c_str(), timewalk_parameters_NEWAMP)){
 	  jout << "Error loading "<<locTOFTimewalkNEWAMPTable<<" !" << endl;
 	}
       }
@@ -256,11 +262,11 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
 	if(print_messages) jout<<"TOF: USE WALK CORRECTION TYPE 4"<<endl;
 	USE_NEW_WALK_NEW = 1;
 	string locTOFTimewalkNEWTable = tofGeom.Get_CCDB_DirectoryName() + "/timewalk_parms_5PAR";
-	if(eventLoop->GetCalib(locTOFTimewalkNEWTable.c_str(), timewalk_parameters_5PAR)){
+	if(calib_cache->GetCalib(eventLoop, locTOFTimewalkNEWTable.c_str(), timewalk_parameters_5PAR)){
 	  jout << "Error loading "<<locTOFTimewalkNEWTable<<" !" << endl;
 	}
 	string locTOFChanOffsetTable = tofGeom.Get_CCDB_DirectoryName() + "/timing_offsets_5PAR";
-	if(eventLoop->GetCalib(locTOFChanOffsetTable.c_str(), raw_tdc_offsets)){
+	if(calib_cache->GetCalib(eventLoop, locTOFChanOffsetTable.c_str(), raw_tdc_offsets)){
 	  jout << "Error loading "<<locTOFChanOffsetTable<<" !" << endl;
 	}
       }
@@ -276,7 +282,7 @@ jerror_t DTOFHit_factory::brun(jana::JEventLoop *eventLoop, int32_t runnumber)
     
     
     string locTOFADC2ETable = tofGeom.Get_CCDB_DirectoryName() + "/adc2E";
-    if(eventLoop->GetCalib(locTOFADC2ETable.c_str(), raw_adc2E))
+    if(calib_cache->GetCalib(eventLoop, locTOFADC2ETable.c_str(), raw_adc2E))
       jout << "Error loading " << locTOFADC2ETable << " !" << endl;
     
     // make sure we have one entry per channel
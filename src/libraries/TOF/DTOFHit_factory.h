@@ -14,6 +14,7 @@
 using namespace std;
 
 #include <JANA/JFactory.h>
+#include "DANA/DCalibCache.h"
 #include "DTOFDigiHit.h"
 #include "DTOFTDCDigiHit.h"
 #include "DTOFHit.h"
@@ -106,6 +107,7 @@ class DTOFHit_factory:public jana::JFactory<DTOFHit>{
   double CalcWalkCorrNEW5PAR(DTOFHit* hit);
 
   bool CHECK_FADC_ERRORS;
+  DCalibCache *calib_cache;
 };
 
 #endif // _DTOFHit_factory_
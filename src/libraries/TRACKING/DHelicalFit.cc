@@ -12,6 +12,7 @@ using namespace std;
 #include <math.h>
 
 #include "DHelicalFit.h"
+#include "DRiemannFitEngine.h"
 #define qBr2p 0.003  // conversion for converting q*B*r to GeV/c
 
 #define ONE_THIRD  0.33333333333333333
@@ -509,46 +510,13 @@ jerror_t DHelicalFit::FitCircleRiemann(float rc){
 /// fitting planes in (x,y, w=x^2+y^2) space
 ///
   size_t num_hits=hits.size();
-  DMatrix X(num_hits,3);
-  DMatrix Xavg(1,3);
   DMatrix A(3,3);
-  // vector of ones
-  DMatrix OnesT(1,num_hits);
+  double Xavg[3];
   double W_sum=0.;
-  DMatrix W(num_hits,num_hits);
 
   // Make sure hit list is ordered in z
   std::sort(hits.begin(),hits.end(),RiemannFit_hit_cmp);
  
-  // Covariance matrix
-  DMatrix CRPhi(num_hits,num_hits);
-  for (unsigned int i=0;i<num_hits;i++){
-    CRPhi(i,i)=hits[i]->covrphi;
-  }
-  
-  // Apply a correction for non-normal track incidence if we already have a 
-  // guess for rc.
-  if (rc>0.){
-    DMatrix C(num_hits,num_hits);
-    DMatrix S(num_hits,num_hits);
-    DMatrix CR(num_hits,num_hits);
-    for (unsigned int i=0;i<num_hits;i++){
-      S(i,i)=0.;
-      C(i,i)=1.;
-      CR(i,i)=hits[i]->covr;
-
-      double rtemp=sqrt(hits[i]->x*hits[i]->x+hits[i]->y*hits[i]->y); 
-      double stemp=rtemp/(4.*rc);
-      double ctemp=1.-stemp*stemp;
-      if (ctemp>0){
-	S(i,i)=stemp;
-	C(i,i)=sqrt(ctemp);
-      }
-    }
-    // Correction for non-normal incidence of track on FDC 
-    CRPhi=C*CRPhi*C+S*CR*S;
-  }
-
   // The goal is to find the eigenvector corresponding to the smallest 
   // eigenvalue of the equation
   //            lambda=n^T (X^T W X - W_sum Xavg^T Xavg)n
@@ -557,19 +525,23 @@ jerror_t DHelicalFit::FitCircleRiemann(float rc){
   // and W is the weight matrix, assumed for now to be diagonal.
   // In the absence of multiple scattering, W_sum is the sum of all the 
   // diagonal elements in W.
-
+  DRiemannFitEngine &engine=DRiemannFitEngine::Get_ThreadInstance();
+  engine.Reset(num_hits);
   for (unsigned int i=0;i<num_hits;i++){
-    X(i,0)=hits[i]->x;
-    X(i,1)=hits[i]->y;
-    X(i,2)=hits[i]->x*hits[i]->x+hits[i]->y*hits[i]->y;
-    OnesT(0,i)=1.;
-    W(i,i)=1./CRPhi(i,i);
-    W_sum+=W(i,i);
+    // Covariance matrix (diagonal)
+    double CRPhi=hits[i]->covrphi;
+  
+    // Apply a correction for non-normal track incidence if we already have a 
+    // guess for rc.
+    if (rc>0.){
+      double rtemp=sqrt(hits[i]->x*hits[i]->x+hits[i]->y*hits[i]->y); 
+      double stemp=rtemp/(4.*rc);
+      CRPhi=DRiemannFitEngine::CorrectVarRPhi(CRPhi,hits[i]->covr,stemp);
+    }
+    engine.SetPoint(i,hits[i]->x,hits[i]->y,1./CRPhi);
   }
-  Xavg=(1./W_sum)*(OnesT*(W*X));
+  engine.CalcMoments(A,Xavg,W_sum);
 
-  A=DMatrix(DMatrix::kTransposed,X)*(W*X)
-    -W_sum*(DMatrix(DMatrix::kTransposed,Xavg)*Xavg);
   if(!A.IsValid())return UNRECOVERABLE_ERROR;
 
   // The characteristic equation is 
@@ -630,7 +602,7 @@ jerror_t DHelicalFit::FitCircleRiemann(float rc){
   }
 
   // Distance to origin
-  c_origin=-(N[0]*Xavg(0,0)+N[1]*Xavg(0,1)+N[2]*Xavg(0,2));
+  c_origin=-(N[0]*Xavg[0]+N[1]*Xavg[1]+N[2]*Xavg[2]);
 
   // Center and radius of the circle
   double one_over_2Nz=1./(2.*N[2]);
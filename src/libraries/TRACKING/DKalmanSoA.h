@@ -0,0 +1,198 @@
+// $Id$
+//
+//    File: DKalmanSoA.h
+//
+
+#ifndef _DKalmanSoA_
+#define _DKalmanSoA_
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#include <DMatrixSIMD.h>
+
+// Number of tracks propagated together: one AVX-512 register of doubles,
+// otherwise one AVX(2) register (also used for the portable loops).
+#if defined(__AVX512F__)
+#define KALMAN_SOA_LANES 8
+#else
+#define KALMAN_SOA_LANES 4
+#endif
+
+/// Structure-of-arrays state vectors and covariance matrices for
+/// KALMAN_SOA_LANES independent tracks following the forward parametrization
+/// of DTrackFitterKalmanSIMD. Element (i,j) of the matrices of all lanes is
+/// stored contiguously, so the propagation step through the reference
+/// trajectory
+///
+///   S = S0 + J*(S-S0_)
+///   C = Q + J*C*J^T
+///
+/// is done for all lanes at once with AVX-512/AVX vector instructions (plain
+/// loops over the lanes when neither is enabled, e.g. build with
+/// CXXFLAGS=-mavx2 or -mavx512f to use them). Only this step is vectorised:
+/// the hit updates (Kalman gain, S and C updates, chi2, pruning) are done
+/// lane by lane with the scalar DMatrix code of the fitter.
+///
+/// The sums are done in the same order as in DMatrix5x1/DMatrix5x5 (AddSym
+/// computes the upper triangle and mirrors it) with separate multiplies and
+/// adds, so each lane reproduces the scalar propagation bit for bit when
+/// the scalar code is built without USE_SSE2 and without fused multiply-adds
+/// (-mavx2 without -mfma, or -ffp-contract=off). With FMA contraction of the
+/// scalar code the results differ in the last bits; with USE_SSE2 the scalar
+/// matrices sum in a different order, so the rounding differs from the first
+/// step and the lockstep propagation is not faster than the scalar SSE2 one.
+/// Rounding differences can change which hits pass the chi2 cuts, so the
+/// agreement of the full fits is not guaranteed by the above: validate it
+/// with the kalman_lockstep_compare plugin.
+/// Unused lanes are zero-filled and propagate zeros.
+class DKalmanSoA{
+ public:
+  enum{kLanes=KALMAN_SOA_LANES};
+
+  DKalmanSoA(){
+    for (unsigned int lane=0;lane<kLanes;lane++) ClearLane(lane);
+  }
+
+  // Current state vector and covariance matrix of one lane
+  void SetLane(unsigned int lane,const DMatrix5x1 &S,const DMatrix5x5 &C){
+    for (unsigned int i=0;i<5;i++){
+      mS[i][lane]=S(i);
+      for (unsigned int j=0;j<5;j++) mC[i][j][lane]=C(i,j);
+    }
+  }
+  void GetLane(unsigned int lane,DMatrix5x1 &S,DMatrix5x5 &C) const{
+    for (unsigned int i=0;i<5;i++){
+      S(i)=mS[i][lane];
+      for (unsigned int j=0;j<5;j++) C(i,j)=mC[i][j][lane];
+    }
+  }
+
+  // Reference trajectory at the next step (S0,J,Q) and at the last step (S0_)
+  void SetStep(unsigned int lane,const DMatrix5x1 &S0,const DMatrix5x1 &S0_,
+	       const DMatrix5x5 &J,const DMatrix5x5 &Q){
+    for (unsigned int i=0;i<5;i++){
+      mS0[i][lane]=S0(i);
+      mS0_[i][lane]=S0_(i);
+      for (unsigned int j=0;j<5;j++){
+	mJ[i][j][lane]=J(i,j);
+	mQ[i][j][lane]=Q(i,j);
+      }
+    }
+  }
+
+  void ClearLane(unsigned int lane){
+    for (unsigned int i=0;i<5;i++){
+      mS[i][lane]=mS0[i][lane]=mS0_[i][lane]=0.;
+      for (unsigned int j=0;j<5;j++){
+	mC[i][j][lane]=mJ[i][j][lane]=mQ[i][j][lane]=0.;
+      }
+    }
+  }
+
+  // Propagate all lanes by one step
+  void Propagate(void){
+    double dS[5][kLanes];
+    double JC[5][5][kLanes];
+    double temp[kLanes];
+
+    // S=S0+J*(S-S0_)
+    for (unsigned int i=0;i<5;i++) Sub(dS[i],mS[i],mS0_[i]);
+    for (unsigned int i=0;i<5;i++){
+      Mul(temp,mJ[i][0],dS[0]);
+      for (unsigned int k=1;k<5;k++) MulAdd(temp,mJ[i][k],dS[k]);
+      Add(mS[i],mS0[i],temp);
+    }
+
+    // J*C
+    for (unsigned int i=0;i<5;i++){
+      for (unsigned int j=0;j<5;j++){
+	Zero(JC[i][j]);
+	for (unsigned int k=0;k<5;k++) MulAdd(JC[i][j],mJ[i][k],mC[k][j]);
+      }
+    }
+    // C=Q+(J*C)*J^T, upper triangle mirrored
+    for (unsigned int i=0;i<5;i++){
+      for (unsigned int j=i;j<5;j++){
+	Zero(temp);
+	for (unsigned int k=0;k<5;k++) MulAdd(temp,JC[i][k],mJ[j][k]);
+	Add(mC[i][j],mQ[i][j],temp);
+	if (j!=i) Copy(mC[j][i],mC[i][j]);
+      }
+    }
+  }
+
+ private:
+  // Operations on one element of all lanes
+#if defined(__AVX512F__)
+  static void Zero(double *a){_mm512_storeu_pd(a,_mm512_setzero_pd());}
+  static void Copy(double *a,const double *b){
+    _mm512_storeu_pd(a,_mm512_loadu_pd(b));
+  }
+  static void Add(double *a,const double *b,const double *c){
+    _mm512_storeu_pd(a,_mm512_add_pd(_mm512_loadu_pd(b),_mm512_loadu_pd(c)));
+  }
+  static void Sub(double *a,const double *b,const double *c){
+    _mm512_storeu_pd(a,_mm512_sub_pd(_mm512_loadu_pd(b),_mm512_loadu_pd(c)));
+  }
+  static void Mul(double *a,const double *b,const double *c){
+    _mm512_storeu_pd(a,_mm512_mul_pd(_mm512_loadu_pd(b),_mm512_loadu_pd(c)));
+  }
+  // a+=b*c, not fused
+  static void MulAdd(double *a,const double *b,const double *c){
+    __m512d bc=_mm512_mul_pd(_mm512_loadu_pd(b),_mm512_loadu_pd(c));
+    _mm512_storeu_pd(a,_mm512_add_pd(_mm512_loadu_pd(a),bc));
+  }
+#elif defined(__AVX__)
+  static void Zero(double *a){_mm256_storeu_pd(a,_mm256_setzero_pd());}
+  static void Copy(double *a,const double *b){
+    _mm256_storeu_pd(a,_mm256_loadu_pd(b));
+  }
+  static void Add(double *a,const double *b,const double *c){
+    _mm256_storeu_pd(a,_mm256_add_pd(_mm256_loadu_pd(b),_mm256_loadu_pd(c)));
+  }
+  static void Sub(double *a,const double *b,const double *c){
+    _mm256_storeu_pd(a,_mm256_sub_pd(_mm256_loadu_pd(b),_mm256_loadu_pd(c)));
+  }
+  static void Mul(double *a,const double *b,const double *c){
+    _mm256_storeu_pd(a,_mm256_mul_pd(_mm256_loadu_pd(b),_mm256_loadu_pd(c)));
+  }
+  // a+=b*c, not fused
+  static void MulAdd(double *a,const double *b,const double *c){
+    __m256d bc=_mm256_mul_pd(_mm256_loadu_pd(b),_mm256_loadu_pd(c));
+    _mm256_storeu_pd(a,_mm256_add_pd(_mm256_loadu_pd(a),bc));
+  }
+#else
+  static void Zero(double *a){
+    for (unsigned int l=0;l<kLanes;l++) a[l]=0.;
+  }
+  static void Copy(double *a,const double *b){
+    for (unsigned int l=0;l<kLanes;l++) a[l]=b[l];
+  }
+  static void Add(double *a,const double *b,const double *c){
+    for (unsigned int l=0;l<kLanes;l++) a[l]=b[l]+c[l];
+  }
+  static void Sub(double *a,const double *b,const double *c){
+    for (unsigned int l=0;l<kLanes;l++) a[l]=b[l]-c[l];
+  }
+  static void Mul(double *a,const double *b,const double *c){
+    for (unsigned int l=0;l<kLanes;l++) a[l]=b[l]*c[l];
+  }
+  static void MulAdd(double *a,const double *b,const double *c){
+    for (unsigned int l=0;l<kLanes;l++){
+      double bc=b[l]*c[l];
+      a[l]+=bc;
+    }
+  }
+#endif
+
+  double mS[5][kLanes];
+  double mS0[5][kLanes];
+  double mS0_[5][kLanes];
+  double mC[5][5][kLanes];
+  double mJ[5][5][kLanes];
+  double mQ[5][5][kLanes];
+};
+
+#endif // _DKalmanSoA_
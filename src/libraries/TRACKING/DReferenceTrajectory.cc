@@ -8,6 +8,7 @@
 #include <signal.h>
 #include <memory>
 #include <cmath>
+#include <map>
 
 #include <DVector3.h>
 using namespace std;
@@ -24,7 +25,47 @@ using namespace std;
 #define EPS 1e-8
 #define QuietNaN std::numeric_limits<double>::quiet_NaN()
 
-struct StepStruct {DReferenceTrajectory::swim_step_t steps[256];};
+#define SWIM_STEP_BLOCK_SIZE 128 // smallest block of swim steps taken from the arena
+#define MAX_FREE_SWIM_STEP_BLOCKS 8 // per block size, per thread
+#define SWIM_STEPS_PER_STEP_LEAF 16 // pairs of consecutive swim steps in a leaf of the step index
+
+//---------------------------------
+// swim_step_arena_t
+//---------------------------------
+// Free lists of swim step blocks for one thread, by block size. Trajectories
+// that own their swim steps take the smallest block that fits (starting with
+// SWIM_STEP_BLOCK_SIZE steps and doubling up to TRK:MAX_SWIM_STEPS) and give
+// it back when they are destroyed or need a larger one. The blocks are then
+// reused by the next trajectory swum on the thread rather than every
+// trajectory holding TRK:MAX_SWIM_STEPS steps for its whole life.
+class DReferenceTrajectory::swim_step_arena_t{
+	public:
+		~swim_step_arena_t(){
+			for(auto &blocks : free_blocks)
+				for(auto block : blocks.second)delete[] block;
+		}
+
+		swim_step_t* Get(int capacity){
+			vector<swim_step_t*> &blocks = free_blocks[capacity];
+			if(blocks.empty())return new swim_step_t[capacity];
+			swim_step_t *block = blocks.back();
+			blocks.pop_back();
+			return block;
+		}
+
+		void Recycle(swim_step_t *block, int capacity){
+			vector<swim_step_t*> &blocks = free_blocks[capacity];
+			if(blocks.size()<MAX_FREE_SWIM_STEP_BLOCKS)
+				blocks.push_back(block);
+			else
+				delete[] block;
+		}
+
+	private:
+		map<int, vector<swim_step_t*> > free_blocks;
+};
+
+thread_local shared_ptr<DReferenceTrajectory::swim_step_arena_t> DReferenceTrajectory::dSwimStepArena = make_shared<DReferenceTrajectory::swim_step_arena_t>();
 
 //---------------------------------
 // DReferenceTrajectory    (Constructor)
@@ -59,31 +100,41 @@ DReferenceTrajectory::DReferenceTrajectory(const DMagneticFieldMap *bfield
 	this->last_dz_dphi = 0.0;
 	
 	this->debug_level = 0;
+	this->step_index_valid = false;
 	
 	// Initialize some values from configuration parameters
 	BOUNDARY_STEP_FRACTION = 0.80;
 	MIN_STEP_SIZE = 0.1;	// cm
 	MAX_STEP_SIZE = 3.0;		// cm
 	int MAX_SWIM_STEPS = 2500;
+	use_step_index = true;
+	check_step_index = false;
 	
 	gPARMS->SetDefaultParameter("TRK:BOUNDARY_STEP_FRACTION" , BOUNDARY_STEP_FRACTION, "Fraction of estimated distance to boundary to use as step size");
 	gPARMS->SetDefaultParameter("TRK:MIN_STEP_SIZE" , MIN_STEP_SIZE, "Minimum step size in cm to take when swimming a track with adaptive step sizes");
 	gPARMS->SetDefaultParameter("TRK:MAX_STEP_SIZE" , MAX_STEP_SIZE, "Maximum step size in cm to take when swimming a track with adaptive step sizes");
 	gPARMS->SetDefaultParameter("TRK:MAX_SWIM_STEPS" , MAX_SWIM_STEPS, "Number of swim steps for DReferenceTrajectory to allocate memory for (when not using external buffer)");
+	gPARMS->SetDefaultParameter("TRK:USE_STEP_INDEX" , use_step_index, "Find the swim step closest to a wire from an index of the steps that skips the parts of the trajectory heading towards the wire. Gives the same step as searching from the first step (set to 0 to do that instead)");
+	gPARMS->SetDefaultParameter("TRK:CHECK_STEP_INDEX" , check_step_index, "Debug: also search from the first step and report wires for which the indexed search found a different step (default false)");
 	gPARMS->SetDefaultParameter("TRK:DEBUG_LEVEL" , this->debug_level);
 	
 	// It turns out that the greatest bottleneck in speed here comes from
 	// allocating/deallocating the large block of memory required to hold
 	// all of the trajectory info. The preferred way of calling this is 
-	// with a pointer allocated once at program startup. This code block
-	// though allows it to be allocated here if necessary.
+	// with a pointer allocated once at program startup. Otherwise, the
+	// steps are taken from the thread's arena: a small block here that is
+	// grown while swimming (up to max_swim_steps if given, TRK:MAX_SWIM_STEPS
+	// if not).
 	if(!swim_steps){
 		own_swim_steps = true;
-		this->max_swim_steps = MAX_SWIM_STEPS;
-		this->swim_steps = new swim_step_t[this->max_swim_steps];
+		this->max_swim_steps = 0;
+		this->max_swim_steps_limit = max_swim_steps>0 ? max_swim_steps:MAX_SWIM_STEPS;
+		this->swim_steps = NULL;
+		Reserve_SwimSteps(1);
 	}else{
 		own_swim_steps = false;
 		this->max_swim_steps = max_swim_steps;
+		this->max_swim_steps_limit = max_swim_steps;
 		this->swim_steps = swim_steps;
 	}
 }
@@ -99,7 +150,8 @@ DReferenceTrajectory::DReferenceTrajectory(const DReferenceTrajectory& rt)
 
 	this->Nswim_steps = rt.Nswim_steps;
 	this->q = rt.q;
-	this->max_swim_steps = rt.max_swim_steps;
+	this->max_swim_steps = 0;
+	this->max_swim_steps_limit = rt.max_swim_steps_limit;
 	this->own_swim_steps = true;
 	this->step_size = rt.step_size;
 	this->bfield = rt.bfield;
@@ -117,13 +169,17 @@ DReferenceTrajectory::DReferenceTrajectory(const DReferenceTrajectory& rt)
 	this->MIN_STEP_SIZE = rt.GetMinStepSize();
 	this->MAX_STEP_SIZE = rt.GetMaxStepSize();
 	this->debug_level=rt.debug_level;
+	this->use_step_index = rt.use_step_index;
+	this->check_step_index = rt.check_step_index;
+	this->step_index_valid = false;
 	this->zmin_track_boundary = -100.0;  // boundary at which to stop swimming
 	this->zmax_track_boundary = 670.0;   // boundary at which to stop swimming
 	this->Rsqmax_interior = 65.0*65.0; // Maximum radius (in cm) corresponding to inside of BCAL
 	this->Rsqmax_exterior = 88.0*88.0; // Maximum radius (in cm) corresponding to outside of BCAL
 	
 
-	this->swim_steps = new swim_step_t[this->max_swim_steps];
+	this->swim_steps = NULL;
+	Reserve_SwimSteps(Nswim_steps>0 ? Nswim_steps:1);
 	this->last_swim_step = NULL;
 	for(int i=0; i<Nswim_steps; i++)
 	{
@@ -149,20 +205,20 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 	
 	if(&rt == this)return *this; // protect against self copies
 
-	// Free memory if block is too small
+	// Give back memory if block is too small
 	if(own_swim_steps==true && max_swim_steps<rt.Nswim_steps){
-		delete[] swim_steps;
-		swim_steps=NULL;
+		Release_SwimSteps();
 	}
 	
 	// Forget memory block if we don't currently own it
 	if(!own_swim_steps){
 		swim_steps=NULL;
+		max_swim_steps=0;
 	}
 
 	this->Nswim_steps = rt.Nswim_steps;
 	this->q = rt.q;
-	this->max_swim_steps = rt.max_swim_steps;
+	this->max_swim_steps_limit = rt.max_swim_steps_limit;
 	this->own_swim_steps = true;
 	this->step_size = rt.step_size;
 	this->bfield = rt.bfield;
@@ -179,9 +235,17 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 	this->BOUNDARY_STEP_FRACTION = rt.GetBoundaryStepFraction();
 	this->MIN_STEP_SIZE = rt.GetMinStepSize();
 	this->MAX_STEP_SIZE = rt.GetMaxStepSize();
+	this->use_step_index = rt.use_step_index;
+	this->check_step_index = rt.check_step_index;
+	this->step_index_valid = false;
 
 	// Allocate memory if needed
-	if(swim_steps==NULL)this->swim_steps = new swim_step_t[this->max_swim_steps];
+	if(swim_steps==NULL){
+		int Nsteps = Nswim_steps;
+		Nswim_steps = 0; // nothing to keep
+		Reserve_SwimSteps(Nsteps>0 ? Nsteps:1);
+		Nswim_steps = Nsteps;
+	}
 
 	// Copy swim steps
 	this->last_swim_step = NULL;
@@ -202,10 +266,76 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 DReferenceTrajectory::~DReferenceTrajectory()
 {
 	if(own_swim_steps){
-		delete[] swim_steps;
+		Release_SwimSteps();
 	}
 }
 
+//---------------------------------
+// Reserve_SwimSteps
+//---------------------------------
+bool DReferenceTrajectory::Reserve_SwimSteps(int num_steps)
+{
+	/// Make sure there is room for num_steps swim steps, moving the
+	/// first Nswim_steps of them to a larger block from the thread's
+	/// arena if needed. Returns false if there is not enough room and
+	/// the steps are not ours, or if more than max_swim_steps_limit
+	/// steps are asked for.
+	if(swim_steps!=NULL && num_steps<=max_swim_steps)return true;
+	if(!own_swim_steps || num_steps>max_swim_steps_limit)return false;
+
+	int capacity = SWIM_STEP_BLOCK_SIZE;
+	while(capacity<num_steps)capacity*=2;
+	if(capacity>max_swim_steps_limit)capacity = max_swim_steps_limit;
+
+	swim_step_t *new_swim_steps = dSwimStepArena->Get(capacity);
+	if(swim_steps!=NULL){
+		for(int i=0; i<Nswim_steps; i++)new_swim_steps[i] = swim_steps[i];
+		if(last_swim_step!=NULL)last_swim_step = &new_swim_steps[last_swim_step - swim_steps];
+		Release_SwimSteps();
+	}
+	swim_steps = new_swim_steps;
+	max_swim_steps = capacity;
+	swim_step_arena = dSwimStepArena;
+
+	return true;
+}
+
+//---------------------------------
+// Grow_SwimSteps
+//---------------------------------
+bool DReferenceTrajectory::Grow_SwimSteps(swim_step_t* &swim_step, swim_step_t* &last_step)
+{
+	/// Called when swimming runs out of room: double the number of steps
+	/// (up to max_swim_steps_limit) and move the pointers the swim loop
+	/// holds into the new block.
+	int istep = swim_step - swim_steps;
+	int ilast_step = last_step!=NULL ? (last_step - swim_steps):-1;
+	if(!Reserve_SwimSteps(max_swim_steps+1))return false;
+	swim_step = &swim_steps[istep];
+	if(ilast_step>=0)last_step = &swim_steps[ilast_step];
+
+	return true;
+}
+
+//---------------------------------
+// Release_SwimSteps
+//---------------------------------
+void DReferenceTrajectory::Release_SwimSteps(void)
+{
+	/// Give the owned swim steps back to the arena they came from. If the
+	/// trajectory is being deleted on another thread, the block is freed
+	/// instead since that arena is not ours to touch.
+	if(own_swim_steps && swim_steps!=NULL){
+		if(swim_step_arena!=NULL && swim_step_arena==dSwimStepArena)
+			swim_step_arena->Recycle(swim_steps, max_swim_steps);
+		else
+			delete[] swim_steps;
+	}
+	swim_steps = NULL;
+	max_swim_steps = 0;
+	swim_step_arena = NULL;
+}
+
 //---------------------------------
 // CopyWithShift
 //---------------------------------
@@ -216,6 +346,7 @@ void DReferenceTrajectory::CopyWithShift(const DReferenceTrajectory *rt, DVector
 	
 	// Second, shift all positions
 	for(int i=0; i<Nswim_steps; i++)swim_steps[i].origin += shift;
+	Invalidate_StepIndex();
 }
 
 
@@ -235,6 +366,7 @@ void DReferenceTrajectory::Reset(void){
 	this->last_dz_dphi = 0.0;
 	this->dist_to_rt_depth = 0;
 	this->check_material_boundaries = true;
+	Invalidate_StepIndex();
 }
 
 //---------------------------------
@@ -324,6 +456,7 @@ void DReferenceTrajectory::FastSwimForHitSelection(const DVector3 &pos, const DV
   // Step until we leave the active tracking region
   swim_step_t *swim_step = this->swim_steps;
   Nswim_steps = 0;
+  Invalidate_StepIndex();
   double itheta02 = 0.0;
   double itheta02s = 0.0;
   double itheta02s2 = 0.0;
@@ -332,7 +465,7 @@ void DReferenceTrajectory::FastSwimForHitSelection(const DVector3 &pos, const DV
 
   for(double s=0; fabs(s)<1000.; Nswim_steps++, swim_step++){
        
-    if(Nswim_steps>=this->max_swim_steps){
+    if(Nswim_steps>=this->max_swim_steps && !Grow_SwimSteps(swim_step, last_step)){
       if (debug_level>0){
 	jerr<<__FILE__<<":"<<__LINE__<<" Too many steps in trajectory. Truncating..."<<endl;
       }
@@ -447,6 +580,7 @@ void DReferenceTrajectory::FastSwim(const DVector3 &pos, const DVector3 &mom, do
   swim_step_t *swim_step = this->swim_steps;
   double t=0.;
   Nswim_steps = 0;
+  Invalidate_StepIndex();
   double itheta02 = 0.0;
   double itheta02s = 0.0;
   double itheta02s2 = 0.0;
@@ -463,7 +597,7 @@ void DReferenceTrajectory::FastSwim(const DVector3 &pos, const DVector3 &mom, do
 	
   for(double s=0; fabs(s)<smax; Nswim_steps++, swim_step++){
        
-    if(Nswim_steps>=this->max_swim_steps){
+    if(Nswim_steps>=this->max_swim_steps && !Grow_SwimSteps(swim_step, last_step)){
       if (debug_level>0){
 	jerr<<__FILE__<<":"<<__LINE__<<" Too many steps in trajectory. Truncating..."<<endl;
       }
@@ -629,6 +763,7 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 	swim_step_t *swim_step = this->swim_steps;
 	double t=0.;
 	Nswim_steps = 0;
+	Invalidate_StepIndex();
 	double itheta02 = 0.0;
 	double itheta02s = 0.0;
 	double itheta02s2 = 0.0;
@@ -680,7 +815,7 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 	
 	for(double s=0; fabs(s)<smax; Nswim_steps++, swim_step++){
 	
-		if(Nswim_steps>=this->max_swim_steps){
+		if(Nswim_steps>=this->max_swim_steps && !Grow_SwimSteps(swim_step, last_step)){
 		  if (debug_level>0){
 			jerr<<__FILE__<<":"<<__LINE__<<" Too many steps in trajectory. Truncating..."<<endl;
 		  }
@@ -875,7 +1010,7 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 		if(z>zmax_track_boundary){Nswim_steps++; break;} // ran into FCAL
 		if(z<zmin_track_boundary){Nswim_steps++; break;} // exit upstream
 		if(wire && Nswim_steps>0){ // optionally check if we passed a wire we're supposed to be swimming to
-			swim_step_t *closest_step = FindClosestSwimStep(wire);
+			swim_step_t *closest_step = FindClosestSwimStepLinear(wire); // no step index while swimming
 			if(++closest_step!=swim_step){Nswim_steps++; break;}
 		}
 
@@ -1187,20 +1322,22 @@ int DReferenceTrajectory::InsertSteps(const swim_step_t *start_step, double delt
 		direction = -1;
 	}
 	
-	// Here I allocate the steps using an auto_ptr so I don't have to mess with
-	// deleting them at all of the possible exits. The problem with auto_ptr
-	// is it can't handle arrays so it has to be wrapped in a struct.
-	auto_ptr<StepStruct> steps_aptr(new StepStruct);
-	DReferenceTrajectory::swim_step_t *steps = steps_aptr->steps;
-	DReferenceTrajectory rt(bfield , my_q , steps , 256);
+	// The steps of this temporary trajectory come from the thread's arena
+	// and are given back at all of the possible exits.
+	DReferenceTrajectory rt(bfield , my_q , NULL , 256);
 	rt.SetStepSize(step_size);
 	rt.Swim(pos, mom, my_q,NULL,fabs(delta_s));
 	if(rt.Nswim_steps==0)return 1;
 
-	// Check that there is enough space to add these points
+	// Check that there is enough space to add these points (grow if they are ours)
 	if((Nswim_steps+rt.Nswim_steps)>max_swim_steps){
-		//_DBG_<<"Not enough swim steps available to add new ones! Max="<<max_swim_steps<<" had="<<Nswim_steps<<" new="<<rt.Nswim_steps<<endl;
-		return 2;
+		bool start_step_is_ours = start_step>=swim_steps && start_step<swim_steps+Nswim_steps;
+		int istart_step = start_step - swim_steps;
+		if(!Reserve_SwimSteps(Nswim_steps+rt.Nswim_steps)){
+			//_DBG_<<"Not enough swim steps available to add new ones! Max="<<max_swim_steps<<" had="<<Nswim_steps<<" new="<<rt.Nswim_steps<<endl;
+			return 2;
+		}
+		if(start_step_is_ours)start_step = &swim_steps[istart_step];
 	}
 	
 	// At this point, we may have swum forward or backwards so the points
@@ -1248,6 +1385,7 @@ int DReferenceTrajectory::InsertSteps(const swim_step_t *start_step, double delt
 		}
 	}
 	Nswim_steps += rt.Nswim_steps-steps_to_overwrite;
+	Invalidate_StepIndex();
 
 	// Note that the above procedure may leave us with "kinks" in the itheta0 
 	// variables. It may be that we need to recalculate those for all of the 
@@ -1527,6 +1665,204 @@ double DReferenceTrajectory::DistToRT(DVector3 hit, double *s,
 	return sqrt(dist2);
 }
 
+//---------------------------------
+// WireDist2
+//---------------------------------
+static inline double WireDist2(const DCoordinateSystem *wire, const DVector3 &pos)
+{
+	// Distance squared of pos from the wire, adding the distance past
+	// the end of the wire if pos is beyond it. This is the value the
+	// closest swim step is found by, both with and without the step index,
+	// so it must be evaluated the same way for both.
+	double dx = pos.X() - wire->origin.X();
+	double dy = pos.Y() - wire->origin.Y();
+	double dz = pos.Z() - wire->origin.Z();
+	double u = wire->udir.X()*dx + wire->udir.Y()*dy + wire->udir.Z()*dz;
+	double delta2 = dx*dx + dy*dy + dz*dz - u*u;
+	double L_over_2 = wire->L/2.0;
+	if(fabs(u)>L_over_2){
+		double u_minus_L_over_2 = fabs(u) - L_over_2;
+		delta2 += u_minus_L_over_2*u_minus_L_over_2;
+	}
+
+	return delta2;
+}
+
+//---------------------------------
+// Build_StepTree
+//---------------------------------
+void DReferenceTrajectory::Build_StepTree(int inode, int ileaf_lo, int ileaf_hi) const
+{
+	/// Fill node inode of the step index, which covers the pairs of steps
+	/// (i, i+1) of leaves ileaf_lo to ileaf_hi-1, and all nodes below it.
+	/// A node with dmin=0 is never skipped in the search.
+	step_node_t &node = step_nodes[inode];
+	int ipair_lo = ileaf_lo*SWIM_STEPS_PER_STEP_LEAF;
+	int ipair_hi = ileaf_hi*SWIM_STEPS_PER_STEP_LEAF;
+	if(ipair_hi>Nswim_steps-1)ipair_hi = Nswim_steps-1;
+
+	// Chord of the node
+	const DVector3 &first = swim_steps[ipair_lo].origin;
+	const DVector3 &last = swim_steps[ipair_hi].origin;
+	double tx = last.X() - first.X();
+	double ty = last.Y() - first.Y();
+	double tz = last.Z() - first.Z();
+	double chord_length = sqrt(tx*tx + ty*ty + tz*tz);
+	if(chord_length>0.0){
+		tx /= chord_length;
+		ty /= chord_length;
+		tz /= chord_length;
+	}
+	node.tx = tx;
+	node.ty = ty;
+	node.tz = tz;
+
+	if(ileaf_hi-ileaf_lo==1){
+		// Leaf: bounding sphere of the steps the pairs end on, and how far
+		// the directions of the pairs are from the chord
+		double xmin=1.0E30, xmax=-1.0E30, ymin=1.0E30, ymax=-1.0E30, zmin=1.0E30, zmax=-1.0E30;
+		for(int i=ipair_lo+1; i<=ipair_hi; i++){
+			const DVector3 &pos = swim_steps[i].origin;
+			xmin = min(xmin, pos.X()); xmax = max(xmax, pos.X());
+			ymin = min(ymin, pos.Y()); ymax = max(ymax, pos.Y());
+			zmin = min(zmin, pos.Z()); zmax = max(zmax, pos.Z());
+		}
+		node.mx = 0.5*(xmin + xmax);
+		node.my = 0.5*(ymin + ymax);
+		node.mz = 0.5*(zmin + zmax);
+
+		// The distance of a pair's direction from the chord follows from the
+		// sine of the angle between them: |dir-t|^2 = 2sin^2/(1+cos)
+		double rho2 = 0.0;
+		double dmin2 = chord_length>0.0 ? 1.0E30:0.0;
+		double cross2max = 0.0, d2max = 1.0; // largest sin^2 = cross2max/d2max
+		bool backward = false;
+		for(int i=ipair_lo; i<ipair_hi; i++){
+			const DVector3 &pos = swim_steps[i+1].origin;
+			const DVector3 &prev = swim_steps[i].origin;
+			double px = pos.X() - node.mx;
+			double py = pos.Y() - node.my;
+			double pz = pos.Z() - node.mz;
+			rho2 = max(rho2, px*px + py*py + pz*pz);
+
+			double dx = pos.X() - prev.X();
+			double dy = pos.Y() - prev.Y();
+			double dz = pos.Z() - prev.Z();
+			double d2 = dx*dx + dy*dy + dz*dz;
+			if(!(d2>0.0)){
+				dmin2 = 0.0;
+				continue;
+			}
+			dmin2 = min(dmin2, d2);
+			if(dx*tx + dy*ty + dz*tz <= 0.0){
+				backward = true;
+				continue;
+			}
+			double cx = dy*tz - dz*ty;
+			double cy = dz*tx - dx*tz;
+			double cz = dx*ty - dy*tx;
+			double cross2 = cx*cx + cy*cy + cz*cz;
+			if(cross2*d2max > cross2max*d2){
+				cross2max = cross2;
+				d2max = d2;
+			}
+		}
+		node.rho = sqrt(rho2);
+		node.dmin = sqrt(dmin2);
+		double sin2max = cross2max/d2max;
+		if(backward || !(sin2max<1.0)){
+			node.beta = 2.0;
+		}else{
+			node.beta = sqrt(2.0*sin2max/(1.0 + sqrt(1.0 - sin2max)));
+		}
+		return;
+	}
+
+	int ileaf_mid = (ileaf_lo + ileaf_hi)/2;
+	Build_StepTree(2*inode, ileaf_lo, ileaf_mid);
+	Build_StepTree(2*inode+1, ileaf_mid, ileaf_hi);
+
+	// Combine the bounds of the children
+	const step_node_t &left = step_nodes[2*inode];
+	const step_node_t &right = step_nodes[2*inode+1];
+	node.mx = 0.5*(left.mx + right.mx);
+	node.my = 0.5*(left.my + right.my);
+	node.mz = 0.5*(left.mz + right.mz);
+	node.rho = 0.0;
+	node.beta = 0.0;
+	node.dmin = chord_length>0.0 ? min(left.dmin, right.dmin):0.0;
+	const step_node_t *children[2] = {&left, &right};
+	for(int k=0; k<2; k++){
+		const step_node_t *child = children[k];
+		double px = child->mx - node.mx;
+		double py = child->my - node.my;
+		double pz = child->mz - node.mz;
+		double dtx = child->tx - node.tx;
+		double dty = child->ty - node.ty;
+		double dtz = child->tz - node.tz;
+		node.rho = max(node.rho, sqrt(px*px + py*py + pz*pz) + child->rho);
+		node.beta = max(node.beta, sqrt(dtx*dtx + dty*dty + dtz*dtz) + child->beta);
+	}
+}
+
+//---------------------------------
+// Find_StepTreeRise
+//---------------------------------
+int DReferenceTrajectory::Find_StepTreeRise(const DCoordinateSystem *wire, int inode, int ileaf_lo, int ileaf_hi) const
+{
+	/// Return the first pair of steps (i, i+1) of leaves ileaf_lo to
+	/// ileaf_hi-1 for which the distance to the wire goes up, or -1 if it
+	/// does not go up anywhere in them.
+	///
+	/// The squared distance f to the wire (segment) is convex with gradient
+	/// 2v(p), v(p) being the vector to p from the closest point of the wire,
+	/// so f(p_i+1)-f(p_i) <= 2 v(p_i+1).(p_i+1 - p_i). Since v changes by no
+	/// more than p does, v(p_i+1).dir_i <= v(m).t + |v(m)|*beta + rho for all
+	/// pairs of the node, m, rho, t and beta being its center, radius, chord
+	/// and spread of the directions about it. If that is negative enough for
+	/// the distance to go down by more than its rounding error on every pair
+	/// the node is skipped. Otherwise its children are searched, down to the
+	/// leaves which are scanned step by step exactly as in
+	/// FindClosestSwimStepLinear.
+	const step_node_t &node = step_nodes[inode];
+	if(node.dmin>0.0){
+		double ux = wire->udir.X();
+		double uy = wire->udir.Y();
+		double uz = wire->udir.Z();
+		double dx = node.mx - wire->origin.X();
+		double dy = node.my - wire->origin.Y();
+		double dz = node.mz - wire->origin.Z();
+		double L_over_2 = wire->L/2.0;
+		double u = ux*dx + uy*dy + uz*dz;
+		double u_wire = u>L_over_2 ? L_over_2:(u<-L_over_2 ? -L_over_2:u);
+		double vx = dx - u_wire*ux;
+		double vy = dy - u_wire*uy;
+		double vz = dz - u_wire*uz;
+		double slope = vx*node.tx + vy*node.ty + vz*node.tz + sqrt(vx*vx + vy*vy + vz*vz)*node.beta + node.rho;
+		double dmax = sqrt(dx*dx + dy*dy + dz*dz) + node.rho;
+		double tolerance = 1.0E-10*(1.0 + dmax*dmax + wire->L*wire->L);
+		if(-2.0*node.dmin*slope > tolerance)return -1;
+	}
+
+	if(ileaf_hi-ileaf_lo==1){
+		int ipair_lo = ileaf_lo*SWIM_STEPS_PER_STEP_LEAF;
+		int ipair_hi = min(ipair_lo + SWIM_STEPS_PER_STEP_LEAF, Nswim_steps-1);
+		double old_delta2 = WireDist2(wire, swim_steps[ipair_lo].origin);
+		for(int i=ipair_lo; i<ipair_hi; i++){
+			double delta2 = WireDist2(wire, swim_steps[i+1].origin);
+			if(delta2>old_delta2)return i;
+			old_delta2 = delta2;
+		}
+		return -1;
+	}
+
+	int ileaf_mid = (ileaf_lo + ileaf_hi)/2;
+	int ipair = Find_StepTreeRise(wire, 2*inode, ileaf_lo, ileaf_mid);
+	if(ipair>=0)return ipair;
+
+	return Find_StepTreeRise(wire, 2*inode+1, ileaf_mid, ileaf_hi);
+}
+
 //---------------------------------
 // FindClosestSwimStep
 //---------------------------------
@@ -1536,6 +1872,54 @@ DReferenceTrajectory::swim_step_t* DReferenceTrajectory::FindClosestSwimStep(con
 	/// "L" should be the active wire length. The coordinate system
 	/// defined by "wire" should have its origin at the center of
 	/// the wire with the wire running in the direction of udir.
+	///
+	/// This returns the same step as FindClosestSwimStepLinear, i.e. the
+	/// first one after which the distance to the wire goes up, but finds it
+	/// from an index of the steps (see Find_StepTreeRise) which skips the
+	/// parts of the trajectory that head straight towards the wire. Only the
+	/// leaves of the index that cannot be skipped are looked at step by step,
+	/// at most SWIM_STEPS_PER_STEP_LEAF+1 steps each. The index is built the
+	/// first time this is called after a swim (TRK:USE_STEP_INDEX=0 to
+	/// always search from the first step instead).
+	if(!use_step_index || Nswim_steps<2 || !wire || !(wire->L>=0.0))return FindClosestSwimStepLinear(wire, istep_ptr);
+
+	if(istep_ptr)*istep_ptr=-1;
+
+	// As in FindClosestSwimStepLinear, no step is returned if the first
+	// one is farther than 10 m from the wire
+	if(WireDist2(wire, swim_steps[0].origin)>1.0e6)return NULL;
+
+	if(!step_index_valid){
+		Nstep_leaves = (Nswim_steps - 2)/SWIM_STEPS_PER_STEP_LEAF + 1;
+		step_nodes.resize(4*Nstep_leaves);
+		Build_StepTree(1, 0, Nstep_leaves);
+		step_index_valid = true;
+	}
+
+	int istep = Find_StepTreeRise(wire, 1, 0, Nstep_leaves);
+	if(istep<0)istep = Nswim_steps-1;
+
+	if(check_step_index){
+		int istep_linear;
+		FindClosestSwimStepLinear(wire, &istep_linear);
+		if(istep_linear!=istep){
+			_DBG_<<"Indexed search found step "<<istep<<" but the linear search found step "<<istep_linear<<"  Nswim_steps="<<Nswim_steps<<endl;
+		}
+	}
+
+	if(istep_ptr)*istep_ptr=istep;
+	if(debug_level>3)_DBG_<<"found closest step at i="<<istep<<" from step index"<<endl;
+
+	return &swim_steps[istep];
+}
+
+//---------------------------------
+// FindClosestSwimStepLinear
+//---------------------------------
+DReferenceTrajectory::swim_step_t* DReferenceTrajectory::FindClosestSwimStepLinear(const DCoordinateSystem *wire, int *istep_ptr) const
+{
+	/// Find the closest swim step to the given wire by stepping from the
+	/// first step until the distance to the wire starts to increase.
 	
 	if(istep_ptr)*istep_ptr=-1;
 	
@@ -1549,64 +1933,20 @@ DReferenceTrajectory::swim_step_t* DReferenceTrajectory::FindClosestSwimStep(con
 	// Loop over swim steps and find the one closest to the wire
 	swim_step_t *swim_step = swim_steps;
 	swim_step_t *step=NULL;
-	//double min_delta2 = 1.0E6;
 	double old_delta2=1.0e6;
-	double L_over_2 = wire->L/2.0; // half-length of wire in cm
 	int istep=-1;
 
-	double dx, dy, dz;
-  
-  // w is a vector to the origin of the wire
-  // u is a unit vector along the wire
-  
-  double wx, wy, wz;
-  double ux, uy, uz;
-  
-  wx = wire->origin.X();
-  wy = wire->origin.Y();
-  wz = wire->origin.Z();
-  
-  ux = wire->udir.X();
-  uy = wire->udir.Y();
-  uz = wire->udir.Z();
-  
-  int i;
-  for(i=0; i<Nswim_steps; i++, swim_step++){
-		// Find the point's position along the wire. If the point
-		// is past the end of the wire, calculate the distance
-		// from the end of the wire.
-    //		DVector3 pos_diff = swim_step->origin - wire->origin;
-
-    dx = swim_step->origin.X() - wx;
-    dy = swim_step->origin.Y() - wy;
-    dz = swim_step->origin.Z() - wz;
-		
-    //    double u = wire->udir.Dot(pos_diff);
-    double u = ux * dx + uy * dy + uz * dz;
-
-		// Find distance perpendicular to wire
-    //		double delta2 = pos_diff.Mag2() - u*u;
-    double delta2 = dx*dx + dy*dy + dz*dz - u*u;
-
-		// If point is past end of wire, calculate distance
-		// from wire's end by adding on distance along wire direction.
-		if( fabs(u)>L_over_2){
-      //			delta2 += pow(fabs(u)-L_over_2, 2.0);
-		  double u_minus_L_over_2=fabs(u)-L_over_2;
-      delta2 += ( u_minus_L_over_2*u_minus_L_over_2 );
-      // printf("step %d\n",i);
-		}
+	int i;
+	for(i=0; i<Nswim_steps; i++, swim_step++){
+		// Distance squared from the wire, or from the wire's end if
+		// the point is past the end of the wire
+		double delta2 = WireDist2(wire, swim_step->origin);
 
 		if(debug_level>3)_DBG_<<"delta2="<<delta2<<"  old_delta2="<<old_delta2<<endl;
 		if (delta2>old_delta2) break;
 
-		//if(delta2 < min_delta2){
-		//	min_delta2 = delta2;
 		step = swim_step;
 		istep=i;
-
-		//}
-		//printf("%d delta %f min %f\n",i,delta2,min_delta2);
 		old_delta2=delta2;
 	}
 
@@ -2533,7 +2873,7 @@ jerror_t DReferenceTrajectory::FindPOCAtoLine(const DVector3 &origin,
   if(track_kd!=NULL)
   {
 	  cov->ResizeTo(7, 7);
-	  *cov = *(track_kd->errorMatrix());
+	  track_kd->errorMatrix()->Get(*cov);
   }
   doca=1000.;
   double tflight=0.;
@@ -2561,7 +2901,7 @@ jerror_t DReferenceTrajectory::FindPOCAtoLine(const DVector3 &origin,
 	
 	swim_step=this->swim_steps;
    if(track_kd!=NULL)
-	   *cov=*track_kd->errorMatrix();
+	   track_kd->errorMatrix()->Get(*cov);
 	
 	pos=swim_step->origin;
 	DVector3 mom=swim_step->mom;
@@ -2604,7 +2944,7 @@ jerror_t DReferenceTrajectory::FindPOCAtoLine(const DVector3 &origin,
       }
       if(track_kd!=NULL)
       {
-        track_kd->setErrorMatrix(cov);
+        track_kd->setErrorMatrix(*cov);
         track_kd->setMomentum(oldmom);
         track_kd->setPosition(oldpos);
         track_kd->setTime(track_kd->time() + tflight);
@@ -2691,14 +3031,10 @@ jerror_t DReferenceTrajectory::IntersectTracks(const DReferenceTrajectory *rt2,
   const swim_step_t *swim_step2=rt2->swim_steps;
   
   TMatrixFSym cov1(7), cov2(7);
-  shared_ptr<TMatrixFSym> locCovarianceMatrix1 = (track1_kd != NULL) ? dResourcePool_TMatrixFSym->Get_SharedResource() : nullptr;
-  shared_ptr<TMatrixFSym> locCovarianceMatrix2 = (track2_kd != NULL) ? dResourcePool_TMatrixFSym->Get_SharedResource() : nullptr;
 
   if((track1_kd != NULL) && (track2_kd != NULL)){
-	  locCovarianceMatrix1->ResizeTo(7, 7);
-	  locCovarianceMatrix2->ResizeTo(7, 7);
-    cov1=*track1_kd->errorMatrix();
-    cov2=*track2_kd->errorMatrix();
+    track1_kd->errorMatrix()->Get(cov1);
+    track2_kd->errorMatrix()->Get(cov2);
   }
 
   double q1=this->q;
@@ -2730,8 +3066,8 @@ jerror_t DReferenceTrajectory::IntersectTracks(const DReferenceTrajectory *rt2,
       if (i==1) {  // backtrack to find the true doca
 	tflight1=tflight2=0.;
 	if((track1_kd != NULL) && (track2_kd != NULL)){
-	  cov1=*track1_kd->errorMatrix();
-	  cov2=*track2_kd->errorMatrix();
+	  track1_kd->errorMatrix()->Get(cov1);
+	  track2_kd->errorMatrix()->Get(cov2);
 	}
 	// Initialize the steppers
 	DMagneticFieldStepper stepper1(this->bfield, q1, &pos1, &mom1);
@@ -2820,14 +3156,12 @@ jerror_t DReferenceTrajectory::IntersectTracks(const DReferenceTrajectory *rt2,
 	double one_over_p2_sq=1./mom2.Mag2();
 	tflight2+=ds*sqrt(1.+mass_sq2*one_over_p2_sq)/SPEED_OF_LIGHT;
 
-	*locCovarianceMatrix1 = cov1;
-	track1_kd->setErrorMatrix(locCovarianceMatrix1);
+	track1_kd->setErrorMatrix(cov1);
 	track1_kd->setMomentum(mom1);
 	track1_kd->setPosition(pos1);
 	track1_kd->setTime(track1_kd->time() + tflight1);
 
-	*locCovarianceMatrix2 = cov2;
-	track2_kd->setErrorMatrix(locCovarianceMatrix2);
+	track2_kd->setErrorMatrix(cov2);
 	track2_kd->setMomentum(mom2);
 	track2_kd->setPosition(pos2);
 	track2_kd->setTime(track2_kd->time() + tflight2);
@@ -57,8 +57,15 @@ class DReferenceTrajectory{
 		  kT
 		};
 
-		class swim_step_t:public DCoordinateSystem{
+		class swim_step_t{
 			public:
+				// Reference trajectory coordinate system at this step, in lab coordinates.
+				// Same members as DCoordinateSystem, without its vtable and wire length
+				DVector3 origin;
+				DVector3 sdir;
+				DVector3 tdir;
+				DVector3 udir;
+
 				DVector3 mom;
 				double Ro;
 				DVector3 B; // components of magnetic field
@@ -99,6 +106,7 @@ class DReferenceTrajectory{
 		double DistToRTBruteForce(const DCoordinateSystem *wire, const swim_step_t *step, double *s=NULL) const;
 		double Straw_dx(const DCoordinateSystem *wire, double radius) const;
 		swim_step_t* FindClosestSwimStep(const DCoordinateSystem *wire, int *istep_ptr=NULL) const;
+		swim_step_t* FindClosestSwimStepLinear(const DCoordinateSystem *wire, int *istep_ptr=NULL) const;
 		swim_step_t* FindClosestSwimStep(const DVector3 &origin, DVector3 norm, int *istep_ptr=NULL) const;
 		swim_step_t* FindPlaneCrossing(const DVector3 &origin, DVector3 norm,int first_i=0, DetectorSystem_t detector=SYS_NULL) const;
 		void Swim(const DVector3 &pos, const DVector3 &mom, double q=-1000.0,const TMatrixFSym *cov=NULL, double smax=2000.0, const DCoordinateSystem *wire=NULL);
@@ -115,7 +123,7 @@ class DReferenceTrajectory{
 			      double smax=2000.0
 			      );
 
-		int InsertSteps(const swim_step_t *start_step, double delta_s, double step_size=0.02); 
+		int InsertSteps(const swim_step_t *start_step, double delta_s, double step_size=0.02); ///< May move swim_steps if more room is needed
 		jerror_t GetIntersectionWithPlane(const DVector3 &origin, const DVector3 &norm, DVector3 &pos, double *s=NULL,double *t=NULL,double *var_t=NULL,DetectorSystem_t detector=SYS_NULL) const;	
 		jerror_t GetIntersectionWithPlane(const DVector3 &origin, const DVector3 &norm, DVector3 &pos, DVector3 &p_at_intersection,double *s=NULL,double *t=NULL,double *var_t=NULL,DetectorSystem_t detector=SYS_NULL) const;
 		jerror_t GetIntersectionWithRadius(double R,DVector3 &mypos,
@@ -146,6 +154,8 @@ class DReferenceTrajectory{
 		void SetMass(double mass){this->mass = mass;this->mass_sq=mass*mass;}
 		void SetPLossDirection(direction_t direction){ploss_direction=direction;}
 		void SetCheckMaterialBoundaries(bool check_material_boundaries){this->check_material_boundaries = check_material_boundaries;}
+		void SetUseStepIndex(bool use_step_index){this->use_step_index = use_step_index;}
+		bool GetUseStepIndex(void) const {return use_step_index;}
 		bool GetCheckMaterialBoundaries(void) const {return check_material_boundaries;}
 		direction_t GetPLossDirection(void) const {return ploss_direction;}
 		double GetBoundaryStepFraction(void) const {return BOUNDARY_STEP_FRACTION;}
@@ -202,7 +212,8 @@ class DReferenceTrajectory{
 	
 		int debug_level;
 	
-		int max_swim_steps;
+		int max_swim_steps;			///< number of steps swim_steps has room for
+		int max_swim_steps_limit;	///< owned steps are grown up to this many when swimming
 		bool own_swim_steps;
 		int dist_to_rt_depth;
 		double step_size;
@@ -228,6 +239,39 @@ class DReferenceTrajectory{
 	
 	    static thread_local shared_ptr<DResourcePool<TMatrixFSym>> dResourcePool_TMatrixFSym;
 
+		// Owned swim steps come from a per-thread arena of blocks, sized to what the trajectory needs
+		class swim_step_arena_t;
+		static thread_local shared_ptr<swim_step_arena_t> dSwimStepArena;
+		shared_ptr<swim_step_arena_t> swim_step_arena; ///< arena the owned swim_steps were taken from
+
+		// Index of the swim steps used by FindClosestSwimStep(wire): a binary
+		// tree over the pairs of consecutive steps (i, i+1), with up to
+		// SWIM_STEPS_PER_STEP_LEAF pairs in each leaf. Each node bounds the
+		// steps it ends on and the directions between them, so that a whole
+		// node can be skipped when the distance to the wire is certain to go
+		// down over all of it. Built the first time it is needed after a swim.
+		class step_node_t{
+			public:
+				double mx, my, mz;	///< center of the steps the pairs end on
+				double rho;			///< max. distance of those steps from the center
+				double tx, ty, tz;	///< unit vector along the chord of the node
+				double beta;		///< max. distance of the pair directions from (tx,ty,tz)
+				double dmin;		///< shortest step in the node (0 if it cannot be skipped)
+		};
+		bool use_step_index;
+		bool check_step_index;
+		mutable bool step_index_valid;
+		mutable int Nstep_leaves;
+		mutable vector<step_node_t> step_nodes; ///< node 1 is the root, the children of node n are 2n and 2n+1
+
+		void Build_StepTree(int inode, int ileaf_lo, int ileaf_hi) const;
+		int Find_StepTreeRise(const DCoordinateSystem *wire, int inode, int ileaf_lo, int ileaf_hi) const;
+		void Invalidate_StepIndex(void){step_index_valid = false;}
+
+		bool Reserve_SwimSteps(int num_steps);
+		bool Grow_SwimSteps(swim_step_t* &swim_step, swim_step_t* &last_step);
+		void Release_SwimSteps(void);
+
 	private:
 		DReferenceTrajectory(){} // force use of constructor with arguments.
 
@@ -1,5 +1,5 @@
 #include "DRiemannFit.h"
-#include <TDecompLU.h>
+#include "DRiemannFitEngine.h"
 #include <math.h>
 
 #include <iostream>
@@ -61,10 +61,8 @@ jerror_t DRiemannFit::AddHit(double x,double y, double z,double covx,
 jerror_t DRiemannFit::DoFit(double rc_input){
   jerror_t error=NOERROR;
 
-  if (CovR_!=NULL) delete CovR_;
-  if (CovRPhi_!=NULL) delete CovRPhi_; 
-  CovR_=NULL;
-  CovRPhi_=NULL;
+  CovR_.clear();
+  CovRPhi_.clear();
 
   error=FitCircle(rc_input);
   error=FitLine();
@@ -95,63 +93,47 @@ jerror_t DRiemannFit::CalcNormal(DMatrix A,double lambda,DMatrix &N){
   return NOERROR;
 }
 
-// Riemann Circle fit with correction for non-normal track incidence
-jerror_t DRiemannFit::FitCircle(double rc){
-  // Covariance matrices
-  DMatrix CRPhi(hits.size(),hits.size());
-  DMatrix CR(hits.size(),hits.size());
-  // Auxiliary matrices for correcting for non-normal track incidence to FDC
-  // The correction is 
-  //    CRPhi'= C*CRPhi*C+S*CR*S, where S(i,i)=R_i*kappa/2
-  //                                and C(i,i)=sqrt(1-S(i,i)^2)  
-  DMatrix C(hits.size(),hits.size());
-  DMatrix S(hits.size(),hits.size());
+// Fill the RPhi covariance matrix (diagonal) if not done yet
+void DRiemannFit::FillCovRPhi(void){
+  if (!CovRPhi_.empty()) return;
+  CovRPhi_.resize(hits.size());
   for (unsigned int i=0;i<hits.size();i++){
-    double rtemp=sqrt(hits[i]->x*hits[i]->x+hits[i]->y*hits[i]->y); 
-    double stemp=rtemp/4./rc;
-    double ctemp=1.-stemp*stemp;
-    if (ctemp>0){
-      S(i,i)=stemp;
-      C(i,i)=sqrt(ctemp);
-    }
-    else{
-      S(i,i)=0.;
-      C(i,i)=1.;
-    }
-  }
-
-  // Covariance matrices
-  if (CovRPhi_==NULL){
-    CovRPhi_ = new DMatrix(hits.size(),hits.size());
-    for (unsigned int i=0;i<hits.size();i++){
-      double Phi=atan2(hits[i]->y,hits[i]->x);
-      CovRPhi_->operator()(i,i)
+    double Phi=atan2(hits[i]->y,hits[i]->x);
+    CovRPhi_[i]
       =(Phi*cos(Phi)-sin(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covx
       +(Phi*sin(Phi)+cos(Phi))*(Phi*sin(Phi)+cos(Phi))*hits[i]->covy
       +2.*(Phi*sin(Phi)+cos(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covxy;
-    }
-  }
-  if (CovR_==NULL){
-    CovR_= new DMatrix(hits.size(),hits.size());
-    for (unsigned int m=0;m<hits.size();m++){
-      double Phi=atan2(hits[m]->y,hits[m]->x);
-      CovR_->operator()(m,m)=cos(Phi)*cos(Phi)*hits[m]->covx
-	+sin(Phi)*sin(Phi)*hits[m]->covy
-	+2.*sin(Phi)*cos(Phi)*hits[m]->covxy;
-    } 
   }
+}
+
+// Fill the R covariance matrix (diagonal) if not done yet
+void DRiemannFit::FillCovR(void){
+  if (!CovR_.empty()) return;
+  CovR_.resize(hits.size());
+  for (unsigned int m=0;m<hits.size();m++){
+    double Phi=atan2(hits[m]->y,hits[m]->x);
+    CovR_[m]=cos(Phi)*cos(Phi)*hits[m]->covx
+      +sin(Phi)*sin(Phi)*hits[m]->covy
+      +2.*sin(Phi)*cos(Phi)*hits[m]->covxy;
+  } 
+}
+
+// Correction for non-normal incidence of track on FDC 
+//    CRPhi'= C*CRPhi*C+S*CR*S, where S(i,i)=R_i*kappa/2
+//                                and C(i,i)=sqrt(1-S(i,i)^2)  
+void DRiemannFit::CorrectCovRPhi(double rc){
+  FillCovRPhi();
+  FillCovR();
   for (unsigned int i=0;i<hits.size();i++){
-    for (unsigned int j=0;j<hits.size();j++){
-      CR(i,j)=CovR_->operator()(i, j);
-      CRPhi(i,j)=CovRPhi_->operator()(i, j);
-    }
+    double rtemp=sqrt(hits[i]->x*hits[i]->x+hits[i]->y*hits[i]->y); 
+    double stemp=rtemp/4./rc;
+    CovRPhi_[i]=DRiemannFitEngine::CorrectVarRPhi(CovRPhi_[i],CovR_[i],stemp);
   }
+}
 
-  // Correction for non-normal incidence of track on FDC 
-  CRPhi=C*CRPhi*C+S*CR*S;
-  for (unsigned int i=0;i<hits.size();i++)
-    for (unsigned int j=0;j<hits.size();j++)
-      CovRPhi_->operator()(i,j)=CRPhi(i,j);
+// Riemann Circle fit with correction for non-normal track incidence
+jerror_t DRiemannFit::FitCircle(double rc){
+  CorrectCovRPhi(rc);
   return FitCircle();
 }
 
@@ -164,15 +146,10 @@ jerror_t DRiemannFit::FitCircle(double rc){
 //
 jerror_t DRiemannFit::FitCircle(){  
   if (hits.size()==0) return RESOURCE_UNAVAILABLE;
-  DMatrix X(hits.size(),3);
-  DMatrix Xavg(1,3);
   DMatrix A(3,3);
+  double Xavg[3],W_sum;
   double B0,B1,B2,Q,Q1,R,sum,diff;
   double theta,lambda_min=0.;
-  // Column and row vectors of ones
-  DMatrix Ones(hits.size(),1),OnesT(1,hits.size());
-  DMatrix W_sum(1,1);
-  DMatrix W(hits.size(),hits.size());
   // Eigenvector
   DMatrix N1(3,1);
 
@@ -180,20 +157,7 @@ jerror_t DRiemannFit::FitCircle(){
   std::sort(hits.begin(),hits.end(),DRiemannFit_hit_cmp);
  
   // Covariance matrix
-  DMatrix CRPhi(hits.size(),hits.size());
-  if (CovRPhi_==NULL){
-    CovRPhi_ = new DMatrix(hits.size(),hits.size());
-    for (unsigned int i=0;i<hits.size();i++){
-      double Phi=atan2(hits[i]->y,hits[i]->x);
-      CovRPhi_->operator()(i,i)
-      =(Phi*cos(Phi)-sin(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covx
-      +(Phi*sin(Phi)+cos(Phi))*(Phi*sin(Phi)+cos(Phi))*hits[i]->covy
-      +2.*(Phi*sin(Phi)+cos(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covxy;
-    }
-  }
-  for (unsigned int i=0;i<hits.size();i++)
-    for (unsigned int j=0;j<hits.size();j++)
-      CRPhi(i,j)=CovRPhi_->operator()(i, j);
+  FillCovRPhi();
  
   // The goal is to find the eigenvector corresponding to the smallest 
   // eigenvalue of the equation
@@ -204,24 +168,17 @@ jerror_t DRiemannFit::FitCircle(){
   // In the absence of multiple scattering, W_sum is the sum of all the 
   // diagonal elements in W.
 
+  // Check that CRPhi is invertible 
   for (unsigned int i=0;i<hits.size();i++){
-    X(i,0)=hits[i]->x;
-    X(i,1)=hits[i]->y;
-    X(i,2)=hits[i]->x*hits[i]->x+hits[i]->y*hits[i]->y;
-    Ones(i,0)=OnesT(0,i)=1.;
+    if (CovRPhi_[i]==0.) return UNRECOVERABLE_ERROR; // error placeholder
   }
-
-  // Check that CRPhi is invertible 
-  TDecompLU lu(CRPhi);
-  if (lu.Decompose()==false){
-    return UNRECOVERABLE_ERROR; // error placeholder
+  DRiemannFitEngine &engine=DRiemannFitEngine::Get_ThreadInstance();
+  engine.Reset(hits.size());
+  for (unsigned int i=0;i<hits.size();i++){
+    engine.SetPoint(i,hits[i]->x,hits[i]->y,1./CovRPhi_[i]);
   }
-  W=DMatrix(DMatrix::kInverted,CRPhi);
-  W_sum=OnesT*(W*Ones);
-  Xavg=(1./W_sum(0,0))*(OnesT*(W*X));
+  engine.CalcMoments(A,Xavg,W_sum);
   
-  A=DMatrix(DMatrix::kTransposed,X)*(W*X)
-    -W_sum(0,0)*(DMatrix(DMatrix::kTransposed,Xavg)*Xavg);
   if(!A.IsValid())return UNRECOVERABLE_ERROR;
 
   // The characteristic equation is 
@@ -274,7 +231,7 @@ jerror_t DRiemannFit::FitCircle(){
   N[2]=N1(2,0);
  
   // Distance to origin
-  dist_to_origin=-(N1(0,0)*Xavg(0,0)+N1(1,0)*Xavg(0,1)+N1(2,0)*Xavg(0,2));
+  dist_to_origin=-(N1(0,0)*Xavg[0]+N1(1,0)*Xavg[1]+N1(2,0)*Xavg[2]);
 
   // Center and radius of the circle
   xc=-N1(0,0)/2./N1(2,0);
@@ -286,60 +243,7 @@ jerror_t DRiemannFit::FitCircle(){
 
 // Charge-finding routine with corrected CRPhi (see above)
 double DRiemannFit::GetCharge(double rc_input){
- // Covariance matrices
-  DMatrix CRPhi(hits.size(),hits.size());
-  DMatrix CR(hits.size(),hits.size());
-  // Auxiliary matrices for correcting for non-normal track incidence to FDC
-  // The correction is 
-  //    CRPhi'= C*CRPhi*C+S*CR*S, where S(i,i)=R_i*kappa/2
-  //                                and C(i,i)=sqrt(1-S(i,i)^2)  
-  DMatrix C(hits.size(),hits.size());
-  DMatrix S(hits.size(),hits.size());
-  for (unsigned int i=0;i<hits.size();i++){
-    double rtemp=sqrt(hits[i]->x*hits[i]->x+hits[i]->y*hits[i]->y); 
-    double stemp=rtemp/4./rc_input;
-    double ctemp=1.-stemp*stemp;
-    if (ctemp>0){
-      S(i,i)=stemp;
-      C(i,i)=sqrt(ctemp);
-    }
-    else{
-      S(i,i)=0.;
-      C(i,i)=1;      
-    }
-  }
-  
-  // Covariance matrices
-  if (CovRPhi_==NULL){
-    CovRPhi_ = new DMatrix(hits.size(),hits.size());
-    for (unsigned int i=0;i<hits.size();i++){
-      double Phi=atan2(hits[i]->y,hits[i]->x);
-      CovRPhi_->operator()(i,i)
-      =(Phi*cos(Phi)-sin(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covx
-      +(Phi*sin(Phi)+cos(Phi))*(Phi*sin(Phi)+cos(Phi))*hits[i]->covy
-      +2.*(Phi*sin(Phi)+cos(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covxy;
-    }
-  }
-  if (CovR_==NULL){
-    CovR_= new DMatrix(hits.size(),hits.size());
-    for (unsigned int m=0;m<hits.size();m++){
-      double Phi=atan2(hits[m]->y,hits[m]->x);
-      CovR_->operator()(m,m)=cos(Phi)*cos(Phi)*hits[m]->covx
-	+sin(Phi)*sin(Phi)*hits[m]->covy
-	+2.*sin(Phi)*cos(Phi)*hits[m]->covxy;
-    } 
-  }
-  for (unsigned int i=0;i<hits.size();i++){
-    for (unsigned int j=0;j<hits.size();j++){
-      CR(i,j)=CovR_->operator()(i, j);
-      CRPhi(i,j)=CovRPhi_->operator()(i, j);
-    }
-  }
-  // Correction for non-normal incidence of track on FDC 
-  CRPhi=C*CRPhi*C+S*CR*S; 
-  for (unsigned int i=0;i<hits.size();i++)
-    for (unsigned int j=0;j<hits.size();j++)
-      CovRPhi_->operator()(i,j)=CRPhi(i,j);
+  CorrectCovRPhi(rc_input);
   return GetCharge();
 }
 
@@ -347,33 +251,8 @@ double DRiemannFit::GetCharge(double rc_input){
 // Linear regression to find charge
 double DRiemannFit::GetCharge(){
   // Covariance matrices
-  DMatrix CRPhi(hits.size(),hits.size());
-  DMatrix CR(hits.size(),hits.size());
-  if (CovRPhi_==NULL){
-    CovRPhi_ = new DMatrix(hits.size(),hits.size());
-    for (unsigned int i=0;i<hits.size();i++){
-      double Phi=atan2(hits[i]->y,hits[i]->x);
-      CovRPhi_->operator()(i,i)
-	=(Phi*cos(Phi)-sin(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covx
-      +(Phi*sin(Phi)+cos(Phi))*(Phi*sin(Phi)+cos(Phi))*hits[i]->covy
-      +2.*(Phi*sin(Phi)+cos(Phi))*(Phi*cos(Phi)-sin(Phi))*hits[i]->covxy;
-    }
-  }
-  if (CovR_==NULL){
-    CovR_= new DMatrix(hits.size(),hits.size());
-    for (unsigned int m=0;m<hits.size();m++){
-      double Phi=atan2(hits[m]->y,hits[m]->x);
-      CovR_->operator()(m,m)=cos(Phi)*cos(Phi)*hits[m]->covx
-	+sin(Phi)*sin(Phi)*hits[m]->covy
-	+2.*sin(Phi)*cos(Phi)*hits[m]->covxy;
-    } 
-  }
-  for (unsigned int i=0;i<hits.size();i++){
-    for (unsigned int j=0;j<hits.size();j++){
-      CR(i,j)=CovR_->operator()(i, j);
-      CRPhi(i,j)=CovRPhi_->operator()(i, j);
-    }
-  }
+  FillCovRPhi();
+  FillCovR();
 
   double phi_old=atan2(hits[0]->y,hits[0]->x);
   double sumv=0,sumy=0,sumx=0,sumxx=0,sumxy=0;
@@ -387,7 +266,7 @@ double DRiemannFit::GetCharge(){
       else phi_z+=2.*M_PI;
     }
     double inv_var=(hit->x*hit->x+hit->y*hit->y)
-      /(CRPhi(k,k)+phi_z*phi_z*CR(k,k));
+      /(CovRPhi_[k]+phi_z*phi_z*CovR_[k]);
     sumv+=inv_var;
     sumy+=phi_z*inv_var;
     sumx+=hit->z*inv_var;
@@ -410,19 +289,8 @@ double DRiemannFit::GetCharge(){
 //
 jerror_t DRiemannFit::FitLine(){
   // Get covariance matrix 
-  DMatrix CR(hits.size(),hits.size());
-  if (CovR_==NULL){ 
-    CovR_= new DMatrix(hits.size(),hits.size());
-    for (unsigned int m=0;m<hits.size();m++){
-      double Phi=atan2(hits[m]->y,hits[m]->x);
-      CovR_->operator()(m,m)=cos(Phi)*cos(Phi)*hits[m]->covx
-      +sin(Phi)*sin(Phi)*hits[m]->covy
-      +2.*sin(Phi)*cos(Phi)*hits[m]->covxy;
-    } 
-  }
-  for (unsigned int i=0;i<hits.size();i++)
-    for (unsigned int j=0;j<hits.size();j++)
-      CR(i,j)=CovR_->operator()(i, j);
+  FillCovR();
+  const vector<double> &CR=CovR_;
 
   // Fill vector of intersection points 
   double x_int0,temp,y_int0;
@@ -501,11 +369,11 @@ jerror_t DRiemannFit::FitLine(){
       else
 	sperp=2.*rc*asin(ratio);
       // Assume errors in s dominated by errors in R 
-      sumv+=1./CR(k,k);
-      sumy+=sperp/CR(k,k);
-      sumx+=projections[k]->z/CR(k,k);
-      sumxx+=projections[k]->z*projections[k]->z/CR(k,k);
-      sumxy+=sperp*projections[k]->z/CR(k,k);
+      sumv+=1./CR[k];
+      sumy+=sperp/CR[k];
+      sumx+=projections[k]->z/CR[k];
+      sumxx+=projections[k]->z*projections[k]->z/CR[k];
+      sumxy+=sperp*projections[k]->z/CR[k];
     }
   }
   chord=sqrt(projections[start]->x*projections[start]->x
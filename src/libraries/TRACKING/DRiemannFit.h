@@ -16,16 +16,11 @@ typedef struct{
 class DRiemannFit{
  public:
   DRiemannFit(){
-    CovR_=NULL;
-    CovRPhi_=NULL;
     hits.clear();
     projections.clear();
   };
   
   ~DRiemannFit(){
-    if (CovR_!=NULL) delete CovR_;
-    if (CovRPhi_!=NULL) delete CovRPhi_; 
-
     for (unsigned int i=0;i<hits.size();i++)
       delete hits[i];
     for (unsigned int i=0;i<projections.size();i++)
@@ -63,12 +58,17 @@ class DRiemannFit{
 
  protected:
   jerror_t CalcNormal(DMatrix A,double lambda,DMatrix &N);
+  void FillCovR(void);
+  void FillCovRPhi(void);
+  void CorrectCovRPhi(double rc);
 
  private:
   vector<DRiemannHit_t*>hits;
   vector<DRiemannHit_t*>projections;
-  DMatrix *CovR_;
-  DMatrix *CovRPhi_;
+  // Diagonals of the (diagonal) R and RPhi covariance matrices; empty until
+  // first needed
+  vector<double> CovR_;
+  vector<double> CovRPhi_;
 
   // Cirlce fit parameters
   double N[3]; 
@@ -0,0 +1,50 @@
+// DRiemannFitEngine: weighted sums for the Riemann circle fit.
+
+#include "DRiemannFitEngine.h"
+
+// Accumulate X^T W X, the weighted sums of the points and W_sum in one pass.
+// Each element is summed over the points in the same order, and with the
+// same grouping of products, as the DMatrix expressions
+//            W_sum = OnesT*(W*Ones)
+//            Xavg  = (1/W_sum)*(OnesT*(W*X))
+//            A     = X^T*(W*X) - W_sum*(Xavg^T*Xavg)
+// (for diagonal W the off-diagonal terms of those products are zero).
+jerror_t DRiemannFitEngine::CalcMoments(DMatrix &A,double Xavg[3],
+					 double &W_sum) const{
+  unsigned int n=dW.size();
+  if (n==0) return RESOURCE_UNAVAILABLE;
+
+  double XtWX[3][3]={{0.,0.,0.},{0.,0.,0.},{0.,0.,0.}};
+  double sumWX[3]={0.,0.,0.};
+  W_sum=0.;
+  for (unsigned int i=0;i<n;i++){
+    double w=dW[i];
+    double Xi[3]={dX[i],dY[i],dX[i]*dX[i]+dY[i]*dY[i]};
+    double WXi[3]={w*Xi[0],w*Xi[1],w*Xi[2]};
+    W_sum+=w;
+    for (int b=0;b<3;b++){
+      sumWX[b]+=WXi[b];
+      for (int a=0;a<3;a++){
+	XtWX[a][b]+=Xi[a]*WXi[b];
+      }
+    }
+  }
+
+  double var_avg=1./W_sum;
+  for (int b=0;b<3;b++) Xavg[b]=var_avg*sumWX[b];
+
+  if (A.GetNrows()!=3 || A.GetNcols()!=3) A.ResizeTo(3,3);
+  for (int a=0;a<3;a++){
+    for (int b=0;b<3;b++){
+      A(a,b)=XtWX[a][b]-W_sum*(Xavg[a]*Xavg[b]);
+    }
+  }
+
+  return NOERROR;
+}
+
+// Per-thread engine for callers that do not keep their own
+DRiemannFitEngine& DRiemannFitEngine::Get_ThreadInstance(void){
+  static thread_local DRiemannFitEngine engine;
+  return engine;
+}
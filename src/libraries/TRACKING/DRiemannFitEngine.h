@@ -0,0 +1,68 @@
+// DRiemannFitEngine: weighted sums for the Riemann circle fit.
+//
+/// The Riemann circle fit maps the points (x,y) onto the paraboloid
+/// (x,y,w=x^2+y^2) and finds the plane through them from the eigenvector
+/// of the 3x3 matrix
+///            A = X^T W X - W_sum Xavg^T Xavg
+/// where X is the n x 3 matrix of mapped points and W the weight matrix.
+/// Since W (like the R and R-phi covariance matrices and the matrices for
+/// the non-normal incidence correction) is diagonal, only the diagonal is
+/// stored and A is accumulated in a single O(n) pass. The accumulation
+/// follows the element order of the equivalent n x n DMatrix products, so
+/// the results are the same.
+///
+/// <p>The point buffers are kept between fits so that repeated fits do not
+/// allocate. Get_ThreadInstance() returns a per-thread engine for code that
+/// does not own one.</p>
+
+#ifndef _DRIEMANN_FIT_ENGINE_H_
+#define _DRIEMANN_FIT_ENGINE_H_
+
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <DMatrix.h>
+#include "JANA/jerror.h"
+
+class DRiemannFitEngine{
+ public:
+  DRiemannFitEngine(){};
+
+  /// Set the number of points and clear them; capacity is retained
+  void Reset(unsigned int n){
+    dX.resize(n);
+    dY.resize(n);
+    dW.resize(n);
+  };
+  unsigned int GetNumPoints(void) const {return dW.size();};
+
+  /// Set point i with the inverse of its R-phi variance as the weight
+  void SetPoint(unsigned int i,double x,double y,double weight){
+    dX[i]=x;
+    dY[i]=y;
+    dW[i]=weight;
+  };
+
+  /// Compute A (3x3) and the weighted average point Xavg, and return the
+  /// sum of the weights in W_sum
+  jerror_t CalcMoments(DMatrix &A,double Xavg[3],double &W_sum) const;
+
+  /// Correction of a diagonal R-phi variance for non-normal incidence of
+  /// the track, CRPhi'= C*CRPhi*C+S*CR*S, with S=R*kappa/2, C=sqrt(1-S^2)
+  static double CorrectVarRPhi(double var_rphi,double var_r,double stemp){
+    double ctemp=1.-stemp*stemp;
+    if (ctemp>0){
+      double c=sqrt(ctemp);
+      return c*var_rphi*c+stemp*var_r*stemp;
+    }
+    return var_rphi;
+  };
+
+  static DRiemannFitEngine& Get_ThreadInstance(void);
+
+ private:
+  vector<double> dX,dY,dW;
+};
+
+#endif //_DRIEMANN_FIT_ENGINE_H_
@@ -0,0 +1,774 @@
+// $Id$
+//
+//    File: DTrackCandidate_factory_CDCGraph.cc
+//
+
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include <functional>
+
+#include <JANA/JCalibration.h>
+#include <DANA/DApplication.h>
+
+#include "DTrackCandidate_factory_CDCGraph.h"
+
+#define BeamRMS 0.5
+
+#ifndef M_TWO_PI
+#define M_TWO_PI 6.28318530717958647692
+#endif
+
+using namespace std;
+
+inline bool CDCGraphSortByRingStraw(const DTrackCandidate_factory_CDCGraph::DGraphHit* locHit1, const DTrackCandidate_factory_CDCGraph::DGraphHit* locHit2)
+{
+	if(locHit1->ring != locHit2->ring)
+		return (locHit1->ring < locHit2->ring);
+	return (locHit1->straw < locHit2->straw);
+}
+
+//------------------
+// init
+//------------------
+jerror_t DTrackCandidate_factory_CDCGraph::init(void)
+{
+	DEBUG_LEVEL = 0;
+	MAX_ALLOWED_CDC_HITS = 10000;
+	MAX_DRIFT_TIME = 1000.0; // ns
+
+	//hits in a super layer are in the same seed if they are connected by hits closer than this
+	MAX_HIT_DIST = 4.0; // cm //each straw is 5/8in (1.5875 cm) in diameter
+	MIN_SEED_HITS = 2;
+	//larger seeds are dropped: spiral blobs, can't get track parameters from them anyway
+	MAX_SEED_HITS = 60;
+
+	//link seeds in adjacent super layers if the distance between their facing rings (transverse to the rings) is less than this
+		//large enough for stereo wires, whose positions are at the center of the wire
+	MAX_LINK_DIST = 10.0; // cm
+	//keep at most this many links from (and to) each seed: bounds the number of chains
+	MAX_LINKS_PER_SEED = 3;
+	//if a seed has no link to the next super layer, try the one after (e.g. dead HV board)
+	ENABLE_SUPERLAYER_SKIP = true;
+
+	//chains may not start after this super layer
+	MAX_SUPERLAYER_NEW_TRACK = 4;
+	//at most this many chains are fit for each starting seed
+	MAX_CHAINS_PER_ROOT = 100;
+
+	MIN_AXIAL_HITS = 3;
+	MIN_HITS_ON_CIRCLE_FRACTION = 0.5; //of the axial hits, within MAX_HIT_DIST of the fit circle
+	MAX_COMMON_HIT_FRACTION = 0.49; //reject if exactly half
+
+	//cluster the super layers in parallel threads if the event has at least this many hits (0: never)
+		//off by default: the JANA threads already keep the cores busy
+	PARALLEL_MIN_HITS = 0;
+
+	TARGET_Z = 65.0;
+	VERTEX_Z_MIN = -100.0;
+	VERTEX_Z_MAX = 200.0;
+
+	dHitsBySuperLayer.resize(7);
+
+	return NOERROR;
+}
+
+//------------------
+// brun
+//------------------
+jerror_t DTrackCandidate_factory_CDCGraph::brun(JEventLoop *locEventLoop, int32_t runnumber)
+{
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:DEBUG_LEVEL", DEBUG_LEVEL);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_ALLOWED_CDC_HITS", MAX_ALLOWED_CDC_HITS);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_DRIFT_TIME", MAX_DRIFT_TIME);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_HIT_DIST", MAX_HIT_DIST);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MIN_SEED_HITS", MIN_SEED_HITS);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_SEED_HITS", MAX_SEED_HITS);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_LINK_DIST", MAX_LINK_DIST);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_LINKS_PER_SEED", MAX_LINKS_PER_SEED);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:ENABLE_SUPERLAYER_SKIP", ENABLE_SUPERLAYER_SKIP);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_SUPERLAYER_NEW_TRACK", MAX_SUPERLAYER_NEW_TRACK);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_CHAINS_PER_ROOT", MAX_CHAINS_PER_ROOT);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MIN_AXIAL_HITS", MIN_AXIAL_HITS);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MIN_HITS_ON_CIRCLE_FRACTION", MIN_HITS_ON_CIRCLE_FRACTION);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:MAX_COMMON_HIT_FRACTION", MAX_COMMON_HIT_FRACTION);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:PARALLEL_MIN_HITS", PARALLEL_MIN_HITS, "Find the seeds of the super layers in parallel if the event has at least this many CDC hits (0: never). Starts 6 worker threads per processing thread.");
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:VERTEX_Z_MIN", VERTEX_Z_MIN);
+	gPARMS->SetDefaultParameter("TRKFIND_CDCGRAPH:VERTEX_Z_MAX", VERTEX_Z_MAX);
+
+	if(MAX_LINKS_PER_SEED == 0)
+		MAX_LINKS_PER_SEED = 1;
+
+	if(PARALLEL_MIN_HITS > 0)
+		Start_Workers();
+
+	DApplication* locApplication = dynamic_cast<DApplication*>(locEventLoop->GetJApplication());
+	dMagneticField = locApplication->GetBfield(runnumber);
+	dFactorForSenseOfRotation = (dMagneticField->GetBz(0.,0.,65.) > 0.) ? -1. : 1.;
+
+	const DGeometry *locGeometry = locApplication->GetDGeometry(runnumber);
+	JCalibration *jcalib = locApplication->GetJCalibration(runnumber);
+	map<string, double> targetparms;
+	if (jcalib->Get("TARGET/target_parms",targetparms)==false){
+	  TARGET_Z = targetparms["TARGET_Z_POSITION"];
+	}
+	else{
+	  locGeometry->GetTargetZ(TARGET_Z);
+	}
+
+	return NOERROR;
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t DTrackCandidate_factory_CDCGraph::evnt(JEventLoop *locEventLoop, uint64_t eventnumber)
+{
+	// Get CDC hits
+	if(!Get_CDCHits(locEventLoop))
+		return NOERROR;
+
+	// Find the seeds of each super layer: they are independent, so can be done in parallel
+	vector<vector<DGraphSeed> > locSeedsBySuperLayer(7);
+	if(!dWorkerThreads.empty() && (PARALLEL_MIN_HITS > 0) && (dHits.size() >= PARALLEL_MIN_HITS))
+	{
+		{
+			lock_guard<mutex> locLock(dWorkerMutex);
+			dWorkSeeds = &locSeedsBySuperLayer;
+			dNumWorkersBusy = dWorkerThreads.size();
+			++dWorkGeneration;
+		}
+		dWorkStart.notify_all();
+		Find_SuperLayerSeeds(1, locSeedsBySuperLayer[0]);
+
+		unique_lock<mutex> locLock(dWorkerMutex);
+		dWorkDone.wait(locLock, [this]{return (dNumWorkersBusy == 0);});
+		dWorkSeeds = nullptr;
+	}
+	else
+	{
+		for(unsigned int loc_i = 0; loc_i < 7; ++loc_i)
+			Find_SuperLayerSeeds(loc_i + 1, locSeedsBySuperLayer[loc_i]);
+	}
+
+	dSeeds.clear();
+	dFirstSeedIndex.clear();
+	for(unsigned int loc_i = 0; loc_i < 7; ++loc_i)
+	{
+		dFirstSeedIndex.push_back(dSeeds.size());
+		dSeeds.insert(dSeeds.end(), locSeedsBySuperLayer[loc_i].begin(), locSeedsBySuperLayer[loc_i].end());
+	}
+	dFirstSeedIndex.push_back(dSeeds.size());
+	if(DEBUG_LEVEL > 3)
+		cout << "CDCGraph: " << dHits.size() << " hits, " << dSeeds.size() << " seeds" << endl;
+
+	// Build the graph
+	Link_Seeds();
+
+	// Walk the chains from each starting seed, keep the best one
+	vector<DGraphTrack> locTracks;
+	for(size_t loc_i = 0; loc_i < dSeeds.size(); ++loc_i)
+	{
+		if((dSeeds[loc_i].dNumInnerLinks > 0) || (dSeeds[loc_i].dSuperLayer > MAX_SUPERLAYER_NEW_TRACK))
+			continue;
+
+		vector<unsigned int> locChain;
+		vector<vector<unsigned int> > locChains;
+		Walk_Chains(loc_i, locChain, locChains);
+
+		DGraphTrack locBestTrack;
+		bool locFoundFlag = false;
+		for(size_t loc_j = 0; loc_j < locChains.size(); ++loc_j)
+		{
+			// If the fit fails, drop seeds from the outside until it works (or no axial seeds are left)
+			vector<unsigned int>& locTrackChain = locChains[loc_j];
+			DGraphTrack locTrack;
+			while(!locTrackChain.empty() && !Fit_Chain(locTrackChain, locTrack))
+				locTrackChain.pop_back();
+			if(locTrackChain.empty())
+				continue;
+			if(!locFoundFlag || Is_Better(locTrack, locBestTrack))
+				locBestTrack = locTrack;
+			locFoundFlag = true;
+		}
+		if(locFoundFlag)
+			locTracks.push_back(locBestTrack);
+	}
+
+	// Accept tracks by decreasing #hits, rejecting those that share too many hits with accepted ones
+	sort(locTracks.begin(), locTracks.end(), [this](const DGraphTrack& locTrack1, const DGraphTrack& locTrack2) -> bool {return Is_Better(locTrack1, locTrack2);});
+	vector<bool> locHitUsedFlags(dHits.size(), false);
+	for(size_t loc_i = 0; loc_i < locTracks.size(); ++loc_i)
+	{
+		const vector<unsigned int>& locHitIndices = locTracks[loc_i].dHitIndices;
+		unsigned int locNumSharedHits = 0;
+		for(size_t loc_j = 0; loc_j < locHitIndices.size(); ++loc_j)
+		{
+			if(locHitUsedFlags[locHitIndices[loc_j]])
+				++locNumSharedHits;
+		}
+		if(double(locNumSharedHits) > MAX_COMMON_HIT_FRACTION*double(locHitIndices.size()))
+			continue;
+		for(size_t loc_j = 0; loc_j < locHitIndices.size(); ++loc_j)
+			locHitUsedFlags[locHitIndices[loc_j]] = true;
+		Create_TrackCandidate(locTracks[loc_i]);
+	}
+
+	if(DEBUG_LEVEL > 3)
+		cout << "CDCGraph: " << locTracks.size() << " chains fit, " << _data.size() << " candidates" << endl;
+
+	return NOERROR;
+}
+
+/*********************************************************************************************************************************************************************/
+/******************************************************************************* SEEDS *******************************************************************************/
+/*********************************************************************************************************************************************************************/
+
+//------------------
+// fini
+//------------------
+jerror_t DTrackCandidate_factory_CDCGraph::fini(void)
+{
+	Stop_Workers();
+	return NOERROR;
+}
+
+//------------------
+// Start_Workers
+//------------------
+void DTrackCandidate_factory_CDCGraph::Start_Workers(void)
+{
+	// The workers live as long as the factory: one per super layer 2 -> 7
+	if(!dWorkerThreads.empty())
+		return;
+	dWorkerQuitFlag = false;
+	for(unsigned int locSuperLayer = 2; locSuperLayer <= 7; ++locSuperLayer)
+		dWorkerThreads.push_back(thread(&DTrackCandidate_factory_CDCGraph::Worker_Thread, this, locSuperLayer));
+}
+
+//------------------
+// Stop_Workers
+//------------------
+void DTrackCandidate_factory_CDCGraph::Stop_Workers(void)
+{
+	{
+		lock_guard<mutex> locLock(dWorkerMutex);
+		dWorkerQuitFlag = true;
+	}
+	dWorkStart.notify_all();
+	for(size_t loc_i = 0; loc_i < dWorkerThreads.size(); ++loc_i)
+		dWorkerThreads[loc_i].join();
+	dWorkerThreads.clear();
+}
+
+//------------------
+// Worker_Thread
+//------------------
+void DTrackCandidate_factory_CDCGraph::Worker_Thread(unsigned int locSuperLayer)
+{
+	// Wait for an event, find the seeds of this super layer, report back
+	uint64_t locGeneration = 0;
+	unique_lock<mutex> locLock(dWorkerMutex);
+	while(true)
+	{
+		dWorkStart.wait(locLock, [this, &locGeneration]{return dWorkerQuitFlag || (dWorkGeneration != locGeneration);});
+		if(dWorkerQuitFlag)
+			return;
+		locGeneration = dWorkGeneration;
+		vector<DGraphSeed>& locSeeds = (*dWorkSeeds)[locSuperLayer - 1];
+		locLock.unlock();
+
+		Find_SuperLayerSeeds(locSuperLayer, locSeeds);
+
+		locLock.lock();
+		if(--dNumWorkersBusy == 0)
+			dWorkDone.notify_one();
+	}
+}
+
+//------------------
+// Get_CDCHits
+//------------------
+bool DTrackCandidate_factory_CDCGraph::Get_CDCHits(JEventLoop* locEventLoop)
+{
+	dHits.clear();
+	for(size_t loc_i = 0; loc_i < dHitsBySuperLayer.size(); ++loc_i)
+		dHitsBySuperLayer[loc_i].clear();
+
+	vector<const DCDCTrackHit*> locCDCTrackHits;
+	locEventLoop->Get(locCDCTrackHits);
+	if(locCDCTrackHits.empty())
+		return false;
+
+	if(locCDCTrackHits.size() > MAX_ALLOWED_CDC_HITS)
+	{
+		cout << "Too many hits in CDC (" << locCDCTrackHits.size() << ", max = " << MAX_ALLOWED_CDC_HITS << ")! Track finding in CDC bypassed for event " << locEventLoop->GetJEvent().GetEventNumber() << endl;
+		return false;
+	}
+
+	// Only the first hit of a wire, only in-time hits
+	int locOldWire = -1;
+	for(size_t loc_i = 0; loc_i < locCDCTrackHits.size(); ++loc_i)
+	{
+		const DCDCWire* locWire = locCDCTrackHits[loc_i]->wire;
+		int locNewWire = locWire->ring*1000 + locWire->straw;
+		if(locNewWire == locOldWire)
+			continue;
+		locOldWire = locNewWire;
+		if(locCDCTrackHits[loc_i]->tdrift > MAX_DRIFT_TIME)
+			continue;
+
+		DGraphHit locHit;
+		locHit.hit = locCDCTrackHits[loc_i];
+		locHit.index = loc_i;
+		locHit.ring = locWire->ring;
+		locHit.straw = locWire->straw;
+		locHit.x = locWire->origin.X();
+		locHit.y = locWire->origin.Y();
+		locHit.r = locWire->origin.Perp();
+		dHits.push_back(locHit);
+	}
+
+	// Sort into super layers (4 rings each), by ring & straw
+	vector<const DGraphHit*> locSortedHits;
+	for(size_t loc_i = 0; loc_i < dHits.size(); ++loc_i)
+		locSortedHits.push_back(&dHits[loc_i]);
+	stable_sort(locSortedHits.begin(), locSortedHits.end(), CDCGraphSortByRingStraw);
+	for(size_t loc_i = 0; loc_i < locSortedHits.size(); ++loc_i)
+	{
+		unsigned int locSuperLayerIndex = (locSortedHits[loc_i]->ring - 1)/4;
+		if(locSuperLayerIndex < 7)
+			dHitsBySuperLayer[locSuperLayerIndex].push_back(locSortedHits[loc_i] - &dHits[0]);
+	}
+
+	return !dHits.empty();
+}
+
+//---------------------
+// Find_SuperLayerSeeds
+//---------------------
+void DTrackCandidate_factory_CDCGraph::Find_SuperLayerSeeds(unsigned int locSuperLayer, vector<DGraphSeed>& locSeeds) const
+{
+	// Group the hits of the super layer into clusters of connected hits (union-find)
+	// May be called from several threads at once (one per super layer): only reads the members
+	locSeeds.clear();
+	const vector<unsigned int>& locHitIndices = dHitsBySuperLayer[locSuperLayer - 1];
+	size_t locNumHits = locHitIndices.size();
+	if(locNumHits == 0)
+		return;
+
+	vector<size_t> locParents(locNumHits);
+	for(size_t loc_i = 0; loc_i < locNumHits; ++loc_i)
+		locParents[loc_i] = loc_i;
+	auto locFindRoot = [&locParents](size_t locIndex) -> size_t
+	{
+		while(locParents[locIndex] != locIndex)
+		{
+			locParents[locIndex] = locParents[locParents[locIndex]];
+			locIndex = locParents[locIndex];
+		}
+		return locIndex;
+	};
+
+	double locMaxHitDist2 = MAX_HIT_DIST*MAX_HIT_DIST;
+	for(size_t loc_i = 0; loc_i < locNumHits; ++loc_i)
+	{
+		const DGraphHit& locHit1 = dHits[locHitIndices[loc_i]];
+		for(size_t loc_j = loc_i + 1; loc_j < locNumHits; ++loc_j)
+		{
+			const DGraphHit& locHit2 = dHits[locHitIndices[loc_j]];
+			if(locHit2.ring > locHit1.ring + 2)
+				break; //sorted by ring: no more neighbors
+			double locDeltaX = locHit2.x - locHit1.x;
+			double locDeltaY = locHit2.y - locHit1.y;
+			if((locDeltaX*locDeltaX + locDeltaY*locDeltaY) > locMaxHitDist2)
+				continue;
+			size_t locRoot1 = locFindRoot(loc_i);
+			size_t locRoot2 = locFindRoot(loc_j);
+			if(locRoot1 != locRoot2)
+				locParents[max(locRoot1, locRoot2)] = min(locRoot1, locRoot2);
+		}
+	}
+
+	// Create the seeds, in order of their first hit
+	vector<int> locSeedIndexOfRoot(locNumHits, -1);
+	for(size_t loc_i = 0; loc_i < locNumHits; ++loc_i)
+	{
+		size_t locRoot = locFindRoot(loc_i);
+		if(locSeedIndexOfRoot[locRoot] < 0)
+		{
+			locSeedIndexOfRoot[locRoot] = locSeeds.size();
+			locSeeds.push_back(DGraphSeed());
+			DGraphSeed& locSeed = locSeeds.back();
+			locSeed.dSuperLayer = locSuperLayer;
+			locSeed.dAxialFlag = ((locSuperLayer == 1) || (locSuperLayer == 4) || (locSuperLayer == 7));
+			locSeed.dMinRing = dHits[locHitIndices[loc_i]].ring;
+			locSeed.dMaxRing = locSeed.dMinRing;
+			locSeed.dNumInnerLinks = 0;
+		}
+		DGraphSeed& locSeed = locSeeds[locSeedIndexOfRoot[locRoot]];
+		locSeed.dHitIndices.push_back(locHitIndices[loc_i]);
+		int locRing = dHits[locHitIndices[loc_i]].ring;
+		if(locRing < locSeed.dMinRing)
+			locSeed.dMinRing = locRing;
+		if(locRing > locSeed.dMaxRing)
+			locSeed.dMaxRing = locRing;
+	}
+
+	// Drop seeds that are too small or too large
+	vector<DGraphSeed>::iterator locIterator = locSeeds.begin();
+	while(locIterator != locSeeds.end())
+	{
+		if((locIterator->dHitIndices.size() < MIN_SEED_HITS) || (locIterator->dHitIndices.size() > MAX_SEED_HITS))
+			locIterator = locSeeds.erase(locIterator);
+		else
+			++locIterator;
+	}
+}
+
+//---------------------
+// Calc_TransverseDist2
+//---------------------
+double DTrackCandidate_factory_CDCGraph::Calc_TransverseDist2(const DGraphSeed& locInnerSeed, const DGraphSeed& locOuterSeed) const
+{
+	// Minimum distance squared between the hits on the facing rings of the two seeds, less the radial distance between the rings (squared)
+	double locMinDist2 = 9.9E9;
+	for(size_t loc_i = 0; loc_i < locInnerSeed.dHitIndices.size(); ++loc_i)
+	{
+		const DGraphHit& locInnerHit = dHits[locInnerSeed.dHitIndices[loc_i]];
+		if(locInnerHit.ring != locInnerSeed.dMaxRing)
+			continue;
+		for(size_t loc_j = 0; loc_j < locOuterSeed.dHitIndices.size(); ++loc_j)
+		{
+			const DGraphHit& locOuterHit = dHits[locOuterSeed.dHitIndices[loc_j]];
+			if(locOuterHit.ring != locOuterSeed.dMinRing)
+				continue;
+			double locDeltaX = locOuterHit.x - locInnerHit.x;
+			double locDeltaY = locOuterHit.y - locInnerHit.y;
+			double locDeltaR = locOuterHit.r - locInnerHit.r;
+			double locDist2 = fabs(locDeltaX*locDeltaX + locDeltaY*locDeltaY - locDeltaR*locDeltaR);
+			if(locDist2 < locMinDist2)
+				locMinDist2 = locDist2;
+		}
+	}
+	return locMinDist2;
+}
+
+/*********************************************************************************************************************************************************************/
+/******************************************************************************* GRAPH *******************************************************************************/
+/*********************************************************************************************************************************************************************/
+
+//-----------
+// Link_Seeds
+//-----------
+void DTrackCandidate_factory_CDCGraph::Link_Seeds(void)
+{
+	// Link each seed to the closest seeds in the next super layer (or the one after, if none and enabled)
+	// Keep at most MAX_LINKS_PER_SEED outer links for each seed, and then at most MAX_LINKS_PER_SEED inner links for each seed
+	double locMaxLinkDist2 = MAX_LINK_DIST*MAX_LINK_DIST;
+	vector<vector<pair<double, unsigned int> > > locOuterLinks(dSeeds.size()); //dist2, outer seed index
+	for(size_t loc_i = 0; loc_i < dSeeds.size(); ++loc_i)
+	{
+		unsigned int locSuperLayer = dSeeds[loc_i].dSuperLayer;
+		unsigned int locMaxOuterSuperLayer = ENABLE_SUPERLAYER_SKIP ? locSuperLayer + 2 : locSuperLayer + 1;
+		for(unsigned int locOuterSuperLayer = locSuperLayer + 1; (locOuterSuperLayer <= locMaxOuterSuperLayer) && (locOuterSuperLayer <= 7); ++locOuterSuperLayer)
+		{
+			for(size_t loc_j = dFirstSeedIndex[locOuterSuperLayer - 1]; loc_j < dFirstSeedIndex[locOuterSuperLayer]; ++loc_j)
+			{
+				double locDist2 = Calc_TransverseDist2(dSeeds[loc_i], dSeeds[loc_j]);
+				if(locDist2 < locMaxLinkDist2)
+					locOuterLinks[loc_i].push_back(pair<double, unsigned int>(locDist2, loc_j));
+			}
+			if(!locOuterLinks[loc_i].empty())
+				break; //found links: don't skip the super layer
+		}
+		sort(locOuterLinks[loc_i].begin(), locOuterLinks[loc_i].end());
+		if(locOuterLinks[loc_i].size() > MAX_LINKS_PER_SEED)
+			locOuterLinks[loc_i].resize(MAX_LINKS_PER_SEED);
+	}
+
+	// Bound the number of inner links
+	vector<vector<pair<double, unsigned int> > > locInnerLinks(dSeeds.size()); //dist2, inner seed index
+	for(size_t loc_i = 0; loc_i < dSeeds.size(); ++loc_i)
+	{
+		for(size_t loc_j = 0; loc_j < locOuterLinks[loc_i].size(); ++loc_j)
+			locInnerLinks[locOuterLinks[loc_i][loc_j].second].push_back(pair<double, unsigned int>(locOuterLinks[loc_i][loc_j].first, loc_i));
+	}
+	for(size_t loc_i = 0; loc_i < dSeeds.size(); ++loc_i)
+	{
+		sort(locInnerLinks[loc_i].begin(), locInnerLinks[loc_i].end());
+		if(locInnerLinks[loc_i].size() > MAX_LINKS_PER_SEED)
+			locInnerLinks[loc_i].resize(MAX_LINKS_PER_SEED);
+		dSeeds[loc_i].dNumInnerLinks = locInnerLinks[loc_i].size();
+		for(size_t loc_j = 0; loc_j < locInnerLinks[loc_i].size(); ++loc_j)
+			dSeeds[locInnerLinks[loc_i][loc_j].second].dOuterLinks.push_back(loc_i);
+	}
+
+	// Closest first
+	for(size_t loc_i = 0; loc_i < dSeeds.size(); ++loc_i)
+	{
+		vector<unsigned int>& locLinks = dSeeds[loc_i].dOuterLinks;
+		vector<unsigned int> locSortedLinks;
+		for(size_t loc_j = 0; loc_j < locOuterLinks[loc_i].size(); ++loc_j)
+		{
+			if(find(locLinks.begin(), locLinks.end(), locOuterLinks[loc_i][loc_j].second) != locLinks.end())
+				locSortedLinks.push_back(locOuterLinks[loc_i][loc_j].second);
+		}
+		locLinks = locSortedLinks;
+	}
+}
+
+//------------
+// Walk_Chains
+//------------
+void DTrackCandidate_factory_CDCGraph::Walk_Chains(unsigned int locSeedIndex, vector<unsigned int>& locChain, vector<vector<unsigned int> >& locChains) const
+{
+	// Depth-first: save each chain when it can't be extended further
+	if(locChains.size() >= MAX_CHAINS_PER_ROOT)
+		return;
+	locChain.push_back(locSeedIndex);
+	const vector<unsigned int>& locOuterLinks = dSeeds[locSeedIndex].dOuterLinks;
+	if(locOuterLinks.empty())
+		locChains.push_back(locChain);
+	for(size_t loc_i = 0; loc_i < locOuterLinks.size(); ++loc_i)
+		Walk_Chains(locOuterLinks[loc_i], locChain, locChains);
+	locChain.pop_back();
+}
+
+/*********************************************************************************************************************************************************************/
+/****************************************************************************** TRACKS *******************************************************************************/
+/*********************************************************************************************************************************************************************/
+
+//----------
+// Fit_Chain
+//----------
+bool DTrackCandidate_factory_CDCGraph::Fit_Chain(const vector<unsigned int>& locChain, DGraphTrack& locTrack) const
+{
+	// Fit a circle to the axial hits, then theta & z to the stereo hits on it
+	double locAxialStrawVariance = 0.214401; //[d/sqrt(12)]^2, d = 1.604 = straw diameter
+
+	locTrack.dHitIndices.clear();
+	locTrack.dNumSuperLayers = locChain.size();
+	locTrack.dNumAxialSuperLayers = 0;
+	vector<unsigned int> locAxialHitIndices, locStereoHitIndices;
+	for(size_t loc_i = 0; loc_i < locChain.size(); ++loc_i)
+	{
+		const DGraphSeed& locSeed = dSeeds[locChain[loc_i]];
+		vector<unsigned int>& locHitIndices = locSeed.dAxialFlag ? locAxialHitIndices : locStereoHitIndices;
+		locHitIndices.insert(locHitIndices.end(), locSeed.dHitIndices.begin(), locSeed.dHitIndices.end());
+		locTrack.dHitIndices.insert(locTrack.dHitIndices.end(), locSeed.dHitIndices.begin(), locSeed.dHitIndices.end());
+		if(locSeed.dAxialFlag)
+			++locTrack.dNumAxialSuperLayers;
+	}
+	if(locAxialHitIndices.size() < MIN_AXIAL_HITS)
+		return false;
+
+	DHelicalFit locFit;
+	for(size_t loc_i = 0; loc_i < locAxialHitIndices.size(); ++loc_i)
+	{
+		const DVector3& locPos = dHits[locAxialHitIndices[loc_i]].hit->wire->origin;
+		locFit.AddHitXYZ(locPos.x(), locPos.y(), locPos.z(), locAxialStrawVariance, locAxialStrawVariance, 0.0);
+	}
+
+	//place a tighter constraint on the beam center if fewer hits: tracks with detached vertices may not go through the center
+	double locBeamRMS = BeamRMS*locTrack.dNumAxialSuperLayers;
+	if(locFit.FitCircleRiemann(TARGET_Z, locBeamRMS) == NOERROR)
+		locFit.GuessChargeFromCircleFit();
+	else if(locFit.FitCircle() == NOERROR)
+		locFit.FindSenseOfRotation();
+	else
+		return false;
+	if(!(locFit.r0 > 0.0) || !isfinite(locFit.r0))
+		return false;
+
+	// Require that most axial hits are close to the circle
+	unsigned int locNumHitsOnCircle = 0;
+	for(size_t loc_i = 0; loc_i < locAxialHitIndices.size(); ++loc_i)
+	{
+		const DGraphHit& locHit = dHits[locAxialHitIndices[loc_i]];
+		double locDeltaX = locHit.x - locFit.x0;
+		double locDeltaY = locHit.y - locFit.y0;
+		if(fabs(sqrt(locDeltaX*locDeltaX + locDeltaY*locDeltaY) - locFit.r0) < MAX_HIT_DIST)
+			++locNumHitsOnCircle;
+	}
+	if(double(locNumHitsOnCircle) < MIN_HITS_ON_CIRCLE_FRACTION*double(locAxialHitIndices.size()))
+		return false;
+
+	locTrack.x0 = locFit.x0;
+	locTrack.y0 = locFit.y0;
+	locTrack.r0 = locFit.r0;
+	locTrack.h = locFit.h;
+	locTrack.phi = locFit.phi;
+	locTrack.dChiSq = locFit.chisq;
+	locTrack.dNDF = locFit.ndof;
+
+	// Stereo hits: intersections of the wires with the circle
+	vector<DVector3> locStereoPositions;
+	vector<double> locVarZs;
+	for(size_t loc_i = 0; loc_i < locStereoHitIndices.size(); ++loc_i)
+	{
+		DVector3 locPos;
+		double locVarZ = 0.0;
+		if(!Calc_StereoPosition(dHits[locStereoHitIndices[loc_i]].hit->wire, locTrack, locPos, locVarZ))
+			continue;
+		locStereoPositions.push_back(locPos);
+		locVarZs.push_back(locVarZ);
+	}
+	Fit_ThetaZ(locStereoPositions, locVarZs, locTrack);
+
+	return true;
+}
+
+//--------------------
+// Calc_StereoPosition
+//--------------------
+bool DTrackCandidate_factory_CDCGraph::Calc_StereoPosition(const DCDCWire* locWire, const DGraphTrack& locTrack, DVector3& locPos, double& locVarZ) const
+{
+	// Intersection between the circle and the stereo wire (as in DTrackCandidate_factory_CDC)
+	DVector3 locDir = (1./locWire->udir.z())*locWire->udir;
+	double dx = locWire->origin.x() - locTrack.x0;
+	double dy = locWire->origin.y() - locTrack.y0;
+	double ux = locDir.x();
+	double uy = locDir.y();
+	double temp1 = ux*ux + uy*uy;
+	double temp2 = ux*dy - uy*dx;
+	double b = -ux*dx - uy*dy;
+	double A = locTrack.r0*locTrack.r0*temp1 - temp2*temp2;
+	if(A < 0.0)
+		return false; // line along wire does not intersect circle, ever.
+
+	double temp = 1.6/sin(locWire->stereo);
+	locVarZ = temp*temp/12.;
+
+	// Use the root closest to the center of the wire
+	double B = sqrt(A);
+	double dz1 = (b - B)/temp1;
+	double dz2 = (b + B)/temp1;
+	double dz = (fabs(dz2) < fabs(dz1)) ? dz2 : dz1;
+	locPos = locWire->origin + dz*locDir;
+	return true;
+}
+
+//-----------
+// Fit_ThetaZ
+//-----------
+void DTrackCandidate_factory_CDCGraph::Fit_ThetaZ(const vector<DVector3>& locStereoPositions, const vector<double>& locVarZs, DGraphTrack& locTrack) const
+{
+	// Weighted straight-line fit of z vs. the arc length from the point of closest approach to the beam line
+	double locPhiCenter = atan2(locTrack.y0, locTrack.x0);
+	double locXV = locTrack.x0 - locTrack.r0*cos(locPhiCenter);
+	double locYV = locTrack.y0 - locTrack.r0*sin(locPhiCenter);
+	double locTwoRC = 2.0*locTrack.r0;
+
+	vector<double> locArcLengths(locStereoPositions.size());
+	for(size_t loc_i = 0; loc_i < locStereoPositions.size(); ++loc_i)
+	{
+		double locDeltaX = locStereoPositions[loc_i].x() - locXV;
+		double locDeltaY = locStereoPositions[loc_i].y() - locYV;
+		double locRatio = sqrt(locDeltaX*locDeltaX + locDeltaY*locDeltaY)/locTwoRC;
+		locArcLengths[loc_i] = (locRatio < 1.0) ? locTwoRC*asin(locRatio) : locTwoRC*M_PI_2;
+	}
+
+	double locTanL = 0.0;
+	double locZ0 = TARGET_Z;
+	bool locFitOKFlag = false;
+	if(locStereoPositions.size() > 1)
+	{
+		double sumv = 0.0, sumx = 0.0, sumy = 0.0, sumxx = 0.0, sumxy = 0.0;
+		for(size_t loc_i = 0; loc_i < locStereoPositions.size(); ++loc_i)
+		{
+			double locWeight = 1.0/locVarZs[loc_i];
+			double s = locArcLengths[loc_i];
+			double z = locStereoPositions[loc_i].z();
+			sumv += locWeight;
+			sumx += s*locWeight;
+			sumy += z*locWeight;
+			sumxx += s*s*locWeight;
+			sumxy += s*z*locWeight;
+		}
+		double locDelta = sumv*sumxx - sumx*sumx;
+		if(fabs(locDelta) > 0.0)
+		{
+			locTanL = (sumv*sumxy - sumx*sumy)/locDelta;
+			locZ0 = (sumxx*sumy - sumx*sumxy)/locDelta;
+			locFitOKFlag = isfinite(locTanL) && (locZ0 >= VERTEX_Z_MIN) && (locZ0 <= VERTEX_Z_MAX);
+		}
+	}
+	if(!locFitOKFlag)
+	{
+		// Assume that the track came from the center of the target
+		locZ0 = TARGET_Z;
+		locTanL = 0.0;
+		double locSumWeights = 0.0;
+		for(size_t loc_i = 0; loc_i < locStereoPositions.size(); ++loc_i)
+		{
+			if(!(locArcLengths[loc_i] > 0.0))
+				continue;
+			double locWeight = 1.0/locVarZs[loc_i];
+			locTanL += locWeight*(locStereoPositions[loc_i].z() - locZ0)/locArcLengths[loc_i];
+			locSumWeights += locWeight;
+		}
+		if(locSumWeights > 0.0)
+			locTanL /= locSumWeights;
+	}
+
+	locTrack.dTheta = M_PI_2 - atan(locTanL);
+	locTrack.dVertexZ = locZ0;
+}
+
+//----------
+// Is_Better
+//----------
+bool DTrackCandidate_factory_CDCGraph::Is_Better(const DGraphTrack& locTrack1, const DGraphTrack& locTrack2) const
+{
+	// More super layers, then more hits, then smaller chisq/ndf
+	if(locTrack1.dNumSuperLayers != locTrack2.dNumSuperLayers)
+		return (locTrack1.dNumSuperLayers > locTrack2.dNumSuperLayers);
+	if(locTrack1.dHitIndices.size() != locTrack2.dHitIndices.size())
+		return (locTrack1.dHitIndices.size() > locTrack2.dHitIndices.size());
+	double locChiSqPerNDF1 = (locTrack1.dNDF > 0) ? locTrack1.dChiSq/double(locTrack1.dNDF) : 0.0;
+	double locChiSqPerNDF2 = (locTrack2.dNDF > 0) ? locTrack2.dChiSq/double(locTrack2.dNDF) : 0.0;
+	return (locChiSqPerNDF1 < locChiSqPerNDF2);
+}
+
+//----------------------
+// Create_TrackCandidate
+//----------------------
+void DTrackCandidate_factory_CDCGraph::Create_TrackCandidate(const DGraphTrack& locTrack)
+{
+	// Position & momentum at the point of closest approach to the beam line
+	double locTanL = tan(M_PI_2 - locTrack.dTheta);
+	double locPhiCenter = atan2(locTrack.y0, locTrack.x0);
+	DVector3 locPos(locTrack.x0 - locTrack.r0*cos(locPhiCenter), locTrack.y0 - locTrack.r0*sin(locPhiCenter), locTrack.dVertexZ);
+	double pt = 0.003*fabs(dMagneticField->GetBz(locPos.x(), locPos.y(), locPos.z()))*locTrack.r0;
+	DVector3 locMom(pt*cos(locTrack.phi), pt*sin(locTrack.phi), pt*locTanL);
+	if(!(locMom.Mag() > 0.0))
+	{
+		if(DEBUG_LEVEL > 5)
+			cout << "Track momentum not greater than zero (or NaN), DTrackCandidate object not created." << endl;
+		return;
+	}
+
+	DTrackCandidate *locTrackCandidate = new DTrackCandidate;
+	locTrackCandidate->rc = locTrack.r0;
+	locTrackCandidate->xc = locTrack.x0;
+	locTrackCandidate->yc = locTrack.y0;
+	Particle_t locPID = (locTrack.h*dFactorForSenseOfRotation > 0.0) ? PiPlus : PiMinus;
+	locTrackCandidate->setPID(locPID);
+	locTrackCandidate->chisq = locTrack.dChiSq;
+	locTrackCandidate->Ndof = locTrack.dNDF;
+	locTrackCandidate->setPosition(locPos);
+	locTrackCandidate->setMomentum(locMom);
+
+	for(size_t loc_i = 0; loc_i < locTrack.dHitIndices.size(); ++loc_i)
+	{
+		const DGraphHit& locHit = dHits[locTrack.dHitIndices[loc_i]];
+		locTrackCandidate->AddAssociatedObject(locHit.hit);
+		locTrackCandidate->used_cdc_indexes.push_back(locHit.index);
+	}
+
+	if(DEBUG_LEVEL > 3)
+		cout << "CDCGraph candidate: p = " << locMom.Mag() << " theta = " << locMom.Theta() << " phi = " << locMom.Phi() << " z = " << locPos.Z() << endl;
+
+	_data.push_back(locTrackCandidate);
+}
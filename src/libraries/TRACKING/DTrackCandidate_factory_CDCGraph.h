@@ -0,0 +1,153 @@
+// $Id$
+//
+//    File: DTrackCandidate_factory_CDCGraph.h
+//
+
+#ifndef _DTrackCandidate_factory_CDCGraph_
+#define _DTrackCandidate_factory_CDCGraph_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+#include <JANA/JFactory.h>
+using namespace jana;
+
+#include "DTrackCandidate.h"
+#include "DHelicalFit.h"
+#include "CDC/DCDCTrackHit.h"
+#include <DVector3.h>
+#include <HDGEOMETRY/DGeometry.h>
+#include <HDGEOMETRY/DMagneticFieldMap.h>
+
+/*
+Alternative CDC track finder (tag "CDCGraph"), for comparison with DTrackCandidate_factory_CDC.
+
+1) Seeds: in each super layer, the hits are grouped into connected clusters (adjacent straws, or rings within MAX_HIT_DIST).
+	The super layers are independent, so for busy events (>= PARALLEL_MIN_HITS hits) they can be clustered in parallel,
+	by worker threads that the factory starts once (in brun) and keeps for the whole job. Off by default:
+	JANA already keeps every core busy with its own events, so this only helps when there are fewer events in flight than cores.
+	Seeds with more than MAX_SEED_HITS hits (spiral blobs) are dropped instead of being split up.
+2) Graph: each seed is linked to the seeds in the next super layer(s) that are within MAX_LINK_DIST (transverse to the rings).
+	Only the MAX_LINKS_PER_SEED closest links are kept, in each direction: the graph has bounded degree,
+	so the number of seed chains (and the time per event) is bounded by the number of seeds, not its power.
+3) Tracks: the chains starting from seeds without inner links are walked outwards (at most MAX_CHAINS_PER_ROOT per start),
+	each is fit (circle to the axial hits, theta/z to the stereo hits), and the best chain of each start is kept.
+	The kept chains are accepted by decreasing #hits, rejecting those sharing more than MAX_COMMON_HIT_FRACTION of their hits.
+
+Parameters are TRKFIND_CDCGRAPH:*. See the cdc_candidate_compare plugin for an efficiency/purity comparison with the "CDC" tag.
+*/
+
+class DTrackCandidate_factory_CDCGraph : public JFactory<DTrackCandidate>
+{
+	public:
+		DTrackCandidate_factory_CDCGraph(){};
+		~DTrackCandidate_factory_CDCGraph(){Stop_Workers();};
+		const char* Tag(void){return "CDCGraph";}
+
+		// One per wire (first hit only)
+		class DGraphHit
+		{
+			public:
+				const DCDCTrackHit* hit;
+				unsigned int index; //in the DCDCTrackHit list: for DTrackCandidate::used_cdc_indexes
+				int ring;
+				int straw;
+				double x, y, r; //wire origin
+		};
+
+		// Cluster of connected hits in one super layer: a node of the graph
+		class DGraphSeed
+		{
+			public:
+				vector<unsigned int> dHitIndices; //into dHits
+				unsigned int dSuperLayer; //1 -> 7
+				bool dAxialFlag;
+				int dMinRing;
+				int dMaxRing;
+				vector<unsigned int> dOuterLinks; //indices into dSeeds, closest first
+				unsigned int dNumInnerLinks;
+		};
+
+		// Chain of linked seeds and its fit
+		class DGraphTrack
+		{
+			public:
+				vector<unsigned int> dHitIndices; //into dHits
+				unsigned int dNumSuperLayers;
+				unsigned int dNumAxialSuperLayers;
+				double x0, y0, r0, h, phi; //circle fit
+				double dChiSq;
+				int dNDF;
+				double dTheta;
+				double dVertexZ;
+		};
+
+	private:
+		jerror_t init(void);						///< Called once at program start.
+		jerror_t brun(JEventLoop *locEventLoop, int32_t runnumber);	///< Called everytime a new run number is detected.
+		jerror_t evnt(JEventLoop *locEventLoop, uint64_t eventnumber);	///< Called every event.
+		jerror_t fini(void);						///< Called after last event of last event source has been processed.
+
+		// Seeds
+		bool Get_CDCHits(JEventLoop* locEventLoop);
+		void Find_SuperLayerSeeds(unsigned int locSuperLayer, vector<DGraphSeed>& locSeeds) const;
+		double Calc_TransverseDist2(const DGraphSeed& locInnerSeed, const DGraphSeed& locOuterSeed) const;
+
+		// Seed-finding workers (super layers 2 -> 7; super layer 1 is done by the event thread)
+		void Start_Workers(void);
+		void Stop_Workers(void);
+		void Worker_Thread(unsigned int locSuperLayer);
+
+		// Graph
+		void Link_Seeds(void);
+		void Walk_Chains(unsigned int locSeedIndex, vector<unsigned int>& locChain, vector<vector<unsigned int> >& locChains) const;
+
+		// Tracks
+		bool Fit_Chain(const vector<unsigned int>& locChain, DGraphTrack& locTrack) const;
+		bool Calc_StereoPosition(const DCDCWire* locWire, const DGraphTrack& locTrack, DVector3& locPos, double& locVarZ) const;
+		void Fit_ThetaZ(const vector<DVector3>& locStereoPositions, const vector<double>& locVarZs, DGraphTrack& locTrack) const;
+		bool Is_Better(const DGraphTrack& locTrack1, const DGraphTrack& locTrack2) const;
+		void Create_TrackCandidate(const DGraphTrack& locTrack);
+
+		int DEBUG_LEVEL;
+		unsigned int MAX_ALLOWED_CDC_HITS;
+		double MAX_DRIFT_TIME;
+		double MAX_HIT_DIST;
+		unsigned int MIN_SEED_HITS;
+		unsigned int MAX_SEED_HITS;
+		double MAX_LINK_DIST;
+		unsigned int MAX_LINKS_PER_SEED;
+		bool ENABLE_SUPERLAYER_SKIP;
+		unsigned int MAX_SUPERLAYER_NEW_TRACK;
+		unsigned int MAX_CHAINS_PER_ROOT;
+		unsigned int MIN_AXIAL_HITS;
+		double MIN_HITS_ON_CIRCLE_FRACTION;
+		double MAX_COMMON_HIT_FRACTION;
+		unsigned int PARALLEL_MIN_HITS;
+
+		double TARGET_Z;
+		double VERTEX_Z_MIN;
+		double VERTEX_Z_MAX;
+
+		const DMagneticFieldMap* dMagneticField;
+		double dFactorForSenseOfRotation;
+
+		vector<DGraphHit> dHits;
+		vector<vector<unsigned int> > dHitsBySuperLayer; //index 0 -> 6 is super layer 1 -> 7; hit indices sorted by ring, straw
+		vector<DGraphSeed> dSeeds; //all super layers, inner to outer
+		vector<unsigned int> dFirstSeedIndex; //index of the first seed of each super layer in dSeeds, plus one-past-the-end
+
+		vector<thread> dWorkerThreads;
+		mutex dWorkerMutex;
+		condition_variable dWorkStart;
+		condition_variable dWorkDone;
+		uint64_t dWorkGeneration = 0; //incremented for each event given to the workers
+		unsigned int dNumWorkersBusy = 0;
+		bool dWorkerQuitFlag = false;
+		vector<vector<DGraphSeed> >* dWorkSeeds = nullptr; //seeds by super layer of the current event
+};
+
+#endif // _DTrackCandidate_factory_CDCGraph_
@@ -192,18 +192,26 @@ void DTrackFitter::AddHits(vector<const DGEMPoint*> gemhits)
 
 
 //-------------------
-// FitTrack
+// SetInputParameters
 //-------------------
-DTrackFitter::fit_status_t DTrackFitter::FitTrack(const DVector3 &pos, const DVector3 &mom, double q, double mass,double t0,DetectorSystem_t t0_det)
+void DTrackFitter::SetInputParameters(const DVector3 &pos, const DVector3 &mom, double q, double mass,double t0,DetectorSystem_t t0_det)
 {
-#ifdef PROFILE_TRK_TIMES
-    prof_time start_time;
-#endif	
 	input_params.setPosition(pos);
 	input_params.setMomentum(mom);
 	input_params.setPID(IDTrack(q, mass));
 	input_params.setTime(t0);
 	input_params.setT0(t0,0.,t0_det);
+}
+
+//-------------------
+// FitTrack
+//-------------------
+DTrackFitter::fit_status_t DTrackFitter::FitTrack(const DVector3 &pos, const DVector3 &mom, double q, double mass,double t0,DetectorSystem_t t0_det)
+{
+#ifdef PROFILE_TRK_TIMES
+    prof_time start_time;
+#endif	
+	SetInputParameters(pos, mom, q, mass, t0, t0_det);
 
 	DTrackFitter::fit_status_t status = FitTrack();
 
@@ -319,29 +327,15 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
   return fit_status;
 }
 //-------------------
-// FindHitsAndFitTrack
+// FindHits
 //-------------------
-DTrackFitter::fit_status_t 
-DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
-				  const DReferenceTrajectory *rt, JEventLoop *loop, 
-				  double mass,int N,double t0,
-				  DetectorSystem_t t0_det)
+bool DTrackFitter::FindHits(const DKinematicData &starting_params,
+			    const DReferenceTrajectory *rt, JEventLoop *loop, 
+			    double mass,int N)
 {
-	/// Fit a DTrackCandidate using a given mass hypothesis.
-	///
-	/// This will perform a full wire-based and time-based
-	/// fit using the given mass and starting from the given
-	/// candidate. The given DReferenceTrajectory is used to
-	/// swim the track numerous times during the various stages
-	/// but will be left with the final time-based fit result.
-	/// The JEventLoop given will be used to get the hits (CDC
-	/// and FDC) and default DTrackHitSelector to use for the
-	/// fit.
-#ifdef PROFILE_TRK_TIMES
-  prof_times["Ntracks"].real += 1.0; // keep count of the number of tracks we fit
-
-  prof_time start_time;
-#endif
+	/// Select the CDC and FDC hits along the DReferenceTrajectory the way
+	/// FindHitsAndFitTrack does and add them to this fitter without fitting.
+	/// Returns false if no hits were found.
 
 	// Reset fitter saving the type of fit we're doing
 	fit_type_t save_type = fit_type;
@@ -350,33 +344,14 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
 	
 	// If a mass<0 is passed in, get it from starting_params instead
 	if(mass<0.0)mass = starting_params.mass();
-
-	// Correct for energy loss in target etc. based on particle mass in starting_params
-	DVector3 pos, mom; // (holds parameters at vertex after correction)
-	/*
-	if(CORRECT_FOR_ELOSS && fit_type==kWireBased){
-		jerror_t err = CorrectForELoss(starting_params, rt, pos, mom, mass);
-		if(err != NOERROR){
-			pos = starting_params.position();
-			mom = starting_params.momentum();
-		}
-	}else{
-	*/
-	  pos = starting_params.position();
-	  mom = starting_params.momentum();
-	  //}
 	double q=starting_params.charge();
-       
-	// Swim a reference trajectory with this candidate's parameters
-	//rt->Swim(pos, mom, q);
-	//if(rt->Nswim_steps<1)return fit_status = kFitFailed;
 
 	// Get pointer to DTrackHitSelector object
 	vector<const DTrackHitSelector *> hitselectors;
 	loop->Get(hitselectors);
 	if(hitselectors.size()<1){
 		_DBG_<<"Unable to get a DTrackHitSelector object! NO Charged track fitting will be done!"<<endl;
-		return fit_status = kFitNotDone;
+		return false;
 	}
 	const DTrackHitSelector * hitselector = hitselectors[0];
 
@@ -391,15 +366,51 @@ DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
 	// If the condition below is met, it seems that the track parameters 
 	// are inconsistent with the hits used to create the track candidate, 
 	// in which case we have to bail...
-	if (fdchits.size()+cdchits.size()==0) return fit_status=kFitNotDone;
+	if (fdchits.size()+cdchits.size()==0) return false;
 	
 	// In case the subclass doesn't actually set the mass ....
 	fit_params.setPID(IDTrack(q, mass));
 
+	return true;
+}
+
+//-------------------
+// FindHitsAndFitTrack
+//-------------------
+DTrackFitter::fit_status_t 
+DTrackFitter::FindHitsAndFitTrack(const DKinematicData &starting_params,
+				  const DReferenceTrajectory *rt, JEventLoop *loop, 
+				  double mass,int N,double t0,
+				  DetectorSystem_t t0_det)
+{
+	/// Fit a DTrackCandidate using a given mass hypothesis.
+	///
+	/// This will perform a full wire-based and time-based
+	/// fit using the given mass and starting from the given
+	/// candidate. The given DReferenceTrajectory is used to
+	/// swim the track numerous times during the various stages
+	/// but will be left with the final time-based fit result.
+	/// The JEventLoop given will be used to get the hits (CDC
+	/// and FDC) and default DTrackHitSelector to use for the
+	/// fit.
+#ifdef PROFILE_TRK_TIMES
+  prof_times["Ntracks"].real += 1.0; // keep count of the number of tracks we fit
+
+  prof_time start_time;
+#endif
+
+	if(!FindHits(starting_params, rt, loop, mass, N)) return fit_status = kFitNotDone;
+
 #ifdef PROFILE_TRK_TIMES
 	start_time.TimeDiffNow(prof_times, "Find Hits");
 #endif
 
+	// If a mass<0 is passed in, get it from starting_params instead
+	if(mass<0.0)mass = starting_params.mass();
+	DVector3 pos = starting_params.position();
+	DVector3 mom = starting_params.momentum();
+	double q=starting_params.charge();
+
 	// Do the fit
 	fit_status = FitTrack(pos, mom,q, mass,t0,t0_det);
 
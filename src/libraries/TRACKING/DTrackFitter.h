@@ -178,6 +178,7 @@ class DTrackFitter:public jana::JObject{
 
 		void SetFitType(fit_type_t type){fit_type=type;}
 		void SetInputParameters(const DTrackingData &starting_params){input_params=starting_params;}
+		void SetInputParameters(const DVector3 &pos, const DVector3 &mom, double q, double mass,double t0=QuietNaN,DetectorSystem_t t0_det=SYS_NULL);
 		
 		// Wrappers
 		fit_status_t FitTrack(const DVector3 &pos, const DVector3 &mom, double q, double mass,double t0=QuietNaN,DetectorSystem_t t0_det=SYS_NULL);
@@ -192,6 +193,10 @@ class DTrackFitter:public jana::JObject{
 				      double t0=QuietNaN,
 				      DetectorSystem_t t0_det=SYS_NULL
 				      ); ///< mass<0 means get it from starting_params
+		bool FindHits(const DKinematicData &starting_params, 
+			      const DReferenceTrajectory *rt, 
+			      JEventLoop *loop, double mass=-1.0,
+			      int N=0); ///< hit selection of FindHitsAndFitTrack without the fit
 		fit_status_t 
 		  FindHitsAndFitTrack(const DKinematicData &starting_params, 
 				      const map<DetectorSystem_t,vector<DTrackFitter::Extrapolation_t> >&extrapolations,
@@ -3,6 +3,7 @@
 //************************************************************************
 
 #include "DTrackFitterKalmanSIMD.h"
+#include "DKalmanSoA.h"
 #include "CDC/DCDCTrackHit.h"
 #include "HDGEOMETRY/DLorentzDeflections.h"
 #include "HDGEOMETRY/DMaterialMap.h"
@@ -19,6 +20,7 @@
 
 #include <iomanip>
 #include <math.h>
+#include <typeinfo>
 
 #define MAX_TB_PASSES 20
 #define MAX_WB_PASSES 20
@@ -1099,6 +1101,335 @@ DTrackFitter::fit_status_t DTrackFitterKalmanSIMD::FitTrack(void)
    return fit_status;
 }
 
+//-----------------
+// PrepareFit
+//-----------------
+bool DTrackFitterKalmanSIMD::PrepareFit(void)
+{
+   // Reset member data and free an memory associated with the last fit,
+   // but some of which only for wire-based fits 
+   ResetKalmanSIMD();
+
+   // Check that we have enough FDC and CDC hits to proceed
+   if (cdchits.size()==0 && fdchits.size()<4) return false;
+   if (cdchits.size()+fdchits.size() < 6) return false;
+   
+   // Copy hits from base class into structures specific to DTrackFitterKalmanSIMD  
+   if (USE_CDC_HITS) 
+     for(unsigned int i=0; i<cdchits.size(); i++)AddCDCHit(cdchits[i]);
+   if (USE_FDC_HITS)
+     for(unsigned int i=0; i<fdchits.size(); i++)AddFDCHit(fdchits[i]);
+   if (USE_TRD_HITS){
+     for(unsigned int i=0; i<trdhits.size(); i++)AddTRDHit(trdhits[i]);
+     if (trdhits.size()>0){
+       //_DBG_ << "Got TRD" <<endl;
+       got_trd_gem_hits=true;
+     }
+   }
+   if (USE_GEM_HITS){
+     for(unsigned int i=0; i<gemhits.size(); i++)AddGEMHit(gemhits[i]);
+     if (gemhits.size()>0){
+       //_DBG_ << " Got GEM" << endl;
+       got_trd_gem_hits=true;
+     }
+   }
+
+   unsigned int num_good_cdchits=my_cdchits.size();
+   unsigned int num_good_fdchits=my_fdchits.size(); 
+
+   // keep track of the range of detector elements that could be hit
+   // for calculating the number of expected hits later on
+   //int min_cdc_ring=-1, max_cdc_ring=-1;
+
+   // Order the cdc hits by ring number
+   if (num_good_cdchits>0){
+      stable_sort(my_cdchits.begin(),my_cdchits.end(),DKalmanSIMDCDCHit_cmp);
+
+	  //min_cdc_ring = my_cdchits[0]->hit->wire->ring;
+	  //max_cdc_ring = my_cdchits[my_cdchits.size()-1]->hit->wire->ring;
+
+      // Look for multiple hits on the same wire
+      for (unsigned int i=0;i<my_cdchits.size()-1;i++){
+         if (my_cdchits[i]->hit->wire->ring==my_cdchits[i+1]->hit->wire->ring && 
+               my_cdchits[i]->hit->wire->straw==my_cdchits[i+1]->hit->wire->straw){
+            num_good_cdchits--;	
+            if (my_cdchits[i]->tdrift<my_cdchits[i+1]->tdrift){
+               my_cdchits[i+1]->status=late_hit;
+            }
+            else{
+               my_cdchits[i]->status=late_hit;
+            }
+         }
+      }
+
+   }
+   // Order the fdc hits by z
+   if (num_good_fdchits>0){
+      stable_sort(my_fdchits.begin(),my_fdchits.end(),DKalmanSIMDFDCHit_cmp);
+
+      // Look for multiple hits on the same wire 
+      for (unsigned int i=0;i<my_fdchits.size()-1;i++){
+	if (my_fdchits[i]->hit==NULL || my_fdchits[i+1]->hit==NULL) continue;
+         if (my_fdchits[i]->hit->wire->layer==my_fdchits[i+1]->hit->wire->layer &&
+               my_fdchits[i]->hit->wire->wire==my_fdchits[i+1]->hit->wire->wire){
+            num_good_fdchits--;
+	    if (fabs(my_fdchits[i]->t-my_fdchits[i+1]->t)<EPS){
+	      double tsum_1=my_fdchits[i]->hit->t_u+my_fdchits[i]->hit->t_v;
+	      double tsum_2=my_fdchits[i+1]->hit->t_u+my_fdchits[i+1]->hit->t_v;
+	      if (tsum_1<tsum_2){
+		my_fdchits[i+1]->status=late_hit;
+	      }
+	      else{
+		my_fdchits[i]->status=late_hit;
+	      }
+	    }
+            else if (my_fdchits[i]->t<my_fdchits[i+1]->t){
+               my_fdchits[i+1]->status=late_hit;
+            }
+            else{
+               my_fdchits[i]->status=late_hit;
+            }
+         }
+      }
+   }
+   if (num_good_cdchits==0 && num_good_fdchits<4) return false;
+   if (num_good_cdchits+num_good_fdchits < 6) return false;
+
+   // Create vectors of updates (from hits) to S and C
+   if (my_cdchits.size()>0){
+      cdc_updates=vector<DKalmanUpdate_t>(my_cdchits.size());
+      // Initialize vector to keep track of whether or not a hit is used in 
+      // the fit
+      cdc_used_in_fit=vector<bool>(my_cdchits.size());
+   }
+   if (my_fdchits.size()>0){
+      fdc_updates=vector<DKalmanUpdate_t>(my_fdchits.size());
+      // Initialize vector to keep track of whether or not a hit is used in 
+      // the fit
+      fdc_used_in_fit=vector<bool>(my_fdchits.size());
+   }
+
+   // start time and variance
+   if (fit_type==kTimeBased){
+      mT0=input_params.t0();
+      switch(input_params.t0_detector()){
+      case SYS_TOF:
+	mVarT0=0.01;
+	break;
+      case SYS_CDC:
+	mVarT0=7.5;
+	break;
+      case SYS_FDC:
+	mVarT0=7.5;
+	break;
+      case SYS_BCAL:
+	mVarT0=0.25;
+	break;
+      default:
+	mVarT0=0.09;
+	break;
+      }
+   }
+   
+   //_DBG_ << SystemName(input_params.t0_detector()) << " " << mT0 <<endl;
+
+   //Set the mass
+   MASS=input_params.mass();
+   mass2=MASS*MASS;
+   m_ratio=ELECTRON_MASS/MASS;
+   m_ratio_sq=m_ratio*m_ratio;
+
+   // Is this particle an electron or positron?
+   if (MASS<0.001){
+      IsHadron=false;
+      if (input_params.charge()<0.) IsElectron=true;
+      else IsPositron=true;
+   }
+   if (DEBUG_LEVEL>0)
+     {
+       _DBG_ << "------Starting " 
+         <<(fit_type==kTimeBased?"Time-based":"Wire-based") 
+         << " Fit with " << my_fdchits.size() << " FDC hits and " 
+         << my_cdchits.size() << " CDC hits.-------" <<endl;
+      if (fit_type==kTimeBased){
+	_DBG_ << " Using t0=" << mT0 << " from DET=" 
+            << input_params.t0_detector() <<endl;
+      }
+   }
+
+   return true;
+}
+
+//-----------------
+// FinishFit
+//-----------------
+DTrackFitter::fit_status_t DTrackFitterKalmanSIMD::FinishFit(jerror_t error)
+{
+   if (error!=NOERROR){
+      if (DEBUG_LEVEL>0)
+         _DBG_ << "Fit failed with Error = " << error <<endl;
+      return kFitFailed;
+   }
+
+   // Copy fit results into DTrackFitter base-class data members
+   DVector3 mom,pos;
+   GetPosition(pos);
+   GetMomentum(mom);
+   double charge = GetCharge();
+   fit_params.setPosition(pos);
+   fit_params.setMomentum(mom);
+   fit_params.setTime(mT0MinimumDriftTime);
+   fit_params.setPID(IDTrack(charge, MASS));
+   fit_params.setT0(mT0MinimumDriftTime,4.,mT0Detector);
+
+   if (DEBUG_LEVEL>0){
+      _DBG_ << "----- Pass: " 
+         << (fit_type==kTimeBased?"Time-based ---":"Wire-based ---") 
+         << " Mass: " << MASS 
+         << " p=" 	<< mom.Mag()
+         << " theta="  << 90.0-180./M_PI*atan(tanl_)
+         << " vertex=(" << x_ << "," << y_ << "," << z_<<")"
+         << " chi2=" << chisq_
+         <<endl;
+      if(DEBUG_LEVEL>3){
+         //Dump pulls
+         for (unsigned int iPull = 0; iPull < pulls.size(); iPull++){
+            if (pulls[iPull].cdc_hit != NULL){
+	      _DBG_ << " ring: " <<  pulls[iPull].cdc_hit->wire->ring
+		    << " straw: " << pulls[iPull].cdc_hit->wire->straw  
+		    << " Residual: " << pulls[iPull].resi
+		    << " Err: " << pulls[iPull].err
+		    << " tdrift: " << pulls[iPull].tdrift
+		    << " doca: " << pulls[iPull].d
+		    << " docaphi: " << pulls[iPull].docaphi
+		    << " z: " << pulls[iPull].z
+		    << " cos(theta_rel): " << pulls[iPull].cosThetaRel
+		    << " tcorr: " << pulls[iPull].tcorr 
+		    << endl;
+            }
+         }
+      }
+   }
+
+   DMatrixDSym errMatrix(5);
+   // Fill the tracking error matrix and the one needed for kinematic fitting
+   if (fcov.size()!=0){      
+      // We MUST fill the entire matrix (not just upper right) even though 
+      // this is a DMatrixDSym
+      for (unsigned int i=0;i<5;i++){
+         for (unsigned int j=0;j<5;j++){
+            errMatrix(i,j)=fcov[i][j];
+         }
+      }
+      if (FORWARD_PARMS_COV){
+         fit_params.setForwardParmFlag(true);    
+         fit_params.setTrackingStateVector(x_,y_,tx_,ty_,q_over_p_);
+
+         // Compute and fill the error matrix needed for kinematic fitting
+         fit_params.setErrorMatrix(Get7x7ErrorMatrixForward(errMatrix));
+      }
+      else {
+         fit_params.setForwardParmFlag(false); 
+         fit_params.setTrackingStateVector(q_over_pt_,phi_,tanl_,D_,z_);
+
+         // Compute and fill the error matrix needed for kinematic fitting
+         fit_params.setErrorMatrix(Get7x7ErrorMatrix(errMatrix));
+      }
+   }
+   else if (cov.size()!=0){
+      fit_params.setForwardParmFlag(false);
+
+      // We MUST fill the entire matrix (not just upper right) even though 
+      // this is a DMatrixDSym
+      for (unsigned int i=0;i<5;i++){
+         for (unsigned int j=0;j<5;j++){
+            errMatrix(i,j)=cov[i][j];
+         }
+      }
+      fit_params.setTrackingStateVector(q_over_pt_,phi_,tanl_,D_,z_);
+
+      // Compute and fill the error matrix needed for kinematic fitting
+      fit_params.setErrorMatrix(Get7x7ErrorMatrix(errMatrix));
+   }
+   auto locTrackingCovarianceMatrix = dResourcePool_TMatrixFSym->Get_SharedResource();
+   locTrackingCovarianceMatrix->ResizeTo(5, 5);
+   for(unsigned int loc_i = 0; loc_i < 5; ++loc_i)
+   {
+      for(unsigned int loc_j = 0; loc_j < 5; ++loc_j)
+         (*locTrackingCovarianceMatrix)(loc_i, loc_j) = errMatrix(loc_i, loc_j);
+
+   }
+   fit_params.setTrackingErrorMatrix(locTrackingCovarianceMatrix);
+   this->chisq = GetChiSq();
+   this->Ndof = GetNDF();
+   fit_status = kFitSuccess;
+
+   // figure out the number of expected hits for this track based on the final fit
+	set<const DCDCWire *> expected_hit_straws;
+	set<int> expected_hit_fdc_planes;
+
+	for(uint i=0; i<extrapolations[SYS_CDC].size(); i++) {
+		// figure out the radial position of the point to see which ring it's in
+		double r = extrapolations[SYS_CDC][i].position.Perp();
+		uint ring=0;
+		for(; ring<cdc_rmid.size(); ring++) {
+			//_DBG_ << "Rs = " << r << " " << cdc_rmid[ring] << endl;
+			if( (r<cdc_rmid[ring]-0.78) || (fabs(r-cdc_rmid[ring])<0.78) )
+				break;
+		}
+		if(ring == cdc_rmid.size()) ring--;
+		//_DBG_ << "ring = " << ring << endl;
+		//_DBG_ << "ring = " << ring << "  stereo = " << cdcwires[ring][0]->stereo << endl;
+		int best_straw=0;
+		double best_dist_diff=fabs((extrapolations[SYS_CDC][i].position 
+			- cdcwires[ring][0]->origin).Mag());		
+	    // match based on straw center
+	    for(uint straw=1; straw<cdcwires[ring].size(); straw++) {
+	    	DVector3 wire_position = cdcwires[ring][straw]->origin;  // start with the nominal wire center
+	    	// now take into account the z dependence due to the stereo angle
+	    	double dz = extrapolations[SYS_CDC][i].position.Z() - cdcwires[ring][straw]->origin.Z();
+	    	double ds = dz*tan(cdcwires[ring][straw]->stereo);
+	    	wire_position += DVector3(-ds*sin(cdcwires[ring][straw]->origin.Phi()), ds*cos(cdcwires[ring][straw]->origin.Phi()), dz);
+	    	double diff = fabs((extrapolations[SYS_CDC][i].position
+				- wire_position).Mag());
+			if( diff < best_dist_diff )
+				best_straw = straw;
+	    }
+	    
+	    expected_hit_straws.insert(cdcwires[ring][best_straw]);
+	}
+	
+	for(uint i=0; i<extrapolations[SYS_FDC].size(); i++) {
+		// check to make sure that the track goes through the sensitive region of the FDC
+		// assume one hit per plane
+		double z = extrapolations[SYS_FDC][i].position.Z();
+		double r = extrapolations[SYS_FDC][i].position.Perp();
+
+		// see if we're in the "sensitive area" of a package
+		for(uint plane=0; plane<fdc_z_wires.size(); plane++) {
+			int package = plane/6;
+			if(fabs(z-fdc_z_wires[plane]) < fdc_package_size) {
+				if( r<fdc_rmax && r>fdc_rmin_packages[package]) {
+					expected_hit_fdc_planes.insert(plane);
+				}
+				break; // found the right plane
+			}
+ 		}
+	}
+	
+	potential_cdc_hits_on_track = expected_hit_straws.size();
+	potential_fdc_hits_on_track = expected_hit_fdc_planes.size();
+
+    if(DEBUG_LEVEL>0) {
+   		_DBG_ << " CDC hits/potential hits " << my_cdchits.size() << "/" << potential_cdc_hits_on_track 
+        	 << "  FDC hits/potential hits " << my_fdchits.size() << "/" << potential_fdc_hits_on_track  << endl;
+	}
+	
+   //_DBG_  << "========= done!" << endl;
+
+   return fit_status;
+}
+
 //-----------------
 // ChiSq
 //-----------------
@@ -3239,6 +3570,168 @@ double DTrackFitterKalmanSIMD::GetEnergyVariance(double ds,
    return var;
 }
 
+// Starting parameters for the Kalman filter from the input parameters
+jerror_t DTrackFitterKalmanSIMD::SetKalmanSeed(DKalmanSeed_t &seed){
+   if (z_<Z_MIN) return VALUE_OUT_OF_RANGE;
+
+   chisq_=-1.;
+
+   // Angle with respect to beam line
+   double theta_deg=(180/M_PI)*input_params.momentum().Theta();
+   //double theta_deg_sq=theta_deg*theta_deg;
+   double tanl0=tanl_=tan(M_PI_2-input_params.momentum().Theta());
+
+   // Azimuthal angle
+   double phi0=phi_=input_params.momentum().Phi();
+
+   // Guess for momentum error
+   double dpt_over_pt=0.1;
+   /*
+      if (theta_deg<15){
+      dpt_over_pt=0.107-0.0178*theta_deg+0.000966*theta_deg_sq;
+      }
+      else {
+      dpt_over_pt=0.0288+0.00579*theta_deg-2.77e-5*theta_deg_sq;
+      }
+      */
+   /* 
+      if (theta_deg<28.){
+      theta_deg=28.;
+      theta_deg_sq=theta_deg*theta_deg;
+      }
+      else if (theta_deg>125.){          
+      theta_deg=125.;
+      theta_deg_sq=theta_deg*theta_deg;
+      }
+      */
+   double sig_lambda=0.02;
+   double dp_over_p_sq
+      =dpt_over_pt*dpt_over_pt+tanl_*tanl_*sig_lambda*sig_lambda;
+
+   // Input charge
+   double q=input_params.charge();
+
+   // Input momentum 
+   DVector3 pvec=input_params.momentum();
+   double p_mag=pvec.Mag();
+   double px=pvec.x();
+   double py=pvec.y();
+   double pz=pvec.z();
+   double q_over_p0=q_over_p_=q/p_mag;
+   double q_over_pt0=q_over_pt_=q/pvec.Perp();
+
+   // Initial position
+   double x0=x_=input_params.position().x();
+   double y0=y_=input_params.position().y();
+   double z0=z_=input_params.position().z();
+
+   if (fit_type==kWireBased && theta_deg>10.){
+     double Bz=fabs(bfield->GetBz(x0,y0,z0));
+     double sperp=25.; // empirical guess
+     if (my_fdchits.size()>0 && my_fdchits[0]->hit!=NULL){
+       double my_z=my_fdchits[0]->z;
+       double my_x=my_fdchits[0]->hit->xy.X();
+       double my_y=my_fdchits[0]->hit->xy.Y();
+       Bz+=fabs(bfield->GetBz(my_x,my_y,my_z));
+       Bz*=0.5; // crude average
+       sperp=(my_z-z0)/tanl_;
+     }
+     double twokappa=qBr2p*Bz*q_over_pt0*FactorForSenseOfRotation; 
+     double one_over_2k=1./twokappa;
+     if (my_fdchits.size()==0){
+       for (unsigned int i=my_cdchits.size()-1;i>1;i--){
+	 // Use outermost axial straw to estimate a resonable arc length
+	 if (my_cdchits[i]->hit->is_stereo==false){
+	   double tworc=2.*fabs(one_over_2k);
+	   double ratio=(my_cdchits[i]->hit->wire->origin
+			 -input_params.position()).Perp()/tworc;
+	   sperp=(ratio<1.)?tworc*asin(ratio):tworc*M_PI_2;
+	   if (sperp<25.) sperp=25.;
+	   break;
+	 }
+       }
+     }
+     double twoks=twokappa*sperp;
+     double cosphi=cos(phi0);
+     double sinphi=sin(phi0);
+     double sin2ks=sin(twoks);
+     double cos2ks=cos(twoks);
+     double one_minus_cos2ks=1.-cos2ks;
+     double myx=x0+one_over_2k*(cosphi*sin2ks-sinphi*one_minus_cos2ks);
+     double myy=y0+one_over_2k*(sinphi*sin2ks+cosphi*one_minus_cos2ks);
+     double mypx=px*cos2ks-py*sin2ks;
+     double mypy=py*cos2ks+px*sin2ks;
+     double myphi=atan2(mypy,mypx);
+     phi0=phi_=myphi;
+     px=mypx;
+     py=mypy;
+     x0=x_=myx;
+     y0=y_=myy;
+     z0+=tanl_*sperp;
+     z_=z0;     
+   }
+   
+   // Check integrity of input parameters
+   if (!isfinite(x0) || !isfinite(y0) || !isfinite(q_over_p0)){
+     if (DEBUG_LEVEL>0) _DBG_ << "Invalid input parameters!" <<endl;
+      return UNRECOVERABLE_ERROR;
+   }
+
+   // Initial direction tangents
+   double tx0=tx_=px/pz;
+   double ty0=ty_=py/pz;
+   double one_plus_tsquare=1.+tx_*tx_+ty_*ty_;
+
+   seed.theta_deg=theta_deg;
+   seed.x0=x0;
+   seed.y0=y0;
+   seed.z0=z0;
+   seed.tx0=tx0;
+   seed.ty0=ty0;
+   seed.q_over_p0=q_over_p0;
+   seed.q_over_pt0=q_over_pt0;
+   seed.phi0=phi0;
+   seed.tanl0=tanl0;
+   seed.dpt_over_pt=dpt_over_pt;
+   seed.sig_lambda=sig_lambda;
+   seed.dp_over_p_sq=dp_over_p_sq;
+   seed.one_plus_tsquare=one_plus_tsquare;
+
+   return NOERROR;
+}
+
+// Initial state vector and covariance matrix for the forward parametrization
+void DTrackFitterKalmanSIMD::InitForwardFit(const DKalmanSeed_t &seed,
+					    DMatrix5x1 &S0,DMatrix5x5 &C0){
+   double sig_lambda=seed.sig_lambda;
+   double dp_over_p_sq=seed.dp_over_p_sq;
+   double one_plus_tsquare=seed.one_plus_tsquare;
+
+   // Initial guess for the state vector
+   S0(state_x)=x_;
+   S0(state_y)=y_;
+   S0(state_tx)=tx_;
+   S0(state_ty)=ty_;
+   S0(state_q_over_p)=q_over_p_;
+
+   // Initial guess for forward representation covariance matrix   
+   C0(state_x,state_x)=2.0;
+   C0(state_y,state_y)=2.0;  
+   double temp=sig_lambda*one_plus_tsquare;
+   C0(state_tx,state_tx)=C0(state_ty,state_ty)=temp*temp;
+   C0(state_q_over_p,state_q_over_p)=dp_over_p_sq*q_over_p_*q_over_p_;
+   C0*=COVARIANCE_SCALE_FACTOR_FORWARD;
+
+   if (my_cdchits.size()>0){
+     mCDCInternalStepSize=0.25;
+   }
+
+   // The position from the track candidate is reported just outside the 
+   // start counter for tracks containing cdc hits. Propagate to the distance
+   // of closest approach to the beam line
+   if (fit_type==kWireBased) ExtrapolateToVertex(S0);
+}
+
 // Interface routine for Kalman filter
 jerror_t DTrackFitterKalmanSIMD::KalmanLoop(void){
    if (z_<Z_MIN) return VALUE_OUT_OF_RANGE;
@@ -5060,8 +5553,371 @@ kalman_error_t DTrackFitterKalmanSIMD::KalmanForward(double fdc_anneal_factor,
   return FIT_SUCCEEDED;
 }
 
-
-
+// Reset the hit flags and the chi2 sums at the start of a pass of the forward
+// Kalman filter and find the cuts for pruning hits
+void DTrackFitterKalmanSIMD::StartKalmanForward(DMatrix5x1 &S,DMatrix5x5 &C,
+						double &chisq,
+						unsigned int &numdof,
+						double &fdc_chi2cut,
+						double &cdc_chi2cut){
+  // Set used_in_fit flags to false for fdc and cdc hits
+  unsigned int num_cdc=cdc_used_in_fit.size();
+  unsigned int num_fdc=fdc_used_in_fit.size();
+  for (unsigned int i=0;i<num_cdc;i++) cdc_used_in_fit[i]=false;
+  for (unsigned int i=0;i<num_fdc;i++) fdc_used_in_fit[i]=false;
+  for (unsigned int i=0;i<forward_traj.size();i++){
+      if (forward_traj[i].h_id>999)
+	forward_traj[i].h_id=0;
+  }
+  
+  // Save the starting values for C and S in the deque
+  forward_traj[break_point_step_index].Skk=S;
+  forward_traj[break_point_step_index].Ckk=C;
+  
+  // Initialize chi squared
+  chisq=0;
+  
+  // Initialize number of degrees of freedom
+  numdof=0;
+
+  fdc_chi2cut=NUM_FDC_SIGMA_CUT*NUM_FDC_SIGMA_CUT;
+  cdc_chi2cut=NUM_CDC_SIGMA_CUT*NUM_CDC_SIGMA_CUT;
+  unsigned int num_fdc_hits=break_point_fdc_index+1;
+  unsigned int num_cdc_hits=my_cdchits.size(); 
+  if (num_fdc_hits+num_cdc_hits<MIN_HITS_FOR_REFIT){
+    cdc_chi2cut=BIG;
+    fdc_chi2cut=BIG;
+  }
+}
+
+// Add the FDC (or TRD/GEM) hit(s) at step k of the forward reference 
+// trajectory to the state vector and covariance matrix
+void DTrackFitterKalmanSIMD::AddForwardFDCHit(unsigned int k,
+					      double fdc_anneal_factor,
+					      double fdc_chi2cut,
+					      unsigned int &num_fdc_hits,
+					      DMatrix5x1 &S,DMatrix5x5 &C,
+					      double &chisq,
+					      unsigned int &numdof){
+  DMatrix2x1 Mdiff; // difference between measurement and prediction 
+  DMatrix2x5 H;  // Track projection matrix
+  DMatrix5x2 H_T; // Transpose of track projection matrix 
+  DMatrix5x2 K;  // Kalman gain matrix
+  DMatrix2x2 V(0.0833,0.,0.,FDC_CATHODE_VARIANCE);  // Measurement covariance matrix
+  DMatrix2x1 R;  // Filtered residual
+  DMatrix2x2 RC;  // Covariance of filtered residual
+  DMatrix2x2 InvV; // Inverse of error matrix
+
+  unsigned int id=forward_traj[k].h_id-1; 
+  // Check if this is a plane we want to skip in the fit (we still want
+  // to store track and hit info at this plane, however).
+  bool skip_plane=(my_fdchits[id]->hit!=NULL
+		   &&my_fdchits[id]->hit->wire->layer==PLANE_TO_SKIP);
+  double upred=0,vpred=0.,doca=0.,cosalpha=0.,lorentz_factor=0.;
+  FindDocaAndProjectionMatrix(my_fdchits[id],S,upred,vpred,doca,cosalpha,
+			      lorentz_factor,H_T);
+  // Matrix transpose H_T -> H
+  H=Transpose(H_T);
+
+  // Variance in coordinate transverse to wire
+  V(0,0)=my_fdchits[id]->uvar;
+  if (my_fdchits[id]->hit==NULL&&my_fdchits[id]->status!=trd_hit){
+    V(0,0)*=fdc_anneal_factor;
+  }
+
+  // Variance in coordinate along wire
+  V(1,1)=my_fdchits[id]->vvar*fdc_anneal_factor;
+
+  // Residual for coordinate along wire
+  Mdiff(1)=my_fdchits[id]->vstrip-vpred-doca*lorentz_factor;
+
+  // Residual for coordinate transverse to wire
+  Mdiff(0)=-doca;
+  double drift_time=my_fdchits[id]->t-mT0-forward_traj[k].t*TIME_UNIT_CONVERSION;
+  if (fit_type==kTimeBased && USE_FDC_DRIFT_TIMES){	
+    if (my_fdchits[id]->hit!=NULL){
+      double drift=(doca>0.0?1.:-1.)
+	*fdc_drift_distance(drift_time,forward_traj[k].B);
+      Mdiff(0)+=drift;
+
+      // Variance in drift distance
+      V(0,0)=fdc_drift_variance(drift_time)*fdc_anneal_factor;	
+    }
+    else if (USE_TRD_DRIFT_TIMES&&my_fdchits[id]->status==trd_hit){
+      double drift =(doca>0.0?1.:-1.)*0.1*pow(drift_time/8./0.91,1./1.556);
+      Mdiff(0)+=drift;
+
+      // Variance in drift distance
+      V(0,0)=0.05*0.05*fdc_anneal_factor;
+    }
+  }
+  // Check to see if we have multiple hits in the same plane
+  if (!ALIGNMENT_FORWARD && forward_traj[k].num_hits>1){
+    UpdateSandCMultiHit(forward_traj[k],upred,vpred,doca,cosalpha,
+			lorentz_factor,V,Mdiff,H,H_T,S,C,
+			fdc_chi2cut,skip_plane,chisq,numdof,
+			fdc_anneal_factor);
+  }
+  else{
+    if (DEBUG_LEVEL > 25) jout << " == There is a single FDC hit on this plane" << endl;
+
+    // Variance for this hit
+    DMatrix2x2 Vtemp=V+H*C*H_T;
+    InvV=Vtemp.Invert();
+
+    // Check if this hit is an outlier
+    double chi2_hit=Vtemp.Chi2(Mdiff);
+    if (chi2_hit<fdc_chi2cut){
+      // Compute Kalman gain matrix
+      K=C*H_T*InvV;
+
+      if (skip_plane==false){
+	// Update the state vector 
+	S+=K*Mdiff;
+
+	// Update state vector covariance matrix
+	//C=C-K*(H*C);    
+	C=C.SubSym(K*(H*C));
+
+	if (DEBUG_LEVEL > 25) {
+	  jout << "S Update: " << endl; S.Print();
+	  jout << "C Uodate: " << endl; C.Print();
+	}
+      }
+
+      // Store the "improved" values for the state vector and covariance
+      fdc_updates[id].S=S;
+      fdc_updates[id].C=C;
+      fdc_updates[id].tdrift=drift_time;
+      fdc_updates[id].tcorr=fdc_updates[id].tdrift; // temporary!
+      fdc_updates[id].doca=doca;
+      fdc_used_in_fit[id]=true;
+
+      if (skip_plane==false){  
+	// Filtered residual and covariance of filtered residual
+	R=Mdiff-H*K*Mdiff;   
+	RC=V-H*(C*H_T);
+
+	fdc_updates[id].V=RC;
+
+	// Update chi2 for this segment
+	chisq+=RC.Chi2(R);
+
+	// update number of degrees of freedom
+	numdof+=2;
+
+	if (DEBUG_LEVEL>20)
+	  {
+	    printf("hit %d p %5.2f t %f dm %5.2f sig %f chi2 %5.2f z %5.2f\n",
+		   id,1./S(state_q_over_p),fdc_updates[id].tdrift,Mdiff(1),
+		   sqrt(V(1,1)),RC.Chi2(R),
+		   forward_traj[k].z);
+
+	  }
+      }
+      else{
+	fdc_updates[id].V=V;
+      }
+
+      break_point_fdc_index=id;
+      break_point_step_index=k;
+    }
+  }
+  if (num_fdc_hits>=forward_traj[k].num_hits)
+    num_fdc_hits-=forward_traj[k].num_hits;
+}
+
+// Optional vertex point, ndof and break-point checks at the end of a pass of 
+// the forward Kalman filter
+kalman_error_t DTrackFitterKalmanSIMD::FinishKalmanForward(unsigned int max_num_fdc_used_in_fit,
+							   DMatrix5x1 &S,
+							   DMatrix5x5 &C,
+							   double &chisq,
+							   unsigned int &numdof){
+  DMatrix1x5 Hc;  // Track projection matrix for cdc hits
+  DMatrix5x1 Hc_T; // Transpose of track projection matrix for cdc hits
+  DMatrix5x5 J;  // State vector Jacobian matrix
+  DMatrix5x1 Kc;  // Kalman gain matrix for cdc hits
+  double Vc=0.0507;
+
+  unsigned int num_cdc=cdc_used_in_fit.size();
+  unsigned int num_fdc=fdc_used_in_fit.size();
+
+  // Save final z position
+  z_=forward_traj[forward_traj.size()-1].z;
+  
+  // The following code segment addes a fake point at a well-defined z position
+  // that would correspond to a thin foil target.  It should not be turned on
+  // for an extended target.
+  if (ADD_VERTEX_POINT){
+    double dz_to_target=TARGET_Z-z_;
+    double my_dz=mStepSizeZ*(dz_to_target>0?1.:-1.);
+    int num_steps=int(fabs(dz_to_target/my_dz));
+    
+    for (int k=0;k<num_steps;k++){
+      double newz=z_+my_dz;
+      // Step C along z
+      StepJacobian(z_,newz,S,0.,J);
+      C=J*C*J.Transpose();
+      //C=C.SandwichMultiply(J);
+      
+      // Step S along z
+      Step(z_,newz,0.,S);
+      
+      z_=newz;
+    }
+    
+    // Step C along z
+    StepJacobian(z_,TARGET_Z,S,0.,J);
+    C=J*C*J.Transpose();
+    //C=C.SandwichMultiply(J);
+    
+    // Step S along z
+    Step(z_,TARGET_Z,0.,S);
+    
+    z_=TARGET_Z;
+    
+    // predicted doca taking into account the orientation of the wire
+    double dy=S(state_y);
+    double dx=S(state_x);      
+    double d=sqrt(dx*dx+dy*dy);
+    
+    // Track projection
+    double one_over_d=1./d;
+    Hc_T(state_x)=dx*one_over_d; 
+    Hc(state_x)=Hc_T(state_x);
+    Hc_T(state_y)=dy*one_over_d;	  
+    Hc(state_y)=Hc_T(state_y);
+    
+    // Variance of target point
+    // Variance is for average beam spot size assuming triangular distribution
+    // out to 2.2 mm from the beam line.
+    //   sigma_r = 2.2 mm/ sqrt(18)
+    Vc=0.002689;
+    
+    // inverse variance including prediction
+    double InvV1=1./(Vc+Hc*(C*Hc_T));
+    //double InvV1=1./(Vc+C.SandwichMultiply(H_T));
+    if (InvV1<0.){
+      if (DEBUG_LEVEL>0)
+	_DBG_ << "Negative variance???" << endl;
+      return NEGATIVE_VARIANCE;
+    }
+    // Compute KalmanSIMD gain matrix
+    Kc=InvV1*(C*Hc_T);
+    
+    // Update the state vector with the target point
+    // "Measurement" is average of expected beam spot size
+    double res=0.1466666667-d;
+    S+=res*Kc;  
+    // Update state vector covariance matrix
+    //C=C-K*(H*C);    
+    C=C.SubSym(Kc*(Hc*C));
+    
+    // Update chi2 for this segment
+    chisq+=(1.-Hc*Kc)*res*res/Vc;
+    numdof++;
+  }
+  
+  // Check that there were enough hits to make this a valid fit
+  if (numdof<6){
+    chisq=-1.;
+    numdof=0;
+    
+    if (num_cdc==0){
+      unsigned int new_index=(3*num_fdc)/4;
+      break_point_fdc_index=(new_index>=MIN_HITS_FOR_REFIT)?new_index:(MIN_HITS_FOR_REFIT-1);
+    }
+    else{
+      unsigned int new_index=(3*num_fdc)/4;
+      if (new_index+num_cdc>=MIN_HITS_FOR_REFIT){
+	break_point_fdc_index=new_index;
+      }
+      else{
+	break_point_fdc_index=MIN_HITS_FOR_REFIT-num_cdc;
+      }
+    }
+    return PRUNED_TOO_MANY_HITS;
+  }
+  
+  //  chisq*=anneal_factor;
+  numdof-=5;
+  
+  // Final positions in x and y for this leg
+  x_=S(state_x);
+  y_=S(state_y);
+  
+  if (DEBUG_LEVEL>1){
+    cout << "Position after forward filter: " << x_ << ", " << y_ << ", " << z_ <<endl;
+    cout << "Momentum " << 1./S(state_q_over_p) <<endl;
+  }
+  
+  if (!S.IsFinite()) return FIT_FAILED;
+  
+  // Check if we have a kink in the track or threw away too many hits
+  if (num_cdc>0 && break_point_fdc_index>0 && break_point_cdc_index>2){ 
+    if (break_point_fdc_index+num_cdc<MIN_HITS_FOR_REFIT){
+      //_DBG_ << endl;
+      unsigned int new_index=(3*num_fdc)/4;
+      if (new_index+num_cdc>=MIN_HITS_FOR_REFIT){
+	break_point_fdc_index=new_index;
+      }
+      else{
+	break_point_fdc_index=MIN_HITS_FOR_REFIT-num_cdc;
+      }
+    }
+    return BREAK_POINT_FOUND;
+  }
+  if (num_cdc==0 && break_point_fdc_index>2){
+    //_DBG_ << endl;
+    if (break_point_fdc_index<num_fdc/2){
+      break_point_fdc_index=(3*num_fdc)/4;
+    }
+    if (break_point_fdc_index<MIN_HITS_FOR_REFIT-1){
+      break_point_fdc_index=MIN_HITS_FOR_REFIT-1;
+    }
+    return BREAK_POINT_FOUND;
+  }
+  if (num_cdc>5 && break_point_cdc_index>2){
+    //_DBG_ << endl;  
+    unsigned int new_index=3*(num_fdc)/4;
+    if (new_index+num_cdc>=MIN_HITS_FOR_REFIT){
+      break_point_fdc_index=new_index;
+    }
+    else{
+      break_point_fdc_index=MIN_HITS_FOR_REFIT-num_cdc;
+    }
+    return BREAK_POINT_FOUND;
+  }
+  unsigned int num_good=0; 
+  unsigned int num_hits=num_cdc+max_num_fdc_used_in_fit;
+  for (unsigned int j=0;j<num_cdc;j++){
+    if (cdc_used_in_fit[j]) num_good++;
+  }
+  for (unsigned int j=0;j<num_fdc;j++){
+    if (fdc_used_in_fit[j]) num_good++;
+  }
+  if (double(num_good)/double(num_hits)<MINIMUM_HIT_FRACTION){
+    //_DBG_ <<endl;
+    if (num_cdc==0){
+      unsigned int new_index=(3*num_fdc)/4;
+      break_point_fdc_index=(new_index>=MIN_HITS_FOR_REFIT)?new_index:(MIN_HITS_FOR_REFIT-1);
+    }
+    else{
+      unsigned int new_index=(3*num_fdc)/4;
+      if (new_index+num_cdc>=MIN_HITS_FOR_REFIT){
+            break_point_fdc_index=new_index;
+      }
+      else{
+	break_point_fdc_index=MIN_HITS_FOR_REFIT-num_cdc;
+      }
+    }
+    return PRUNED_TOO_MANY_HITS;
+  }
+  
+  return FIT_SUCCEEDED;
+}
+
 // Kalman engine for forward tracks -- this routine adds CDC hits
 kalman_error_t DTrackFitterKalmanSIMD::KalmanForwardCDC(double anneal,
 							DMatrix5x1 &S,
@@ -6048,9 +6904,7 @@ jerror_t DTrackFitterKalmanSIMD::ExtrapolateToVertex(DVector2 &xy,
 
 // Transform the 5x5 tracking error matrix into a 7x7 error matrix in cartesian
 // coordinates
-shared_ptr<TMatrixFSym> DTrackFitterKalmanSIMD::Get7x7ErrorMatrixForward(DMatrixDSym C){
-   auto C7x7 = dResourcePool_TMatrixFSym->Get_SharedResource();
-   C7x7->ResizeTo(7, 7);
+DMatrixFSym7 DTrackFitterKalmanSIMD::Get7x7ErrorMatrixForward(DMatrixDSym C){
    DMatrix J(7,5);
 
    double p=1./fabs(q_over_p_);
@@ -6077,18 +6931,14 @@ shared_ptr<TMatrixFSym> DTrackFitterKalmanSIMD::Get7x7ErrorMatrixForward(DMatrix
    J(state_Z,state_ty)=(2.*tx_*ty_*x_-y_*diff)*frac;
 
    // C'= JCJ^T
-   *C7x7=C.Similarity(J);
-
-   return C7x7;
+   return DMatrixFSym7(C.Similarity(J));
 }
 
 
 
 // Transform the 5x5 tracking error matrix into a 7x7 error matrix in cartesian
 // coordinates
-shared_ptr<TMatrixFSym> DTrackFitterKalmanSIMD::Get7x7ErrorMatrix(DMatrixDSym C){
-   auto C7x7 = dResourcePool_TMatrixFSym->Get_SharedResource();
-   C7x7->ResizeTo(7, 7);
+DMatrixFSym7 DTrackFitterKalmanSIMD::Get7x7ErrorMatrix(DMatrixDSym C){
    DMatrix J(7,5);
    //double cosl=cos(atan(tanl_));
    double pt=1./fabs(q_over_pt_);
@@ -6118,11 +6968,7 @@ shared_ptr<TMatrixFSym> DTrackFitterKalmanSIMD::Get7x7ErrorMatrix(DMatrixDSym C)
    J(state_Z,state_z)=1.;
 
    // C'= JCJ^T
-   *C7x7=C.Similarity(J);
-   // C7x7->Print();
-   //   _DBG_ << " " << C7x7->operator()(3,3) << " " << C7x7->operator()(4,4) << endl;
-
-   return C7x7;
+   return DMatrixFSym7(C.Similarity(J));
 }
 
 // Track recovery for Central tracks
@@ -6821,6 +7667,574 @@ kalman_error_t DTrackFitterKalmanSIMD::ForwardFit(const DMatrix5x1 &S0,const DMa
    return last_error;
 }
 
+// Initialize the state of the iterations of the forward fit
+void DTrackFitterKalmanSIMD::StartForwardFit(const DMatrix5x1 &S0,
+					     const DMatrix5x5 &C0,
+					     DKalmanForwardFit_t &fit){
+   // Vectors to keep track of the hits used in the last good iteration
+   fit.last_fdc_used_in_fit=vector<bool>(my_fdchits.size());
+   fit.last_cdc_used_in_fit=vector<bool>(my_cdchits.size());
+
+   // Covariance matrix and state vector
+   fit.S=S0;
+   fit.C0=C0;
+
+   // Create matrices to store results from previous iteration
+   fit.Slast=S0;
+   fit.Clast=C0;
+   // last z position
+   fit.last_z=z_;
+
+   fit.fdc_anneal=FORWARD_ANNEAL_SCALE+1.;  // variable for scaling cut for hit pruning
+   fit.cdc_anneal=ANNEAL_SCALE+1.;  // variable for scaling cut for hit pruning
+
+   // Chi-squared and degrees of freedom
+   fit.chisq=-1.;
+   fit.chisq_forward=-1.;
+   fit.my_ndf=0;
+   fit.last_ndf=1;
+   fit.error=FIT_NOT_DONE;
+   fit.last_error=FIT_NOT_DONE;
+   fit.iter=0;
+   fit.did_second_refit=false;
+}
+
+// Set up the reference trajectory for the current iteration of the forward 
+// fit, up to the call to KalmanForward
+DTrackFitterKalmanSIMD::forward_pass_t 
+DTrackFitterKalmanSIMD::StartForwardPass(DKalmanForwardFit_t &fit){
+   unsigned int num_cdchits=my_cdchits.size();
+   unsigned int max_fdc_index=my_fdchits.size()-1;
+   int iter=fit.iter;
+   DMatrix5x1 &S=fit.S;
+   double &fdc_anneal=fit.fdc_anneal;
+   double &cdc_anneal=fit.cdc_anneal;
+
+   // These variables provide the approximate location along the trajectory
+   // where there is an indication of a kink in the track      
+   break_point_fdc_index=max_fdc_index;
+   break_point_cdc_index=0;
+   break_point_step_index=0;
+
+   // Reset material map index
+   last_material_map=0;
+
+   // Abort if momentum is too low
+   if (fabs(S(state_q_over_p))>Q_OVER_P_MAX) return kForwardPassDone;
+
+   // Initialize path length variable and flight time
+   len=0;
+   ftime=0.;
+   var_ftime=0.;
+
+   // Scale cut for pruning hits according to the iteration number
+   fdc_anneal=(iter<MIN_ITER)?(FORWARD_ANNEAL_SCALE/pow(FORWARD_ANNEAL_POW_CONST,iter)+1.):1.;
+   cdc_anneal=(iter<MIN_ITER)?(ANNEAL_SCALE/pow(ANNEAL_POW_CONST,iter)+1.):1.;
+
+   // Swim through the field out to the most upstream FDC hit
+   jerror_t ref_track_error=SetReferenceTrajectory(S);
+   if (ref_track_error!=NOERROR){
+     if (iter==0) return kForwardPassAbort;  
+     return kForwardPassDone;
+   }
+
+   // Reset the status of the cdc hits 
+   for (unsigned int j=0;j<num_cdchits;j++){
+     if (my_cdchits[j]->status!=late_hit)my_cdchits[j]->status=good_hit;
+   }
+
+   fit.C=fit.C0;
+   fit.did_second_refit=false;
+
+   return kForwardPassContinue;
+}
+
+// Recovery of broken tracks and convergence test after KalmanForward for the
+// current iteration of the forward fit
+DTrackFitterKalmanSIMD::forward_pass_t 
+DTrackFitterKalmanSIMD::FinishForwardPass(DKalmanForwardFit_t &fit){
+   unsigned int num_cdchits=my_cdchits.size();
+   unsigned int num_fdchits=my_fdchits.size();
+   int iter=fit.iter;
+   DMatrix5x1 &S=fit.S;
+   DMatrix5x5 &C=fit.C;
+   const DMatrix5x5 &C0=fit.C0;
+   double &fdc_anneal=fit.fdc_anneal;
+   double &cdc_anneal=fit.cdc_anneal;
+   double &chisq=fit.chisq;
+   unsigned int &my_ndf=fit.my_ndf;
+   kalman_error_t &error=fit.error;
+   bool &did_second_refit=fit.did_second_refit;
+   double &chisq_forward=fit.chisq_forward;
+   unsigned int &last_ndf=fit.last_ndf;
+   kalman_error_t &last_error=fit.last_error;
+   DMatrix5x1 &Slast=fit.Slast;
+   DMatrix5x5 &Clast=fit.Clast;
+   double &last_z=fit.last_z;
+   vector<bool>&last_fdc_used_in_fit=fit.last_fdc_used_in_fit;
+   vector<bool>&last_cdc_used_in_fit=fit.last_cdc_used_in_fit;
+
+   if (DEBUG_LEVEL>1){
+     _DBG_ << "Iter: " << iter+1 << " Chi2=" << chisq << " Ndf=" << my_ndf << " Error code: " << error << endl; 
+   }
+   // Try to recover tracks that failed the first attempt at fitting by
+   // cutting outer hits
+   if (error!=FIT_SUCCEEDED && RECOVER_BROKEN_TRACKS
+       && num_fdchits>2  // some minimum to make this worthwhile...
+       && break_point_fdc_index<num_fdchits
+       && break_point_fdc_index+num_cdchits>=MIN_HITS_FOR_REFIT
+       && forward_traj.size()>2*MIN_HITS_FOR_REFIT // avoid small track stubs
+       ){
+     DMatrix5x5 Ctemp=C;
+     DMatrix5x1 Stemp=S;
+     unsigned int temp_ndf=my_ndf;
+     double temp_chi2=chisq;
+     double x=x_,y=y_,z=z_;
+
+     kalman_error_t refit_error=RecoverBrokenForwardTracks(fdc_anneal,
+							   cdc_anneal,
+							   S,C,C0,chisq,
+							   my_ndf);
+     if (fit_type==kTimeBased && refit_error!=FIT_SUCCEEDED){
+       fdc_anneal=1000.;
+       cdc_anneal=1000.;
+       refit_error=RecoverBrokenForwardTracks(fdc_anneal,
+					      cdc_anneal,
+					      S,C,C0,chisq,
+					      my_ndf);
+       //chisq=1e6;
+       did_second_refit=true;
+     }
+     if (refit_error!=FIT_SUCCEEDED){
+       if (error==PRUNED_TOO_MANY_HITS || error==BREAK_POINT_FOUND){
+	 C=Ctemp;
+	 S=Stemp;
+	 my_ndf=temp_ndf;
+	 chisq=temp_chi2;
+	 x_=x,y_=y,z_=z;
+
+	 if (num_cdchits<6) error=FIT_SUCCEEDED;
+       }
+       else error=FIT_FAILED;
+     }
+     else error=FIT_SUCCEEDED;
+   }
+   if ((error==POSITION_OUT_OF_RANGE || error==MOMENTUM_OUT_OF_RANGE)
+       && iter==0){ 
+     return kForwardPassAbort;
+   }
+   if (error==FIT_FAILED || error==INVALID_FIT  || my_ndf==0){
+     if (iter==0) return kForwardPassAbort; // first iteration failed
+     return kForwardPassDone;
+   }
+
+   if (iter>MIN_ITER && did_second_refit==false){
+     double new_reduced_chisq=chisq/my_ndf;
+     double old_reduced_chisq=chisq_forward/last_ndf;
+     double new_prob=TMath::Prob(chisq,my_ndf);
+     double old_prob=TMath::Prob(chisq_forward,last_ndf);
+     if (new_prob<old_prob
+	 || fabs(new_reduced_chisq-old_reduced_chisq)<CHISQ_DELTA){
+       return kForwardPassDone;
+     }
+   }
+
+   chisq_forward=chisq; 
+   last_ndf=my_ndf;
+   last_error=error;
+   Slast=S;
+   Clast=C;	 
+   last_z=z_;
+
+   last_fdc_used_in_fit=fdc_used_in_fit;
+   last_cdc_used_in_fit=cdc_used_in_fit;
+
+   return kForwardPassContinue;
+}
+
+// Smoothing, extrapolations and final track parameters at the end of the 
+// iterations of the forward fit
+kalman_error_t DTrackFitterKalmanSIMD::FinishForwardFit(DKalmanForwardFit_t &fit){
+   vector<pull_t>forward_pulls;
+   DMatrix5x1 &S=fit.S;
+   DMatrix5x5 &C=fit.C;
+   DMatrix5x1 &Slast=fit.Slast;
+   DMatrix5x5 &Clast=fit.Clast;
+   double fdc_anneal=fit.fdc_anneal;
+   double cdc_anneal=fit.cdc_anneal;
+   const vector<bool>&last_fdc_used_in_fit=fit.last_fdc_used_in_fit;
+   const vector<bool>&last_cdc_used_in_fit=fit.last_cdc_used_in_fit;
+   double chisq_forward=fit.chisq_forward;
+   unsigned int last_ndf=fit.last_ndf;
+   double last_z=fit.last_z;
+
+   IsSmoothed=false;
+   if(fit_type==kTimeBased){
+     forward_pulls.clear();
+     if (SmoothForward(forward_pulls) == NOERROR){
+       IsSmoothed = true;
+       pulls.assign(forward_pulls.begin(),forward_pulls.end());
+     }   
+   }
+
+   // total chisq and ndf
+   chisq_=chisq_forward;
+   ndf_=last_ndf;
+
+   // output lists of hits used in the fit and fill pull vector
+   cdchits_used_in_fit.clear();
+   for (unsigned int m=0;m<last_cdc_used_in_fit.size();m++){
+      if (last_cdc_used_in_fit[m]){
+         cdchits_used_in_fit.push_back(my_cdchits[m]->hit);
+      }
+   }
+   fdchits_used_in_fit.clear();
+   for (unsigned int m=0;m<last_fdc_used_in_fit.size();m++){
+      if (last_fdc_used_in_fit[m] && my_fdchits[m]->hit!=NULL){
+         fdchits_used_in_fit.push_back(my_fdchits[m]->hit);
+      }
+   }
+   // fill pull vector
+   //pulls.assign(last_forward_pulls.begin(),last_forward_pulls.end());
+
+   // fill vector of extrapolations
+   ClearExtrapolations();
+   if (forward_traj.size()>1){
+     ExtrapolateToInnerDetectors();
+     if (fit_type==kTimeBased){
+       double reverse_chisq=1e16,reverse_chisq_old=1e16;
+       unsigned int reverse_ndf=0,reverse_ndf_old=0;
+
+       // Run the Kalman filter in the reverse direction, to get the best guess
+       // for the state vector at the last FDC point on the track
+       DMatrix5x5 CReverse=C;
+       DMatrix5x1 SReverse=S,SDownstream,SBest;
+       kalman_error_t reverse_error=FIT_NOT_DONE;
+       for (int iter=0;iter<20;iter++){
+	 reverse_chisq_old=reverse_chisq;
+	 reverse_ndf_old=reverse_ndf;
+	 SBest=SDownstream;
+	 reverse_error=KalmanReverse(fdc_anneal,cdc_anneal,SReverse,CReverse,
+				     SDownstream,reverse_chisq,reverse_ndf);
+	 if (reverse_error!=FIT_SUCCEEDED) break;
+
+	 SReverse=SDownstream;
+	 for (unsigned int k=0;k<forward_traj.size()-1;k++){
+	   // Get dEdx for the upcoming step
+	   double dEdx=0.;
+	   if (CORRECT_FOR_ELOSS){
+	     dEdx=GetdEdx(SReverse(state_q_over_p),
+			  forward_traj[k].K_rho_Z_over_A,
+			  forward_traj[k].rho_Z_over_A,
+			  forward_traj[k].LnI,forward_traj[k].Z); 
+	   }
+	   // Step through field
+	   DMatrix5x5 J;
+	   double z=forward_traj[k].z;
+	   double newz=forward_traj[k+1].z;
+	   StepJacobian(z,newz,SReverse,dEdx,J);
+	   Step(z,newz,dEdx,SReverse);
+	   
+	   CReverse=forward_traj[k].Q.AddSym(J*CReverse*J.Transpose());
+	 }
+
+	 double reduced_chisq=reverse_chisq/double(reverse_ndf);
+	 double reduced_chisq_old=reverse_chisq_old/double(reverse_ndf_old);
+	 if (reduced_chisq>reduced_chisq_old
+	     || fabs(reduced_chisq-reduced_chisq_old)<0.01) break;
+       }
+
+       if (reverse_error!=FIT_SUCCEEDED){
+	 ExtrapolateToOuterDetectors(forward_traj[0].S);
+       }
+       else{
+	 ExtrapolateToOuterDetectors(SBest);
+       }
+     }
+     else{
+       ExtrapolateToOuterDetectors(forward_traj[0].S);
+     }
+     if (extrapolations.at(SYS_BCAL).size()==1){
+       // There needs to be some steps inside the the volume of the BCAL for 
+       // the extrapolation to be useful.  If this is not the case, clear 
+       // the extrolation vector.
+       extrapolations[SYS_BCAL].clear();
+     }
+   }
+   // Extrapolate to the point of closest approach to the beam line
+   z_=last_z;
+   DVector2 beam_pos=beam_center+(z_-beam_z0)*beam_dir;
+   double dx=Slast(state_x)-beam_pos.X();
+   double dy=Slast(state_y)-beam_pos.Y();
+   bool extrapolated=false;
+   if (sqrt(dx*dx+dy*dy)>EPS2){  
+      DMatrix5x5 Ctemp=Clast;
+      DMatrix5x1 Stemp=Slast; 
+      double ztemp=z_;
+      if (ExtrapolateToVertex(Stemp,Ctemp)==NOERROR){
+         Clast=Ctemp;
+         Slast=Stemp;
+	 extrapolated=true;
+      }
+      else{
+         //_DBG_ << endl;
+         z_=ztemp;
+      }
+   }
+
+   // Final momentum, positions and tangents
+   x_=Slast(state_x), y_=Slast(state_y);
+   tx_=Slast(state_tx),ty_=Slast(state_ty);
+   q_over_p_=Slast(state_q_over_p);
+
+   // Convert from forward rep. to central rep.
+   double tsquare=tx_*tx_+ty_*ty_;
+   tanl_=1./sqrt(tsquare);
+   double cosl=cos(atan(tanl_));
+   q_over_pt_=q_over_p_/cosl;
+   phi_=atan2(ty_,tx_);
+   if (FORWARD_PARMS_COV==false){
+     if (extrapolated){
+       beam_pos=beam_center+(z_-beam_z0)*beam_dir;
+       dx=x_-beam_pos.X();
+       dy=y_-beam_pos.Y();
+     }
+     D_=sqrt(dx*dx+dy*dy)+EPS;
+     x_ = dx; y_ = dy;
+     double cosphi=cos(phi_);
+     double sinphi=sin(phi_);     
+     if ((dx>0.0 && sinphi>0.0) || (dy<0.0 && cosphi>0.0) 
+	 || (dy>0.0 && cosphi<0.0) || (dx<0.0 && sinphi<0.0)) D_*=-1.; 
+     TransformCovariance(Clast);      
+   }
+   // Covariance matrix  
+   vector<double>dummy;
+   for (unsigned int i=0;i<5;i++){
+      dummy.clear();
+      for(unsigned int j=0;j<5;j++){
+         dummy.push_back(Clast(i,j));
+      }
+      fcov.push_back(dummy);
+   }
+
+   return fit.last_error;
+}
+
+// Fit the tracks set up in each of the fitters (hits, fit type and input 
+// parameters), e.g. several mass hypotheses of one track or several tracks of
+// an event.  Tracks with only FDC (TRD/GEM) hits are fit with the forward 
+// parametrization with the iterations of all of them interleaved; the steps 
+// through the reference trajectories in KalmanForward are done in lockstep 
+// with DKalmanSoA.  Only these propagation steps are vectorised: the hit 
+// updates, pruning and convergence tests stay per track, in scalar code.  All
+// other tracks are fit one at a time with FitTrack.
+void DTrackFitterKalmanSIMD::FitTracksLockstep(const vector<DTrackFitterKalmanSIMD*>&fitters,
+					       vector<fit_status_t>&status){
+  status.assign(fitters.size(),kFitNotDone);
+
+  // deque so that the pointers to the lanes stay valid
+  deque<DKalmanLockstepLane_t>lanes;
+  for (unsigned int i=0;i<fitters.size();i++){
+    DTrackFitterKalmanSIMD *fitter=fitters[i];
+    
+    // Derived classes may replace the forward filter
+    if (typeid(*fitter)!=typeid(DTrackFitterKalmanSIMD)){
+      status[i]=fitter->FitTrack();
+      continue;
+    }
+    if (fitter->PrepareFit()==false) continue;
+    if (fitter->my_cdchits.size()>0){
+      status[i]=fitter->FinishFit(fitter->KalmanLoop());
+      continue;
+    }
+    DKalmanSeed_t seed;
+    jerror_t error=fitter->SetKalmanSeed(seed);
+    if (error!=NOERROR){
+      status[i]=fitter->FinishFit(error);
+      continue;
+    }
+    if (fitter->my_fdchits.size()==0 || !isfinite(seed.tx0) 
+	|| !isfinite(seed.ty0)){
+      // KalmanLoop has nothing to fit for this track
+      status[i]=fitter->FinishFit(fitter->ndf_==0?UNRECOVERABLE_ERROR:NOERROR);
+      continue;
+    }
+    if (fitter->DEBUG_LEVEL>0){
+      _DBG_ << "Using forward parameterization." <<endl;
+    }
+    
+    lanes.push_back(DKalmanLockstepLane_t());
+    DKalmanLockstepLane_t &lane=lanes.back();
+    lane.fitter=fitter;
+    lane.index=i;
+    lane.done=false;
+    lane.filtering=false;
+
+    DMatrix5x1 S0;
+    DMatrix5x5 C0;
+    fitter->InitForwardFit(seed,S0,C0);
+    fitter->StartForwardFit(S0,C0,lane.fit);
+  }
+
+  // Iterate over reference trajectories
+  vector<DKalmanLockstepLane_t *>passes;
+  do {
+    passes.clear();
+    for (unsigned int i=0;i<lanes.size();i++){
+      DKalmanLockstepLane_t &lane=lanes[i];
+      if (lane.done) continue;
+      DTrackFitterKalmanSIMD *fitter=lane.fitter;
+
+      forward_pass_t pass=kForwardPassDone;
+      if (lane.fit.iter<(fitter->fit_type==kTimeBased?MAX_TB_PASSES:MAX_WB_PASSES)){
+	pass=fitter->StartForwardPass(lane.fit);
+      }
+      if (pass==kForwardPassContinue){
+	passes.push_back(&lane);
+      }
+      else{
+	status[lane.index]=fitter->FinishLockstepFit(lane.fit,pass);
+	lane.done=true;
+      }
+    }
+
+    // perform the kalman filter 
+    KalmanForwardLockstep(passes);
+
+    for (unsigned int i=0;i<passes.size();i++){
+      DKalmanLockstepLane_t &lane=*passes[i];
+      forward_pass_t pass=lane.fitter->FinishForwardPass(lane.fit);
+      if (pass==kForwardPassContinue){
+	lane.fit.iter++;
+      }
+      else{
+	status[lane.index]=lane.fitter->FinishLockstepFit(lane.fit,pass);
+	lane.done=true;
+      }
+    }
+  } while (passes.size()>0);
+}
+
+// Same as KalmanForward for FDC-only tracks, for up to DKalmanSoA::kLanes 
+// tracks at a time.  Each track has its own reference trajectory, so the 
+// tracks step independently and are dropped from the SoA state as they finish
+void DTrackFitterKalmanSIMD::KalmanForwardLockstep(const vector<DKalmanLockstepLane_t *>&lanes){
+  for (unsigned int first=0;first<lanes.size();first+=DKalmanSoA::kLanes){
+    unsigned int num_lanes=lanes.size()-first;
+    if (num_lanes>DKalmanSoA::kLanes) num_lanes=DKalmanSoA::kLanes;
+    DKalmanSoA soa;
+
+    for (unsigned int l=0;l<num_lanes;l++){
+      DKalmanLockstepLane_t &lane=*lanes[first+l];
+      DTrackFitterKalmanSIMD *fitter=lane.fitter;
+      DKalmanForwardFit_t &fit=lane.fit;
+
+      double cdc_chi2cut=0.;
+      fitter->StartKalmanForward(fit.S,fit.C,fit.chisq,fit.my_ndf,
+				 lane.fdc_chi2cut,cdc_chi2cut);
+      lane.num_fdc_hits=fitter->break_point_fdc_index+1;
+      lane.max_num_fdc_used_in_fit=lane.num_fdc_hits;
+      lane.k=fitter->break_point_step_index+1;
+      lane.S0_=fitter->forward_traj[fitter->break_point_step_index].S;
+      lane.filtering=true;
+    }
+
+    bool stepping=true;
+    while (stepping){
+      // Load the next step of each track still being filtered
+      stepping=false;
+      for (unsigned int l=0;l<num_lanes;l++){
+	DKalmanLockstepLane_t &lane=*lanes[first+l];
+	if (lane.filtering==false) continue;
+	DTrackFitterKalmanSIMD *fitter=lane.fitter;
+	DKalmanForwardFit_t &fit=lane.fit;
+
+	if (lane.k>=fitter->forward_traj.size()){
+	  fit.error=fitter->FinishKalmanForward(lane.max_num_fdc_used_in_fit,
+						fit.S,fit.C,fit.chisq,
+						fit.my_ndf);
+	  lane.filtering=false;
+	  soa.ClearLane(l);
+	  continue;
+	}
+	// Check that C matrix is positive definite
+	if (!fit.C.IsPosDef()){
+	  if (fitter->DEBUG_LEVEL>0) _DBG_ << "Broken covariance matrix!" <<endl;
+	  fit.error=BROKEN_COVARIANCE_MATRIX;
+	  lane.filtering=false;
+	  soa.ClearLane(l);
+	  continue;
+	}
+	const DKalmanForwardTrajectory_t &traj=fitter->forward_traj[lane.k];
+	soa.SetLane(l,fit.S,fit.C);
+	soa.SetStep(l,traj.S,lane.S0_,traj.J,traj.Q);
+	stepping=true;
+      }
+      if (stepping==false) break;
+
+      // Update the actual state vectors and covariance matrices
+      soa.Propagate();
+
+      for (unsigned int l=0;l<num_lanes;l++){
+	DKalmanLockstepLane_t &lane=*lanes[first+l];
+	if (lane.filtering==false) continue;
+	DTrackFitterKalmanSIMD *fitter=lane.fitter;
+	DKalmanForwardFit_t &fit=lane.fit;
+	
+	DMatrix5x1 S;
+	DMatrix5x5 C;
+	soa.GetLane(l,S,C);
+	fit.S=S;
+
+	// Bail if the momentum has dropped below some minimum
+	if (fabs(S(state_q_over_p))>=fitter->Q_OVER_P_MAX){
+	  if (fitter->DEBUG_LEVEL>2)
+	    {
+	      _DBG_ << "Bailing: P = " << 1./fabs(S(state_q_over_p)) << endl;
+	    }
+	  fitter->break_point_fdc_index=(3*fitter->fdc_used_in_fit.size())/4;
+	  fit.error=MOMENTUM_OUT_OF_RANGE;
+	  lane.filtering=false;
+	  soa.ClearLane(l);
+	  continue;
+	}
+	fit.C=C;
+
+	// Save the current state and covariance matrix in the deque
+	DKalmanForwardTrajectory_t &traj=fitter->forward_traj[lane.k];
+	traj.Skk=S;
+	traj.Ckk=C;
+
+	// Save the current state of the reference trajectory
+	lane.S0_=traj.S;
+
+	// Add the hit
+	if (lane.num_fdc_hits>0 && traj.h_id>0 && traj.h_id<1000){
+	  fitter->AddForwardFDCHit(lane.k,fit.fdc_anneal,lane.fdc_chi2cut,
+				   lane.num_fdc_hits,fit.S,fit.C,fit.chisq,
+				   fit.my_ndf);
+	}
+	lane.k++;
+      }
+    }
+  }
+}
+
+// Finish a forward fit from FitTracksLockstep the same way as FitTrack for a
+// track without CDC hits
+DTrackFitter::fit_status_t 
+DTrackFitterKalmanSIMD::FinishLockstepFit(DKalmanForwardFit_t &fit,
+					  forward_pass_t pass){
+  kalman_error_t error=FIT_FAILED;
+  if (pass!=kForwardPassAbort) error=FinishForwardFit(fit);
+
+  jerror_t loop_error=NOERROR;
+  if (error!=FIT_SUCCEEDED && (error==FIT_FAILED || ndf_==0)){
+    loop_error=UNRECOVERABLE_ERROR;
+  }
+  return FinishFit(loop_error);
+}
+
 // Routine to fit hits in the CDC using the forward parametrization
 kalman_error_t DTrackFitterKalmanSIMD::ForwardCDCFit(const DMatrix5x1 &S0,const DMatrix5x5 &C0){   
    unsigned int num_cdchits=my_cdchits.size();
@@ -19,6 +19,7 @@
 #include <TH2.h>
 #include <TH1I.h>
 #include <TMatrixFSym.h>
+#include <DMatrixFSym7.h>
 #include "DResourcePool.h"
 
 #ifndef M_TWO_PI
@@ -137,6 +138,43 @@ typedef struct{
   bool used_in_fit;
 }DKalmanUpdate_t;
 
+// Starting values for the track parameters and their errors
+typedef struct{
+  double x0,y0,z0,tx0,ty0;
+  double q_over_p0,q_over_pt0,phi0,tanl0;
+  double theta_deg,dpt_over_pt,sig_lambda,dp_over_p_sq,one_plus_tsquare;
+}DKalmanSeed_t;
+
+// State carried between the iterations of the forward fit
+typedef struct{
+  DMatrix5x5 C,C0,Clast;
+  DMatrix5x1 S,Slast;
+  double last_z;
+  double fdc_anneal,cdc_anneal;
+  double chisq,chisq_forward;
+  unsigned int my_ndf,last_ndf;
+  kalman_error_t error,last_error;
+  vector<bool>last_fdc_used_in_fit,last_cdc_used_in_fit;
+  int iter;
+  bool did_second_refit;
+}DKalmanForwardFit_t;
+
+class DTrackFitterKalmanSIMD;
+
+// One track in DTrackFitterKalmanSIMD::FitTracksLockstep
+typedef struct{
+  DTrackFitterKalmanSIMD *fitter;
+  unsigned int index;
+  bool done;
+  DKalmanForwardFit_t fit;
+  // Current pass of the forward filter
+  bool filtering;
+  unsigned int k;
+  DMatrix5x1 S0_;
+  double fdc_chi2cut;
+  unsigned int num_fdc_hits,max_num_fdc_used_in_fit;
+}DKalmanLockstepLane_t;
+
 
 class DTrackFitterKalmanSIMD: public DTrackFitter{
  public:
@@ -182,6 +220,12 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
   // Virtual methods from TrackFitter base class
   string Name(void) const {return string("KalmanSIMD");}
   fit_status_t FitTrack(void);
+
+  // Fit the tracks set up in several fitters (hits and input parameters) 
+  // together, propagating the forward tracks in lockstep (see DKalmanSoA.h).
+  // Only the propagation is vectorised; the hit updates are per track.
+  static void FitTracksLockstep(const vector<DTrackFitterKalmanSIMD*>&fitters,
+				vector<fit_status_t>&status);
   double ChiSq(fit_type_t fit_type, DReferenceTrajectory *rt, double *chisq_ptr=NULL, int *dof_ptr=NULL, vector<pull_t> *pulls_ptr=NULL);
 
   unsigned int GetRatioMeasuredPotentialFDCHits(void) const {return my_fdchits.size()/potential_fdc_hits_on_track;}
@@ -391,8 +435,42 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
 			    double &var_t_factor,
 			    DMatrix5x1 &Sc,bool &stepped_to_boundary);
 
-  shared_ptr<TMatrixFSym> Get7x7ErrorMatrix(DMatrixDSym C);
-  shared_ptr<TMatrixFSym> Get7x7ErrorMatrixForward(DMatrixDSym C);
+  DMatrixFSym7 Get7x7ErrorMatrix(DMatrixDSym C);
+  DMatrixFSym7 Get7x7ErrorMatrixForward(DMatrixDSym C);
+
+  // Stages of FitTrack, KalmanLoop, ForwardFit and KalmanForward for the
+  // FDC-only tracks of FitTracksLockstep. These are copies of the code of
+  // those routines, which do not use them, so that the fits of a single
+  // track are not changed by the lockstep fits: keep the two in step.
+  bool PrepareFit(void);
+  fit_status_t FinishFit(jerror_t error);
+  jerror_t SetKalmanSeed(DKalmanSeed_t &seed);
+  void InitForwardFit(const DKalmanSeed_t &seed,DMatrix5x1 &S0,DMatrix5x5 &C0);
+
+  enum forward_pass_t{
+    kForwardPassContinue,
+    kForwardPassDone,
+    kForwardPassAbort,
+  };
+  void StartForwardFit(const DMatrix5x1 &S0,const DMatrix5x5 &C0,
+		       DKalmanForwardFit_t &fit);
+  forward_pass_t StartForwardPass(DKalmanForwardFit_t &fit);
+  forward_pass_t FinishForwardPass(DKalmanForwardFit_t &fit);
+  kalman_error_t FinishForwardFit(DKalmanForwardFit_t &fit);
+  void StartKalmanForward(DMatrix5x1 &S,DMatrix5x5 &C,double &chisq,
+			  unsigned int &numdof,double &fdc_chi2cut,
+			  double &cdc_chi2cut);
+  void AddForwardFDCHit(unsigned int k,double fdc_anneal_factor,
+			double fdc_chi2cut,unsigned int &num_fdc_hits,
+			DMatrix5x1 &S,DMatrix5x5 &C,double &chisq,
+			unsigned int &numdof);
+  kalman_error_t FinishKalmanForward(unsigned int max_num_fdc_used_in_fit,
+				     DMatrix5x1 &S,DMatrix5x5 &C,
+				     double &chisq,unsigned int &numdof);
+
+  // Lockstep forward fits
+  static void KalmanForwardLockstep(const vector<DKalmanLockstepLane_t *>&lanes);
+  fit_status_t FinishLockstepFit(DKalmanForwardFit_t &fit,forward_pass_t pass);
 
   kalman_error_t ForwardFit(const DMatrix5x1 &S,const DMatrix5x5 &C0); 
   kalman_error_t ForwardCDCFit(const DMatrix5x1 &S,const DMatrix5x5 &C0);  
@@ -2068,10 +2068,8 @@ DTrackFitterStraightTrack::Smooth(vector<fdc_update_t>&fdc_updates,
   return NOERROR;
 }
 
-shared_ptr<TMatrixFSym> 
+DMatrixFSym7 
 DTrackFitterStraightTrack::Get7x7ErrorMatrix(TMatrixFSym C,DMatrix4x1 &S,double sign){
-  auto C7x7 = dResourcePool_TMatrixFSym->Get_SharedResource();
-  C7x7->ResizeTo(7, 7);
   DMatrix J(7,5);
 
   double p=5.; // fixed: cannot measure
@@ -2102,9 +2100,7 @@ DTrackFitterStraightTrack::Get7x7ErrorMatrix(TMatrixFSym C,DMatrix4x1 &S,double
   J(state_Z,state_ty)=(2.*tx_*ty_*x_-y_*diff)*frac;
   
   // C'= JCJ^T
-  *C7x7=C.Similarity(J);
-  
-  return C7x7;
+  return DMatrixFSym7(C.Similarity(J));
 }
 
 // Routine to get extrapolations to other detectors
@@ -17,6 +17,7 @@
 #include <DMatrixSIMD.h>
 #include <deque>
 #include <TMatrixFSym.h>
+#include <DMatrixFSym7.h>
 #include "DResourcePool.h"
 #include <TRACKING/DTrackFinder.h>
 
@@ -100,8 +101,8 @@ public:
 			int &ndof);
   jerror_t Smooth(vector<fdc_update_t>&fdc_updates,
 		  vector<cdc_update_t>&cdc_updates); 
-  shared_ptr<TMatrixFSym> Get7x7ErrorMatrix(TMatrixFSym C,
-					    DMatrix4x1 &S,double sign);
+  DMatrixFSym7 Get7x7ErrorMatrix(TMatrixFSym C,
+			       DMatrix4x1 &S,double sign);
   void GetExtrapolations(const DVector3 &pos0,const DVector3 &dir);
 	
  private:
@@ -79,8 +79,10 @@ DTrackHitSelectorALT2::DTrackHitSelectorALT2(jana::JEventLoop *loop, int32_t run
 	MIN_FDC_SIGMA_ANODE_WIREBASED = 0.0100;
 	MIN_FDC_SIGMA_CATHODE_WIREBASED = 0.0100;
 	MAX_DOCA=2.5;
+	USE_HIT_INDEX=true;
 
 	gPARMS->SetDefaultParameter("TRKFIT:MAX_DOCA",MAX_DOCA,"Maximum doca for associating hit with track");
+	gPARMS->SetDefaultParameter("TRKFIT:USE_HIT_INDEX",USE_HIT_INDEX,"Use the ring/phi (CDC) and plane (FDC) hit indexes to skip hits far from the extrapolations (the selected hits are the same either way)");
 
 	gPARMS->SetDefaultParameter("TRKFIT:HS_DEBUG_LEVEL", HS_DEBUG_LEVEL, "Debug verbosity level for hit selector used in track fitting (0=no debug messages)");
 	gPARMS->SetDefaultParameter("TRKFIT:MAKE_DEBUG_TREES", MAKE_DEBUG_TREES, "Create a TTree with debugging info on hit selection for the FDC and CDC");
@@ -263,10 +265,16 @@ void DTrackHitSelectorALT2::GetCDCHits(double Bz,double q,
   double var_x0=0.0,var_y0=0.0;
   double var_k=0.;
 
+  // Flag the hits that can be close enough to the extrapolations to pass
+  // the d2<4 test below; the others are skipped.
+  vector<bool> is_candidate;
+  if (USE_HIT_INDEX) FindCDCCandidates(extrapolations,cdchits_in_sorted,is_candidate);
+
   // Loop over all the CDC hits looking for matches with the track
   bool outermost_hit=true;
   vector<const DCDCTrackHit*>::const_reverse_iterator iter;
   for(iter=cdchits_in_sorted.rbegin(); iter!=cdchits_in_sorted.rend(); iter++){
+    if (USE_HIT_INDEX && !is_candidate[iter.base()-cdchits_in_sorted.begin()-1]) continue;
     const DCDCTrackHit *hit = *iter;
     DVector3 origin=hit->wire->origin;
     DVector3 dir=hit->wire->udir;
@@ -976,13 +984,22 @@ void DTrackHitSelectorALT2::GetFDCHits(double Bz,double q,
   double var_x0=0.0,var_y0=0.0; 
   double var_z0=2.*tanl2*(var_tot)*double(2*N-1)/double(N*(N+1));
 
+  // For each plane, the extrapolation points (last to first) that can be
+  // within 0.5 cm in z of the hits in it
+  vector<unsigned int> plane_of_hit;
+  vector<vector<int> > extrapolations_in_plane;
+  FindFDCCandidates(extrapolations,fdchits_in_sorted,plane_of_hit,
+		    extrapolations_in_plane);
+
   // Loop over hits
   bool most_downstream_hit=true;
-  int last_extrapolation_index=extrapolations.size()-1;
   vector<const DFDCPseudo*>::const_reverse_iterator iter;
   for(iter=fdchits_in_sorted.rbegin(); iter!=fdchits_in_sorted.rend(); iter++){
     const DFDCPseudo *hit = *iter;
-    for (int k=last_extrapolation_index;k>=0;k--){
+    const vector<int> &klist
+      =extrapolations_in_plane[plane_of_hit[iter.base()-fdchits_in_sorted.begin()-1]];
+    for (unsigned int ik=0;ik<klist.size();ik++){
+      int k=klist[ik];
       // Position along trajectory
       DVector3 pos=extrapolations[k].position;
       double dz=pos.z()-z0;
@@ -1170,3 +1187,134 @@ void DTrackHitSelectorALT2::GetFDCHits(double Bz,double q,
     old_layer=fdchits_tmp[i].second->wire->layer;
   }
 }
+
+//---------------------------------
+// FindCDCCandidates
+//---------------------------------
+void DTrackHitSelectorALT2::FindCDCCandidates(const vector<DTrackFitter::Extrapolation_t> &extrapolations, const vector<const DCDCTrackHit*> &cdchits_sorted, vector<bool> &is_candidate) const
+{
+  /// Flag the hits for which some extrapolation point is less than 2 cm 
+  /// (in x and y) from the wire at the z of that point, the necessary 
+  /// condition for the hit to be used in GetCDCHits above. The wire 
+  /// position at z is within |z-z0|*max_slope of the wire origin, so it is 
+  /// enough to look at the wires whose origin is within 
+  /// 2+|z-z0|*max_slope of the point, and these are found by ring and phi.
+  const double CDC_INDEX_DMAX=2.0+0.01; // includes a margin for rounding
+
+  unsigned int num_hits=cdchits_sorted.size();
+  is_candidate.assign(num_hits,false);
+
+  // Rebuild the index if the hit wires have changed
+  bool same_wires=(cdc_index_wires.size()==num_hits);
+  for (unsigned int i=0;same_wires && i<num_hits;i++){
+    same_wires=(cdc_index_wires[i]==cdchits_sorted[i]->wire);
+  }
+  if (!same_wires){
+    cdc_index_wires.resize(num_hits);
+    cdc_index.clear();
+    int old_ring=-1;
+    for (unsigned int i=0;i<num_hits;i++){
+      const DCDCWire *wire=cdchits_sorted[i]->wire;
+      cdc_index_wires[i]=wire;
+      double r=wire->origin.Perp();
+      double z=wire->origin.z();
+      double slope=wire->udir.Perp()/fabs(wire->udir.z());
+      if (wire->ring!=old_ring){
+	// The hits are sorted by ring
+	cdc_index.push_back(cdc_ring_index_t());
+	cdc_ring_index_t &ring=cdc_index.back();
+	ring.rmin=ring.rmax=r;
+	ring.zmin=ring.zmax=z;
+	ring.max_slope=slope;
+	old_ring=wire->ring;
+      }
+      cdc_ring_index_t &ring=cdc_index.back();
+      if (r<ring.rmin) ring.rmin=r;
+      if (r>ring.rmax) ring.rmax=r;
+      if (z<ring.zmin) ring.zmin=z;
+      if (z>ring.zmax) ring.zmax=z;
+      if (slope>ring.max_slope) ring.max_slope=slope;
+      ring.phi_index.push_back(make_pair(wire->origin.Phi(),i));
+    }
+    for (unsigned int j=0;j<cdc_index.size();j++){
+      sort(cdc_index[j].phi_index.begin(),cdc_index[j].phi_index.end());
+    }
+  }
+
+  for (unsigned int i=0;i<extrapolations.size();i++){
+    const DVector3 &pos=extrapolations[i].position;
+    double r=pos.Perp();
+    double z=pos.z();
+    // No hit can be accepted at a point that is not finite
+    if (!isfinite(r) || !isfinite(z)) continue;
+    double phi=pos.Phi();
+    for (unsigned int j=0;j<cdc_index.size();j++){
+      const cdc_ring_index_t &ring=cdc_index[j];
+      double dz=max(fabs(z-ring.zmin),fabs(z-ring.zmax));
+      double D=CDC_INDEX_DMAX+dz*ring.max_slope;
+      if (r+D<ring.rmin || r-D>ring.rmax) continue;
+
+      const vector<pair<double,unsigned int> > &phi_index=ring.phi_index;
+      if (D>=ring.rmin){
+	for (unsigned int k=0;k<phi_index.size();k++){
+	  is_candidate[phi_index[k].second]=true;
+	}
+	continue;
+      }
+      // Window in phi seen from the beam line, with wrap-around at +/-pi
+      double dphi=asin(D/ring.rmin)+EPS;
+      double phimin=phi-dphi;
+      double phimax=phi+dphi;
+      double ranges[3][2]={{phimin,phimax},{phimin+2.*M_PI,phimax+2.*M_PI},
+			   {phimin-2.*M_PI,phimax-2.*M_PI}};
+      for (unsigned int m=0;m<3;m++){
+	vector<pair<double,unsigned int> >::const_iterator it
+	  =lower_bound(phi_index.begin(),phi_index.end(),
+		       make_pair(ranges[m][0],0u));
+	for (;it!=phi_index.end() && it->first<=ranges[m][1];it++){
+	  is_candidate[it->second]=true;
+	}
+      }
+    }
+  }
+}
+
+//---------------------------------
+// FindFDCCandidates
+//---------------------------------
+void DTrackHitSelectorALT2::FindFDCCandidates(const vector<DTrackFitter::Extrapolation_t> &extrapolations, const vector<const DFDCPseudo*> &fdchits_sorted, vector<unsigned int> &plane_of_hit, vector<vector<int> > &extrapolations_in_plane) const
+{
+  /// Group the (sorted) hits by plane and list for each plane the 
+  /// extrapolation points, last to first, that can pass the 
+  /// |z-z_wire|<0.5 test in GetFDCHits above, so that the hits are not
+  /// tested against the whole trajectory. The FDC selection has no cut on
+  /// the distance to the wire, so the hits are not indexed by wire.
+  plane_of_hit.resize(fdchits_sorted.size());
+  extrapolations_in_plane.clear();
+  vector<pair<double,double> > plane_z;
+  int old_layer=-1;
+  for (unsigned int i=0;i<fdchits_sorted.size();i++){
+    const DFDCWire *wire=fdchits_sorted[i]->wire;
+    double z=wire->origin.z();
+    if (wire->layer!=old_layer){
+      // The hits are sorted by layer
+      plane_z.push_back(make_pair(z,z));
+      old_layer=wire->layer;
+    }
+    pair<double,double> &zrange=plane_z.back();
+    if (z<zrange.first) zrange.first=z;
+    if (z>zrange.second) zrange.second=z;
+    plane_of_hit[i]=plane_z.size()-1;
+  }
+  extrapolations_in_plane.resize(plane_z.size());
+
+  for (int k=extrapolations.size()-1;k>=0;k--){
+    double z=extrapolations[k].position.z();
+    for (unsigned int j=0;j<plane_z.size();j++){
+      // Passes for every plane if the index is disabled, never for z=nan
+      if (!USE_HIT_INDEX || (z-plane_z[j].second<0.5 && plane_z[j].first-z<0.5)){
+	extrapolations_in_plane[j].push_back(k);
+      }
+    }
+  }
+}
@@ -29,6 +29,9 @@ class DTrackHitSelectorALT2:public DTrackHitSelector{
 	void GetTRDHits(const vector<DTrackFitter::Extrapolation_t> &extrapolations, const vector<const DTRDPoint*> &trdhits_in, vector<const DTRDPoint*> &trdhits_out) const;
 
 	private:
+		void FindCDCCandidates(const vector<DTrackFitter::Extrapolation_t> &extrapolations, const vector<const DCDCTrackHit*> &cdchits_sorted, vector<bool> &is_candidate) const;
+		void FindFDCCandidates(const vector<DTrackFitter::Extrapolation_t> &extrapolations, const vector<const DFDCPseudo*> &fdchits_sorted, vector<unsigned int> &plane_of_hit, vector<vector<int> > &extrapolations_in_plane) const;
+
 		const DMagneticFieldMap *bfield;
 
 		int HS_DEBUG_LEVEL;
@@ -42,6 +45,20 @@ class DTrackHitSelectorALT2:public DTrackHitSelector{
 		double MIN_FDC_SIGMA_ANODE_WIREBASED;
 		double MIN_FDC_SIGMA_CATHODE_WIREBASED;
 		double MAX_DOCA;
+		bool USE_HIT_INDEX;
+
+		// Index of the CDC hits by ring and phi of the wire, used to skip
+		// hits that cannot be within 2 cm of any extrapolation point.
+		// It depends only on the wires, so it is kept from one call to the
+		// next while the (sorted) list of hit wires stays the same.
+		typedef struct{
+		  double rmin,rmax; // radial range of the wire origins
+		  double zmin,zmax; // z range of the wire origins
+		  double max_slope; // largest transverse displacement of a wire per unit z
+		  vector<pair<double,unsigned int> > phi_index; // (phi of wire origin, position in sorted hit list), sorted by phi
+		}cdc_ring_index_t;
+		mutable vector<const DCDCWire*> cdc_index_wires;
+		mutable vector<cdc_ring_index_t> cdc_index;
 		
 		TTree *cdchitsel;
 		TTree *fdchitsel;
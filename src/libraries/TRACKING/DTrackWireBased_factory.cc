@@ -11,11 +11,13 @@
 #include <set>
 #include <cmath>
 #include <mutex>
+#include <typeinfo>
 using namespace std;
 
 #include "DTrackWireBased_factory.h"
 #include <TRACKING/DTrackCandidate.h>
 #include <TRACKING/DReferenceTrajectory.h>
+#include <TRACKING/DTrackFitterKalmanSIMD.h>
 #include <CDC/DCDCTrackHit.h>
 #include <FDC/DFDCPseudo.h>
 #include <SplitString.h>
@@ -89,6 +91,7 @@ bool DTrackWireBased_cmp(DTrackWireBased *a,DTrackWireBased *b){
 jerror_t DTrackWireBased_factory::init(void)
 {
    fitter = NULL;
+   rt = NULL;
 
    //DEBUG_HISTS = true;	
    DEBUG_HISTS = false;
@@ -216,6 +219,29 @@ jerror_t DTrackWireBased_factory::brun(jana::JEventLoop *loop, int32_t runnumber
    MIN_FIT_P = 0.050; // GeV
    gPARMS->SetDefaultParameter("TRKFIT:MIN_FIT_P", MIN_FIT_P, "Minimum fit momentum in GeV/c for fit to be considered successful");
 
+   LOCKSTEP_HYPOTHESES=false;
+   gPARMS->SetDefaultParameter("TRKFIT:LOCKSTEP_HYPOTHESES",
+         LOCKSTEP_HYPOTHESES, "Fit the mass hypotheses of a candidate together with DTrackFitterKalmanSIMD::FitTracksLockstep. Only tracks with no CDC hits are interleaved and only their propagation steps are vectorised; the results may differ from the one-at-a-time fits by rounding, validate with the kalman_lockstep_compare plugin first (default false: the fits are done by FitTrack, unchanged)");
+
+   // Fitters for the lockstep fits of the mass hypotheses. These are only
+   // used if the default fitter is the plain DTrackFitterKalmanSIMD: the
+   // fitters derived from it replace the filter that FitTracksLockstep uses.
+   for(unsigned int i=0; i<lockstep_fitters.size(); i++) delete lockstep_fitters[i];
+   lockstep_fitters.clear();
+   if(LOCKSTEP_HYPOTHESES && !SKIP_MASS_HYPOTHESES_WIRE_BASED){
+      if(typeid(*fitter)==typeid(DTrackFitterKalmanSIMD)){
+         size_t num_fitters=max(mass_hypotheses_positive.size(),mass_hypotheses_negative.size());
+         for(size_t i=0; i<num_fitters; i++)
+            lockstep_fitters.push_back(new DTrackFitterKalmanSIMD(loop));
+      }
+      else{
+         static once_flag lwarn_flag;
+         call_once(lwarn_flag, [](){
+            jout << "TRKFIT:LOCKSTEP_HYPOTHESES needs the DTrackFitterKalmanSIMD fitter; fitting the hypotheses one at a time." << endl;
+         });
+      }
+   }
+
    if(DEBUG_HISTS){
       dapp->Lock();
 
@@ -322,6 +348,11 @@ jerror_t DTrackWireBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
          if ((!isfinite(candidate->momentum().Mag())) || (!isfinite(candidate->position().Mag())))
             _DBG_ << "Invalid seed data for event "<< eventnumber <<"..."<<endl;
 
+         if(!lockstep_fitters.empty()){
+            DoLockstepFits(i,candidate,rt,loop,mass_hypotheses);
+            continue;
+         }
+
          // Loop over potential particle masses
          for(unsigned int j=0; j<mass_hypotheses.size(); j++){
             if(DEBUG_LEVEL>1){_DBG__;_DBG_<<"---- Starting wire based fit with id: "<<mass_hypotheses[j]<<endl;}
@@ -352,6 +383,9 @@ jerror_t DTrackWireBased_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
 jerror_t DTrackWireBased_factory::erun(void)
 {
   if (rt) delete rt;
+  rt=NULL;
+  for(unsigned int i=0; i<lockstep_fitters.size(); i++) delete lockstep_fitters[i];
+  lockstep_fitters.clear();
    return NOERROR;
 }
 
@@ -489,6 +523,79 @@ void DTrackWireBased_factory::DoFit(unsigned int c_id,
       }
    }
 
+   MakeTrack(c_id,candidate,fitter,status);
+}
+
+// Fit all of the mass hypotheses of a candidate at once with 
+// DTrackFitterKalmanSIMD::FitTracksLockstep and fill the list of wire-based 
+// tracks with the results. The hits are found the same way as in DoFit.
+void DTrackWireBased_factory::DoLockstepFits(unsigned int c_id,
+      const DTrackCandidate *candidate,
+      DReferenceTrajectory *rt,
+      JEventLoop *loop, const vector<int> &mass_hypotheses){
+   // Get the hits from the candidate
+  vector<const DFDCPseudo*>myfdchits;
+  candidate->GetT(myfdchits);
+  vector<const DCDCTrackHit *>mycdchits;
+  candidate->GetT(mycdchits);
+
+  // Set up one fitter per hypothesis
+  vector<DTrackFitterKalmanSIMD *>myfitters(lockstep_fitters.begin(),
+					    lockstep_fitters.begin()+mass_hypotheses.size());
+  vector<bool>use_candidate_hits(mass_hypotheses.size(),USE_HITS_FROM_CANDIDATE);
+  for(unsigned int j=0; j<mass_hypotheses.size(); j++){
+    if(DEBUG_LEVEL>1){_DBG__;_DBG_<<"---- Starting lockstep wire based fit with id: "<<mass_hypotheses[j]<<endl;}
+    double mass=ParticleMass(Particle_t(mass_hypotheses[j]));
+    DTrackFitterKalmanSIMD *myfitter=myfitters[j];
+    myfitter->Reset();
+    myfitter->SetFitType(DTrackFitter::kWireBased);
+    if (!USE_HITS_FROM_CANDIDATE){
+      // Swim a reference trajectory using the candidate starting momentum
+      // and position
+      rt->Reset();
+      rt->q = candidate->charge();
+      rt->SetMass(mass);
+      rt->FastSwimForHitSelection(candidate->position(),candidate->momentum(),candidate->charge());
+      if (myfitter->FindHits(*candidate,rt,loop,mass,
+			     mycdchits.size()+2*myfdchits.size())==false){
+	if (DEBUG_LEVEL>1)_DBG_ << "Using hits from candidate..." << endl;
+	use_candidate_hits[j]=true;
+      }
+    }
+    if (use_candidate_hits[j]){
+      myfitter->Reset();
+      myfitter->AddHits(myfdchits);
+      myfitter->AddHits(mycdchits);
+    }
+    myfitter->SetInputParameters(candidate->position(),candidate->momentum(),
+				 candidate->charge(),mass,0.);
+  }
+
+  // Do the fits
+  vector<DTrackFitter::fit_status_t>status;
+  DTrackFitterKalmanSIMD::FitTracksLockstep(myfitters,status);
+
+  for(unsigned int j=0; j<mass_hypotheses.size(); j++){
+    // Same fallback as in DoFit when the fit with the selected hits was not 
+    // done
+    if (status[j]==DTrackFitter::kFitNotDone && !use_candidate_hits[j]){
+      if (DEBUG_LEVEL>1)_DBG_ << "Using hits from candidate..." << endl;
+      double mass=ParticleMass(Particle_t(mass_hypotheses[j]));
+      myfitters[j]->Reset();
+      myfitters[j]->AddHits(myfdchits);
+      myfitters[j]->AddHits(mycdchits);
+      status[j]=myfitters[j]->FitTrack(candidate->position(),
+				       candidate->momentum(),
+				       candidate->charge(),mass,0.);
+    }
+    MakeTrack(c_id,candidate,myfitters[j],status[j]);
+  }
+}
+
+// Make a wire-based track from the fit results and add it to the list
+void DTrackWireBased_factory::MakeTrack(unsigned int c_id,
+      const DTrackCandidate *candidate,
+      DTrackFitter *fitter,DTrackFitter::fit_status_t status){
    // if the fit returns chisq=-1, something went terribly wrong... 
    if (fitter->GetChisq()<0){
      status=DTrackFitter::kFitFailed;
@@ -22,6 +22,7 @@
 
 class DTrackCandidate;
 class DParticleID;
+class DTrackFitterKalmanSIMD;
 
 #include "DTrackWireBased.h"
 
@@ -63,6 +64,7 @@ class DTrackWireBased_factory:public jana::JFactory<DTrackWireBased>{
 		int DEBUG_LEVEL;
 		DTrackFitter *fitter;
 		DReferenceTrajectory *rt;
+		vector<DTrackFitterKalmanSIMD *> lockstep_fitters; // one per mass hypothesis
 
 		vector<int> mass_hypotheses_positive;
 		vector<int> mass_hypotheses_negative;
@@ -73,6 +75,11 @@ class DTrackWireBased_factory:public jana::JFactory<DTrackWireBased>{
 		void DoFit(unsigned int c_id,const DTrackCandidate *candidate,
 			   DReferenceTrajectory *rt,jana::JEventLoop *loop, 
 			   double mass);
+		void DoLockstepFits(unsigned int c_id,const DTrackCandidate *candidate,
+				    DReferenceTrajectory *rt,jana::JEventLoop *loop,
+				    const vector<int> &mass_hypotheses);
+		void MakeTrack(unsigned int c_id,const DTrackCandidate *candidate,
+			       DTrackFitter *fitter,DTrackFitter::fit_status_t status);
 		void AddMissingTrackHypothesis(vector<DTrackWireBased*>&tracks_to_add,
 					       const DTrackWireBased *src_track,
 					       double my_mass,double q);
@@ -90,6 +97,7 @@ class DTrackWireBased_factory:public jana::JFactory<DTrackWireBased>{
 		bool DEBUG_HISTS;
 		bool SKIP_MASS_HYPOTHESES_WIRE_BASED;
 		bool USE_HITS_FROM_CANDIDATE;
+		bool LOCKSTEP_HYPOTHESES;
 		double MIN_FIT_P;
 		double PROTON_MOM_THRESH;
 		bool dIsNoFieldFlag;
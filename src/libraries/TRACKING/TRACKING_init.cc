@@ -8,6 +8,7 @@
 #include "DTrackCandidate_factory.h"
 #include "DTrackCandidate_factory_THROWN.h"
 #include "DTrackCandidate_factory_CDC.h"
+#include "DTrackCandidate_factory_CDCGraph.h"
 #include "DTrackCandidate_factory_FDC.h"
 #include "DTrackCandidate_factory_FDCCathodes.h"
 #include "DTrackCandidate_factory_FDCpseudo.h"
@@ -39,6 +40,7 @@ jerror_t TRACKING_init(JEventLoop *loop)
    loop->AddFactory(new DTrackTimeBased_factory());
    loop->AddFactory(new DTrackCandidate_factory());
    loop->AddFactory(new DTrackCandidate_factory_CDC());
+   loop->AddFactory(new DTrackCandidate_factory_CDCGraph());
    loop->AddFactory(new DTrackCandidate_factory_FDC());
    loop->AddFactory(new DTrackCandidate_factory_FDCCathodes());
    loop->AddFactory(new DTrackCandidate_factory_FDCpseudo());
@@ -0,0 +1,397 @@
+// $Id$
+//
+//    File: DFlatBDT.cc
+//
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#include <expat.h>
+
+#include "DFlatBDT.h"
+
+namespace
+{
+	// Nodes and settings as read from the file, before flattening
+	struct DFlatBDT_Node
+	{
+		int dTree;
+		int dVariable; //index in the file, -1 for leaves
+		float dCut;
+		int dCutType;
+		int dNodeType; //1: signal leaf, -1: background leaf, 0: not a leaf
+		float dPurity;
+		float dResponse;
+		bool dHasFisherCuts;
+		int dChildren[2];
+	};
+
+	struct DFlatBDT_XMLState
+	{
+		DFlatBDT_XMLState(void) : dNumTransformations(0), dAnalysisType(0), dInOption(false), dError(false) {}
+
+		string dMethod;
+		map<string, string> dOptions;
+		vector<string> dVariableNames; //in the file
+		int dNumTransformations;
+		int dAnalysisType;
+
+		bool dInOption;
+		string dOptionName;
+		string dOptionText;
+
+		vector<DFlatBDT_Node> dNodes;
+		vector<int> dTreeRoots;
+		vector<int> dTreeDepths;
+		vector<double> dBoostWeights;
+		vector<int> dNodeStack;
+
+		bool dError;
+		string dErrorMessage;
+	};
+
+	mutex dFlatBDT_XMLMutex; //parse one file at a time, as for the translation table
+
+	const char* Get_Attribute(const char** locAttributes, const char* locName)
+	{
+		for(int loc_i = 0; locAttributes[loc_i] != NULL; loc_i += 2)
+		{
+			if(strcmp(locAttributes[loc_i], locName) == 0)
+				return locAttributes[loc_i + 1];
+		}
+		return NULL;
+	}
+
+	// Numbers are read as in TMVA's Tools::ReadAttr(), with a stringstream into
+	// the type of the TMVA member (strtof/strtod would depend on the C locale)
+	template <typename DType> DType Parse_Number(const char* locText)
+	{
+		istringstream locStream(locText);
+		DType locValue = DType();
+		locStream >> locValue;
+		return locValue;
+	}
+
+	void DFlatBDT_StartElement(void* locUserData, const char* locName, const char** locAttributes)
+	{
+		DFlatBDT_XMLState* locState = static_cast<DFlatBDT_XMLState*>(locUserData);
+		if(locState->dError)
+			return;
+
+		if(strcmp(locName, "MethodSetup") == 0)
+		{
+			const char* locMethod = Get_Attribute(locAttributes, "Method");
+			if(locMethod != NULL)
+				locState->dMethod = locMethod;
+		}
+		else if(strcmp(locName, "Option") == 0)
+		{
+			const char* locOptionName = Get_Attribute(locAttributes, "name");
+			locState->dInOption = (locOptionName != NULL);
+			locState->dOptionName = (locOptionName != NULL) ? locOptionName : "";
+			locState->dOptionText = "";
+		}
+		else if(strcmp(locName, "Variable") == 0)
+		{
+			const char* locIndex = Get_Attribute(locAttributes, "VarIndex");
+			const char* locExpression = Get_Attribute(locAttributes, "Expression");
+			if((locIndex == NULL) || (locExpression == NULL))
+				return;
+			size_t locVarIndex = strtoul(locIndex, NULL, 10);
+			if(locState->dVariableNames.size() <= locVarIndex)
+				locState->dVariableNames.resize(locVarIndex + 1);
+			locState->dVariableNames[locVarIndex] = locExpression;
+		}
+		else if(strcmp(locName, "Transformations") == 0)
+		{
+			const char* locNumTransformations = Get_Attribute(locAttributes, "NTransformations");
+			if(locNumTransformations != NULL)
+				locState->dNumTransformations = atoi(locNumTransformations);
+		}
+		else if(strcmp(locName, "Weights") == 0)
+		{
+			const char* locAnalysisType = Get_Attribute(locAttributes, "AnalysisType");
+			if(locAnalysisType == NULL)
+				locAnalysisType = Get_Attribute(locAttributes, "TreeType"); //pre 4.1.0
+			if(locAnalysisType != NULL)
+				locState->dAnalysisType = atoi(locAnalysisType);
+		}
+		else if(strcmp(locName, "BinaryTree") == 0)
+		{
+			const char* locBoostWeight = Get_Attribute(locAttributes, "boostWeight");
+			locState->dBoostWeights.push_back((locBoostWeight != NULL) ? Parse_Number<double>(locBoostWeight) : 1.0);
+			locState->dTreeRoots.push_back(-1);
+			locState->dTreeDepths.push_back(0);
+			locState->dNodeStack.clear();
+		}
+		else if(strcmp(locName, "Node") == 0)
+		{
+			if(locState->dTreeRoots.empty())
+				return;
+
+			const char* locVariable = Get_Attribute(locAttributes, "IVar");
+			const char* locCut = Get_Attribute(locAttributes, "Cut");
+			const char* locCutType = Get_Attribute(locAttributes, "cType");
+			const char* locNodeType = Get_Attribute(locAttributes, "nType");
+			const char* locPurity = Get_Attribute(locAttributes, "purity");
+			const char* locResponse = Get_Attribute(locAttributes, "res");
+			const char* locNumFisherCoeffs = Get_Attribute(locAttributes, "NCoef");
+			const char* locPosition = Get_Attribute(locAttributes, "pos");
+			if((locVariable == NULL) || (locCut == NULL) || (locCutType == NULL) || (locNodeType == NULL) || (locPurity == NULL))
+			{
+				locState->dError = true;
+				locState->dErrorMessage = "unsupported node format (TMVA version?)";
+				return;
+			}
+
+			DFlatBDT_Node locNode;
+			locNode.dTree = int(locState->dTreeRoots.size()) - 1;
+			locNode.dVariable = atoi(locVariable);
+			locNode.dCut = Parse_Number<float>(locCut); //Float_t in TMVA, as the purity and response
+			locNode.dCutType = atoi(locCutType);
+			locNode.dNodeType = atoi(locNodeType);
+			locNode.dPurity = Parse_Number<float>(locPurity);
+			locNode.dResponse = (locResponse != NULL) ? Parse_Number<float>(locResponse) : 0.0;
+			locNode.dHasFisherCuts = (locNumFisherCoeffs != NULL) && (atoi(locNumFisherCoeffs) > 0);
+			locNode.dChildren[0] = locNode.dChildren[1] = -1;
+
+			int locNodeIndex = locState->dNodes.size();
+			if(locState->dNodeStack.empty())
+				locState->dTreeRoots.back() = locNodeIndex;
+			else
+			{
+				DFlatBDT_Node& locParent = locState->dNodes[locState->dNodeStack.back()];
+				bool locIsRight = (locPosition != NULL) && (locPosition[0] == 'r');
+				locParent.dChildren[locIsRight ? 1 : 0] = locNodeIndex;
+			}
+			locState->dNodes.push_back(locNode);
+
+			locState->dNodeStack.push_back(locNodeIndex);
+			int locDepth = int(locState->dNodeStack.size()) - 1;
+			if(locDepth > locState->dTreeDepths.back())
+				locState->dTreeDepths.back() = locDepth;
+		}
+	}
+
+	void DFlatBDT_EndElement(void* locUserData, const char* locName)
+	{
+		DFlatBDT_XMLState* locState = static_cast<DFlatBDT_XMLState*>(locUserData);
+		if(strcmp(locName, "Node") == 0)
+		{
+			if(!locState->dNodeStack.empty())
+				locState->dNodeStack.pop_back();
+		}
+		else if((strcmp(locName, "Option") == 0) && locState->dInOption)
+		{
+			locState->dOptions[locState->dOptionName] = locState->dOptionText;
+			locState->dInOption = false;
+		}
+	}
+
+	void DFlatBDT_CharacterData(void* locUserData, const char* locText, int locLength)
+	{
+		DFlatBDT_XMLState* locState = static_cast<DFlatBDT_XMLState*>(locUserData);
+		if(locState->dInOption)
+			locState->dOptionText.append(locText, locLength);
+	}
+}
+
+//------------------
+// Read_WeightsXML
+//------------------
+bool DFlatBDT::Read_WeightsXML(string locFileName, const vector<string>& locVariableNames)
+{
+	dTreeRoots.clear();
+	dTreeDepths.clear();
+	dVariables.clear();
+	dCuts.clear();
+	dCutTypes.clear();
+	dChildren.clear();
+	dLeafValues.clear();
+
+	ifstream locInputFile(locFileName.c_str());
+	if(!locInputFile.is_open())
+	{
+		cerr << "DFlatBDT: Unable to open " << locFileName << endl;
+		return false;
+	}
+	stringstream locStream;
+	locStream << locInputFile.rdbuf();
+	string locXML = locStream.str();
+
+	DFlatBDT_XMLState locState;
+	{
+		lock_guard<mutex> locLock(dFlatBDT_XMLMutex);
+		XML_Parser locParser = XML_ParserCreate(NULL);
+		if(locParser == NULL)
+		{
+			cerr << "DFlatBDT: Unable to create XML parser" << endl;
+			return false;
+		}
+		XML_SetElementHandler(locParser, DFlatBDT_StartElement, DFlatBDT_EndElement);
+		XML_SetCharacterDataHandler(locParser, DFlatBDT_CharacterData);
+		XML_SetUserData(locParser, &locState);
+		if(XML_Parse(locParser, locXML.c_str(), locXML.size(), 1) == 0)
+		{
+			cerr << "DFlatBDT: XML parse error in " << locFileName << ": " << XML_ErrorString(XML_GetErrorCode(locParser)) << endl;
+			XML_ParserFree(locParser);
+			return false;
+		}
+		XML_ParserFree(locParser);
+	}
+
+	// Check that the method is supported
+	string locBoostType = locState.dOptions.count("BoostType") ? locState.dOptions["BoostType"] : "AdaBoost";
+	bool locUseYesNoLeaf = !locState.dOptions.count("UseYesNoLeaf") || (locState.dOptions["UseYesNoLeaf"] != "False");
+	string locError = locState.dErrorMessage;
+	if(locState.dMethod.compare(0, 5, "BDT::") != 0)
+		locError = string("method is ") + locState.dMethod + ", not BDT";
+	else if((locBoostType != "AdaBoost") && (locBoostType != "Bagging") && (locBoostType != "Grad"))
+		locError = string("boost type ") + locBoostType + " is not supported";
+	else if((locBoostType != "Grad") && (locState.dAnalysisType != 0))
+		locError = "only classification is supported";
+	else if(locState.dNumTransformations != 0)
+		locError = "variable transformations are not supported";
+	else if(locState.dTreeRoots.empty())
+		locError = "no trees";
+	if(locError != "")
+	{
+		cerr << "DFlatBDT: Can't use " << locFileName << ": " << locError << endl;
+		return false;
+	}
+
+	// Match the variables
+	vector<int> locVariableMap(locState.dVariableNames.size(), -1);
+	for(size_t loc_i = 0; loc_i < locState.dVariableNames.size(); ++loc_i)
+	{
+		vector<string>::const_iterator locIterator = find(locVariableNames.begin(), locVariableNames.end(), locState.dVariableNames[loc_i]);
+		if(locIterator == locVariableNames.end())
+		{
+			cerr << "DFlatBDT: Variable " << locState.dVariableNames[loc_i] << " of " << locFileName << " is not an input" << endl;
+			return false;
+		}
+		locVariableMap[loc_i] = locIterator - locVariableNames.begin();
+	}
+
+	// Flatten
+	size_t locNumNodes = locState.dNodes.size();
+	dVariables.resize(locNumNodes);
+	dCuts.resize(locNumNodes);
+	dCutTypes.resize(locNumNodes);
+	dChildren.resize(2*locNumNodes);
+	dLeafValues.resize(locNumNodes);
+	for(size_t loc_i = 0; loc_i < locNumNodes; ++loc_i)
+	{
+		const DFlatBDT_Node& locNode = locState.dNodes[loc_i];
+		// As in TMVA::DecisionTree::CheckEvent(), the walk stops at the first signal or background node
+		bool locIsLeaf = (locNode.dNodeType != 0);
+		if(locIsLeaf)
+		{
+			// Any cut result stays here
+			dVariables[loc_i] = 0;
+			dCuts[loc_i] = 0.0;
+			dCutTypes[loc_i] = 1;
+			dChildren[2*loc_i] = dChildren[2*loc_i + 1] = loc_i;
+			// times the boost weight of the tree, so Evaluate() only adds (see DFlatBDT.h)
+			if(locBoostType == "Grad")
+				dLeafValues[loc_i] = locNode.dResponse;
+			else
+				dLeafValues[loc_i] = locState.dBoostWeights[locNode.dTree]*(locUseYesNoLeaf ? double(locNode.dNodeType) : double(locNode.dPurity));
+			continue;
+		}
+
+		if(locNode.dHasFisherCuts || (locNode.dChildren[0] < 0) || (locNode.dChildren[1] < 0) ||
+				(locNode.dVariable < 0) || (locNode.dVariable >= int(locVariableMap.size())))
+		{
+			cerr << "DFlatBDT: Can't use " << locFileName << ": unsupported node (Fisher cut or missing child)" << endl;
+			dTreeRoots.clear();
+			return false;
+		}
+		dVariables[loc_i] = locVariableMap[locNode.dVariable];
+		dCuts[loc_i] = locNode.dCut;
+		dCutTypes[loc_i] = (locNode.dCutType != 0) ? 1 : 0;
+		dChildren[2*loc_i] = locNode.dChildren[0];
+		dChildren[2*loc_i + 1] = locNode.dChildren[1];
+		dLeafValues[loc_i] = 0.0;
+	}
+
+	dNumVariables = locVariableNames.size();
+	dIsGradBoost = (locBoostType == "Grad");
+	dTreeRoots = locState.dTreeRoots;
+	dTreeDepths = locState.dTreeDepths;
+	dNormalization = 0.0;
+	for(size_t loc_i = 0; loc_i < locState.dBoostWeights.size(); ++loc_i)
+		dNormalization += dIsGradBoost ? 1.0 : locState.dBoostWeights[loc_i];
+
+	return true;
+}
+
+//------------------
+// Evaluate
+//------------------
+void DFlatBDT::Evaluate(const float* locInputs, size_t locNumEvents, double* locOutputs) const
+{
+	const int* locVariables = dVariables.data();
+	const float* locCuts = dCuts.data();
+	const int* locCutTypes = dCutTypes.data();
+	const int* locChildren = dChildren.data();
+	const double* locLeafValues = dLeafValues.data();
+
+	for(size_t locFirstEvent = 0; locFirstEvent < locNumEvents; locFirstEvent += kBlockSize)
+	{
+		// Offsets of the events of this block in the inputs; the unused slots of the last block repeat its last event
+		const float* locBlockInputs = locInputs + locFirstEvent*dNumVariables;
+		size_t locNumBlockEvents = min(size_t(kBlockSize), locNumEvents - locFirstEvent);
+		int locOffsets[kBlockSize];
+		for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+			locOffsets[loc_i] = min(loc_i, locNumBlockEvents - 1)*dNumVariables;
+
+		double locSums[kBlockSize];
+		for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+			locSums[loc_i] = 0.0;
+
+		for(size_t locTree = 0; locTree < dTreeRoots.size(); ++locTree)
+		{
+			int locNodes[kBlockSize];
+			for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+				locNodes[loc_i] = dTreeRoots[locTree];
+
+			for(int locDepth = 0; locDepth < dTreeDepths[locTree]; ++locDepth)
+			{
+				for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+				{
+					int locNode = locNodes[loc_i];
+					int locGoesRight = ((locBlockInputs[locOffsets[loc_i] + locVariables[locNode]] >= locCuts[locNode]) == (locCutTypes[locNode] != 0));
+					locNodes[loc_i] = locChildren[2*locNode + locGoesRight];
+				}
+			}
+
+			for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+				locSums[loc_i] += locLeafValues[locNodes[loc_i]];
+		}
+
+		for(size_t loc_i = 0; loc_i < locNumBlockEvents; ++loc_i)
+		{
+			// TMVA::Reader refuses events with NaN inputs
+			bool locHasNaN = false;
+			for(size_t loc_j = 0; loc_j < dNumVariables; ++loc_j)
+				locHasNaN |= std::isnan(locBlockInputs[locOffsets[loc_i] + loc_j]);
+
+			double& locOutput = locOutputs[locFirstEvent + loc_i];
+			if(locHasNaN)
+				locOutput = -999.0;
+			else if(dIsGradBoost)
+				locOutput = 2.0/(1.0 + exp(-2.0*locSums[loc_i])) - 1.0;
+			else
+				locOutput = (dNormalization > numeric_limits<double>::epsilon()) ? locSums[loc_i]/dNormalization : 0.0;
+		}
+	}
+}
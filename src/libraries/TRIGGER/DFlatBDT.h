@@ -0,0 +1,79 @@
+// $Id$
+//
+//    File: DFlatBDT.h
+//
+
+#ifndef _DFlatBDT_
+#define _DFlatBDT_
+
+#include <string>
+#include <vector>
+using namespace std;
+
+/// Boosted decision tree classifier read from a TMVA (MethodBDT) XML weights
+/// file into flat node arrays and evaluated without ROOT or TMVA::Reader.
+///
+/// All trees of the forest are stored in the same arrays (variable index, cut,
+/// cut type, left/right child and leaf value per node) and the trees are walked
+/// branch-free for a block of events at a time: a leaf is its own child, so each
+/// tree takes a fixed number of steps (its depth) for every event and the inner
+/// loop over the events of the block can be vectorized by the compiler (with
+/// gathers for e.g. -mavx2).
+///
+/// The response is the one of TMVA::Reader::EvaluateMVA, bit for bit: the cuts,
+/// purities and responses are read into single precision (TMVA's Float_t) as
+/// TMVA reads them, a tree is walked down to its first signal or background
+/// node, and the products of the boost weights and leaf values are summed in
+/// double precision over the trees in the order of the file. The products are
+/// taken once when the file is read, so the compiler can't fuse them into the
+/// sum (e.g. with -mfma); the results match a TMVA that doesn't fuse them
+/// either. As in TMVA, events with a NaN input get a response of -999.
+///
+/// Supported are the AdaBoost, Bagging and Grad boost types without variable
+/// transformations or Fisher cuts; Read_WeightsXML() returns false for other
+/// weights files, which should then be evaluated with TMVA::Reader.
+class DFlatBDT
+{
+	public:
+		DFlatBDT(void) : dNumVariables(0), dIsGradBoost(false), dNormalization(0.0) {}
+
+		// The variable names are the inputs in the order they are given to
+		// Evaluate(); they are matched to the names (expressions) in the file.
+		bool Read_WeightsXML(string locFileName, const vector<string>& locVariableNames);
+
+		bool Get_IsLoaded(void) const{return !dTreeRoots.empty();}
+		size_t Get_NumVariables(void) const{return dNumVariables;}
+		size_t Get_NumTrees(void) const{return dTreeRoots.size();}
+
+		// MVA response of one event
+		double Evaluate(const float* locInputs) const;
+		// MVA responses of locNumEvents events: locInputs[event*Get_NumVariables() + variable]
+		void Evaluate(const float* locInputs, size_t locNumEvents, double* locOutputs) const;
+
+	private:
+		enum{kBlockSize = 16};
+
+		size_t dNumVariables;
+		bool dIsGradBoost;
+		double dNormalization; //sum of the boost weights (not used for Grad)
+
+		// Per tree
+		vector<int> dTreeRoots;
+		vector<int> dTreeDepths;
+
+		// Per node
+		vector<int> dVariables; //index in the Evaluate() inputs
+		vector<float> dCuts;
+		vector<int> dCutTypes; //1: goes right if input >= cut, 0: if not
+		vector<int> dChildren; //2*node: left, 2*node + 1: right; leaves point to themselves
+		vector<double> dLeafValues; //times the boost weight of the tree (not for Grad)
+};
+
+inline double DFlatBDT::Evaluate(const float* locInputs) const
+{
+	double locOutput;
+	Evaluate(locInputs, 1, &locOutput);
+	return locOutput;
+}
+
+#endif // _DFlatBDT_
@@ -36,7 +36,11 @@ jerror_t DL3Trigger_factory::init(void)
 	L1_FP_TRIG_MASK = 0xffffffff;
 	MVA_WEIGHTS = "";
 	MVA_CUT = -0.2;
+	MVA_USE_TMVA = false;
+	MVA_CHECK = false;
+#ifdef HAVE_TMVA
 	mvareader = NULL;
+#endif
 
 	gPARMS->SetDefaultParameter("L3:FRACTION_TO_KEEP", FRACTION_TO_KEEP ,"Random Fraction of event L3 should keep. (Only used for debugging).");
 	gPARMS->SetDefaultParameter("L3:DO_WIRE_BASED_TRACKING", DO_WIRE_BASED_TRACKING ,"Activate wire-based tracking for every event");
@@ -45,22 +49,37 @@ jerror_t DL3Trigger_factory::init(void)
 	gPARMS->SetDefaultParameter("L3:L1_FP_TRIG_MASK", L1_FP_TRIG_MASK ,"Discard events that don't have one of these bits set in DL1Trigger::fp_trig_mask (or in L1_TRIG_MASK)");
 	gPARMS->SetDefaultParameter("L3:MVA_WEIGHTS", MVA_WEIGHTS ,"TMVA weights file");
 	gPARMS->SetDefaultParameter("L3:MVA_CUT", MVA_CUT ,"Cut on MVA response function. Event with values less than this are discarded.");
+	gPARMS->SetDefaultParameter("L3:MVA_USE_TMVA", MVA_USE_TMVA ,"Evaluate the MVA with TMVA::Reader even if the weights file can be read into the flat-array DFlatBDT (a BDT without transformations).");
+	gPARMS->SetDefaultParameter("L3:MVA_CHECK", MVA_CHECK ,"Evaluate the MVA with both DFlatBDT and TMVA::Reader and print the events where the responses differ.");
 
 	if(MVA_WEIGHTS != ""){
+		const char *varnames[] = {"Nstart_counter", "Ntof", "Nbcal_points", "Nbcal_clusters", "Ebcal_points",
+			"Ebcal_clusters", "Nfcal_clusters", "Efcal_clusters", "Ntrack_candidates", "Ptot_candidates"};
+		if(!MVA_USE_TMVA){
+			if(flatbdt.Read_WeightsXML(MVA_WEIGHTS, vector<string>(varnames, varnames+10))){
+				jout << "L3: Evaluating MVA with DFlatBDT (" << flatbdt.Get_NumTrees() << " trees)" << endl;
+			}else{
+				jout << "L3: Unable to use DFlatBDT for " << MVA_WEIGHTS << ". Evaluating MVA with TMVA::Reader" << endl;
+			}
+		}
 #ifdef HAVE_TMVA
-		mvareader = new TMVA::Reader();
-		mvareader->AddVariable("Nstart_counter",      &Nstart_counter);
-		mvareader->AddVariable("Ntof",                &Ntof);
-		mvareader->AddVariable("Nbcal_points",        &Nbcal_points);
-		mvareader->AddVariable("Nbcal_clusters",      &Nbcal_clusters);
-		mvareader->AddVariable("Ebcal_points",        &Ebcal_points);
-		mvareader->AddVariable("Ebcal_clusters",      &Ebcal_clusters);
-		mvareader->AddVariable("Nfcal_clusters",      &Nfcal_clusters);
-		mvareader->AddVariable("Efcal_clusters",      &Efcal_clusters);
-		mvareader->AddVariable("Ntrack_candidates",   &Ntrack_candidates);
-		mvareader->AddVariable("Ptot_candidates",     &Ptot_candidates);
+		if(!flatbdt.Get_IsLoaded() || MVA_CHECK){
+			mvareader = new TMVA::Reader();
+			mvareader->AddVariable("Nstart_counter",      &Nstart_counter);
+			mvareader->AddVariable("Ntof",                &Ntof);
+			mvareader->AddVariable("Nbcal_points",        &Nbcal_points);
+			mvareader->AddVariable("Nbcal_clusters",      &Nbcal_clusters);
+			mvareader->AddVariable("Ebcal_points",        &Ebcal_points);
+			mvareader->AddVariable("Ebcal_clusters",      &Ebcal_clusters);
+			mvareader->AddVariable("Nfcal_clusters",      &Nfcal_clusters);
+			mvareader->AddVariable("Efcal_clusters",      &Efcal_clusters);
+			mvareader->AddVariable("Ntrack_candidates",   &Ntrack_candidates);
+			mvareader->AddVariable("Ptot_candidates",     &Ptot_candidates);
 		
-		mvareader->BookMVA("MVA", MVA_WEIGHTS);
+			mvareader->BookMVA("MVA", MVA_WEIGHTS);
+		}
+#else
+		if(!flatbdt.Get_IsLoaded()) jerr << "L3: TMVA not available. MVA will not be evaluated!" << endl;
 #endif
 	}
 
@@ -106,8 +125,11 @@ jerror_t DL3Trigger_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
 		if(!trig_bit_is_set) l3trig->L3_decision = DL3Trigger::kDISCARD_EVENT;
 	}
 	
+	bool have_mva = flatbdt.Get_IsLoaded();
 #ifdef HAVE_TMVA
-	if(mvareader){
+	if(mvareader) have_mva = true;
+#endif
+	if(have_mva){
 		vector<const DSCDigiHit*> scdigihits;
 		vector<const DTOFDigiHit*> tofdigihits;
 		vector<const DBCALPoint*> bcalpoints;
@@ -122,32 +144,49 @@ jerror_t DL3Trigger_factory::evnt(JEventLoop *loop, uint64_t eventnumber)
 		loop->Get(trackcandidates);
 
 		// Calorimeter energies
-		double Ebcal_points   = 0.0;
-		double Ebcal_clusters = 0.0;
-		double Efcal_clusters = 0.0;
-		for(auto bp : bcalpoints  ) Ebcal_points   += bp->E();
-		for(auto bc : bcalclusters) Ebcal_clusters += bc->E();
-		for(auto fc : fcalclusters) Efcal_clusters += fc->getEnergy();
+		double locEbcal_points   = 0.0;
+		double locEbcal_clusters = 0.0;
+		double locEfcal_clusters = 0.0;
+		for(auto bp : bcalpoints  ) locEbcal_points   += bp->E();
+		for(auto bc : bcalclusters) locEbcal_clusters += bc->E();
+		for(auto fc : fcalclusters) locEfcal_clusters += fc->getEnergy();
 
 		// Ptot for candidates
-		double Ptot_candidates = 0.0;
-		for(auto tc : trackcandidates) Ptot_candidates += tc->momentum().Mag();
+		double locPtot_candidates = 0.0;
+		for(auto tc : trackcandidates) locPtot_candidates += tc->momentum().Mag();
 
 		Nstart_counter    = scdigihits.size();
 		Ntof              = tofdigihits.size();
 		Nbcal_points      = bcalpoints.size();
 		Nbcal_clusters    = bcalclusters.size();
-		Ebcal_points      = Ebcal_points;
-		Ebcal_clusters    = Ebcal_clusters;
+		Ebcal_points      = locEbcal_points;
+		Ebcal_clusters    = locEbcal_clusters;
 		Nfcal_clusters    = fcalclusters.size();
-		Efcal_clusters    = Efcal_clusters;
+		Efcal_clusters    = locEfcal_clusters;
 		Ntrack_candidates = trackcandidates.size();
-		Ptot_candidates   = Ptot_candidates;
+		Ptot_candidates   = locPtot_candidates;
 
-		l3trig->mva_response = mvareader->EvaluateMVA("MVA");
+		if(flatbdt.Get_IsLoaded()){
+			// same order as the variable names given to DFlatBDT in init()
+			float inputs[10] = {Nstart_counter, Ntof, Nbcal_points, Nbcal_clusters, Ebcal_points,
+				Ebcal_clusters, Nfcal_clusters, Efcal_clusters, Ntrack_candidates, Ptot_candidates};
+			l3trig->mva_response = flatbdt.Evaluate(inputs);
+		}
+#ifdef HAVE_TMVA
+		if(mvareader){
+			double tmva_response = mvareader->EvaluateMVA("MVA");
+			if(!flatbdt.Get_IsLoaded()){
+				l3trig->mva_response = tmva_response;
+			}else if(tmva_response != l3trig->mva_response){
+				// DFlatBDT reproduces TMVA bit for bit, so any difference is reported
+				jerr << "L3: event " << eventnumber << " DFlatBDT response " << setprecision(17) << l3trig->mva_response << " != TMVA::Reader response " << tmva_response;
+				if((tmva_response < MVA_CUT) != (l3trig->mva_response < MVA_CUT)) jerr << " (different L3 decision)";
+				jerr << endl;
+			}
+		}
+#endif
 		if( l3trig->mva_response < MVA_CUT ) l3trig->L3_decision = DL3Trigger::kDISCARD_EVENT;
 	}
-#endif
 
 	
 	if(DO_WIRE_BASED_TRACKING){
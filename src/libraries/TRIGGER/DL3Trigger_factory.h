@@ -13,6 +13,7 @@ using std::mutex;
 
 #include <JANA/JFactory.h>
 #include "DL3Trigger.h"
+#include "DFlatBDT.h"
 
 #ifdef HAVE_TMVA
 #include <TMVA/Reader.h>
@@ -30,8 +31,10 @@ class DL3Trigger_factory:public jana::JFactory<DL3Trigger>{
 		uint32_t L1_FP_TRIG_MASK;
 		string MVA_WEIGHTS;
 		double MVA_CUT;
+		bool MVA_USE_TMVA;
+		bool MVA_CHECK;
 		
-		
+		DFlatBDT flatbdt;
 #ifdef HAVE_TMVA
 		TMVA::Reader *mvareader;
 #endif
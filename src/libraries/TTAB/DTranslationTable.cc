@@ -9,6 +9,12 @@
 
 #include <expat.h>
 #include <sstream>
+#include <cstring>
+#include <chrono>
+#include <unistd.h>
+#include <cstdlib>
+#include <cerrno>
+#include <sys/stat.h>
 
 #include <DAQ/DModuleType.h>
 #include <DAQ/JEventSource_EVIO.h>
@@ -138,6 +144,29 @@ DTranslationTable::DTranslationTable(JEventLoop *loop)
 			"JANA call stack. You will want this if using the janadot"
 			"plugin, but otherwise, it will just give a slight performance"
 			"hit.");
+
+	// The cache is per user so that nobody else can plant a table in it
+	const char *xdg_cache_home = getenv("XDG_CACHE_HOME");
+	if(xdg_cache_home != NULL && xdg_cache_home[0] == '/'){
+		CACHE_DIR = string(xdg_cache_home) + "/halld_tt";
+	}else{
+		stringstream ss;
+		ss << "/tmp/halld_tt_" << getuid();
+		CACHE_DIR = ss.str();
+	}
+	gPARMS->SetDefaultParameter("TT:CACHE_DIR", CACHE_DIR,
+			"Directory for the binary cache of the parsed translation table"
+			" (one file per translation table XML, identified by its checksum)."
+			" Later processes load the cache instead of parsing the XML. The XML"
+			" itself is still read from the CCDB. Defaults to $XDG_CACHE_HOME/halld_tt"
+			" or /tmp/halld_tt_<uid>. The directory is created with mode 0700 and"
+			" must be owned by the user and not writable by group or others, else"
+			" the cache is not used. Set to an empty string to always parse the XML.");
+	if(CACHE_DIR != "" && !CheckCacheDirectory(CACHE_DIR)){
+		jerr << "Not using translation table cache directory " << CACHE_DIR << endl;
+		jerr << "(it must be owned by you and not writable by group or others)" << endl;
+		CACHE_DIR = "";
+	}
 	if(SYSTEMS_TO_PARSE != ""){
 		jerr << "You have set the TT:SYSTEMS_TO_PARSE config. parameter." << endl;
 		jerr << "This is now deprecated. Please use EVIO:SYSTEMS_TO_PARSE" << endl;
@@ -2027,6 +2056,47 @@ static DTranslationTable::Detector_t DetectorStr2DetID(string &type);
 static void StartElement(void *userData, const char *xmlname, const char **atts);
 static void EndElement(void *userData, const char *xmlname);
 
+// Header of the binary translation table cache files. Increment
+// TT_CACHE_VERSION whenever the parsing of the XML or the layout
+// of DChannelInfo changes.
+static const uint32_t TT_CACHE_VERSION = 1;
+struct TTCacheHeader_t{
+   char magic[8];                // "TTCACHE"
+   uint32_t version;             // TT_CACHE_VERSION
+   uint32_t channel_info_size;   // sizeof(DChannelInfo)
+   uint64_t xml_checksum;        // of the XML the table was parsed from
+   uint64_t xml_size;
+   uint64_t Nchannels;           // DChannelInfo entries following the header
+   uint64_t Nrocid_words;        // rocid by system words following the channels
+   uint64_t payload_checksum;
+   double xml_parse_ms;          // time it took to parse the XML
+};
+
+//---------------------------------
+// TTCacheIsPrivate
+//---------------------------------
+static bool TTCacheIsPrivate(const struct stat &st)
+{
+   // Cache files and their directory must belong to us and must not
+   // be writable by anyone else
+   if (st.st_uid != geteuid()) return false;
+   if (st.st_mode & (S_IWGRP | S_IWOTH)) return false;
+   return true;
+}
+
+//---------------------------------
+// TTChecksum
+//---------------------------------
+static uint64_t TTChecksum(const char *buff, size_t len, uint64_t hash=14695981039346656037ULL)
+{
+   // 64 bit FNV-1a hash
+   for (size_t i=0; i<len; i++) {
+      hash ^= (uint8_t)buff[i];
+      hash *= 1099511628211ULL;
+   }
+   return hash;
+}
+
 
 //---------------------------------
 // ReadTranslationTable
@@ -2097,20 +2167,46 @@ void DTranslationTable::ReadTranslationTable(JCalibration *jcalib)
 	auto save_rocid_map = Get_ROCID_By_System();
 	Get_ROCID_By_System().clear();
 
-   // create parser and specify element handlers
-   XML_Parser xmlParser = XML_ParserCreate(NULL);
-   if (xmlParser == NULL) {
-      jerr << "readTranslationTable...unable to create parser" << std::endl;
-      exit(EXIT_FAILURE);
+   // The parsed table may be in the binary cache already. The cache
+   // files are named by the checksum of the XML, so a changed table
+   // simply won't be found, and is parsed and cached anew.
+   uint64_t xml_checksum = TTChecksum(tt_xml.c_str(), tt_xml.size());
+   string cache_filename;
+   if (CACHE_DIR != "") {
+      char fname[64];
+      sprintf(fname, "/halld_tt_%016llx.bin", (unsigned long long)xml_checksum);
+      cache_filename = CACHE_DIR + fname;
    }
-   XML_SetElementHandler(xmlParser,StartElement,EndElement);
-   XML_SetUserData(xmlParser, &Get_TT());
-
-   // Parse XML string
-   int status=XML_Parse(xmlParser, tt_xml.c_str(), tt_xml.size(), 1); // "1" indicates this is the final piece of XML
-   if (status == 0) {
-      jerr << "  ?readTranslationTable...parseXMLFile parse error for " << XML_FILENAME << std::endl;
-      jerr << XML_ErrorString(XML_GetErrorCode(xmlParser)) << std::endl;
+
+   auto start_time = std::chrono::steady_clock::now();
+   double xml_parse_ms = 0.0;
+   if (cache_filename != "" && ReadTranslationTableCache(cache_filename, xml_checksum, tt_xml.size(), xml_parse_ms)) {
+      double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+      jout << "Loaded translation table from cache " << cache_filename << " in " << load_ms << " ms"
+           << " (parsing the XML took " << xml_parse_ms << " ms)" << std::endl;
+   }else{
+      // create parser and specify element handlers
+      XML_Parser xmlParser = XML_ParserCreate(NULL);
+      if (xmlParser == NULL) {
+         jerr << "readTranslationTable...unable to create parser" << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      XML_SetElementHandler(xmlParser,StartElement,EndElement);
+      XML_SetUserData(xmlParser, &Get_TT());
+
+      // Parse XML string
+      int status=XML_Parse(xmlParser, tt_xml.c_str(), tt_xml.size(), 1); // "1" indicates this is the final piece of XML
+      if (status == 0) {
+         jerr << "  ?readTranslationTable...parseXMLFile parse error for " << XML_FILENAME << std::endl;
+         jerr << XML_ErrorString(XML_GetErrorCode(xmlParser)) << std::endl;
+      }
+      XML_ParserFree(xmlParser);
+      xml_parse_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+      if (VERBOSE > 0) ttout << "Parsed translation table XML in " << xml_parse_ms << " ms" << std::endl;
+
+      // Only cache tables that were parsed completely
+      if (status != 0 && cache_filename != "")
+         WriteTranslationTableCache(cache_filename, xml_checksum, tt_xml.size(), xml_parse_ms);
    }
    
 	// Check if there was a rocid map prior to parsing and
@@ -2165,12 +2261,155 @@ void DTranslationTable::ReadTranslationTable(JCalibration *jcalib)
 	}
 
    jout << Get_TT().size() << " channels defined in translation table" << std::endl;
-   XML_ParserFree(xmlParser);
 
    pthread_mutex_unlock(&Get_TT_Mutex());
    Get_TT_Initialized() = true;
 }
 
+//---------------------------------
+// CheckCacheDirectory
+//---------------------------------
+bool DTranslationTable::CheckCacheDirectory(string dirname)
+{
+   /// Create the cache directory (mode 0700) if it doesn't exist yet
+   /// and check that it is a directory owned by the current user that
+   /// is not writable by group or others.
+
+   if (mkdir(dirname.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+      if (VERBOSE > 0) ttout << "Unable to create translation table cache directory " << dirname << std::endl;
+      return false;
+   }
+
+   struct stat st;
+   if (lstat(dirname.c_str(), &st) != 0) return false;
+   if (! S_ISDIR(st.st_mode)) return false;
+   return TTCacheIsPrivate(st);
+}
+
+//---------------------------------
+// ReadTranslationTableCache
+//---------------------------------
+bool DTranslationTable::ReadTranslationTableCache(string filename, uint64_t xml_checksum, uint64_t xml_size, double &xml_parse_ms)
+{
+   /// Fill the TT and rocid by system maps from a binary cache file
+   /// written by WriteTranslationTableCache(). Returns false, leaving
+   /// the maps untouched, if the file doesn't exist or doesn't match
+   /// the XML and this version of the code, or if it isn't a regular
+   /// file owned by the current user and private to them.
+
+   struct stat st;
+   if (lstat(filename.c_str(), &st) != 0) return false;
+   if (! S_ISREG(st.st_mode) || ! TTCacheIsPrivate(st)) {
+      jerr << "Translation table cache " << filename << " is not owned by you or is writable by others. Ignoring it." << std::endl;
+      return false;
+   }
+
+   ifstream ifs(filename.c_str(), ios::in | ios::binary);
+   if (! ifs.is_open()) return false;
+
+   TTCacheHeader_t header;
+   ifs.read((char*)&header, sizeof(header));
+   if (! ifs.good()) return false;
+   if (strncmp(header.magic, "TTCACHE", 8) != 0
+       || header.version != TT_CACHE_VERSION
+       || header.channel_info_size != sizeof(DChannelInfo)
+       || header.xml_checksum != xml_checksum
+       || header.xml_size != xml_size) {
+      if (VERBOSE > 0) ttout << "Translation table cache " << filename << " is stale. Ignoring it." << std::endl;
+      return false;
+   }
+
+   vector<DChannelInfo> channels(header.Nchannels);
+   vector<uint32_t> rocid_words(header.Nrocid_words);
+   if (! channels.empty()) ifs.read((char*)&channels[0], channels.size()*sizeof(DChannelInfo));
+   if (! rocid_words.empty()) ifs.read((char*)&rocid_words[0], rocid_words.size()*sizeof(uint32_t));
+   if (! ifs.good()) {
+      jerr << "Translation table cache " << filename << " is truncated. Ignoring it." << std::endl;
+      return false;
+   }
+   uint64_t payload_checksum = TTChecksum((const char*)channels.data(), channels.size()*sizeof(DChannelInfo));
+   payload_checksum = TTChecksum((const char*)rocid_words.data(), rocid_words.size()*sizeof(uint32_t), payload_checksum);
+   if (payload_checksum != header.payload_checksum) {
+      jerr << "Translation table cache " << filename << " is corrupt. Ignoring it." << std::endl;
+      return false;
+   }
+
+   // rocid by system: det_sys, Nrocids, rocid, rocid, ...
+   map<Detector_t, set<uint32_t> > rocid_by_system;
+   for (size_t i=0; i+1 < rocid_words.size(); ) {
+      set<uint32_t> &rocids = rocid_by_system[(Detector_t)rocid_words[i]];
+      size_t Nrocids = rocid_words[i+1];
+      i += 2;
+      if (i + Nrocids > rocid_words.size()) return false;
+      rocids.insert(rocid_words.begin() + i, rocid_words.begin() + i + Nrocids);
+      i += Nrocids;
+   }
+
+   // The channels were written in map order, so each one is inserted at the end
+   map<csc_t, DChannelInfo> &TT = Get_TT();
+   TT.clear();
+   for (size_t i=0; i < channels.size(); i++)
+      TT.insert(TT.end(), make_pair(channels[i].CSC, channels[i]));
+   Get_ROCID_By_System() = rocid_by_system;
+   xml_parse_ms = header.xml_parse_ms;
+
+   return true;
+}
+
+//---------------------------------
+// WriteTranslationTableCache
+//---------------------------------
+void DTranslationTable::WriteTranslationTableCache(string filename, uint64_t xml_checksum, uint64_t xml_size, double xml_parse_ms)
+{
+   /// Write the TT and rocid by system maps to a binary cache file. The
+   /// file is written under a temporary name and then renamed, so other
+   /// processes never see a partially written cache. Failing to write it
+   /// (e.g. in a read-only directory) is not an error.
+
+   vector<DChannelInfo> channels;
+   channels.reserve(Get_TT().size());
+   for (auto &it : Get_TT()) channels.push_back(it.second);
+
+   vector<uint32_t> rocid_words;
+   for (auto &it : Get_ROCID_By_System()) {
+      rocid_words.push_back((uint32_t)it.first);
+      rocid_words.push_back(it.second.size());
+      rocid_words.insert(rocid_words.end(), it.second.begin(), it.second.end());
+   }
+
+   TTCacheHeader_t header;
+   memset(&header, 0, sizeof(header));
+   strncpy(header.magic, "TTCACHE", 8);
+   header.version = TT_CACHE_VERSION;
+   header.channel_info_size = sizeof(DChannelInfo);
+   header.xml_checksum = xml_checksum;
+   header.xml_size = xml_size;
+   header.Nchannels = channels.size();
+   header.Nrocid_words = rocid_words.size();
+   header.payload_checksum = TTChecksum((const char*)channels.data(), channels.size()*sizeof(DChannelInfo));
+   header.payload_checksum = TTChecksum((const char*)rocid_words.data(), rocid_words.size()*sizeof(uint32_t), header.payload_checksum);
+   header.xml_parse_ms = xml_parse_ms;
+
+   stringstream tmp_filename;
+   tmp_filename << filename << ".tmp" << getpid();
+   ofstream ofs(tmp_filename.str().c_str(), ios::out | ios::binary);
+   if (! ofs.is_open()) {
+      if (VERBOSE > 0) ttout << "Unable to write translation table cache " << filename << std::endl;
+      return;
+   }
+   ofs.write((const char*)&header, sizeof(header));
+   if (! channels.empty()) ofs.write((const char*)&channels[0], channels.size()*sizeof(DChannelInfo));
+   if (! rocid_words.empty()) ofs.write((const char*)&rocid_words[0], rocid_words.size()*sizeof(uint32_t));
+   ofs.close();
+
+   if (ofs.fail() || chmod(tmp_filename.str().c_str(), S_IRUSR | S_IWUSR) != 0 || rename(tmp_filename.str().c_str(), filename.c_str()) != 0) {
+      if (VERBOSE > 0) ttout << "Unable to write translation table cache " << filename << std::endl;
+      unlink(tmp_filename.str().c_str());
+      return;
+   }
+   jout << "Wrote translation table cache " << filename << std::endl;
+}
+
 //---------------------------------
 // DetectorStr2DetID
 //---------------------------------
@@ -547,6 +547,9 @@ class DTranslationTable:public jana::JObject{
 		static void SetSystemsToParse(string systems, int systems_to_parse_force, JEventSource *eventsource);
 		void SetSystemsToParse(JEventSource *eventsource){SetSystemsToParse(SYSTEMS_TO_PARSE, 0, eventsource);}
 		void ReadTranslationTable(JCalibration *jcalib=NULL);
+		bool CheckCacheDirectory(string dirname);
+		bool ReadTranslationTableCache(string filename, uint64_t xml_checksum, uint64_t xml_size, double &xml_parse_ms);
+		void WriteTranslationTableCache(string filename, uint64_t xml_checksum, uint64_t xml_size, double xml_parse_ms);
 		
 		template<class T> void CopyDf250Info(T *h, const Df250PulseIntegral *pi, const Df250PulseTime *pt, const Df250PulsePedestal *pp) const;
 		template<class T> void CopyDf250Info(T *h, const Df250PulseData *pd) const;
@@ -600,6 +603,7 @@ class DTranslationTable:public jana::JObject{
 		string SYSTEMS_TO_PARSE;
 		string ROCID_MAP_FILENAME;
 		bool CALL_STACK;
+		string CACHE_DIR;
 		
 		mutable JStreamLog ttout;
 
@@ -0,0 +1,439 @@
+#ifndef _DEVIOSkimRouter_
+#define _DEVIOSkimRouter_
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+
+using namespace std;
+
+/****************************************************** OVERVIEW ******************************************************
+ *
+ * Writes the events selected by several skims to their EVIO files in a single pass over the input. It is used by the
+ * hdskims program and by DEventWriterEVIO (evio_writer plugin), which all the EVIO skim plugins write through.
+ *
+ * An event that is selected is put into a buffer once, already byte swapped to big endian (as it is written), and the
+ * buffer is shared with every output file that takes the event through a reference-counted handle (DEVIOSkimBuffer).
+ * It is freed once the last file has written it. Running N skims therefore no longer builds, copies and swaps each
+ * selected event N times.
+ *
+ * Each output file (DEVIOSkimSink) has its own writer thread and bounded queue of event handles. The writer takes up to
+ * NEVENTS_PER_BLOCK events (or MAX_BLOCK_WORDS words) from its queue and writes them as one EVIO block with a single
+ * writev() call: the 8-word block header followed by the event buffers themselves, which are never copied into a block
+ * buffer. A partial block is written once its first event has waited for MAX_HOLD_TIME. Add_Buffer() blocks while the
+ * queue is full, so a slow output applies back-pressure to the threads that fill it.
+ *
+ * DEVIOSkimRouter evaluates the predicates of all skims for an event in one go, makes the event buffer only if at least
+ * one of them selects it, and hands it to the sink of each selecting skim. Skims with the same output file share one
+ * sink, and the event is then written to it once.
+ *
+ ************************************************************ USE ************************************************************
+ *
+ * DEVIOSkimRouter<MyEventInfo> locRouter;
+ * locRouter.Add_Skim("bcal_led", "run_bcal_led.evio", [](const MyEventInfo& locInfo){return locInfo.dIsBCALLED;});
+ * ...
+ * locRouter.Route(locInfo, [&](void){return Make_SwappedBuffer(...);}); //per event
+ * locRouter.Close(); //writes the remaining events and closes the files
+ *
+ * Route() is called by one thread. DEVIOSkimSink::Add_Buffer() may be called by any number of threads.
+ *
+ ************************************************************************************************************************/
+
+// Event buffer as written to the file (big endian). The first word is the event length (not counting itself).
+typedef shared_ptr<const vector<uint32_t> > DEVIOSkimBuffer;
+
+class DEVIOSkimSink
+{
+	public:
+		DEVIOSkimSink(string locFileName, size_t locMaxQueueSize = 200, uint32_t locEventsPerBlock = 100,
+				uint32_t locMaxBlockWords = 250*1024, uint32_t locMaxHoldTime = 2);
+		~DEVIOSkimSink(void){Close();}
+
+		bool Is_Open(void) const{return (dFileDescriptor >= 0);}
+		string Get_FileName(void) const{return dFileName;}
+
+		// Blocks while the queue is full; returns false (and counts the event as dropped) if the sink is closed or unable to write
+		bool Add_Buffer(const DEVIOSkimBuffer& locBuffer);
+
+		// Writes the remaining events and the end-of-file block header, and closes the file
+		void Close(void);
+
+		uint64_t Get_NumEventsWritten(void) const{return dNumEventsWritten;}
+		uint64_t Get_NumBlocksWritten(void) const{return dNumBlocksWritten;}
+		uint64_t Get_NumBytesWritten(void) const{return dNumBytesWritten;}
+		uint64_t Get_NumEventsDropped(void){lock_guard<mutex> locLock(dMutex); return dNumEventsDropped;}
+		bool Has_Error(void){lock_guard<mutex> locLock(dMutex); return dHasError;}
+
+	private:
+		void Write_Thread(void);
+		bool Write_Block(deque<DEVIOSkimBuffer>& locBuffers, uint32_t locNumWords);
+		bool Write_IOVecs(vector<iovec>& locIOVecs);
+
+		string dFileName;
+		int dFileDescriptor;
+
+		size_t dMaxQueueSize; //events
+		uint32_t dEventsPerBlock;
+		uint32_t dMaxBlockWords; //including the block header
+		chrono::seconds dMaxHoldTime;
+		size_t dFlushSize; //events: a full block, or a full queue
+
+		mutex dMutex;
+		condition_variable dNotFull;
+		condition_variable dNotEmpty;
+		deque<DEVIOSkimBuffer> dQueue;
+		uint64_t dQueuedWords;
+		chrono::steady_clock::time_point dOldestTime; //when the first event of the queue was added
+		bool dIsClosed;
+		bool dHasError;
+		uint64_t dNumEventsDropped; //not added, or lost in the queue by a write error
+		thread dThread;
+
+		//only changed by the writer thread (read them after Close())
+		uint32_t dBlockNumber;
+		uint64_t dNumEventsWritten;
+		uint64_t dNumBlocksWritten;
+		uint64_t dNumBytesWritten;
+};
+
+template <typename DEventInfo> class DEVIOSkimRouter
+{
+	public:
+		typedef function<bool(const DEventInfo&)> DPredicate;
+
+		DEVIOSkimRouter(size_t locMaxQueueSize = 200, uint32_t locEventsPerBlock = 100) :
+			dMaxQueueSize(locMaxQueueSize), dEventsPerBlock(locEventsPerBlock) {}
+		~DEVIOSkimRouter(void){Close();}
+
+		// Returns false if the output file can't be opened
+		bool Add_Skim(string locName, string locFileName, DPredicate locPredicate);
+
+		// Returns the number of skims that selected the event. locMakeBuffer (DEVIOSkimBuffer(void)) is only called
+		// if there is at least one.
+		template <typename DMakeBuffer> size_t Route(const DEventInfo& locInfo, DMakeBuffer locMakeBuffer);
+
+		void Close(void);
+		void Print_Summary(ostream& locStream) const;
+
+		size_t Get_NumSkims(void) const{return dSkims.size();}
+		uint64_t Get_NumSelected(size_t locSkimIndex) const{return dSkims[locSkimIndex].dNumSelected;}
+
+		// Events that were selected but not written (summed over the output files), and whether any file had an error
+		uint64_t Get_NumDropped(void) const;
+		bool Has_Error(void) const;
+
+	private:
+		class DSkim
+		{
+			public:
+				string dName;
+				DPredicate dPredicate;
+				size_t dSinkIndex;
+				uint64_t dNumSelected;
+		};
+
+		size_t dMaxQueueSize;
+		uint32_t dEventsPerBlock;
+		vector<DSkim> dSkims;
+		vector<shared_ptr<DEVIOSkimSink> > dSinks;
+		vector<char> dSinkSelected; //per sink, for the event being routed
+};
+
+/************************************************************** DEVIOSkimSink **************************************************************/
+
+inline DEVIOSkimSink::DEVIOSkimSink(string locFileName, size_t locMaxQueueSize, uint32_t locEventsPerBlock,
+		uint32_t locMaxBlockWords, uint32_t locMaxHoldTime) :
+	dFileName(locFileName), dFileDescriptor(-1), dMaxQueueSize(max(locMaxQueueSize, size_t(1))),
+	dEventsPerBlock(max(locEventsPerBlock, uint32_t(1))), dMaxBlockWords(locMaxBlockWords), dMaxHoldTime(locMaxHoldTime),
+	dFlushSize(min(dMaxQueueSize, size_t(dEventsPerBlock))), dQueuedWords(0), dIsClosed(false), dHasError(false), dNumEventsDropped(0), dBlockNumber(0), dNumEventsWritten(0), dNumBlocksWritten(0),
+	dNumBytesWritten(0)
+{
+	dFileDescriptor = open(dFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(dFileDescriptor < 0)
+	{
+		cerr << "Unable to open EVIO output file \"" << dFileName << "\": " << strerror(errno) << endl;
+		dIsClosed = true;
+		return;
+	}
+	dThread = thread(&DEVIOSkimSink::Write_Thread, this);
+}
+
+inline bool DEVIOSkimSink::Add_Buffer(const DEVIOSkimBuffer& locBuffer)
+{
+	unique_lock<mutex> locLock(dMutex);
+	dNotFull.wait(locLock, [this]{return dIsClosed || dHasError || (dQueue.size() < dMaxQueueSize);});
+	if(dIsClosed || dHasError)
+	{
+		++dNumEventsDropped;
+		return false;
+	}
+
+	if(dQueue.empty())
+		dOldestTime = chrono::steady_clock::now();
+	dQueue.push_back(locBuffer);
+	dQueuedWords += locBuffer->size();
+	//wake the writer to write the block, or to start timing the hold of the first event
+	bool locWakeWriter = (dQueue.size() == 1) || (dQueue.size() >= dFlushSize) || ((dQueuedWords + 8) >= dMaxBlockWords);
+	locLock.unlock();
+
+	if(locWakeWriter)
+		dNotEmpty.notify_one();
+	return true;
+}
+
+inline void DEVIOSkimSink::Close(void)
+{
+	{
+		lock_guard<mutex> locLock(dMutex);
+		dIsClosed = true;
+	}
+	dNotEmpty.notify_all();
+	dNotFull.notify_all();
+	if(dThread.joinable())
+		dThread.join();
+
+	if(dFileDescriptor < 0)
+		return;
+
+	// Write out just an EVIO block header to specify end-of-file
+	deque<DEVIOSkimBuffer> locNoBuffers;
+	bool locWriteOK = Write_Block(locNoBuffers, 8);
+	if(close(dFileDescriptor) != 0)
+	{
+		cerr << "Error closing EVIO output file \"" << dFileName << "\": " << strerror(errno) << endl;
+		locWriteOK = false;
+	}
+	dFileDescriptor = -1;
+	if(!locWriteOK)
+	{
+		lock_guard<mutex> locLock(dMutex);
+		dHasError = true;
+	}
+}
+
+inline void DEVIOSkimSink::Write_Thread(void)
+{
+	deque<DEVIOSkimBuffer> locBlockBuffers;
+	while(true)
+	{
+		uint32_t locNumWords = 8; //block header
+		{
+			unique_lock<mutex> locLock(dMutex);
+
+			// Wait until a block is full, the first event has been held long enough, or the sink is closed
+			while(true)
+			{
+				if(dIsClosed || (dQueue.size() >= dFlushSize) || ((dQueuedWords + 8) >= dMaxBlockWords))
+					break;
+				if(dQueue.empty())
+					dNotEmpty.wait(locLock);
+				else if(dNotEmpty.wait_until(locLock, dOldestTime + dMaxHoldTime) == cv_status::timeout)
+					break;
+			}
+			if(dQueue.empty()) //closed
+				return;
+
+			// Take as many events as fit into one block (at least one, even if it is huge)
+			while(!dQueue.empty() && (locBlockBuffers.size() < dEventsPerBlock))
+			{
+				uint32_t locEventWords = dQueue.front()->size();
+				if(!locBlockBuffers.empty() && ((locNumWords + locEventWords) > dMaxBlockWords))
+					break;
+				locNumWords += locEventWords;
+				dQueuedWords -= locEventWords;
+				locBlockBuffers.push_back(std::move(dQueue.front()));
+				dQueue.pop_front();
+			}
+			if(!dQueue.empty())
+				dOldestTime = chrono::steady_clock::now();
+		}
+		dNotFull.notify_all();
+
+		if(!Write_Block(locBlockBuffers, locNumWords))
+		{
+			lock_guard<mutex> locLock(dMutex);
+			dHasError = true;
+			dNumEventsDropped += locBlockBuffers.size() + dQueue.size();
+			dQueue.clear();
+			dQueuedWords = 0;
+			dNotFull.notify_all();
+			return;
+		}
+		locBlockBuffers.clear(); //release the handles: the last sink to write a buffer frees it
+	}
+}
+
+inline bool DEVIOSkimSink::Write_Block(deque<DEVIOSkimBuffer>& locBuffers, uint32_t locNumWords)
+{
+	// EVIO version 4 block header, as written by HDEVIOWriter: see the notes there on the bit info word.
+	uint32_t locBitInfo = (1<<9) + (1<<10); // (1<<9)=Last event in ET stack, (1<<10)="Physics" payload
+	uint32_t locHeader[8];
+	locHeader[0] = htonl(locNumWords); // Number of 32 bit words in evio block, (already includes 8 for block header)
+	locHeader[1] = htonl(++dBlockNumber); // Block number
+	locHeader[2] = htonl(8); // Length of block header (words)
+	locHeader[3] = htonl(locBuffers.size()); // Event Count
+	locHeader[4] = 0; // Reserved 1
+	locHeader[5] = htonl((locBitInfo<<8) + 0x4); //  0x4=EVIO version 4
+	locHeader[6] = 0; // Reserved 2
+	locHeader[7] = htonl(0xc0da0100); // Magic number
+
+	vector<iovec> locIOVecs;
+	locIOVecs.reserve(locBuffers.size() + 1);
+	locIOVecs.push_back(iovec{locHeader, sizeof(locHeader)});
+	for(auto& locBuffer : locBuffers)
+		locIOVecs.push_back(iovec{const_cast<uint32_t*>(locBuffer->data()), locBuffer->size()*sizeof(uint32_t)});
+
+	if(!Write_IOVecs(locIOVecs))
+	{
+		cerr << "Error writing EVIO block to \"" << dFileName << "\": " << strerror(errno) << endl;
+		return false;
+	}
+
+	dNumEventsWritten += locBuffers.size();
+	++dNumBlocksWritten;
+	dNumBytesWritten += uint64_t(locNumWords)*sizeof(uint32_t);
+	return true;
+}
+
+inline bool DEVIOSkimSink::Write_IOVecs(vector<iovec>& locIOVecs)
+{
+	// writev() may write fewer bytes than asked for, and takes at most IOV_MAX vectors per call
+	size_t locIndex = 0;
+	while(locIndex < locIOVecs.size())
+	{
+		int locCount = min(locIOVecs.size() - locIndex, size_t(IOV_MAX));
+		ssize_t locNumBytes = writev(dFileDescriptor, &locIOVecs[locIndex], locCount);
+		if(locNumBytes < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return false;
+		}
+
+		// Skip what has been written
+		while((locIndex < locIOVecs.size()) && (size_t(locNumBytes) >= locIOVecs[locIndex].iov_len))
+			locNumBytes -= locIOVecs[locIndex++].iov_len;
+		if(locNumBytes > 0)
+		{
+			locIOVecs[locIndex].iov_base = (char*)locIOVecs[locIndex].iov_base + locNumBytes;
+			locIOVecs[locIndex].iov_len -= locNumBytes;
+		}
+	}
+	return true;
+}
+
+/************************************************************** DEVIOSkimRouter **************************************************************/
+
+template <typename DEventInfo> bool DEVIOSkimRouter<DEventInfo>::Add_Skim(string locName, string locFileName, DPredicate locPredicate)
+{
+	DSkim locSkim;
+	locSkim.dName = locName;
+	locSkim.dPredicate = locPredicate;
+	locSkim.dNumSelected = 0;
+
+	// Skims with the same output file share its sink
+	auto locSinkIterator = find_if(dSinks.begin(), dSinks.end(),
+			[&locFileName](const shared_ptr<DEVIOSkimSink>& locSink){return locSink->Get_FileName() == locFileName;});
+	if(locSinkIterator == dSinks.end())
+	{
+		auto locSink = make_shared<DEVIOSkimSink>(locFileName, dMaxQueueSize, dEventsPerBlock);
+		if(!locSink->Is_Open())
+			return false;
+		locSinkIterator = dSinks.insert(dSinks.end(), locSink);
+		dSinkSelected.push_back(0);
+	}
+	locSkim.dSinkIndex = locSinkIterator - dSinks.begin();
+
+	dSkims.push_back(locSkim);
+	return true;
+}
+
+template <typename DEventInfo> template <typename DMakeBuffer>
+size_t DEVIOSkimRouter<DEventInfo>::Route(const DEventInfo& locInfo, DMakeBuffer locMakeBuffer)
+{
+	size_t locNumSelected = 0;
+	for(auto& locSkim : dSkims)
+	{
+		if(!locSkim.dPredicate(locInfo))
+			continue;
+		++locSkim.dNumSelected;
+		++locNumSelected;
+		dSinkSelected[locSkim.dSinkIndex] = 1;
+	}
+	if(locNumSelected == 0)
+		return 0;
+
+	DEVIOSkimBuffer locBuffer = locMakeBuffer();
+	for(size_t loc_i = 0; loc_i < dSinks.size(); ++loc_i)
+	{
+		if(!dSinkSelected[loc_i])
+			continue;
+		dSinkSelected[loc_i] = 0;
+		if(!dSinks[loc_i]->Add_Buffer(locBuffer)) //counted as dropped by the sink
+		{
+			static bool locWarnedFlag = false;
+			if(!locWarnedFlag)
+				cerr << "Unable to write to EVIO output file \"" << dSinks[loc_i]->Get_FileName() << "\": dropping events for it." << endl;
+			locWarnedFlag = true;
+		}
+	}
+	return locNumSelected;
+}
+
+template <typename DEventInfo> void DEVIOSkimRouter<DEventInfo>::Close(void)
+{
+	for(auto& locSink : dSinks)
+		locSink->Close();
+}
+
+template <typename DEventInfo> uint64_t DEVIOSkimRouter<DEventInfo>::Get_NumDropped(void) const
+{
+	uint64_t locNumDropped = 0;
+	for(auto& locSink : dSinks)
+		locNumDropped += locSink->Get_NumEventsDropped();
+	return locNumDropped;
+}
+
+template <typename DEventInfo> bool DEVIOSkimRouter<DEventInfo>::Has_Error(void) const
+{
+	for(auto& locSink : dSinks)
+	{
+		if(locSink->Has_Error())
+			return true;
+	}
+	return false;
+}
+
+template <typename DEventInfo> void DEVIOSkimRouter<DEventInfo>::Print_Summary(ostream& locStream) const
+{
+	for(auto& locSkim : dSkims)
+	{
+		const shared_ptr<DEVIOSkimSink>& locSink = dSinks[locSkim.dSinkIndex];
+		locStream << setw(20) << locSkim.dName << ": " << setw(10) << locSkim.dNumSelected << " events selected -> "
+				<< locSink->Get_FileName() << " (" << locSink->Get_NumEventsWritten() << " events in "
+				<< locSink->Get_NumBlocksWritten() << " blocks";
+		if(locSink->Get_NumEventsDropped() > 0)
+			locStream << ", " << locSink->Get_NumEventsDropped() << " events DROPPED";
+		locStream << ")" << endl;
+	}
+}
+
+#endif // _DEVIOSkimRouter_
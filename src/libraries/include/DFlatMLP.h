@@ -0,0 +1,164 @@
+#ifndef _DFlatMLP_
+#define _DFlatMLP_
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+/// Feed-forward neural network (TMVA MethodMLP) in flat weight arrays,
+/// evaluated without ROOT and without per-call heap allocations.
+///
+/// The inputs are first normalized to [-1, 1] as by TMVA's "N" variable
+/// transformation, then propagated through the layers, each of which has a
+/// bias input (value 1) after its regular inputs, as in the TMVA network and
+/// its MakeClass() code. The events are evaluated in blocks: the weighted sums
+/// are loops over the events of the block (vectorized by the compiler), with
+/// the terms added in the same order as in the TMVA code, so the results agree
+/// with it up to the rounding of fused multiply-adds.
+class DFlatMLP
+{
+	public:
+		enum activation_t {kLinear, kSigmoid, kTanh, kRadial};
+
+		DFlatMLP(void) : dNumInputs(0) {}
+
+		// Input normalization: x -> (x - min)*(1/(max - min))*2 - 1
+		void Set_InputNormalization(const vector<double>& locMins, const vector<double>& locMaxs);
+
+		// Next layer: locWeights[output*(num_inputs + 1) + input], where input num_inputs is the bias
+		// The inputs of the first layer must have been set with Set_InputNormalization()
+		bool Add_Layer(size_t locNumOutputs, const vector<double>& locWeights, activation_t locActivation);
+
+		size_t Get_NumInputs(void) const{return dNumInputs;}
+
+		// Response of one event
+		double Evaluate(const double* locInputs) const;
+		// Responses of locNumEvents events: locInputs[event*Get_NumInputs() + input]
+		void Evaluate(const double* locInputs, size_t locNumEvents, double* locOutputs) const;
+
+	private:
+		enum{kBlockSize = 16, kMaxNeurons = 64};
+
+		static double Activate(double locX, activation_t locActivation);
+
+		size_t dNumInputs;
+		vector<double> dInputOffsets;
+		vector<double> dInputScales;
+
+		vector<size_t> dLayerSizes; //inputs of the first layer, then the outputs of each layer
+		vector<activation_t> dActivations;
+		vector<vector<double> > dWeights;
+};
+
+inline void DFlatMLP::Set_InputNormalization(const vector<double>& locMins, const vector<double>& locMaxs)
+{
+	dNumInputs = min(locMins.size(), locMaxs.size());
+	dInputOffsets.resize(dNumInputs);
+	dInputScales.resize(dNumInputs);
+	for(size_t loc_i = 0; loc_i < dNumInputs; ++loc_i)
+	{
+		dInputOffsets[loc_i] = locMins[loc_i];
+		dInputScales[loc_i] = 1.0/(locMaxs[loc_i] - locMins[loc_i]);
+	}
+	dLayerSizes.assign(1, dNumInputs);
+	dActivations.clear();
+	dWeights.clear();
+}
+
+inline bool DFlatMLP::Add_Layer(size_t locNumOutputs, const vector<double>& locWeights, activation_t locActivation)
+{
+	if(dLayerSizes.empty() || (dLayerSizes.back() > kMaxNeurons) || (locNumOutputs > kMaxNeurons))
+		return false;
+	if(locWeights.size() != locNumOutputs*(dLayerSizes.back() + 1))
+		return false;
+	dLayerSizes.push_back(locNumOutputs);
+	dActivations.push_back(locActivation);
+	dWeights.push_back(locWeights);
+	return true;
+}
+
+inline double DFlatMLP::Activate(double locX, activation_t locActivation)
+{
+	switch(locActivation)
+	{
+		case kSigmoid:
+			return 1.0/(1.0 + exp(-locX));
+		case kTanh:
+			return tanh(locX);
+		case kRadial:
+			return exp(-locX*locX/2.0);
+		default:
+			return locX;
+	}
+}
+
+inline double DFlatMLP::Evaluate(const double* locInputs) const
+{
+	double locOutput;
+	Evaluate(locInputs, 1, &locOutput);
+	return locOutput;
+}
+
+inline void DFlatMLP::Evaluate(const double* locInputs, size_t locNumEvents, double* locOutputs) const
+{
+	if(dWeights.empty())
+	{
+		for(size_t loc_i = 0; loc_i < locNumEvents; ++loc_i)
+			locOutputs[loc_i] = 0.0;
+		return;
+	}
+
+	// Neuron values of the current and next layer: [neuron][event in block], the last used neuron is the bias
+	double locValues[2][kMaxNeurons + 1][kBlockSize];
+	for(size_t locFirstEvent = 0; locFirstEvent < locNumEvents; locFirstEvent += kBlockSize)
+	{
+		size_t locNumBlockEvents = min(size_t(kBlockSize), locNumEvents - locFirstEvent);
+		const double* locBlockInputs = locInputs + locFirstEvent*dNumInputs;
+
+		// Normalized inputs; the unused slots of the last block repeat its last event
+		for(size_t loc_j = 0; loc_j < dNumInputs; ++loc_j)
+		{
+			for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+			{
+				double locX = locBlockInputs[min(loc_i, locNumBlockEvents - 1)*dNumInputs + loc_j];
+				locValues[0][loc_j][loc_i] = (locX - dInputOffsets[loc_j])*dInputScales[loc_j]*2 - 1;
+			}
+		}
+
+		size_t locCurrent = 0;
+		for(size_t locLayer = 0; locLayer < dWeights.size(); ++locLayer)
+		{
+			size_t locNumLayerInputs = dLayerSizes[locLayer];
+			size_t locNumLayerOutputs = dLayerSizes[locLayer + 1];
+			double (*locIn)[kBlockSize] = locValues[locCurrent];
+			double (*locOut)[kBlockSize] = locValues[1 - locCurrent];
+			for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+				locIn[locNumLayerInputs][loc_i] = 1.0;
+
+			const double* locWeights = dWeights[locLayer].data();
+			for(size_t locOutput = 0; locOutput < locNumLayerOutputs; ++locOutput)
+			{
+				const double* locOutputWeights = locWeights + locOutput*(locNumLayerInputs + 1);
+				double locSums[kBlockSize];
+				for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+					locSums[loc_i] = 0.0;
+				for(size_t loc_j = 0; loc_j <= locNumLayerInputs; ++loc_j)
+				{
+					double locWeight = locOutputWeights[loc_j];
+					for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+						locSums[loc_i] += locWeight*locIn[loc_j][loc_i];
+				}
+				for(size_t loc_i = 0; loc_i < kBlockSize; ++loc_i)
+					locOut[locOutput][loc_i] = (loc_i < locNumBlockEvents) ? Activate(locSums[loc_i], dActivations[locLayer]) : 0.0;
+			}
+			locCurrent = 1 - locCurrent;
+		}
+
+		for(size_t loc_i = 0; loc_i < locNumBlockEvents; ++loc_i)
+			locOutputs[locFirstEvent + loc_i] = locValues[locCurrent][0][loc_i];
+	}
+}
+
+#endif // _DFlatMLP_
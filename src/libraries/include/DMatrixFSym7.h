@@ -0,0 +1,75 @@
+// $Id$
+//
+//    File: DMatrixFSym7.h
+//
+
+#ifndef _DMatrixFSym7_
+#define _DMatrixFSym7_
+
+#include <TMatrixFSym.h>
+
+// Fixed-size symmetric 7x7 matrix of floats, stored packed (lower triangle,
+// 28 elements), used for the (px, py, pz, x, y, z, t) covariance matrices of
+// the kinematic objects. It is a plain value type: no heap allocation, no
+// virtual table, and it is copied along with the object that holds it.
+//
+// Element access follows TMatrixFSym: m(i,j) and m(j,i) are the same element.
+// For code that needs ROOT's matrix algebra, the matrix converts to and from
+// a 7x7 TMatrixFSym; the values are identical (both are float).
+
+class DMatrixFSym7{
+ public:
+  enum{kRows=7, kSize=28};
+
+  DMatrixFSym7(){Zero();}
+  template <class T> explicit DMatrixFSym7(const TMatrixTSym<T> &m){Zero(); Set(m);}
+
+  // Access by row and column
+  float &operator() (int row, int col){
+    return mA[Index(row,col)];
+  }
+  float operator() (int row, int col) const{
+    return mA[Index(row,col)];
+  }
+  int GetNrows(void) const{return kRows;}
+  int GetNcols(void) const{return kRows;}
+
+  void Zero(void){
+    for (int i=0;i<kSize;i++) mA[i]=0.;
+  }
+
+  // Copy the leading 7x7 block of a (symmetric) ROOT matrix, float or
+  // double; returns false (leaving the matrix unchanged) if it has fewer
+  // than 7 rows.
+  template <class T> bool Set(const TMatrixTSym<T> &m){
+    if (m.GetNrows()<kRows) return false;
+    for (int i=0;i<kRows;i++){
+      for (int j=0;j<=i;j++) mA[Index(i,j)]=static_cast<float>(m(i,j));
+    }
+    return true;
+  }
+
+  // Fill a ROOT matrix (resized to 7x7 if needed)
+  void Get(TMatrixFSym &m) const{
+    if (m.GetNrows()!=kRows) m.ResizeTo(kRows,kRows);
+    for (int i=0;i<kRows;i++){
+      for (int j=0;j<=i;j++) m(i,j)=m(j,i)=mA[Index(i,j)];
+    }
+  }
+
+  // Conversion shim for code written against TMatrixFSym
+  operator TMatrixFSym() const{
+    TMatrixFSym m(kRows);
+    Get(m);
+    return m;
+  }
+
+ private:
+  static int Index(int row,int col){
+    return (row>=col) ? row*(row+1)/2+col : col*(col+1)/2+row;
+  }
+
+  float mA[kSize];
+};
+
+#endif // _DMatrixFSym7_
@@ -0,0 +1,486 @@
+#ifndef _DMilleWriter_
+#define _DMilleWriter_
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+/****************************************************** OVERVIEW ******************************************************
+ *
+ * Writes Millepede-II C-binary files (the input of pede) from several threads, without serializing them. It replaces
+ * the Mille class of the Millepede-II distribution in the alignment plugins (MilleFieldOn, MilleFieldOff).
+ *
+ * Each thread fills its own DMilleRecordBuilder, which has the interface of Mille (mille(), special(), kill(), end()).
+ * A record (the measurements of one track) is collected column-wise, floats and ints separately, as it is written. On
+ * end() it is appended to the thread's batch buffer: a contiguous array of 32-bit words holding many records, each in
+ * the Mille binary format: the number of words (2*N), the N floats and the N ints. Once the batch holds BATCH_SIZE bytes
+ * it is handed to DMilleWriter, and the thread continues with an empty batch from the writer's pool.
+ *
+ * DMilleWriter has one writer thread that writes the batches with a single write() each, in the order it gets them, and
+ * gives the emptied buffers back to the pool. Its queue holds at most MAX_QUEUED_BATCHES batches: the threads filling
+ * it block while it is full. Records of different threads are interleaved batch-wise, which doesn't matter to pede.
+ *
+ * With shards, each thread's records go to a file of its own, named after the output file with "_tNN" added before the
+ * extension. As the format has no file header, the shards can be given to pede together or concatenated afterwards:
+ *
+ *   cat fieldon_mille_out_t*.mil > fieldon_mille_out.mil
+ *
+ * The files are written in the native byte order, as Mille does.
+ *
+ ************************************************************ USE ************************************************************
+ *
+ * DMilleWriter* locWriter = new DMilleWriter("mille_out.mil"); //in init()
+ *
+ * DMilleRecordBuilder& locMille = locWriter->Get_Builder(); //per event: the builder of this thread
+ * locMille.mille(NLC, derLc, NGL, derGl, label, rMeas, sigma); //per measurement
+ * locMille.end(); //per track
+ *
+ * locWriter->Close(); //in fini(): writes the partly filled batches of all threads and closes the files
+ *
+ ************************************************************************************************************************/
+
+class DMilleWriter;
+
+class DMilleRecordBuilder
+{
+	friend class DMilleWriter;
+
+	public:
+		void mille(int NLC, const float* derLc, int NGL, const float* derGl, const int* label, float rMeas, float sigma);
+		void special(int nSpecial, const float* floatings, const int* integers);
+		void kill(void){dInRecord = false;}
+		void end(void);
+
+	private:
+		DMilleRecordBuilder(DMilleWriter* locWriter, size_t locShard, bool locWriteZero);
+		~DMilleRecordBuilder(void);
+
+		void New_Record(void);
+		bool Check_RecordSize(int locNumLocal, int locNumGlobal);
+		void Add_Word(float locFloat, int32_t locInt){dFloats.push_back(locFloat); dInts.push_back(locInt);}
+		void Flush(void);
+
+		// largest label allowed: 2^31 - 1; largest record: as in Mille
+		enum {dMaxLabel = 0x7FFFFFFF, dMaxRecordSize = 15000};
+
+		DMilleWriter* dWriter;
+		size_t dShard;
+		bool dWriteZero; //if true also write out derivatives/labels == 0
+
+		// Record being built: position 0 is the error counter
+		vector<float> dFloats;
+		vector<int32_t> dInts;
+		bool dInRecord;
+		bool dHasSpecial; //if true, special() already called for this record
+
+		vector<int32_t>* dBatch; //complete records, not yet handed to the writer
+		uint64_t dNumRecords;
+};
+
+class DMilleWriter
+{
+	friend class DMilleRecordBuilder;
+
+	public:
+		DMilleWriter(string locFileName, bool locUseShards = false, size_t locBatchSize = 4*1024*1024,
+				size_t locMaxQueuedBatches = 16, bool locWriteZero = false);
+		~DMilleWriter(void);
+
+		bool Is_Open(void) const{return !dHasError;}
+
+		// The record builder of the calling thread (made the first time it asks)
+		DMilleRecordBuilder& Get_Builder(void);
+
+		// Writes the partly filled batches of all threads, joins the writer thread and closes the files.
+		// The builders may not be used anymore, nor from the time it is called.
+		void Close(void);
+
+		vector<string> Get_FileNames(void) const{return dFileNames;}
+		uint64_t Get_NumRecordsWritten(void) const{return dNumRecordsWritten;}
+		uint64_t Get_NumBatchesWritten(void) const{return dNumBatchesWritten;}
+		uint64_t Get_NumBytesWritten(void) const{return dNumBytesWritten;}
+
+	private:
+		class DBatch
+		{
+			public:
+				size_t dShard;
+				vector<int32_t>* dWords;
+				uint64_t dNumRecords;
+		};
+
+		string Get_ShardFileName(size_t locShard) const;
+		int Open_File(string locFileName);
+
+		// Called by the builders
+		vector<int32_t>* Get_EmptyBatch(void);
+		void Add_Batch(size_t locShard, vector<int32_t>* locWords, uint64_t locNumRecords);
+
+		void Write_Thread(void);
+		bool Write_Words(int locFileDescriptor, const vector<int32_t>& locWords);
+
+		string dFileName;
+		bool dUseShards;
+		size_t dBatchSize; //bytes
+		size_t dMaxQueuedBatches;
+		bool dWriteZero;
+
+		mutex dMutex;
+		condition_variable dNotFull;
+		condition_variable dNotEmpty;
+		map<thread::id, DMilleRecordBuilder*> dBuilders;
+		vector<int> dFileDescriptors; //per shard
+		vector<string> dFileNames; //per shard
+		deque<DBatch> dQueue;
+		vector<vector<int32_t>*> dPool; //empty batch buffers
+		bool dIsClosed;
+		bool dHasError;
+		thread dThread;
+
+		//only changed by the writer thread (read them after Close())
+		uint64_t dNumRecordsWritten;
+		uint64_t dNumBatchesWritten;
+		uint64_t dNumBytesWritten;
+};
+
+/************************************************************** DMilleRecordBuilder **************************************************************/
+
+inline DMilleRecordBuilder::DMilleRecordBuilder(DMilleWriter* locWriter, size_t locShard, bool locWriteZero) :
+	dWriter(locWriter), dShard(locShard), dWriteZero(locWriteZero), dInRecord(false), dHasSpecial(false), dBatch(NULL), dNumRecords(0)
+{
+	dFloats.reserve(dMaxRecordSize);
+	dInts.reserve(dMaxRecordSize);
+}
+
+inline DMilleRecordBuilder::~DMilleRecordBuilder(void)
+{
+	delete dBatch;
+}
+
+inline void DMilleRecordBuilder::New_Record(void)
+{
+	dFloats.assign(1, 0.0);
+	dInts.assign(1, 0); //position 0 used as error counter
+	dInRecord = true;
+	dHasSpecial = false;
+}
+
+inline bool DMilleRecordBuilder::Check_RecordSize(int locNumLocal, int locNumGlobal)
+{
+	// Enough space for next locNumLocal + locNumGlobal derivatives incl. measurement?
+	if((dFloats.size() - 1 + locNumLocal + locNumGlobal + 2) < dMaxRecordSize)
+		return true;
+
+	++dInts[0]; //increase error count
+	cerr << "DMilleRecordBuilder: Record too long (" << dMaxRecordSize << "), need space for nLocal (" << locNumLocal
+			<< ")/nGlobal (" << locNumGlobal << ") local/global derivatives, " << dFloats.size() << " already stored!" << endl;
+	return false;
+}
+
+inline void DMilleRecordBuilder::mille(int NLC, const float* derLc, int NGL, const float* derGl, const int* label, float rMeas, float sigma)
+{
+	if(sigma <= 0.)
+		return;
+	if(!dInRecord)
+		New_Record(); //start, e.g. new track
+	if(!Check_RecordSize(NLC, NGL))
+		return;
+
+	// first store measurement
+	Add_Word(rMeas, 0);
+
+	// store local derivatives and local 'labels' 1,...,NLC (by default only non-zero derivatives)
+	for(int loc_i = 0; loc_i < NLC; ++loc_i)
+	{
+		if(derLc[loc_i] || dWriteZero)
+			Add_Word(derLc[loc_i], loc_i + 1);
+	}
+
+	// store uncertainty of measurement in between locals and globals
+	Add_Word(sigma, 0);
+
+	// store global derivatives and their labels
+	for(int loc_i = 0; loc_i < NGL; ++loc_i)
+	{
+		if(!derGl[loc_i] && !dWriteZero)
+			continue;
+		if((label[loc_i] > 0 || dWriteZero) && (label[loc_i] <= dMaxLabel))
+			Add_Word(derGl[loc_i], label[loc_i]);
+		else
+			cerr << "DMilleRecordBuilder::mille: Invalid label " << label[loc_i] << " <= 0 or > " << dMaxLabel << endl;
+	}
+}
+
+inline void DMilleRecordBuilder::special(int nSpecial, const float* floatings, const int* integers)
+{
+	if(nSpecial == 0)
+		return;
+	if(!dInRecord)
+		New_Record(); //start, e.g. new track
+	if(dHasSpecial)
+	{
+		cerr << "DMilleRecordBuilder::special: Special values already stored for this record." << endl;
+		return;
+	}
+	if(!Check_RecordSize(nSpecial, 0))
+		return;
+	dHasSpecial = true;
+
+	// A (0.0, 0) pair followed by (-nSpecial, 0) indicates special data: nSpecial floats and ints follow
+	Add_Word(0.0, 0);
+	Add_Word(-nSpecial, 0);
+	for(int loc_i = 0; loc_i < nSpecial; ++loc_i)
+		Add_Word(floatings[loc_i], integers[loc_i]);
+}
+
+inline void DMilleRecordBuilder::end(void)
+{
+	// Append the record (set of derivatives with the same local parameters) to the batch
+	if(dInRecord && (dFloats.size() > 1)) //only if anything stored...
+	{
+		if(dBatch == NULL)
+			dBatch = dWriter->Get_EmptyBatch();
+
+		size_t locNumWords = dFloats.size();
+		size_t locPosition = dBatch->size();
+		dBatch->resize(locPosition + 1 + 2*locNumWords);
+		int32_t* locRecord = &(*dBatch)[locPosition];
+		locRecord[0] = 2*locNumWords;
+		memcpy(locRecord + 1, dFloats.data(), locNumWords*sizeof(float));
+		memcpy(locRecord + 1 + locNumWords, dInts.data(), locNumWords*sizeof(int32_t));
+		++dNumRecords;
+
+		if(dBatch->size()*sizeof(int32_t) >= dWriter->dBatchSize)
+			Flush();
+	}
+	dInRecord = false; //reset for next set of derivatives
+}
+
+inline void DMilleRecordBuilder::Flush(void)
+{
+	if((dBatch == NULL) || dBatch->empty())
+		return;
+	dWriter->Add_Batch(dShard, dBatch, dNumRecords);
+	dBatch = NULL;
+	dNumRecords = 0;
+}
+
+/************************************************************** DMilleWriter **************************************************************/
+
+inline DMilleWriter::DMilleWriter(string locFileName, bool locUseShards, size_t locBatchSize, size_t locMaxQueuedBatches, bool locWriteZero) :
+	dFileName(locFileName), dUseShards(locUseShards), dBatchSize(max(locBatchSize, size_t(1))), dMaxQueuedBatches(max(locMaxQueuedBatches, size_t(1))),
+	dWriteZero(locWriteZero), dIsClosed(false), dHasError(false), dNumRecordsWritten(0), dNumBatchesWritten(0), dNumBytesWritten(0)
+{
+	// Without shards, all threads write to shard 0. The shard files are opened as the threads show up.
+	if(!dUseShards)
+	{
+		dFileDescriptors.push_back(Open_File(dFileName));
+		dFileNames.push_back(dFileName);
+		if(dFileDescriptors[0] < 0)
+		{
+			dHasError = true;
+			return;
+		}
+	}
+	dThread = thread(&DMilleWriter::Write_Thread, this);
+}
+
+inline DMilleWriter::~DMilleWriter(void)
+{
+	Close();
+	for(auto& locBuilderPair : dBuilders)
+		delete locBuilderPair.second;
+	for(auto& locWords : dPool)
+		delete locWords;
+}
+
+inline string DMilleWriter::Get_ShardFileName(size_t locShard) const
+{
+	char locSuffix[16];
+	snprintf(locSuffix, sizeof(locSuffix), "_t%02d", int(locShard));
+
+	// Insert before the extension (if any, and not in a directory name)
+	size_t locDotIndex = dFileName.find_last_of(".");
+	size_t locSlashIndex = dFileName.find_last_of("/");
+	if((locDotIndex == string::npos) || ((locSlashIndex != string::npos) && (locDotIndex < locSlashIndex)))
+		return dFileName + locSuffix;
+	return dFileName.substr(0, locDotIndex) + locSuffix + dFileName.substr(locDotIndex);
+}
+
+inline int DMilleWriter::Open_File(string locFileName)
+{
+	int locFileDescriptor = open(locFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(locFileDescriptor < 0)
+		cerr << "DMilleWriter: Could not open " << locFileName << " as output file: " << strerror(errno) << endl;
+	return locFileDescriptor;
+}
+
+inline DMilleRecordBuilder& DMilleWriter::Get_Builder(void)
+{
+	lock_guard<mutex> locLock(dMutex);
+	DMilleRecordBuilder*& locBuilder = dBuilders[this_thread::get_id()];
+	if(locBuilder != NULL)
+		return *locBuilder;
+
+	size_t locShard = 0;
+	if(dUseShards)
+	{
+		locShard = dFileDescriptors.size();
+		dFileNames.push_back(Get_ShardFileName(locShard));
+		dFileDescriptors.push_back(Open_File(dFileNames.back()));
+	}
+	locBuilder = new DMilleRecordBuilder(this, locShard, dWriteZero);
+	return *locBuilder;
+}
+
+inline vector<int32_t>* DMilleWriter::Get_EmptyBatch(void)
+{
+	{
+		lock_guard<mutex> locLock(dMutex);
+		if(!dPool.empty())
+		{
+			vector<int32_t>* locWords = dPool.back();
+			dPool.pop_back();
+			return locWords;
+		}
+	}
+	vector<int32_t>* locWords = new vector<int32_t>();
+	locWords->reserve(dBatchSize/sizeof(int32_t) + 1 + 2*DMilleRecordBuilder::dMaxRecordSize); //a record may go beyond the batch size
+	return locWords;
+}
+
+inline void DMilleWriter::Add_Batch(size_t locShard, vector<int32_t>* locWords, uint64_t locNumRecords)
+{
+	unique_lock<mutex> locLock(dMutex);
+	dNotFull.wait(locLock, [this]{return dIsClosed || dHasError || (dQueue.size() < dMaxQueuedBatches);});
+	if(dIsClosed || dHasError || (dFileDescriptors[locShard] < 0))
+	{
+		// Can't be written: recycle the buffer
+		locWords->clear();
+		dPool.push_back(locWords);
+		return;
+	}
+
+	DBatch locBatch;
+	locBatch.dShard = locShard;
+	locBatch.dWords = locWords;
+	locBatch.dNumRecords = locNumRecords;
+	dQueue.push_back(locBatch);
+	locLock.unlock();
+
+	dNotEmpty.notify_one();
+}
+
+inline void DMilleWriter::Close(void)
+{
+	// Hand over the partly filled batches. The writer thread is still running, so this may block on a full queue.
+	{
+		unique_lock<mutex> locLock(dMutex);
+		if(dIsClosed)
+			return;
+		vector<DMilleRecordBuilder*> locBuilders;
+		for(auto& locBuilderPair : dBuilders)
+			locBuilders.push_back(locBuilderPair.second);
+		locLock.unlock();
+
+		for(auto& locBuilder : locBuilders)
+			locBuilder->Flush();
+
+		locLock.lock();
+		dIsClosed = true;
+	}
+	dNotEmpty.notify_all();
+	dNotFull.notify_all();
+	if(dThread.joinable())
+		dThread.join();
+
+	for(auto& locFileDescriptor : dFileDescriptors)
+	{
+		if(locFileDescriptor >= 0)
+			close(locFileDescriptor);
+		locFileDescriptor = -1;
+	}
+}
+
+inline void DMilleWriter::Write_Thread(void)
+{
+	while(true)
+	{
+		DBatch locBatch;
+		int locFileDescriptor = -1;
+		{
+			unique_lock<mutex> locLock(dMutex);
+			dNotEmpty.wait(locLock, [this]{return dIsClosed || !dQueue.empty();});
+			if(dQueue.empty()) //closed
+				return;
+			locBatch = dQueue.front();
+			dQueue.pop_front();
+			locFileDescriptor = dFileDescriptors[locBatch.dShard];
+		}
+		dNotFull.notify_all();
+
+		bool locSuccess = Write_Words(locFileDescriptor, *locBatch.dWords);
+		int locErrno = errno;
+		if(locSuccess)
+		{
+			dNumRecordsWritten += locBatch.dNumRecords;
+			++dNumBatchesWritten;
+			dNumBytesWritten += locBatch.dWords->size()*sizeof(int32_t);
+		}
+
+		locBatch.dWords->clear(); //keeps its capacity
+		lock_guard<mutex> locLock(dMutex);
+		dPool.push_back(locBatch.dWords);
+		if(!locSuccess)
+		{
+			// Stop writing: the builders' batches are recycled from now on
+			cerr << "DMilleWriter: Error writing to " << dFileNames[locBatch.dShard] << ": " << strerror(locErrno) << endl;
+			dHasError = true;
+			for(auto& locQueuedBatch : dQueue)
+			{
+				locQueuedBatch.dWords->clear();
+				dPool.push_back(locQueuedBatch.dWords);
+			}
+			dQueue.clear();
+			dNotFull.notify_all();
+			return;
+		}
+	}
+}
+
+inline bool DMilleWriter::Write_Words(int locFileDescriptor, const vector<int32_t>& locWords)
+{
+	// write() may write fewer bytes than asked for
+	const char* locData = reinterpret_cast<const char*>(locWords.data());
+	size_t locNumBytes = locWords.size()*sizeof(int32_t);
+	while(locNumBytes > 0)
+	{
+		ssize_t locNumWritten = write(locFileDescriptor, locData, locNumBytes);
+		if(locNumWritten < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return false;
+		}
+		locData += locNumWritten;
+		locNumBytes -= locNumWritten;
+	}
+	return true;
+}
+
+#endif // _DMilleWriter_
@@ -0,0 +1,346 @@
+#ifndef _DOrderedMerge_
+#define _DOrderedMerge_
+
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+/****************************************************** OVERVIEW ******************************************************
+ *
+ * k-way merge of several record streams (e.g. the partial output files of a run) into one stream that is ordered by
+ * run and event number (or timestamp). It is used by the evio_merge_files and hddm_merge_files programs.
+ *
+ * Each input is read by its own thread, which calls the input's reader function (reading, decompressing and unpacking
+ * the records) and the key function, and fills a bounded queue of prefetched records. The merge itself runs on the
+ * calling thread and passes the records to a writer thread through another bounded queue, so reading, merging and
+ * writing overlap.
+ *
+ * The inputs are expected to be (mostly) ordered themselves. The merge always takes the input whose next record has the
+ * smallest key, and puts it into a lookahead window of up to N records, from which the record with the smallest key is
+ * written. Records that are out of order within an input by fewer than N records are therefore written in order.
+ *
+ * Records that have no number of their own (e.g. control, EPICS or comment events) get the key of the previous record
+ * of their input, and are written after it. Of the records with the same (run, number) only the first one is written
+ * (the one of the earliest input), unless duplicates are kept. The numbers that are skipped between consecutive
+ * records of a run are counted as missing, and records that are still out of order are counted and written anyway.
+ *
+ ************************************************************ USE ************************************************************
+ *
+ * DOrderedMerge<MyRecord> locMerge(locKeyFunction, locWriter);
+ * locMerge.Add_Input(locReader); //one per input
+ * locMerge.Merge();
+ *
+ * The reader (bool(MyRecord&)) returns false at the end of its input; it is only called by its input's thread.
+ * The key function (bool(const MyRecord&, DOrderedMergeKey&)) returns false if the record has no number; it is called
+ * by all input threads and must not change any shared state.
+ * The writer (void(MyRecord&)) is only called by the writer thread.
+ * MyRecord must be default-constructible and movable.
+ *
+ ************************************************************************************************************************/
+
+class DOrderedMergeKey
+{
+	public:
+		DOrderedMergeKey(void) : dRun(0), dNumber(0), dCount(0), dIsSet(false) {}
+		DOrderedMergeKey(uint64_t locRun, uint64_t locNumber, uint64_t locCount = 1) :
+			dRun(locRun), dNumber(locNumber), dCount(locCount), dIsSet(true) {}
+
+		bool operator<(const DOrderedMergeKey& locKey) const
+		{
+			return (dRun != locKey.dRun) ? (dRun < locKey.dRun) : (dNumber < locKey.dNumber);
+		}
+
+		uint64_t dRun;
+		uint64_t dNumber; //event number (or timestamp) of the first event of the record
+		uint64_t dCount; //number of consecutive event numbers in the record: 0 if they aren't counted (e.g. timestamps)
+		bool dIsSet; //false if the key is the one of the previous record of the input
+};
+
+template <typename DType> class DOrderedMergeQueue
+{
+	public:
+		DOrderedMergeQueue(size_t locCapacity) : dCapacity(max(locCapacity, size_t(1))), dIsClosed(false) {}
+
+		// Blocks while the queue is full; returns false if the queue has been closed
+		bool Push(DType&& locItem)
+		{
+			unique_lock<mutex> locLock(dMutex);
+			dNotFull.wait(locLock, [this]{return dIsClosed || (dItems.size() < dCapacity);});
+			if(dIsClosed)
+				return false;
+			dItems.push_back(std::move(locItem));
+			dNotEmpty.notify_one();
+			return true;
+		}
+
+		// Blocks while the queue is empty; returns false once it has been closed and is empty
+		bool Pop(DType& locItem)
+		{
+			unique_lock<mutex> locLock(dMutex);
+			dNotEmpty.wait(locLock, [this]{return dIsClosed || !dItems.empty();});
+			if(dItems.empty())
+				return false;
+			locItem = std::move(dItems.front());
+			dItems.pop_front();
+			dNotFull.notify_one();
+			return true;
+		}
+
+		// No more pushes: the remaining items can still be popped
+		void Close(void)
+		{
+			lock_guard<mutex> locLock(dMutex);
+			dIsClosed = true;
+			dNotFull.notify_all();
+			dNotEmpty.notify_all();
+		}
+
+	private:
+		size_t dCapacity;
+		bool dIsClosed;
+		deque<DType> dItems;
+		mutex dMutex;
+		condition_variable dNotFull;
+		condition_variable dNotEmpty;
+};
+
+template <typename DRecordType> class DOrderedMerge
+{
+	public:
+		typedef function<bool(DRecordType&)> DReader;
+		typedef function<bool(const DRecordType&, DOrderedMergeKey&)> DKeyFunction;
+		typedef function<void(DRecordType&)> DWriter;
+
+		DOrderedMerge(DKeyFunction locKeyFunction, DWriter locWriter) : dKeyFunction(locKeyFunction), dWriter(locWriter),
+			dLookahead(1000), dPrefetchDepth(100), dWriteDepth(1000), dKeepDuplicates(false), dShowTicker(false), dQuitFlag(NULL),
+			dNumRead(0), dNumWritten(0), dNumDuplicates(0), dNumMissing(0), dNumOutOfOrder(0), dHaveLastKey(false) {}
+
+		void Add_Input(DReader locReader){dReaders.push_back(locReader);}
+
+		void Set_Lookahead(size_t locLookahead){dLookahead = locLookahead;} //records in the reordering window
+		void Set_PrefetchDepth(size_t locDepth){dPrefetchDepth = locDepth;} //records read ahead per input
+		void Set_WriteDepth(size_t locDepth){dWriteDepth = locDepth;} //records waiting for the writer
+		void Set_KeepDuplicates(bool locKeepDuplicates){dKeepDuplicates = locKeepDuplicates;}
+		void Set_ShowTicker(bool locShowTicker){dShowTicker = locShowTicker;}
+		void Set_QuitFlag(const int* locQuitFlag){dQuitFlag = locQuitFlag;} //stop reading once *locQuitFlag is non-zero
+
+		// Reads all inputs and writes the merged records; returns when everything has been written
+		void Merge(void);
+
+		uint64_t Get_NumRead(void) const{return dNumRead;}
+		uint64_t Get_NumWritten(void) const{return dNumWritten;}
+		uint64_t Get_NumDuplicates(void) const{return dNumDuplicates;} //not written
+		uint64_t Get_NumMissing(void) const{return dNumMissing;} //event numbers in the gaps
+		uint64_t Get_NumOutOfOrder(void) const{return dNumOutOfOrder;} //written after a larger key
+
+	private:
+		class DEntry
+		{
+			public:
+				DEntry(void) : dInput(0), dSequence(0) {}
+
+				DRecordType dRecord;
+				DOrderedMergeKey dKey;
+				size_t dInput;
+				uint64_t dSequence; //within the input
+		};
+
+		// Heap order: true if locFirst comes after locSecond
+		static bool Is_Later(const DEntry& locFirst, const DEntry& locSecond)
+		{
+			if(locSecond.dKey < locFirst.dKey)
+				return true;
+			if(locFirst.dKey < locSecond.dKey)
+				return false;
+			if(locFirst.dInput != locSecond.dInput)
+				return (locFirst.dInput > locSecond.dInput);
+			return (locFirst.dSequence > locSecond.dSequence);
+		}
+
+		bool Get_Quit(void) const{return (dQuitFlag != NULL) && (*dQuitFlag != 0);}
+		void Read_Input(size_t locInput);
+		void Write_Records(void);
+		void Write_Next(vector<DEntry>& locWindow);
+
+		DKeyFunction dKeyFunction;
+		DWriter dWriter;
+		vector<DReader> dReaders;
+
+		size_t dLookahead;
+		size_t dPrefetchDepth;
+		size_t dWriteDepth;
+		bool dKeepDuplicates;
+		bool dShowTicker;
+		const int* dQuitFlag;
+
+		vector<shared_ptr<DOrderedMergeQueue<DEntry> > > dInputQueues;
+		shared_ptr<DOrderedMergeQueue<DRecordType> > dWriteQueue;
+
+		uint64_t dNumRead;
+		uint64_t dNumWritten;
+		uint64_t dNumDuplicates;
+		uint64_t dNumMissing;
+		uint64_t dNumOutOfOrder;
+		bool dHaveLastKey;
+		DOrderedMergeKey dLastKey;
+};
+
+template <typename DRecordType> void DOrderedMerge<DRecordType>::Read_Input(size_t locInput)
+{
+	DOrderedMergeQueue<DEntry>& locQueue = *dInputQueues[locInput];
+	DOrderedMergeKey locLastKey;
+	uint64_t locSequence = 0;
+	try
+	{
+		while(!Get_Quit())
+		{
+			DEntry locEntry;
+			if(!dReaders[locInput](locEntry.dRecord))
+				break;
+
+			if(dKeyFunction(locEntry.dRecord, locEntry.dKey))
+			{
+				locEntry.dKey.dIsSet = true;
+				locLastKey = locEntry.dKey;
+			}
+			else
+			{
+				locEntry.dKey = locLastKey;
+				locEntry.dKey.dIsSet = false;
+			}
+			locEntry.dInput = locInput;
+			locEntry.dSequence = locSequence++;
+			if(!locQueue.Push(std::move(locEntry)))
+				break;
+		}
+	}
+	catch(exception& locException)
+	{
+		cerr << endl << "Error reading input " << locInput << ": " << locException.what() << endl;
+	}
+	locQueue.Close();
+}
+
+template <typename DRecordType> void DOrderedMerge<DRecordType>::Write_Records(void)
+{
+	DRecordType locRecord;
+	while(dWriteQueue->Pop(locRecord))
+		dWriter(locRecord);
+}
+
+template <typename DRecordType> void DOrderedMerge<DRecordType>::Write_Next(vector<DEntry>& locWindow)
+{
+	pop_heap(locWindow.begin(), locWindow.end(), Is_Later);
+	DEntry locEntry(std::move(locWindow.back()));
+	locWindow.pop_back();
+
+	const DOrderedMergeKey& locKey = locEntry.dKey;
+	if(locKey.dIsSet)
+	{
+		if(!dHaveLastKey || (dLastKey < locKey))
+		{
+			// Gap: the numbers between the end of the previous record and this one
+			if(dHaveLastKey && (locKey.dRun == dLastKey.dRun) && (dLastKey.dCount > 0) && (locKey.dCount > 0))
+			{
+				uint64_t locExpected = dLastKey.dNumber + dLastKey.dCount;
+				if(locKey.dNumber > locExpected)
+					dNumMissing += locKey.dNumber - locExpected;
+			}
+			dLastKey = locKey;
+			dHaveLastKey = true;
+		}
+		else if(locKey < dLastKey)
+			++dNumOutOfOrder;
+		else if(!dKeepDuplicates)
+		{
+			++dNumDuplicates;
+			return;
+		}
+	}
+
+	dWriteQueue->Push(std::move(locEntry.dRecord));
+	++dNumWritten;
+}
+
+template <typename DRecordType> void DOrderedMerge<DRecordType>::Merge(void)
+{
+	dInputQueues.clear();
+	for(size_t loc_i = 0; loc_i < dReaders.size(); ++loc_i)
+		dInputQueues.push_back(make_shared<DOrderedMergeQueue<DEntry> >(dPrefetchDepth));
+	dWriteQueue = make_shared<DOrderedMergeQueue<DRecordType> >(dWriteDepth);
+
+	vector<thread> locReadThreads;
+	for(size_t loc_i = 0; loc_i < dReaders.size(); ++loc_i)
+		locReadThreads.push_back(thread(&DOrderedMerge<DRecordType>::Read_Input, this, loc_i));
+	thread locWriteThread(&DOrderedMerge<DRecordType>::Write_Records, this);
+
+	// Next record of each input, and the lookahead window: both heaps ordered by Is_Later()
+	vector<DEntry> locHeads;
+	for(size_t loc_i = 0; loc_i < dInputQueues.size(); ++loc_i)
+	{
+		DEntry locEntry;
+		if(!dInputQueues[loc_i]->Pop(locEntry))
+			continue;
+		++dNumRead;
+		locHeads.push_back(std::move(locEntry));
+		push_heap(locHeads.begin(), locHeads.end(), Is_Later);
+	}
+
+	vector<DEntry> locWindow;
+	locWindow.reserve(dLookahead + 1);
+	time_t locLastTime = time(NULL);
+	while(!locHeads.empty() && !Get_Quit())
+	{
+		pop_heap(locHeads.begin(), locHeads.end(), Is_Later);
+		size_t locInput = locHeads.back().dInput;
+		locWindow.push_back(std::move(locHeads.back()));
+		locHeads.pop_back();
+		push_heap(locWindow.begin(), locWindow.end(), Is_Later);
+
+		DEntry locEntry;
+		if(dInputQueues[locInput]->Pop(locEntry))
+		{
+			++dNumRead;
+			locHeads.push_back(std::move(locEntry));
+			push_heap(locHeads.begin(), locHeads.end(), Is_Later);
+		}
+
+		if(locWindow.size() > dLookahead)
+			Write_Next(locWindow);
+
+		if(dShowTicker)
+		{
+			time_t locNow = time(NULL);
+			if(locNow != locLastTime)
+			{
+				cout << "  " << dNumRead << " events read     (" << dNumWritten << " events written) \r";
+				cout.flush();
+				locLastTime = locNow;
+			}
+		}
+	}
+
+	// Stop the readers if quitting, then write what has been read
+	for(size_t loc_i = 0; loc_i < dInputQueues.size(); ++loc_i)
+		dInputQueues[loc_i]->Close();
+	for(size_t loc_i = 0; loc_i < locReadThreads.size(); ++loc_i)
+		locReadThreads[loc_i].join();
+	while(!locWindow.empty())
+		Write_Next(locWindow);
+
+	dWriteQueue->Close();
+	locWriteThread.join();
+}
+
+#endif // _DOrderedMerge_
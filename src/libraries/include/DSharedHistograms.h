@@ -0,0 +1,331 @@
+// $Id$
+//
+//    File: DSharedHistograms.h
+//
+// Histograms exported to a POSIX shared memory region, for reading by
+// other processes without interfering with the one filling them.
+//
+
+#ifndef _DSharedHistograms_
+#define _DSharedHistograms_
+
+#include <new>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// Layout of the region
+/// -------------------------------------------------------------------
+/// The region starts with a DSharedHistogramsHeader followed by two
+/// buffers. The (single) writer fills the buffer that was not published
+/// last, then publishes it by incrementing "generation": the latest
+/// snapshot is in buffer generation%2. Each buffer has a sequence number
+/// that is odd while the buffer is written, so a reader copies it and
+/// checks that the sequence number is even and did not change meanwhile
+/// (a "seqlock"). Neither side ever waits for the other: a reader only
+/// has to retry if its copy took longer than the time between two
+/// updates.
+///
+/// A buffer starts with a DSharedHistogramsBuffer, followed by the
+/// histograms, each a DSharedHistogramRecord followed by its name (the
+/// ROOT path, e.g. "occupancy/cdc_occ_ring_01"), its title and its bin
+/// contents: one double per cell including the under- and overflow
+/// bins, in the order of TH1::GetBin(). The snapshot files written by
+/// histshm_dump are copies of a buffer.
+
+static const char     DSHAREDHISTOGRAMS_MAGIC[8] = "HDHSHM";
+static const uint32_t DSHAREDHISTOGRAMS_VERSION  = 1;
+
+struct DSharedHistogramsHeader{
+	char magic[8];                   // DSHAREDHISTOGRAMS_MAGIC
+	uint32_t version;                // DSHAREDHISTOGRAMS_VERSION
+	uint32_t pid;                    // of the writer
+	uint64_t buffer_offset[2];       // from the start of the region
+	uint64_t buffer_size;            // capacity of each buffer
+	std::atomic<uint64_t> generation;   // number of published snapshots
+	std::atomic<uint64_t> sequence[2];  // odd while the buffer is written
+};
+
+struct DSharedHistogramsBuffer{
+	uint64_t generation;
+	uint64_t used_size;              // including this header
+	uint64_t Nhistograms;
+	uint64_t Nevents;                // events processed by the writer
+	double   time;                   // unix time of the snapshot
+};
+
+struct DSharedHistogramRecord{
+	uint32_t record_size;            // including name, title and contents
+	uint16_t name_len;
+	uint16_t title_len;
+	uint32_t ndim;
+	uint32_t nbins[2];               // regular bins (y is 1 for 1D)
+	uint32_t ncells;                 // (nbins[0]+2)*(nbins[1]+2) or (nbins[0]+2)
+	double   xmin, xmax;
+	double   ymin, ymax;
+	double   entries;
+};
+
+/// A histogram of a snapshot, as read back
+class DSharedHistogram{
+	public:
+		std::string name;
+		std::string title;
+		uint32_t ndim;
+		uint32_t nbins[2];
+		double xmin, xmax, ymin, ymax;
+		double entries;
+		std::vector<double> contents;  // all cells, including under- and overflows
+
+		double Integral(void) const {
+			double sum = 0.0;
+			for(auto c : contents) sum += c;
+			return sum;
+		}
+};
+
+//---------------------------------
+// DSharedHistogramsWriter
+//---------------------------------
+class DSharedHistogramsWriter{
+	/// Creates the region and writes snapshots to it. Usage:
+	///
+	///    BeginSnapshot();
+	///    for(...) {double *c = AddHistogram(...); if(c) fill c[0..ncells-1];}
+	///    EndSnapshot(Nevents, time);
+	public:
+		DSharedHistogramsWriter(void) : header(NULL), region_size(0), buff(NULL), full(false) {}
+		~DSharedHistogramsWriter() {Close();}
+
+		// Create (or replace) the region; false on error
+		bool Open(std::string name, uint64_t buffer_size){
+			Close();
+			this->name = name;
+			buffer_size = (buffer_size + 7)/8*8;
+			uint64_t header_size = (sizeof(DSharedHistogramsHeader) + 63)/64*64;
+			region_size = header_size + 2*buffer_size;
+			shm_unlink(name.c_str());
+			int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+			if(fd < 0) return false;
+			if(ftruncate(fd, region_size) != 0){
+				close(fd);
+				shm_unlink(name.c_str());
+				return false;
+			}
+			void *ptr = mmap(NULL, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			close(fd);
+			if(ptr == MAP_FAILED){
+				shm_unlink(name.c_str());
+				return false;
+			}
+			header = new(ptr) DSharedHistogramsHeader; // region is zero filled by ftruncate
+			header->version = DSHAREDHISTOGRAMS_VERSION;
+			header->pid = getpid();
+			header->buffer_offset[0] = header_size;
+			header->buffer_offset[1] = header_size + buffer_size;
+			header->buffer_size = buffer_size;
+			header->generation.store(0);
+			header->sequence[0].store(0);
+			header->sequence[1].store(0);
+			std::atomic_thread_fence(std::memory_order_release);
+			memcpy(header->magic, DSHAREDHISTOGRAMS_MAGIC, sizeof(header->magic));
+			return true;
+		}
+
+		// Unmap the region and optionally remove it
+		void Close(bool unlink_region=true){
+			if(!header) return;
+			munmap((void*)header, region_size);
+			if(unlink_region) shm_unlink(name.c_str());
+			header = NULL;
+		}
+
+		bool IsOpen(void) const {return header != NULL;}
+		std::string Name(void) const {return name;}
+
+		void BeginSnapshot(void){
+			ibuff = (header->generation.load(std::memory_order_relaxed) + 1)%2;
+			header->sequence[ibuff].fetch_add(1, std::memory_order_relaxed); // odd: being written
+			std::atomic_thread_fence(std::memory_order_release);
+			buff = (char*)header + header->buffer_offset[ibuff];
+			used = sizeof(DSharedHistogramsBuffer);
+			Nhistograms = 0;
+			full = false;
+		}
+
+		// Space for the contents of a histogram (ncells doubles), NULL if the buffer is full
+		double* AddHistogram(const std::string &hname, const std::string &htitle, uint32_t ndim,
+		                     uint32_t nbinsx, double xmin, double xmax,
+		                     uint32_t nbinsy, double ymin, double ymax, double entries){
+			uint32_t ncells = (nbinsx + 2)*(ndim>1 ? nbinsy + 2:1);
+			uint16_t name_len  = hname.size()  < 0xFFFF ? hname.size() :0xFFFF;
+			uint16_t title_len = htitle.size() < 0xFFFF ? htitle.size():0xFFFF;
+			uint64_t strings_size = (name_len + title_len + 7)/8*8;
+			uint64_t record_size = sizeof(DSharedHistogramRecord) + strings_size + ncells*sizeof(double);
+			if(full || used + record_size > header->buffer_size){
+				full = true;
+				return NULL;
+			}
+
+			DSharedHistogramRecord *rec = (DSharedHistogramRecord*)&buff[used];
+			rec->record_size = record_size;
+			rec->name_len    = name_len;
+			rec->title_len   = title_len;
+			rec->ndim        = ndim;
+			rec->nbins[0]    = nbinsx;
+			rec->nbins[1]    = ndim>1 ? nbinsy:1;
+			rec->ncells      = ncells;
+			rec->xmin        = xmin;
+			rec->xmax        = xmax;
+			rec->ymin        = ymin;
+			rec->ymax        = ymax;
+			rec->entries     = entries;
+			char *strings = (char*)&rec[1];
+			memcpy(strings, hname.c_str(), name_len);
+			memcpy(&strings[name_len], htitle.c_str(), title_len);
+			used += record_size;
+			Nhistograms++;
+			return (double*)&strings[strings_size];
+		}
+
+		// true if histograms didn't fit since BeginSnapshot()
+		bool Full(void) const {return full;}
+
+		void EndSnapshot(uint64_t Nevents, double time){
+			DSharedHistogramsBuffer *bh = (DSharedHistogramsBuffer*)buff;
+			bh->generation  = header->generation.load(std::memory_order_relaxed) + 1;
+			bh->used_size   = used;
+			bh->Nhistograms = Nhistograms;
+			bh->Nevents     = Nevents;
+			bh->time        = time;
+			header->sequence[ibuff].fetch_add(1, std::memory_order_release); // even: complete
+			header->generation.fetch_add(1, std::memory_order_release);
+		}
+
+	private:
+		std::string name;
+		DSharedHistogramsHeader *header;
+		uint64_t region_size;
+		uint32_t ibuff;
+		char *buff;
+		uint64_t used;
+		uint64_t Nhistograms;
+		bool full;
+};
+
+//---------------------------------
+// DSharedHistogramsReader
+//---------------------------------
+class DSharedHistogramsReader{
+	public:
+		DSharedHistogramsReader(void) : header(NULL), region_size(0) {}
+		~DSharedHistogramsReader() {Close();}
+
+		// Map an existing region read-only; false on error
+		bool Open(std::string name){
+			Close();
+			int fd = shm_open(name.c_str(), O_RDONLY, 0);
+			if(fd < 0) return false;
+			struct stat st;
+			if(fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(DSharedHistogramsHeader)){
+				close(fd);
+				return false;
+			}
+			region_size = st.st_size;
+			void *ptr = mmap(NULL, region_size, PROT_READ, MAP_SHARED, fd, 0);
+			close(fd);
+			if(ptr == MAP_FAILED) return false;
+			header = (const DSharedHistogramsHeader*)ptr;
+			if(memcmp(header->magic, DSHAREDHISTOGRAMS_MAGIC, sizeof(header->magic)) != 0 ||
+			   header->version != DSHAREDHISTOGRAMS_VERSION ||
+			   header->buffer_offset[1] + header->buffer_size > region_size){
+				Close();
+				return false;
+			}
+			return true;
+		}
+
+		void Close(void){
+			if(header) munmap((void*)header, region_size);
+			header = NULL;
+		}
+
+		uint32_t WriterPid(void) const {return header ? header->pid:0;}
+
+		// Copy the latest complete snapshot into snapshot. Returns false
+		// if none was published yet or if the copy was overwritten
+		// max_tries times in a row while being made.
+		bool Snapshot(std::vector<char> &snapshot, int max_tries=100) const {
+			if(!header) return false;
+			for(int itry=0; itry<max_tries; itry++){
+				uint64_t generation = header->generation.load(std::memory_order_acquire);
+				if(generation == 0) return false;
+				uint32_t ibuff = generation%2;
+				uint64_t seq1 = header->sequence[ibuff].load(std::memory_order_acquire);
+				if(seq1%2) continue;
+				const char *buff = (const char*)header + header->buffer_offset[ibuff];
+				uint64_t used_size = ((const DSharedHistogramsBuffer*)buff)->used_size;
+				if(used_size < sizeof(DSharedHistogramsBuffer) || used_size > header->buffer_size) used_size = header->buffer_size;
+				snapshot.resize(used_size);
+				memcpy(snapshot.data(), buff, used_size);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				uint64_t seq2 = header->sequence[ibuff].load(std::memory_order_relaxed);
+				if(seq1 == seq2 && Parse(snapshot, NULL)) return true;
+			}
+			return false;
+		}
+
+		// Read the histograms of a snapshot; false if it is corrupt.
+		// With hists NULL the snapshot is only checked.
+		static bool Parse(const std::vector<char> &snapshot, std::vector<DSharedHistogram> *hists,
+		                  DSharedHistogramsBuffer *info=NULL){
+			if(snapshot.size() < sizeof(DSharedHistogramsBuffer)) return false;
+			DSharedHistogramsBuffer bh;
+			memcpy(&bh, snapshot.data(), sizeof(bh));
+			if(bh.used_size != snapshot.size()) return false;
+			if(info) *info = bh;
+			if(hists) hists->clear();
+
+			uint64_t pos = sizeof(DSharedHistogramsBuffer);
+			for(uint64_t i=0; i<bh.Nhistograms; i++){
+				if(pos + sizeof(DSharedHistogramRecord) > snapshot.size()) return false;
+				DSharedHistogramRecord rec;
+				memcpy(&rec, &snapshot[pos], sizeof(rec));
+				uint64_t strings_size = (rec.name_len + rec.title_len + 7)/8*8;
+				if(rec.record_size != sizeof(rec) + strings_size + rec.ncells*sizeof(double)) return false;
+				if(pos + rec.record_size > snapshot.size()) return false;
+				if(hists){
+					const char *strings = &snapshot[pos + sizeof(rec)];
+					DSharedHistogram h;
+					h.name.assign(strings, rec.name_len);
+					h.title.assign(&strings[rec.name_len], rec.title_len);
+					h.ndim     = rec.ndim;
+					h.nbins[0] = rec.nbins[0];
+					h.nbins[1] = rec.nbins[1];
+					h.xmin     = rec.xmin;
+					h.xmax     = rec.xmax;
+					h.ymin     = rec.ymin;
+					h.ymax     = rec.ymax;
+					h.entries  = rec.entries;
+					h.contents.resize(rec.ncells);
+					memcpy(h.contents.data(), &strings[strings_size], rec.ncells*sizeof(double));
+					hists->push_back(h);
+				}
+				pos += rec.record_size;
+			}
+			return pos == snapshot.size();
+		}
+
+	private:
+		const DSharedHistogramsHeader *header;
+		uint64_t region_size;
+};
+
+#endif // _DSharedHistograms_
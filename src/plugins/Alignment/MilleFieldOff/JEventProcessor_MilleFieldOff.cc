@@ -30,12 +30,21 @@ JEventProcessor_MilleFieldOff::~JEventProcessor_MilleFieldOff() {}
 jerror_t JEventProcessor_MilleFieldOff::init(void) {
   // This is called once at program startup.
   int version = -1;
+  bool shards = false;
+  int batch_size = 4;
   gPARMS->SetDefaultParameter("MILLE:VERSION", version);
-  if (version < 0) {
-    milleWriter = new Mille("nofield_mille_out.mil");
-  } else {
-    milleWriter = new Mille(Form("mil/nofield_mille_out_v%02d.mil", version));
-  }
+  gPARMS->SetDefaultParameter(
+      "MILLE:SHARDS", shards,
+      "Write the records of each thread to a file of its own (_tNN added to "
+      "the file name). The files can be concatenated afterwards.");
+  gPARMS->SetDefaultParameter(
+      "MILLE:BATCH_SIZE", batch_size,
+      "Size in MB of the batches of records each thread hands to the writer "
+      "thread");
+  string filename = "nofield_mille_out.mil";
+  if (version >= 0) filename = Form("mil/nofield_mille_out_v%02d.mil", version);
+  milleWriter =
+      new DMilleWriter(filename, shards, size_t(batch_size) * 1024 * 1024);
 
   return NOERROR;
 }
@@ -70,6 +79,10 @@ jerror_t JEventProcessor_MilleFieldOff::evnt(JEventLoop *loop,
                           2528, 2710, 2907, 3104, 3313};
   vector<const DTrackTimeBased *> trackVector;
   loop->Get(trackVector, "StraightLine");
+  if (trackVector.empty()) return NOERROR;
+
+  // Records are built and batched per thread, no lock is needed
+  DMilleRecordBuilder &mille = milleWriter->Get_Builder();
 
   for (size_t i = 0; i < trackVector.size(); ++i) {
     const DTrackTimeBased *track = trackVector[i];
@@ -104,7 +117,6 @@ jerror_t JEventProcessor_MilleFieldOff::evnt(JEventLoop *loop,
     }
     if (contains_bad_pulls) continue;
 
-    japp->RootWriteLock();  // Just use the root lock as a temporary
     for (size_t iPull = 0; iPull < pulls.size(); ++iPull) {
       float resi = pulls[iPull].resi;  // residual of measurement
       float err = pulls[iPull].err;    // estimated error of measurement
@@ -155,7 +167,7 @@ jerror_t JEventProcessor_MilleFieldOff::evnt(JEventLoop *loop,
         // pulls[iPull].fdc_hit->wire->wire;
         label_W[5] = label_layer_offset + 999;
 
-        milleWriter->mille(NLC, derLc_W, NGL_W, derGl_W, label_W, resi, err);
+        mille.mille(NLC, derLc_W, NGL_W, derGl_W, label_W, resi, err);
 
         // For cathode measurement.
         const int NGL_C = 20;
@@ -226,7 +238,7 @@ jerror_t JEventProcessor_MilleFieldOff::evnt(JEventLoop *loop,
         label_C[18] = label_layer_offset + 208;
         label_C[19] = label_layer_offset + 209;
 
-        milleWriter->mille(NLC, derLc_C, NGL_C, derGl_C, label_C, resic, errc);
+        mille.mille(NLC, derLc_C, NGL_C, derGl_C, label_C, resic, errc);
       }
 
       if (cdc_hit != nullptr) {
@@ -395,11 +407,10 @@ jerror_t JEventProcessor_MilleFieldOff::evnt(JEventLoop *loop,
                    (straw_offset[thisWire->ring] + (thisWire->straw - 1)) * 4 +
                    4;
 
-        milleWriter->mille(NLC, derLc, NGL, derGl, label, resi, err);
+        mille.mille(NLC, derLc, NGL, derGl, label, resi, err);
       }
     }
-    milleWriter->end();
-    japp->RootUnLock();
+    mille.end();
   }
 
   return NOERROR;
@@ -414,6 +425,11 @@ jerror_t JEventProcessor_MilleFieldOff::erun(void) {
 
 jerror_t JEventProcessor_MilleFieldOff::fini(void) {
   // Called before program exit after event processing is finished.
+  milleWriter->Close();
+  jout << "Wrote " << milleWriter->Get_NumRecordsWritten()
+       << " Millepede records (" << milleWriter->Get_NumBytesWritten()
+       << " bytes) to " << milleWriter->Get_FileNames().size() << " file(s)"
+       << endl;
   delete milleWriter;
   return NOERROR;
 }
@@ -9,7 +9,7 @@
 #define _JEventProcessor_MilleFieldOff_
 
 #include <JANA/JEventProcessor.h>
-#include "Mille.h"
+#include <DMilleWriter.h>
 
 class JEventProcessor_MilleFieldOff : public jana::JEventProcessor {
  public:
@@ -28,7 +28,7 @@ class JEventProcessor_MilleFieldOff : public jana::JEventProcessor {
                         ///< has been called.
   jerror_t fini(void);  ///< Called after last event of last event source has
                         ///< been processed.
-  Mille *milleWriter;
+  DMilleWriter *milleWriter;
 };
 
 #endif  // _JEventProcessor_MilleFieldOff_
@@ -31,12 +31,21 @@ JEventProcessor_MilleFieldOn::~JEventProcessor_MilleFieldOn() {}
 jerror_t JEventProcessor_MilleFieldOn::init(void) {
   // This is called once at program startup.
   int version = -1;
+  bool shards = false;
+  int batch_size = 4;
   gPARMS->SetDefaultParameter("MILLE:VERSION", version);
-  if (version < 0) {
-    milleWriter = new Mille("fieldon_mille_out.mil");
-  } else {
-    milleWriter = new Mille(Form("mil/fieldon_mille_out_v%02d.mil", version));
-  }
+  gPARMS->SetDefaultParameter(
+      "MILLE:SHARDS", shards,
+      "Write the records of each thread to a file of its own (_tNN added to "
+      "the file name). The files can be concatenated afterwards.");
+  gPARMS->SetDefaultParameter(
+      "MILLE:BATCH_SIZE", batch_size,
+      "Size in MB of the batches of records each thread hands to the writer "
+      "thread");
+  string filename = "fieldon_mille_out.mil";
+  if (version >= 0) filename = Form("mil/fieldon_mille_out_v%02d.mil", version);
+  milleWriter =
+      new DMilleWriter(filename, shards, size_t(batch_size) * 1024 * 1024);
 
   return NOERROR;
 }
@@ -70,6 +79,10 @@ jerror_t JEventProcessor_MilleFieldOn::evnt(JEventLoop *loop,
                           2528, 2710, 2907, 3104, 3313};
   vector<const DChargedTrack *> trackVector;
   loop->Get(trackVector);
+  if (trackVector.empty()) return NOERROR;
+
+  // Records are built and batched per thread, no lock is needed
+  DMilleRecordBuilder &mille = milleWriter->Get_Builder();
 
   for (size_t i = 0; i < trackVector.size(); ++i) {
     // TODO: Should be changed to use PID FOM when ready
@@ -111,7 +124,6 @@ jerror_t JEventProcessor_MilleFieldOn::evnt(JEventLoop *loop,
     if (pullsNDF != track->Ndof) continue;
     if (track->Ndof < (isCDCOnly ? 10 : 22)) continue;
 
-    japp->RootWriteLock();  // Just use the root lock as a temporary
     for (size_t iPull = 0; iPull < pulls.size(); ++iPull) {
       float resi = pulls[iPull].resi;  // residual of measurement
       float err = pulls[iPull].err;    // estimated error of measurement
@@ -161,7 +173,7 @@ jerror_t JEventProcessor_MilleFieldOn::evnt(JEventLoop *loop,
           label_W[5] = label_layer_offset + 998;
         }
 
-        milleWriter->mille(NLC, derLc_W, NGL_W, derGl_W, label_W, resi, err);
+        mille.mille(NLC, derLc_W, NGL_W, derGl_W, label_W, resi, err);
 
         // For cathode measurement.
         const int NGL_C = 20;
@@ -222,7 +234,7 @@ jerror_t JEventProcessor_MilleFieldOn::evnt(JEventLoop *loop,
         label_C[18] = label_layer_offset + 208;
         label_C[19] = label_layer_offset + 209;
 
-        milleWriter->mille(NLC, derLc_C, NGL_C, derGl_C, label_C, resic, errc);
+        mille.mille(NLC, derLc_C, NGL_C, derGl_C, label_C, resic, errc);
       }
 
       if (cdc_hit != nullptr) {
@@ -383,11 +395,10 @@ jerror_t JEventProcessor_MilleFieldOn::evnt(JEventLoop *loop,
         // derGl[10] = -der[CDCTrackD::dDdt0];
         // label[10] = 16000 + straw_offset[wire->ring] + wire->straw;
 
-        milleWriter->mille(NLC, derLc, NGL, derGl, label, resi, err);
+        mille.mille(NLC, derLc, NGL, derGl, label, resi, err);
       }
     }
-    milleWriter->end();
-    japp->RootUnLock();
+    mille.end();
   }
 
   return NOERROR;
@@ -402,6 +413,11 @@ jerror_t JEventProcessor_MilleFieldOn::erun(void) {
 
 jerror_t JEventProcessor_MilleFieldOn::fini(void) {
   // Called before program exit after event processing is finished.
+  milleWriter->Close();
+  jout << "Wrote " << milleWriter->Get_NumRecordsWritten()
+       << " Millepede records (" << milleWriter->Get_NumBytesWritten()
+       << " bytes) to " << milleWriter->Get_FileNames().size() << " file(s)"
+       << endl;
   delete milleWriter;
   return NOERROR;
 }
@@ -7,7 +7,7 @@
 #define _JEventProcessor_MilleFieldOn_
 
 #include <JANA/JEventProcessor.h>
-#include "Mille.h"
+#include <DMilleWriter.h>
 
 class JEventProcessor_MilleFieldOn : public jana::JEventProcessor {
  public:
@@ -26,7 +26,7 @@ class JEventProcessor_MilleFieldOn : public jana::JEventProcessor {
                         ///< has been called.
   jerror_t fini(void);  ///< Called after last event of last event source has
                         ///< been processed.
-  Mille *milleWriter;
+  DMilleWriter *milleWriter;
 };
 
 #endif  // _JEventProcessor_MilleFieldOn_
@@ -0,0 +1,233 @@
+// $Id$
+//
+//    File: JEventProcessor_cdc_candidate_compare.cc
+//
+
+#include <sys/time.h>
+#include <sstream>
+#include <iomanip>
+#include <set>
+#include <cmath>
+
+#include "JEventProcessor_cdc_candidate_compare.h"
+using namespace jana;
+
+// Routine used to create our JEventProcessor
+#include <JANA/JApplication.h>
+
+#include <TRACKING/DTrackHitSelectorTHROWN.h>
+
+extern "C"{
+void InitPlugin(JApplication *app){
+	InitJANAPlugin(app);
+	app->AddProcessor(new JEventProcessor_cdc_candidate_compare());
+}
+} // "C"
+
+static double GetTime(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + 1.0E-6*(double)tv.tv_usec;
+}
+
+//------------------
+// JEventProcessor_cdc_candidate_compare (Constructor)
+//------------------
+JEventProcessor_cdc_candidate_compare::JEventProcessor_cdc_candidate_compare()
+{
+	pthread_mutex_init(&mutex, NULL);
+	Nevents = 0;
+	Nhits = 0;
+	Nhits_both = 0;
+	Nhits_either = 0;
+}
+
+//------------------
+// ~JEventProcessor_cdc_candidate_compare (Destructor)
+//------------------
+JEventProcessor_cdc_candidate_compare::~JEventProcessor_cdc_candidate_compare()
+{
+
+}
+
+//------------------
+// init
+//------------------
+jerror_t JEventProcessor_cdc_candidate_compare::init(void)
+{
+	string tags = "CDC,CDCGraph";
+	MIN_TRUTH_HITS = 10;
+	MIN_PURITY = 0.7;
+	gPARMS->SetDefaultParameter("CDCCOMPARE:TAGS", tags, "Comma-separated DTrackCandidate factory tags to compare (the first two are used for the hit overlap)");
+	gPARMS->SetDefaultParameter("CDCCOMPARE:MIN_TRUTH_HITS", MIN_TRUTH_HITS, "Minimum number of truth-matched CDC hits for a track to be reconstructable");
+	gPARMS->SetDefaultParameter("CDCCOMPARE:MIN_PURITY", MIN_PURITY, "Minimum fraction of the hits of a candidate from its truth track, for it not to be a ghost");
+
+	stringstream ss(tags);
+	string tag;
+	while(getline(ss, tag, ','))
+		TAGS.push_back(tag);
+	stats.resize(TAGS.size());
+
+	return NOERROR;
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t JEventProcessor_cdc_candidate_compare::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	vector<const DCDCTrackHit*> cdchits;
+	vector<const DMCTrackHit*> mctrackhits;
+	loop->Get(cdchits);
+	loop->Get(mctrackhits);
+
+	// Truth track of each CDC hit
+	map<const DCDCTrackHit*, int> truth_track;
+	map<int, unsigned int> num_truth_hits;
+	for(unsigned int i=0; i<cdchits.size(); i++){
+		// Use the match from DCDCTrackHit_factory if there (CDC:MATCH_TRUTH_HITS), else match here the same way
+		const DMCTrackHit *mctrackhit = NULL;
+		cdchits[i]->GetSingle(mctrackhit);
+		if(!mctrackhit){
+			double d = (cdchits[i]->tdrift > 0.0) ? 0.0279*sqrt(cdchits[i]->tdrift) : 0.0;
+			mctrackhit = DTrackHitSelectorTHROWN::GetMCTrackHit(cdchits[i]->wire, d, mctrackhits);
+		}
+		if(!mctrackhit)continue;
+		truth_track[cdchits[i]] = mctrackhit->track;
+		num_truth_hits[mctrackhit->track]++;
+	}
+
+	// Run each finder (timed: first request runs the factory)
+	vector<vector<const DTrackCandidate*> > candidates(TAGS.size());
+	vector<double> times(TAGS.size());
+	for(unsigned int i=0; i<TAGS.size(); i++){
+		double t_start = GetTime();
+		loop->Get(candidates[i], TAGS[i].c_str());
+		times[i] = GetTime() - t_start;
+	}
+
+	vector<DFinderStats> event_stats(TAGS.size());
+	vector<vector<bool> > used_hits(TAGS.size(), vector<bool>(cdchits.size(), false));
+	for(unsigned int i=0; i<TAGS.size(); i++){
+		Compare_Finder(candidates[i], truth_track, num_truth_hits, event_stats[i], used_hits[i], cdchits);
+		event_stats[i].dTime = times[i];
+	}
+
+	unsigned long hits_both = 0;
+	unsigned long hits_either = 0;
+	if(TAGS.size() > 1){
+		for(unsigned int i=0; i<cdchits.size(); i++){
+			if(used_hits[0][i] && used_hits[1][i])hits_both++;
+			if(used_hits[0][i] || used_hits[1][i])hits_either++;
+		}
+	}
+
+	pthread_mutex_lock(&mutex);
+	Nevents++;
+	Nhits += cdchits.size();
+	Nhits_both += hits_both;
+	Nhits_either += hits_either;
+	for(unsigned int i=0; i<TAGS.size(); i++){
+		DFinderStats &s = stats[i];
+		const DFinderStats &e = event_stats[i];
+		s.dNumCandidates += e.dNumCandidates;
+		s.dNumGhosts += e.dNumGhosts;
+		s.dNumClones += e.dNumClones;
+		s.dNumFound += e.dNumFound;
+		s.dNumReconstructable += e.dNumReconstructable;
+		s.dSumPurity += e.dSumPurity;
+		s.dSumHitEfficiency += e.dSumHitEfficiency;
+		s.dTime += e.dTime;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return NOERROR;
+}
+
+//------------------
+// Compare_Finder
+//------------------
+void JEventProcessor_cdc_candidate_compare::Compare_Finder(const vector<const DTrackCandidate*>& candidates, const map<const DCDCTrackHit*, int>& truth_track,
+		const map<int, unsigned int>& num_truth_hits, DFinderStats& s, vector<bool>& used_hits, const vector<const DCDCTrackHit*>& cdchits) const
+{
+	map<const DCDCTrackHit*, unsigned int> hit_index;
+	for(unsigned int i=0; i<cdchits.size(); i++)hit_index[cdchits[i]] = i;
+
+	set<int> found_tracks;
+	for(unsigned int i=0; i<candidates.size(); i++){
+		vector<const DCDCTrackHit*> hits;
+		candidates[i]->Get(hits);
+		if(hits.empty())continue; // not from the CDC
+		s.dNumCandidates++;
+
+		// Majority truth track
+		map<int, unsigned int> counts;
+		for(unsigned int j=0; j<hits.size(); j++){
+			map<const DCDCTrackHit*, unsigned int>::const_iterator iter_index = hit_index.find(hits[j]);
+			if(iter_index != hit_index.end())used_hits[iter_index->second] = true;
+			map<const DCDCTrackHit*, int>::const_iterator iter = truth_track.find(hits[j]);
+			if(iter != truth_track.end())counts[iter->second]++;
+		}
+		int track = -1;
+		unsigned int max_count = 0;
+		for(map<int, unsigned int>::iterator iter = counts.begin(); iter != counts.end(); iter++){
+			if(iter->second > max_count){
+				max_count = iter->second;
+				track = iter->first;
+			}
+		}
+		double purity = double(max_count)/double(hits.size());
+		if(purity < MIN_PURITY){
+			s.dNumGhosts++;
+			continue;
+		}
+
+		s.dSumPurity += purity;
+		map<int, unsigned int>::const_iterator iter_truth = num_truth_hits.find(track);
+		if(iter_truth != num_truth_hits.end())s.dSumHitEfficiency += double(max_count)/double(iter_truth->second);
+
+		if(found_tracks.find(track) != found_tracks.end()){
+			s.dNumClones++;
+			continue;
+		}
+		found_tracks.insert(track);
+		if((iter_truth != num_truth_hits.end()) && (iter_truth->second >= MIN_TRUTH_HITS))s.dNumFound++;
+	}
+
+	for(map<int, unsigned int>::const_iterator iter = num_truth_hits.begin(); iter != num_truth_hits.end(); iter++){
+		if(iter->second >= MIN_TRUTH_HITS)s.dNumReconstructable++;
+	}
+}
+
+//------------------
+// fini
+//------------------
+jerror_t JEventProcessor_cdc_candidate_compare::fini(void)
+{
+	if(Nevents == 0)return NOERROR;
+
+	jout << endl;
+	jout << "CDC candidate comparison: " << Nevents << " events, " << double(Nhits)/double(Nevents) << " CDC hits/event" << endl;
+	jout << setw(12) << "tag" << setw(12) << "cand/event" << setw(12) << "efficiency" << setw(12) << "ghosts" << setw(12) << "clones";
+	jout << setw(12) << "purity" << setw(12) << "hit eff." << setw(12) << "ms/event" << endl;
+	for(unsigned int i=0; i<TAGS.size(); i++){
+		const DFinderStats &s = stats[i];
+		unsigned long Ngood = s.dNumCandidates - s.dNumGhosts;
+		jout << setw(12) << TAGS[i];
+		jout << setw(12) << double(s.dNumCandidates)/double(Nevents);
+		jout << setw(12) << (s.dNumReconstructable ? double(s.dNumFound)/double(s.dNumReconstructable) : 0.0);
+		jout << setw(12) << (s.dNumCandidates ? double(s.dNumGhosts)/double(s.dNumCandidates) : 0.0);
+		jout << setw(12) << (Ngood ? double(s.dNumClones)/double(Ngood) : 0.0);
+		jout << setw(12) << (Ngood ? s.dSumPurity/double(Ngood) : 0.0);
+		jout << setw(12) << (Ngood ? s.dSumHitEfficiency/double(Ngood) : 0.0);
+		jout << setw(12) << 1000.0*s.dTime/double(Nevents) << endl;
+	}
+	if(TAGS.size() > 1){
+		jout << "Hits used by both " << TAGS[0] << " and " << TAGS[1] << ": " << (Nhits_either ? double(Nhits_both)/double(Nhits_either) : 0.0);
+		jout << " (of the hits used by either)" << endl;
+	}
+	jout << endl;
+
+	return NOERROR;
+}
@@ -0,0 +1,72 @@
+// $Id$
+//
+//    File: JEventProcessor_cdc_candidate_compare.h
+//
+
+#ifndef _JEventProcessor_cdc_candidate_compare_
+#define _JEventProcessor_cdc_candidate_compare_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+using namespace std;
+
+#include <JANA/JEventProcessor.h>
+
+#include <TRACKING/DTrackCandidate.h>
+#include <TRACKING/DMCTrackHit.h>
+#include <CDC/DCDCTrackHit.h>
+
+// Compares the CDC track finders: DTrackCandidate:CDC (default) vs. DTrackCandidate:CDCGraph (or the tags in CDCCOMPARE:TAGS).
+// MC truth: each CDC hit is matched to a DMCTrackHit (as in DCDCTrackHit_factory), the track with most hits on a candidate is its truth track.
+// Reported at the end, for each finder:
+//   efficiency:  fraction of reconstructable tracks (>= CDCCOMPARE:MIN_TRUTH_HITS matched hits) found by a good candidate
+//   ghost rate:  fraction of candidates with purity < CDCCOMPARE:MIN_PURITY
+//   clone rate:  fraction of good candidates matched to an already-found track
+//   purity & hit efficiency of good candidates, time per event in the factory
+// and the fraction of CDC hits used by both finders
+
+class JEventProcessor_cdc_candidate_compare:public jana::JEventProcessor{
+	public:
+		JEventProcessor_cdc_candidate_compare();
+		~JEventProcessor_cdc_candidate_compare();
+		const char* className(void){return "JEventProcessor_cdc_candidate_compare";}
+
+		class DFinderStats
+		{
+			public:
+				DFinderStats(void) : dNumCandidates(0), dNumGhosts(0), dNumClones(0), dNumFound(0), dNumReconstructable(0),
+					dSumPurity(0.0), dSumHitEfficiency(0.0), dTime(0.0) {}
+
+				unsigned long dNumCandidates;
+				unsigned long dNumGhosts;
+				unsigned long dNumClones;
+				unsigned long dNumFound;
+				unsigned long dNumReconstructable;
+				double dSumPurity; //good candidates
+				double dSumHitEfficiency; //good candidates
+				double dTime; //s
+		};
+
+	private:
+		jerror_t init(void);						///< Called once at program start.
+		jerror_t evnt(jana::JEventLoop *eventLoop, uint64_t eventnumber);	///< Called every event.
+		jerror_t fini(void);						///< Called after last event of last event source has been processed.
+
+		void Compare_Finder(const vector<const DTrackCandidate*>& candidates, const map<const DCDCTrackHit*, int>& truth_track, const map<int, unsigned int>& num_truth_hits,
+				DFinderStats& stats, vector<bool>& used_hits, const vector<const DCDCTrackHit*>& cdchits) const;
+
+		vector<string> TAGS;
+		unsigned int MIN_TRUTH_HITS;
+		double MIN_PURITY;
+
+		pthread_mutex_t mutex;
+		unsigned long Nevents;
+		unsigned long Nhits;
+		unsigned long Nhits_both;
+		unsigned long Nhits_either;
+		vector<DFinderStats> stats;
+};
+
+#endif // _JEventProcessor_cdc_candidate_compare_
@@ -180,18 +180,7 @@ void DEVIOBufferWriter::WriteEventToBuffer(JEventLoop *loop, vector<uint32_t> &b
         }
     }
 	
-	// Get the DL3Trigger object for the event. We go to some trouble
-	// here not to activate the factory ourselves and only check if the
-	// object already exists. This is because we may have skipped creating
-	// the object due to this being an unbiased event.
-	const DL3Trigger *l3trigger = NULL;
-	JFactory_base *fac = loop->GetFactory("DL3Trigger");
-	if(fac){
-		int nobjs = fac->GetNrows(false, true); // don't create objects if not already existing
-		if(nobjs>0){
-			loop->GetSingle(l3trigger, "", false); // don't throw exception if nobjs>1
-		}
-	}
+	const DL3Trigger *l3trigger = GetL3Trigger(loop);
 	
 	// If there are any EPICS values then asume this is an EPICS event
 	// with no CODA data. In this case, write the EPICS banks and then
@@ -287,6 +276,56 @@ void DEVIOBufferWriter::WriteEventToBuffer(JEventLoop *loop, vector<uint32_t> &b
 }
 
 
+//------------------
+// WriteRawEventToBuffer
+//------------------
+bool DEVIOBufferWriter::WriteRawEventToBuffer(JEventLoop *loop, const uint32_t *raw_event, vector<uint32_t> &buff) const
+{
+	/// Copy the original EVIO event (host byte order) into buff, with
+	/// its EventTag bank replaced by one written for the current event
+	/// status and L3 decision, exactly as WriteEventToBuffer would write
+	/// it. The new bank goes right after the built trigger bank. Returns
+	/// false, leaving buff empty, if raw_event is not a single CODA
+	/// physics event that can be walked bank by bank.
+
+	buff.clear();
+
+	uint32_t event_len = raw_event[0] + 1;
+	if( event_len < 2 ) return false;
+	uint32_t mask = 0xFF001000;
+	if( (raw_event[1]&mask) != mask ) return false; // not a CODA physics event
+	if( (raw_event[1]&0xFF) != 1 ) return false;    // block of entangled events
+
+	// Find the child banks, leaving out any existing EventTag bank
+	vector<pair<uint32_t, uint32_t> > banks; // index, length in words
+	uint32_t trigger_bank = 0;
+	for(uint32_t idx=2; idx<event_len; ){
+		uint32_t bank_len = raw_event[idx] + 1;
+		if( (raw_event[idx] == 0) || (idx + bank_len > event_len) ) return false; // corrupt
+		if( (bank_len>1) && (raw_event[idx+1] == 0x0F561001) ){
+			idx += bank_len;
+			continue; // rocid=0xF56: EventTag
+		}
+		if( banks.empty() && ((raw_event[idx+1]>>16)&0xFFF0)==0xFF20 ) trigger_bank = 1; // built trigger bank
+		banks.push_back(make_pair(idx, bank_len));
+		idx += bank_len;
+	}
+
+	buff.reserve(event_len + 12);
+	buff.push_back(0); // Physics Event Length (must be updated at the end)
+	buff.push_back(raw_event[1]);
+	for(uint32_t i=0; i<trigger_bank; i++)
+		buff.insert(buff.end(), raw_event + banks[i].first, raw_event + banks[i].first + banks[i].second);
+	WriteEventTagData(buff, loop->GetJEvent().GetStatus(), GetL3Trigger(loop));
+	for(uint32_t i=trigger_bank; i<banks.size(); i++)
+		buff.insert(buff.end(), raw_event + banks[i].first, raw_event + banks[i].first + banks[i].second);
+
+	// Update event length
+	buff[0] = buff.size() - 1;
+
+	return true;
+}
+
 //------------------
 // WriteBuiltTriggerBank
 //------------------
@@ -1580,6 +1619,27 @@ void DEVIOBufferWriter::WriteEPICSData(vector<uint32_t> &buff,
 	buff[epics_bank_idx] = buff.size() - epics_bank_idx - 1;
 }
 
+//------------------
+// GetL3Trigger
+//------------------
+const DL3Trigger* DEVIOBufferWriter::GetL3Trigger(JEventLoop *loop) const
+{
+	// Get the DL3Trigger object for the event. We go to some trouble
+	// here not to activate the factory ourselves and only check if the
+	// object already exists. This is because we may have skipped creating
+	// the object due to this being an unbiased event.
+	const DL3Trigger *l3trigger = NULL;
+	JFactory_base *fac = loop->GetFactory("DL3Trigger");
+	if(fac){
+		int nobjs = fac->GetNrows(false, true); // don't create objects if not already existing
+		if(nobjs>0){
+			loop->GetSingle(l3trigger, "", false); // don't throw exception if nobjs>1
+		}
+	}
+
+	return l3trigger;
+}
+
 //------------------
 // WriteEventTagData
 //------------------
@@ -70,6 +70,7 @@ class DEVIOBufferWriter
 
     void WriteEventToBuffer(JEventLoop *loop, vector<uint32_t> &buff, vector<const JObject *> objects_to_save) const;
     void WriteEventToBuffer(JEventLoop *locEventLoop, vector<uint32_t> &buff) const;
+    bool WriteRawEventToBuffer(JEventLoop *loop, const uint32_t *raw_event, vector<uint32_t> &buff) const;
 
     void SetROCsToWriteOut(set<uint32_t> &new_rocs_to_write_out) {
         rocs_to_write_out = new_rocs_to_write_out;
@@ -78,6 +79,11 @@ class DEVIOBufferWriter
             write_out_all_rocs = true;
     }
 
+    // ROCs the output depends on (empty if all of them are written out)
+    set<uint32_t> GetROCsToWriteOut(void) const {
+        return write_out_all_rocs ? set<uint32_t>() : rocs_to_write_out;
+    }
+
 
   protected:
 
@@ -129,6 +135,8 @@ class DEVIOBufferWriter
 		void WriteEPICSData(vector<uint32_t> &buff,
                             vector<const DEPICSvalue*> epicsValues) const;
 
+		const DL3Trigger* GetL3Trigger(JEventLoop *loop) const;
+
 		void WriteEventTagData(vector<uint32_t> &buff,
                                uint64_t event_status,
                                const DL3Trigger* l3trigger) const;
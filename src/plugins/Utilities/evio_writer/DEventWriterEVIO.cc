@@ -1,7 +1,9 @@
 #include "DEventWriterEVIO.h"
 #include "DAQ/DL1Info.h"
+#include "hdbyte_swapout.h"
 
 #include <DAQ/JEventSource_EVIO.h>
+#include <DAQ/JEventSource_EVIOpp.h>
 
 
 size_t& DEventWriterEVIO::Get_NumEVIOOutputThreads(void) const
@@ -18,6 +20,20 @@ map<string, HDEVIOWriter*>& DEventWriterEVIO::Get_EVIOOutputters(void) const
 	return locEVIOOutputters;
 }
 
+map<string, DEVIOSkimSink*>& DEventWriterEVIO::Get_EVIOSkimSinks(void) const
+{
+	// must be read/used entirely in "EVIOWriter" lock
+	static map<string, DEVIOSkimSink*> locEVIOSkimSinks;
+	return locEVIOSkimSinks;
+}
+
+map<string, uint64_t>& DEventWriterEVIO::Get_EVIOWriteStats(void) const
+{
+	// must be read/used entirely in "EVIOWriter" lock
+	static map<string, uint64_t> locEVIOWriteStats;
+	return locEVIOWriteStats;
+}
+
 map<string, DEVIOBufferWriter*>& DEventWriterEVIO::Get_EVIOBufferWriters(void) const
 {
 	// must be read/used entirely in "EVIOWriter" lock
@@ -37,8 +53,19 @@ DEventWriterEVIO::DEventWriterEVIO(JEventLoop* locEventLoop)
 	COMPACT = true;
 	PREFER_EMULATED = false;
 	DEBUG_FILES = false; // n.b. also defined in HDEVIOWriter
+	SKIM_ROUTER = true;
+	PASSTHROUGH = false;
+	MAX_OUTPUT_QUEUE_SIZE = 200; // n.b. these three are also defined in HDEVIOWriter
+	MAX_HOLD_TIME = 2;
+	NEVENTS_PER_BLOCK = 100;
     dMergeFiles = false;
     dMergedFilename = "merged.evio";  
+	dSharedBuffersEvent = 0;
+	dNumEventsPassedThrough = 0;
+	dNumBytesPassedThrough = 0;
+	dNumEventsReencoded = 0;
+	dNumBytesReencoded = 0;
+	dNumEventsDropped = 0;
 
 	ofs_debug_input = NULL;
 	ofs_debug_output = NULL;
@@ -46,6 +73,11 @@ DEventWriterEVIO::DEventWriterEVIO(JEventLoop* locEventLoop)
 	gPARMS->SetDefaultParameter("EVIOOUT:COMPACT" , COMPACT,  "Drop words where we can to reduce output file size. This shouldn't loose any vital information, but can be turned off to help with debugging.");
 	gPARMS->SetDefaultParameter("EVIOOUT:PREFER_EMULATED" , PREFER_EMULATED,  "If true, then sample data will not be written to output, but emulated hits will. Otherwise, do exactly the opposite.");
 	gPARMS->SetDefaultParameter("EVIOOUT:DEBUG_FILES" , DEBUG_FILES,  "Write input and output debug files in addition to the standard output.");
+	gPARMS->SetDefaultParameter("EVIOOUT:SKIM_ROUTER" , SKIM_ROUTER,  "Build the output buffer of an event once per thread for all output files that take it (with the same detectors), and write files with DEVIOSkimSink (one writer thread per file, using writev). ET outputs always use HDEVIOWriter. Set to 0 to use HDEVIOWriter for all outputs.");
+	gPARMS->SetDefaultParameter("EVIOOUT:PASSTHROUGH" , PASSTHROUGH,  "Write the original EVIO event (with a new EventTag bank) when the output would otherwise be the same (no objects to add, no selection of detectors, EVIOOUT:PREFER_EMULATED off) instead of re-encoding it from the parsed objects. EVIOOUT:COMPACT is not applied to these events. Requires EVIO:KEEP_RAW_EVENT, which this turns on by default.");
+	gPARMS->SetDefaultParameter("EVIOOUT:MAX_OUTPUT_QUEUE_SIZE" , MAX_OUTPUT_QUEUE_SIZE,  "Maximum number of events output queue can have before processing threads start blocking.");
+	gPARMS->SetDefaultParameter("EVIOOUT:MAX_HOLD_TIME", MAX_HOLD_TIME, "Maximum time in seconds to keep events in buffer before flushing them. This is to prevent farm from witholding events from ER when running very slow trigger rates. This should not be set lesst than 2.");
+	gPARMS->SetDefaultParameter("EVIOOUT:NEVENTS_PER_BLOCK", NEVENTS_PER_BLOCK, "Suggested number of events to write in single output block.");
 
     //buffer_writer = new DEVIOBufferWriter(COMPACT, PREFER_EMULATED);
 
@@ -194,21 +226,45 @@ bool DEventWriterEVIO::Write_EVIOEvent(JEventLoop* locEventLoop, string locOutpu
 	japp->WriteLock("EVIOWriter");
 	{
 		//check to see if the EVIO file is open
-		if(Get_EVIOOutputters().find(locOutputFileName) == Get_EVIOOutputters().end()) {
+		if((Get_EVIOOutputters().find(locOutputFileName) == Get_EVIOOutputters().end()) &&
+				(Get_EVIOSkimSinks().find(locOutputFileName) == Get_EVIOSkimSinks().end())) {
 			//not open, open it
-			if(!Open_OutputFile(locEventLoop, locOutputFileName))
+			if(!Open_OutputFile(locEventLoop, locOutputFileName)){
+				japp->Unlock("EVIOWriter");
 				return false; //failed to open
+			}
 		}
 
 		//open: get handle, write event
-		HDEVIOWriter *locEVIOWriter = Get_EVIOOutputters()[locOutputFileName];
         DEVIOBufferWriter *locBufferWriter = Get_EVIOBufferWriters()[locOutputFileName];
+		map<string, DEVIOSkimSink*>::iterator locSinkIterator = Get_EVIOSkimSinks().find(locOutputFileName);
+		if(locSinkIterator != Get_EVIOSkimSinks().end()) {
+			DEVIOSkimSink *locSkimSink = locSinkIterator->second;
+			japp->Unlock("EVIOWriter");
+
+			// The buffer is built (and byte swapped) outside of the lock, once for
+			// all files of this thread taking the event. Blocks if the queue is full.
+			if(!locSkimSink->Add_Buffer(Get_SharedBuffer(locEventLoop, locBufferWriter, locObjectsToSave))){
+				dNumEventsDropped++;
+				return false; //the file can't be written
+			}
+			return true;
+		}
+
+		HDEVIOWriter *locEVIOWriter = Get_EVIOOutputters()[locOutputFileName];
 		// Write event into buffer
 		vector<uint32_t> *buff = locEVIOWriter->GetBufferFromPool();
-        if(locObjectsToSave.size() == 0)
-            locBufferWriter->WriteEventToBuffer(locEventLoop, *buff);
-        else
-            locBufferWriter->WriteEventToBuffer(locEventLoop, *buff, locObjectsToSave);
+		if(Write_RawEvent(locEventLoop, locBufferWriter, locObjectsToSave, *buff)){
+			dNumEventsPassedThrough++;
+			dNumBytesPassedThrough += buff->size()*sizeof(uint32_t);
+		}else{
+			if(locObjectsToSave.size() == 0)
+				locBufferWriter->WriteEventToBuffer(locEventLoop, *buff);
+			else
+				locBufferWriter->WriteEventToBuffer(locEventLoop, *buff, locObjectsToSave);
+			dNumEventsReencoded++;
+			dNumBytesReencoded += buff->size()*sizeof(uint32_t);
+		}
 
 		// Optionally write buffer to output file
 		if(ofs_debug_output) ofs_debug_output->write((const char*)&(*buff)[0], buff->size()*sizeof(uint32_t));
@@ -264,7 +320,8 @@ bool DEventWriterEVIO::Write_EVIOBuffer(JEventLoop* locEventLoop, vector<uint32_
 	japp->WriteLock("EVIOWriter");
 	{
 		//check to see if the EVIO file is open
-		if(Get_EVIOOutputters().find(locOutputFileName) == Get_EVIOOutputters().end())  {
+		if((Get_EVIOOutputters().find(locOutputFileName) == Get_EVIOOutputters().end()) &&
+				(Get_EVIOSkimSinks().find(locOutputFileName) == Get_EVIOSkimSinks().end())) {
 			//not open, open it
 			if(!Open_OutputFile(locEventLoop, locOutputFileName)){
 				jerr << "Unable to open EVIO file \""<< locOutputFileName << "\" for writing!" << endl;
@@ -275,6 +332,24 @@ bool DEventWriterEVIO::Write_EVIOBuffer(JEventLoop* locEventLoop, vector<uint32_
 		}
 
 		//open: get handle, write event
+		map<string, DEVIOSkimSink*>::iterator locSinkIterator = Get_EVIOSkimSinks().find(locOutputFileName);
+		if(locSinkIterator != Get_EVIOSkimSinks().end()) {
+			DEVIOSkimSink *locSkimSink = locSinkIterator->second;
+			japp->Unlock("EVIOWriter");
+
+			// The event MUST be written big endian (see HDEVIOWriter::FlushOutput).
+			// We own the given buffer, as HDEVIOWriter would.
+			shared_ptr<vector<uint32_t> > locSwappedBuffer = make_shared<vector<uint32_t> >(locOutputBuffer->size());
+			swap_bank_out(&(*locSwappedBuffer)[0], &(*locOutputBuffer)[0], locOutputBuffer->size());
+			delete locOutputBuffer;
+
+			if(!locSkimSink->Add_Buffer(locSwappedBuffer)){
+				dNumEventsDropped++;
+				return false; //the file can't be written
+			}
+			return true;
+		}
+
 		HDEVIOWriter *locEVIOWriter = Get_EVIOOutputters()[locOutputFileName];
 		// Add event to output queue
 		locEVIOWriter->AddBufferToOutput(locOutputBuffer);
@@ -284,6 +359,81 @@ bool DEventWriterEVIO::Write_EVIOBuffer(JEventLoop* locEventLoop, vector<uint32_
     return true;
 }
 
+DEVIOSkimBuffer DEventWriterEVIO::Get_SharedBuffer(JEventLoop* locEventLoop, const DEVIOBufferWriter* locBufferWriter, vector<const JObject *> &locObjectsToSave) const
+{
+	// Events written with their own list of objects are not shared with other files
+	set<uint32_t> locROCs = locBufferWriter->GetROCsToWriteOut();
+	if(locObjectsToSave.empty())
+	{
+		if(dSharedBuffersEvent != locEventLoop->GetNevents())
+		{
+			dSharedBuffers.clear();
+			dSharedBuffersEvent = locEventLoop->GetNevents();
+		}
+		map<set<uint32_t>, DEVIOSkimBuffer>::iterator locIterator = dSharedBuffers.find(locROCs);
+		if(locIterator != dSharedBuffers.end())
+			return locIterator->second;
+	}
+
+	// Use the original event if the output would be the same, else re-encode it
+	// from the parsed objects
+	vector<uint32_t> buff;
+	if(Write_RawEvent(locEventLoop, locBufferWriter, locObjectsToSave, buff))
+	{
+		dNumEventsPassedThrough++;
+		dNumBytesPassedThrough += 2*buff.size()*sizeof(uint32_t); // copy + swapped copy
+	}
+	else
+	{
+		if(locObjectsToSave.empty())
+			locBufferWriter->WriteEventToBuffer(locEventLoop, buff);
+		else
+			locBufferWriter->WriteEventToBuffer(locEventLoop, buff, locObjectsToSave);
+		dNumEventsReencoded++;
+		dNumBytesReencoded += 2*buff.size()*sizeof(uint32_t); // encoding + swapped copy
+	}
+
+	// Optionally write buffer to output file
+	if(ofs_debug_output){
+		japp->WriteLock("EVIOWriter");
+		ofs_debug_output->write((const char*)&buff[0], buff.size()*sizeof(uint32_t));
+		japp->Unlock("EVIOWriter");
+	}
+
+	// The event MUST be written big endian (see HDEVIOWriter::FlushOutput)
+	shared_ptr<vector<uint32_t> > locSwappedBuffer = make_shared<vector<uint32_t> >(buff.size());
+	swap_bank_out(&(*locSwappedBuffer)[0], &buff[0], buff.size());
+
+	DEVIOSkimBuffer locSharedBuffer(locSwappedBuffer);
+	if(locObjectsToSave.empty())
+		dSharedBuffers[locROCs] = locSharedBuffer;
+	return locSharedBuffer;
+}
+
+bool DEventWriterEVIO::Write_RawEvent(JEventLoop* locEventLoop, const DEVIOBufferWriter* locBufferWriter, vector<const JObject *> &locObjectsToSave, vector<uint32_t> &buff) const
+{
+	// Copy the original event (host byte order) into buff, with a new EventTag
+	// bank for the current status bits and L3 decision, if the output would
+	// otherwise be the same as re-encoding it: nothing to add or leave out of it.
+	// Returns false if not (or if the source didn't keep it, see
+	// EVIO:KEEP_RAW_EVENT, or it is not a single CODA physics event).
+	if(!PASSTHROUGH || PREFER_EMULATED || !locObjectsToSave.empty())
+		return false;
+	if(!locBufferWriter->GetROCsToWriteOut().empty())
+		return false;
+
+	JEvent& locEvent = locEventLoop->GetJEvent();
+	JEventSource_EVIOpp *locEvioSource = dynamic_cast<JEventSource_EVIOpp*>(locEvent.GetJEventSource());
+	if(locEvioSource == NULL)
+		return false;
+
+	shared_ptr<const uint32_t> locRawEvent = locEvioSource->GetRawEvent(locEvent);
+	if(!locRawEvent)
+		return false;
+
+	return locBufferWriter->WriteRawEventToBuffer(locEventLoop, locRawEvent.get(), buff);
+}
+
 string DEventWriterEVIO::Get_OutputFileName(JEventLoop* locEventLoop, string locOutputFileNameSubString) const
 {
     // if we're merging input files, write everything to the specified file
@@ -319,6 +469,22 @@ bool DEventWriterEVIO::Open_OutputFile(JEventLoop* locEventLoop, string locOutpu
 	//ASSUMES A LOCK HAS ALREADY BEEN ACQUIRED (by WriteEVIOEvent)
 	// and assume that it doesn't exist
 
+	// Files written with DEVIOSkimSink, which runs its own thread
+	if(SKIM_ROUTER && (locOutputFileName.substr(0,3) != "ET:"))
+	{
+		DEVIOSkimSink *locSkimSink = new DEVIOSkimSink(locOutputFileName, MAX_OUTPUT_QUEUE_SIZE, NEVENTS_PER_BLOCK, 250*1024, MAX_HOLD_TIME);
+		if(!locSkimSink->Is_Open())
+		{
+			jerr << "Unable to open EVIO file " << locOutputFileName << endl;
+			delete locSkimSink;
+			return false;
+		}
+		jout << "Output EVIO file " << locOutputFileName << " created." << endl;
+		Get_EVIOSkimSinks()[locOutputFileName] = locSkimSink;
+		Get_EVIOBufferWriters()[locOutputFileName] = new DEVIOBufferWriter(COMPACT, PREFER_EMULATED);
+		return true;
+	}
+
 	// Create object to write the selected events to a file or ET system
 	// Run each connection in their own thread
 	HDEVIOWriter *locEVIOout = new HDEVIOWriter(locOutputFileName);
@@ -345,6 +511,12 @@ DEventWriterEVIO::~DEventWriterEVIO(void)
 {
 	japp->WriteLock("EVIOWriter");
 	{
+		Get_EVIOWriteStats()["NEVENTS_PASSED_THROUGH"] += dNumEventsPassedThrough;
+		Get_EVIOWriteStats()["NBYTES_PASSED_THROUGH"] += dNumBytesPassedThrough;
+		Get_EVIOWriteStats()["NEVENTS_REENCODED"] += dNumEventsReencoded;
+		Get_EVIOWriteStats()["NBYTES_REENCODED"] += dNumBytesReencoded;
+		Get_EVIOWriteStats()["NEVENTS_DROPPED"] += dNumEventsDropped;
+
 		--Get_NumEVIOOutputThreads();
 		if(Get_NumEVIOOutputThreads() > 0)
 		{
@@ -352,6 +524,20 @@ DEventWriterEVIO::~DEventWriterEVIO(void)
 			return; //not the last thread writing to EVIO files
 		}
 
+		//last thread: report how the events were built
+		map<string, uint64_t> &locStats = Get_EVIOWriteStats();
+		if(locStats["NEVENTS_PASSED_THROUGH"] + locStats["NEVENTS_REENCODED"] > 0)
+		{
+			jout << "EVIO output: " << locStats["NEVENTS_PASSED_THROUGH"] << " events passed through ("
+			     << (locStats["NEVENTS_PASSED_THROUGH"] ? locStats["NBYTES_PASSED_THROUGH"]/locStats["NEVENTS_PASSED_THROUGH"] : 0)
+			     << " bytes copied per event), " << locStats["NEVENTS_REENCODED"] << " events re-encoded ("
+			     << (locStats["NEVENTS_REENCODED"] ? locStats["NBYTES_REENCODED"]/locStats["NEVENTS_REENCODED"] : 0)
+			     << " bytes copied per event)" << endl;
+		}
+		if(locStats["NEVENTS_DROPPED"] > 0)
+			jerr << "EVIO output: " << locStats["NEVENTS_DROPPED"] << " events were NOT written (output file error)" << endl;
+		locStats.clear();
+
 		//last thread writing to EVIO files: close all files and free all memory
 		map<string, HDEVIOWriter *>::iterator locIterator = Get_EVIOOutputters().begin();
 		for(; locIterator != Get_EVIOOutputters().end(); ++locIterator)
@@ -372,6 +558,18 @@ DEventWriterEVIO::~DEventWriterEVIO(void)
 		}
 		Get_EVIOOutputters().clear();
 		Get_EVIOOutputThreads().clear();
+
+		map<string, DEVIOSkimSink *>::iterator locSinkIterator = Get_EVIOSkimSinks().begin();
+		for(; locSinkIterator != Get_EVIOSkimSinks().end(); ++locSinkIterator)
+		{
+			// write out the remaining events, join the output thread and close the file
+			locSinkIterator->second->Close();
+			std::cout << "Closed EVIO file " << locSinkIterator->first << " (" << locSinkIterator->second->Get_NumEventsWritten() << " events)" << std::endl;
+			if(locSinkIterator->second->Has_Error())
+				jerr << "EVIO file " << locSinkIterator->first << " is incomplete: " << locSinkIterator->second->Get_NumEventsDropped() << " events were NOT written" << endl;
+			delete locSinkIterator->second;
+		}
+		Get_EVIOSkimSinks().clear();
 	}
 	japp->Unlock("EVIOWriter");
 }
@@ -16,6 +16,7 @@
 #include <pthread.h>
 #include <stdint.h>
 #include <fstream>
+#include <memory>
 
 #include <JANA/JEventLoop.h>
 
@@ -39,6 +40,8 @@
 #include <DANA/DStatusBits.h>
 #include <TTAB/DTranslationTable.h>
 
+#include <DEVIOSkimRouter.h>
+
 #include "HDEVIOWriter.h"
 #include "DEVIOBufferWriter.h"
 
@@ -70,9 +73,16 @@ class DEventWriterEVIO : public JObject
 		bool COMPACT;
 		bool PREFER_EMULATED;
 		bool DEBUG_FILES;
+		bool SKIM_ROUTER;
+		bool PASSTHROUGH;
+		uint32_t MAX_OUTPUT_QUEUE_SIZE;
+		uint32_t MAX_HOLD_TIME;
+		uint32_t NEVENTS_PER_BLOCK;
 
 	protected:
 		bool Open_OutputFile(JEventLoop* locEventLoop, string locOutputFileName) const;
+		DEVIOSkimBuffer Get_SharedBuffer(JEventLoop* locEventLoop, const DEVIOBufferWriter* locBufferWriter, vector<const JObject *> &locObjectsToSave) const;
+		bool Write_RawEvent(JEventLoop* locEventLoop, const DEVIOBufferWriter* locBufferWriter, vector<const JObject *> &locObjectsToSave, vector<uint32_t> &buff) const;
 		
 		std::ofstream *ofs_debug_input;
 		std::ofstream *ofs_debug_output;
@@ -83,11 +93,26 @@ class DEventWriterEVIO : public JObject
         bool dMergeFiles;
         string dMergedFilename;
 
+		// Output buffers of the current event of this thread (byte swapped for
+		// writing), by selection of ROCs, shared by all files that take the event
+		mutable uint64_t dSharedBuffersEvent;
+		mutable map<set<uint32_t>, DEVIOSkimBuffer> dSharedBuffers;
+
+		// Events written by this thread from the original EVIO event or re-encoded,
+		// and the bytes copied into output buffers for them
+		mutable uint64_t dNumEventsPassedThrough;
+		mutable uint64_t dNumBytesPassedThrough;
+		mutable uint64_t dNumEventsReencoded;
+		mutable uint64_t dNumBytesReencoded;
+		mutable uint64_t dNumEventsDropped; // the output file couldn't take them
+
 	private:
 
 		//contain static variables shared amongst threads: acquire "EVIOWriter" write lock before calling
 		size_t& Get_NumEVIOOutputThreads(void) const;
 		map<string, HDEVIOWriter*>& Get_EVIOOutputters(void) const;
+		map<string, DEVIOSkimSink*>& Get_EVIOSkimSinks(void) const;
+		map<string, uint64_t>& Get_EVIOWriteStats(void) const;
 		map<string, pthread_t>& Get_EVIOOutputThreads(void) const;
         map<string, DEVIOBufferWriter*>& Get_EVIOBufferWriters(void) const;
 };
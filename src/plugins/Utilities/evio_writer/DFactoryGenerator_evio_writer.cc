@@ -7,6 +7,16 @@ extern "C"
 	{
 		InitJANAPlugin(app);
 		app->AddFactoryGenerator(new DFactoryGenerator_evio_writer());
+
+		// Have the EVIO source keep the original event buffers so events can
+		// be written out without re-encoding them (must be set before the
+		// source is opened)
+		bool PASSTHROUGH = false;
+		gPARMS->SetDefaultParameter("EVIOOUT:PASSTHROUGH", PASSTHROUGH, "Write the original EVIO event (with a new EventTag bank) when the output would otherwise be the same (no objects to add, no selection of detectors, EVIOOUT:PREFER_EMULATED off) instead of re-encoding it from the parsed objects. EVIOOUT:COMPACT is not applied to these events. Requires EVIO:KEEP_RAW_EVENT, which this turns on by default.");
+		if(PASSTHROUGH){
+			bool KEEP_RAW_EVENT = true;
+			gPARMS->SetDefaultParameter("EVIO:KEEP_RAW_EVENT", KEEP_RAW_EVENT, "Keep the original EVIO buffer of each event (not of blocks of entangled events) so it can be written out without re-encoding it (see EVIOOUT:PASSTHROUGH). This is turned on by the evio_writer plugin.");
+		}
 	}
 } // "C"
 
@@ -0,0 +1,273 @@
+// $Id$
+//
+//    File: JEventProcessor_kalman_lockstep_compare.cc
+//
+
+#include <sys/time.h>
+#include <iomanip>
+#include <cmath>
+
+#include "JEventProcessor_kalman_lockstep_compare.h"
+using namespace jana;
+
+// Routine used to create our JEventProcessor
+#include <JANA/JApplication.h>
+
+#include <TRACKING/DKalmanSoA.h>
+#include <particleType.h>
+
+extern "C"{
+void InitPlugin(JApplication *app){
+	InitJANAPlugin(app);
+	app->AddProcessor(new JEventProcessor_kalman_lockstep_compare());
+}
+} // "C"
+
+static double GetTime(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + 1.0E-6*(double)tv.tv_usec;
+}
+
+static double RelDiff(double a, double b)
+{
+	double norm = max(fabs(a), fabs(b));
+	if(norm == 0.0)return 0.0;
+	return fabs(a - b)/norm;
+}
+
+//------------------
+// JEventProcessor_kalman_lockstep_compare (Constructor)
+//------------------
+JEventProcessor_kalman_lockstep_compare::JEventProcessor_kalman_lockstep_compare()
+{
+	pthread_mutex_init(&mutex, NULL);
+	Nevents = 0;
+}
+
+//------------------
+// ~JEventProcessor_kalman_lockstep_compare (Destructor)
+//------------------
+JEventProcessor_kalman_lockstep_compare::~JEventProcessor_kalman_lockstep_compare()
+{
+	for(map<JEventLoop*, DThreadFitters*>::iterator iter = thread_fitters.begin(); iter != thread_fitters.end(); iter++){
+		DThreadFitters *fitters = iter->second;
+		for(unsigned int i=0; i<fitters->dLaneFitters.size(); i++)
+			delete fitters->dLaneFitters[i];
+		delete fitters->dScalarFitter;
+		delete fitters;
+	}
+}
+
+//------------------
+// init
+//------------------
+jerror_t JEventProcessor_kalman_lockstep_compare::init(void)
+{
+	TIME_BASED = false;
+	TOLERANCE = 1.0E-9;
+	gPARMS->SetDefaultParameter("KLCOMPARE:TIME_BASED", TIME_BASED, "Refit the tracks time-based (using the t0 of the wire-based track) instead of wire-based");
+	gPARMS->SetDefaultParameter("KLCOMPARE:TOLERANCE", TOLERANCE, "Largest relative difference of the lockstep and the scalar fit results that is counted as agreement");
+
+	return NOERROR;
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t JEventProcessor_kalman_lockstep_compare::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	vector<const DTrackWireBased*> tracks;
+	loop->Get(tracks);
+
+	// Tracks fit in lockstep: only FDC hits
+	vector<const DTrackWireBased*> fdc_tracks;
+	for(unsigned int i=0; i<tracks.size(); i++){
+		vector<const DCDCTrackHit*> cdchits;
+		vector<const DFDCPseudo*> fdchits;
+		tracks[i]->Get(cdchits);
+		tracks[i]->Get(fdchits);
+		if(cdchits.empty() && !fdchits.empty())
+			fdc_tracks.push_back(tracks[i]);
+	}
+
+	DCompareStats event_hypotheses_stats;
+	DCompareStats event_tracks_stats;
+	if(!fdc_tracks.empty()){
+		DThreadFitters *fitters = Get_Fitters(loop, max((unsigned int)DKalmanSoA::kLanes, (unsigned int)fdc_tracks.size()));
+
+		// Several mass hypotheses of one track
+		for(unsigned int i=0; i<fdc_tracks.size(); i++){
+			bool positive = (fdc_tracks[i]->charge() > 0.0);
+			vector<double> masses;
+			masses.push_back(ParticleMass(positive ? Positron : Electron));
+			masses.push_back(ParticleMass(positive ? PiPlus : PiMinus));
+			masses.push_back(ParticleMass(positive ? KPlus : KMinus));
+			masses.push_back(ParticleMass(positive ? Proton : AntiProton));
+			vector<const DTrackWireBased*> hypotheses(masses.size(), fdc_tracks[i]);
+			Compare_Fits(hypotheses, masses, fitters, event_hypotheses_stats);
+		}
+
+		// Several tracks at once
+		vector<double> masses;
+		for(unsigned int i=0; i<fdc_tracks.size(); i++)
+			masses.push_back(fdc_tracks[i]->mass());
+		Compare_Fits(fdc_tracks, masses, fitters, event_tracks_stats);
+	}
+
+	pthread_mutex_lock(&mutex);
+	Nevents++;
+	DCompareStats *stats[2] = {&hypotheses_stats, &tracks_stats};
+	const DCompareStats *event_stats[2] = {&event_hypotheses_stats, &event_tracks_stats};
+	for(unsigned int i=0; i<2; i++){
+		stats[i]->dNumFits += event_stats[i]->dNumFits;
+		stats[i]->dNumStatusDiffs += event_stats[i]->dNumStatusDiffs;
+		stats[i]->dNumOverTolerance += event_stats[i]->dNumOverTolerance;
+		stats[i]->dMaxRelDiff = max(stats[i]->dMaxRelDiff, event_stats[i]->dMaxRelDiff);
+		stats[i]->dLockstepTime += event_stats[i]->dLockstepTime;
+		stats[i]->dScalarTime += event_stats[i]->dScalarTime;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return NOERROR;
+}
+
+//------------------
+// Get_Fitters
+//------------------
+JEventProcessor_kalman_lockstep_compare::DThreadFitters* JEventProcessor_kalman_lockstep_compare::Get_Fitters(JEventLoop *loop, unsigned int num_fitters)
+{
+	// The fitters keep the event loop they were made with: one set per thread
+	pthread_mutex_lock(&mutex);
+	DThreadFitters *&fitters = thread_fitters[loop];
+	if(fitters == NULL)
+		fitters = new DThreadFitters();
+	pthread_mutex_unlock(&mutex);
+
+	// New run: new calibrations
+	int32_t run_number = loop->GetJEvent().GetRunNumber();
+	if(fitters->dRunNumber != run_number){
+		for(unsigned int i=0; i<fitters->dLaneFitters.size(); i++)
+			delete fitters->dLaneFitters[i];
+		fitters->dLaneFitters.clear();
+		delete fitters->dScalarFitter;
+		fitters->dScalarFitter = new DTrackFitterKalmanSIMD(loop);
+		fitters->dRunNumber = run_number;
+	}
+	while(fitters->dLaneFitters.size() < num_fitters)
+		fitters->dLaneFitters.push_back(new DTrackFitterKalmanSIMD(loop));
+
+	return fitters;
+}
+
+//------------------
+// Setup_Fitter
+//------------------
+void JEventProcessor_kalman_lockstep_compare::Setup_Fitter(DTrackFitterKalmanSIMD* fitter, const DTrackWireBased* track, double mass) const
+{
+	vector<const DFDCPseudo*> fdchits;
+	track->Get(fdchits);
+
+	fitter->Reset();
+	fitter->SetFitType(TIME_BASED ? DTrackFitter::kTimeBased : DTrackFitter::kWireBased);
+	fitter->AddHits(fdchits);
+
+	DTrackingData input_params = *track;
+	input_params.setPID(IDTrack(track->charge(), mass));
+	fitter->SetInputParameters(input_params);
+}
+
+//------------------
+// Compare_Fits
+//------------------
+void JEventProcessor_kalman_lockstep_compare::Compare_Fits(const vector<const DTrackWireBased*>& tracks, const vector<double>& masses,
+		DThreadFitters* fitters, DCompareStats& stats) const
+{
+	vector<DTrackFitterKalmanSIMD*> lane_fitters(fitters->dLaneFitters.begin(), fitters->dLaneFitters.begin() + tracks.size());
+	for(unsigned int i=0; i<tracks.size(); i++)
+		Setup_Fitter(lane_fitters[i], tracks[i], masses[i]);
+
+	vector<DTrackFitter::fit_status_t> status;
+	double t_start = GetTime();
+	DTrackFitterKalmanSIMD::FitTracksLockstep(lane_fitters, status);
+	stats.dLockstepTime += GetTime() - t_start;
+
+	DTrackFitterKalmanSIMD *scalar = fitters->dScalarFitter;
+	for(unsigned int i=0; i<tracks.size(); i++){
+		Setup_Fitter(scalar, tracks[i], masses[i]);
+		t_start = GetTime();
+		DTrackFitter::fit_status_t scalar_status = scalar->FitTrack();
+		stats.dScalarTime += GetTime() - t_start;
+
+		stats.dNumFits++;
+		if(status[i] != scalar_status){
+			stats.dNumStatusDiffs++;
+			continue;
+		}
+		if(scalar_status != DTrackFitter::kFitSuccess)
+			continue;
+
+		double rel_diff = Compare_Results(lane_fitters[i], scalar);
+		stats.dMaxRelDiff = max(stats.dMaxRelDiff, rel_diff);
+		if(rel_diff > TOLERANCE)
+			stats.dNumOverTolerance++;
+	}
+}
+
+//------------------
+// Compare_Results
+//------------------
+double JEventProcessor_kalman_lockstep_compare::Compare_Results(DTrackFitterKalmanSIMD* lockstep, DTrackFitterKalmanSIMD* scalar) const
+{
+	double rel_diff = RelDiff(lockstep->GetChisq(), scalar->GetChisq());
+	if(lockstep->GetNdof() != scalar->GetNdof())
+		return 1.0;
+
+	const DTrackingData &lockstep_params = lockstep->GetFitParameters();
+	const DTrackingData &scalar_params = scalar->GetFitParameters();
+	for(int i=0; i<3; i++){
+		rel_diff = max(rel_diff, RelDiff(lockstep_params.momentum()(i), scalar_params.momentum()(i)));
+		rel_diff = max(rel_diff, RelDiff(lockstep_params.position()(i), scalar_params.position()(i)));
+	}
+
+	vector<vector<double> > lockstep_cov, scalar_cov;
+	lockstep->GetForwardCovarianceMatrix(lockstep_cov);
+	scalar->GetForwardCovarianceMatrix(scalar_cov);
+	if(lockstep_cov.size() != scalar_cov.size())
+		return 1.0;
+	for(unsigned int i=0; i<scalar_cov.size(); i++){
+		for(unsigned int j=0; j<scalar_cov[i].size(); j++)
+			rel_diff = max(rel_diff, RelDiff(lockstep_cov[i][j], scalar_cov[i][j]));
+	}
+
+	return rel_diff;
+}
+
+//------------------
+// fini
+//------------------
+jerror_t JEventProcessor_kalman_lockstep_compare::fini(void)
+{
+	if(Nevents == 0)return NOERROR;
+
+	jout << endl;
+	jout << "Lockstep vs. scalar KalmanSIMD fits (" << DKalmanSoA::kLanes << " lanes): " << Nevents << " events, tolerance " << TOLERANCE << endl;
+	jout << setw(12) << "mode" << setw(12) << "fits" << setw(14) << "status diffs" << setw(14) << "max rel diff";
+	jout << setw(14) << "> tolerance" << setw(16) << "lockstep us/fit" << setw(16) << "scalar us/fit" << endl;
+	const char *modes[2] = {"hypotheses", "tracks"};
+	const DCompareStats *stats[2] = {&hypotheses_stats, &tracks_stats};
+	for(unsigned int i=0; i<2; i++){
+		const DCompareStats &s = *stats[i];
+		double Nfits = s.dNumFits ? double(s.dNumFits) : 1.0;
+		jout << setw(12) << modes[i] << setw(12) << s.dNumFits;
+		jout << setw(14) << double(s.dNumStatusDiffs)/Nfits;
+		jout << setw(14) << s.dMaxRelDiff;
+		jout << setw(14) << double(s.dNumOverTolerance)/Nfits;
+		jout << setw(16) << 1.0E6*s.dLockstepTime/Nfits;
+		jout << setw(16) << 1.0E6*s.dScalarTime/Nfits << endl;
+	}
+	jout << endl;
+
+	return NOERROR;
+}
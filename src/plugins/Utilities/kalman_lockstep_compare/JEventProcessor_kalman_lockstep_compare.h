@@ -0,0 +1,80 @@
+// $Id$
+//
+//    File: JEventProcessor_kalman_lockstep_compare.h
+//
+
+#ifndef _JEventProcessor_kalman_lockstep_compare_
+#define _JEventProcessor_kalman_lockstep_compare_
+
+#include <map>
+#include <vector>
+#include <pthread.h>
+using namespace std;
+
+#include <JANA/JEventProcessor.h>
+
+#include <TRACKING/DTrackWireBased.h>
+#include <TRACKING/DTrackFitterKalmanSIMD.h>
+
+// Validates DTrackFitterKalmanSIMD::FitTracksLockstep against the scalar fitter (FitTrack).
+// The wire-based tracks with only FDC hits are refit from their hits and parameters:
+//   hypotheses mode: the electron, pion, kaon and proton hypotheses of each track together
+//   tracks mode:     the tracks of the event together, each with its own mass
+// and every lockstep result is compared to a FitTrack of the same track and mass.
+// Reported at the end: the number of fits, the fraction with a different fit status, the
+// largest relative difference of chi2, ndf, momentum, position and error matrix, the
+// fraction of fits with a difference above KLCOMPARE:TOLERANCE, and the time per fit.
+
+class JEventProcessor_kalman_lockstep_compare:public jana::JEventProcessor{
+	public:
+		JEventProcessor_kalman_lockstep_compare();
+		~JEventProcessor_kalman_lockstep_compare();
+		const char* className(void){return "JEventProcessor_kalman_lockstep_compare";}
+
+		class DCompareStats
+		{
+			public:
+				DCompareStats(void) : dNumFits(0), dNumStatusDiffs(0), dNumOverTolerance(0), dMaxRelDiff(0.0),
+					dLockstepTime(0.0), dScalarTime(0.0) {}
+
+				unsigned long dNumFits;
+				unsigned long dNumStatusDiffs;
+				unsigned long dNumOverTolerance;
+				double dMaxRelDiff;
+				double dLockstepTime; //s
+				double dScalarTime; //s
+		};
+
+		// Fitters for one thread (JEventLoop)
+		class DThreadFitters
+		{
+			public:
+				DThreadFitters(void) : dRunNumber(-1), dScalarFitter(NULL) {}
+
+				int32_t dRunNumber;
+				vector<DTrackFitterKalmanSIMD*> dLaneFitters;
+				DTrackFitterKalmanSIMD* dScalarFitter;
+		};
+
+	private:
+		jerror_t init(void);						///< Called once at program start.
+		jerror_t evnt(jana::JEventLoop *eventLoop, uint64_t eventnumber);	///< Called every event.
+		jerror_t fini(void);						///< Called after last event of last event source has been processed.
+
+		DThreadFitters* Get_Fitters(jana::JEventLoop *loop, unsigned int num_fitters);
+		void Setup_Fitter(DTrackFitterKalmanSIMD* fitter, const DTrackWireBased* track, double mass) const;
+		void Compare_Fits(const vector<const DTrackWireBased*>& tracks, const vector<double>& masses, DThreadFitters* fitters,
+				DCompareStats& stats) const;
+		double Compare_Results(DTrackFitterKalmanSIMD* lockstep, DTrackFitterKalmanSIMD* scalar) const;
+
+		bool TIME_BASED;
+		double TOLERANCE;
+
+		pthread_mutex_t mutex;
+		map<jana::JEventLoop*, DThreadFitters*> thread_fitters;
+		unsigned long Nevents;
+		DCompareStats hypotheses_stats;
+		DCompareStats tracks_stats;
+};
+
+#endif // _JEventProcessor_kalman_lockstep_compare_
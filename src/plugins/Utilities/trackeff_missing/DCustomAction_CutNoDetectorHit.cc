@@ -171,7 +171,7 @@ bool DCustomAction_CutNoDetectorHit::Perform_Action(JEventLoop* locEventLoop, co
 
 
 	TMatrixDSym locMissingCovarianceMatrix(3);
-	const TMatrixFSym& locKinFitCovarianceMatrix = *(locMissingParticle->errorMatrix());
+	const DMatrixFSym7& locKinFitCovarianceMatrix = *(locMissingParticle->errorMatrix());
 	for(unsigned int loc_q = 0; loc_q < 3; ++loc_q)
 	{
 		for(unsigned int loc_r = 0; loc_r < 3; ++loc_r)
@@ -196,7 +196,7 @@ bool DCustomAction_CutNoDetectorHit::Perform_Action(JEventLoop* locEventLoop, co
 		DVector3 locTimeBasedDP3 = locTimeBasedTrack->momentum();
 		TVector3 locTimeBasedP3(locTimeBasedDP3.X(), locTimeBasedDP3.Y(), locTimeBasedDP3.Z());
 
-		const TMatrixFSym& locCovarianceMatrix = *(locTimeBasedTrack->errorMatrix());
+		const DMatrixFSym7& locCovarianceMatrix = *(locTimeBasedTrack->errorMatrix());
 		TMatrixDSym locDCovarianceMatrix(3);
 		for(unsigned int loc_j = 0; loc_j < 3; ++loc_j)
 		{
@@ -134,7 +134,7 @@ bool DCustomAction_TrackingEfficiency::Perform_Action(JEventLoop* locEventLoop,
 	else //kinfit succeeded
 	{
 		locMissingP3 = locMissingParticle->momentum();
-		const TMatrixFSym& locKinFitCovarianceMatrix = *(locMissingParticle->errorMatrix());
+		const DMatrixFSym7& locKinFitCovarianceMatrix = *(locMissingParticle->errorMatrix());
 		for(unsigned int loc_q = 0; loc_q < 3; ++loc_q)
 		{
 			for(unsigned int loc_r = 0; loc_r < 3; ++loc_r)
@@ -207,7 +207,7 @@ bool DCustomAction_TrackingEfficiency::Perform_Action(JEventLoop* locEventLoop,
 			dTreeFillData.Fill_Array<TVector3>("ReconP3_WireBased", locWireBasedP3, locNumWireBasedTracks);
 			dTreeFillData.Fill_Array<Float_t>("ReconTrackingFOM_WireBased", locWireBasedTrack->FOM, locNumWireBasedTracks);
 
-			const TMatrixFSym& locCovarianceMatrix = *(locWireBasedTrack->errorMatrix());
+			const DMatrixFSym7& locCovarianceMatrix = *(locWireBasedTrack->errorMatrix());
 			TMatrixDSym locDCovarianceMatrix(3);
 			for(unsigned int loc_j = 0; loc_j < 3; ++loc_j)
 			{
@@ -255,7 +255,7 @@ bool DCustomAction_TrackingEfficiency::Perform_Action(JEventLoop* locEventLoop,
 		dTreeFillData.Fill_Array<TVector3>("ReconP3", locTimeBasedP3, locNumTimeBasedTracks);
 		dTreeFillData.Fill_Array<Float_t>("ReconTrackingFOM", locTimeBasedTrack->FOM, locNumTimeBasedTracks);
 
-		const TMatrixFSym& locCovarianceMatrix = *(locTimeBasedTrack->errorMatrix());
+		const DMatrixFSym7& locCovarianceMatrix = *(locTimeBasedTrack->errorMatrix());
 		TMatrixDSym locDCovarianceMatrix(3);
 		for(unsigned int loc_j = 0; loc_j < 3; ++loc_j)
 		{
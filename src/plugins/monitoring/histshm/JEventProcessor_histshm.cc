@@ -0,0 +1,200 @@
+// $Id$
+//
+//    File: JEventProcessor_histshm.cc
+//
+
+#include <unistd.h>
+#include <chrono>
+#include <sstream>
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TH1.h>
+
+#include "JEventProcessor_histshm.h"
+using namespace jana;
+
+// Routine used to create our JEventProcessor
+#include <JANA/JApplication.h>
+#include <JANA/JFactory.h>
+extern "C"{
+	void InitPlugin(JApplication *app){
+		InitJANAPlugin(app);
+		app->AddProcessor(new JEventProcessor_histshm());
+	}
+} // "C"
+
+
+//------------------
+// JEventProcessor_histshm (Constructor)
+//------------------
+JEventProcessor_histshm::JEventProcessor_histshm()
+{
+	Nevents = 0;
+	Nskipped = 0;
+	warned_full = false;
+	export_thread = NULL;
+	done = false;
+}
+
+//------------------
+// ~JEventProcessor_histshm (Destructor)
+//------------------
+JEventProcessor_histshm::~JEventProcessor_histshm()
+{
+
+}
+
+//------------------
+// init
+//------------------
+jerror_t JEventProcessor_histshm::init(void)
+{
+	stringstream ss;
+	ss << "/halld_histshm_" << getpid();
+	NAME = ss.str();
+	PERIOD = 1.0;
+	SIZE_MB = 64;
+	KEEP = false;
+	gPARMS->SetDefaultParameter("HISTSHM:NAME", NAME, "Name of the shared memory region the histograms are exported to (appears in /dev/shm)");
+	gPARMS->SetDefaultParameter("HISTSHM:PERIOD", PERIOD, "Seconds between two exports of the histograms");
+	gPARMS->SetDefaultParameter("HISTSHM:SIZE_MB", SIZE_MB, "Size of each of the two snapshot buffers in MB. Histograms that don't fit are left out.");
+	gPARMS->SetDefaultParameter("HISTSHM:KEEP", KEEP, "Set to 1 to keep the shared memory region (with the final histograms) after the program ends");
+
+	if(!writer.Open(NAME, (uint64_t)SIZE_MB*1024*1024)){
+		jerr << "Unable to create shared memory region " << NAME << " for the histograms!" << endl;
+		return NOERROR;
+	}
+	jout << "Exporting histograms to shared memory region " << NAME << " every " << PERIOD << " s" << endl;
+
+	export_thread = new thread(&JEventProcessor_histshm::ExportThread, this);
+
+	return NOERROR;
+}
+
+//------------------
+// brun
+//------------------
+jerror_t JEventProcessor_histshm::brun(JEventLoop *eventLoop, int32_t runnumber)
+{
+	return NOERROR;
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t JEventProcessor_histshm::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	Nevents++;
+
+	return NOERROR;
+}
+
+//------------------
+// erun
+//------------------
+jerror_t JEventProcessor_histshm::erun(void)
+{
+	return NOERROR;
+}
+
+//------------------
+// fini
+//------------------
+jerror_t JEventProcessor_histshm::fini(void)
+{
+	if(export_thread){
+		{
+			lock_guard<mutex> lck(export_mutex);
+			done = true;
+		}
+		export_cv.notify_all();
+		export_thread->join();
+		delete export_thread;
+		export_thread = NULL;
+
+		// Final histograms
+		Export();
+	}
+	writer.Close(!KEEP);
+
+	return NOERROR;
+}
+
+//------------------
+// ExportThread
+//------------------
+void JEventProcessor_histshm::ExportThread(void)
+{
+	unique_lock<mutex> lck(export_mutex);
+	while(!done){
+		export_cv.wait_for(lck, chrono::duration<double>(PERIOD));
+		if(done) break;
+		lck.unlock();
+		Export();
+		lck.lock();
+	}
+}
+
+//------------------
+// Export
+//------------------
+void JEventProcessor_histshm::Export(void)
+{
+	if(!writer.IsOpen()) return;
+
+	writer.BeginSnapshot();
+	Nskipped = 0;
+
+	// Histograms are created and deleted under the write lock, so they
+	// all stay in place while we hold the read lock. Filling can go on
+	// meanwhile in plugins that use RootFillLock, so a snapshot may
+	// have bins of a histogram from slightly different times.
+	japp->RootReadLock();
+	ExportDirectory(gROOT, "");
+	TIter next(gROOT->GetListOfFiles());
+	while(TObject *obj = next()){
+		TDirectory *dir = dynamic_cast<TDirectory*>(obj);
+		if(dir) ExportDirectory(dir, "");
+	}
+	japp->RootUnLock();
+
+	double now = chrono::duration<double>(chrono::system_clock::now().time_since_epoch()).count();
+	writer.EndSnapshot(Nevents, now);
+
+	if(Nskipped && !warned_full){
+		jerr << Nskipped << " histograms didn't fit in shared memory region " << NAME << ". Increase HISTSHM:SIZE_MB to export them." << endl;
+		warned_full = true;
+	}
+}
+
+//------------------
+// ExportDirectory
+//------------------
+void JEventProcessor_histshm::ExportDirectory(TDirectory *dir, string path)
+{
+	TIter next(dir->GetList());
+	while(TObject *obj = next()){
+		if(obj->InheritsFrom(TDirectory::Class())){
+			ExportDirectory((TDirectory*)obj, path + obj->GetName() + "/");
+			continue;
+		}
+		if(!obj->InheritsFrom(TH1::Class())) continue;
+
+		TH1 *h = (TH1*)obj;
+		int ndim = h->GetDimension();
+		if(ndim > 2) continue;
+		TAxis *xaxis = h->GetXaxis();
+		TAxis *yaxis = h->GetYaxis();
+		double *contents = writer.AddHistogram(path + h->GetName(), h->GetTitle(), ndim,
+				xaxis->GetNbins(), xaxis->GetXmin(), xaxis->GetXmax(),
+				yaxis->GetNbins(), yaxis->GetXmin(), yaxis->GetXmax(), h->GetEntries());
+		if(!contents){
+			Nskipped++;
+			continue;
+		}
+		int ncells = (xaxis->GetNbins() + 2)*(ndim>1 ? yaxis->GetNbins() + 2:1);
+		for(int i=0; i<ncells; i++) contents[i] = h->GetBinContent(i);
+	}
+}
+
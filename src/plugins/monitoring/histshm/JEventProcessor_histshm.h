@@ -0,0 +1,65 @@
+// $Id$
+//
+//    File: JEventProcessor_histshm.h
+//
+
+#ifndef _JEventProcessor_histshm_
+#define _JEventProcessor_histshm_
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+
+#include <JANA/JEventProcessor.h>
+
+#include <TDirectory.h>
+
+#include <DSharedHistograms.h>
+
+using namespace std;
+
+/// Exports all histograms of the process (those of the online monitoring
+/// plugins in particular) to a shared memory region, from which other
+/// processes can read consistent snapshots at any time without locking
+/// anything in this one (see DSharedHistograms.h and histshm_dump).
+///
+/// A dedicated thread copies the bin contents every HISTSHM:PERIOD
+/// seconds. It holds the ROOT read lock during the copy, which only
+/// delays plugins that fill under RootWriteLock by the time of a
+/// memory copy, but never waits for a reader.
+class JEventProcessor_histshm:public jana::JEventProcessor{
+	public:
+		JEventProcessor_histshm();
+		~JEventProcessor_histshm();
+		const char* className(void){return "JEventProcessor_histshm";}
+
+	private:
+		jerror_t init(void);						///< Called once at program start.
+		jerror_t brun(jana::JEventLoop *eventLoop, int32_t runnumber);	///< Called everytime a new run number is detected.
+		jerror_t evnt(jana::JEventLoop *eventLoop, uint64_t eventnumber);	///< Called every event.
+		jerror_t erun(void);						///< Called everytime run number changes, provided brun has been called.
+		jerror_t fini(void);						///< Called after last event of last event source has been processed.
+
+		void ExportThread(void);
+		void Export(void);
+		void ExportDirectory(TDirectory *dir, string path);
+
+		string NAME;
+		double PERIOD;
+		unsigned int SIZE_MB;
+		bool KEEP;
+
+		DSharedHistogramsWriter writer;
+		atomic<uint64_t> Nevents;
+		unsigned int Nskipped;     // histograms that didn't fit in the last snapshot
+		bool warned_full;
+
+		thread *export_thread;
+		mutex export_mutex;
+		condition_variable export_cv;
+		bool done;
+};
+
+#endif // _JEventProcessor_histshm_
+
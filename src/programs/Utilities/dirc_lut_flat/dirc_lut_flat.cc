@@ -0,0 +1,80 @@
+// dirc_lut_flat.cc
+//
+// Convert a DIRC lookup table from the ROOT "lut_dirc_flat" tree into the
+// binary format that DDIRCLutReader memory-maps (see DDIRCLutFlat.h).
+//
+
+#include <iostream>
+#include <string>
+using namespace std;
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <DIRC/DDIRCLutFlat.h>
+
+void Usage(void);
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	string infile, outfile, source;
+	for(int i=1; i<narg; i++){
+		string arg(argv[i]);
+		if(arg=="-h" || arg=="--help"){Usage(); exit(0);}
+		else if(arg=="-n" && i+1<narg) source = argv[++i];
+		else if(infile.empty()) infile = arg;
+		else if(outfile.empty()) outfile = arg;
+		else{
+			cerr<<"Unexpected argument: "<<arg<<endl;
+			Usage();
+			exit(-1);
+		}
+	}
+	if(infile.empty() || outfile.empty()){Usage(); exit(-1);}
+	if(source.empty()) source = infile;
+
+	uint64_t checksum;
+	if(!DDIRCLutFlat::Checksum(infile, checksum)) return -1;
+
+	DDIRCLutFlat lut;
+	cout<<"Reading DIRC LUT TTree from "<<infile<<" ..."<<endl;
+	if(!lut.ReadROOT(infile, source, checksum)) return -1;
+	cout<<"  "<<lut.GetNentries()<<" entries"<<endl;
+
+	if(!lut.Write(outfile)) return -2;
+
+	// Read it back through the same path the reconstruction uses
+	DDIRCLutFlat check;
+	if(!check.Map(outfile, source, checksum) || check.GetNentries()!=lut.GetNentries()){
+		cerr<<"Unable to map back "<<outfile<<"!"<<endl;
+		return -3;
+	}
+	cout<<"Wrote "<<outfile<<endl;
+
+	return 0;
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+	cout<<endl;
+	cout<<"Usage:"<<endl;
+	cout<<"   dirc_lut_flat [options] lut.root lut.bin"<<endl;
+	cout<<endl;
+	cout<<" options:"<<endl;
+	cout<<"    -n name      Name of the LUT: the /DIRC/LUT/lut_map map_name in the CCDB"<<endl;
+	cout<<"                 (default is lut.root, as when passed with -PDIRC_LUT=lut.root)"<<endl;
+	cout<<"    -h, --help   Show this Usage statement"<<endl;
+	cout<<endl;
+	cout<<" Converts the DIRC LUT ROOT file into a flat binary file that can be"<<endl;
+	cout<<"memory-mapped by reconstruction jobs. Pass it with -PDIRC:LUT_FLAT=lut.bin ."<<endl;
+	cout<<"All processes on a node mapping the same file share one copy in memory."<<endl;
+	cout<<"The name and checksum of the ROOT file are stored in lut.bin; jobs only map"<<endl;
+	cout<<"it if they match the LUT the CCDB (or -PDIRC_LUT) selects for the run."<<endl;
+	cout<<endl;
+}
@@ -6,12 +6,15 @@
 #include <fstream>
 #include <iomanip>
 #include <vector>
+#include <memory>
 using namespace std;
 
 #include <signal.h>
 #include <time.h>
 #include <stdlib.h>
+#include <stdint.h>
 
+#include <DOrderedMerge.h>
 
 
 #ifndef _DBG_
@@ -23,12 +26,17 @@ void ParseCommandLineArguments(int narg, char* argv[]);
 void Usage(void);
 void ctrlCHandle(int x);
 void Process(unsigned int &NEvents, unsigned int &NEvents_read);
+bool ProcessOrdered(unsigned int &NEvents, unsigned int &NEvents_read);
 
 static vector<char*> INFILENAMES;
 static char *OUTFILENAME = NULL;
 static int QUIT = 0;
 static int BLOCKSIZE = 10485760;   // 10 M
 static bool VERBOSE = false;
+static bool MERGE_ORDERED = false;
+static unsigned int MERGE_LOOKAHEAD = 1000;
+static bool MERGE_KEEP_DUPLICATES = false;
+static bool MERGE_BY_TIMESTAMP = false;
 
 //-----------
 // GetFilesize
@@ -53,7 +61,17 @@ int main(int narg,char* argv[])
 	unsigned int NEvents_read = 0;
 
 	// Process all events
-	Process(NEvents, NEvents_read);
+	if(MERGE_ORDERED){
+		bool ok = ProcessOrdered(NEvents, NEvents_read);
+		cout<<endl;
+		cout<<" "<<NEvents_read<<" events read, "<<NEvents<<" events written"<<endl;
+		if(!ok){
+			cerr<<" ERRORS while merging: the output file is incomplete!"<<endl;
+			return -1;
+		}
+	}else{
+		Process(NEvents, NEvents_read);
+	}
 	
 	//cout<<endl;
 	//cout<<" "<<NEvents_read<<" events read, "<<NEvents<<" events written"<<endl;
@@ -75,6 +93,12 @@ void ParseCommandLineArguments(int narg, char* argv[])
 			switch(ptr[1]){
 				case 'h': Usage();						break;
 				case 'o': OUTFILENAME=&ptr[2];		break;
+				case 'k':
+					MERGE_ORDERED = true;
+					if(ptr[2] != 0) MERGE_LOOKAHEAD = atoi(&ptr[2]);
+					break;
+				case 'd': MERGE_KEEP_DUPLICATES = true;	break;
+				case 't': MERGE_BY_TIMESTAMP = true;	break;
 			}
 		}else{
 			INFILENAMES.push_back(argv[i]);
@@ -103,9 +127,18 @@ void Usage(void)
 	cout<<endl;
 	cout<<"options:"<<endl;
 	cout<<"    -oOutputfile  Set output filename (def. merged.evio)"<<endl;
+	cout<<"    -k[N]         Merge the events ordered by run and event number,"<<endl;
+	cout<<"                  reordering up to N events (def. 1000)"<<endl;
+	cout<<"    -t            With -k, order by the average timestamp instead"<<endl;
+	cout<<"                  of the event number"<<endl;
+	cout<<"    -d            With -k, keep events whose run and event number"<<endl;
+	cout<<"                  were already written (def. drop them)"<<endl;
 	cout<<endl;
 	cout<<" This will merge together multiple EVIO files into a single EVIO file."<<endl;
-	cout<<" "<<endl;
+	cout<<" By default the files are concatenated block by block. With -k each"<<endl;
+	cout<<" file is read and split into events by its own thread, the events of"<<endl;
+	cout<<" all files are interleaved in order and written into new blocks, e.g."<<endl;
+	cout<<" to rebuild a run file from partial outputs that overlap or have gaps."<<endl;
 	cout<<" "<<endl;
 	cout<<endl;
 
@@ -199,6 +232,322 @@ void Process(unsigned int &NEvents, unsigned int &NEvents_read)
     outfile.close();
 }
 
+//-----------
+// Swap32
+//-----------
+static inline uint32_t Swap32(uint32_t x)
+{
+	return (x>>24) | ((x>>8)&0x0000FF00) | ((x<<8)&0x00FF0000) | (x<<24);
+}
+
+//-----------
+// EVIOEvent
+//-----------
+class EVIOEvent
+{
+	// One top-level EVIO event (bank), kept in the byte order of its file
+
+	public:
+		EVIOEvent(void):swapped(false){}
+
+		uint32_t Word(size_t i) const { return swapped ? Swap32(words[i]):words[i]; }
+		uint64_t Word64(size_t i) const {
+			// 64-bit data are swapped as a whole: the high word comes first in swapped files
+			if(swapped) return (((uint64_t)Swap32(words[i]))<<32) | (uint64_t)Swap32(words[i+1]);
+			return (uint64_t)words[i] | (((uint64_t)words[i+1])<<32);
+		}
+
+		vector<uint32_t> words;
+		bool swapped;
+};
+
+//-----------
+// EVIOEventReader
+//-----------
+class EVIOEventReader
+{
+	// Reads the EVIO (version 4) blocks of one file and splits them into events.
+	// The file is opened by the first Read() so that all of the reading is
+	// done by the input's merge thread. Read() returns false at the end of the
+	// file and on errors: Get_Error() tells them apart.
+
+	public:
+		EVIOEventReader(const char *filename):filename(filename),swapped(false),error(false),ipos(0),iend(0){}
+
+		bool Read(EVIOEvent &event);
+		bool Get_Error(void) const { return error; }
+		const string& Get_Filename(void) const { return filename; }
+
+	private:
+		bool ReadBlock(void);
+		uint32_t Word(uint32_t w) const { return swapped ? Swap32(w):w; }
+
+		string filename;
+		ifstream infile;
+		vector<uint32_t> block;
+		bool swapped;
+		bool error;
+		size_t ipos;
+		size_t iend;
+};
+
+//-----------
+// EVIOEventReader::Read
+//-----------
+bool EVIOEventReader::Read(EVIOEvent &event)
+{
+	if(!infile.is_open()){
+		infile.open(filename.c_str(), ios::in|ios::binary);
+		if(!infile.is_open()){
+			cerr<<"Could not open input file " << filename << endl;
+			error = true;
+			return false;
+		}
+	}
+
+	while(ipos >= iend){
+		if(!ReadBlock()) return false;
+	}
+
+	size_t len = Word(block[ipos]) + 1;
+	if(ipos + len > iend){
+		cerr << "Event extends past the end of its EVIO block in " << filename << endl;
+		error = true;
+		return false;
+	}
+	event.words.assign(block.begin() + ipos, block.begin() + ipos + len);
+	event.swapped = swapped;
+	ipos += len;
+
+	return true;
+}
+
+//-----------
+// EVIOEventReader::ReadBlock
+//-----------
+bool EVIOEventReader::ReadBlock(void)
+{
+	uint32_t header[8];
+	if(!infile.read((char*)header, sizeof(header))){
+		if(infile.gcount()==0 && infile.eof()) return false; // end of file
+		cerr << (infile.eof() ? "Truncated EVIO block header in ":"Error reading ") << filename << endl;
+		error = true;
+		return false;
+	}
+
+	if(header[7] == 0xc0da0100){
+		swapped = false;
+	}else if(Swap32(header[7]) == 0xc0da0100){
+		swapped = true;
+	}else{
+		cerr << "Bad EVIO block header (magic word 0x" << hex << header[7] << dec << ") in " << filename << endl;
+		error = true;
+		return false;
+	}
+
+	uint32_t len    = Word(header[0]);
+	uint32_t hlen   = Word(header[2]);
+	uint32_t bitinfo = Word(header[5]);
+	if(hlen<8 || len<hlen){
+		cerr << "Bad EVIO block length (" << len << " words, header " << hlen << " words) in " << filename << endl;
+		error = true;
+		return false;
+	}
+
+	block.resize(len);
+	for(int i=0; i<8; i++) block[i] = header[i];
+	if(!infile.read((char*)&block[8], (len-8)*sizeof(uint32_t))){
+		cerr << "Truncated EVIO block in " << filename << endl;
+		error = true;
+		return false;
+	}
+	ipos = hlen;
+	iend = len;
+
+	// A dictionary in the first block is not copied to the output
+	if((bitinfo & (1<<8)) && ipos<iend){
+		cerr << "Skipping EVIO dictionary in " << filename << endl;
+		ipos += Word(block[ipos]) + 1;
+	}
+
+	// An empty block with the last block bit set marks the end of the file
+	if(ipos>=iend && (bitinfo & (1<<9))) return false;
+
+	return true;
+}
+
+//-----------
+// EVIOBlockWriter
+//-----------
+class EVIOBlockWriter
+{
+	// Packs events into EVIO (version 4) blocks of up to BLOCKSIZE bytes. The
+	// block headers are written in the byte order of the events, so events
+	// from files with a different byte order go into separate blocks.
+
+	public:
+		EVIOBlockWriter(ofstream &outfile):outfile(outfile),swapped(false),Nevents(0),Nblocks(0){}
+
+		void Write(EVIOEvent &event);
+		void Flush(bool last_block=false);
+
+	private:
+		ofstream &outfile;
+		vector<uint32_t> block;
+		bool swapped;
+		uint32_t Nevents;
+		uint32_t Nblocks;
+};
+
+//-----------
+// EVIOBlockWriter::Write
+//-----------
+void EVIOBlockWriter::Write(EVIOEvent &event)
+{
+	size_t max_words = BLOCKSIZE/sizeof(uint32_t);
+	if(Nevents>0 && (event.swapped!=swapped || block.size()+event.words.size()>max_words)) Flush();
+
+	if(Nevents==0){
+		block.assign(8, 0);
+		swapped = event.swapped;
+	}
+	block.insert(block.end(), event.words.begin(), event.words.end());
+	Nevents++;
+}
+
+//-----------
+// EVIOBlockWriter::Flush
+//-----------
+void EVIOBlockWriter::Flush(bool last_block)
+{
+	if(Nevents==0){
+		if(!last_block) return;
+		block.assign(8, 0); // end-of-file block
+	}
+
+	block[0] = block.size();  // Number of 32 bit words in block, including header
+	block[1] = ++Nblocks;     // Block number
+	block[2] = 8;             // Length of block header (words)
+	block[3] = Nevents;       // Event Count
+	block[4] = 0;             // Reserved 1
+	block[5] = 0x4 + (last_block ? (1<<9):0); // EVIO version 4, last block bit
+	block[6] = 0;             // Reserved 2
+	block[7] = 0xc0da0100;    // Magic number
+	if(swapped){
+		for(int i=0; i<8; i++) block[i] = Swap32(block[i]);
+	}
+
+	outfile.write((const char*)&block[0], block.size()*sizeof(uint32_t));
+	block.clear();
+	Nevents = 0;
+}
+
+//-----------
+// GetKey
+//-----------
+static bool GetKey(const EVIOEvent &event, DOrderedMergeKey &key)
+{
+	// Only the physics events built by CODA have a number: their bank (tag
+	// 0xFF50-0xFF8F, num = number of entangled events) starts with the built
+	// trigger bank (tag 0xFF2X), whose first segment holds 64-bit words: the
+	// first event number, the average timestamp(s) and, if bit 1 of the tag
+	// is set, the run number and type. See DEVIOWorkerThread::ParseBuiltTriggerBank.
+	const vector<uint32_t> &words = event.words;
+	if(words.size() < 7) return false;
+
+	uint32_t event_head = event.Word(1);
+	uint32_t tag = event_head>>16;
+	if(tag<0xFF50 || tag>0xFF8F) return false;
+
+	uint32_t trigger_head = event.Word(3);
+	if((trigger_head & 0xFF202000) != 0xFF202000) return false;
+	uint32_t trigger_tag = trigger_head>>16;
+
+	uint32_t common_header64_len = event.Word(4) & 0xFFFF;
+	if(common_header64_len<2 || 5+common_header64_len>words.size()) return false;
+	uint32_t N64 = common_header64_len/2;
+
+	uint64_t first_event_num = event.Word64(5);
+	uint64_t run_number = 0;
+	uint32_t Ntimestamps = N64 - 1;
+	if((trigger_tag & 0x02) && N64>=2){
+		run_number = event.Word64(5 + 2*(N64-1))>>32;
+		Ntimestamps--;
+	}
+
+	if(MERGE_BY_TIMESTAMP){
+		if(Ntimestamps == 0) return false;
+		key = DOrderedMergeKey(run_number, event.Word64(7), 0);
+	}else{
+		uint32_t M = event_head & 0xFF;
+		key = DOrderedMergeKey(run_number, first_event_num, M>0 ? M:1);
+	}
+
+	return true;
+}
+
+//-----------
+// ProcessOrdered
+//-----------
+bool ProcessOrdered(unsigned int &NEvents, unsigned int &NEvents_read)
+{
+	// k-way merge of the events of all input files (see DOrderedMerge.h).
+	// Each input file is read and split into events by its own thread, the
+	// events are ordered by run and event number (or timestamp) and written
+	// into new blocks by a writer thread. Events without a number (control,
+	// EPICS, BOR, ...) stay after the preceding event of their file.
+
+	cout<<" output file: "<<OUTFILENAME<<endl;
+	ofstream outfile (OUTFILENAME, ios::out|ios::binary);
+	if(!outfile.is_open()) {
+		cerr<<"Could not open output file " << OUTFILENAME << endl;
+		return false;
+	}
+	EVIOBlockWriter writer(outfile);
+
+	cout << " Merging ordered by run and " << (MERGE_BY_TIMESTAMP ? "timestamp":"event number");
+	cout << " (lookahead " << MERGE_LOOKAHEAD << " events)" << endl;
+	DOrderedMerge<EVIOEvent> merge(GetKey, [&writer](EVIOEvent &event){writer.Write(event);});
+	merge.Set_Lookahead(MERGE_LOOKAHEAD);
+	merge.Set_KeepDuplicates(MERGE_KEEP_DUPLICATES);
+	merge.Set_ShowTicker(true);
+	merge.Set_QuitFlag(&QUIT);
+
+	vector<shared_ptr<EVIOEventReader> > readers;
+	for(unsigned int i=0; i<INFILENAMES.size(); i++){
+		cout << "Opening input file : \"" << INFILENAMES[i] << "\"" << endl;
+		shared_ptr<EVIOEventReader> reader = make_shared<EVIOEventReader>(INFILENAMES[i]);
+		merge.Add_Input([reader](EVIOEvent &event){return reader->Read(event);});
+		readers.push_back(reader);
+	}
+
+	merge.Merge();
+
+	writer.Flush();
+	writer.Flush(true);
+	outfile.close();
+
+	bool ok = true;
+	for(auto &reader : readers){
+		if(!reader->Get_Error()) continue;
+		cerr << " Input file " << reader->Get_Filename() << " was not read completely!" << endl;
+		ok = false;
+	}
+	if(outfile.fail()){
+		cerr << " Error writing output file " << OUTFILENAME << endl;
+		ok = false;
+	}
+
+	NEvents_read = merge.Get_NumRead();
+	NEvents = merge.Get_NumWritten();
+	cout << endl;
+	cout << " " << merge.Get_NumDuplicates() << " duplicate events " << (MERGE_KEEP_DUPLICATES ? "kept":"dropped") << ", ";
+	if(!MERGE_BY_TIMESTAMP) cout << merge.Get_NumMissing() << " missing event numbers, ";
+	cout << merge.Get_NumOutOfOrder() << " events out of order" << endl;
+
+	return ok;
+}
+
 #if 0
 
 // old code disabled, see description above (sdobbs, 6/15/2016)
@@ -7,11 +7,26 @@
 #include <HDDM/hddm_r.hpp>
 using namespace hddm_r;
 
+#include "hddm_merge_ordered.h"
+
+//-----------
+// GetKey_r  --  run and event number of the reconstructed event
+//-----------
+static bool GetKey_r(const std::shared_ptr<hddm_r::HDDM> &record,
+                     DOrderedMergeKey &key)
+{
+   if (record->getReconstructedPhysicsEvents().empty())
+      return false;
+   ReconstructedPhysicsEvent &re = record->getReconstructedPhysicsEvent();
+   key = DOrderedMergeKey(re.getRunNo(), re.getEventNo());
+   return true;
+}
+
 
 //-----------
 // Process_r  --  HDDM REST format
 //-----------
-void Process_r(unsigned int &NEvents, unsigned int &NEvents_read)
+bool Process_r(unsigned int &NEvents, unsigned int &NEvents_read)
 {
    // Output file
    std::cout << " output file: " << OUTFILENAME << std::endl;
@@ -39,6 +54,19 @@ void Process_r(unsigned int &NEvents, unsigned int &NEvents_read)
       std::cout << " HDDM integrity checks disabled" << std::endl;
    }
 
+   if (MERGE_ORDERED) {
+      bool ok = MergeOrdered<hddm_r::HDDM, hddm_r::istream>(ostr, GetKey_r,
+                                                        NEvents, NEvents_read);
+      delete ostr;
+      ofs.close();
+      if (ofs.fail()) {
+         std::cerr << " Error writing output file \"" << OUTFILENAME
+                   << "\"!" << std::endl;
+         ok = false;
+      }
+      return ok;
+   }
+
    // Loop over input files
    time_t last_time = time(NULL);
    for (unsigned int i=0; i<INFILENAMES.size(); i++) {
@@ -73,4 +101,5 @@ void Process_r(unsigned int &NEvents, unsigned int &NEvents_read)
       delete istr;
    }
    delete ostr;
+   return true;
 }
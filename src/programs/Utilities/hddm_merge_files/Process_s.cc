@@ -6,10 +6,25 @@
 
 #include <HDDM/hddm_s.hpp>
 
+#include "hddm_merge_ordered.h"
+
+//-----------
+// GetKey_s  --  run and event number of the first physics event
+//-----------
+static bool GetKey_s(const std::shared_ptr<hddm_s::HDDM> &record,
+                     DOrderedMergeKey &key)
+{
+   if (record->getPhysicsEvents().empty())
+      return false;
+   hddm_s::PhysicsEvent &pe = record->getPhysicsEvent(0);
+   key = DOrderedMergeKey(pe.getRunNo(), pe.getEventNo());
+   return true;
+}
+
 //-----------
 // Process_s  --  HDDM simulation format
 //-----------
-void Process_s(unsigned int &NEvents, unsigned int &NEvents_read)
+bool Process_s(unsigned int &NEvents, unsigned int &NEvents_read)
 {
    // Output file
    std::cout << " output file: " << OUTFILENAME << std::endl;
@@ -37,6 +52,19 @@ void Process_s(unsigned int &NEvents, unsigned int &NEvents_read)
       std::cout << " HDDM integrity checks disabled" << std::endl;
    }
 
+   if (MERGE_ORDERED) {
+      bool ok = MergeOrdered<hddm_s::HDDM, hddm_s::istream>(fout, GetKey_s,
+                                                        NEvents, NEvents_read);
+      delete fout;
+      ofs.close();
+      if (ofs.fail()) {
+         std::cerr << " Error writing output file \"" << OUTFILENAME
+                   << "\"!" << std::endl;
+         ok = false;
+      }
+      return ok;
+   }
+
    // Loop over input files
    time_t last_time = time(NULL);
    for (unsigned int i=0; i<INFILENAMES.size(); i++) {
@@ -80,4 +108,5 @@ void Process_s(unsigned int &NEvents, unsigned int &NEvents_read)
    // Close output file
    ofs.close();
    delete fout;
+   return true;
 }
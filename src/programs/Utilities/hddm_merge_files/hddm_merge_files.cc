@@ -14,6 +14,9 @@ char *OUTFILENAME = NULL;
 int QUIT = 0;
 bool HDDM_USE_COMPRESSION = false;
 bool HDDM_USE_INTEGRITY_CHECKS = false;
+bool MERGE_ORDERED = false;
+unsigned int MERGE_LOOKAHEAD = 1000;
+bool MERGE_KEEP_DUPLICATES = false;
 
 
 //-----------
@@ -30,10 +33,11 @@ int main(int narg,char* argv[])
    unsigned int NEvents_read = 0;
 
    // Each HDDM class must have it's own cull routine
+   bool ok;
    if (HDDM_CLASS == "s")
-      Process_s(NEvents, NEvents_read);
+      ok = Process_s(NEvents, NEvents_read);
    else if (HDDM_CLASS == "r")
-      Process_r(NEvents, NEvents_read);
+      ok = Process_r(NEvents, NEvents_read);
    else {
       std::cout << "Don't know how to process HDDM class \"" << HDDM_CLASS 
                 << "\"!" << std::endl;
@@ -43,6 +47,11 @@ int main(int narg,char* argv[])
    std::cout << std::endl;
    std::cout << " " << NEvents_read << " events read, " 
              << NEvents << " events written" << std::endl;
+   if (! ok) {
+      std::cerr << " ERRORS while merging: the output file is incomplete!"
+                << std::endl;
+      return -1;
+   }
    return 0;
 }
 
@@ -73,6 +82,14 @@ void ParseCommandLineArguments(int narg, char* argv[])
             case 'I':
                HDDM_USE_INTEGRITY_CHECKS = true;
                break;
+            case 'k':
+               MERGE_ORDERED = true;
+               if (ptr[2] != 0)
+                  MERGE_LOOKAHEAD = atoi(&ptr[2]);
+               break;
+            case 'd':
+               MERGE_KEEP_DUPLICATES = true;
+               break;
          }
       }
       else {
@@ -110,9 +127,23 @@ void Usage(void)
    std::cout << "    -C            Enable data compression on"
                 " the output hddm stream" << std::endl;
    std::cout << "    -r            Input file is in REST format" << std::endl;
+   std::cout << "    -k[N]         Merge ordered by run and event number,"
+                " reordering up to" << std::endl;
+   std::cout << "                  N events (def. 1000); each input is read"
+                " by its own thread" << std::endl;
+   std::cout << "    -d            With -k, keep events whose run and event"
+                " number" << std::endl;
+   std::cout << "                  were already written (def. drop them)"
+             << std::endl;
    std::cout << std::endl;
    std::cout << " This will merge 1 or more HDDM files "
                 "into a single HDDM file." << std::endl;
+   std::cout << " By default the files are concatenated; with -k the events"
+                " of all files" << std::endl;
+   std::cout << " are interleaved in event number order, e.g. to rebuild"
+                " a run file" << std::endl;
+   std::cout << " from partial outputs that overlap or have gaps."
+             << std::endl;
    std::cout << " " << std::endl;
    std::cout << " " << std::endl;
    std::cout << std::endl;
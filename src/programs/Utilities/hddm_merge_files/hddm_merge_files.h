@@ -16,10 +16,14 @@ extern char *OUTFILENAME;
 extern int QUIT;
 extern bool HDDM_USE_COMPRESSION;
 extern bool HDDM_USE_INTEGRITY_CHECKS;
+extern bool MERGE_ORDERED;
+extern unsigned int MERGE_LOOKAHEAD;
+extern bool MERGE_KEEP_DUPLICATES;
 
 #define _DBG_ cout<<__FILE__<<":"<<__LINE__<<" "
 #define _DBG__ cout<<__FILE__<<":"<<__LINE__<<endl
 
 
-void Process_s(unsigned int &NEvents, unsigned int &NEvents_read);
-void Process_r(unsigned int &NEvents, unsigned int &NEvents_read);
+// Return false if the ordered merge did not read every input file completely
+bool Process_s(unsigned int &NEvents, unsigned int &NEvents_read);
+bool Process_r(unsigned int &NEvents, unsigned int &NEvents_read);
@@ -0,0 +1,134 @@
+// $Id$
+//
+// Ordered (k-way) merge of HDDM files, see DOrderedMerge.h
+
+#ifndef _hddm_merge_ordered_
+#define _hddm_merge_ordered_
+
+#include "hddm_merge_files.h"
+
+#include <DOrderedMerge.h>
+
+#include <memory>
+#include <string>
+
+//-----------
+// HDDMOrderedReader  --  reads one input file on its merge thread
+//-----------
+template <class HDDM_t, class istream_t>
+class HDDMOrderedReader
+{
+ public:
+   HDDMOrderedReader(const std::string &filename,
+                     std::shared_ptr<std::ifstream> ifs)
+    : filename(filename), ifs(ifs), error(false) {}
+
+   // Returns false at the end of the file and on a read error,
+   // Get_Error() tells the two apart
+   bool Read(std::shared_ptr<HDDM_t> &record)
+   {
+      try {
+         // The hddm stream reads (and checks) the file header when it is
+         // created: do that on this input's thread too
+         if (! fin)
+            fin = std::make_shared<istream_t>(*ifs);
+         if (! ifs->good())
+            return End_Of_Input();
+         record = std::make_shared<HDDM_t>();
+         if (! (*fin >> *record) || ifs->fail())
+            return End_Of_Input();
+         return true;
+      }
+      catch (std::exception &e) {
+         std::cerr << std::endl << " Error reading input file \"" << filename
+                   << "\": " << e.what() << std::endl;
+         error = true;
+         return false;
+      }
+   }
+
+   bool Get_Error() const { return error; }
+   const std::string& Get_Filename() const { return filename; }
+
+ private:
+   // Only a stream that stopped at the end of the file was read cleanly
+   bool End_Of_Input()
+   {
+      if (ifs->bad() || ! ifs->eof()) {
+         std::cerr << std::endl << " Error reading input file \"" << filename
+                   << "\"" << std::endl;
+         error = true;
+      }
+      return false;
+   }
+
+   std::string filename;
+   std::shared_ptr<std::ifstream> ifs;
+   std::shared_ptr<istream_t> fin;
+   bool error;
+};
+
+//-----------
+// MergeOrdered  --  merge all INFILENAMES into fout, ordered by run and event number
+//
+// Returns false if any input file was not read to its end without errors
+//-----------
+template <class HDDM_t, class istream_t, class ostream_t>
+bool MergeOrdered(ostream_t *fout,
+                  bool (*GetKey)(const std::shared_ptr<HDDM_t>&, DOrderedMergeKey&),
+                  unsigned int &NEvents, unsigned int &NEvents_read)
+{
+   std::cout << " Merging ordered by run and event number (lookahead "
+             << MERGE_LOOKAHEAD << " events)" << std::endl;
+
+   DOrderedMerge<std::shared_ptr<HDDM_t> > merge(GetKey,
+         [fout](std::shared_ptr<HDDM_t> &record) { *fout << *record; });
+   merge.Set_Lookahead(MERGE_LOOKAHEAD);
+   merge.Set_KeepDuplicates(MERGE_KEEP_DUPLICATES);
+   merge.Set_ShowTicker(true);
+   merge.Set_QuitFlag(&QUIT);
+
+   std::vector<std::shared_ptr<HDDMOrderedReader<HDDM_t, istream_t> > > readers;
+   for (unsigned int i=0; i<INFILENAMES.size(); i++) {
+      std::cout << " input file: " << INFILENAMES[i] << std::endl;
+      std::shared_ptr<std::ifstream> ifs =
+            std::make_shared<std::ifstream>(INFILENAMES[i]);
+      if (! ifs->is_open()) {
+         std::cout << " Error opening input file \"" << INFILENAMES[i]
+                   << "\"!" << std::endl;
+         exit(-1);
+      }
+      std::shared_ptr<HDDMOrderedReader<HDDM_t, istream_t> > reader =
+            std::make_shared<HDDMOrderedReader<HDDM_t, istream_t> >(INFILENAMES[i], ifs);
+      readers.push_back(reader);
+      merge.Add_Input([reader](std::shared_ptr<HDDM_t> &record) {
+                         return reader->Read(record);
+                      });
+   }
+
+   merge.Merge();
+
+   NEvents_read += merge.Get_NumRead();
+   NEvents += merge.Get_NumWritten();
+   std::cout << std::endl;
+   std::cout << " " << merge.Get_NumDuplicates() << " duplicate events "
+             << (MERGE_KEEP_DUPLICATES ? "kept" : "dropped") << ", "
+             << merge.Get_NumMissing() << " missing event numbers, "
+             << merge.Get_NumOutOfOrder() << " events out of order"
+             << std::endl;
+
+   // An input stopped by a read error is closed by the merge like one that
+   // reached its end, so check each of them here. Stopping on SIGINT is not
+   // an error.
+   bool ok = true;
+   for (unsigned int i=0; i<readers.size(); i++) {
+      if (readers[i]->Get_Error()) {
+         std::cerr << " Input file " << readers[i]->Get_Filename()
+                   << " was not read completely!" << std::endl;
+         ok = false;
+      }
+   }
+   return ok;
+}
+
+#endif // _hddm_merge_ordered_
@@ -12,12 +12,14 @@
 #include <thread>
 #include <sstream>
 #include <numeric>
+#include <memory>
 
 using namespace std;
 
 #include <TFile.h>
 
-#include "HDEVIOWriter.h"
+#include <DEVIOSkimRouter.h>
+#include "hdbyte_swapout.h"
 
 #undef _DBG_
 #undef _DBG__
@@ -34,6 +36,22 @@ enum EventType_t {
 	kCDAQ_PHYSICS_EVENT
 };
 
+// What the skim predicates get to see of an EVIO event
+struct SkimEventInfo_t {
+	EventType_t type;
+	uint32_t fp_trig_bits;   // OR of the FP trigger masks of all physics events in the block
+	uint32_t gtp_trig_bits;  // OR of the GTP trigger masks of all physics events in the block
+};
+
+// Skim written by this program. Blocks of physics events are written if any of
+// their events has any of the FP or GTP trigger bits of the skim set. All other
+// events are written to every skim.
+struct SkimDef_t {
+	string name;
+	uint32_t fp_mask;
+	uint32_t gtp_mask;
+};
+
 
 void Usage(string mess);
 
@@ -41,7 +59,9 @@ void ParseCommandLineArguments(int narg, char *argv[]);
 
 void MakeSkim(string &fname);
 
-bool ProcessEvent(uint32_t *buff, uint32_t buff_len);
+uint32_t ParseTrigBits(string bits);
+
+void ProcessEvent(uint32_t *buff, uint32_t buff_len, SkimEventInfo_t &info);
 
 void GetEventInfo(uint32_t *buff, uint32_t buff_len, EventType_t &type, uint32_t &Mevents);
 
@@ -55,8 +75,11 @@ uint64_t MAX_EVIO_EVENTS = 50000;
 uint64_t SKIP_EVIO_EVENTS = 0;
 uint64_t Nevents = 0;
 uint64_t Nevents_saved = 0;
+bool     WRITE_ERRORS = false;    // set if any output file couldn't be opened or written
 bool     WRITE_SQL_FILE = false;
 bool     FP_IGNORE[32];
+bool     USER_SKIMS = false;
+vector <SkimDef_t> SKIMS;
 
 uint32_t NGTP_TOTAL[32];
 uint32_t NFP_TOTAL[32];
@@ -79,6 +102,11 @@ int main(int narg, char *argv[]) {
 	// Loop over input files
 	for (auto fname : filenames) MakeSkim(fname);
 
+	if (WRITE_ERRORS) {
+		cerr << "ERROR: Not all selected events were written. See the messages above." << endl;
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -96,6 +124,14 @@ void Usage(string mess = "") {
 	cout << "   -m max_events     Max. EVIO events (not physics events) to process." << endl;
 	cout << "   -i ignore_events  Num. EVIO events (not physics events) to ignore at start." << endl;
 	cout << "   -o outfilename    Output filename (only use with single input file!)." << endl;
+	cout << "   -fp trig          Do not write blocks because of FP trigger bit trig (0-31)" << endl;
+	cout << "                     (may be given multiple times, applies to the default skim only)." << endl;
+	cout << "   -s name:fp[:gtp]  Write skim \"name\" with the blocks having any of the FP" << endl;
+	cout << "                     trigger bits fp or GTP trigger bits gtp (comma separated" << endl;
+	cout << "                     lists of bits 0-31, e.g. \"-s bcal_led:8,9\" or \"-s ps::3\")." << endl;
+	cout << "                     May be given multiple times; all skims are made in a single" << endl;
+	cout << "                     pass. Skim \"name\" is written to outfilename_name.evio and" << endl;
+	cout << "                     replaces the default skim (blocks with any FP trigger)." << endl;
 	cout << "   --sql             Write SQL for entering into skiminfo table to an outputfile" << endl;
 	cout << "                     (name will be same as outputfile but with .sql extension)" << endl;
 	cout << endl;
@@ -145,6 +181,21 @@ void ParseCommandLineArguments(int narg, char *argv[]) {
 			FP_IGNORE[itrig] = true;
 			i++;
 		}
+		else if (arg == "-s") {
+			SkimDef_t skim;
+			auto pos1 = next.find(':');
+			auto pos2 = pos1 == string::npos ? string::npos : next.find(':', pos1 + 1);
+			skim.name = next.substr(0, pos1);
+			skim.fp_mask  = pos1 == string::npos ? 0 : ParseTrigBits(next.substr(pos1 + 1, pos2 - pos1 - 1));
+			skim.gtp_mask = pos2 == string::npos ? 0 : ParseTrigBits(next.substr(pos2 + 1));
+			if(skim.name.empty() || (skim.fp_mask==0 && skim.gtp_mask==0)){
+				cerr<<"ERROR: argument to -s option must be name:fp[:gtp] with at least one trigger bit" << endl;
+				exit(-1);
+			}
+			SKIMS.push_back(skim);
+			USER_SKIMS = true;
+			i++;
+		}
 		else if (arg == "-sql" || arg == "--sql") {
 			WRITE_SQL_FILE = true;
 		}
@@ -159,9 +210,38 @@ void ParseCommandLineArguments(int narg, char *argv[]) {
 		Usage("ERROR: You may only use the -o option with a single input file! (otherwise output skim files will overwrite one another)");
 	}
 	
-	cout << "The following FP triggers will be saved: ";
-	for(int itrig=0; itrig<16; itrig++) if(!FP_IGNORE[itrig]) cout << itrig << ",";
-	cout << endl; 
+	if (!USER_SKIMS) {
+		// Default skim: blocks with any FP trigger (except those ignored)
+		SkimDef_t skim;
+		skim.name = "skims";
+		skim.fp_mask = 0;
+		skim.gtp_mask = 0;
+		for(int itrig=0; itrig<32; itrig++) if(!FP_IGNORE[itrig]) skim.fp_mask |= (1u << itrig);
+		SKIMS.push_back(skim);
+
+		cout << "The following FP triggers will be saved: ";
+		for(int itrig=0; itrig<16; itrig++) if(!FP_IGNORE[itrig]) cout << itrig << ",";
+		cout << endl; 
+	}
+}
+
+//----------------
+// ParseTrigBits
+//----------------
+uint32_t ParseTrigBits(string bits) {
+	uint32_t mask = 0;
+	stringstream ss(bits);
+	string bit;
+	while (getline(ss, bit, ',')) {
+		if (bit.empty()) continue;
+		int itrig = atoi(bit.c_str());
+		if(itrig<0 || itrig>=32){
+			cerr<<"ERROR: trigger bits of -s option must be numbers in 0-31 range" << endl;
+			exit(-1);
+		}
+		mask |= (1u << itrig);
+	}
+	return mask;
 }
 
 
@@ -186,7 +266,9 @@ void MakeSkim(string &filename) {
 	for (int ibit = 0; ibit < 32; ibit++) NFP_TOTAL[ibit] = NGTP_TOTAL[ibit] = 0;
 
 	// Open EVIO input file
-	cout << "Processing file: " << filename << " -> " << ofilename << endl;
+	cout << "Processing file: " << filename;
+	if (!USER_SKIMS) cout << " -> " << ofilename;
+	cout << endl;
 	HDEVIO *hdevio = new HDEVIO(filename);
 	if (!hdevio->is_open) {
 		cout << hdevio->err_mess.str() << endl;
@@ -194,33 +276,60 @@ void MakeSkim(string &filename) {
 	}
 	auto Nwords_in_input_file = hdevio->GetNWordsLeftInFile();
 
-	// Open EVIO output file
-	HDEVIOWriter evioout(ofilename);
-	std::thread thr(HDEVIOOutputThread, &evioout);
+	// Open EVIO output files. All skims are made in this one pass: each
+	// event is written by every skim that selects it from a single buffer,
+	// and every output file has its own writer thread.
+	DEVIOSkimRouter<SkimEventInfo_t> router;
+	string ofilename_stem = ofilename;
+	pos = ofilename_stem.rfind(".evio");
+	if (pos != string::npos) ofilename_stem.erase(pos);
+	for (auto &skim : SKIMS) {
+		string skim_ofilename = USER_SKIMS ? (ofilename_stem + "_" + skim.name + ".evio") : ofilename;
+		if (USER_SKIMS) cout << "    skim " << skim.name << " -> " << skim_ofilename << endl;
+		auto fp_mask = skim.fp_mask;
+		auto gtp_mask = skim.gtp_mask;
+		auto predicate = [fp_mask, gtp_mask](const SkimEventInfo_t &info) {
+			if (info.type != kCODA_PHYSICS_EVENT) return true; // write out all non-physics events
+			return ((info.fp_trig_bits & fp_mask) != 0) || ((info.gtp_trig_bits & gtp_mask) != 0);
+		};
+		if (!router.Add_Skim(skim.name, skim_ofilename, predicate)) {
+			WRITE_ERRORS = true;
+			delete hdevio;
+			return;
+		}
+	}
 
 	// Read all events in file
-	vector <uint32_t> *vbuff = evioout.GetBufferFromPool();
+	vector <uint32_t> vbuff(1000);
 	bool done = false;
 	while (!done) {
 
-		uint32_t *buff = vbuff->data();
-		uint32_t buff_len = vbuff->capacity();
-		vbuff->resize(buff_len); // we do this here so when we resize below, it does not re-initialize the contents
+		uint32_t *buff = vbuff.data();
+		uint32_t buff_len = vbuff.size();
 		hdevio->readNoFileBuff(buff, buff_len);
 
 		switch (hdevio->err_code) {
 			case HDEVIO::HDEVIO_OK:
 				if (Nevents >= SKIP_EVIO_EVENTS) {
-					if (ProcessEvent(buff, buff_len)) {
-						vbuff->resize((*vbuff)[0] + 1);
-						evioout.AddBufferToOutput(vbuff); // HDEVIOWriter takes ownership of buffer
-						vbuff = evioout.GetBufferFromPool(); // get a new buffer
+					SkimEventInfo_t info;
+					ProcessEvent(buff, buff_len, info);
+
+					// The event is swapped to big endian (as written) once, into
+					// a buffer shared by all skims writing it
+					uint32_t len = buff[0] + 1;
+					auto Nselected = router.Route(info, [buff, len](void) {
+						auto swapped_buff = make_shared<vector<uint32_t> >(len);
+						swap_bank_out(swapped_buff->data(), buff, len);
+						return DEVIOSkimBuffer(swapped_buff);
+					});
+					if (Nselected > 0) {
+						if (info.type == kCODA_PHYSICS_EVENT) NEVIO_BLOCKS_TOTAL++;
 						Nevents_saved++;
 					}
 				}
 				break;
 			case HDEVIO::HDEVIO_USER_BUFFER_TOO_SMALL:
-				vbuff->reserve(hdevio->last_event_len);
+				vbuff.resize(hdevio->last_event_len);
 				break;
 			case HDEVIO::HDEVIO_EOF:
 				cout << endl << " end of file" << endl;
@@ -247,9 +356,12 @@ void MakeSkim(string &filename) {
 
 	// Close EVIO files
 	delete hdevio;
-	evioout.ReturnBufferToPool(vbuff);
-	evioout.Quit();
-	thr.join();
+	router.Close();
+	if (USER_SKIMS) router.Print_Summary(cout);
+	if (router.Has_Error() || router.Get_NumDropped() > 0) {
+		cerr << "ERROR: " << router.Get_NumDropped() << " selected events of " << filename << " were not written!" << endl;
+		WRITE_ERRORS = true;
+	}
 
 	// Extract file number from file name (run number extracted from EVIO already)
 	uint32_t file_number = 999;
@@ -346,18 +458,21 @@ void MakeSkim(string &filename) {
 //------------------------------------------------------------------
 // ProcessEvent
 //
-// Scan event in the given buffer and decide whether to write the
-// event to the output file. Returns true if it should be written
-// and false if it shouldn't.
+// Scan event in the given buffer and fill the info the skims use
+// to decide whether to write the event to their output file.
 //
 // This will also accumulate statistics on how many events and
 // triggers there are.
 //------------------------------------------------------------------
-bool ProcessEvent(uint32_t *buff, uint32_t buff_len) {
+void ProcessEvent(uint32_t *buff, uint32_t buff_len, SkimEventInfo_t &info) {
 	EventType_t event_type;
 	uint32_t Mevents;
 	GetEventInfo(buff, buff_len, event_type, Mevents);
 
+	info.type = event_type;
+	info.fp_trig_bits = 0;
+	info.gtp_trig_bits = 0;
+
 //    cout << "Processing buffer: " <<  "   type: " << event_type << "  M: " << Mevents << endl;
 
 	if (event_type == kCODA_PHYSICS_EVENT) {
@@ -371,10 +486,12 @@ bool ProcessEvent(uint32_t *buff, uint32_t buff_len) {
 
 		for (auto fp_trig_mask : fp_trig_masks) {
 			for (int ibit = 0; ibit < 32; ibit++) NFP[ibit] += ((fp_trig_mask >> ibit) & 0x01);
+			info.fp_trig_bits |= fp_trig_mask;
 		}
 
 		for (auto trig_mask : trig_masks) {
 			for (int ibit = 0; ibit < 32; ibit++) NGTP[ibit] += ((trig_mask >> ibit) & 0x01);
+			info.gtp_trig_bits |= trig_mask;
 		}
 
 		NEVENTS_TOTAL += Mevents;
@@ -383,21 +500,7 @@ bool ProcessEvent(uint32_t *buff, uint32_t buff_len) {
 			NGTP_TOTAL[ibit] += NGTP[ibit];
 			NFP_TOTAL[ibit]  += NFP[ibit];
 		}
-
-		auto NFP_TOT = 0;
-		for(int itrig=0; itrig<32; itrig++){
-			if( FP_IGNORE[itrig] ) continue;  // Allow user to specify certain FP triggers not to cause block to be written
-			NFP_TOT += NFP[itrig];
-		}
-		//auto NFP = NBCAL_LED_US + NBCAL_LED_DS + Nrandom + NFCAL_LED + NCCAL_LED1 + NCCAL_LED2 + NDIRC_LED;
-		if (NFP_TOT > 0) {
-			NEVIO_BLOCKS_TOTAL++;
-			return true; // Tell caller to write this event to file
-		}
-		return false; // Tell caller not to write this event to file
 	}
-
-	return true; // write out all non-physics events
 }
 
 //----------------
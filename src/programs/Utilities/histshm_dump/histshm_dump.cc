@@ -0,0 +1,300 @@
+// $Id$
+//
+//    File: histshm_dump.cc
+//
+// Dump and diff snapshots of the histograms exported to shared
+// memory by the histshm plugin.
+//
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <dirent.h>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+using namespace std;
+
+#include <DSharedHistograms.h>
+
+
+void Usage(string mess);
+void ParseCommandLineArguments(int narg, char *argv[]);
+vector<string> ListRegions(void);
+bool GetSnapshot(string source, vector<char> &snapshot);
+bool ReadSnapshotFile(string filename, vector<char> &snapshot);
+bool WriteSnapshotFile(string filename, const vector<char> &snapshot);
+void PrintSnapshot(const vector<char> &snapshot);
+void PrintDiff(const vector<char> &before, const vector<char> &after);
+
+
+string REGION_NAME = "";
+string INPUT_FILENAME = "";
+string OUTPUT_FILENAME = "";
+string DIFF_FILENAME = "";
+string PATTERN = "";
+double WAIT_SECONDS = 0.0;
+bool   LIST_REGIONS = false;
+bool   PRINT_BINS = false;
+
+//----------------
+// main
+//----------------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	if(LIST_REGIONS){
+		for(auto name : ListRegions()) cout << name << endl;
+		return 0;
+	}
+
+	// Source of the (first) snapshot
+	string source = INPUT_FILENAME;
+	if(source == ""){
+		if(REGION_NAME == ""){
+			vector<string> regions = ListRegions();
+			if(regions.size() != 1){
+				cerr << (regions.empty() ? "No":"More than one") << " histshm region found in /dev/shm. Specify one of:" << endl;
+				for(auto name : regions) cerr << "   " << name << endl;
+				return -1;
+			}
+			REGION_NAME = regions[0];
+		}
+		source = REGION_NAME;
+	}
+
+	vector<char> snapshot;
+	if(!GetSnapshot(source, snapshot)) return -1;
+	if(OUTPUT_FILENAME != "" && !WriteSnapshotFile(OUTPUT_FILENAME, snapshot)) return -1;
+
+	if(DIFF_FILENAME != ""){
+		vector<char> before;
+		if(!ReadSnapshotFile(DIFF_FILENAME, before)) return -1;
+		PrintDiff(before, snapshot);
+	}else if(WAIT_SECONDS > 0.0){
+		this_thread::sleep_for(chrono::duration<double>(WAIT_SECONDS));
+		vector<char> after;
+		if(!GetSnapshot(source, after)) return -1;
+		PrintDiff(snapshot, after);
+	}else{
+		PrintSnapshot(snapshot);
+	}
+
+	return 0;
+}
+
+//----------------
+// Usage
+//----------------
+void Usage(string mess="")
+{
+	cout << endl;
+	cout << "Usage:" << endl;
+	cout << endl;
+	cout << "    histshm_dump [options] [region]" << endl;
+	cout << endl;
+	cout << "Print the histograms exported to a shared memory region by the" << endl;
+	cout << "histshm plugin (e.g. /halld_histshm_12345), or the changes of" << endl;
+	cout << "them. The region may be left out if there is only one." << endl;
+	cout << endl;
+	cout << "options:" << endl;
+	cout << "   -h, --help      Print this usage statement" << endl;
+	cout << "   -l              List the histshm regions in /dev/shm" << endl;
+	cout << "   -o file         Save the snapshot to file" << endl;
+	cout << "   -i file         Read the snapshot from file (written with -o)" << endl;
+	cout << "                   instead of shared memory" << endl;
+	cout << "   -d file         Print the changes since the snapshot in file" << endl;
+	cout << "   -w seconds      Print the changes during the given time" << endl;
+	cout << "   -p pattern      Only histograms with pattern in their name" << endl;
+	cout << "   -b              Print the bin contents too" << endl;
+	cout << endl;
+
+	if(mess != "") cout << endl << mess << endl << endl;
+
+	exit(0);
+}
+
+//----------------
+// ParseCommandLineArguments
+//----------------
+void ParseCommandLineArguments(int narg, char *argv[])
+{
+	for(int i=1; i<narg; i++){
+		string arg  = argv[i];
+		string next = (i+1)<narg ? argv[i+1]:"";
+
+		if(arg == "-h" || arg == "--help") Usage();
+		else if(arg == "-l"){ LIST_REGIONS = true; }
+		else if(arg == "-b"){ PRINT_BINS = true; }
+		else if(arg == "-o"){ if(next=="") Usage("-o requires an argument!"); OUTPUT_FILENAME = next; i++; }
+		else if(arg == "-i"){ if(next=="") Usage("-i requires an argument!"); INPUT_FILENAME = next; i++; }
+		else if(arg == "-d"){ if(next=="") Usage("-d requires an argument!"); DIFF_FILENAME = next; i++; }
+		else if(arg == "-p"){ if(next=="") Usage("-p requires an argument!"); PATTERN = next; i++; }
+		else if(arg == "-w"){ if(next=="") Usage("-w requires an argument!"); WAIT_SECONDS = atof(next.c_str()); i++; }
+		else if(arg[0] == '-'){ Usage("Unknown argument \"" + arg + "\"!"); }
+		else{
+			REGION_NAME = arg;
+			if(REGION_NAME[0] != '/') REGION_NAME = "/" + REGION_NAME;
+		}
+	}
+
+	if(WAIT_SECONDS > 0.0 && INPUT_FILENAME != "") Usage("-w can only be used with shared memory regions!");
+}
+
+//----------------
+// ListRegions
+//----------------
+vector<string> ListRegions(void)
+{
+	vector<string> regions;
+	DIR *dir = opendir("/dev/shm");
+	if(!dir) return regions;
+	while(struct dirent *entry = readdir(dir)){
+		string name = entry->d_name;
+		if(name.find("halld_histshm") == 0) regions.push_back("/" + name);
+	}
+	closedir(dir);
+	return regions;
+}
+
+//----------------
+// GetSnapshot
+//----------------
+bool GetSnapshot(string source, vector<char> &snapshot)
+{
+	if(source == INPUT_FILENAME) return ReadSnapshotFile(source, snapshot);
+
+	DSharedHistogramsReader reader;
+	if(!reader.Open(source)){
+		cerr << "Unable to open shared memory region " << source << " !" << endl;
+		return false;
+	}
+	// Wait for the first snapshot for a few seconds
+	for(int i=0; i<50; i++){
+		if(reader.Snapshot(snapshot)) return true;
+		this_thread::sleep_for(chrono::milliseconds(100));
+	}
+	cerr << "No snapshot available in " << source << " (writer pid " << reader.WriterPid() << ")" << endl;
+	return false;
+}
+
+//----------------
+// ReadSnapshotFile
+//----------------
+bool ReadSnapshotFile(string filename, vector<char> &snapshot)
+{
+	ifstream ifs(filename.c_str(), ios::binary);
+	if(!ifs.is_open()){
+		cerr << "Unable to open " << filename << " !" << endl;
+		return false;
+	}
+	snapshot.assign(istreambuf_iterator<char>(ifs), istreambuf_iterator<char>());
+	if(!DSharedHistogramsReader::Parse(snapshot, NULL)){
+		cerr << filename << " is not a valid histogram snapshot!" << endl;
+		return false;
+	}
+	return true;
+}
+
+//----------------
+// WriteSnapshotFile
+//----------------
+bool WriteSnapshotFile(string filename, const vector<char> &snapshot)
+{
+	ofstream ofs(filename.c_str(), ios::binary);
+	ofs.write(snapshot.data(), snapshot.size());
+	if(!ofs.good()){
+		cerr << "Error writing " << filename << " !" << endl;
+		return false;
+	}
+	cout << "Snapshot saved to " << filename << endl;
+	return true;
+}
+
+//----------------
+// PrintSnapshot
+//----------------
+void PrintSnapshot(const vector<char> &snapshot)
+{
+	DSharedHistogramsBuffer info;
+	vector<DSharedHistogram> hists;
+	DSharedHistogramsReader::Parse(snapshot, &hists, &info);
+
+	time_t t = (time_t)info.time;
+	cout << "Snapshot " << info.generation << " of " << ctime(&t);
+	cout << info.Nhistograms << " histograms, " << info.Nevents << " events processed" << endl;
+	cout << endl;
+	cout << setw(14) << "entries" << setw(16) << "integral" << "  name (bins)" << endl;
+	for(auto &h : hists){
+		if(h.name.find(PATTERN) == string::npos) continue;
+		cout << setw(14) << h.entries << setw(16) << h.Integral() << "  " << h.name;
+		cout << " (" << h.nbins[0];
+		if(h.ndim > 1) cout << "x" << h.nbins[1];
+		cout << ")" << endl;
+		if(!PRINT_BINS) continue;
+		for(size_t i=0; i<h.contents.size(); i++){
+			if(h.contents[i] == 0.0) continue;
+			uint32_t ix = i%(h.nbins[0] + 2);
+			uint32_t iy = i/(h.nbins[0] + 2);
+			cout << "        bin " << ix;
+			if(h.ndim > 1) cout << "," << iy;
+			cout << " : " << h.contents[i] << endl;
+		}
+	}
+}
+
+//----------------
+// PrintDiff
+//----------------
+void PrintDiff(const vector<char> &before, const vector<char> &after)
+{
+	DSharedHistogramsBuffer info_before, info_after;
+	vector<DSharedHistogram> hists_before, hists_after;
+	DSharedHistogramsReader::Parse(before, &hists_before, &info_before);
+	DSharedHistogramsReader::Parse(after,  &hists_after,  &info_after);
+
+	map<string, const DSharedHistogram*> old_hists;
+	for(auto &h : hists_before) old_hists[h.name] = &h;
+
+	cout << "Changes from snapshot " << info_before.generation << " to " << info_after.generation;
+	cout << " (" << info_after.time - info_before.time << " s, ";
+	cout << (int64_t)(info_after.Nevents - info_before.Nevents) << " events)" << endl;
+	cout << endl;
+	cout << setw(14) << "d(entries)" << setw(16) << "d(integral)" << setw(10) << "bins" << "  name" << endl;
+
+	uint32_t Nchanged = 0;
+	for(auto &h : hists_after){
+		if(h.name.find(PATTERN) == string::npos) continue;
+		auto iter = old_hists.find(h.name);
+		if(iter == old_hists.end()){
+			cout << setw(14) << h.entries << setw(16) << h.Integral() << setw(10) << "new" << "  " << h.name << endl;
+			Nchanged++;
+			continue;
+		}
+		const DSharedHistogram *old = iter->second;
+		old_hists.erase(iter);
+		if(old->contents.size() != h.contents.size()){
+			cout << setw(14) << h.entries - old->entries << setw(16) << h.Integral() - old->Integral() << setw(10) << "rebinned" << "  " << h.name << endl;
+			Nchanged++;
+			continue;
+		}
+		uint32_t Nbins_changed = 0;
+		for(size_t i=0; i<h.contents.size(); i++) if(h.contents[i] != old->contents[i]) Nbins_changed++;
+		if(Nbins_changed == 0 && h.entries == old->entries) continue;
+		cout << setw(14) << h.entries - old->entries << setw(16) << h.Integral() - old->Integral() << setw(10) << Nbins_changed << "  " << h.name << endl;
+		Nchanged++;
+	}
+	for(auto &iter : old_hists){
+		if(iter.first.find(PATTERN) == string::npos) continue;
+		cout << setw(14) << -iter.second->entries << setw(16) << -iter.second->Integral() << setw(10) << "removed" << "  " << iter.first << endl;
+		Nchanged++;
+	}
+	cout << endl << Nchanged << " histograms changed" << endl;
+}
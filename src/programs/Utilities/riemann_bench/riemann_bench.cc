@@ -0,0 +1,251 @@
+// riemann_bench.cc
+//
+// Microbenchmark for the Riemann circle fit. The hits of the FDC segments
+// found in the input files are collected, then each segment is refit many
+// times with DRiemannFit (diagonal covariance, DRiemannFitEngine) and with a
+// reference copy of the former implementation that builds hits x hits
+// DMatrix workspaces. Prints the time per fit for both and the largest
+// difference in the fitted circles.
+//
+// Usage: riemann_bench [options] source1 source2 ...
+//   -PRIEMANN_BENCH:NREPS=N       number of passes over the segments
+//   -PRIEMANN_BENCH:MAX_SEGMENTS=N  stop collecting after N segments
+//
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+#include <pthread.h>
+
+#include <JANA/JEventProcessor.h>
+#include <DANA/DApplication.h>
+#include <FDC/DFDCSegment.h>
+#include <TRACKING/DRiemannFit.h>
+#include <DMatrix.h>
+#include <TDecompLU.h>
+
+void Usage(JApplication &app);
+
+typedef struct{
+	double xc,yc,rc;
+	bool ok;
+}circle_t;
+
+//-----------
+// SegmentCollector
+//-----------
+class SegmentCollector:public JEventProcessor
+{
+	public:
+		SegmentCollector(unsigned int max_segments):max_segments(max_segments){
+			pthread_mutex_init(&mutex, NULL);
+		}
+
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber){
+			vector<const DFDCSegment*> fdcsegments;
+			loop->Get(fdcsegments);
+
+			pthread_mutex_lock(&mutex);
+			for(unsigned int i=0; i<fdcsegments.size(); i++){
+				if(segments.size() >= max_segments) break;
+				const vector<const DFDCPseudo*> &hits = fdcsegments[i]->hits;
+				if(hits.size() < 3) continue;
+				vector<DRiemannHit_t> seg;
+				for(unsigned int j=0; j<hits.size(); j++){
+					DRiemannHit_t hit;
+					hit.x = hits[j]->xy.X();
+					hit.y = hits[j]->xy.Y();
+					hit.z = hits[j]->wire->origin.z();
+					hit.covx = hits[j]->covxx;
+					hit.covy = hits[j]->covyy;
+					hit.covxy = hits[j]->covxy;
+					seg.push_back(hit);
+				}
+				segments.push_back(seg);
+			}
+			pthread_mutex_unlock(&mutex);
+
+			return NOERROR;
+		}
+
+		unsigned int max_segments;
+		vector<vector<DRiemannHit_t> > segments;
+		pthread_mutex_t mutex;
+};
+
+//-----------
+// ReferenceFit
+//-----------
+// The circle fit as it was done before DRiemannFitEngine: full hits x hits
+// covariance, weight and correction matrices. Same sequence as FitFast()
+// below: a first fit, then a refit corrected for non-normal incidence.
+static bool ReferenceFitCircle(vector<DRiemannHit_t> hits, DMatrix &CRPhi, circle_t &circle)
+{
+	unsigned int n = hits.size();
+	DMatrix X(n,3), Xavg(1,3), A(3,3);
+	DMatrix Ones(n,1), OnesT(1,n), W_sum(1,1), W(n,n);
+	for(unsigned int i=0; i<n; i++){
+		X(i,0) = hits[i].x;
+		X(i,1) = hits[i].y;
+		X(i,2) = hits[i].x*hits[i].x + hits[i].y*hits[i].y;
+		Ones(i,0) = OnesT(0,i) = 1.;
+	}
+	TDecompLU lu(CRPhi);
+	if(lu.Decompose()==false) return false;
+	W = DMatrix(DMatrix::kInverted, CRPhi);
+	W_sum = OnesT*(W*Ones);
+	Xavg = (1./W_sum(0,0))*(OnesT*(W*X));
+	A = DMatrix(DMatrix::kTransposed,X)*(W*X) - W_sum(0,0)*(DMatrix(DMatrix::kTransposed,Xavg)*Xavg);
+	if(!A.IsValid()) return false;
+
+	double B2 = -(A(0,0)+A(1,1)+A(2,2));
+	double B1 = A(0,0)*A(1,1)-A(1,0)*A(0,1)+A(0,0)*A(2,2)-A(2,0)*A(0,2)+A(1,1)*A(2,2)-A(2,1)*A(1,2);
+	double B0 = -A.Determinant();
+	if(B0==0 || !isfinite(B0)) return false;
+	double Q = (3.*B1-B2*B2)/9.e4;
+	double R = (9.*B2*B1-27.*B0-2.*B2*B2*B2)/54.e6;
+	double Q1 = Q*Q*Q+R*R;
+	if(Q1 >= 0) return false;
+	Q1 = sqrt(-Q1);
+	double temp = 100.*pow(R*R+Q1*Q1,0.16666666666666666667);
+	double theta = atan2(Q1,R)/3.;
+	double sum = 2.*temp*cos(theta);
+	double diff = -2.*temp*sin(theta);
+	double lambda = -B2/3.-sum/2.+sqrt(3.)/2.*diff;
+
+	double N[3];
+	N[0] = 1.;
+	N[1] = (A(1,0)*A(0,2)-(A(0,0)-lambda)*A(1,2))/(A(0,1)*A(2,1)-(A(1,1)-lambda)*A(0,2));
+	N[2] = (A(2,0)*(A(1,1)-lambda)-A(1,0)*A(2,1))/(A(1,2)*A(2,1)-(A(2,2)-lambda)*(A(1,1)-lambda));
+	double norm = 0.;
+	for(int i=0; i<3; i++) norm += N[i]*N[i];
+	for(int i=0; i<3; i++) N[i] /= sqrt(norm);
+	double c = -(N[0]*Xavg(0,0)+N[1]*Xavg(0,1)+N[2]*Xavg(0,2));
+
+	circle.xc = -N[0]/2./N[2];
+	circle.yc = -N[1]/2./N[2];
+	circle.rc = sqrt(1.-N[2]*N[2]-4.*c*N[2])/2./fabs(N[2]);
+	return true;
+}
+
+static void FitReference(vector<DRiemannHit_t> hits, circle_t &circle)
+{
+	circle.ok = false;
+	std::sort(hits.begin(), hits.end(), [](const DRiemannHit_t &a, const DRiemannHit_t &b){return a.z>b.z;});
+	unsigned int n = hits.size();
+	DMatrix CRPhi(n,n), CR(n,n), C(n,n), S(n,n);
+	for(unsigned int i=0; i<n; i++){
+		double Phi = atan2(hits[i].y, hits[i].x);
+		double a = Phi*cos(Phi)-sin(Phi), b = Phi*sin(Phi)+cos(Phi);
+		CRPhi(i,i) = a*a*hits[i].covx + b*b*hits[i].covy + 2.*b*a*hits[i].covxy;
+		CR(i,i) = cos(Phi)*cos(Phi)*hits[i].covx + sin(Phi)*sin(Phi)*hits[i].covy + 2.*sin(Phi)*cos(Phi)*hits[i].covxy;
+	}
+	if(!ReferenceFitCircle(hits, CRPhi, circle)) return;
+
+	for(unsigned int i=0; i<n; i++){
+		double stemp = sqrt(hits[i].x*hits[i].x + hits[i].y*hits[i].y)/4./circle.rc;
+		double ctemp = 1.-stemp*stemp;
+		S(i,i) = ctemp>0 ? stemp:0.;
+		C(i,i) = ctemp>0 ? sqrt(ctemp):1.;
+	}
+	CRPhi = C*CRPhi*C+S*CR*S;
+	circle.ok = ReferenceFitCircle(hits, CRPhi, circle);
+}
+
+//-----------
+// FitFast
+//-----------
+static void FitFast(const vector<DRiemannHit_t> &hits, circle_t &circle)
+{
+	circle.ok = false;
+	DRiemannFit rfit;
+	for(unsigned int i=0; i<hits.size(); i++)
+		rfit.AddHit(hits[i].x, hits[i].y, hits[i].z, hits[i].covx, hits[i].covy, hits[i].covxy);
+	if(rfit.FitCircle() != NOERROR) return;
+	// FitCircle(rc) reuses (and corrects) the covariance of the first fit
+	if(rfit.FitCircle(rfit.rc) != NOERROR) return;
+	circle.xc = rfit.xc;
+	circle.yc = rfit.yc;
+	circle.rc = rfit.rc;
+	circle.ok = true;
+}
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	DApplication app(narg, argv);
+	if(narg<=1) Usage(app);
+
+	unsigned int NREPS = 100;
+	unsigned int MAX_SEGMENTS = 100000;
+	gPARMS->SetDefaultParameter("RIEMANN_BENCH:NREPS", NREPS, "Number of passes over the recorded segments");
+	gPARMS->SetDefaultParameter("RIEMANN_BENCH:MAX_SEGMENTS", MAX_SEGMENTS, "Maximum number of FDC segments to record");
+
+	SegmentCollector collector(MAX_SEGMENTS);
+	app.Run(&collector);
+
+	vector<vector<DRiemannHit_t> > &segments = collector.segments;
+	if(segments.empty()){
+		jerr << "No FDC segments found in input!" << endl;
+		return -1;
+	}
+	unsigned int Nhits = 0;
+	for(unsigned int i=0; i<segments.size(); i++) Nhits += segments[i].size();
+	jout << segments.size() << " segments, " << (double)Nhits/segments.size() << " hits/segment on average" << endl;
+
+	// Results, also checks that the fits are not optimized away
+	vector<circle_t> ref(segments.size()), fast(segments.size());
+
+	auto t0 = chrono::steady_clock::now();
+	for(unsigned int rep=0; rep<NREPS; rep++)
+		for(unsigned int i=0; i<segments.size(); i++) FitReference(segments[i], ref[i]);
+	auto t1 = chrono::steady_clock::now();
+	for(unsigned int rep=0; rep<NREPS; rep++)
+		for(unsigned int i=0; i<segments.size(); i++) FitFast(segments[i], fast[i]);
+	auto t2 = chrono::steady_clock::now();
+
+	double Nfits = (double)NREPS*segments.size();
+	double t_ref = chrono::duration<double, micro>(t1-t0).count()/Nfits;
+	double t_fast = chrono::duration<double, micro>(t2-t1).count()/Nfits;
+
+	unsigned int Nmismatch = 0;
+	double max_diff = 0.;
+	for(unsigned int i=0; i<segments.size(); i++){
+		if(ref[i].ok != fast[i].ok){Nmismatch++; continue;}
+		if(!ref[i].ok) continue;
+		double diff = max(fabs(ref[i].xc-fast[i].xc), max(fabs(ref[i].yc-fast[i].yc), fabs(ref[i].rc-fast[i].rc)));
+		diff /= max(1., ref[i].rc);
+		max_diff = max(max_diff, diff);
+	}
+
+	jout << "  DMatrix reference: " << t_ref  << " us/fit" << endl;
+	jout << "  DRiemannFit:       " << t_fast << " us/fit (" << t_ref/t_fast << "x)" << endl;
+	jout << "  largest relative difference in xc,yc,rc: " << max_diff << endl;
+	jout << "  fits failing in only one of the two: " << Nmismatch << endl;
+
+	return 0;
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(JApplication &app)
+{
+	cout<<endl;
+	cout<<"Usage:"<<endl;
+	cout<<"    riemann_bench [options] source1 source2 source3 ..."<<endl;
+	cout<<endl;
+	cout<<"Refits the FDC segments found in the input with DRiemannFit and"<<endl;
+	cout<<"with the former N x N matrix implementation and compares the speed."<<endl;
+	cout<<endl;
+	app.Usage();
+	cout<<endl;
+
+	exit(0);
+}
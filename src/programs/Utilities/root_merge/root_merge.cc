@@ -23,12 +23,27 @@
  */
 
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 #include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <sstream>
 #include <iostream>
 #include <iomanip>
 using namespace std;
 
+#include <TROOT.h>
+#include <TClass.h>
 #include <TChain.h>
 #include <TFile.h>
 #include <TH1.h>
@@ -40,35 +55,109 @@ TList *FileList;
 TFile *Target;
 
 const char *OUTPUT_FILENAME = "merged.root";
+vector<string> INPUT_FILENAMES;
+unsigned int NTHREADS = 0;     // 0: original sequential merge
+unsigned int GROUP_SIZE = 0;   // 0: merge all inputs at once
+unsigned int MAX_OPEN_FILES = 0; // input files each merge thread keeps open (0: 512 over all threads)
+bool COMPARE_SEQUENTIAL = false;
+string TMP_DIR = ".";
 
 void Usage(void);
 void ParseCommandLineArguments(int narg, char* argv[]);
 void MergeRootfile( TDirectory *target, TList *sourcelist );
+void MergeSequential(const char *output);
+bool MergeIndexed(const vector<string> &inputs, const string &output);
+bool MergeTreeReduction(const vector<string> &inputs, const string &output);
+double GetTime(void);
 
 //--------------
 // main
 //--------------
 int main(int narg, char* argv[])
 {
-	// create empty list of input files
-	FileList = new TList();
-
 	// Parse command line to fill list
 	ParseCommandLineArguments(narg, argv);
 
+	// Total size of inputs for throughput
+	double input_MB = 0.0;
+	for(auto &fname : INPUT_FILENAMES){
+		struct stat st;
+		if(stat(fname.c_str(), &st) == 0) input_MB += (double)st.st_size/1.0E6;
+	}
+
+	// Optionally time the original sequential merge of the same inputs
+	// first (into a temporary file) to compare the throughput with
+	double t_sequential = 0.0;
+	if(COMPARE_SEQUENTIAL && NTHREADS>0){
+		stringstream ss;
+		ss << TMP_DIR << "/root_merge_sequential_" << getpid() << ".root";
+		cout<<"Sequential merge for comparison ..."<<endl;
+		double t_start_sequential = GetTime();
+		MergeSequential(ss.str().c_str());
+		t_sequential = GetTime() - t_start_sequential;
+		unlink(ss.str().c_str());
+	}
+
+	double t_start = GetTime();
+
+	if(NTHREADS == 0){
+		MergeSequential(OUTPUT_FILENAME);
+	}else{
+		// Indexed merge on NTHREADS threads, optionally in groups of GROUP_SIZE files
+		ROOT::EnableThreadSafety();
+		TH1::AddDirectory(kFALSE);
+		bool ok = (GROUP_SIZE>1 && INPUT_FILENAMES.size()>GROUP_SIZE) ? MergeTreeReduction(INPUT_FILENAMES, OUTPUT_FILENAME):MergeIndexed(INPUT_FILENAMES, OUTPUT_FILENAME);
+		if(!ok) return -1;
+	}
+
+	double t_merge = GetTime() - t_start;
+	cout<<endl<<"Merged "<<INPUT_FILENAMES.size()<<" files ("<<setprecision(4)<<input_MB<<" MB) in "<<t_merge<<" s";
+	if(t_merge > 0.0) cout<<": "<<(double)INPUT_FILENAMES.size()/t_merge<<" files/s, "<<input_MB/t_merge<<" MB/s";
+	cout<<" ("<<(NTHREADS==0 ? string("sequential"):(to_string(NTHREADS)+" threads"))<<")"<<endl;
+	if(t_sequential > 0.0){
+		cout<<"Sequential merge: "<<t_sequential<<" s, "<<input_MB/t_sequential<<" MB/s. Speedup: "<<t_sequential/t_merge<<endl;
+		cout<<"(the sequential merge ran first: the inputs may have been in the page cache for the indexed merge)"<<endl;
+	}
+
+	return 0;
+}
+
+//--------------
+// MergeSequential
+//--------------
+void MergeSequential(const char *output)
+{
+	// Original sequential merge: all input files are opened up front
+	FileList = new TList();
+	for(auto &fname : INPUT_FILENAMES) FileList->Add( TFile::Open(fname.c_str()));
+
 	// Open ROOT file for output
-	Target = new TFile(OUTPUT_FILENAME,"RECREATE","Produced by root_merge");
-	cout<<"Opened ROOT file \""<<OUTPUT_FILENAME<<"\" ..."<<endl;
-	
+	Target = new TFile(output,"RECREATE","Produced by root_merge");
+	cout<<"Opened ROOT file \""<<output<<"\" ..."<<endl;
+
 	// Merge input files into output file
 	MergeRootfile( Target, FileList );
-	
+
 	// Close output file
 	Target->Write();
 	delete Target;
-	cout<<endl<<"Closed ROOT file: "<<OUTPUT_FILENAME<<endl;
+	Target = NULL;
+	cout<<endl<<"Closed ROOT file: "<<output<<endl;
 
-	return 0;
+	// Close input files
+	FileList->Delete();
+	delete FileList;
+	FileList = NULL;
+}
+
+//--------------
+// GetTime
+//--------------
+double GetTime(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + 1.0E-6*(double)tv.tv_usec;
 }
 
 //--------------
@@ -81,6 +170,17 @@ void Usage(void)
 	cout<<endl;
 	cout<<"options:"<<endl;
 	cout<<"     -o filename   set output filename (def:"<<OUTPUT_FILENAME<<")"<<endl;
+	cout<<"     -j nthreads   indexed merge on nthreads threads (def: original"<<endl;
+	cout<<"                   sequential merge). The keys of all inputs are indexed"<<endl;
+	cout<<"                   in one pass, then the directories are merged in"<<endl;
+	cout<<"                   parallel, reading one input object at a time."<<endl;
+	cout<<"     -g groupsize  with -j: merge in groups of groupsize files into"<<endl;
+	cout<<"                   temporary files, then merge those (tree reduction)"<<endl;
+	cout<<"     -d dir        directory for the temporary files of -g and -c (def:"<<TMP_DIR<<")"<<endl;
+	cout<<"     -m maxopen    with -j: input files each thread keeps open between"<<endl;
+	cout<<"                   directories (def: 512/nthreads)"<<endl;
+	cout<<"     -c            with -j: also time the sequential merge (into a"<<endl;
+	cout<<"                   temporary file) and report the speedup"<<endl;
 	cout<<"     -h            Print this usage statement"<<endl;
 	cout<<endl;
 	cout<<endl;
@@ -102,6 +202,25 @@ void ParseCommandLineArguments(int narg, char* argv[])
 					i++;
 					OUTPUT_FILENAME = argv[i];
 					break;
+				case 'j':
+					i++;
+					NTHREADS = atoi(argv[i]);
+					break;
+				case 'g':
+					i++;
+					GROUP_SIZE = atoi(argv[i]);
+					break;
+				case 'd':
+					i++;
+					TMP_DIR = argv[i];
+					break;
+				case 'm':
+					i++;
+					MAX_OPEN_FILES = atoi(argv[i]);
+					break;
+				case 'c':
+					COMPARE_SEQUENTIAL = true;
+					break;
 				case 'h':
 					Usage();
 					break;
@@ -110,7 +229,7 @@ void ParseCommandLineArguments(int narg, char* argv[])
 					exit(-1);
 			}
 		}else{
-			FileList->Add( TFile::Open(argv[i]));
+			INPUT_FILENAMES.push_back(argv[i]);
 		}
 	}
 }
@@ -238,3 +357,381 @@ void MergeRootfile( TDirectory *target, TList *sourcelist ) {
 }
 
 
+
+//==============================================================
+// Indexed merge (-j)
+//
+// Pass 1 indexes the keys of all input files (each file is opened
+// once, files are indexed in parallel and combined in input order).
+// Pass 2 merges each directory as an independent task on the thread
+// pool: a task reads only the files that have keys in its directory,
+// one object at a time, and adds it to the sum. Each thread keeps the
+// files it has opened (up to MAX_OPEN_FILES, least recently used are
+// closed first), so a file is not reopened for every directory. The main thread
+// writes the merged objects of a directory as soon as its task is
+// done, so at most one sum per directory in progress is in memory.
+// Trees are chained as in MergeRootfile. Unlike MergeRootfile, keys
+// that are not in the first file are merged too.
+//==============================================================
+
+// One key of one directory
+class KeyInfo{
+	public:
+		string classname;
+		bool mergeable;             // TH1: summed, otherwise copied from the first file
+		bool is_tree;
+		vector<int> files;          // indexes of the input files that have the key
+		vector<string> tree_files;  // trees: files to chain (the files of input TChains)
+};
+
+// One directory, over all input files
+class DirInfo{
+	public:
+		DirInfo():cost(0){}
+		string title;
+		vector<string> keynames;    // in order of first appearance
+		map<string, KeyInfo> keys;
+		vector<int> files;          // input files with keys in this directory
+		unsigned long cost;         // number of objects to read
+};
+
+// Key (or subdirectory) of one input file, as found by the index pass
+class IndexEntry{
+	public:
+		string path;
+		string name;
+		string title;
+		string classname;
+		bool is_dir;
+		vector<string> tree_files;
+};
+
+//--------------
+// IndexDirectory
+//--------------
+void IndexDirectory(TDirectory *dir, const string &path, const string &fname, vector<IndexEntry> &entries)
+{
+	set<string> names;
+	TIter nextkey( dir->GetListOfKeys() );
+	TKey *key;
+	while ( (key = (TKey*)nextkey())) {
+
+		// Keys are sorted by decreasing cycle: only the latest one is used
+		if(!names.insert(key->GetName()).second) continue;
+
+		IndexEntry entry;
+		entry.path = path;
+		entry.name = key->GetName();
+		entry.title = key->GetTitle();
+		entry.classname = key->GetClassName();
+		entry.is_dir = false;
+
+		TClass *cl = TClass::GetClass(key->GetClassName());
+		if(cl && cl->InheritsFrom(TDirectory::Class())){
+			entry.is_dir = true;
+			entries.push_back(entry);
+			TDirectory *subdir = dir->GetDirectory(key->GetName());
+			if(subdir) IndexDirectory(subdir, path.empty() ? entry.name:(path + "/" + entry.name), fname, entries);
+			continue;
+		}
+		if(cl && cl->InheritsFrom(TChain::Class())){
+			// chain written by an earlier merge (e.g. a tree reduction step): chain its files
+			TChain *chain = (TChain*)key->ReadObj();
+			TIter nextfile(chain->GetListOfFiles());
+			TObject *element;
+			while( (element = nextfile()) ) entry.tree_files.push_back(element->GetTitle());
+			delete chain;
+		}else if(cl && cl->InheritsFrom(TTree::Class())){
+			entry.tree_files.push_back(fname);
+		}
+		entries.push_back(entry);
+	}
+}
+
+//--------------
+// AddToIndex
+//--------------
+void AddToIndex(int ifile, const vector<IndexEntry> &entries, map<string, DirInfo> &index, vector<string> &dir_order)
+{
+	for(auto &entry : entries){
+		if(entry.is_dir){
+			string subpath = entry.path.empty() ? entry.name:(entry.path + "/" + entry.name);
+			if(index.find(subpath) == index.end()){
+				index[subpath].title = entry.title;
+				dir_order.push_back(subpath);
+			}
+			continue;
+		}
+
+		DirInfo &dirinfo = index[entry.path];
+		auto iter = dirinfo.keys.find(entry.name);
+		if(iter == dirinfo.keys.end()){
+			KeyInfo &keyinfo = dirinfo.keys[entry.name];
+			TClass *cl = TClass::GetClass(entry.classname.c_str());
+			keyinfo.classname = entry.classname;
+			keyinfo.mergeable = cl && cl->InheritsFrom(TH1::Class());
+			keyinfo.is_tree = cl && cl->InheritsFrom(TTree::Class());
+			dirinfo.keynames.push_back(entry.name);
+			iter = dirinfo.keys.find(entry.name);
+		}
+		KeyInfo &keyinfo = iter->second;
+		keyinfo.files.push_back(ifile);
+		keyinfo.tree_files.insert(keyinfo.tree_files.end(), entry.tree_files.begin(), entry.tree_files.end());
+		if(keyinfo.is_tree) continue;
+		if(dirinfo.files.empty() || dirinfo.files.back()!=ifile) dirinfo.files.push_back(ifile);
+		if(keyinfo.mergeable || keyinfo.files.size()==1) dirinfo.cost++;
+	}
+}
+
+//--------------
+// BuildIndex
+//--------------
+bool BuildIndex(const vector<string> &inputs, map<string, DirInfo> &index, vector<string> &dir_order)
+{
+	index[""].title = "";
+	dir_order.push_back("");
+
+	// Files are indexed in parallel, but added to the index in input order
+	// (which defines the "first file" of a key). Workers stay at most a
+	// few files per thread ahead of the file being added.
+	size_t max_ahead = 4*NTHREADS;
+	vector<vector<IndexEntry>*> results(inputs.size(), NULL);
+	vector<bool> failed(inputs.size(), false);
+	size_t Nadded = 0;
+	atomic<size_t> next_file(0);
+	mutex results_mutex;
+	condition_variable results_cv;
+
+	auto worker = [&](){
+		while(true){
+			size_t ifile = next_file++;
+			if(ifile >= inputs.size()) break;
+			{
+				unique_lock<mutex> lck(results_mutex);
+				results_cv.wait(lck, [&]{return ifile < Nadded + max_ahead;});
+			}
+			vector<IndexEntry> *entries = new vector<IndexEntry>();
+			TFile *f = TFile::Open(inputs[ifile].c_str(), "READ");
+			bool ok = f && !f->IsZombie();
+			if(ok) IndexDirectory(f, "", inputs[ifile], *entries);
+			delete f;
+
+			lock_guard<mutex> lck(results_mutex);
+			results[ifile] = entries;
+			failed[ifile] = !ok;
+			results_cv.notify_all();
+		}
+	};
+	vector<thread> threads;
+	for(unsigned int i=0; i<NTHREADS; i++) threads.push_back(thread(worker));
+
+	bool ok = true;
+	for(size_t ifile=0; ifile<inputs.size(); ifile++){
+		vector<IndexEntry> *entries;
+		{
+			unique_lock<mutex> lck(results_mutex);
+			results_cv.wait(lck, [&]{return results[ifile] != NULL;});
+			entries = results[ifile];
+			if(failed[ifile]){
+				cerr << "Unable to open \"" << inputs[ifile] << "\"!" << endl;
+				ok = false;
+			}
+		}
+		AddToIndex(ifile, *entries, index, dir_order);
+		delete entries;
+
+		lock_guard<mutex> lck(results_mutex);
+		Nadded = ifile + 1;
+		results_cv.notify_all();
+	}
+	for(auto &t : threads) t.join();
+
+	return ok;
+}
+
+// Input files opened by one merge thread, kept open across its directory tasks
+class FileCache{
+	public:
+		FileCache(const vector<string> &inputs, size_t max_open):inputs(inputs),max_open(max(max_open, (size_t)1)),Nuses(0),Nopens(0){}
+		~FileCache(){for(auto &p : files) delete p.second.first;}
+
+		TFile* Get(int ifile){
+			auto iter = files.find(ifile);
+			if(iter == files.end()){
+				if(files.size() >= max_open){
+					// close the least recently used file
+					auto oldest = files.begin();
+					for(auto it=files.begin(); it!=files.end(); it++) if(it->second.second < oldest->second.second) oldest = it;
+					delete oldest->second.first;
+					files.erase(oldest);
+				}
+				TFile *f = TFile::Open(inputs[ifile].c_str(), "READ");
+				Nopens++;
+				iter = files.insert(make_pair(ifile, make_pair(f, 0UL))).first;
+			}
+			iter->second.second = ++Nuses;
+			return iter->second.first;
+		}
+
+		const vector<string> &inputs;
+		size_t max_open;
+		map<int, pair<TFile*, unsigned long> > files; // file, last use
+		unsigned long Nuses;
+		unsigned long Nopens;
+};
+
+//--------------
+// MergeDirectory
+//--------------
+void MergeDirectory(FileCache &files, const string &path, const DirInfo &dirinfo, map<string, TObject*> &merged)
+{
+	for(int ifile : dirinfo.files){
+		TFile *f = files.Get(ifile);
+		TDirectory *dir = (f && !f->IsZombie()) ? (path.empty() ? (TDirectory*)f:f->GetDirectory(path.c_str())):NULL;
+		if(!dir) continue;
+
+		for(auto &name : dirinfo.keynames){
+			const KeyInfo &keyinfo = dirinfo.keys.find(name)->second;
+			if(keyinfo.is_tree) continue;
+			if(!binary_search(keyinfo.files.begin(), keyinfo.files.end(), ifile)) continue;
+			TObject *&sum = merged[name];
+			if(sum && !keyinfo.mergeable) continue; // copied from the first file only
+
+			TKey *key = dir->GetKey(name.c_str());
+			if(!key) continue;
+			TObject *obj = key->ReadObj();
+			if(!obj) continue;
+			if(!sum){
+				sum = obj;
+			}else{
+				((TH1*)sum)->Add((TH1*)obj);
+				delete obj;
+			}
+		}
+	}
+}
+
+//--------------
+// MergeIndexed
+//--------------
+bool MergeIndexed(const vector<string> &inputs, const string &output)
+{
+	// Pass 1: index
+	double t_start = GetTime();
+	map<string, DirInfo> index;
+	vector<string> dir_order;
+	if(!BuildIndex(inputs, index, dir_order)) return false;
+	unsigned long Nkeys = 0;
+	for(auto &p : index) Nkeys += p.second.keys.size();
+	cout << "Indexed " << inputs.size() << " files: " << index.size() << " directories, " << Nkeys << " keys (" << setprecision(3) << GetTime()-t_start << " s)" << endl;
+
+	// Output file with all directories
+	TFile *target = new TFile(output.c_str(), "RECREATE", "Produced by root_merge");
+	if(target->IsZombie()){
+		cerr << "Unable to open \"" << output << "\" for writing!" << endl;
+		delete target;
+		return false;
+	}
+	cout << "Opened ROOT file \"" << output << "\" ..." << endl;
+	for(auto &path : dir_order){
+		if(path.empty()) continue;
+		size_t pos = path.rfind('/');
+		TDirectory *parent = (pos == string::npos) ? (TDirectory*)target:target->GetDirectory(path.substr(0, pos).c_str());
+		parent->mkdir(path.substr(pos == string::npos ? 0:pos+1).c_str(), index[path].title.c_str());
+	}
+
+	// Pass 2: one task per directory, the most expensive first
+	vector<string> tasks(dir_order);
+	stable_sort(tasks.begin(), tasks.end(), [&](const string &a, const string &b){return index.find(a)->second.cost > index.find(b)->second.cost;});
+
+	atomic<size_t> next_task(0);
+	atomic<unsigned long> Nopens(0);
+	mutex done_mutex;
+	condition_variable done_cv;
+	deque<pair<string, map<string, TObject*>*> > done;
+	size_t max_open = MAX_OPEN_FILES>0 ? MAX_OPEN_FILES:512/NTHREADS;
+
+	auto worker = [&](){
+		FileCache files(inputs, max_open);
+		while(true){
+			size_t itask = next_task++;
+			if(itask >= tasks.size()) break;
+			map<string, TObject*> *merged = new map<string, TObject*>();
+			MergeDirectory(files, tasks[itask], index.find(tasks[itask])->second, *merged);
+
+			lock_guard<mutex> lck(done_mutex);
+			done.push_back(make_pair(tasks[itask], merged));
+			done_cv.notify_one();
+		}
+		Nopens += files.Nopens;
+	};
+	vector<thread> threads;
+	for(unsigned int i=0; i<NTHREADS; i++) threads.push_back(thread(worker));
+
+	// Write the directories as they are merged
+	for(size_t Nwritten=0; Nwritten<tasks.size(); Nwritten++){
+		pair<string, map<string, TObject*>*> result;
+		{
+			unique_lock<mutex> lck(done_mutex);
+			done_cv.wait(lck, [&]{return !done.empty();});
+			result = done.front();
+			done.pop_front();
+		}
+		const DirInfo &dirinfo = index.find(result.first)->second;
+		TDirectory *dir = result.first.empty() ? (TDirectory*)target:target->GetDirectory(result.first.c_str());
+		dir->cd();
+		for(auto &name : dirinfo.keynames){
+			const KeyInfo &keyinfo = dirinfo.keys.find(name)->second;
+			if(keyinfo.is_tree){
+				TChain chain(name.c_str());
+				for(auto &fname : keyinfo.tree_files) chain.Add(fname.c_str());
+				chain.Write(name.c_str());
+				continue;
+			}
+			TObject *obj = (*result.second)[name];
+			if(!obj) continue;
+			obj->Write(name.c_str());
+			delete obj;
+		}
+		delete result.second;
+	}
+	for(auto &t : threads) t.join();
+	cout << "Merged " << tasks.size() << " directories, " << Nopens << " input file opens" << endl;
+
+	target->Write();
+	delete target;
+	cout << "Closed ROOT file: " << output << endl;
+
+	return true;
+}
+
+//--------------
+// MergeTreeReduction
+//--------------
+bool MergeTreeReduction(const vector<string> &inputs, const string &output)
+{
+	// Merge groups of GROUP_SIZE files into temporary files, then groups
+	// of those, until one group is left, which is merged into the output.
+	// Temporary files are deleted once the next level is done.
+	vector<string> level = inputs;
+	vector<string> tmp_files;
+	bool ok = true;
+	for(int ilevel=0; ok && level.size()>GROUP_SIZE; ilevel++){
+		vector<string> next_level;
+		for(size_t first=0; ok && first<level.size(); first+=GROUP_SIZE){
+			vector<string> group(level.begin()+first, level.begin()+min(level.size(), first+GROUP_SIZE));
+			stringstream ss;
+			ss << TMP_DIR << "/root_merge_tmp_" << getpid() << "_" << ilevel << "_" << next_level.size() << ".root";
+			cout << "Level " << ilevel << ": merging " << group.size() << " files into " << ss.str() << endl;
+			ok = MergeIndexed(group, ss.str());
+			next_level.push_back(ss.str());
+		}
+		for(auto &fname : tmp_files) unlink(fname.c_str());
+		tmp_files = next_level;
+		level = next_level;
+	}
+	if(ok) ok = MergeIndexed(level, output);
+	for(auto &fname : tmp_files) unlink(fname.c_str());
+
+	return ok;
+}
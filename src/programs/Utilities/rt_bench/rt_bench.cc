@@ -0,0 +1,384 @@
+// rt_bench.cc
+//
+// Microbenchmark for DReferenceTrajectory. The track candidates found in the
+// input files are recorded along with the CDC and FDC wires of their hits.
+// A trajectory is then swum for every candidate (all kept in memory at once,
+// as the fitting factories do) and DistToRT() and FindClosestSwimStep() are
+// timed for all of the wires of the candidate. Prints the size of a swim
+// step, the memory held by the trajectories and the time per call.
+//
+// To compare the swim step layout and allocation before and after a change
+// to DReferenceTrajectory, run this with both builds on the same input.
+//
+// It also checks the indexed FindClosestSwimStep() on its own, without any
+// input: random tracks are swum through a constant 2 T field and random
+// wires (CDC-like, FDC-like and of any direction and length) are placed near
+// them. For every wire the indexed search must find the same step as the
+// search from the first step (FindClosestSwimStepLinear()) and
+// DistToRTBruteForce() must give the same distance from either step. The
+// exit code is 1 if they differ for any wire. Both searches are timed on
+// these wires too. With no sources given, only this check is run.
+//
+// Usage: rt_bench [options] [source1 source2 ...]
+//   -PRT_BENCH:NREPS=N           number of passes over the wires
+//   -PRT_BENCH:MAX_CANDIDATES=N  stop collecting after N candidates
+//   -PRT_BENCH:NRANDOM_TRACKS=N  random tracks for the check
+//   -PRT_BENCH:NRANDOM_WIRES=N   random wires per track for the check
+//   -PRT_BENCH:SEED=N            random number seed
+//
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include <JANA/JEventProcessor.h>
+#include <DANA/DApplication.h>
+#include <TRACKING/DTrackCandidate.h>
+#include <TRACKING/DReferenceTrajectory.h>
+#include <HDGEOMETRY/DMagneticFieldMapConst.h>
+#include <CDC/DCDCTrackHit.h>
+#include <FDC/DFDCPseudo.h>
+
+void Usage(JApplication &app);
+unsigned long CheckStepIndex(unsigned int NRANDOM_TRACKS, unsigned int NRANDOM_WIRES, unsigned int SEED, unsigned int NREPS);
+void Benchmark(DApplication &app, unsigned int MAX_CANDIDATES, unsigned int NREPS);
+
+typedef struct{
+	DVector3 pos;
+	DVector3 mom;
+	double q;
+	vector<const DCoordinateSystem*> wires;
+}candidate_t;
+
+//-----------
+// CandidateCollector
+//-----------
+class CandidateCollector:public JEventProcessor
+{
+	public:
+		CandidateCollector(unsigned int max_candidates):max_candidates(max_candidates),run_number(0){
+			pthread_mutex_init(&mutex, NULL);
+		}
+
+		jerror_t brun(JEventLoop *loop, int32_t runnumber){
+			run_number = runnumber;
+			return NOERROR;
+		}
+
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber){
+			vector<const DTrackCandidate*> trackcandidates;
+			loop->Get(trackcandidates);
+
+			pthread_mutex_lock(&mutex);
+			for(unsigned int i=0; i<trackcandidates.size(); i++){
+				if(candidates.size() >= max_candidates) break;
+				vector<const DCDCTrackHit*> cdchits;
+				vector<const DFDCPseudo*> fdchits;
+				trackcandidates[i]->Get(cdchits);
+				trackcandidates[i]->Get(fdchits);
+				if(cdchits.empty() && fdchits.empty()) continue;
+
+				candidate_t cand;
+				cand.pos = trackcandidates[i]->position();
+				cand.mom = trackcandidates[i]->momentum();
+				cand.q = trackcandidates[i]->charge();
+				for(unsigned int j=0; j<cdchits.size(); j++) cand.wires.push_back(cdchits[j]->wire);
+				for(unsigned int j=0; j<fdchits.size(); j++) cand.wires.push_back(fdchits[j]->wire);
+				candidates.push_back(cand);
+			}
+			pthread_mutex_unlock(&mutex);
+
+			return NOERROR;
+		}
+
+		unsigned int max_candidates;
+		int32_t run_number;
+		vector<candidate_t> candidates;
+		pthread_mutex_t mutex;
+};
+
+//-----------
+// MaxRSS
+//-----------
+static double MaxRSS(void)
+{
+	// Peak resident set size of the process in MB
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss/1024.0;
+}
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	DApplication app(narg, argv);
+	bool have_sources = false;
+	for(int i=1; i<narg; i++){
+		string arg = argv[i];
+		if(arg=="-h" || arg=="--help") Usage(app);
+		if(arg[0] != '-') have_sources = true;
+	}
+
+	unsigned int NREPS = 10;
+	unsigned int MAX_CANDIDATES = 10000;
+	gPARMS->SetDefaultParameter("RT_BENCH:NREPS", NREPS, "Number of passes over the wires of the recorded candidates");
+	gPARMS->SetDefaultParameter("RT_BENCH:MAX_CANDIDATES", MAX_CANDIDATES, "Maximum number of track candidates to record");
+	unsigned int NRANDOM_TRACKS = 500;
+	unsigned int NRANDOM_WIRES = 40;
+	unsigned int SEED = 12345;
+	gPARMS->SetDefaultParameter("RT_BENCH:NRANDOM_TRACKS", NRANDOM_TRACKS, "Number of random tracks for checking the indexed FindClosestSwimStep");
+	gPARMS->SetDefaultParameter("RT_BENCH:NRANDOM_WIRES", NRANDOM_WIRES, "Number of random wires per track for checking the indexed FindClosestSwimStep");
+	gPARMS->SetDefaultParameter("RT_BENCH:SEED", SEED, "Seed for the random tracks and wires");
+
+	unsigned long Nmismatch = CheckStepIndex(NRANDOM_TRACKS, NRANDOM_WIRES, SEED, NREPS);
+
+	if(have_sources) Benchmark(app, MAX_CANDIDATES, NREPS);
+
+	// Fail if the indexed search differs from the linear one for any wire
+	if(Nmismatch > 0){
+		jerr << Nmismatch << " random wires have a different closest step or distance with the indexed search than with the linear one!" << endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+//-----------
+// RandomWire
+//-----------
+static DCoordinateSystem RandomWire(mt19937 &gen, const DVector3 &pos)
+{
+	// CDC-like (along z, up to 6 degrees stereo, 150 cm long), FDC-like
+	// (across z, 100 cm long) or of any direction and length (including
+	// 0, i.e. a point) with its closest point mostly within 1.5 cm of pos
+	// but sometimes up to 50 cm away
+	uniform_real_distribution<double> flat(0.0, 1.0);
+	DCoordinateSystem wire;
+	double phi = 2.0*M_PI*flat(gen);
+	double type = flat(gen);
+	if(type < 0.4){
+		double stereo = 0.105*(2.0*flat(gen) - 1.0);
+		wire.udir.SetXYZ(sin(stereo)*cos(phi), sin(stereo)*sin(phi), cos(stereo));
+		wire.L = 150.0;
+	}else if(type < 0.8){
+		wire.udir.SetXYZ(cos(phi), sin(phi), 0.0);
+		wire.L = 100.0;
+	}else{
+		double costheta = 2.0*flat(gen) - 1.0;
+		double sintheta = sqrt(1.0 - costheta*costheta);
+		wire.udir.SetXYZ(sintheta*cos(phi), sintheta*sin(phi), costheta);
+		wire.L = flat(gen) < 0.2 ? 0.0:300.0*flat(gen);
+	}
+	DVector3 offset(2.0*flat(gen) - 1.0, 2.0*flat(gen) - 1.0, 2.0*flat(gen) - 1.0);
+	offset -= offset.Dot(wire.udir)*wire.udir;
+	if(offset.Mag() > 0.0) offset.SetMag((flat(gen) < 0.9 ? 1.5:50.0)*flat(gen));
+	wire.origin = pos + offset - wire.L*(flat(gen) - 0.5)*wire.udir;
+
+	// Complete the coordinate system (DistToRTBruteForce uses sdir and tdir)
+	wire.sdir = wire.udir.Orthogonal();
+	wire.sdir.SetMag(1.0);
+	wire.tdir = wire.udir.Cross(wire.sdir);
+
+	return wire;
+}
+
+//-----------
+// CheckStepIndex
+//-----------
+unsigned long CheckStepIndex(unsigned int NRANDOM_TRACKS, unsigned int NRANDOM_WIRES, unsigned int SEED, unsigned int NREPS)
+{
+	/// Swim random tracks and compare the indexed FindClosestSwimStep()
+	/// with FindClosestSwimStepLinear() and DistToRTBruteForce() from
+	/// either step for random wires near them. Returns the number of wires
+	/// for which they differ.
+	mt19937 gen(SEED);
+	uniform_real_distribution<double> flat(0.0, 1.0);
+	DMagneticFieldMapConst bfield(0.0, 0.0, 2.0);
+
+	// Tracks from the target region or from anywhere in the tracking
+	// volume, from loopers up to stiff tracks, in all directions
+	vector<DReferenceTrajectory*> rts;
+	unsigned long Nsteps = 0;
+	for(unsigned int i=0; i<NRANDOM_TRACKS; i++){
+		DVector3 pos;
+		if(flat(gen) < 0.5){
+			pos.SetXYZ(2.0*flat(gen) - 1.0, 2.0*flat(gen) - 1.0, 50.0 + 30.0*flat(gen));
+		}else{
+			double r = 55.0*flat(gen);
+			double phi = 2.0*M_PI*flat(gen);
+			pos.SetXYZ(r*cos(phi), r*sin(phi), -50.0 + 450.0*flat(gen));
+		}
+		double p = 0.05 + 5.0*pow(flat(gen), 2.0);
+		double costheta = 2.0*flat(gen) - 1.0;
+		double sintheta = sqrt(1.0 - costheta*costheta);
+		double phi = 2.0*M_PI*flat(gen);
+		DVector3 mom(p*sintheta*cos(phi), p*sintheta*sin(phi), p*costheta);
+		double q = flat(gen) < 0.5 ? -1.0:1.0;
+
+		DReferenceTrajectory *rt = new DReferenceTrajectory(&bfield);
+		rt->SetUseStepIndex(true);
+		rt->Swim(pos, mom, q);
+		Nsteps += rt->Nswim_steps;
+		rts.push_back(rt);
+	}
+
+	vector<DCoordinateSystem> wires;
+	vector<unsigned int> wire_rt;
+	for(unsigned int i=0; i<rts.size(); i++){
+		if(rts[i]->Nswim_steps<1) continue;
+		for(unsigned int j=0; j<NRANDOM_WIRES; j++){
+			int istep = (int)(flat(gen)*rts[i]->Nswim_steps);
+			if(istep >= rts[i]->Nswim_steps) istep = rts[i]->Nswim_steps - 1;
+			wires.push_back(RandomWire(gen, rts[i]->swim_steps[istep].origin));
+			wire_rt.push_back(i);
+		}
+	}
+
+	// Time both searches first, so the indexed one includes building the
+	// index of each trajectory
+	double t_index = 0.0, t_linear = 0.0;
+	if(!wires.empty()){
+		unsigned long Nfound = 0;
+		auto t0 = chrono::steady_clock::now();
+		for(unsigned int rep=0; rep<NREPS; rep++)
+			for(unsigned int k=0; k<wires.size(); k++)
+				if(rts[wire_rt[k]]->FindClosestSwimStep(&wires[k]) != NULL) Nfound++;
+		auto t1 = chrono::steady_clock::now();
+		for(unsigned int rep=0; rep<NREPS; rep++)
+			for(unsigned int k=0; k<wires.size(); k++)
+				if(rts[wire_rt[k]]->FindClosestSwimStepLinear(&wires[k]) != NULL) Nfound++;
+		auto t2 = chrono::steady_clock::now();
+		t_index = chrono::duration<double, micro>(t1-t0).count()/((double)NREPS*wires.size());
+		t_linear = chrono::duration<double, micro>(t2-t1).count()/((double)NREPS*wires.size());
+	}
+
+	unsigned long Nmismatch = 0;
+	for(unsigned int k=0; k<wires.size(); k++){
+		const DReferenceTrajectory *rt = rts[wire_rt[k]];
+		int istep_index, istep_linear;
+		const DReferenceTrajectory::swim_step_t *step_linear = rt->FindClosestSwimStepLinear(&wires[k], &istep_linear);
+		rt->FindClosestSwimStep(&wires[k], &istep_index);
+		double doca_index = rt->DistToRTBruteForce(&wires[k]);
+		double doca_linear = step_linear ? rt->DistToRTBruteForce(&wires[k], step_linear):numeric_limits<double>::quiet_NaN();
+		bool same_doca = (doca_index == doca_linear) || (std::isnan(doca_index) && std::isnan(doca_linear));
+		if(istep_index == istep_linear && same_doca) continue;
+
+		if(Nmismatch < 10){
+			jerr << "Wire " << k << " (L=" << wires[k].L << "): indexed search found step " << istep_index
+				<< " (doca=" << doca_index << "), linear search step " << istep_linear << " (doca=" << doca_linear
+				<< ")  Nswim_steps=" << rt->Nswim_steps << endl;
+		}
+		Nmismatch++;
+	}
+
+	jout << "  Random tracks:         " << rts.size() << " (" << (rts.empty() ? 0.0:(double)Nsteps/rts.size()) << " swim steps/trajectory)" << endl;
+	jout << "  Random wires:          " << wires.size() << endl;
+	jout << "    different from linear search:   " << Nmismatch << endl;
+	jout << "    FindClosestSwimStep:            " << t_index << " us/call (index built on the first call for each track)" << endl;
+	jout << "    FindClosestSwimStepLinear:      " << t_linear << " us/call" << endl;
+
+	for(unsigned int i=0; i<rts.size(); i++) delete rts[i];
+
+	return Nmismatch;
+}
+
+//-----------
+// Benchmark
+//-----------
+void Benchmark(DApplication &app, unsigned int MAX_CANDIDATES, unsigned int NREPS)
+{
+	/// Record the track candidates of the input and time Swim, DistToRT
+	/// and FindClosestSwimStep on them
+	CandidateCollector collector(MAX_CANDIDATES);
+	app.Run(&collector);
+
+	vector<candidate_t> &candidates = collector.candidates;
+	if(candidates.empty()){
+		jerr << "No track candidates with CDC or FDC hits found in input!" << endl;
+		return;
+	}
+	unsigned int Nwires = 0;
+	for(unsigned int i=0; i<candidates.size(); i++) Nwires += candidates[i].wires.size();
+	jout << candidates.size() << " candidates, " << (double)Nwires/candidates.size() << " wires/candidate on average" << endl;
+
+	DMagneticFieldMap *bfield = app.GetBfield(collector.run_number);
+	DGeometry *geom = app.GetDGeometry(collector.run_number);
+
+	// Swim one trajectory per candidate, all alive at the same time
+	double rss_start = MaxRSS();
+	auto t0 = chrono::steady_clock::now();
+	vector<DReferenceTrajectory*> rts;
+	unsigned long Nsteps = 0;
+	for(unsigned int i=0; i<candidates.size(); i++){
+		DReferenceTrajectory *rt = new DReferenceTrajectory(bfield);
+		rt->SetDGeometry(geom);
+		rt->Swim(candidates[i].pos, candidates[i].mom, candidates[i].q);
+		Nsteps += rt->Nswim_steps;
+		rts.push_back(rt);
+	}
+	auto t1 = chrono::steady_clock::now();
+	double rss_end = MaxRSS();
+
+	// DistToRT and FindClosestSwimStep for all wires of each candidate
+	double sum_doca = 0.0; // checks that the calls are not optimized away
+	unsigned long Nclosest = 0;
+	auto t2 = chrono::steady_clock::now();
+	for(unsigned int rep=0; rep<NREPS; rep++)
+		for(unsigned int i=0; i<candidates.size(); i++)
+			for(unsigned int j=0; j<candidates[i].wires.size(); j++){
+				double doca = rts[i]->DistToRT(candidates[i].wires[j]);
+				if(isfinite(doca)) sum_doca += doca;
+			}
+	auto t3 = chrono::steady_clock::now();
+	for(unsigned int rep=0; rep<NREPS; rep++)
+		for(unsigned int i=0; i<candidates.size(); i++)
+			for(unsigned int j=0; j<candidates[i].wires.size(); j++)
+				if(rts[i]->FindClosestSwimStep(candidates[i].wires[j]) != NULL) Nclosest++;
+	auto t4 = chrono::steady_clock::now();
+
+	double Ncalls = (double)NREPS*Nwires;
+	double t_swim = chrono::duration<double, micro>(t1-t0).count()/candidates.size();
+	double t_dist = chrono::duration<double, micro>(t3-t2).count()/Ncalls;
+	double t_closest = chrono::duration<double, micro>(t4-t3).count()/Ncalls;
+
+	jout << "  sizeof(swim_step_t):   " << sizeof(DReferenceTrajectory::swim_step_t) << " bytes" << endl;
+	jout << "  swim steps/trajectory: " << (double)Nsteps/candidates.size() << endl;
+	jout << "  memory/trajectory:     " << 1024.0*(rss_end-rss_start)/candidates.size() << " kB (growth of peak RSS while swimming)" << endl;
+	jout << "  Swim:                  " << t_swim << " us/trajectory" << endl;
+	jout << "  DistToRT:              " << t_dist << " us/call" << endl;
+	jout << "  FindClosestSwimStep:   " << t_closest << " us/call" << endl;
+	jout << "  (sum of docas " << sum_doca << ", " << Nclosest << " closest steps found)" << endl;
+
+	for(unsigned int i=0; i<rts.size(); i++) delete rts[i];
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(JApplication &app)
+{
+	cout<<endl;
+	cout<<"Usage:"<<endl;
+	cout<<"    rt_bench [options] [source1 source2 source3 ...]"<<endl;
+	cout<<endl;
+	cout<<"Checks the indexed FindClosestSwimStep() against the search from"<<endl;
+	cout<<"the first step on random tracks and wires (exit code 1 if they"<<endl;
+	cout<<"differ). If sources are given, also swims a DReferenceTrajectory"<<endl;
+	cout<<"for each track candidate found in them, times DistToRT() and"<<endl;
+	cout<<"FindClosestSwimStep() on the wires of its hits and prints the"<<endl;
+	cout<<"memory used by the trajectories."<<endl;
+	cout<<endl;
+	app.Usage();
+	cout<<endl;
+
+	exit(0);
+}